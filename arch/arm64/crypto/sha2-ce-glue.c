@@ -28,6 +28,10 @@ struct sha256_ce_state {
 
 asmlinkage void sha2_ce_transform(struct sha256_ce_state *sst, u8 const *src,
 				  int blocks);
+asmlinkage void sha2_ce_transform_2x(struct sha256_state *sst1,
+				     struct sha256_state *sst2,
+				     u8 const *src1, u8 const *src2,
+				     int blocks);
 
 const u32 sha256_ce_offsetof_count = offsetof(struct sha256_ce_state,
 					      sst.count);
@@ -78,6 +82,93 @@ static int sha256_ce_final(struct shash_desc *desc, u8 *out)
 	return sha256_base_finish(desc, out);
 }
 
+static void sha256_ce_put_digest(struct sha256_state *sst, u8 *out)
+{
+	__be32 *digest = (__be32 *)out;
+	int i;
+
+	for (i = 0; i < SHA256_DIGEST_SIZE / sizeof(__be32); i++)
+		put_unaligned_be32(sst->state[i], digest++);
+}
+
+/*
+ * Finish two messages of the same length, starting from the (possibly
+ * partial) state in desc, with both streams going through the interleaved
+ * transform. As the lengths match, so does the padding.
+ */
+static int sha256_ce_finup2x(struct shash_desc *desc, const u8 *data1,
+			     const u8 *data2, unsigned int len, u8 *out1,
+			     u8 *out2)
+{
+	const int bit_offset = SHA256_BLOCK_SIZE - sizeof(__be64);
+	struct sha256_ce_state *sctx = shash_desc_ctx(desc);
+	struct sha256_state sst1 = sctx->sst;
+	struct sha256_state sst2 = sctx->sst;
+	unsigned int partial = sst1.count % SHA256_BLOCK_SIZE;
+	unsigned int blocks;
+
+	sst1.count += len;
+	sst2.count += len;
+
+	kernel_neon_begin_partial(22);
+
+	if (partial) {
+		unsigned int p = min(len, SHA256_BLOCK_SIZE - partial);
+
+		memcpy(sst1.buf + partial, data1, p);
+		memcpy(sst2.buf + partial, data2, p);
+		data1 += p;
+		data2 += p;
+		len -= p;
+		partial += p;
+
+		if (partial == SHA256_BLOCK_SIZE) {
+			sha2_ce_transform_2x(&sst1, &sst2, sst1.buf, sst2.buf,
+					     1);
+			partial = 0;
+		}
+	}
+
+	blocks = len / SHA256_BLOCK_SIZE;
+	if (blocks) {
+		sha2_ce_transform_2x(&sst1, &sst2, data1, data2, blocks);
+		data1 += blocks * SHA256_BLOCK_SIZE;
+		data2 += blocks * SHA256_BLOCK_SIZE;
+		len %= SHA256_BLOCK_SIZE;
+	}
+
+	if (len) {
+		memcpy(sst1.buf, data1, len);
+		memcpy(sst2.buf, data2, len);
+		partial = len;
+	}
+
+	sst1.buf[partial] = 0x80;
+	sst2.buf[partial] = 0x80;
+	partial++;
+	if (partial > bit_offset) {
+		memset(sst1.buf + partial, 0, SHA256_BLOCK_SIZE - partial);
+		memset(sst2.buf + partial, 0, SHA256_BLOCK_SIZE - partial);
+		sha2_ce_transform_2x(&sst1, &sst2, sst1.buf, sst2.buf, 1);
+		partial = 0;
+	}
+	memset(sst1.buf + partial, 0, bit_offset - partial);
+	memset(sst2.buf + partial, 0, bit_offset - partial);
+	*(__be64 *)(sst1.buf + bit_offset) = cpu_to_be64(sst1.count << 3);
+	*(__be64 *)(sst2.buf + bit_offset) = cpu_to_be64(sst2.count << 3);
+	sha2_ce_transform_2x(&sst1, &sst2, sst1.buf, sst2.buf, 1);
+
+	kernel_neon_end();
+
+	sha256_ce_put_digest(&sst1, out1);
+	sha256_ce_put_digest(&sst2, out2);
+
+	memzero_explicit(&sst1, sizeof(sst1));
+	memzero_explicit(&sst2, sizeof(sst2));
+	*sctx = (struct sha256_ce_state){};
+	return 0;
+}
+
 static struct shash_alg algs[] = { {
 	.init			= sha224_base_init,
 	.update			= sha256_ce_update,
@@ -98,6 +189,7 @@ static struct shash_alg algs[] = { {
 	.update			= sha256_ce_update,
 	.final			= sha256_ce_final,
 	.finup			= sha256_ce_finup,
+	.finup2x		= sha256_ce_finup2x,
 	.descsize		= sizeof(struct sha256_ce_state),
 	.digestsize		= SHA256_DIGEST_SIZE,
 	.base			= {
@@ -26,6 +26,7 @@
 #include <asm/cpu.h>
 #include <asm/cpufeature.h>
 #include <asm/cpu_ops.h>
+#include <asm/cputype.h>
 #include <asm/processor.h>
 #include <asm/sysreg.h>
 
@@ -626,6 +627,16 @@ has_cpuid_feature(const struct arm64_cpu_capabilities *entry)
 	return feature_matches(val, entry);
 }
 
+/*
+ * Use the Cortex-A53 tuned copy_page() when booting on an A53. This is a
+ * performance choice only, so on big.LITTLE systems the boot CPU decides.
+ */
+static bool is_cortex_a53(const struct arm64_cpu_capabilities *entry)
+{
+	return read_cpuid_implementor() == ARM_CPU_IMP_ARM &&
+	       read_cpuid_part_number() == ARM_CPU_PART_CORTEX_A53;
+}
+
 #ifdef CONFIG_UNMAP_KERNEL_AT_EL0
 static int __kpti_forced; /* 0: not forced, >0: forced on, <0: forced off */
 
@@ -704,6 +715,11 @@ static const struct arm64_cpu_capabilities arm64_features[] = {
 		.matches = unmap_kernel_at_el0,
 	},
 #endif
+	{
+		.desc = "Cortex-A53 tuned copy_page",
+		.capability = ARM64_TUNE_A53_COPY,
+		.matches = is_cortex_a53,
+	},
 	{},
 };
 
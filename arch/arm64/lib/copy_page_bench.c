@@ -0,0 +1,127 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Self-benchmark for the page copy/clear routines. Reading
+ * <debugfs>/copy_page_bench times every copy_page() variant and
+ * clear_page() over a buffer larger than the L2 cache, so the numbers
+ * resemble the cold-source copies done on COW faults, and reports which
+ * variant the alternatives framework selected for copy_page().
+ */
+
+#include <linux/debugfs.h>
+#include <linux/gfp.h>
+#include <linux/init.h>
+#include <linux/ktime.h>
+#include <linux/mm.h>
+#include <linux/seq_file.h>
+
+#include <asm/cpufeature.h>
+#include <asm/page.h>
+
+#define BENCH_ORDER	8	/* 1MB, larger than any A53 L2 */
+#define BENCH_PAGES	(1 << BENCH_ORDER)
+#define BENCH_ROUNDS	4
+
+static u64 bench_copy(void (*copy)(void *, const void *), void *dst, void *src)
+{
+	u64 start, ns;
+	int r, i;
+
+	preempt_disable();
+	start = ktime_get_ns();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		for (i = 0; i < BENCH_PAGES; i++)
+			copy(dst + i * PAGE_SIZE, src + i * PAGE_SIZE);
+	ns = ktime_get_ns() - start;
+	preempt_enable();
+
+	return ns;
+}
+
+static u64 bench_clear(void *dst)
+{
+	u64 start, ns;
+	int r, i;
+
+	preempt_disable();
+	start = ktime_get_ns();
+	for (r = 0; r < BENCH_ROUNDS; r++)
+		for (i = 0; i < BENCH_PAGES; i++)
+			clear_page(dst + i * PAGE_SIZE);
+	ns = ktime_get_ns() - start;
+	preempt_enable();
+
+	return ns;
+}
+
+static void bench_report(struct seq_file *s, const char *name, u64 ns)
+{
+	u64 bytes = (u64)BENCH_ROUNDS * BENCH_PAGES * PAGE_SIZE;
+
+	seq_printf(s, "%-20s %6llu ns/page %6llu MB/s\n", name,
+		   div64_u64(ns, BENCH_ROUNDS * BENCH_PAGES),
+		   ns ? div64_u64(bytes * (NSEC_PER_SEC >> 10), ns) >> 10 : 0);
+}
+
+static int copy_page_bench_show(struct seq_file *s, void *unused)
+{
+	struct page *src, *dst;
+	void *from, *to;
+
+	src = alloc_pages(GFP_KERNEL, BENCH_ORDER);
+	dst = alloc_pages(GFP_KERNEL, BENCH_ORDER);
+	if (!src || !dst) {
+		if (src)
+			__free_pages(src, BENCH_ORDER);
+		if (dst)
+			__free_pages(dst, BENCH_ORDER);
+		return -ENOMEM;
+	}
+
+	from = page_address(src);
+	to = page_address(dst);
+	memset(from, 0x5a, BENCH_PAGES * PAGE_SIZE);
+
+	seq_printf(s, "copy_page uses %s variant\n",
+		   cpus_have_cap(ARM64_TUNE_A53_COPY) ? "a53" : "generic");
+	bench_report(s, "copy_page generic", bench_copy(__copy_page_generic,
+							 to, from));
+	bench_report(s, "copy_page a53", bench_copy(__copy_page_a53, to, from));
+	bench_report(s, "clear_page", bench_clear(to));
+
+	__free_pages(src, BENCH_ORDER);
+	__free_pages(dst, BENCH_ORDER);
+	return 0;
+}
+
+static int copy_page_bench_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, copy_page_bench_show, NULL);
+}
+
+static const struct file_operations copy_page_bench_fops = {
+	.open		= copy_page_bench_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init copy_page_bench_init(void)
+{
+	debugfs_create_file("copy_page_bench", 0400, NULL, NULL,
+			    &copy_page_bench_fops);
+	return 0;
+}
+late_initcall(copy_page_bench_init);
@@ -838,6 +838,35 @@ static void bfq_handle_burst(struct bfq_data *bfqd, struct bfq_queue *bfqq,
 	bfq_add_to_burst(bfqd, bfqq);
 }
 
+/*
+ * Requests issued by foreground tasks, as flagged by SchedTune, are
+ * weight-raised regardless of the interactive/soft real-time heuristics,
+ * which a foreground application can easily fail to satisfy while it is
+ * starting up together with background jobs (e.g., dex2oat).
+ */
+static inline bool bfq_rq_from_fg(struct bfq_data *bfqd,
+				  struct bfq_queue *bfqq)
+{
+	return bfqd->low_latency && bfqd->bfq_wr_fg_max_time > 0 &&
+	       (!bfq_bfqq_sync(bfqq) || bfqq->bic != NULL) &&
+	       schedtune_task_foreground(current);
+}
+
+static void bfq_fg_weight_raise(struct bfq_data *bfqd,
+				struct bfq_queue *bfqq)
+{
+	if (bfqq->wr_coeff == 1) {
+		bfqq->wr_coeff = bfqd->bfq_wr_coeff;
+		bfq_log_bfqq(bfqd, bfqq,
+			     "fg wrais starting at %lu, rais_max_time %u",
+			     jiffies,
+			     jiffies_to_msecs(bfqd->bfq_wr_fg_max_time));
+	}
+	bfqq->wr_cur_max_time = bfqd->bfq_wr_fg_max_time;
+	bfqq->last_wr_start_finish = jiffies;
+	bfq_mark_bfqq_fg_wr(bfqq);
+}
+
 static void bfq_add_request(struct request *rq)
 {
 	struct bfq_queue *bfqq = RQ_BFQQ(rq);
@@ -846,6 +875,7 @@ static void bfq_add_request(struct request *rq)
 	struct request *next_rq, *prev;
 	unsigned long old_wr_coeff = bfqq->wr_coeff;
 	bool interactive = false;
+	bool fg = bfq_rq_from_fg(bfqd, bfqq);
 
 	bfq_log_bfqq(bfqd, bfqq, "add_request %d", rq_is_sync(rq));
 	bfqq->queued[rq_is_sync(rq)]++;
@@ -919,6 +949,11 @@ static void bfq_add_request(struct request *rq)
 		if (bfq_bfqq_just_split(bfqq))
 			goto set_ioprio_changed;
 
+		if (fg) {
+			bfq_fg_weight_raise(bfqd, bfqq);
+			goto set_ioprio_changed;
+		}
+
 		/*
 		 * If the queue:
 		 * - is not being boosted,
@@ -948,6 +983,7 @@ static void bfq_add_request(struct request *rq)
 				  bfqd->bfq_wr_rt_max_time &&
 				  !soft_rt)) {
 				bfqq->wr_coeff = 1;
+				bfq_clear_bfqq_fg_wr(bfqq);
 				bfq_log_bfqq(bfqd, bfqq,
 					"wrais ending at %lu, rais_max_time %u",
 					jiffies,
@@ -1017,8 +1053,15 @@ add_bfqq_busy:
 		bfq_clear_bfqq_softrt_update(bfqq);
 		bfq_add_bfqq_busy(bfqd, bfqq);
 	} else {
-		if (bfqd->low_latency && old_wr_coeff == 1 && !rq_is_sync(rq) &&
-		    time_is_before_jiffies(
+		if (fg) {
+			bfq_fg_weight_raise(bfqd, bfqq);
+			if (old_wr_coeff == 1) {
+				bfqd->wr_busy_queues++;
+				entity->ioprio_changed = 1;
+			}
+		} else if (bfqd->low_latency && old_wr_coeff == 1 &&
+			   !rq_is_sync(rq) &&
+			   time_is_before_jiffies(
 				bfqq->last_wr_start_finish +
 				bfqd->bfq_wr_min_inter_arr_async)) {
 			bfqq->wr_coeff = bfqd->bfq_wr_coeff;
@@ -1197,6 +1240,7 @@ static inline void bfq_bfqq_end_wr(struct bfq_queue *bfqq)
 		bfqq->bfqd->wr_busy_queues--;
 	bfqq->wr_coeff = 1;
 	bfqq->wr_cur_max_time = 0;
+	bfq_clear_bfqq_fg_wr(bfqq);
 	/* Trigger a weight change on the next activation of the queue */
 	bfqq->entity.ioprio_changed = 1;
 }
@@ -2619,13 +2663,15 @@ static void bfq_update_wr_data(struct bfq_data *bfqd, struct bfq_queue *bfqq)
 			bfq_log_bfqq(bfqd, bfqq, "WARN: pending prio change");
 
 		/*
-		 * If the queue was activated in a burst, or
+		 * If the queue was activated in a burst (and is not
+		 * raised on behalf of a foreground task), or
 		 * too much time has elapsed from the beginning
 		 * of this weight-raising period, or the queue has
 		 * exceeded the acceptable number of cooperations,
 		 * then end weight raising.
 		 */
-		if (bfq_bfqq_in_large_burst(bfqq) ||
+		if ((bfq_bfqq_in_large_burst(bfqq) &&
+		     !bfq_bfqq_fg_wr(bfqq)) ||
 		    bfq_bfqq_cooperations(bfqq) >= bfqd->bfq_coop_thresh ||
 		    time_is_before_jiffies(bfqq->last_wr_start_finish +
 					   bfqq->wr_cur_max_time)) {
@@ -3874,6 +3920,7 @@ static int bfq_init_queue(struct request_queue *q, struct elevator_type *e)
 	bfqd->bfq_wr_rt_max_time = msecs_to_jiffies(300);
 	bfqd->bfq_wr_max_time = 0;
 	bfqd->bfq_wr_min_idle_time = msecs_to_jiffies(2000);
+	bfqd->bfq_wr_fg_max_time = msecs_to_jiffies(3000);
 	bfqd->bfq_wr_min_inter_arr_async = msecs_to_jiffies(500);
 	bfqd->bfq_wr_max_softrt_rate = 7000; /*
 					      * Approximate rate required
@@ -4010,6 +4057,7 @@ SHOW_FUNCTION(bfq_low_latency_show, bfqd->low_latency, 0);
 SHOW_FUNCTION(bfq_wr_coeff_show, bfqd->bfq_wr_coeff, 0);
 SHOW_FUNCTION(bfq_wr_rt_max_time_show, bfqd->bfq_wr_rt_max_time, 1);
 SHOW_FUNCTION(bfq_wr_min_idle_time_show, bfqd->bfq_wr_min_idle_time, 1);
+SHOW_FUNCTION(bfq_wr_fg_max_time_show, bfqd->bfq_wr_fg_max_time, 1);
 SHOW_FUNCTION(bfq_wr_min_inter_arr_async_show, bfqd->bfq_wr_min_inter_arr_async,
 	1);
 SHOW_FUNCTION(bfq_wr_max_softrt_rate_show, bfqd->bfq_wr_max_softrt_rate, 0);
@@ -4050,6 +4098,8 @@ STORE_FUNCTION(bfq_wr_rt_max_time_store, &bfqd->bfq_wr_rt_max_time, 0, INT_MAX,
 		1);
 STORE_FUNCTION(bfq_wr_min_idle_time_store, &bfqd->bfq_wr_min_idle_time, 0,
 		INT_MAX, 1);
+STORE_FUNCTION(bfq_wr_fg_max_time_store, &bfqd->bfq_wr_fg_max_time, 0,
+		INT_MAX, 1);
 STORE_FUNCTION(bfq_wr_min_inter_arr_async_store,
 		&bfqd->bfq_wr_min_inter_arr_async, 0, INT_MAX, 1);
 STORE_FUNCTION(bfq_wr_max_softrt_rate_store, &bfqd->bfq_wr_max_softrt_rate, 0,
@@ -4146,6 +4196,7 @@ static struct elv_fs_entry bfq_attrs[] = {
 	BFQ_ATTR(wr_max_time),
 	BFQ_ATTR(wr_rt_max_time),
 	BFQ_ATTR(wr_min_idle_time),
+	BFQ_ATTR(wr_fg_max_time),
 	BFQ_ATTR(wr_min_inter_arr_async),
 	BFQ_ATTR(wr_max_softrt_rate),
 	BFQ_ATTR(weights),
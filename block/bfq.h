@@ -468,6 +468,9 @@ enum bfq_device_speed {
  * @bfq_wr_rt_max_time: maximum duration for soft real-time processes.
  * @bfq_wr_min_idle_time: minimum idle period after which weight-raising
  *			  may be reactivated for a queue (in jiffies).
+ * @bfq_wr_fg_max_time: duration of the weight-raising period granted to
+ *			queues of foreground (SchedTune boosted) tasks, 0 to
+ *			disable (in jiffies).
  * @bfq_wr_min_inter_arr_async: minimum period between request arrivals
  *				after which weight-raising may be
  *				reactivated for an already busy queue
@@ -554,6 +557,7 @@ struct bfq_data {
 	unsigned int bfq_wr_max_time;
 	unsigned int bfq_wr_rt_max_time;
 	unsigned int bfq_wr_min_idle_time;
+	unsigned int bfq_wr_fg_max_time;
 	unsigned long bfq_wr_min_inter_arr_async;
 	unsigned int bfq_wr_max_softrt_rate;
 	u64 RT_prod;
@@ -590,6 +594,10 @@ enum bfqq_state_flags {
 	BFQ_BFQQ_FLAG_coop,		/* bfqq is shared */
 	BFQ_BFQQ_FLAG_split_coop,	/* shared bfqq will be split */
 	BFQ_BFQQ_FLAG_just_split,	/* queue has just been split */
+	BFQ_BFQQ_FLAG_fg_wr,		/*
+					 * weight-raised on behalf of a
+					 * foreground task
+					 */
 };
 
 #define BFQ_BFQQ_FNS(name)						\
@@ -619,6 +627,7 @@ BFQ_BFQQ_FNS(constantly_seeky);
 BFQ_BFQQ_FNS(coop);
 BFQ_BFQQ_FNS(split_coop);
 BFQ_BFQQ_FNS(just_split);
+BFQ_BFQQ_FNS(fg_wr);
 BFQ_BFQQ_FNS(softrt_update);
 #undef BFQ_BFQQ_FNS
 
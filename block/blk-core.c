@@ -1357,6 +1357,7 @@ void __blk_put_request(struct request_queue *q, struct request *req)
 		return;
 	}
 
+	blk_rq_io_lat_put(req);
 	blk_pm_put_request(req);
 
 	elv_completed_request(q, req);
@@ -1548,6 +1549,7 @@ void init_request_from_bio(struct request *req, struct bio *bio)
 	req->__sector = bio->bi_iter.bi_sector;
 	req->ioprio = bio_prio(bio);
 	blk_rq_bio_prep(req->q, req, bio);
+	blk_rq_io_lat_init(req);
 }
 EXPORT_SYMBOL(init_request_from_bio);
 
@@ -2143,8 +2145,29 @@ void blk_account_io_completion(struct request *req, unsigned int bytes)
 	}
 }
 
+#ifdef CONFIG_TASK_IO_LATENCY
+static void blk_account_io_latency(struct request *req)
+{
+	u64 now;
+
+	if (!req->io_lat_task || !req->io_lat_issue_ns ||
+	    (req->cmd_flags & REQ_FLUSH_SEQ))
+		return;
+
+	now = ktime_get_ns();
+	task_io_account_latency(req->io_lat_task,
+				req->io_lat_issue_ns - req->io_lat_queue_ns,
+				now - req->io_lat_issue_ns);
+	blk_rq_io_lat_put(req);
+}
+#else
+static inline void blk_account_io_latency(struct request *req) { }
+#endif
+
 void blk_account_io_done(struct request *req)
 {
+	blk_account_io_latency(req);
+
 	/*
 	 * Account IO completion.  flush_rq isn't accounted as a
 	 * normal IO on queueing nor completion.  Accounting the
@@ -2380,6 +2403,7 @@ void blk_start_request(struct request *req)
 
 	BUG_ON(test_bit(REQ_ATOM_COMPLETE, &req->atomic_flags));
 	blk_add_timer(req);
+	blk_rq_io_lat_issue(req);
 }
 EXPORT_SYMBOL(blk_start_request);
 
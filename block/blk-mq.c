@@ -178,6 +178,9 @@ static void blk_mq_rq_ctx_init(struct request_queue *q, struct blk_mq_ctx *ctx,
 	rq->rl = NULL;
 	set_start_time_ns(rq);
 	rq->io_start_time_ns = 0;
+#endif
+#ifdef CONFIG_TASK_IO_LATENCY
+	rq->io_lat_task = NULL;
 #endif
 	rq->nr_phys_segments = 0;
 #if defined(CONFIG_BLK_DEV_INTEGRITY)
@@ -273,6 +276,7 @@ static void __blk_mq_free_request(struct blk_mq_hw_ctx *hctx,
 	if (rq->cmd_flags & REQ_MQ_INFLIGHT)
 		atomic_dec(&hctx->nr_active);
 	rq->cmd_flags = 0;
+	blk_rq_io_lat_put(rq);
 
 	clear_bit(REQ_ATOM_STARTED, &rq->atomic_flags);
 	blk_mq_put_tag(hctx, tag, &ctx->last_tag);
@@ -386,6 +390,7 @@ void blk_mq_start_request(struct request *rq)
 		rq->next_rq->resid_len = blk_rq_bytes(rq->next_rq);
 
 	blk_add_timer(rq);
+	blk_rq_io_lat_issue(rq);
 
 	/*
 	 * Ensure that ->deadline is visible before set the started
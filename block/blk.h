@@ -237,6 +237,44 @@ static inline int blk_do_io_stat(struct request *rq)
 		(rq->cmd_type == REQ_TYPE_FS);
 }
 
+#ifdef CONFIG_TASK_IO_LATENCY
+/*
+ * Per-task I/O latency: a request built from a bio submitted by a user
+ * task pins that task until the request completes or is freed, so the
+ * queueing and service times can be charged to it at completion.
+ */
+static inline void blk_rq_io_lat_init(struct request *rq)
+{
+	if (current->flags & PF_KTHREAD) {
+		rq->io_lat_task = NULL;
+		return;
+	}
+
+	get_task_struct(current);
+	rq->io_lat_task = current;
+	rq->io_lat_queue_ns = ktime_get_ns();
+	rq->io_lat_issue_ns = 0;
+}
+
+static inline void blk_rq_io_lat_issue(struct request *rq)
+{
+	if (rq->io_lat_task)
+		rq->io_lat_issue_ns = ktime_get_ns();
+}
+
+static inline void blk_rq_io_lat_put(struct request *rq)
+{
+	if (rq->io_lat_task) {
+		put_task_struct(rq->io_lat_task);
+		rq->io_lat_task = NULL;
+	}
+}
+#else
+static inline void blk_rq_io_lat_init(struct request *rq) { }
+static inline void blk_rq_io_lat_issue(struct request *rq) { }
+static inline void blk_rq_io_lat_put(struct request *rq) { }
+#endif /* CONFIG_TASK_IO_LATENCY */
+
 /*
  * Internal io_context interface
  */
@@ -26,8 +26,12 @@
 #include <linux/slab.h>
 #include <linux/init.h>
 #include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <linux/test-iosched.h>
 #include <linux/delay.h>
+#include <linux/vmalloc.h>
+#include <linux/sort.h>
+#include <linux/math64.h>
 #include "blk.h"
 
 #define MODULE_NAME "test-iosched"
@@ -36,6 +40,14 @@
 #define TIMEOUT_TIMER_MS 40000
 #define TEST_MAX_TESTCASE_ROUNDS 15
 
+#define TEST_BENCH_DEFAULT_NUM_REQS	10000
+#define TEST_BENCH_DEFAULT_QUEUE_DEPTH	32
+#define TEST_BENCH_DEFAULT_SEED		7
+#define TEST_BENCH_DEFAULT_SECTOR_RANGE	(1024 * 1024) /* 512MB */
+/* keep clear of the 128 requests of the queue's request pool */
+#define TEST_BENCH_MAX_QUEUE_DEPTH	64
+#define TEST_BENCH_MAX_REQS		(1024 * 1024)
+
 
 static DEFINE_MUTEX(blk_dev_test_list_lock);
 static LIST_HEAD(blk_dev_test_list);
@@ -881,6 +893,288 @@ void test_iosched_set_ignore_round(struct test_iosched *tios,
 }
 EXPORT_SYMBOL(test_iosched_set_ignore_round);
 
+/*
+ * Benchmark mode: issue a configurable mix of requests while keeping at most
+ * queue_depth of them outstanding, and record the latency of each one from
+ * queueing to completion. Block device test utilities expose it as a test
+ * case by plugging test_iosched_bench_run() and
+ * test_iosched_bench_check_completion() into their test_info, and calling
+ * test_iosched_bench_report() from their post_test_fn.
+ */
+static bool test_bench_pick(struct test_bench *bench, u32 pct)
+{
+	return prandom_u32_state(&bench->rnd) % 100 < pct;
+}
+
+static void test_bench_end_io(struct request *rq, int err)
+{
+	struct test_iosched *tios = rq->q->elevator->elevator_data;
+	struct test_request *test_rq = (struct test_request *)rq->elv.priv[0];
+	struct test_bench *bench = &tios->bench;
+	s64 lat_us = ktime_us_delta(ktime_get(), test_rq->issue_time);
+	unsigned long flags;
+
+	spin_lock_irqsave(&tios->lock, flags);
+	tios->dispatched_count--;
+	list_del_init(&test_rq->queuelist);
+	__blk_put_request(tios->req_q, rq);
+
+	if (bench->lat_us && bench->nr_completed < bench->nr_reqs)
+		bench->lat_us[bench->nr_completed] =
+			min_t(s64, lat_us, U32_MAX);
+	bench->nr_completed++;
+	if (err)
+		bench->nr_errors++;
+	else
+		bench->bytes += test_rq->buf_size;
+	spin_unlock_irqrestore(&tios->lock, flags);
+
+	test_iosched_free_test_req_data_buffer(test_rq);
+	kfree(test_rq);
+
+	wake_up(&bench->wait_q);
+	check_test_completion(tios);
+}
+
+/**
+ * test_iosched_bench_run() - run_test_fn of a benchmark test case
+ *
+ * Generates the workload described by tios->bench.cfg. The request
+ * sequence only depends on the configuration and seed, so runs with the
+ * same settings are comparable. Returns once all requests are queued.
+ */
+int test_iosched_bench_run(struct test_iosched *tios)
+{
+	struct test_bench *bench = &tios->bench;
+	struct test_bench_cfg cfg = bench->cfg;
+	struct test_request *test_rq;
+	u32 start, range, sec_per_req, seq_sector, sector;
+	unsigned long flags;
+	u32 *lat_us;
+	int direction;
+	int ret = 0;
+
+	cfg.num_reqs = clamp_t(u32, cfg.num_reqs, 1, TEST_BENCH_MAX_REQS);
+	cfg.queue_depth = clamp_t(u32, cfg.queue_depth, 1,
+				  TEST_BENCH_MAX_QUEUE_DEPTH);
+	cfg.bios_per_req = clamp_t(u32, cfg.bios_per_req, 1,
+				   BLK_MAX_SEGMENTS);
+
+	sec_per_req = cfg.bios_per_req * (TEST_BIO_SIZE >> 9);
+	start = ALIGN(tios->start_sector, TEST_BIO_SIZE >> 9);
+	range = tios->sector_range ? tios->sector_range :
+		TEST_BENCH_DEFAULT_SECTOR_RANGE;
+	if (range < sec_per_req) {
+		pr_err("%s: sector_range is smaller than a request", __func__);
+		return -EINVAL;
+	}
+
+	lat_us = vmalloc(cfg.num_reqs * sizeof(*lat_us));
+	if (!lat_us) {
+		pr_err("%s: failed to allocate latency samples", __func__);
+		return -ENOMEM;
+	}
+
+	spin_lock_irqsave(&tios->lock, flags);
+	bench->lat_us = lat_us;
+	bench->nr_reqs = cfg.num_reqs;
+	bench->nr_issued = 0;
+	bench->nr_completed = 0;
+	bench->nr_errors = 0;
+	bench->bytes = 0;
+	spin_unlock_irqrestore(&tios->lock, flags);
+
+	prandom_seed_state(&bench->rnd, cfg.seed);
+	seq_sector = start;
+
+	pr_info("%s: %u reqs of %u sectors, QD %u, %u%% read, %u%% random, %u%% sync",
+		__func__, cfg.num_reqs, sec_per_req, cfg.queue_depth,
+		cfg.read_pct, cfg.random_pct, cfg.sync_pct);
+
+	while (bench->nr_issued < cfg.num_reqs) {
+		ret = wait_event_interruptible(bench->wait_q,
+			bench->nr_issued - ACCESS_ONCE(bench->nr_completed) <
+			cfg.queue_depth);
+		if (ret)
+			break;
+
+		direction = test_bench_pick(bench, cfg.read_pct) ? READ : WRITE;
+		if (test_bench_pick(bench, cfg.random_pct)) {
+			sector = start + sec_per_req *
+				(prandom_u32_state(&bench->rnd) %
+				 (range / sec_per_req));
+		} else {
+			if (seq_sector + sec_per_req > start + range)
+				seq_sector = start;
+			sector = seq_sector;
+		}
+		seq_sector = sector + sec_per_req;
+
+		test_rq = test_iosched_create_test_req(tios, 0, direction,
+			sector, cfg.bios_per_req, TEST_NO_PATTERN,
+			test_bench_end_io);
+		if (!test_rq) {
+			ret = -ENOMEM;
+			break;
+		}
+		if (test_bench_pick(bench, cfg.sync_pct))
+			test_rq->rq->cmd_flags |= REQ_SYNC;
+
+		test_rq->issue_time = ktime_get();
+		spin_lock_irqsave(tios->req_q->queue_lock, flags);
+		list_add_tail(&test_rq->queuelist, &tios->test_queue);
+		tios->test_count++;
+		spin_unlock_irqrestore(tios->req_q->queue_lock, flags);
+		bench->nr_issued++;
+
+		blk_run_queue(tios->req_q);
+	}
+
+	return ret;
+}
+EXPORT_SYMBOL(test_iosched_bench_run);
+
+/**
+ * test_iosched_bench_check_completion() - check_test_completion_fn of a
+ * benchmark test case
+ */
+bool test_iosched_bench_check_completion(struct test_iosched *tios)
+{
+	return tios->bench.nr_completed >= tios->bench.nr_reqs;
+}
+EXPORT_SYMBOL(test_iosched_bench_check_completion);
+
+static int test_bench_cmp_u32(const void *a, const void *b)
+{
+	u32 x = *(const u32 *)a;
+	u32 y = *(const u32 *)b;
+
+	return (x > y) - (x < y);
+}
+
+static u32 test_bench_percentile(const u32 *sorted, u32 n, u32 permille)
+{
+	return sorted[div_u64((u64)(n - 1) * permille, 1000)];
+}
+
+/**
+ * test_iosched_bench_report() - compute the results of the last run
+ *
+ * To be called from the post_test_fn of a benchmark test case. The results
+ * stay readable in utils/bench/results until the next run.
+ */
+void test_iosched_bench_report(struct test_iosched *tios)
+{
+	struct test_bench *bench = &tios->bench;
+	struct test_bench_result *res = &bench->res;
+	unsigned long flags;
+	u32 *lat_us;
+	u32 n;
+
+	spin_lock_irqsave(&tios->lock, flags);
+	lat_us = bench->lat_us;
+	bench->lat_us = NULL;
+	n = min(bench->nr_completed, bench->nr_reqs);
+	memset(res, 0, sizeof(*res));
+	res->completed = bench->nr_completed;
+	res->errors = bench->nr_errors;
+	res->bytes = bench->bytes;
+	spin_unlock_irqrestore(&tios->lock, flags);
+
+	if (!lat_us)
+		return;
+
+	if (n < bench->nr_reqs) {
+		pr_err("%s: only %u of %u requests completed", __func__, n,
+			bench->nr_reqs);
+		goto out;
+	}
+
+	sort(lat_us, n, sizeof(*lat_us), test_bench_cmp_u32, NULL);
+	res->min_us = lat_us[0];
+	res->p50_us = test_bench_percentile(lat_us, n, 500);
+	res->p99_us = test_bench_percentile(lat_us, n, 990);
+	res->p999_us = test_bench_percentile(lat_us, n, 999);
+	res->max_us = lat_us[n - 1];
+
+	res->duration_us = ktime_to_us(tios->test_info.test_duration);
+	if (res->duration_us) {
+		res->kib_per_sec = div64_u64(res->bytes * USEC_PER_SEC,
+					     res->duration_us * 1024);
+		res->iops = div64_u64((u64)res->completed * USEC_PER_SEC,
+				      res->duration_us);
+	}
+
+	pr_info("%s: %llu KiB/s, %llu IOPS, latency p50 %u us, p99 %u us, p99.9 %u us, max %u us",
+		__func__, res->kib_per_sec, res->iops, res->p50_us,
+		res->p99_us, res->p999_us, res->max_us);
+out:
+	vfree(lat_us);
+}
+EXPORT_SYMBOL(test_iosched_bench_report);
+
+static int test_bench_results_show(struct seq_file *m, void *v)
+{
+	struct test_iosched *tios = m->private;
+	struct test_bench_result *res = &tios->bench.res;
+
+	seq_printf(m, "completed: %u\n", res->completed);
+	seq_printf(m, "errors: %u\n", res->errors);
+	seq_printf(m, "bytes: %llu\n", res->bytes);
+	seq_printf(m, "duration_us: %llu\n", res->duration_us);
+	seq_printf(m, "throughput_kib_s: %llu\n", res->kib_per_sec);
+	seq_printf(m, "iops: %llu\n", res->iops);
+	seq_printf(m, "lat_min_us: %u\n", res->min_us);
+	seq_printf(m, "lat_p50_us: %u\n", res->p50_us);
+	seq_printf(m, "lat_p99_us: %u\n", res->p99_us);
+	seq_printf(m, "lat_p99.9_us: %u\n", res->p999_us);
+	seq_printf(m, "lat_max_us: %u\n", res->max_us);
+	return 0;
+}
+
+static int test_bench_results_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, test_bench_results_show, inode->i_private);
+}
+
+static const struct file_operations test_bench_results_fops = {
+	.open		= test_bench_results_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int test_bench_debugfs_init(struct test_iosched *tios)
+{
+	struct test_bench_cfg *cfg = &tios->bench.cfg;
+	struct dentry *root;
+
+	root = debugfs_create_dir("bench", tios->debug.debug_utils_root);
+	if (!root)
+		return -ENOENT;
+	tios->debug.bench_root = root;
+
+	if (!debugfs_create_u32("num_reqs", S_IRUGO | S_IWUGO, root,
+				&cfg->num_reqs) ||
+	    !debugfs_create_u32("queue_depth", S_IRUGO | S_IWUGO, root,
+				&cfg->queue_depth) ||
+	    !debugfs_create_u32("read_pct", S_IRUGO | S_IWUGO, root,
+				&cfg->read_pct) ||
+	    !debugfs_create_u32("random_pct", S_IRUGO | S_IWUGO, root,
+				&cfg->random_pct) ||
+	    !debugfs_create_u32("sync_pct", S_IRUGO | S_IWUGO, root,
+				&cfg->sync_pct) ||
+	    !debugfs_create_u32("bios_per_req", S_IRUGO | S_IWUGO, root,
+				&cfg->bios_per_req) ||
+	    !debugfs_create_u32("seed", S_IRUGO | S_IWUGO, root,
+				&cfg->seed) ||
+	    !debugfs_create_file("results", S_IRUGO, root, tios,
+				 &test_bench_results_fops))
+		return -ENOENT;
+
+	return 0;
+}
+
 static int test_debugfs_init(struct test_iosched *tios)
 {
 	char name[2*BDEVNAME_SIZE];
@@ -928,6 +1222,9 @@ static int test_debugfs_init(struct test_iosched *tios)
 	if (!tios->debug.sector_range)
 		goto err;
 
+	if (test_bench_debugfs_init(tios))
+		goto err;
+
 	return 0;
 
 err:
@@ -1137,6 +1434,15 @@ static int test_init_queue(struct request_queue *q, struct elevator_type *e)
 	init_waitqueue_head(&tios->wait_q);
 	tios->req_q = q;
 
+	init_waitqueue_head(&tios->bench.wait_q);
+	tios->bench.cfg.num_reqs = TEST_BENCH_DEFAULT_NUM_REQS;
+	tios->bench.cfg.queue_depth = TEST_BENCH_DEFAULT_QUEUE_DEPTH;
+	tios->bench.cfg.read_pct = 50;
+	tios->bench.cfg.random_pct = 100;
+	tios->bench.cfg.sync_pct = 100;
+	tios->bench.cfg.bios_per_req = 1;
+	tios->bench.cfg.seed = TEST_BENCH_DEFAULT_SEED;
+
 	spin_lock_init(&tios->lock);
 
 	ret = test_debugfs_init(tios);
@@ -1205,6 +1511,7 @@ static void test_exit_queue(struct elevator_queue *e)
 
 	test_debugfs_cleanup(tios);
 
+	vfree(tios->bench.lat_us);
 	kfree(tios);
 }
 
@@ -178,6 +178,25 @@ int crypto_shash_finup(struct shash_desc *desc, const u8 *data,
 }
 EXPORT_SYMBOL_GPL(crypto_shash_finup);
 
+int crypto_shash_finup2x(struct shash_desc *desc, const u8 *data1,
+			 const u8 *data2, unsigned int len, u8 *out1,
+			 u8 *out2)
+{
+	struct crypto_shash *tfm = desc->tfm;
+	struct shash_alg *shash = crypto_shash_alg(tfm);
+	unsigned long alignmask = crypto_shash_alignmask(tfm);
+
+	if (!shash->finup2x)
+		return -EOPNOTSUPP;
+
+	if (((unsigned long)data1 | (unsigned long)data2 |
+	     (unsigned long)out1 | (unsigned long)out2) & alignmask)
+		return -EINVAL;
+
+	return shash->finup2x(desc, data1, data2, len, out1, out2);
+}
+EXPORT_SYMBOL_GPL(crypto_shash_finup2x);
+
 static int shash_digest_unaligned(struct shash_desc *desc, const u8 *data,
 				  unsigned int len, u8 *out)
 {
@@ -430,6 +430,40 @@ int driver_probe_device(struct device_driver *drv, struct device *dev)
 	return ret;
 }
 
+#define ASYNC_DRV_NAMES_MAX_LEN	256
+static char async_probe_drv_names[ASYNC_DRV_NAMES_MAX_LEN];
+static bool async_probe_default;
+
+/*
+ * "driver_async_probe=" takes a comma separated list of drivers that
+ * should probe asynchronously even though they don't ask for it, so
+ * independent built-in drivers can be probed in parallel without
+ * touching them. "*" selects all drivers, and with it the listed
+ * drivers are the ones kept synchronous. Drivers with
+ * PROBE_FORCE_SYNCHRONOUS are never affected. Dependencies between
+ * drivers are handled as usual through -EPROBE_DEFER.
+ */
+static int __init save_async_options(char *buf)
+{
+	if (strlen(buf) >= ASYNC_DRV_NAMES_MAX_LEN)
+		pr_warn("Too long list of driver names for 'driver_async_probe'!\n");
+
+	strlcpy(async_probe_drv_names, buf, ASYNC_DRV_NAMES_MAX_LEN);
+	async_probe_default = parse_option_str(async_probe_drv_names, "*");
+
+	return 1;
+}
+__setup("driver_async_probe=", save_async_options);
+
+static bool cmdline_requested_async_probing(const char *drv_name)
+{
+	bool async_drv;
+
+	async_drv = parse_option_str(async_probe_drv_names, drv_name);
+
+	return (async_probe_default != async_drv);
+}
+
 bool driver_allows_async_probing(struct device_driver *drv)
 {
 	switch (drv->probe_type) {
@@ -440,6 +474,9 @@ bool driver_allows_async_probing(struct device_driver *drv)
 		return false;
 
 	default:
+		if (cmdline_requested_async_probing(drv->name))
+			return true;
+
 		if (module_requested_async_probing(drv->owner))
 			return true;
 
@@ -196,6 +196,25 @@ struct page *dma_alloc_from_contiguous(struct device *dev, size_t count,
 	return cma_alloc(dev_get_cma_area(dev), count, align);
 }
 
+/**
+ * dma_prepare_contiguous() - prepare for an upcoming allocation
+ * @dev:   Pointer to device for which the allocation will be performed.
+ * @count: Expected number of pages.
+ * @align: Expected alignment of pages (in PAGE_SIZE order).
+ *
+ * Hints that dma_alloc_from_contiguous() is about to be called for @dev,
+ * so that the pages can be migrated out of its contiguous area ahead of
+ * time.  See cma_prepare().
+ */
+int dma_prepare_contiguous(struct device *dev, size_t count,
+			   unsigned int align)
+{
+	if (align > CONFIG_CMA_ALIGNMENT)
+		align = CONFIG_CMA_ALIGNMENT;
+
+	return cma_prepare(dev_get_cma_area(dev), count, align);
+}
+
 /**
  * dma_release_from_contiguous() - release allocated pages
  * @dev:   Pointer to device for which the pages were allocated.
@@ -23,6 +23,7 @@
 #include <linux/sched.h>
 #include <linux/file.h>
 #include <linux/list.h>
+#include <linux/sizes.h>
 #include <linux/async.h>
 #include <linux/pm.h>
 #include <linux/suspend.h>
@@ -316,6 +317,143 @@ static const char * const fw_path[] = {
 module_param_string(path, fw_path_para, sizeof(fw_path_para), 0644);
 MODULE_PARM_DESC(path, "customized firmware image search path with a higher priority than default path");
 
+/*
+ * Blob cache for images loaded with request_firmware_into_buf(), i.e.
+ * PIL segments. Every subsystem restart loads the same images again, so
+ * keeping a copy in memory saves going to the filesystem (which may be
+ * slow or busy at that point) on recovery. Images are kept up to a total
+ * of 'blob_cache_kb', least recently used ones are dropped first; the
+ * cache is off by default. Images updated on disk are not noticed while
+ * cached, setting 'blob_cache_kb' to 0 drops everything.
+ */
+struct fw_blob {
+	struct list_head list;
+	size_t size;
+	void *data;
+	char name[];
+};
+
+static unsigned int fw_blob_cache_kb;
+module_param_named(blob_cache_kb, fw_blob_cache_kb, uint, 0644);
+MODULE_PARM_DESC(blob_cache_kb, "size limit in KB of the in-memory cache for request_firmware_into_buf() images, 0 disables it");
+
+static LIST_HEAD(fw_blob_list);
+static DEFINE_MUTEX(fw_blob_lock);
+static size_t fw_blob_bytes;
+
+/* Make room for @extra bytes, called with fw_blob_lock held */
+static void fw_blob_cache_trim(size_t extra)
+{
+	size_t limit = (size_t)ACCESS_ONCE(fw_blob_cache_kb) * SZ_1K;
+	struct fw_blob *blob;
+
+	while (!list_empty(&fw_blob_list) && fw_blob_bytes + extra > limit) {
+		blob = list_last_entry(&fw_blob_list, struct fw_blob, list);
+		list_del(&blob->list);
+		fw_blob_bytes -= blob->size;
+		vfree(blob->data);
+		kfree(blob);
+	}
+}
+
+static int fw_blob_cache_copy(struct firmware_buf *fw_buf)
+{
+	struct fw_blob *blob;
+	void *buf;
+	int rc = -ENOENT;
+
+	mutex_lock(&fw_blob_lock);
+	fw_blob_cache_trim(0);
+	list_for_each_entry(blob, &fw_blob_list, list) {
+		if (strcmp(blob->name, fw_buf->fw_id))
+			continue;
+
+		if (fw_buf->dest_size < blob->size) {
+			rc = -EINVAL;
+			break;
+		}
+
+		buf = fw_buf->map_fw_mem(fw_buf->dest_addr, fw_buf->dest_size,
+					 fw_buf->map_data);
+		if (!buf) {
+			rc = -ENOMEM;
+			break;
+		}
+		memcpy(buf, blob->data, blob->size);
+		fw_buf->data = buf;
+		fw_buf->size = blob->size;
+		fw_buf->unmap_fw_mem(buf, fw_buf->size, fw_buf->map_data);
+
+		list_move(&blob->list, &fw_blob_list);
+		rc = 0;
+		break;
+	}
+	mutex_unlock(&fw_blob_lock);
+
+	return rc;
+}
+
+/*
+ * Read the image into a new cache entry and copy it to the destination
+ * from there. Returns -ENOMEM if the entry could not be allocated, the
+ * caller then reads straight into the destination instead.
+ */
+static int fw_blob_cache_read(struct file *file, struct firmware_buf *fw_buf,
+			      int size)
+{
+	struct fw_blob *blob;
+	void *buf;
+	int rc;
+
+	if ((size_t)size > (size_t)ACCESS_ONCE(fw_blob_cache_kb) * SZ_1K)
+		return -ENOMEM;
+
+	blob = kmalloc(sizeof(*blob) + strlen(fw_buf->fw_id) + 1, GFP_KERNEL);
+	if (!blob)
+		return -ENOMEM;
+
+	blob->data = vmalloc(size);
+	if (!blob->data) {
+		kfree(blob);
+		return -ENOMEM;
+	}
+	blob->size = size;
+	strcpy(blob->name, fw_buf->fw_id);
+
+	rc = kernel_read(file, 0, blob->data, size);
+	if (rc != size) {
+		if (rc > 0)
+			rc = -EIO;
+		goto fail;
+	}
+	rc = security_kernel_fw_from_file(file, blob->data, size);
+	if (rc)
+		goto fail;
+
+	buf = fw_buf->map_fw_mem(fw_buf->dest_addr, fw_buf->dest_size,
+				 fw_buf->map_data);
+	if (!buf) {
+		rc = -ENOMEM;
+		goto fail;
+	}
+	memcpy(buf, blob->data, size);
+	fw_buf->data = buf;
+	fw_buf->size = size;
+	fw_buf->unmap_fw_mem(buf, fw_buf->size, fw_buf->map_data);
+
+	mutex_lock(&fw_blob_lock);
+	fw_blob_cache_trim(size);
+	list_add(&blob->list, &fw_blob_list);
+	fw_blob_bytes += size;
+	mutex_unlock(&fw_blob_lock);
+
+	return 0;
+fail:
+	vfree(blob->data);
+	kfree(blob);
+	return rc;
+}
+
 static int fw_read_file_contents(struct file *file, struct firmware_buf *fw_buf)
 {
 	int size;
@@ -330,6 +468,12 @@ static int fw_read_file_contents(struct file *file, struct firmware_buf *fw_buf)
 	if (fw_buf->dest_size > 0 && fw_buf->dest_size < size)
 		return -EINVAL;
 
+	if (fw_buf->dest_addr && fw_blob_cache_kb) {
+		rc = fw_blob_cache_read(file, fw_buf, size);
+		if (rc != -ENOMEM)
+			return rc;
+	}
+
 	if (fw_buf->dest_addr)
 		buf = fw_buf->map_fw_mem(fw_buf->dest_addr,
 					   fw_buf->dest_size, fw_buf->map_data);
@@ -365,7 +509,16 @@ static int fw_get_filesystem_firmware(struct device *device,
 {
 	int i;
 	int rc = -ENOENT;
-	char *path = __getname();
+	char *path;
+
+	if (dest_addr && fw_blob_cache_kb && !fw_blob_cache_copy(buf)) {
+		dev_dbg(device, "firmware: loaded %s from blob cache\n",
+			buf->fw_id);
+		rc = 0;
+		goto done;
+	}
+
+	path = __getname();
 	if (!path)
 		return false;
 
@@ -391,6 +544,7 @@ static int fw_get_filesystem_firmware(struct device *device,
 	}
 	__putname(path);
 
+done:
 	if (!rc) {
 		dev_dbg(device, "firmware: direct-loading firmware %s\n",
 			buf->fw_id);
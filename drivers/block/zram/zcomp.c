@@ -13,12 +13,17 @@
 #include <linux/slab.h>
 #include <linux/wait.h>
 #include <linux/sched.h>
+#include <linux/percpu.h>
+#include <linux/cpumask.h>
 
 #include "zcomp.h"
 #include "zcomp_lzo.h"
 #ifdef CONFIG_ZRAM_LZ4_COMPRESS
 #include "zcomp_lz4.h"
 #endif
+#ifdef CONFIG_ZRAM_LZ4HC_COMPRESS
+#include "zcomp_lz4hc.h"
+#endif
 
 /*
  * single zcomp_strm backend
@@ -43,10 +48,20 @@ struct zcomp_strm_multi {
 	wait_queue_head_t strm_wait;
 };
 
+/*
+ * per-cpu zcomp_strm backend
+ */
+struct zcomp_strm_percpu {
+	struct zcomp_strm * __percpu *strm;
+};
+
 static struct zcomp_backend *backends[] = {
 	&zcomp_lzo,
 #ifdef CONFIG_ZRAM_LZ4_COMPRESS
 	&zcomp_lz4,
+#endif
+#ifdef CONFIG_ZRAM_LZ4HC_COMPRESS
+	&zcomp_lz4hc,
 #endif
 	NULL
 };
@@ -226,6 +241,83 @@ static int zcomp_strm_multi_create(struct zcomp *comp, int max_strm)
 	return 0;
 }
 
+/*
+ * get this CPU's zcomp_strm; preemption stays disabled until
+ * zcomp_strm_release(), so the caller must not sleep in between
+ */
+static struct zcomp_strm *zcomp_strm_percpu_find(struct zcomp *comp)
+{
+	struct zcomp_strm_percpu *zs = comp->stream;
+
+	return *get_cpu_ptr(zs->strm);
+}
+
+static void zcomp_strm_percpu_release(struct zcomp *comp,
+		struct zcomp_strm *zstrm)
+{
+	struct zcomp_strm_percpu *zs = comp->stream;
+
+	put_cpu_ptr(zs->strm);
+}
+
+static bool zcomp_strm_percpu_set_max_streams(struct zcomp *comp,
+		int num_strm)
+{
+	/* there is exactly one stream per possible cpu */
+	return num_strm >= num_possible_cpus();
+}
+
+static void zcomp_strm_percpu_destroy(struct zcomp *comp)
+{
+	struct zcomp_strm_percpu *zs = comp->stream;
+	struct zcomp_strm *zstrm;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		zstrm = *per_cpu_ptr(zs->strm, cpu);
+		if (zstrm)
+			zcomp_strm_free(comp, zstrm);
+	}
+	free_percpu(zs->strm);
+	kfree(zs);
+}
+
+static int zcomp_strm_percpu_create(struct zcomp *comp)
+{
+	struct zcomp_strm_percpu *zs;
+	struct zcomp_strm *zstrm;
+	int cpu;
+
+	comp->destroy = zcomp_strm_percpu_destroy;
+	comp->strm_find = zcomp_strm_percpu_find;
+	comp->strm_release = zcomp_strm_percpu_release;
+	comp->set_max_streams = zcomp_strm_percpu_set_max_streams;
+	zs = kmalloc(sizeof(struct zcomp_strm_percpu), GFP_KERNEL);
+	if (!zs)
+		return -ENOMEM;
+
+	comp->stream = zs;
+	zs->strm = alloc_percpu(struct zcomp_strm *);
+	if (!zs->strm) {
+		kfree(zs);
+		return -ENOMEM;
+	}
+
+	/*
+	 * Streams of offline cpus are allocated as well, so that cpu
+	 * hotplug never has to allocate memory on the swapout path.
+	 */
+	for_each_possible_cpu(cpu) {
+		zstrm = zcomp_strm_alloc(comp, GFP_KERNEL);
+		if (!zstrm) {
+			zcomp_strm_percpu_destroy(comp);
+			return -ENOMEM;
+		}
+		*per_cpu_ptr(zs->strm, cpu) = zstrm;
+	}
+	return 0;
+}
+
 static struct zcomp_strm *zcomp_strm_single_find(struct zcomp *comp)
 {
 	struct zcomp_strm_single *zs = comp->stream;
@@ -334,7 +426,10 @@ void zcomp_destroy(struct zcomp *comp)
  * backend pointer or ERR_PTR if things went bad. ERR_PTR(-EINVAL)
  * if requested algorithm is not supported, ERR_PTR(-ENOMEM) in
  * case of allocation error, or any other error potentially
- * returned by functions zcomp_strm_{multi,single}_create.
+ * returned by functions zcomp_strm_{percpu,multi,single}_create.
+ *
+ * A device that asks for at least one stream per possible cpu gets
+ * per-cpu streams, which need neither a lock nor a wait queue.
  */
 struct zcomp *zcomp_create(const char *compress, int max_strm)
 {
@@ -351,7 +446,9 @@ struct zcomp *zcomp_create(const char *compress, int max_strm)
 		return ERR_PTR(-ENOMEM);
 
 	comp->backend = backend;
-	if (max_strm > 1)
+	if (max_strm > 1 && max_strm >= num_possible_cpus())
+		error = zcomp_strm_percpu_create(comp);
+	else if (max_strm > 1)
 		error = zcomp_strm_multi_create(comp, max_strm);
 	else
 		error = zcomp_strm_single_create(comp);
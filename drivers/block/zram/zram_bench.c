@@ -0,0 +1,175 @@
+/*
+ * Compression benchmarks for the zram backends
+ *
+ * Registers a compress and a decompress benchmark per compiled-in zcomp
+ * backend with the MSM benchmark framework. Each iteration handles one
+ * page, as zram does, of a fixed mix of random and repetitive data that
+ * compresses roughly as well as typical anonymous memory does, so runs
+ * are comparable across kernels.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#define KMSG_COMPONENT "zram"
+#define pr_fmt(fmt) KMSG_COMPONENT ": " fmt
+
+#include <linux/err.h>
+#include <linux/kernel.h>
+#include <linux/random.h>
+#include <linux/slab.h>
+#include <soc/qcom/msm_bench.h>
+
+#include "zcomp.h"
+#include "zram_drv.h"
+
+struct zram_bench {
+	struct msm_bench bench;
+	const char *comp_name;
+	bool decompress;
+	char name[32];
+
+	struct zcomp *comp;
+	unsigned char *src;
+	unsigned char *dst;
+	size_t clen;
+};
+
+static const char * const zram_bench_comps[] = {
+	"lzo",
+#ifdef CONFIG_ZRAM_LZ4_COMPRESS
+	"lz4",
+#endif
+#ifdef CONFIG_ZRAM_LZ4HC_COMPRESS
+	"lz4hc",
+#endif
+};
+
+static struct zram_bench *zram_benches;
+
+/* A quarter random bytes, the rest a repeating pattern with zero runs */
+static void zram_bench_fill(unsigned char *buf)
+{
+	struct rnd_state rnd;
+	int i;
+
+	prandom_seed_state(&rnd, 0x7a72616d);
+	for (i = 0; i < PAGE_SIZE / 4; i++)
+		buf[i] = prandom_u32_state(&rnd);
+	for (; i < PAGE_SIZE; i++)
+		buf[i] = (i & 64) ? 0 : (unsigned char)(i % 23);
+}
+
+static int zram_bench_compress(struct zram_bench *zb, size_t *clen)
+{
+	struct zcomp_strm *zstrm;
+	int ret;
+
+	zstrm = zcomp_strm_find(zb->comp);
+	ret = zcomp_compress(zb->comp, zstrm, zb->src, clen);
+	if (!ret && zb->decompress && *clen <= PAGE_SIZE)
+		memcpy(zb->dst, zstrm->buffer, *clen);
+	zcomp_strm_release(zb->comp, zstrm);
+
+	return ret;
+}
+
+static int zram_bench_setup(struct msm_bench *bench)
+{
+	struct zram_bench *zb = bench->priv;
+	int ret;
+
+	zb->comp = zcomp_create(zb->comp_name, 1);
+	if (IS_ERR(zb->comp))
+		return PTR_ERR(zb->comp);
+
+	zb->src = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	zb->dst = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	if (!zb->src || !zb->dst) {
+		ret = -ENOMEM;
+		goto err;
+	}
+	zram_bench_fill(zb->src);
+
+	/* Decompression runs on the compressed form of the same page */
+	if (zb->decompress) {
+		ret = zram_bench_compress(zb, &zb->clen);
+		if (ret)
+			goto err;
+		if (zb->clen > PAGE_SIZE) {
+			ret = -EINVAL;
+			goto err;
+		}
+		memcpy(zb->src, zb->dst, zb->clen);
+	}
+
+	return 0;
+
+err:
+	kfree(zb->dst);
+	kfree(zb->src);
+	zcomp_destroy(zb->comp);
+	return ret;
+}
+
+static int zram_bench_run(struct msm_bench *bench)
+{
+	struct zram_bench *zb = bench->priv;
+	size_t clen;
+
+	if (zb->decompress)
+		return zcomp_decompress(zb->comp, zb->src, zb->clen, zb->dst);
+
+	return zram_bench_compress(zb, &clen);
+}
+
+static void zram_bench_teardown(struct msm_bench *bench)
+{
+	struct zram_bench *zb = bench->priv;
+
+	kfree(zb->dst);
+	kfree(zb->src);
+	zcomp_destroy(zb->comp);
+}
+
+void zram_bench_init(void)
+{
+	int i, n = 2 * ARRAY_SIZE(zram_bench_comps);
+
+	zram_benches = kcalloc(n, sizeof(*zram_benches), GFP_KERNEL);
+	if (!zram_benches)
+		return;
+
+	for (i = 0; i < n; i++) {
+		struct zram_bench *zb = &zram_benches[i];
+
+		zb->comp_name = zram_bench_comps[i / 2];
+		zb->decompress = i & 1;
+		snprintf(zb->name, sizeof(zb->name), "zram_%s_%s",
+			 zb->comp_name, zb->decompress ? "decomp" : "comp");
+
+		zb->bench.name = zb->name;
+		zb->bench.bytes = PAGE_SIZE;
+		zb->bench.setup = zram_bench_setup;
+		zb->bench.run = zram_bench_run;
+		zb->bench.teardown = zram_bench_teardown;
+		zb->bench.priv = zb;
+		msm_bench_register(&zb->bench);
+	}
+}
+
+void zram_bench_exit(void)
+{
+	int i;
+
+	if (!zram_benches)
+		return;
+
+	for (i = 0; i < 2 * ARRAY_SIZE(zram_bench_comps); i++)
+		msm_bench_unregister(&zram_benches[i].bench);
+
+	kfree(zram_benches);
+	zram_benches = NULL;
+}
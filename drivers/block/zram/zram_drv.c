@@ -34,6 +34,8 @@
 #include <linux/err.h>
 #include <linux/show_mem_notifier.h>
 #include <linux/ratelimit.h>
+#include <linux/file.h>
+#include <linux/fs.h>
 
 #include "zram_drv.h"
 
@@ -177,6 +179,16 @@ static ssize_t orig_data_size_show(struct device *dev,
 		(u64)(atomic64_read(&zram->stats.pages_stored)) << PAGE_SHIFT);
 }
 
+static ssize_t zero_pages_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	deprecated_attr_warn("zero_pages");
+	return scnprintf(buf, PAGE_SIZE, "%llu\n",
+		(u64)atomic64_read(&zram->stats.same_pages));
+}
+
 static ssize_t mem_used_total_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
@@ -394,6 +406,294 @@ static inline int valid_io_request(struct zram *zram,
 	return 1;
 }
 
+#ifdef CONFIG_ZRAM_WRITEBACK
+static void reset_bdev(struct zram *zram)
+{
+	struct block_device *bdev;
+
+	if (!zram->backing_dev)
+		return;
+
+	bdev = zram->bdev;
+	/* hope filp_close flush all of IO */
+	set_blocksize(bdev, zram->old_block_size);
+	blkdev_put(bdev, FMODE_READ|FMODE_WRITE|FMODE_EXCL);
+	filp_close(zram->backing_dev, NULL);
+	zram->backing_dev = NULL;
+	zram->old_block_size = 0;
+	zram->bdev = NULL;
+
+	vfree(zram->bitmap);
+	zram->bitmap = NULL;
+	zram->nr_pages = 0;
+}
+
+static ssize_t backing_dev_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	struct file *file;
+	char *p;
+	ssize_t ret;
+
+	down_read(&zram->init_lock);
+	file = zram->backing_dev;
+	if (!file) {
+		memcpy(buf, "none\n", 5);
+		up_read(&zram->init_lock);
+		return 5;
+	}
+
+	p = d_path(&file->f_path, buf, PAGE_SIZE - 1);
+	if (IS_ERR(p)) {
+		ret = PTR_ERR(p);
+		goto out;
+	}
+
+	ret = strlen(p);
+	memmove(buf, p, ret);
+	buf[ret++] = '\n';
+out:
+	up_read(&zram->init_lock);
+	return ret;
+}
+
+static ssize_t backing_dev_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	char *file_name;
+	size_t sz;
+	struct file *backing_dev = NULL;
+	struct inode *inode;
+	struct address_space *mapping;
+	unsigned int bitmap_sz, old_block_size = 0;
+	unsigned long nr_pages, *bitmap = NULL;
+	struct block_device *bdev = NULL;
+	int err;
+	struct zram *zram = dev_to_zram(dev);
+
+	file_name = kmalloc(PATH_MAX, GFP_KERNEL);
+	if (!file_name)
+		return -ENOMEM;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		pr_info("Can't setup backing device for initialized device\n");
+		err = -EBUSY;
+		goto out;
+	}
+
+	strlcpy(file_name, buf, PATH_MAX);
+	/* ignore trailing newline */
+	sz = strlen(file_name);
+	if (sz > 0 && file_name[sz - 1] == '\n')
+		file_name[sz - 1] = 0x00;
+
+	backing_dev = filp_open(file_name, O_RDWR|O_LARGEFILE, 0);
+	if (IS_ERR(backing_dev)) {
+		err = PTR_ERR(backing_dev);
+		backing_dev = NULL;
+		goto out;
+	}
+
+	mapping = backing_dev->f_mapping;
+	inode = mapping->host;
+
+	/* Support only block device in this moment */
+	if (!S_ISBLK(inode->i_mode)) {
+		err = -ENOTBLK;
+		goto out;
+	}
+
+	bdev = bdgrab(I_BDEV(inode));
+	err = blkdev_get(bdev, FMODE_READ | FMODE_WRITE | FMODE_EXCL, zram);
+	if (err < 0) {
+		bdev = NULL;
+		goto out;
+	}
+
+	nr_pages = i_size_read(inode) >> PAGE_SHIFT;
+	bitmap_sz = BITS_TO_LONGS(nr_pages) * sizeof(long);
+	bitmap = vzalloc(bitmap_sz);
+	if (!bitmap) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	old_block_size = block_size(bdev);
+	err = set_blocksize(bdev, PAGE_SIZE);
+	if (err)
+		goto out;
+
+	reset_bdev(zram);
+
+	zram->old_block_size = old_block_size;
+	zram->bdev = bdev;
+	zram->backing_dev = backing_dev;
+	zram->bitmap = bitmap;
+	zram->nr_pages = nr_pages;
+	up_write(&zram->init_lock);
+
+	pr_info("setup backing device %s\n", file_name);
+	kfree(file_name);
+
+	return len;
+out:
+	vfree(bitmap);
+
+	if (bdev)
+		blkdev_put(bdev, FMODE_READ | FMODE_WRITE | FMODE_EXCL);
+
+	if (backing_dev)
+		filp_close(backing_dev, NULL);
+
+	up_write(&zram->init_lock);
+
+	kfree(file_name);
+
+	return err;
+}
+
+static unsigned long alloc_block_bdev(struct zram *zram)
+{
+	unsigned long blk_idx = 1;
+retry:
+	/* skip 0 bit to confuse zram.handle = 0 */
+	blk_idx = find_next_zero_bit(zram->bitmap, zram->nr_pages, blk_idx);
+	if (blk_idx == zram->nr_pages)
+		return 0;
+
+	if (test_and_set_bit(blk_idx, zram->bitmap))
+		goto retry;
+
+	atomic64_inc(&zram->stats.bd_count);
+	return blk_idx;
+}
+
+static void free_block_bdev(struct zram *zram, unsigned long blk_idx)
+{
+	int was_set;
+
+	was_set = test_and_clear_bit(blk_idx, zram->bitmap);
+	WARN_ON_ONCE(!was_set);
+	atomic64_dec(&zram->stats.bd_count);
+}
+
+/*
+ * Read a page from the backing device without waiting for it: the bio is
+ * chained to @parent, which completes once the read has finished.
+ */
+static int read_from_bdev_async(struct zram *zram, struct bio_vec *bvec,
+			unsigned long entry, struct bio *parent)
+{
+	struct bio *bio;
+
+	bio = bio_alloc(GFP_NOIO, 1);
+	if (!bio)
+		return -ENOMEM;
+
+	bio->bi_iter.bi_sector = entry * (PAGE_SIZE >> 9);
+	bio->bi_bdev = zram->bdev;
+	if (!bio_add_page(bio, bvec->bv_page, bvec->bv_len, bvec->bv_offset)) {
+		bio_put(bio);
+		return -EIO;
+	}
+
+	bio_chain(bio, parent);
+	submit_bio(READ, bio);
+	return 1;
+}
+
+static int read_from_bdev_sync(struct zram *zram, struct page *page,
+			unsigned long entry)
+{
+	struct bio *bio;
+	int ret;
+
+	bio = bio_alloc(GFP_NOIO, 1);
+	if (!bio)
+		return -ENOMEM;
+
+	bio->bi_iter.bi_sector = entry * (PAGE_SIZE >> 9);
+	bio->bi_bdev = zram->bdev;
+	if (!bio_add_page(bio, page, PAGE_SIZE, 0)) {
+		bio_put(bio);
+		return -EIO;
+	}
+
+	ret = submit_bio_wait(READ, bio);
+	bio_put(bio);
+	return ret;
+}
+
+/*
+ * Fill @mem with the content of backing device block @entry. @mem is
+ * a kernel buffer so go through a bounce page.
+ */
+static int read_from_bdev_mem(struct zram *zram, char *mem,
+			unsigned long entry)
+{
+	struct page *page;
+	void *src;
+	int ret;
+
+	page = alloc_page(GFP_NOIO);
+	if (!page)
+		return -ENOMEM;
+
+	ret = read_from_bdev_sync(zram, page, entry);
+	if (!ret) {
+		src = kmap_atomic(page);
+		memcpy(mem, src, PAGE_SIZE);
+		kunmap_atomic(src);
+	}
+	__free_page(page);
+	return ret;
+}
+
+static int read_from_bdev(struct zram *zram, struct bio_vec *bvec,
+			unsigned long entry, int offset, struct bio *parent)
+{
+	void *dst;
+	char *uncmem;
+	int ret;
+
+	atomic64_inc(&zram->stats.bd_reads);
+	if (!is_partial_io(bvec)) {
+		if (parent)
+			return read_from_bdev_async(zram, bvec, entry, parent);
+
+		ret = read_from_bdev_sync(zram, bvec->bv_page, entry);
+		if (!ret)
+			flush_dcache_page(bvec->bv_page);
+		return ret;
+	}
+
+	uncmem = kmalloc(PAGE_SIZE, GFP_NOIO);
+	if (!uncmem)
+		return -ENOMEM;
+
+	ret = read_from_bdev_mem(zram, uncmem, entry);
+	if (!ret) {
+		dst = kmap_atomic(bvec->bv_page);
+		memcpy(dst + bvec->bv_offset, uncmem + offset, bvec->bv_len);
+		kunmap_atomic(dst);
+		flush_dcache_page(bvec->bv_page);
+	}
+	kfree(uncmem);
+	return ret;
+}
+#else
+static inline void reset_bdev(struct zram *zram) {};
+static inline void free_block_bdev(struct zram *zram,
+			unsigned long blk_idx) {};
+static inline int read_from_bdev_mem(struct zram *zram, char *mem,
+			unsigned long entry)
+{
+	return -EIO;
+}
+#endif
+
 static void zram_meta_free(struct zram_meta *meta, u64 disksize)
 {
 	size_t num_pages = disksize >> PAGE_SHIFT;
@@ -403,7 +703,12 @@ static void zram_meta_free(struct zram_meta *meta, u64 disksize)
 	for (index = 0; index < num_pages; index++) {
 		unsigned long handle = meta->table[index].handle;
 
-		if (!handle)
+		/*
+		 * No memory is allocated for same element filled pages and
+		 * the handle of written back pages is a backing device block.
+		 */
+		if (!handle || zram_test_flag(meta, index, ZRAM_SAME) ||
+		    zram_test_flag(meta, index, ZRAM_WB))
 			continue;
 
 		zs_free(meta->mem_pool, handle);
@@ -431,7 +736,7 @@ static struct zram_meta *zram_meta_alloc(int device_id, u64 disksize)
 	}
 
 	snprintf(pool_name, sizeof(pool_name), "zram%d", device_id);
-	meta->mem_pool = zs_create_pool(pool_name, GFP_NOIO | __GFP_HIGHMEM);
+	meta->mem_pool = zs_create_pool(pool_name);
 	if (!meta->mem_pool) {
 		pr_err("Error creating memory pool\n");
 		goto out_error;
@@ -464,22 +769,49 @@ static void update_position(u32 *index, int *offset, struct bio_vec *bvec)
 	*offset = (*offset + bvec->bv_len) % PAGE_SIZE;
 }
 
-static int page_zero_filled(void *ptr)
+static bool page_same_filled(void *ptr, unsigned long *element)
 {
 	unsigned int pos;
 	unsigned long *page;
+	unsigned long val;
 
 	page = (unsigned long *)ptr;
+	val = page[0];
 
-	for (pos = 0; pos != PAGE_SIZE / sizeof(*page); pos++) {
-		if (page[pos])
-			return 0;
+	/* most mismatches show up at the end of the page, check it first */
+	if (val != page[PAGE_SIZE / sizeof(*page) - 1])
+		return false;
+
+	for (pos = 1; pos < PAGE_SIZE / sizeof(*page) - 1; pos++) {
+		if (val != page[pos])
+			return false;
 	}
 
-	return 1;
+	*element = val;
+	return true;
 }
 
-static void handle_zero_page(struct bio_vec *bvec)
+static void zram_fill_page(void *ptr, unsigned long len,
+			unsigned long value)
+{
+	unsigned long *page = ptr;
+	unsigned long pos;
+
+	WARN_ON_ONCE(!IS_ALIGNED(len, sizeof(unsigned long)));
+	if (!value) {
+		memset(ptr, 0, len);
+		return;
+	}
+
+	for (pos = 0; pos < len / sizeof(*page); pos++)
+		page[pos] = value;
+}
+
+/*
+ * A partial read of a non-zero pattern may start at any byte of the
+ * pattern, so the caller only uses this for full pages or zeroes.
+ */
+static void handle_same_page(struct bio_vec *bvec, unsigned long element)
 {
 	struct page *page = bvec->bv_page;
 	void *user_mem;
@@ -488,7 +820,7 @@ static void handle_zero_page(struct bio_vec *bvec)
 	if (is_partial_io(bvec))
 		memset(user_mem + bvec->bv_offset, 0, bvec->bv_len);
 	else
-		clear_page(user_mem);
+		zram_fill_page(user_mem, PAGE_SIZE, element);
 	kunmap_atomic(user_mem);
 
 	flush_dcache_page(page);
@@ -505,18 +837,34 @@ static void zram_free_page(struct zram *zram, size_t index)
 	struct zram_meta *meta = zram->meta;
 	unsigned long handle = meta->table[index].handle;
 
-	if (unlikely(!handle)) {
-		/*
-		 * No memory is allocated for zero filled pages.
-		 * Simply clear zero page flag.
-		 */
-		if (zram_test_flag(meta, index, ZRAM_ZERO)) {
-			zram_clear_flag(meta, index, ZRAM_ZERO);
-			atomic64_dec(&zram->stats.zero_pages);
-		}
+	zram_clear_flag(meta, index, ZRAM_IDLE);
+	zram_clear_flag(meta, index, ZRAM_HUGE);
+	zram_clear_flag(meta, index, ZRAM_UNDER_WB);
+	zram_clear_flag(meta, index, ZRAM_RECOMP);
+	zram_clear_flag(meta, index, ZRAM_UNDER_RECOMP);
+	zram_clear_flag(meta, index, ZRAM_INCOMPRESSIBLE);
+
+	if (zram_test_flag(meta, index, ZRAM_WB)) {
+		zram_clear_flag(meta, index, ZRAM_WB);
+		free_block_bdev(zram, handle);
+		meta->table[index].handle = 0;
+		return;
+	}
+
+	/*
+	 * No memory is allocated for same element filled pages.
+	 * Simply clear same page flag.
+	 */
+	if (zram_test_flag(meta, index, ZRAM_SAME)) {
+		zram_clear_flag(meta, index, ZRAM_SAME);
+		meta->table[index].element = 0;
+		atomic64_dec(&zram->stats.same_pages);
 		return;
 	}
 
+	if (unlikely(!handle))
+		return;
+
 	zs_free(meta->mem_pool, handle);
 
 	atomic64_sub(zram_get_obj_size(meta, index),
@@ -532,6 +880,7 @@ static int zram_decompress_page(struct zram *zram, char *mem, u32 index)
 	int ret = 0;
 	unsigned char *cmem;
 	struct zram_meta *meta = zram->meta;
+	struct zcomp *comp;
 	unsigned long handle;
 	size_t size;
 
@@ -539,17 +888,33 @@ static int zram_decompress_page(struct zram *zram, char *mem, u32 index)
 	handle = meta->table[index].handle;
 	size = zram_get_obj_size(meta, index);
 
-	if (!handle || zram_test_flag(meta, index, ZRAM_ZERO)) {
+	if (zram_test_flag(meta, index, ZRAM_WB)) {
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+		ret = read_from_bdev_mem(zram, mem, handle);
+		if (unlikely(ret))
+			pr_err("Backing device read failed! err=%d, page=%u\n",
+				ret, index);
+		return ret;
+	}
+
+	if (!handle || zram_test_flag(meta, index, ZRAM_SAME)) {
+		unsigned long element = meta->table[index].element;
+
 		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
-		memset(mem, 0, PAGE_SIZE);
+		zram_fill_page(mem, PAGE_SIZE, element);
 		return 0;
 	}
 
+	comp = zram->comp;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram_test_flag(meta, index, ZRAM_RECOMP))
+		comp = zram->recomp;
+#endif
 	cmem = zs_map_object(meta->mem_pool, handle, ZS_MM_RO);
 	if (size == PAGE_SIZE)
 		memcpy(mem, cmem, PAGE_SIZE);
 	else
-		ret = zcomp_decompress(zram->comp, cmem, size, mem);
+		ret = zcomp_decompress(comp, cmem, size, mem);
 	zs_unmap_object(meta->mem_pool, handle);
 	bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
 
@@ -563,7 +928,7 @@ static int zram_decompress_page(struct zram *zram, char *mem, u32 index)
 }
 
 static int zram_bvec_read(struct zram *zram, struct bio_vec *bvec,
-			  u32 index, int offset)
+			  u32 index, int offset, struct bio *bio)
 {
 	int ret;
 	struct page *page;
@@ -572,11 +937,26 @@ static int zram_bvec_read(struct zram *zram, struct bio_vec *bvec,
 	page = bvec->bv_page;
 
 	bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
-	if (unlikely(!meta->table[index].handle) ||
-			zram_test_flag(meta, index, ZRAM_ZERO)) {
+	zram_clear_flag(meta, index, ZRAM_IDLE);
+#ifdef CONFIG_ZRAM_WRITEBACK
+	if (zram_test_flag(meta, index, ZRAM_WB)) {
+		unsigned long blk_idx = meta->table[index].handle;
+
 		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
-		handle_zero_page(bvec);
-		return 0;
+		return read_from_bdev(zram, bvec, blk_idx, offset, bio);
+	}
+#endif
+	if (unlikely(!meta->table[index].handle) ||
+			zram_test_flag(meta, index, ZRAM_SAME)) {
+		unsigned long element = meta->table[index].element;
+
+		if (!element || !is_partial_io(bvec)) {
+			bit_spin_unlock(ZRAM_ACCESS,
+					&meta->table[index].value);
+			handle_same_page(bvec, element);
+			return 0;
+		}
+		/* partial read of a pattern goes through zram_decompress_page */
 	}
 	bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
 
@@ -627,22 +1007,87 @@ static inline void update_used_max(struct zram *zram,
 	} while (old_max != cur_max);
 }
 
+/*
+ * Upper bound on the pages compressed back to back under one stream: a
+ * per-cpu stream keeps preemption disabled while it is held.
+ */
+#define ZRAM_WRITE_BATCH_PAGES	16
+
+/*
+ * State kept across the pages of one multi-page write bio, so that they
+ * share a compression stream and the request counters are updated once
+ * per bio. The size/page counters stay per page as zram_free_page()
+ * updates them concurrently.
+ */
+struct zram_write_batch {
+	struct zcomp_strm *zstrm;
+	unsigned int nr_held;
+	u64 num_writes;
+	u64 failed_writes;
+};
+
+static struct zcomp_strm *zram_strm_get(struct zram *zram,
+					struct zram_write_batch *wb)
+{
+	if (wb && wb->zstrm)
+		return wb->zstrm;
+
+	return zcomp_strm_find(zram->comp);
+}
+
+/*
+ * Hand the stream back for the next page of the batch, or really
+ * release it when there is no batch, the batch is long enough or the
+ * caller is about to sleep.
+ */
+static void zram_strm_put(struct zram *zram, struct zram_write_batch *wb,
+			  struct zcomp_strm *zstrm, bool may_sleep)
+{
+	if (wb) {
+		if (!may_sleep && ++wb->nr_held < ZRAM_WRITE_BATCH_PAGES) {
+			wb->zstrm = zstrm;
+			return;
+		}
+		wb->zstrm = NULL;
+		wb->nr_held = 0;
+	}
+
+	zcomp_strm_release(zram->comp, zstrm);
+}
+
+static void zram_write_batch_finish(struct zram *zram,
+				    struct zram_write_batch *wb)
+{
+	if (wb->zstrm)
+		zram_strm_put(zram, wb, wb->zstrm, true);
+
+	atomic64_add(wb->num_writes, &zram->stats.num_writes);
+	if (wb->failed_writes)
+		atomic64_add(wb->failed_writes, &zram->stats.failed_writes);
+}
+
 static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
-			   int offset)
+			   int offset, struct zram_write_batch *wb)
 {
 	int ret = 0;
 	size_t clen;
-	unsigned long handle;
 	struct page *page;
 	unsigned char *user_mem, *cmem, *src, *uncmem = NULL;
 	struct zram_meta *meta = zram->meta;
 	struct zcomp_strm *zstrm;
 	bool locked = false;
 	unsigned long alloced_pages;
+	unsigned long handle = 0;
+	size_t handle_len = 0;
+	unsigned long element;
 	static unsigned long zram_rs_time;
 
 	page = bvec->bv_page;
 	if (is_partial_io(bvec)) {
+		/* the allocation below may sleep */
+		if (wb && wb->zstrm)
+			zram_strm_put(zram, wb, wb->zstrm, true);
+
 		/*
 		 * This is a partial IO. We need to read the full page
 		 * before to write the changes.
@@ -657,7 +1102,8 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 			goto out;
 	}
 
-	zstrm = zcomp_strm_find(zram->comp);
+compress_again:
+	zstrm = zram_strm_get(zram, wb);
 	locked = true;
 	user_mem = kmap_atomic(page);
 
@@ -670,16 +1116,19 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 		uncmem = user_mem;
 	}
 
-	if (page_zero_filled(uncmem)) {
+	if (page_same_filled(uncmem, &element)) {
 		if (user_mem)
 			kunmap_atomic(user_mem);
+		if (handle)
+			zs_free(meta->mem_pool, handle);
 		/* Free memory associated with this sector now. */
 		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
 		zram_free_page(zram, index);
-		zram_set_flag(meta, index, ZRAM_ZERO);
+		zram_set_flag(meta, index, ZRAM_SAME);
+		meta->table[index].element = element;
 		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
 
-		atomic64_inc(&zram->stats.zero_pages);
+		atomic64_inc(&zram->stats.same_pages);
 		ret = 0;
 		goto out;
 	}
@@ -693,6 +1142,8 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 
 	if (unlikely(ret)) {
 		pr_err("Compression failed! err=%d\n", ret);
+		if (handle)
+			zs_free(meta->mem_pool, handle);
 		goto out;
 	}
 	src = zstrm->buffer;
@@ -702,8 +1153,32 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 			src = uncmem;
 	}
 
-	handle = zs_malloc(meta->mem_pool, clen);
+	/*
+	 * handle allocation has 2 paths:
+	 * a) fast path is executed with the compression stream held (and
+	 *  preemption disabled for per-cpu streams) and must not sleep;
+	 * b) slow path puts the stream and allocates with GFP_NOIO. The
+	 *  stream's buffer may be reused meanwhile, so the page has to be
+	 *  compressed again once the handle is allocated.
+	 */
+	if (handle && handle_len != clen) {
+		/* page content changed under us, size the handle again */
+		zs_free(meta->mem_pool, handle);
+		handle = 0;
+	}
+	if (!handle)
+		handle = zs_malloc(meta->mem_pool, clen,
+				GFP_NOWAIT | __GFP_NOWARN | __GFP_HIGHMEM);
 	if (!handle) {
+		zram_strm_put(zram, wb, zstrm, true);
+		locked = false;
+		handle = zs_malloc(meta->mem_pool, clen,
+				GFP_NOIO | __GFP_HIGHMEM);
+		if (handle) {
+			handle_len = clen;
+			goto compress_again;
+		}
+
 		if (printk_timed_ratelimit(&zram_rs_time,
 					   ALLOC_ERROR_LOG_RATE_MS))
 			pr_info("Error allocating memory for compressed page: %u, size=%zu\n",
@@ -732,7 +1207,7 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 		memcpy(cmem, src, clen);
 	}
 
-	zcomp_strm_release(zram->comp, zstrm);
+	zram_strm_put(zram, wb, zstrm, false);
 	locked = false;
 	zs_unmap_object(meta->mem_pool, handle);
 
@@ -745,6 +1220,8 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 
 	meta->table[index].handle = handle;
 	zram_set_obj_size(meta, index, clen);
+	if (clen == PAGE_SIZE)
+		zram_set_flag(meta, index, ZRAM_HUGE);
 	bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
 
 	/* Update stats */
@@ -752,28 +1229,34 @@ static int zram_bvec_write(struct zram *zram, struct bio_vec *bvec, u32 index,
 	atomic64_inc(&zram->stats.pages_stored);
 out:
 	if (locked)
-		zcomp_strm_release(zram->comp, zstrm);
+		zram_strm_put(zram, wb, zstrm, false);
 	if (is_partial_io(bvec))
 		kfree(uncmem);
 	return ret;
 }
 
 static int zram_bvec_rw(struct zram *zram, struct bio_vec *bvec, u32 index,
-			int offset, int rw)
+			int offset, int rw, struct bio *bio,
+			struct zram_write_batch *wb)
 {
 	int ret;
 
 	if (rw == READ) {
 		atomic64_inc(&zram->stats.num_reads);
-		ret = zram_bvec_read(zram, bvec, index, offset);
+		ret = zram_bvec_read(zram, bvec, index, offset, bio);
 	} else {
-		atomic64_inc(&zram->stats.num_writes);
-		ret = zram_bvec_write(zram, bvec, index, offset);
+		if (wb)
+			wb->num_writes++;
+		else
+			atomic64_inc(&zram->stats.num_writes);
+		ret = zram_bvec_write(zram, bvec, index, offset, wb);
 	}
 
-	if (unlikely(ret)) {
+	if (unlikely(ret < 0)) {
 		if (rw == READ)
 			atomic64_inc(&zram->stats.failed_reads);
+		else if (wb)
+			wb->failed_writes++;
 		else
 			atomic64_inc(&zram->stats.failed_writes);
 	}
@@ -791,6 +1274,7 @@ static void zram_bio_discard(struct zram *zram, u32 index,
 {
 	size_t n = bio->bi_iter.bi_size;
 	struct zram_meta *meta = zram->meta;
+	u64 freed = 0;
 
 	/*
 	 * zram manages data in physical block size units. Because logical block
@@ -814,17 +1298,457 @@ static void zram_bio_discard(struct zram *zram, u32 index,
 		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
 		zram_free_page(zram, index);
 		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
-		atomic64_inc(&zram->stats.notify_free);
+		freed++;
 		index++;
 		n -= PAGE_SIZE;
 	}
+
+	atomic64_add(freed, &zram->stats.notify_free);
+}
+
+#if defined(CONFIG_ZRAM_WRITEBACK) || defined(CONFIG_ZRAM_MULTI_COMP)
+static ssize_t idle_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	struct zram_meta *meta;
+	unsigned long nr_pages;
+	unsigned long index;
+	int ret = -EINVAL;
+
+	if (!sysfs_streq(buf, "all"))
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram))
+		goto out;
+
+	meta = zram->meta;
+	nr_pages = zram->disksize >> PAGE_SHIFT;
+	for (index = 0; index < nr_pages; index++) {
+		/*
+		 * Do not mark slots under writeback or recompression as
+		 * ZRAM_IDLE: writeback relies on the flag pair to notice
+		 * slots that were accessed while their I/O was in flight.
+		 */
+		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
+		if (meta->table[index].handle &&
+			!zram_test_flag(meta, index, ZRAM_SAME) &&
+			!zram_test_flag(meta, index, ZRAM_WB) &&
+			!zram_test_flag(meta, index, ZRAM_UNDER_WB) &&
+			!zram_test_flag(meta, index, ZRAM_UNDER_RECOMP))
+			zram_set_flag(meta, index, ZRAM_IDLE);
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+	}
+
+	ret = len;
+out:
+	up_read(&zram->init_lock);
+	return ret;
+}
+
+#endif
+
+#ifdef CONFIG_ZRAM_WRITEBACK
+/* Number of pages written back to the backing device per bio batch */
+#define ZRAM_WB_BATCH		32
+
+#define IDLE_WRITEBACK		1
+#define HUGE_WRITEBACK		2
+
+struct zram_wb_ctl {
+	atomic_t pending;
+	struct completion done;
+};
+
+struct zram_wb_entry {
+	struct zram_wb_ctl *ctl;
+	struct page *page;
+	unsigned long index;
+	unsigned long blk_idx;
+	int error;
+};
+
+static void zram_wb_end_io(struct bio *bio, int err)
+{
+	struct zram_wb_entry *entry = bio->bi_private;
+	struct zram_wb_ctl *ctl = entry->ctl;
+
+	entry->error = err;
+	bio_put(bio);
+	if (atomic_dec_and_test(&ctl->pending))
+		complete(&ctl->done);
+}
+
+/*
+ * Wait for a batch of writeback bios and publish the pages that made
+ * it to the backing device, unless the slot was freed or rewritten
+ * while the I/O was in flight.
+ */
+static void zram_wb_finish(struct zram *zram, struct zram_wb_ctl *ctl,
+		struct zram_wb_entry *entries, int nr, int mode)
+{
+	struct zram_meta *meta = zram->meta;
+	int i;
+
+	if (!atomic_dec_and_test(&ctl->pending))
+		wait_for_completion(&ctl->done);
+
+	for (i = 0; i < nr; i++) {
+		struct zram_wb_entry *entry = &entries[i];
+		unsigned long index = entry->index;
+
+		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
+		if (entry->error ||
+		    !zram_test_flag(meta, index, ZRAM_UNDER_WB) ||
+		    (mode == IDLE_WRITEBACK &&
+		     !zram_test_flag(meta, index, ZRAM_IDLE))) {
+			zram_clear_flag(meta, index, ZRAM_UNDER_WB);
+			bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+			free_block_bdev(zram, entry->blk_idx);
+			continue;
+		}
+
+		zram_free_page(zram, index);
+		zram_set_flag(meta, index, ZRAM_WB);
+		meta->table[index].handle = entry->blk_idx;
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+		atomic64_inc(&zram->stats.bd_writes);
+	}
+}
+
+static ssize_t writeback_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	struct zram_meta *meta;
+	unsigned long nr_pages;
+	unsigned long index;
+	struct zram_wb_entry *entries;
+	struct zram_wb_ctl ctl;
+	struct blk_plug plug;
+	int i, nr = 0, mode;
+	ssize_t ret = len;
+
+	if (sysfs_streq(buf, "idle"))
+		mode = IDLE_WRITEBACK;
+	else if (sysfs_streq(buf, "huge"))
+		mode = HUGE_WRITEBACK;
+	else
+		return -EINVAL;
+
+	entries = kcalloc(ZRAM_WB_BATCH, sizeof(*entries), GFP_KERNEL);
+	if (!entries)
+		return -ENOMEM;
+
+	for (i = 0; i < ZRAM_WB_BATCH; i++) {
+		entries[i].page = alloc_page(GFP_KERNEL);
+		if (!entries[i].page) {
+			ret = -ENOMEM;
+			goto free_pages;
+		}
+	}
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram)) {
+		ret = -EINVAL;
+		goto release_init_lock;
+	}
+
+	if (!zram->backing_dev) {
+		ret = -ENODEV;
+		goto release_init_lock;
+	}
+
+	meta = zram->meta;
+	nr_pages = zram->disksize >> PAGE_SHIFT;
+
+	atomic_set(&ctl.pending, 1);
+	init_completion(&ctl.done);
+	blk_start_plug(&plug);
+
+	for (index = 0; index < nr_pages; index++) {
+		struct zram_wb_entry *entry = &entries[nr];
+		unsigned long blk_idx;
+		struct bio *bio;
+
+		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
+		if (!meta->table[index].handle ||
+		    zram_test_flag(meta, index, ZRAM_SAME) ||
+		    zram_test_flag(meta, index, ZRAM_WB) ||
+		    zram_test_flag(meta, index, ZRAM_UNDER_WB) ||
+		    zram_test_flag(meta, index, ZRAM_UNDER_RECOMP) ||
+		    (mode == IDLE_WRITEBACK &&
+		     !zram_test_flag(meta, index, ZRAM_IDLE)) ||
+		    (mode == HUGE_WRITEBACK &&
+		     !zram_test_flag(meta, index, ZRAM_HUGE))) {
+			bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+			continue;
+		}
+		/*
+		 * An overwrite or free of the slot clears ZRAM_UNDER_WB
+		 * through zram_free_page, which zram_wb_finish() checks
+		 * before it publishes the written back copy.
+		 */
+		zram_set_flag(meta, index, ZRAM_UNDER_WB);
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+
+		blk_idx = alloc_block_bdev(zram);
+		if (!blk_idx) {
+			ret = -ENOSPC;
+			goto clear_under_wb;
+		}
+
+		if (zram_decompress_page(zram, page_address(entry->page),
+					 index))
+			goto free_block;
+
+		bio = bio_alloc(GFP_KERNEL, 1);
+		if (!bio) {
+			ret = -ENOMEM;
+			goto free_block;
+		}
+
+		bio->bi_iter.bi_sector = blk_idx * (PAGE_SIZE >> 9);
+		bio->bi_bdev = zram->bdev;
+		bio->bi_private = entry;
+		bio->bi_end_io = zram_wb_end_io;
+		bio_add_page(bio, entry->page, PAGE_SIZE, 0);
+
+		entry->ctl = &ctl;
+		entry->index = index;
+		entry->blk_idx = blk_idx;
+		entry->error = 0;
+		atomic_inc(&ctl.pending);
+		submit_bio(WRITE, bio);
+
+		if (++nr < ZRAM_WB_BATCH)
+			continue;
+
+		blk_finish_plug(&plug);
+		zram_wb_finish(zram, &ctl, entries, nr, mode);
+		nr = 0;
+		atomic_set(&ctl.pending, 1);
+		reinit_completion(&ctl.done);
+		blk_start_plug(&plug);
+		continue;
+
+free_block:
+		free_block_bdev(zram, blk_idx);
+clear_under_wb:
+		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
+		zram_clear_flag(meta, index, ZRAM_UNDER_WB);
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+		if (ret < 0)
+			break;
+	}
+
+	blk_finish_plug(&plug);
+	zram_wb_finish(zram, &ctl, entries, nr, mode);
+
+release_init_lock:
+	up_read(&zram->init_lock);
+free_pages:
+	for (i = 0; i < ZRAM_WB_BATCH; i++)
+		if (entries[i].page)
+			__free_page(entries[i].page);
+	kfree(entries);
+
+	return ret;
+}
+#endif
+
+#ifdef CONFIG_ZRAM_MULTI_COMP
+#define IDLE_RECOMP		1
+#define HUGE_RECOMP		2
+
+/*
+ * Recompress a single slot with the secondary algorithm. @page is a
+ * scratch page for the decompressed data. Returns 0 when the slot was
+ * recompressed or skipped, a negative error to stop the pass.
+ */
+static int zram_recompress(struct zram *zram, u32 index, struct page *page)
+{
+	struct zram_meta *meta = zram->meta;
+	struct zcomp_strm *zstrm;
+	unsigned long handle;
+	unsigned char *cmem;
+	size_t old_size, clen;
+	bool idle;
+	int ret;
+
+	old_size = zram_get_obj_size(meta, index);
+	ret = zram_decompress_page(zram, page_address(page), index);
+	if (ret)
+		return ret;
+
+	zstrm = zcomp_strm_find(zram->recomp);
+	ret = zcomp_compress(zram->recomp, zstrm, page_address(page), &clen);
+	if (ret) {
+		zcomp_strm_release(zram->recomp, zstrm);
+		return ret;
+	}
+
+	/*
+	 * Only keep the new object if it lands in a smaller size class,
+	 * otherwise it still takes the same space in the zspage and
+	 * costs a slower algorithm on every later read.
+	 */
+	if (clen > max_zpage_size ||
+	    zs_lookup_class_size(meta->mem_pool, clen) >=
+	    zs_lookup_class_size(meta->mem_pool, old_size)) {
+		zcomp_strm_release(zram->recomp, zstrm);
+		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
+		if (zram_test_flag(meta, index, ZRAM_UNDER_RECOMP)) {
+			zram_clear_flag(meta, index, ZRAM_UNDER_RECOMP);
+			zram_set_flag(meta, index, ZRAM_INCOMPRESSIBLE);
+		}
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+		return 0;
+	}
+
+	/* recomp uses a single, mutex protected stream, so we may sleep */
+	handle = zs_malloc(meta->mem_pool, clen, GFP_NOIO | __GFP_HIGHMEM);
+	if (!handle) {
+		zcomp_strm_release(zram->recomp, zstrm);
+		return -ENOMEM;
+	}
+
+	cmem = zs_map_object(meta->mem_pool, handle, ZS_MM_WO);
+	memcpy(cmem, zstrm->buffer, clen);
+	zs_unmap_object(meta->mem_pool, handle);
+	zcomp_strm_release(zram->recomp, zstrm);
+
+	bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
+	if (!zram_test_flag(meta, index, ZRAM_UNDER_RECOMP)) {
+		/* slot was freed or rewritten meanwhile */
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+		zs_free(meta->mem_pool, handle);
+		return 0;
+	}
+
+	idle = zram_test_flag(meta, index, ZRAM_IDLE);
+	zram_free_page(zram, index);
+	meta->table[index].handle = handle;
+	zram_set_obj_size(meta, index, clen);
+	zram_set_flag(meta, index, ZRAM_RECOMP);
+	if (idle)
+		zram_set_flag(meta, index, ZRAM_IDLE);
+	bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+
+	atomic64_add(clen, &zram->stats.compr_data_size);
+	atomic64_inc(&zram->stats.pages_stored);
+	return 0;
+}
+
+static ssize_t recompress_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	struct zram_meta *meta;
+	unsigned long nr_pages;
+	unsigned long index;
+	struct page *page;
+	ssize_t ret = len;
+	int err, mode;
+
+	if (sysfs_streq(buf, "idle"))
+		mode = IDLE_RECOMP;
+	else if (sysfs_streq(buf, "huge"))
+		mode = HUGE_RECOMP;
+	else
+		return -EINVAL;
+
+	page = alloc_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram)) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	if (!zram->recomp) {
+		ret = -ENODEV;
+		goto out;
+	}
+
+	meta = zram->meta;
+	nr_pages = zram->disksize >> PAGE_SHIFT;
+	for (index = 0; index < nr_pages; index++) {
+		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
+		if (!meta->table[index].handle ||
+		    zram_test_flag(meta, index, ZRAM_SAME) ||
+		    zram_test_flag(meta, index, ZRAM_WB) ||
+		    zram_test_flag(meta, index, ZRAM_UNDER_WB) ||
+		    zram_test_flag(meta, index, ZRAM_RECOMP) ||
+		    zram_test_flag(meta, index, ZRAM_INCOMPRESSIBLE) ||
+		    (mode == IDLE_RECOMP &&
+		     !zram_test_flag(meta, index, ZRAM_IDLE)) ||
+		    (mode == HUGE_RECOMP &&
+		     !zram_test_flag(meta, index, ZRAM_HUGE))) {
+			bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+			continue;
+		}
+		zram_set_flag(meta, index, ZRAM_UNDER_RECOMP);
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+
+		err = zram_recompress(zram, index, page);
+
+		bit_spin_lock(ZRAM_ACCESS, &meta->table[index].value);
+		zram_clear_flag(meta, index, ZRAM_UNDER_RECOMP);
+		bit_spin_unlock(ZRAM_ACCESS, &meta->table[index].value);
+
+		if (err) {
+			ret = err;
+			break;
+		}
+		cond_resched();
+	}
+out:
+	up_read(&zram->init_lock);
+	__free_page(page);
+	return ret;
 }
 
+static ssize_t recomp_algorithm_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	size_t sz;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	sz = zcomp_available_show(zram->recomp_algorithm, buf);
+	up_read(&zram->init_lock);
+
+	return sz;
+}
+
+static ssize_t recomp_algorithm_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change algorithm for initialized device\n");
+		return -EBUSY;
+	}
+	strlcpy(zram->recomp_algorithm, buf, sizeof(zram->recomp_algorithm));
+	up_write(&zram->init_lock);
+	return len;
+}
+#endif
+
 static void zram_reset_device(struct zram *zram)
 {
 	struct zram_meta *meta;
 	struct zcomp *comp;
 	u64 disksize;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	struct zcomp *recomp;
+#endif
 
 	down_write(&zram->init_lock);
 
@@ -838,6 +1762,10 @@ static void zram_reset_device(struct zram *zram)
 	meta = zram->meta;
 	comp = zram->comp;
 	disksize = zram->disksize;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	recomp = zram->recomp;
+	zram->recomp = NULL;
+#endif
 	/*
 	 * Refcount will go down to 0 eventually and r/w handler
 	 * cannot handle further I/O so it will bail out by
@@ -862,6 +1790,14 @@ static void zram_reset_device(struct zram *zram)
 	/* I/O operation under all of CPU are done so let's free */
 	zram_meta_free(meta, disksize);
 	zcomp_destroy(comp);
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (recomp)
+		zcomp_destroy(recomp);
+#endif
+
+	down_write(&zram->init_lock);
+	reset_bdev(zram);
+	up_write(&zram->init_lock);
 }
 
 static ssize_t disksize_store(struct device *dev,
@@ -869,6 +1805,9 @@ static ssize_t disksize_store(struct device *dev,
 {
 	u64 disksize;
 	struct zcomp *comp;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	struct zcomp *recomp = NULL;
+#endif
 	struct zram_meta *meta;
 	struct zram *zram = dev_to_zram(dev);
 	int err;
@@ -890,6 +1829,20 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_free_meta;
 	}
 
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	if (zram->recomp_algorithm[0]) {
+		/* recompression runs from a single sysfs writer */
+		recomp = zcomp_create(zram->recomp_algorithm, 1);
+		if (IS_ERR(recomp)) {
+			pr_info("Cannot initialise %s recompressing backend\n",
+					zram->recomp_algorithm);
+			err = PTR_ERR(recomp);
+			recomp = NULL;
+			goto out_destroy_comp_unlocked;
+		}
+	}
+#endif
+
 	down_write(&zram->init_lock);
 	if (init_done(zram)) {
 		pr_info("Cannot change disksize for initialized device\n");
@@ -901,6 +1854,9 @@ static ssize_t disksize_store(struct device *dev,
 	atomic_set(&zram->refcount, 1);
 	zram->meta = meta;
 	zram->comp = comp;
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	zram->recomp = recomp;
+#endif
 	zram->disksize = disksize;
 	set_capacity(zram->disk, zram->disksize >> SECTOR_SHIFT);
 	up_write(&zram->init_lock);
@@ -916,6 +1872,11 @@ static ssize_t disksize_store(struct device *dev,
 
 out_destroy_comp:
 	up_write(&zram->init_lock);
+#ifdef CONFIG_ZRAM_MULTI_COMP
+out_destroy_comp_unlocked:
+	if (recomp)
+		zcomp_destroy(recomp);
+#endif
 	zcomp_destroy(comp);
 out_free_meta:
 	zram_meta_free(meta, disksize);
@@ -974,6 +1935,8 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 	u32 index;
 	struct bio_vec bvec;
 	struct bvec_iter iter;
+	struct zram_write_batch batch = { 0 };
+	struct zram_write_batch *wb = NULL;
 
 	index = bio->bi_iter.bi_sector >> SECTORS_PER_PAGE_SHIFT;
 	offset = (bio->bi_iter.bi_sector &
@@ -986,6 +1949,9 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 	}
 
 	rw = bio_data_dir(bio);
+	if (rw == WRITE && bio_segments(bio) > 1)
+		wb = &batch;
+
 	bio_for_each_segment(bvec, bio, iter) {
 		int max_transfer_size = PAGE_SIZE - offset;
 
@@ -1000,25 +1966,36 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 			bv.bv_len = max_transfer_size;
 			bv.bv_offset = bvec.bv_offset;
 
-			if (zram_bvec_rw(zram, &bv, index, offset, rw) < 0)
+			if (zram_bvec_rw(zram, &bv, index, offset, rw, bio,
+					 wb) < 0)
 				goto out;
 
 			bv.bv_len = bvec.bv_len - max_transfer_size;
 			bv.bv_offset += max_transfer_size;
-			if (zram_bvec_rw(zram, &bv, index + 1, 0, rw) < 0)
+			if (zram_bvec_rw(zram, &bv, index + 1, 0, rw, bio,
+					 wb) < 0)
 				goto out;
 		} else
-			if (zram_bvec_rw(zram, &bvec, index, offset, rw) < 0)
+			if (zram_bvec_rw(zram, &bvec, index, offset, rw, bio,
+					 wb) < 0)
 				goto out;
 
 		update_position(&index, &offset, &bvec);
 	}
 
-	set_bit(BIO_UPTODATE, &bio->bi_flags);
+	/*
+	 * Reads from the backing device may still be in flight and are
+	 * chained to this bio, so leave BIO_UPTODATE alone: a failed
+	 * chained read must not be reported as success.
+	 */
+	if (wb)
+		zram_write_batch_finish(zram, wb);
 	bio_endio(bio, 0);
 	return;
 
 out:
+	if (wb)
+		zram_write_batch_finish(zram, wb);
 	bio_io_error(bio);
 }
 
@@ -1087,7 +2064,7 @@ static int zram_rw_page(struct block_device *bdev, sector_t sector,
 	bv.bv_len = PAGE_SIZE;
 	bv.bv_offset = 0;
 
-	err = zram_bvec_rw(zram, &bv, index, offset, rw);
+	err = zram_bvec_rw(zram, &bv, index, offset, rw, NULL, NULL);
 put_zram:
 	zram_meta_put(zram);
 out:
@@ -1115,11 +2092,23 @@ static DEVICE_ATTR_RW(disksize);
 static DEVICE_ATTR_RO(initstate);
 static DEVICE_ATTR_WO(reset);
 static DEVICE_ATTR_RO(orig_data_size);
+static DEVICE_ATTR_RO(zero_pages);
 static DEVICE_ATTR_RO(mem_used_total);
 static DEVICE_ATTR_RW(mem_limit);
 static DEVICE_ATTR_RW(mem_used_max);
 static DEVICE_ATTR_RW(max_comp_streams);
 static DEVICE_ATTR_RW(comp_algorithm);
+#if defined(CONFIG_ZRAM_WRITEBACK) || defined(CONFIG_ZRAM_MULTI_COMP)
+static DEVICE_ATTR_WO(idle);
+#endif
+#ifdef CONFIG_ZRAM_WRITEBACK
+static DEVICE_ATTR_RW(backing_dev);
+static DEVICE_ATTR_WO(writeback);
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+static DEVICE_ATTR_RW(recomp_algorithm);
+static DEVICE_ATTR_WO(recompress);
+#endif
 
 static ssize_t io_stat_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
@@ -1143,13 +2132,15 @@ static ssize_t mm_stat_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
 	struct zram *zram = dev_to_zram(dev);
-	u64 orig_size, mem_used = 0;
+	u64 orig_size, mem_used = 0, bg_migrated = 0;
 	long max_used;
 	ssize_t ret;
 
 	down_read(&zram->init_lock);
-	if (init_done(zram))
+	if (init_done(zram)) {
 		mem_used = zs_get_total_pages(zram->meta->mem_pool);
+		bg_migrated = zs_get_bg_migrated(zram->meta->mem_pool);
+	}
 
 	orig_size = atomic64_read(&zram->stats.pages_stored);
 	max_used = atomic_long_read(&zram->stats.max_used_pages);
@@ -1161,8 +2152,63 @@ static ssize_t mm_stat_show(struct device *dev,
 			mem_used << PAGE_SHIFT,
 			zram->limit_pages << PAGE_SHIFT,
 			max_used << PAGE_SHIFT,
-			(u64)atomic64_read(&zram->stats.zero_pages),
-			(u64)atomic64_read(&zram->stats.num_migrated));
+			(u64)atomic64_read(&zram->stats.same_pages),
+			(u64)atomic64_read(&zram->stats.num_migrated) +
+				bg_migrated);
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+
+#ifdef CONFIG_ZRAM_WRITEBACK
+#define FOUR_K(x) ((x) * (1 << (PAGE_SHIFT - 12)))
+static ssize_t bd_stat_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	ssize_t ret;
+
+	down_read(&zram->init_lock);
+	ret = scnprintf(buf, PAGE_SIZE,
+		"%8llu %8llu %8llu\n",
+			FOUR_K((u64)atomic64_read(&zram->stats.bd_count)),
+			FOUR_K((u64)atomic64_read(&zram->stats.bd_reads)),
+			FOUR_K((u64)atomic64_read(&zram->stats.bd_writes)));
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+#endif
+
+/*
+ * One line per non-empty zsmalloc size class:
+ * class size, objects allocated, objects used, pages used.
+ */
+static ssize_t class_stat_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	struct zs_class_stats stats;
+	unsigned int i, nr_classes;
+	ssize_t ret = 0;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram))
+		goto out;
+
+	nr_classes = zs_get_nr_size_classes();
+	for (i = 0; i < nr_classes; i++) {
+		if (!zs_get_class_stats(zram->meta->mem_pool, i, &stats))
+			continue;
+		if (!stats.obj_allocated)
+			continue;
+
+		ret += scnprintf(buf + ret, PAGE_SIZE - ret,
+				"%u %lu %lu %lu\n",
+				stats.size, stats.obj_allocated,
+				stats.obj_used, stats.pages_used);
+	}
+out:
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -1170,13 +2216,16 @@ static ssize_t mm_stat_show(struct device *dev,
 
 static DEVICE_ATTR_RO(io_stat);
 static DEVICE_ATTR_RO(mm_stat);
+static DEVICE_ATTR_RO(class_stat);
+#ifdef CONFIG_ZRAM_WRITEBACK
+static DEVICE_ATTR_RO(bd_stat);
+#endif
 ZRAM_ATTR_RO(num_reads);
 ZRAM_ATTR_RO(num_writes);
 ZRAM_ATTR_RO(failed_reads);
 ZRAM_ATTR_RO(failed_writes);
 ZRAM_ATTR_RO(invalid_io);
 ZRAM_ATTR_RO(notify_free);
-ZRAM_ATTR_RO(zero_pages);
 ZRAM_ATTR_RO(compr_data_size);
 
 static struct attribute *zram_disk_attrs[] = {
@@ -1198,8 +2247,23 @@ static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_mem_used_max.attr,
 	&dev_attr_max_comp_streams.attr,
 	&dev_attr_comp_algorithm.attr,
+#if defined(CONFIG_ZRAM_WRITEBACK) || defined(CONFIG_ZRAM_MULTI_COMP)
+	&dev_attr_idle.attr,
+#endif
+#ifdef CONFIG_ZRAM_WRITEBACK
+	&dev_attr_backing_dev.attr,
+	&dev_attr_writeback.attr,
+#endif
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	&dev_attr_recomp_algorithm.attr,
+	&dev_attr_recompress.attr,
+#endif
 	&dev_attr_io_stat.attr,
 	&dev_attr_mm_stat.attr,
+	&dev_attr_class_stat.attr,
+#ifdef CONFIG_ZRAM_WRITEBACK
+	&dev_attr_bd_stat.attr,
+#endif
 	NULL,
 };
 
@@ -1342,6 +2406,7 @@ static int __init zram_init(void)
 	}
 
 	show_mem_notifier_register(&zram_show_mem_notifier_block);
+	zram_bench_init();
 	pr_info("Created %u device(s) ...\n", num_devices);
 
 	return 0;
@@ -1353,6 +2418,7 @@ out_error:
 
 static void __exit zram_exit(void)
 {
+	zram_bench_exit();
 	destroy_devices(num_devices);
 }
 
@@ -59,15 +59,24 @@ static const size_t max_zpage_size = PAGE_SIZE / 4 * 3;
  * zram is mainly used for memory efficiency so we want to keep memory
  * footprint small so we can squeeze size and flags into a field.
  * The lower ZRAM_FLAG_SHIFT bits is for object size (excluding header),
- * the higher bits is for zram_pageflags.
+ * the higher bits is for zram_pageflags. An object is at most PAGE_SIZE
+ * long, so PAGE_SHIFT + 1 bits are enough and leave room for all flags
+ * in a 32-bit value.
  */
-#define ZRAM_FLAG_SHIFT 24
+#define ZRAM_FLAG_SHIFT (PAGE_SHIFT + 1)
 
 /* Flags for zram pages (table[page_no].value) */
 enum zram_pageflags {
-	/* Page consists entirely of zeros */
-	ZRAM_ZERO = ZRAM_FLAG_SHIFT,
+	/* Page consists entirely of one repeated element */
+	ZRAM_SAME = ZRAM_FLAG_SHIFT,
 	ZRAM_ACCESS,	/* page is now accessed */
+	ZRAM_WB,	/* page is stored on backing_device */
+	ZRAM_UNDER_WB,	/* page is under writeback */
+	ZRAM_HUGE,	/* Incompressible page */
+	ZRAM_IDLE,	/* not accessed page since last idle marking */
+	ZRAM_RECOMP,	/* page is compressed with the secondary algorithm */
+	ZRAM_UNDER_RECOMP,	/* page is under recompression */
+	ZRAM_INCOMPRESSIBLE,	/* recompression gave no gain, don't retry */
 
 	__NR_ZRAM_PAGEFLAGS,
 };
@@ -76,7 +85,10 @@ enum zram_pageflags {
 
 /* Allocated for each disk page */
 struct zram_table_entry {
-	unsigned long handle;
+	union {
+		unsigned long handle;
+		unsigned long element;	/* pattern of a ZRAM_SAME page */
+	};
 	unsigned long value;
 };
 
@@ -89,9 +101,14 @@ struct zram_stats {
 	atomic64_t failed_writes;	/* can happen when memory is too low */
 	atomic64_t invalid_io;	/* non-page-aligned I/O requests */
 	atomic64_t notify_free;	/* no. of swap slot free notifications */
-	atomic64_t zero_pages;		/* no. of zero filled pages */
+	atomic64_t same_pages;		/* no. of same element filled pages */
 	atomic64_t pages_stored;	/* no. of pages currently stored */
 	atomic_long_t max_used_pages;	/* no. of maximum pages stored */
+#ifdef CONFIG_ZRAM_WRITEBACK
+	atomic64_t bd_count;		/* no. of pages in backing device */
+	atomic64_t bd_reads;		/* no. of reads from backing device */
+	atomic64_t bd_writes;		/* no. of writes from backing device */
+#endif
 };
 
 struct zram_meta {
@@ -121,5 +138,26 @@ struct zram {
 	 */
 	u64 disksize;	/* bytes */
 	char compressor[10];
+#ifdef CONFIG_ZRAM_MULTI_COMP
+	/* secondary algorithm used by recompress, none if empty */
+	struct zcomp *recomp;
+	char recomp_algorithm[10];
+#endif
+#ifdef CONFIG_ZRAM_WRITEBACK
+	struct file *backing_dev;
+	struct block_device *bdev;
+	unsigned int old_block_size;
+	/* one bit per block of backing_dev, protected by atomic bitops */
+	unsigned long *bitmap;
+	unsigned long nr_pages;
+#endif
 };
+
+#ifdef CONFIG_ZRAM_BENCH
+void zram_bench_init(void);
+void zram_bench_exit(void);
+#else
+static inline void zram_bench_init(void) { }
+static inline void zram_bench_exit(void) { }
+#endif
 #endif
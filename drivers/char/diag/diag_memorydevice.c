@@ -23,6 +23,8 @@
 #include <linux/delay.h>
 #include <linux/kmemleak.h>
 #include <linux/uaccess.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
 #include "diagchar.h"
 #include "diag_memorydevice.h"
 #include "diagfwd_bridge.h"
@@ -31,6 +33,10 @@
 #include "diagfwd.h"
 #include "diagfwd_peripheral.h"
 
+/* Bounds on the size of a mapped memory device ring, header included */
+#define DIAG_MD_RING_MIN_SIZE	(64 * 1024)
+#define DIAG_MD_RING_MAX_SIZE	(8 * 1024 * 1024)
+
 struct diag_md_info diag_md[NUM_DIAG_MD_DEV] = {
 	{
 		.id = DIAG_MD_LOCAL,
@@ -137,9 +143,158 @@ void diag_md_close_all()
 	diag_ws_reset(DIAG_WS_MUX);
 }
 
+/*
+ * Append one record to the ring. The tail is written by userspace, so it
+ * is sanity checked and never trusted beyond bounding the free space.
+ * Records that do not fit are dropped and counted. Called with
+ * diagchar_mutex held, which keeps rb alive.
+ */
+static void diag_md_ring_put(struct diag_md_ring_buf *rb,
+			     unsigned char *buf, int len)
+{
+	struct diag_md_ring *ring = rb->ring;
+	struct diag_md_ring_rec *rec = NULL;
+	uint32_t head = rb->head;
+	uint32_t tail;
+	uint32_t need;
+	uint32_t room;
+
+	tail = ACCESS_ONCE(ring->tail);
+	/* Don't overwrite data before the reader is done with it */
+	smp_mb();
+	if (tail >= rb->size || !IS_ALIGNED(tail, DIAG_MD_RING_ALIGN))
+		goto drop;
+
+	need = ALIGN(sizeof(*rec) + len, DIAG_MD_RING_ALIGN);
+	room = (tail > head) ? tail - head : rb->size - head + tail;
+
+	if (rb->size - head < need) {
+		/* Doesn't fit before the end, wrap to the start */
+		if (room <= rb->size - head + need)
+			goto drop;
+		rec = (struct diag_md_ring_rec *)(ring->data + head);
+		rec->len = 0;
+		rec->flags = DIAG_MD_RING_REC_WRAP;
+		head = 0;
+	} else if (room <= need) {
+		goto drop;
+	}
+
+	rec = (struct diag_md_ring_rec *)(ring->data + head);
+	rec->len = len;
+	rec->flags = 0;
+	memcpy(ring->data + head + sizeof(*rec), buf, len);
+	head += need;
+	if (head == rb->size)
+		head = 0;
+
+	/* Publish the record before the new head */
+	smp_wmb();
+	rb->head = head;
+	ring->head = head;
+	return;
+
+drop:
+	rb->dropped++;
+	ring->dropped = rb->dropped;
+	pr_err_ratelimited("diag: md ring full, dropping %d bytes\n", len);
+}
+
+/*
+ * If the logging process owning the session has mapped a ring, copy the
+ * data there and release the buffer right away. Returns -ENOENT if there
+ * is no ring and the data has to be queued for read().
+ */
+static int diag_md_ring_write(struct diag_md_info *ch, int pid,
+			      unsigned char *buf, int len, int ctx)
+{
+	int i;
+	int err = -ENOENT;
+
+	mutex_lock(&driver->diagchar_mutex);
+	for (i = 0; i < driver->num_clients; i++) {
+		if (driver->client_map[i].pid != pid ||
+		    !driver->client_map[i].md_ring)
+			continue;
+		diag_md_ring_put(driver->client_map[i].md_ring, buf, len);
+		wake_up_interruptible(&driver->wait_q);
+		err = 0;
+		break;
+	}
+	mutex_unlock(&driver->diagchar_mutex);
+
+	if (err)
+		return err;
+
+	diag_ws_on_read(DIAG_WS_MUX, len);
+	diag_ws_on_copy(DIAG_WS_MUX);
+	if (ch->ops && ch->ops->write_done)
+		ch->ops->write_done(buf, len, ctx, DIAG_MEMORY_DEVICE_MODE);
+	diag_ws_on_copy_complete(DIAG_WS_MUX);
+
+	return 0;
+}
+
+int diag_md_ring_mmap(struct diag_md_ring_buf **prb,
+		      struct vm_area_struct *vma)
+{
+	int err = 0;
+	unsigned long size = vma->vm_end - vma->vm_start;
+	struct diag_md_ring_buf *rb = NULL;
+
+	if (vma->vm_pgoff || !(vma->vm_flags & VM_SHARED))
+		return -EINVAL;
+	if (size < DIAG_MD_RING_MIN_SIZE || size > DIAG_MD_RING_MAX_SIZE)
+		return -EINVAL;
+	if (*prb)
+		return -EBUSY;
+
+	rb = kzalloc(sizeof(*rb), GFP_KERNEL);
+	if (!rb)
+		return -ENOMEM;
+
+	rb->ring = vmalloc_user(size);
+	if (!rb->ring) {
+		err = -ENOMEM;
+		goto fail;
+	}
+	rb->size = round_down(size - sizeof(struct diag_md_ring),
+			      DIAG_MD_RING_ALIGN);
+	rb->ring->size = rb->size;
+
+	err = remap_vmalloc_range(vma, rb->ring, 0);
+	if (err)
+		goto fail;
+
+	*prb = rb;
+	return 0;
+
+fail:
+	vfree(rb->ring);
+	kfree(rb);
+	return err;
+}
+
+/* Only call once the ring can no longer be mapped, i.e. on release */
+void diag_md_ring_free(struct diag_md_ring_buf *rb)
+{
+	if (!rb)
+		return;
+	vfree(rb->ring);
+	kfree(rb);
+}
+
+int diag_md_ring_pending(struct diag_md_ring_buf *rb)
+{
+	if (!rb)
+		return 0;
+	return rb->head != ACCESS_ONCE(rb->ring->tail);
+}
+
 int diag_md_write(int id, unsigned char *buf, int len, int ctx)
 {
 	int i, pid = 0;
+	int err = 0;
 	uint8_t found = 0;
 	unsigned long flags;
 	struct diag_md_info *ch = NULL;
@@ -183,6 +338,12 @@ int diag_md_write(int id, unsigned char *buf, int len, int ctx)
 	if (found)
 		return -ENOMEM;
 
+	if (id == DIAG_MD_LOCAL) {
+		err = diag_md_ring_write(ch, pid, buf, len, ctx);
+		if (err != -ENOENT)
+			return err;
+	}
+
 	spin_lock_irqsave(&ch->lock, flags);
 	for (i = 0; i < ch->num_tbl_entries && !found; i++) {
 		if (ch->tbl[i].len == 0) {
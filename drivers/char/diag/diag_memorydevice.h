@@ -33,6 +33,16 @@ struct diag_buf_tbl_t {
 	int ctx;
 };
 
+struct vm_area_struct;
+
+/* Kernel side of a struct diag_md_ring mapped by a logging process */
+struct diag_md_ring_buf {
+	struct diag_md_ring *ring;
+	uint32_t size;
+	uint32_t head;
+	uint32_t dropped;
+};
+
 struct diag_md_info {
 	int id;
 	int ctx;
@@ -57,4 +67,8 @@ int diag_md_close_peripheral(int id, uint8_t peripheral);
 int diag_md_write(int id, unsigned char *buf, int len, int ctx);
 int diag_md_copy_to_user(char __user *buf, int *pret, size_t buf_size,
 			 struct diag_md_session_t *info);
+int diag_md_ring_mmap(struct diag_md_ring_buf **prb,
+		      struct vm_area_struct *vma);
+void diag_md_ring_free(struct diag_md_ring_buf *rb);
+int diag_md_ring_pending(struct diag_md_ring_buf *rb);
 #endif
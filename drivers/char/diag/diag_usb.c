@@ -28,11 +28,22 @@
 #endif
 #include "diag_usb.h"
 #include "diag_mux.h"
+#include "diagfwd.h"
 #include "diagmem.h"
 #include "diag_ipc_logging.h"
 
 #define DIAG_USB_STRING_SZ	10
 #define DIAG_USB_MAX_SIZE	16384
+#define DIAG_USB_AGG_SIZE	DIAG_USB_MAX_SIZE
+/* Packets larger than this are not worth a copy and go out as they are */
+#define DIAG_USB_AGG_MAX_PKT	(DIAG_USB_AGG_SIZE / 2)
+
+/*
+ * Coalesce small peripheral data packets into larger USB writes. Only
+ * consulted when the local channel registers.
+ */
+static bool usb_coalesce = true;
+module_param(usb_coalesce, bool, 0);
 
 struct diag_usb_info diag_usb[NUM_DIAG_USB_DEV] = {
 	{
@@ -168,6 +179,218 @@ static struct diag_usb_buf_tbl_t *diag_usb_buf_tbl_get(
 	return NULL;
 }
 
+static struct diag_usb_agg *diag_usb_agg_get(struct diag_usb_info *ch,
+					     int ctxt)
+{
+	int peripheral = GET_BUF_PERIPHERAL(ctxt);
+
+	if (!ch->agg || GET_BUF_TYPE(ctxt) != TYPE_DATA ||
+	    peripheral >= NUM_PERIPHERALS)
+		return NULL;
+
+	return &ch->agg[peripheral];
+}
+
+static struct diag_usb_agg_buf *diag_usb_agg_buf_get(struct diag_usb_info *ch,
+						     void *context,
+						     struct diag_usb_agg **agg)
+{
+	int i, j;
+
+	if (!ch->agg)
+		return NULL;
+
+	for (i = 0; i < NUM_PERIPHERALS; i++) {
+		for (j = 0; j < DIAG_USB_AGG_BUFS; j++) {
+			if (context == &ch->agg[i].buf[j]) {
+				*agg = &ch->agg[i];
+				return &ch->agg[i].buf[j];
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static int diag_usb_agg_idle(struct diag_usb_agg *agg)
+{
+	int i;
+
+	for (i = 0; i < DIAG_USB_AGG_BUFS; i++) {
+		if (agg->buf[i].busy)
+			return 0;
+	}
+
+	return 1;
+}
+
+/* Send whatever has accumulated in the fill buffer. Call with write_lock. */
+static void diag_usb_agg_flush(struct diag_usb_info *ch,
+			       struct diag_usb_agg *agg)
+{
+	int err = 0;
+	struct diag_usb_agg_buf *abuf = &agg->buf[agg->fill];
+	struct diag_request *req = NULL;
+
+	if (abuf->len == 0)
+		return;
+
+	req = diagmem_alloc(driver, sizeof(struct diag_request), ch->mempool);
+	if (!req) {
+		err = -ENOMEM;
+		goto drop;
+	}
+
+	req->buf = abuf->data;
+	req->length = abuf->len;
+	req->context = (void *)abuf;
+
+	abuf->busy = 1;
+	diag_ws_on_read(DIAG_WS_MUX, abuf->len);
+	err = usb_diag_write(ch->hdl, req);
+	diag_ws_on_copy(DIAG_WS_MUX);
+	if (err) {
+		diag_ws_on_copy_fail(DIAG_WS_MUX);
+		diagmem_free(driver, req, ch->mempool);
+		abuf->busy = 0;
+		goto drop;
+	}
+	ch->agg_flush_cnt++;
+	agg->fill = (agg->fill + 1) % DIAG_USB_AGG_BUFS;
+	return;
+
+drop:
+	pr_err_ratelimited("diag: In %s, dropping %d coalesced bytes on usb channel %s, err: %d\n",
+			   __func__, abuf->len, ch->name, err);
+	ch->agg_drop_cnt++;
+	abuf->len = 0;
+}
+
+/*
+ * Copy a peripheral data packet into the coalescing buffer and hand the
+ * peripheral buffer straight back, so the peripheral can be read again
+ * without waiting for the USB round trip. The copy goes out immediately
+ * if nothing is in flight for this peripheral, otherwise when the
+ * in-flight buffer completes or the fill buffer runs out of room.
+ *
+ * Returns -EAGAIN if the packet has to be written as it is. Call with
+ * write_lock held.
+ */
+static int diag_usb_agg_write(struct diag_usb_info *ch,
+			      struct diag_usb_agg *agg,
+			      unsigned char *buf, int len, int ctxt)
+{
+	int size = min(ch->max_size, DIAG_USB_AGG_SIZE);
+	struct diag_usb_agg_buf *abuf = NULL;
+
+	if (len > DIAG_USB_AGG_MAX_PKT || len > size) {
+		diag_usb_agg_flush(ch, agg);
+		return -EAGAIN;
+	}
+
+	abuf = &agg->buf[agg->fill];
+	if (abuf->len + len > size) {
+		diag_usb_agg_flush(ch, agg);
+		abuf = &agg->buf[agg->fill];
+	}
+	if (abuf->busy)
+		return -EAGAIN;
+
+	memcpy(abuf->data + abuf->len, buf, len);
+	abuf->len += len;
+	ch->agg_copy_cnt++;
+
+	diag_ws_on_read(DIAG_WS_MUX, len);
+	diag_ws_on_copy(DIAG_WS_MUX);
+	if (ch->ops && ch->ops->write_done)
+		ch->ops->write_done(buf, len, ctxt, DIAG_USB_MODE);
+	diag_ws_on_copy_complete(DIAG_WS_MUX);
+
+	if (diag_usb_agg_idle(agg))
+		diag_usb_agg_flush(ch, agg);
+
+	return 0;
+}
+
+static void diag_usb_agg_write_done(struct diag_usb_info *ch,
+				    struct diag_usb_agg *agg,
+				    struct diag_usb_agg_buf *abuf,
+				    struct diag_request *req)
+{
+	unsigned long flags;
+
+	ch->write_cnt++;
+	spin_lock_irqsave(&ch->write_lock, flags);
+	abuf->len = 0;
+	abuf->busy = 0;
+	diag_ws_on_copy_complete(DIAG_WS_MUX);
+	/* Push out what accumulated while this buffer was in flight */
+	diag_usb_agg_flush(ch, agg);
+	spin_unlock_irqrestore(&ch->write_lock, flags);
+	diagmem_free(driver, req, ch->mempool);
+}
+
+/* Discard data not yet handed to USB. In-flight buffers complete as usual. */
+static void diag_usb_agg_reset(struct diag_usb_info *ch)
+{
+	int i, j;
+	unsigned long flags;
+
+	if (!ch->agg)
+		return;
+
+	spin_lock_irqsave(&ch->write_lock, flags);
+	for (i = 0; i < NUM_PERIPHERALS; i++) {
+		for (j = 0; j < DIAG_USB_AGG_BUFS; j++) {
+			if (!ch->agg[i].buf[j].busy)
+				ch->agg[i].buf[j].len = 0;
+		}
+	}
+	spin_unlock_irqrestore(&ch->write_lock, flags);
+}
+
+static void diag_usb_agg_exit(struct diag_usb_info *ch)
+{
+	int i, j;
+
+	if (!ch->agg)
+		return;
+
+	for (i = 0; i < NUM_PERIPHERALS; i++) {
+		for (j = 0; j < DIAG_USB_AGG_BUFS; j++)
+			kfree(ch->agg[i].buf[j].data);
+	}
+	kfree(ch->agg);
+	ch->agg = NULL;
+}
+
+static void diag_usb_agg_init(struct diag_usb_info *ch)
+{
+	int i, j;
+
+	ch->agg = kcalloc(NUM_PERIPHERALS, sizeof(struct diag_usb_agg),
+			  GFP_KERNEL);
+	if (!ch->agg)
+		goto fail;
+
+	for (i = 0; i < NUM_PERIPHERALS; i++) {
+		for (j = 0; j < DIAG_USB_AGG_BUFS; j++) {
+			ch->agg[i].buf[j].data = kzalloc(DIAG_USB_AGG_SIZE,
+							 GFP_KERNEL);
+			if (!ch->agg[i].buf[j].data)
+				goto fail;
+			kmemleak_not_leak(ch->agg[i].buf[j].data);
+		}
+	}
+	kmemleak_not_leak(ch->agg);
+	return;
+
+fail:
+	pr_warn("diag: Unable to allocate coalescing buffers for USB %s\n",
+		ch->name);
+	diag_usb_agg_exit(ch);
+}
+
 /*
  * This function is called asynchronously when USB is connected and
  * synchronously when Diag wants to connect to USB explicitly.
@@ -308,10 +531,18 @@ static void diag_usb_write_done(struct diag_usb_info *ch,
 	struct diag_usb_buf_tbl_t *entry = NULL;
 	unsigned char *buf = NULL;
 	unsigned long flags;
+	struct diag_usb_agg *agg = NULL;
+	struct diag_usb_agg_buf *abuf = NULL;
 
 	if (!ch || !req)
 		return;
 
+	abuf = diag_usb_agg_buf_get(ch, req->context, &agg);
+	if (abuf) {
+		diag_usb_agg_write_done(ch, agg, abuf, req);
+		return;
+	}
+
 	ch->write_cnt++;
 	entry = diag_usb_buf_tbl_get(ch, req->context);
 	if (!entry) {
@@ -368,6 +599,7 @@ static void diag_usb_notifier(void *priv, unsigned event,
 		break;
 	case USB_DIAG_DISCONNECT:
 		atomic_set(&usb_info->connected, 0);
+		diag_usb_agg_reset(usb_info);
 		pr_info("diag: USB channel %s disconnected\n", usb_info->name);
 		queue_work(usb_info->usb_wq,
 			   &usb_info->disconnect_work);
@@ -487,6 +719,7 @@ int diag_usb_write(int id, unsigned char *buf, int len, int ctxt)
 	int err = 0;
 	struct diag_request *req = NULL;
 	struct diag_usb_info *usb_info = NULL;
+	struct diag_usb_agg *agg = NULL;
 	unsigned long flags;
 
 	if (id < 0 || id >= NUM_DIAG_USB_DEV) {
@@ -497,6 +730,19 @@ int diag_usb_write(int id, unsigned char *buf, int len, int ctxt)
 
 	usb_info = &diag_usb[id];
 
+	agg = diag_usb_agg_get(usb_info, ctxt);
+	if (agg) {
+		err = -EAGAIN;
+		spin_lock_irqsave(&usb_info->write_lock, flags);
+		if (usb_info->hdl && atomic_read(&usb_info->connected) &&
+		    atomic_read(&usb_info->diag_state))
+			err = diag_usb_agg_write(usb_info, agg, buf, len, ctxt);
+		spin_unlock_irqrestore(&usb_info->write_lock, flags);
+		if (err != -EAGAIN)
+			return err;
+		err = 0;
+	}
+
 	if (len > usb_info->max_size) {
 		DIAG_LOG(DIAG_DEBUG_MUX, "len: %d, max_size: %d\n",
 			 len, usb_info->max_size);
@@ -590,6 +836,7 @@ void diag_usb_disconnect_all(void)
 		if (!usb_info->enabled)
 			continue;
 		atomic_set(&usb_info->diag_state, 0);
+		diag_usb_agg_reset(usb_info);
 		usb_disconnect(usb_info);
 	}
 }
@@ -629,6 +876,8 @@ int diag_usb_register(int id, int ctxt, struct diag_mux_ops *ops)
 	 */
 	atomic_set(&ch->diag_state, 1);
 	INIT_LIST_HEAD(&ch->buf_tbl);
+	if (id == DIAG_USB_LOCAL && usb_coalesce)
+		diag_usb_agg_init(ch);
 	diagmem_init(driver, ch->mempool);
 	INIT_WORK(&(ch->read_work), usb_read_work_fn);
 	INIT_WORK(&(ch->read_done_work), usb_read_done_work_fn);
@@ -652,6 +901,7 @@ int diag_usb_register(int id, int ctxt, struct diag_mux_ops *ops)
 err:
 	if (ch->usb_wq)
 		destroy_workqueue(ch->usb_wq);
+	diag_usb_agg_exit(ch);
 	kfree(ch->read_ptr);
 	kfree(ch->read_buf);
 	return -ENOMEM;
@@ -687,5 +937,6 @@ void diag_usb_exit(int id)
 	ch->read_ptr = NULL;
 	kfree(ch->read_buf);
 	ch->read_buf = NULL;
+	diag_usb_agg_exit(ch);
 }
 
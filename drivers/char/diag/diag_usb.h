@@ -38,6 +38,8 @@
 
 #define DIAG_USB_MODE		0
 
+#define DIAG_USB_AGG_BUFS	2
+
 struct diag_usb_buf_tbl_t {
 	struct list_head track;
 	unsigned char *buf;
@@ -46,6 +48,22 @@ struct diag_usb_buf_tbl_t {
 	int ctxt;
 };
 
+struct diag_usb_agg_buf {
+	unsigned char *data;
+	int len;
+	int busy;
+};
+
+/*
+ * Per-peripheral coalescing state. Small data packets from a peripheral
+ * are copied into the buffer at index fill; the buffers are sent in
+ * order and at most DIAG_USB_AGG_BUFS of them are ever in flight.
+ */
+struct diag_usb_agg {
+	struct diag_usb_agg_buf buf[DIAG_USB_AGG_BUFS];
+	int fill;
+};
+
 struct diag_usb_info {
 	int id;
 	int ctxt;
@@ -59,10 +77,14 @@ struct diag_usb_info {
 	struct list_head buf_tbl;
 	unsigned long read_cnt;
 	unsigned long write_cnt;
+	unsigned long agg_copy_cnt;
+	unsigned long agg_flush_cnt;
+	unsigned long agg_drop_cnt;
 	spinlock_t lock;
 	spinlock_t write_lock;
 	struct usb_diag_ch *hdl;
 	struct diag_mux_ops *ops;
+	struct diag_usb_agg *agg;
 	unsigned char *read_buf;
 	struct diag_request *read_ptr;
 	struct work_struct read_work;
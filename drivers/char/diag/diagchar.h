@@ -326,6 +326,7 @@ struct diag_cmd_reg_tbl_t {
 struct diag_client_map {
 	char name[20];
 	int pid;
+	struct diag_md_ring_buf *md_ring;
 };
 
 struct real_time_vote_t {
@@ -21,6 +21,7 @@
 #include <linux/diagchar.h>
 #include <linux/sched.h>
 #include <linux/ratelimit.h>
+#include <linux/poll.h>
 #include <linux/timer.h>
 #include <linux/sched.h>
 #include <linux/platform_device.h>
@@ -60,6 +61,7 @@ MODULE_VERSION("1.0");
 struct diagchar_dev *driver;
 struct diagchar_priv {
 	int pid;
+	struct diag_md_ring_buf *md_ring;
 };
 
 #define USER_SPACE_RAW_DATA	0
@@ -287,10 +289,13 @@ void diag_add_client(int i, struct file *file)
 	struct diagchar_priv *diagpriv_data;
 
 	driver->client_map[i].pid = current->tgid;
+	driver->client_map[i].md_ring = NULL;
 	diagpriv_data = kmalloc(sizeof(struct diagchar_priv),
 							GFP_KERNEL);
-	if (diagpriv_data)
+	if (diagpriv_data) {
 		diagpriv_data->pid = current->tgid;
+		diagpriv_data->md_ring = NULL;
+	}
 	file->private_data = diagpriv_data;
 	strlcpy(driver->client_map[i].name, current->comm, 20);
 	driver->client_map[i].name[19] = '\0';
@@ -477,6 +482,7 @@ static void diag_close_logging_process(const int pid)
 static int diag_remove_client_entry(struct file *file)
 {
 	int i = -1;
+	struct diag_md_ring_buf *md_ring = NULL;
 	struct diagchar_priv *diagpriv_data = NULL;
 	struct diag_dci_client_tbl *dci_entry = NULL;
 
@@ -518,6 +524,14 @@ static int diag_remove_client_entry(struct file *file)
 	if (driver->ref_count == 0)
 		diag_mempool_exit();
 
+	md_ring = diagpriv_data->md_ring;
+	if (md_ring) {
+		for (i = 0; i < driver->num_clients; i++) {
+			if (driver->client_map[i].md_ring == md_ring)
+				driver->client_map[i].md_ring = NULL;
+		}
+	}
+
 	for (i = 0; i < driver->num_clients; i++) {
 		if (NULL != diagpriv_data && diagpriv_data->pid ==
 						driver->client_map[i].pid) {
@@ -530,6 +544,7 @@ static int diag_remove_client_entry(struct file *file)
 	}
 	mutex_unlock(&driver->diagchar_mutex);
 	mutex_unlock(&driver->diag_file_mutex);
+	diag_md_ring_free(md_ring);
 	return 0;
 }
 static int diagchar_close(struct inode *inode, struct file *file)
@@ -3533,6 +3548,60 @@ static int diag_real_time_info_init(void)
 	return 0;
 }
 
+/*
+ * Map a memory device log ring, see struct diag_md_ring. The ring is
+ * attached to the calling process' client entry and fed from
+ * diag_md_write() from then on.
+ */
+static int diagchar_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	int i;
+	int err = 0;
+	struct diagchar_priv *diagpriv_data = file->private_data;
+
+	if (!diagpriv_data)
+		return -EINVAL;
+
+	mutex_lock(&driver->diagchar_mutex);
+	for (i = 0; i < driver->num_clients; i++)
+		if (driver->client_map[i].pid == current->tgid)
+			break;
+	if (i == driver->num_clients) {
+		err = -EINVAL;
+		goto out;
+	}
+
+	err = diag_md_ring_mmap(&diagpriv_data->md_ring, vma);
+	if (!err)
+		driver->client_map[i].md_ring = diagpriv_data->md_ring;
+out:
+	mutex_unlock(&driver->diagchar_mutex);
+	return err;
+}
+
+static unsigned int diagchar_poll(struct file *file, poll_table *wait)
+{
+	int i;
+	unsigned int mask = 0;
+	struct diagchar_priv *diagpriv_data = file->private_data;
+
+	poll_wait(file, &driver->wait_q, wait);
+
+	mutex_lock(&driver->diagchar_mutex);
+	for (i = 0; i < driver->num_clients; i++) {
+		if (driver->client_map[i].pid != current->tgid)
+			continue;
+		if (atomic_read(&driver->data_ready_notif[i]) > 0)
+			mask |= POLLIN | POLLRDNORM;
+		break;
+	}
+	if (diagpriv_data && diag_md_ring_pending(diagpriv_data->md_ring))
+		mask |= POLLIN | POLLRDNORM;
+	mutex_unlock(&driver->diagchar_mutex);
+
+	return mask;
+}
+
 static const struct file_operations diagcharfops = {
 	.owner = THIS_MODULE,
 	.read = diagchar_read,
@@ -3541,6 +3610,8 @@ static const struct file_operations diagcharfops = {
 	.compat_ioctl = diagchar_compat_ioctl,
 #endif
 	.unlocked_ioctl = diagchar_ioctl,
+	.mmap = diagchar_mmap,
+	.poll = diagchar_poll,
 	.open = diagchar_open,
 	.release = diagchar_close
 };
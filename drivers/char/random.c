@@ -261,6 +261,8 @@
 #include <linux/syscalls.h>
 #include <linux/completion.h>
 
+#include <crypto/chacha20.h>
+
 #include <asm/processor.h>
 #include <asm/uaccess.h>
 #include <asm/irq.h>
@@ -472,6 +474,25 @@ static struct entropy_store nonblocking_pool = {
 					push_to_pool),
 };
 
+/*
+ * Each CPU runs its own ChaCha20 CRNG, keyed from the nonblocking pool,
+ * to serve get_random_bytes() and /dev/urandom without taking the pool
+ * lock and hashing the pool for every request.  A CPU reseeds when its
+ * key is older than CRNG_RESEED_INTERVAL or crng_generation has moved,
+ * which happens once the nonblocking pool is fully initialized.
+ */
+#define CRNG_RESEED_INTERVAL	(300 * HZ)
+
+struct crng_state {
+	__u32		state[16];
+	unsigned long	init_time;
+	int		generation;
+	int		cpu;		/* CPU that seeded this state */
+};
+
+static DEFINE_PER_CPU(struct crng_state, crng_state);
+static atomic_t crng_generation = ATOMIC_INIT(1);
+
 static __u32 const twist_table[8] = {
 	0x00000000, 0x3b6e20c8, 0x76dc4190, 0x4db26158,
 	0xedb88320, 0xd6d6a3e8, 0x9b64c2b0, 0xa00ae278 };
@@ -659,6 +680,7 @@ retry:
 		r->initialized = 1;
 		r->entropy_total = 0;
 		if (r == &nonblocking_pool) {
+			atomic_inc(&crng_generation);
 			prandom_reseed_late();
 			wake_up_interruptible(&urandom_init_wait);
 			pr_notice("random: %s pool is initialized\n", r->name);
@@ -1232,6 +1254,107 @@ static ssize_t extract_entropy_user(struct entropy_store *r, void __user *buf,
 	return ret;
 }
 
+/*
+ * State seeded before the per-cpu areas are set up is copied to every
+ * CPU, so a CPU also reseeds when it was not the one that seeded it.
+ */
+static inline bool crng_stale(struct crng_state *crng)
+{
+	return crng->generation != atomic_read(&crng_generation) ||
+		crng->cpu != smp_processor_id() ||
+		time_after(jiffies, crng->init_time + CRNG_RESEED_INTERVAL);
+}
+
+/*
+ * Copy this CPU's CRNG state into @state, for the caller to generate its
+ * keystream from.  The CPU's state is only touched with interrupts off,
+ * as get_random_bytes() may be called from any context; a stale key is
+ * replaced first with 384 bits from the nonblocking pool, mixed with the
+ * arch RNG when there is one.
+ *
+ * In the same interrupts-off section the CPU's key is replaced with a
+ * keystream block that the copy never produces.  This gives backtracking
+ * protection even if the caller migrates to another CPU: once the caller
+ * wipes its copy, nothing can regenerate what it handed out.
+ */
+static void crng_get_state(__u32 state[16])
+{
+	struct crng_state *crng;
+	unsigned long flags, rv;
+	__u32 seed[12];		/* key, block counter and nonce */
+	__u8 tmp[CHACHA20_BLOCK_SIZE];
+	int gen, i;
+
+	local_irq_save(flags);
+	crng = this_cpu_ptr(&crng_state);
+	if (unlikely(crng_stale(crng))) {
+		local_irq_restore(flags);
+
+		gen = atomic_read(&crng_generation);
+		extract_entropy(&nonblocking_pool, seed, sizeof(seed), 0, 0);
+		for (i = 0; i < ARRAY_SIZE(seed); i++) {
+			if (arch_get_random_long(&rv))
+				seed[i] ^= rv;
+		}
+
+		local_irq_save(flags);
+		crng = this_cpu_ptr(&crng_state);
+		crng->state[0] = 0x61707865;	/* "expand 32-byte k" */
+		crng->state[1] = 0x3320646e;
+		crng->state[2] = 0x79622d32;
+		crng->state[3] = 0x6b206574;
+		memcpy(&crng->state[4], seed, sizeof(seed));
+		crng->init_time = jiffies;
+		crng->generation = gen;
+		crng->cpu = smp_processor_id();
+		memzero_explicit(seed, sizeof(seed));
+	}
+	/* The block counter moves past tmp before the state is copied */
+	chacha20_block(crng->state, tmp);
+	memcpy(state, crng->state, sizeof(crng->state));
+	memcpy(&crng->state[4], tmp, CHACHA20_KEY_SIZE);
+	local_irq_restore(flags);
+	memzero_explicit(tmp, sizeof(tmp));
+}
+
+static ssize_t extract_crng_user(void __user *buf, size_t nbytes)
+{
+	ssize_t ret = 0, i;
+	__u32 state[16];
+	__u8 tmp[CHACHA20_BLOCK_SIZE];
+	int large_request = (nbytes > 256);
+
+	crng_get_state(state);
+
+	while (nbytes) {
+		if (large_request && need_resched()) {
+			if (signal_pending(current)) {
+				if (ret == 0)
+					ret = -ERESTARTSYS;
+				break;
+			}
+			schedule();
+		}
+
+		chacha20_block(state, tmp);
+		i = min_t(int, nbytes, CHACHA20_BLOCK_SIZE);
+		if (copy_to_user(buf, tmp, i)) {
+			ret = -EFAULT;
+			break;
+		}
+
+		nbytes -= i;
+		buf += i;
+		ret += i;
+	}
+
+	/* Wipe data just written to memory */
+	memzero_explicit(tmp, sizeof(tmp));
+	memzero_explicit(state, sizeof(state));
+
+	return ret;
+}
+
 /*
  * This function is the exported kernel interface.  It returns some
  * number of good random numbers, suitable for key generation, seeding
@@ -1241,6 +1364,9 @@ static ssize_t extract_entropy_user(struct entropy_store *r, void __user *buf,
  */
 void get_random_bytes(void *buf, int nbytes)
 {
+	__u32 state[16];
+	__u8 tmp[CHACHA20_BLOCK_SIZE];
+
 #if DEBUG_RANDOM_BOOT > 0
 	if (unlikely(nonblocking_pool.initialized == 0))
 		printk(KERN_NOTICE "random: %pF get_random_bytes called "
@@ -1249,7 +1375,21 @@ void get_random_bytes(void *buf, int nbytes)
 		       nonblocking_pool.entropy_total);
 #endif
 	trace_get_random_bytes(nbytes, _RET_IP_);
-	extract_entropy(&nonblocking_pool, buf, nbytes, 0, 0);
+
+	crng_get_state(state);
+
+	while (nbytes >= CHACHA20_BLOCK_SIZE) {
+		chacha20_block(state, buf);
+		buf += CHACHA20_BLOCK_SIZE;
+		nbytes -= CHACHA20_BLOCK_SIZE;
+	}
+
+	if (nbytes > 0) {
+		chacha20_block(state, tmp);
+		memcpy(buf, tmp, nbytes);
+		memzero_explicit(tmp, sizeof(tmp));
+	}
+	memzero_explicit(state, sizeof(state));
 }
 EXPORT_SYMBOL(get_random_bytes);
 
@@ -1400,7 +1540,7 @@ urandom_read(struct file *file, char __user *buf, size_t nbytes, loff_t *ppos)
 	}
 
 	nbytes = min_t(size_t, nbytes, INT_MAX >> (ENTROPY_SHIFT + 3));
-	ret = extract_entropy_user(&nonblocking_pool, buf, nbytes);
+	ret = extract_crng_user(buf, nbytes);
 
 	trace_urandom_read(8 * nbytes, ENTROPY_BITS(&nonblocking_pool),
 			   ENTROPY_BITS(&input_pool));
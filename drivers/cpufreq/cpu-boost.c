@@ -22,6 +22,8 @@
 #include <linux/slab.h>
 #include <linux/input.h>
 #include <linux/time.h>
+#include <linux/fb.h>
+#include <linux/pid.h>
 
 struct cpu_sync {
 	int cpu;
@@ -43,6 +45,28 @@ module_param(sched_boost_on_input, bool, 0644);
 
 static bool sched_boost_active;
 
+/*
+ * Targeted boost: only boost the CPUs that the tasks listed in
+ * input_boost_pids (e.g. InputDispatcher and the render threads) are
+ * running on, instead of every CPU in the system.
+ */
+static bool input_boost_targeted;
+module_param(input_boost_targeted, bool, 0644);
+
+#define MAX_BOOST_PIDS 8
+static int input_boost_pids[MAX_BOOST_PIDS];
+static int nr_input_boost_pids;
+module_param_array(input_boost_pids, int, &nr_input_boost_pids, 0644);
+
+/* Percentage of the boost dropped on every completed frame, 0 disables */
+static unsigned int input_boost_decay_pct;
+module_param(input_boost_decay_pct, uint, 0644);
+
+static DEFINE_MUTEX(input_boost_lock);
+static bool input_boost_active;
+static unsigned int input_boost_level = 100;
+static struct work_struct input_boost_decay_work;
+
 static struct delayed_work input_boost_rem;
 static u64 last_input_time;
 #define MIN_INPUT_INTERVAL (150 * USEC_PER_MSEC)
@@ -169,6 +193,64 @@ static void update_policy_online(void)
 	put_online_cpus();
 }
 
+/*
+ * Build the mask of CPUs to boost: every CPU sharing a frequency domain
+ * with a CPU that one of the input_boost_pids tasks is on. Falls back to
+ * all CPUs when targeting is off or none of the tasks can be found.
+ */
+static void get_boost_cpus(struct cpumask *mask)
+{
+	struct cpumask task_cpus;
+	struct cpufreq_policy *policy;
+	struct task_struct *p;
+	int i;
+
+	cpumask_clear(mask);
+	if (!input_boost_targeted)
+		goto all;
+
+	cpumask_clear(&task_cpus);
+	rcu_read_lock();
+	for (i = 0; i < nr_input_boost_pids; i++) {
+		p = pid_task(find_vpid(input_boost_pids[i]), PIDTYPE_PID);
+		if (p)
+			cpumask_set_cpu(task_cpu(p), &task_cpus);
+	}
+	rcu_read_unlock();
+
+	for_each_cpu(i, &task_cpus) {
+		policy = cpufreq_cpu_get(i);
+		if (!policy)
+			continue;
+		cpumask_or(mask, mask, policy->related_cpus);
+		cpufreq_cpu_put(policy);
+	}
+
+	if (!cpumask_empty(mask))
+		return;
+all:
+	cpumask_copy(mask, cpu_possible_mask);
+}
+
+/* Set the input_boost_min of the boosted CPUs, called with the lock held */
+static void set_input_boost_min(void)
+{
+	struct cpumask boost_cpus;
+	struct cpu_sync *i_sync_info;
+	unsigned int i;
+
+	get_boost_cpus(&boost_cpus);
+	for_each_possible_cpu(i) {
+		i_sync_info = &per_cpu(sync_info, i);
+		if (cpumask_test_cpu(i, &boost_cpus))
+			i_sync_info->input_boost_min =
+				i_sync_info->input_boost_freq *
+				input_boost_level / 100;
+		else
+			i_sync_info->input_boost_min = 0;
+	}
+}
+
 static void do_input_boost_rem(struct work_struct *work)
 {
 	unsigned int i, ret;
@@ -176,10 +258,13 @@ static void do_input_boost_rem(struct work_struct *work)
 
 	/* Reset the input_boost_min for all CPUs in the system */
 	pr_debug("Resetting input boost min for all CPUs\n");
+	mutex_lock(&input_boost_lock);
+	input_boost_active = false;
 	for_each_possible_cpu(i) {
 		i_sync_info = &per_cpu(sync_info, i);
 		i_sync_info->input_boost_min = 0;
 	}
+	mutex_unlock(&input_boost_lock);
 
 	/* Update policies for all online CPUs */
 	update_policy_online();
@@ -194,8 +279,7 @@ static void do_input_boost_rem(struct work_struct *work)
 
 static void do_input_boost(struct work_struct *work)
 {
-	unsigned int i, ret;
-	struct cpu_sync *i_sync_info;
+	unsigned int ret;
 
 	cancel_delayed_work_sync(&input_boost_rem);
 	if (sched_boost_active) {
@@ -203,12 +287,13 @@ static void do_input_boost(struct work_struct *work)
 		sched_boost_active = false;
 	}
 
-	/* Set the input_boost_min for all CPUs in the system */
-	pr_debug("Setting input boost min for all CPUs\n");
-	for_each_possible_cpu(i) {
-		i_sync_info = &per_cpu(sync_info, i);
-		i_sync_info->input_boost_min = i_sync_info->input_boost_freq;
-	}
+	/* Set the input_boost_min for the boosted CPUs */
+	pr_debug("Setting input boost min\n");
+	mutex_lock(&input_boost_lock);
+	input_boost_level = 100;
+	set_input_boost_min();
+	input_boost_active = true;
+	mutex_unlock(&input_boost_lock);
 
 	/* Update policies for all online CPUs */
 	update_policy_online();
@@ -226,6 +311,49 @@ static void do_input_boost(struct work_struct *work)
 					msecs_to_jiffies(input_boost_ms));
 }
 
+/*
+ * Drop input_boost_decay_pct of the boost for every frame the display
+ * completes, re-targeting the boost in case the tasks have migrated.
+ * Once the boost has fully decayed, remove it without waiting for
+ * input_boost_ms to elapse.
+ */
+static void do_input_boost_decay(struct work_struct *work)
+{
+	mutex_lock(&input_boost_lock);
+	if (!input_boost_active) {
+		mutex_unlock(&input_boost_lock);
+		return;
+	}
+
+	if (input_boost_level <= input_boost_decay_pct) {
+		mutex_unlock(&input_boost_lock);
+		mod_delayed_work(cpu_boost_wq, &input_boost_rem, 0);
+		return;
+	}
+
+	input_boost_level -= input_boost_decay_pct;
+	set_input_boost_min();
+	mutex_unlock(&input_boost_lock);
+
+	update_policy_online();
+}
+
+static int boost_fb_notify(struct notifier_block *nb, unsigned long val,
+			   void *data)
+{
+	if (val != FB_EVENT_FRAME_DONE)
+		return NOTIFY_OK;
+
+	if (input_boost_decay_pct && input_boost_active)
+		queue_work(cpu_boost_wq, &input_boost_decay_work);
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block boost_fb_nb = {
+	.notifier_call = boost_fb_notify,
+};
+
 static void cpuboost_input_event(struct input_handle *handle,
 		unsigned int type, unsigned int code, int value)
 {
@@ -326,6 +454,7 @@ static int cpu_boost_init(void)
 		return -EFAULT;
 
 	INIT_WORK(&input_boost_work, do_input_boost);
+	INIT_WORK(&input_boost_decay_work, do_input_boost_decay);
 	INIT_DELAYED_WORK(&input_boost_rem, do_input_boost_rem);
 
 	for_each_possible_cpu(cpu) {
@@ -333,6 +462,7 @@ static int cpu_boost_init(void)
 		s->cpu = cpu;
 	}
 	cpufreq_register_notifier(&boost_adjust_nb, CPUFREQ_POLICY_NOTIFIER);
+	fb_register_client(&boost_fb_nb);
 	ret = input_register_handler(&cpuboost_input_handler);
 
 	return ret;
@@ -124,7 +124,8 @@ EXPORT_SYMBOL_GPL(have_governor_per_policy);
 
 bool cpufreq_driver_is_slow(void)
 {
-	return !(cpufreq_driver->flags & CPUFREQ_DRIVER_FAST);
+	return !(cpufreq_driver->flags & CPUFREQ_DRIVER_FAST) &&
+		!cpufreq_driver->fast_switch;
 }
 EXPORT_SYMBOL_GPL(cpufreq_driver_is_slow);
 
@@ -2117,6 +2118,37 @@ out:
 }
 EXPORT_SYMBOL_GPL(__cpufreq_driver_target);
 
+bool cpufreq_driver_has_fast_switch(void)
+{
+	return cpufreq_driver && cpufreq_driver->fast_switch;
+}
+EXPORT_SYMBOL_GPL(cpufreq_driver_has_fast_switch);
+
+/**
+ * cpufreq_driver_fast_switch - switch the frequency from scheduler context
+ * @policy: cpufreq policy to switch the frequency for
+ * @target_freq: new frequency to set, clamped to the policy limits
+ *
+ * Unlike __cpufreq_driver_target(), this neither sleeps nor takes
+ * policy->rwsem and it does not send transition notifiers. The governor
+ * must make sure @policy stays valid while this runs. Updates
+ * policy->cur and returns the new frequency, or 0 on failure.
+ */
+unsigned int cpufreq_driver_fast_switch(struct cpufreq_policy *policy,
+					unsigned int target_freq)
+{
+	unsigned int freq;
+
+	target_freq = clamp_val(target_freq, policy->min, policy->max);
+
+	freq = cpufreq_driver->fast_switch(policy, target_freq);
+	if (freq)
+		policy->cur = freq;
+
+	return freq;
+}
+EXPORT_SYMBOL_GPL(cpufreq_driver_fast_switch);
+
 int cpufreq_driver_target(struct cpufreq_policy *policy,
 			  unsigned int target_freq,
 			  unsigned int relation)
@@ -80,6 +80,7 @@ static struct mutex gov_lock;
 
 static int set_window_count;
 static int migration_register_count;
+static int rollover_register_count;
 static struct mutex sched_lock;
 static cpumask_t controlled_cpus;
 
@@ -139,6 +140,12 @@ struct cpufreq_interactive_tunables {
 	bool use_sched_load;
 	bool use_migration_notif;
 
+	/*
+	 * Evaluate load on scheduler window rollover instead of arming the
+	 * sampling timers. Only takes effect when use_sched_load is true.
+	 */
+	bool use_window_notif;
+
 	/*
 	 * Whether to align timer windows across all CPUs. When
 	 * use_sched_load is true, this flag is ignored and windows
@@ -160,6 +167,12 @@ struct cpufreq_interactive_tunables {
 
 	/* Whether to enable prediction or not */
 	bool enable_prediction;
+
+	/*
+	 * Whether to use the busy time of the heaviest task on a cpu as a
+	 * floor for its load. Only used when use_sched_load is set.
+	 */
+	bool use_top_task;
 };
 
 /* For cases where we have single governor instance for system */
@@ -185,6 +198,12 @@ static u64 round_to_nw_start(u64 jif,
 	return ret;
 }
 
+static inline bool window_notif_enabled(
+			struct cpufreq_interactive_tunables *tunables)
+{
+	return tunables->use_sched_load && tunables->use_window_notif;
+}
+
 static inline int set_window_helper(
 			struct cpufreq_interactive_tunables *tunables)
 {
@@ -203,6 +222,9 @@ static void cpufreq_interactive_timer_resched(unsigned long cpu,
 	unsigned long flags;
 	int i;
 
+	if (window_notif_enabled(tunables))
+		return;
+
 	spin_lock_irqsave(&ppol->load_lock, flags);
 	expires = round_to_nw_start(ppol->last_evaluated_jiffy, tunables);
 	if (!slack_only) {
@@ -245,13 +267,15 @@ static void cpufreq_interactive_timer_start(
 	int i;
 
 	spin_lock_irqsave(&ppol->load_lock, flags);
-	ppol->policy_timer.expires = expires;
-	add_timer(&ppol->policy_timer);
-	if (tunables->timer_slack_val >= 0 &&
-	    ppol->target_freq > ppol->policy->min) {
-		expires += tunables->timer_slack_val;
-		ppol->policy_slack_timer.expires = expires;
-		add_timer(&ppol->policy_slack_timer);
+	if (!window_notif_enabled(tunables)) {
+		ppol->policy_timer.expires = expires;
+		add_timer(&ppol->policy_timer);
+		if (tunables->timer_slack_val >= 0 &&
+		    ppol->target_freq > ppol->policy->min) {
+			expires += tunables->timer_slack_val;
+			ppol->policy_slack_timer.expires = expires;
+			add_timer(&ppol->policy_slack_timer);
+		}
 	}
 
 	for_each_cpu(i, ppol->policy->cpus) {
@@ -505,6 +529,9 @@ static void cpufreq_interactive_timer(unsigned long data)
 		pcpu = &per_cpu(cpuinfo, cpu);
 		if (tunables->use_sched_load) {
 			t_prevlaf = sl_busy_to_laf(ppol, sl[i].prev_load);
+			if (tunables->use_top_task)
+				t_prevlaf = max(t_prevlaf, sl_busy_to_laf(ppol,
+						sl[i].top_task_load));
 			prev_l = t_prevlaf / ppol->target_freq;
 			if (tunables->enable_prediction) {
 				t_predlaf = sl_busy_to_laf(ppol,
@@ -793,6 +820,9 @@ static int load_change_callback(struct notifier_block *nb, unsigned long val,
 	struct cpufreq_interactive_tunables *tunables;
 	unsigned long flags;
 
+	if (val != SCHED_LOAD_ALERT)
+		return 0;
+
 	if (!ppol || ppol->reject_notification)
 		return 0;
 
@@ -818,6 +848,51 @@ exit:
 	return 0;
 }
 
+/*
+ * Evaluate the policy once per scheduler window, when the first of its
+ * cpus rolls over into a new window. This replaces the sampling timers,
+ * so cpus that stay idle are not woken up just to sample their load.
+ */
+static int window_rollover_callback(struct notifier_block *nb,
+				    unsigned long val, void *data)
+{
+	unsigned long cpu = (unsigned long) data;
+	struct cpufreq_interactive_policyinfo *ppol = per_cpu(polinfo, cpu);
+	struct cpufreq_interactive_tunables *tunables;
+	unsigned long flags;
+
+	if (val != SCHED_WINDOW_ROLLOVER)
+		return 0;
+
+	if (!ppol || ppol->reject_notification)
+		return 0;
+
+	if (!down_read_trylock(&ppol->enable_sem))
+		return 0;
+	if (!ppol->governor_enabled)
+		goto exit;
+
+	tunables = ppol->policy->governor_data;
+	if (!window_notif_enabled(tunables))
+		goto exit;
+
+	/* Already evaluated in this window */
+	if (get_jiffies_64() < round_to_nw_start(ppol->last_evaluated_jiffy,
+						 tunables))
+		goto exit;
+
+	spin_lock_irqsave(&ppol->target_freq_lock, flags);
+	ppol->notif_cpu = cpu;
+	spin_unlock_irqrestore(&ppol->target_freq_lock, flags);
+
+	if (!hrtimer_is_queued(&ppol->notif_timer))
+		__hrtimer_start_range_ns(&ppol->notif_timer, ms_to_ktime(1),
+					0, HRTIMER_MODE_REL, 0);
+exit:
+	up_read(&ppol->enable_sem);
+	return 0;
+}
+
 static enum hrtimer_restart cpufreq_interactive_hrtimer(struct hrtimer *timer)
 {
 	struct cpufreq_interactive_policyinfo *ppol = container_of(timer,
@@ -844,6 +919,10 @@ static struct notifier_block load_notifier_block = {
 	.notifier_call = load_change_callback,
 };
 
+static struct notifier_block rollover_notifier_block = {
+	.notifier_call = window_rollover_callback,
+};
+
 static int cpufreq_interactive_notifier(
 	struct notifier_block *nb, unsigned long val, void *data)
 {
@@ -1053,6 +1132,7 @@ show_store_one(align_windows);
 show_store_one(ignore_hispeed_on_notif);
 show_store_one(fast_ramp_down);
 show_store_one(enable_prediction);
+show_store_one(use_top_task);
 
 static ssize_t show_go_hispeed_load(struct cpufreq_interactive_tunables
 		*tunables, char *buf)
@@ -1283,6 +1363,14 @@ static int cpufreq_interactive_enable_sched_input(
 		sched_set_io_is_busy(tunables->io_is_busy);
 	}
 
+	if (tunables->use_window_notif) {
+		rollover_register_count++;
+		if (rollover_register_count == 1)
+			atomic_notifier_chain_register(
+					&load_alert_notifier_head,
+					&rollover_notifier_block);
+	}
+
 	if (!tunables->use_migration_notif)
 		goto out;
 
@@ -1309,12 +1397,43 @@ static int cpufreq_interactive_disable_sched_input(
 					&load_alert_notifier_head,
 					&load_notifier_block);
 	}
+	if (tunables->use_window_notif) {
+		rollover_register_count--;
+		if (rollover_register_count < 1)
+			atomic_notifier_chain_unregister(
+					&load_alert_notifier_head,
+					&rollover_notifier_block);
+	}
 	set_window_count--;
 
 	mutex_unlock(&sched_lock);
 	return 0;
 }
 
+/*
+ * Restart the sampling timers of every policy governed by @tunables that
+ * stopped using window rollover notifications.
+ */
+static void cpufreq_interactive_rearm_timers(
+			struct cpufreq_interactive_tunables *tunables)
+{
+	struct cpufreq_interactive_policyinfo *ppol;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		ppol = per_cpu(polinfo, cpu);
+		if (!ppol || !ppol->policy || ppol->policy->cpu != cpu)
+			continue;
+
+		down_read(&ppol->enable_sem);
+		if (ppol->governor_enabled &&
+		    ppol->policy->governor_data == tunables &&
+		    !timer_pending(&ppol->policy_timer))
+			cpufreq_interactive_timer_resched(cpu, false);
+		up_read(&ppol->enable_sem);
+	}
+}
+
 static ssize_t show_use_sched_load(
 		struct cpufreq_interactive_tunables *tunables, char *buf)
 {
@@ -1347,6 +1466,9 @@ static ssize_t store_use_sched_load(
 		return ret;
 	}
 
+	if (!val && tunables->use_window_notif)
+		cpufreq_interactive_rearm_timers(tunables);
+
 	return count;
 }
 
@@ -1394,6 +1516,53 @@ static ssize_t store_use_migration_notif(
 	return count;
 }
 
+static ssize_t show_use_window_notif(
+		struct cpufreq_interactive_tunables *tunables, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%d\n",
+			tunables->use_window_notif);
+}
+
+static ssize_t store_use_window_notif(
+			struct cpufreq_interactive_tunables *tunables,
+			const char *buf, size_t count)
+{
+	int ret;
+	unsigned long val;
+
+	ret = kstrtoul(buf, 0, &val);
+	if (ret < 0)
+		return ret;
+
+	if (tunables->use_window_notif == (bool) val)
+		return count;
+	tunables->use_window_notif = val;
+
+	if (!tunables->use_sched_load)
+		return count;
+
+	mutex_lock(&sched_lock);
+	if (val) {
+		rollover_register_count++;
+		if (rollover_register_count == 1)
+			atomic_notifier_chain_register(
+					&load_alert_notifier_head,
+					&rollover_notifier_block);
+	} else {
+		rollover_register_count--;
+		if (!rollover_register_count)
+			atomic_notifier_chain_unregister(
+					&load_alert_notifier_head,
+					&rollover_notifier_block);
+	}
+	mutex_unlock(&sched_lock);
+
+	if (!val)
+		cpufreq_interactive_rearm_timers(tunables);
+
+	return count;
+}
+
 /*
  * Create show/store routines
  * - sys: One governor instance for complete SYSTEM
@@ -1443,11 +1612,13 @@ show_store_gov_pol_sys(boostpulse_duration);
 show_store_gov_pol_sys(io_is_busy);
 show_store_gov_pol_sys(use_sched_load);
 show_store_gov_pol_sys(use_migration_notif);
+show_store_gov_pol_sys(use_window_notif);
 show_store_gov_pol_sys(max_freq_hysteresis);
 show_store_gov_pol_sys(align_windows);
 show_store_gov_pol_sys(ignore_hispeed_on_notif);
 show_store_gov_pol_sys(fast_ramp_down);
 show_store_gov_pol_sys(enable_prediction);
+show_store_gov_pol_sys(use_top_task);
 
 #define gov_sys_attr_rw(_name)						\
 static struct global_attr _name##_gov_sys =				\
@@ -1473,11 +1644,13 @@ gov_sys_pol_attr_rw(boostpulse_duration);
 gov_sys_pol_attr_rw(io_is_busy);
 gov_sys_pol_attr_rw(use_sched_load);
 gov_sys_pol_attr_rw(use_migration_notif);
+gov_sys_pol_attr_rw(use_window_notif);
 gov_sys_pol_attr_rw(max_freq_hysteresis);
 gov_sys_pol_attr_rw(align_windows);
 gov_sys_pol_attr_rw(ignore_hispeed_on_notif);
 gov_sys_pol_attr_rw(fast_ramp_down);
 gov_sys_pol_attr_rw(enable_prediction);
+gov_sys_pol_attr_rw(use_top_task);
 
 static struct global_attr boostpulse_gov_sys =
 	__ATTR(boostpulse, 0200, NULL, store_boostpulse_gov_sys);
@@ -1500,11 +1673,13 @@ static struct attribute *interactive_attributes_gov_sys[] = {
 	&io_is_busy_gov_sys.attr,
 	&use_sched_load_gov_sys.attr,
 	&use_migration_notif_gov_sys.attr,
+	&use_window_notif_gov_sys.attr,
 	&max_freq_hysteresis_gov_sys.attr,
 	&align_windows_gov_sys.attr,
 	&ignore_hispeed_on_notif_gov_sys.attr,
 	&fast_ramp_down_gov_sys.attr,
 	&enable_prediction_gov_sys.attr,
+	&use_top_task_gov_sys.attr,
 	NULL,
 };
 
@@ -1528,11 +1703,13 @@ static struct attribute *interactive_attributes_gov_pol[] = {
 	&io_is_busy_gov_pol.attr,
 	&use_sched_load_gov_pol.attr,
 	&use_migration_notif_gov_pol.attr,
+	&use_window_notif_gov_pol.attr,
 	&max_freq_hysteresis_gov_pol.attr,
 	&align_windows_gov_pol.attr,
 	&ignore_hispeed_on_notif_gov_pol.attr,
 	&fast_ramp_down_gov_pol.attr,
 	&enable_prediction_gov_pol.attr,
+	&use_top_task_gov_pol.attr,
 	NULL,
 };
 
@@ -35,6 +35,8 @@
 #include <linux/moduleparam.h>
 #include <linux/sched.h>
 #include <linux/cpu_pm.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <soc/qcom/spm.h>
 #include <soc/qcom/pm.h>
 #include <soc/qcom/rpm-notifier.h>
@@ -81,6 +83,35 @@ struct lpm_debug {
 	uint32_t arg4;
 };
 
+/*
+ * Per-CPU idle history used to predict the next idle duration when the
+ * CPU is frequently woken up by interrupts before its next timer event.
+ */
+#define MAXSAMPLES		5
+#define PRED_REF_STDDEV_US	500
+#define PRED_TIMER_ADD_US	100
+
+struct lpm_history {
+	uint32_t resi[MAXSAMPLES];
+	int nsamp;
+	uint32_t hptr;
+	uint32_t sleep_us;	/* timer based sleep length at select */
+	bool pred_used;		/* last selection was limited by prediction */
+	ktime_t pred_wakeup;	/* absolute predicted wakeup, 0 if none */
+	ktime_t htmr_expires;	/* expiry of the misprediction timer */
+	/* accounting, exported through debugfs */
+	uint64_t nr_sel_tmr;
+	uint64_t nr_sel_pred;
+	uint64_t nr_wake_tmr;
+	uint64_t nr_wake_irq;
+	uint64_t nr_too_deep_tmr;
+	uint64_t nr_too_deep_pred;
+	uint64_t nr_too_shallow;
+};
+
+static DEFINE_PER_CPU(struct lpm_history, hist);
+static DEFINE_PER_CPU(struct hrtimer, histtimer);
+
 struct lpm_cluster *lpm_root_node;
 
 static DEFINE_PER_CPU(struct lpm_cluster*, cpu_cluster);
@@ -126,6 +157,10 @@ static bool sleep_disabled;
 module_param_named(sleep_disabled,
 	sleep_disabled, bool, S_IRUGO | S_IWUSR | S_IWGRP);
 
+static bool lpm_prediction = true;
+module_param_named(lpm_prediction,
+	lpm_prediction, bool, S_IRUGO | S_IWUSR | S_IWGRP);
+
 s32 msm_cpuidle_get_deep_idle_latency(void)
 {
 	return 10;
@@ -448,6 +483,135 @@ static int set_device_mode(struct lpm_cluster *cluster, int ndevice,
 		return -EINVAL;
 }
 
+static enum hrtimer_restart histtimer_fn(struct hrtimer *h)
+{
+	return HRTIMER_NORESTART;
+}
+
+static void histtimer_start(uint32_t time_us)
+{
+	struct hrtimer *cpu_histtimer = this_cpu_ptr(&histtimer);
+	struct lpm_history *history = this_cpu_ptr(&hist);
+	ktime_t hist_ktime = ns_to_ktime((u64)time_us * NSEC_PER_USEC);
+
+	history->htmr_expires = ktime_add(ktime_get(), hist_ktime);
+	hrtimer_start(cpu_histtimer, hist_ktime, HRTIMER_MODE_REL_PINNED);
+}
+
+static void histtimer_cancel(void)
+{
+	struct lpm_history *history = this_cpu_ptr(&hist);
+
+	if (!history->htmr_expires.tv64)
+		return;
+	hrtimer_try_to_cancel(this_cpu_ptr(&histtimer));
+	history->htmr_expires.tv64 = 0;
+}
+
+static void clear_predict_history(struct lpm_history *history)
+{
+	history->nsamp = 0;
+	history->hptr = 0;
+}
+
+/*
+ * Predict the next idle duration from the last MAXSAMPLES residencies.
+ * The samples are considered predictable when their standard deviation
+ * is small, or small compared to their average; the largest samples are
+ * discarded as outliers (at most one) before giving up.
+ */
+static uint32_t lpm_cpu_predict(struct cpuidle_device *dev)
+{
+	struct lpm_history *history = &per_cpu(hist, dev->cpu);
+	uint64_t max, avg, stddev;
+	int64_t thresh = LLONG_MAX;
+	int i, divisor;
+
+	if (!lpm_prediction || history->nsamp < MAXSAMPLES)
+		return 0;
+
+again:
+	max = avg = divisor = stddev = 0;
+	for (i = 0; i < MAXSAMPLES; i++) {
+		int64_t value = history->resi[i];
+
+		if (value <= thresh) {
+			avg += value;
+			divisor++;
+			if (value > max)
+				max = value;
+		}
+	}
+	do_div(avg, divisor);
+
+	for (i = 0; i < MAXSAMPLES; i++) {
+		int64_t value = history->resi[i];
+
+		if (value <= thresh) {
+			int64_t diff = value - avg;
+
+			stddev += diff * diff;
+		}
+	}
+	do_div(stddev, divisor);
+	stddev = int_sqrt(stddev);
+
+	if (((avg > stddev * 6) && (divisor >= (MAXSAMPLES - 1)))
+			|| stddev <= PRED_REF_STDDEV_US)
+		return (uint32_t)avg;
+	else if (divisor > (MAXSAMPLES - 1)) {
+		thresh = max - 1;
+		goto again;
+	}
+
+	return 0;
+}
+
+static void update_history(struct cpuidle_device *dev, int idx,
+		uint32_t resi_us)
+{
+	struct lpm_history *history = &per_cpu(hist, dev->cpu);
+	struct lpm_cluster *cluster = per_cpu(cpu_cluster, dev->cpu);
+	uint32_t *residency = get_per_cpu_max_residency(dev->cpu);
+	bool htmr_wkup = false;
+
+	if (history->htmr_expires.tv64 &&
+		ktime_compare(ktime_get(), history->htmr_expires) >= 0)
+		htmr_wkup = true;
+	histtimer_cancel();
+	history->pred_wakeup.tv64 = 0;
+
+	if (idx > 0 && idx < cluster->cpu->nlevels &&
+			resi_us < residency[idx - 1]) {
+		if (history->pred_used)
+			history->nr_too_deep_pred++;
+		else
+			history->nr_too_deep_tmr++;
+	}
+
+	/*
+	 * A wakeup from the misprediction timer means the history did not
+	 * describe this idle period; fall back to timer based selection
+	 * until enough new samples have been collected.
+	 */
+	if (htmr_wkup) {
+		history->nr_too_shallow++;
+		clear_predict_history(history);
+		return;
+	}
+
+	if (resi_us + PRED_TIMER_ADD_US >= history->sleep_us)
+		history->nr_wake_tmr++;
+	else
+		history->nr_wake_irq++;
+
+	history->resi[history->hptr] = resi_us;
+	if (history->nsamp < MAXSAMPLES)
+		history->nsamp++;
+	if (++history->hptr >= MAXSAMPLES)
+		history->hptr = 0;
+}
+
 static int cpu_power_select(struct cpuidle_device *dev,
 		struct lpm_cpu *cpu)
 {
@@ -460,11 +624,18 @@ static int cpu_power_select(struct cpuidle_device *dev,
 	int i;
 	uint32_t lvl_latency_us = 0;
 	uint32_t *residency = get_per_cpu_max_residency(dev->cpu);
+	struct lpm_history *history = &per_cpu(hist, dev->cpu);
+	uint32_t predicted;
+	bool pred_used = false;
+
+	history->pred_used = false;
+	history->sleep_us = 0;
 
 	if (sleep_disabled || sleep_us  < 0)
 		return 0;
 
 	next_event_us = (uint32_t)(ktime_to_us(get_next_event_time(dev->cpu)));
+	predicted = lpm_cpu_predict(dev);
 
 	for (i = 0; i < cpu->nlevels; i++) {
 		struct lpm_cpu_level *level = &cpu->levels[i];
@@ -493,6 +664,7 @@ static int cpu_power_select(struct cpuidle_device *dev,
 		}
 
 		best_level = i;
+		history->sleep_us = next_wakeup_us;
 
 		if (next_event_us && next_event_us < sleep_us &&
 				(mode != MSM_PM_SLEEP_MODE_WAIT_FOR_INTERRUPT))
@@ -503,11 +675,30 @@ static int cpu_power_select(struct cpuidle_device *dev,
 
 		if (next_wakeup_us <= residency[i])
 			break;
+
+		if (predicted && predicted <= residency[i]) {
+			pred_used = true;
+			break;
+		}
 	}
 
 	if (modified_time_us)
 		msm_pm_set_timer(modified_time_us);
 
+	/*
+	 * When the prediction kept the CPU in a shallower level than its
+	 * timers allow, arm a timer slightly past the predicted wakeup so a
+	 * misprediction costs at most one re-selection.
+	 */
+	history->pred_used = pred_used;
+	if (pred_used) {
+		history->nr_sel_pred++;
+		history->pred_wakeup = ktime_add_us(ktime_get(), predicted);
+		histtimer_start(predicted + PRED_TIMER_ADD_US);
+	} else {
+		history->nr_sel_tmr++;
+	}
+
 	trace_cpu_power_select(best_level, sleep_us, latency_us, next_event_us);
 
 	return best_level;
@@ -538,11 +729,17 @@ static uint64_t get_cluster_sleep_time(struct lpm_cluster *cluster,
 			&cluster->num_children_in_sync, cpu_online_mask);
 
 	for_each_cpu(cpu, &online_cpus_in_cluster) {
+		ktime_t pred_wakeup = per_cpu(hist, cpu).pred_wakeup;
+
 		td = &per_cpu(tick_cpu_device, cpu);
 		if (td->evtdev->next_event.tv64 < next_event.tv64) {
 			next_event.tv64 = td->evtdev->next_event.tv64;
 			next_cpu = cpu;
 		}
+		if (pred_wakeup.tv64 && pred_wakeup.tv64 < next_event.tv64) {
+			next_event.tv64 = pred_wakeup.tv64;
+			next_cpu = cpu;
+		}
 	}
 
 	if (mask)
@@ -555,6 +752,30 @@ static uint64_t get_cluster_sleep_time(struct lpm_cluster *cluster,
 		return 0;
 }
 
+/*
+ * Earliest event_timer deadline of the online CPUs in the cluster, in
+ * microseconds from now, or 0 if none of them has an event scheduled.
+ */
+static uint32_t get_cluster_event_time(struct lpm_cluster *cluster)
+{
+	int cpu;
+	uint32_t next_event_us = 0;
+	struct cpumask online_cpus_in_cluster;
+
+	cpumask_and(&online_cpus_in_cluster, &cluster->child_cpus,
+			cpu_online_mask);
+
+	for_each_cpu(cpu, &online_cpus_in_cluster) {
+		uint32_t event_us =
+			(uint32_t)ktime_to_us(get_next_event_time(cpu));
+
+		if (event_us && (!next_event_us || event_us < next_event_us))
+			next_event_us = event_us;
+	}
+
+	return next_event_us;
+}
+
 static int cluster_select(struct lpm_cluster *cluster, bool from_idle)
 {
 	int best_level = -1;
@@ -562,11 +783,14 @@ static int cluster_select(struct lpm_cluster *cluster, bool from_idle)
 	struct cpumask mask;
 	uint32_t latency_us = ~0U;
 	uint32_t sleep_us;
+	uint32_t next_event_us = 0;
 
 	if (!cluster)
 		return -EINVAL;
 
 	sleep_us = (uint32_t)get_cluster_sleep_time(cluster, NULL, from_idle);
+	if (from_idle)
+		next_event_us = get_cluster_event_time(cluster);
 
 	if (cpumask_and(&mask, cpu_online_mask, &cluster->child_cpus))
 		latency_us = pm_qos_request_for_cpumask(PM_QOS_CPU_DMA_LATENCY,
@@ -586,6 +810,7 @@ static int cluster_select(struct lpm_cluster *cluster, bool from_idle)
 	for (i = 0; i < cluster->nlevels; i++) {
 		struct lpm_cluster_level *level = &cluster->levels[i];
 		struct power_params *pwr_params = &level->pwr;
+		uint32_t next_wakeup_us = sleep_us;
 
 		if (!lpm_cluster_mode_allow(cluster, i, from_idle))
 			continue;
@@ -601,7 +826,21 @@ static int cluster_select(struct lpm_cluster *cluster, bool from_idle)
 		if (from_idle && latency_us < pwr_params->latency_us)
 			break;
 
-		if (sleep_us < pwr_params->time_overhead_us)
+		/*
+		 * An event_timer deadline (e.g. display vsync) must be met
+		 * including the exit latency of the level, so it cuts the
+		 * usable sleep time short just like it does for the CPUs.
+		 */
+		if (next_event_us) {
+			if (next_event_us < pwr_params->latency_us)
+				break;
+
+			if (next_event_us - pwr_params->latency_us < sleep_us)
+				next_wakeup_us = next_event_us -
+					pwr_params->latency_us;
+		}
+
+		if (next_wakeup_us < pwr_params->time_overhead_us)
 			break;
 
 		if (suspend_in_progress && from_idle && level->notify_rpm)
@@ -612,7 +851,7 @@ static int cluster_select(struct lpm_cluster *cluster, bool from_idle)
 
 		best_level = i;
 
-		if (from_idle && sleep_us <= pwr_params->max_residency)
+		if (from_idle && next_wakeup_us <= pwr_params->max_residency)
 			break;
 	}
 
@@ -1032,6 +1271,7 @@ static int lpm_cpuidle_enter(struct cpuidle_device *dev,
 	int64_t start_time = ktime_to_ns(ktime_get()), end_time;
 	struct power_params *pwr_params;
 	struct clk *cpu_clk = per_cpu(cpu_clocks, dev->cpu);
+	uint32_t resi_us;
 
 	pwr_params = &cluster->cpu->levels[idx].pwr;
 	sched_set_cpu_cstate(smp_processor_id(), idx + 1,
@@ -1078,7 +1318,10 @@ exit:
 	sched_set_cpu_cstate(smp_processor_id(), 0, 0, 0);
 	trace_cpu_idle_exit(idx, success);
 	end_time = ktime_to_ns(ktime_get()) - start_time;
-	dev->last_residency = do_div(end_time, 1000);
+	do_div(end_time, 1000);
+	resi_us = (uint32_t)min_t(int64_t, end_time, UINT_MAX);
+	dev->last_residency = resi_us;
+	update_history(dev, idx, resi_us);
 	local_irq_enable();
 
 	return idx;
@@ -1354,12 +1597,52 @@ static void lpm_clk_init(struct platform_device *pdev)
 	}
 }
 
+static int lpm_prediction_show(struct seq_file *m, void *unused)
+{
+	int cpu;
+
+	seq_printf(m, "%-4s %12s %12s %12s %12s %12s %12s %12s\n", "cpu",
+			"sel_tmr", "sel_pred", "wake_tmr", "wake_irq",
+			"deep_tmr", "deep_pred", "shallow");
+	for_each_possible_cpu(cpu) {
+		struct lpm_history *history = &per_cpu(hist, cpu);
+
+		seq_printf(m,
+			"%-4d %12llu %12llu %12llu %12llu %12llu %12llu %12llu\n",
+			cpu, history->nr_sel_tmr, history->nr_sel_pred,
+			history->nr_wake_tmr, history->nr_wake_irq,
+			history->nr_too_deep_tmr, history->nr_too_deep_pred,
+			history->nr_too_shallow);
+	}
+	return 0;
+}
+
+static int lpm_prediction_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lpm_prediction_show, inode->i_private);
+}
+
+static const struct file_operations lpm_prediction_fops = {
+	.open = lpm_prediction_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 static int lpm_probe(struct platform_device *pdev)
 {
 	int ret;
 	int size;
+	int cpu;
 	struct kobject *module_kobj = NULL;
 
+	for_each_possible_cpu(cpu) {
+		struct hrtimer *cpu_histtimer = &per_cpu(histtimer, cpu);
+
+		hrtimer_init(cpu_histtimer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+		cpu_histtimer->function = histtimer_fn;
+	}
+
 	get_online_cpus();
 	lpm_root_node = lpm_of_parse_cluster(pdev);
 
@@ -1421,6 +1704,9 @@ static int lpm_probe(struct platform_device *pdev)
 		goto failed;
 	}
 
+	debugfs_create_file("lpm_prediction", S_IRUGO, NULL, NULL,
+			&lpm_prediction_fops);
+
 	return 0;
 failed:
 	free_cluster_node(lpm_root_node);
@@ -62,6 +62,25 @@
 
 #define QCRYPTO_HIGH_BANDWIDTH_TIMEOUT 1000
 
+/*
+ * AES ECB/CBC/CTR requests of up to sw_dispatch_len bytes are run on the
+ * CPU (ARMv8 CE/NEON through the fallback tfm) since they do not amortise
+ * the BAM descriptor setup. While sw_dispatch_qlen or more requests are
+ * waiting for an engine, requests of up to QCRYPTO_SW_DISPATCH_MAX_LEN
+ * bytes are also moved to the CPU. A value of 0 disables either rule.
+ */
+#define QCRYPTO_SW_DISPATCH_MAX_LEN	4096
+
+static unsigned int sw_dispatch_len = 256;
+module_param(sw_dispatch_len, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(sw_dispatch_len,
+		"Max AES request size always handled on the CPU");
+
+static unsigned int sw_dispatch_qlen = 16;
+module_param(sw_dispatch_qlen, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(sw_dispatch_qlen,
+		"Engine queue length above which AES requests use the CPU");
+
 
 
 /* Status of response workq */
@@ -112,6 +131,7 @@ struct crypto_stat {
 	u64 ablk_cipher_des_dec;
 	u64 ablk_cipher_3des_enc;
 	u64 ablk_cipher_3des_dec;
+	u64 ablk_cipher_aes_sw_dispatch;
 	u64 ablk_cipher_op_success;
 	u64 ablk_cipher_op_fail;
 	u64 sha1_digest;
@@ -417,6 +437,7 @@ struct qcrypto_cipher_ctx {
 	u8 ccm4309_nonce[QCRYPTO_CCM4309_NONCE_LEN];
 
 	struct crypto_ablkcipher *cipher_aes192_fb;
+	bool fb_key_valid;	/* cipher_aes192_fb holds enc_key */
 
 	struct crypto_ahash *ahash_aead_aes192_fb;
 };
@@ -1099,6 +1120,9 @@ static int _disp_stats(int id)
 	len += scnprintf(_debug_read_buf + len, DEBUG_MAX_RW_BUF - len - 1,
 			"   ABLK CIPHER AES decryption          : %llu\n",
 					pstat->ablk_cipher_aes_dec);
+	len += scnprintf(_debug_read_buf + len, DEBUG_MAX_RW_BUF - len - 1,
+			"   ABLK CIPHER AES dispatched to CPU   : %llu\n",
+					pstat->ablk_cipher_aes_sw_dispatch);
 
 	len += scnprintf(_debug_read_buf + len, DEBUG_MAX_RW_BUF - len - 1,
 			"   ABLK CIPHER DES encryption          : %llu\n",
@@ -1371,6 +1395,7 @@ static int _qcrypto_setkey_aes(struct crypto_ablkcipher *cipher, const u8 *key,
 	struct qcrypto_cipher_ctx *ctx = crypto_tfm_ctx(tfm);
 	struct crypto_priv *cp = ctx->cp;
 
+	ctx->fb_key_valid = false;
 	if ((ctx->flags & QCRYPTO_CTX_USE_HW_KEY) == QCRYPTO_CTX_USE_HW_KEY)
 		return 0;
 
@@ -1391,6 +1416,18 @@ static int _qcrypto_setkey_aes(struct crypto_ablkcipher *cipher, const u8 *key,
 			}
 		}
 	}
+
+	/* keep the CPU path keyed so requests can be dispatched to it */
+	if (ctx->cipher_aes192_fb && key != NULL &&
+			!(ctx->flags & QCRYPTO_CTX_USE_PIPE_KEY)) {
+		crypto_ablkcipher_clear_flags(ctx->cipher_aes192_fb,
+				CRYPTO_TFM_REQ_MASK);
+		crypto_ablkcipher_set_flags(ctx->cipher_aes192_fb,
+				crypto_ablkcipher_get_flags(cipher) &
+				CRYPTO_TFM_REQ_MASK);
+		ctx->fb_key_valid = !crypto_ablkcipher_setkey(
+				ctx->cipher_aes192_fb, key, len);
+	}
 	return 0;
 };
 
@@ -2368,9 +2405,6 @@ static int _start_qcrypto_process(struct crypto_priv *cp,
 	struct qcrypto_req_control *pqcrypto_req_control;
 	unsigned int cpu = MAX_SMP_CPU;
 
-	if (ACCESS_ONCE(cp->ce_req_proc_sts) == STOPPED)
-		return 0;
-
 	if (in_interrupt()) {
 		cpu = smp_processor_id();
 		if (cpu >= MAX_SMP_CPU)
@@ -2381,6 +2415,9 @@ static int _start_qcrypto_process(struct crypto_priv *cp,
 	pstat = &_qcrypto_stat;
 
 again:
+	if (ACCESS_ONCE(cp->ce_req_proc_sts) == STOPPED)
+		return 0;
+
 	spin_lock_irqsave(&cp->lock, flags);
 	if (pengine->issue_req ||
 		atomic_read(&pengine->req_count) >= (pengine->max_req)) {
@@ -2503,9 +2540,14 @@ again:
 				pstat->aead_op_fail++;
 
 		_qcrypto_tfm_complete(pengine, type, tfm_ctx, arsp, ret);
-		goto again;
 	};
-	return ret;
+	/*
+	 * Keep issuing until the engine has max_req requests in flight
+	 * or the queues are drained, so that the BAM pipeline is refilled
+	 * to full depth after a bandwidth vote or a backlog restart rather
+	 * than one request per completion.
+	 */
+	goto again;
 }
 
 static inline struct crypto_engine *_next_eng(struct crypto_priv *cp,
@@ -2597,6 +2639,48 @@ static int _qcrypto_queue_req(struct crypto_priv *cp,
 	return ret;
 }
 
+/*
+ * Pick the CPU over the crypto engine for an AES ECB/CBC/CTR request
+ * that is short, or mid-sized while the engine queues are backed up.
+ * Only done when no request of the same tfm is outstanding on the
+ * engine, so that per-tfm completion order is kept.
+ */
+static bool _qcrypto_aes_sw_dispatch(struct ablkcipher_request *req)
+{
+	struct qcrypto_cipher_ctx *ctx = crypto_tfm_ctx(req->base.tfm);
+	struct crypto_priv *cp = ctx->cp;
+	unsigned int len_limit = ACCESS_ONCE(sw_dispatch_len);
+	unsigned int qlen_limit = ACCESS_ONCE(sw_dispatch_qlen);
+	unsigned long flags;
+	unsigned int qlen;
+	bool use_sw = false;
+
+	if (!ctx->cipher_aes192_fb || !ctx->fb_key_valid ||
+			(ctx->flags & QCRYPTO_CTX_KEY_MASK))
+		return false;
+
+	if (req->nbytes > len_limit &&
+		(!qlen_limit || req->nbytes > QCRYPTO_SW_DISPATCH_MAX_LEN))
+		return false;
+
+	spin_lock_irqsave(&cp->lock, flags);
+	if (list_empty(&ctx->rsp_queue)) {
+		if (req->nbytes <= len_limit) {
+			use_sw = true;
+		} else {
+			qlen = cp->req_queue.qlen;
+			if (ctx->pengine)
+				qlen += ctx->pengine->req_queue.qlen;
+			use_sw = (qlen >= qlen_limit);
+		}
+	}
+	spin_unlock_irqrestore(&cp->lock, flags);
+
+	if (use_sw)
+		_qcrypto_stat.ablk_cipher_aes_sw_dispatch++;
+	return use_sw;
+}
+
 static int _qcrypto_enc_aes_192_fallback(struct ablkcipher_request *req)
 {
 	struct crypto_tfm *tfm =
@@ -2644,6 +2728,9 @@ static int _qcrypto_enc_aes_ecb(struct ablkcipher_request *req)
 				ctx->cipher_aes192_fb)
 		return _qcrypto_enc_aes_192_fallback(req);
 
+	if (_qcrypto_aes_sw_dispatch(req))
+		return _qcrypto_enc_aes_192_fallback(req);
+
 	rctx = ablkcipher_request_ctx(req);
 	rctx->aead = 0;
 	rctx->alg = CIPHER_ALG_AES;
@@ -2674,6 +2761,9 @@ static int _qcrypto_enc_aes_cbc(struct ablkcipher_request *req)
 				ctx->cipher_aes192_fb)
 		return _qcrypto_enc_aes_192_fallback(req);
 
+	if (_qcrypto_aes_sw_dispatch(req))
+		return _qcrypto_enc_aes_192_fallback(req);
+
 	rctx = ablkcipher_request_ctx(req);
 	rctx->aead = 0;
 	rctx->alg = CIPHER_ALG_AES;
@@ -2704,6 +2794,9 @@ static int _qcrypto_enc_aes_ctr(struct ablkcipher_request *req)
 				ctx->cipher_aes192_fb)
 		return _qcrypto_enc_aes_192_fallback(req);
 
+	if (_qcrypto_aes_sw_dispatch(req))
+		return _qcrypto_enc_aes_192_fallback(req);
+
 	rctx = ablkcipher_request_ctx(req);
 	rctx->aead = 0;
 	rctx->alg = CIPHER_ALG_AES;
@@ -2888,6 +2981,9 @@ static int _qcrypto_dec_aes_ecb(struct ablkcipher_request *req)
 				ctx->cipher_aes192_fb)
 		return _qcrypto_dec_aes_192_fallback(req);
 
+	if (_qcrypto_aes_sw_dispatch(req))
+		return _qcrypto_dec_aes_192_fallback(req);
+
 	rctx = ablkcipher_request_ctx(req);
 	rctx->aead = 0;
 	rctx->alg = CIPHER_ALG_AES;
@@ -2918,6 +3014,9 @@ static int _qcrypto_dec_aes_cbc(struct ablkcipher_request *req)
 				ctx->cipher_aes192_fb)
 		return _qcrypto_dec_aes_192_fallback(req);
 
+	if (_qcrypto_aes_sw_dispatch(req))
+		return _qcrypto_dec_aes_192_fallback(req);
+
 	rctx = ablkcipher_request_ctx(req);
 	rctx->aead = 0;
 	rctx->alg = CIPHER_ALG_AES;
@@ -2948,6 +3047,9 @@ static int _qcrypto_dec_aes_ctr(struct ablkcipher_request *req)
 				ctx->cipher_aes192_fb)
 		return _qcrypto_dec_aes_192_fallback(req);
 
+	if (_qcrypto_aes_sw_dispatch(req))
+		return _qcrypto_dec_aes_192_fallback(req);
+
 	rctx = ablkcipher_request_ctx(req);
 	rctx->aead = 0;
 	rctx->alg = CIPHER_ALG_AES;
@@ -36,6 +36,7 @@ enum ev_index {
 	INST_IDX,
 	L2DM_IDX,
 	CYC_IDX,
+	STALL_IDX,
 	NUM_EVENTS
 };
 #define INST_EV		0x08
@@ -56,6 +57,7 @@ static DEFINE_PER_CPU(struct memlat_hwmon_data, pm_data);
 
 struct cpu_grp_info {
 	cpumask_t cpus;
+	unsigned int stall_ev;
 	struct memlat_hwmon hw;
 	struct notifier_block arm_memlat_cpu_notif;
 };
@@ -100,7 +102,7 @@ static void read_perf_counters(int cpu, struct cpu_grp_info *cpu_grp)
 	int cpu_idx;
 	struct memlat_hwmon_data *hw_data = &per_cpu(pm_data, cpu);
 	struct memlat_hwmon *hw = &cpu_grp->hw;
-	unsigned long cyc_cnt;
+	unsigned long cyc_cnt, stall_cnt;
 
 	if (hw_data->init_pending)
 		return;
@@ -115,6 +117,15 @@ static void read_perf_counters(int cpu, struct cpu_grp_info *cpu_grp)
 
 	cyc_cnt = read_event(&hw_data->events[CYC_IDX]);
 	hw->core_stats[cpu_idx].freq = compute_freq(hw_data, cyc_cnt);
+
+	if (hw_data->events[STALL_IDX].pevent && cyc_cnt) {
+		stall_cnt = read_event(&hw_data->events[STALL_IDX]);
+		stall_cnt *= 100;
+		do_div(stall_cnt, cyc_cnt);
+		hw->core_stats[cpu_idx].stall_pct = min(stall_cnt, 100UL);
+	} else {
+		hw->core_stats[cpu_idx].stall_pct = 0;
+	}
 }
 
 static unsigned long get_cnt(struct memlat_hwmon *hw)
@@ -135,7 +146,10 @@ static void delete_events(struct memlat_hwmon_data *hw_data)
 
 	for (i = 0; i < NUM_EVENTS; i++) {
 		hw_data->events[i].prev_count = 0;
+		if (!hw_data->events[i].pevent)
+			continue;
 		perf_event_release_kernel(hw_data->events[i].pevent);
+		hw_data->events[i].pevent = NULL;
 	}
 }
 
@@ -159,6 +173,7 @@ static void stop_hwmon(struct memlat_hwmon *hw)
 		hw->core_stats[idx].inst_count = 0;
 		hw->core_stats[idx].mem_count = 0;
 		hw->core_stats[idx].freq = 0;
+		hw->core_stats[idx].stall_pct = 0;
 	}
 	put_online_cpus();
 
@@ -181,7 +196,8 @@ static struct perf_event_attr *alloc_attr(void)
 	return attr;
 }
 
-static int set_events(struct memlat_hwmon_data *hw_data, int cpu)
+static int set_events(struct memlat_hwmon_data *hw_data, int cpu,
+		      unsigned int stall_ev)
 {
 	struct perf_event *pevent;
 	struct perf_event_attr *attr;
@@ -213,6 +229,16 @@ static int set_events(struct memlat_hwmon_data *hw_data, int cpu)
 	hw_data->events[CYC_IDX].pevent = pevent;
 	perf_event_enable(hw_data->events[CYC_IDX].pevent);
 
+	if (stall_ev) {
+		attr->config = stall_ev;
+		pevent = perf_event_create_kernel_counter(attr, cpu, NULL,
+							  NULL, NULL);
+		if (IS_ERR(pevent))
+			goto err_out;
+		hw_data->events[STALL_IDX].pevent = pevent;
+		perf_event_enable(hw_data->events[STALL_IDX].pevent);
+	}
+
 	kfree(attr);
 	return 0;
 
@@ -227,11 +253,13 @@ static int arm_memlat_cpu_callback(struct notifier_block *nb,
 {
 	unsigned long cpu = (unsigned long)hcpu;
 	struct memlat_hwmon_data *hw_data = &per_cpu(pm_data, cpu);
+	struct cpu_grp_info *cpu_grp = container_of(nb,
+				struct cpu_grp_info, arm_memlat_cpu_notif);
 
 	if ((action != CPU_ONLINE) || !hw_data->init_pending)
 		return NOTIFY_OK;
 
-	if (set_events(hw_data, cpu))
+	if (set_events(hw_data, cpu, cpu_grp->stall_ev))
 		pr_warn("Failed to create perf event for CPU%lu\n", cpu);
 
 	hw_data->init_pending = false;
@@ -251,7 +279,7 @@ static int start_hwmon(struct memlat_hwmon *hw)
 	get_online_cpus();
 	for_each_cpu(cpu, &cpu_grp->cpus) {
 		hw_data = &per_cpu(pm_data, cpu);
-		ret = set_events(hw_data, cpu);
+		ret = set_events(hw_data, cpu, cpu_grp->stall_ev);
 		if (ret) {
 			if (!cpu_online(cpu)) {
 				hw_data->init_pending = true;
@@ -319,6 +347,12 @@ static int arm_memlat_mon_driver_probe(struct platform_device *pdev)
 		return -ENODEV;
 	}
 
+	/*
+	 * Optional raw PMU event counting cycles stalled on memory, e.g.
+	 * an implementation defined load/store stall event on Cortex-A53.
+	 */
+	of_property_read_u32(dev->of_node, "qcom,stall-ev", &cpu_grp->stall_ev);
+
 	hw->num_cores = cpumask_weight(&cpu_grp->cpus);
 	hw->core_stats = devm_kzalloc(dev, hw->num_cores *
 				sizeof(*(hw->core_stats)), GFP_KERNEL);
@@ -52,6 +52,8 @@ struct hwmon_node {
 	unsigned int low_power_io_percent;
 	unsigned int low_power_delay;
 	unsigned int mbps_zones[NUM_MBPS_ZONES];
+	unsigned int zone_ramp;
+	unsigned int zone_down_count;
 
 	unsigned long prev_ab;
 	unsigned long *dev_ab;
@@ -71,6 +73,8 @@ struct hwmon_node {
 	unsigned long down_wake_mbps;
 	unsigned int wake;
 	unsigned int down_cnt;
+	unsigned int cur_zone;
+	unsigned int zone_down_cnt;
 	ktime_t prev_ts;
 	ktime_t hist_max_ts;
 	bool sampled;
@@ -264,6 +268,55 @@ unsigned long to_mbps_zone(struct hwmon_node *node, unsigned long mbps)
 	return node->hw->df->max_freq;
 }
 
+/*
+ * Index of the mbps zone that a bandwidth of @mbps falls in, after
+ * converting it to the zone's frequency units. Bandwidth above the last
+ * zone maps to the number of configured zones.
+ */
+static unsigned int to_mbps_zone_idx(struct hwmon_node *node,
+				     unsigned long mbps,
+				     unsigned int io_percent)
+{
+	unsigned int i;
+
+	mbps = (mbps * 100) / io_percent;
+	for (i = 0; i < NUM_MBPS_ZONES && node->mbps_zones[i]; i++)
+		if (node->mbps_zones[i] >= mbps)
+			break;
+
+	return i;
+}
+
+/*
+ * With zone_ramp, the vote moves between mbps zones instead of tracking
+ * the measurement: a wake up vote covers the whole zone the burst falls
+ * in, and the vote only drops to a lower zone once the measurement has
+ * stayed there for zone_down_count decision windows. The IRQ threshold
+ * is placed at the upper edge of the current zone, so the next interrupt
+ * means the traffic has moved into a higher zone.
+ */
+static unsigned long zone_ramp_req(struct hwmon_node *node,
+				   unsigned long meas_mbps_zone,
+				   unsigned long req_mbps,
+				   unsigned int io_percent)
+{
+	unsigned int zone;
+
+	if (node->wake == UP_WAKE)
+		req_mbps = max(req_mbps, meas_mbps_zone);
+
+	zone = to_mbps_zone_idx(node, req_mbps, io_percent);
+	if (zone < node->cur_zone &&
+	    ++node->zone_down_cnt < node->zone_down_count) {
+		/* Hold the previous zone's vote until the drop persists */
+		return max(req_mbps, node->prev_req);
+	}
+
+	node->cur_zone = zone;
+	node->zone_down_cnt = 0;
+	return req_mbps;
+}
+
 #define MIN_MBPS	500UL
 #define HIST_PEAK_TOL	60
 static unsigned long get_bw_and_set_irq(struct hwmon_node *node,
@@ -386,6 +439,10 @@ static unsigned long get_bw_and_set_irq(struct hwmon_node *node,
 			req_mbps = max(req_mbps, node->hyst_mbps);
 	}
 
+	if (node->zone_ramp && node->mbps_zones[0])
+		req_mbps = zone_ramp_req(node, meas_mbps_zone, req_mbps,
+					 io_percent);
+
 	/* Stretch the short sample window size, if the traffic is too low */
 	if (meas_mbps < MIN_MBPS) {
 		node->up_wake_mbps = (max(MIN_MBPS, req_mbps)
@@ -405,6 +462,17 @@ static unsigned long get_bw_and_set_irq(struct hwmon_node *node,
 		node->down_wake_mbps = (meas_mbps * node->down_thres) / 100;
 		thres = mbps_to_bytes(meas_mbps, node->sample_ms);
 	}
+
+	if (node->zone_ramp && node->mbps_zones[0] &&
+	    node->cur_zone < NUM_MBPS_ZONES &&
+	    node->mbps_zones[node->cur_zone]) {
+		unsigned long zone_top;
+
+		zone_top = ((unsigned long)node->mbps_zones[node->cur_zone]
+				* io_percent) / 100;
+		node->up_wake_mbps = max(zone_top, MIN_MBPS);
+		thres = mbps_to_bytes(node->up_wake_mbps, node->sample_ms);
+	}
 	node->down_cnt = node->down_count;
 
 	node->bytes = hw->set_thres(hw, thres);
@@ -502,6 +570,8 @@ static int start_monitor(struct devfreq *df, bool init)
 		node->prev_ab = 0;
 		node->resume_freq = 0;
 		node->resume_ab = 0;
+		node->cur_zone = 0;
+		node->zone_down_cnt = 0;
 		mbps = (df->previous_freq * node->io_percent) / 100;
 		ret = hw->start_hwmon(hw, mbps);
 	} else {
@@ -731,6 +801,8 @@ gov_attr(low_power_ceil_mbps, 0U, 2500U);
 gov_attr(low_power_io_percent, 1U, 100U);
 gov_attr(low_power_delay, 1U, 60U);
 gov_list_attr(mbps_zones, NUM_MBPS_ZONES, 0U, UINT_MAX);
+gov_attr(zone_ramp, 0U, 1U);
+gov_attr(zone_down_count, 0U, 90U);
 
 static struct attribute *dev_attr[] = {
 	&dev_attr_guard_band_mbps.attr,
@@ -750,6 +822,8 @@ static struct attribute *dev_attr[] = {
 	&dev_attr_low_power_io_percent.attr,
 	&dev_attr_low_power_delay.attr,
 	&dev_attr_mbps_zones.attr,
+	&dev_attr_zone_ramp.attr,
+	&dev_attr_zone_down_count.attr,
 	&dev_attr_throttle_adj.attr,
 	NULL,
 };
@@ -893,6 +967,8 @@ int register_bw_hwmon(struct device *dev, struct bw_hwmon *hwmon)
 	node->hyst_length = 0;
 	node->idle_mbps = 400;
 	node->mbps_zones[0] = 0;
+	node->zone_ramp = 0;
+	node->zone_down_count = 3;
 	node->hw = hwmon;
 
 	mutex_lock(&list_lock);
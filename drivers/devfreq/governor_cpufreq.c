@@ -22,6 +22,7 @@
 #include <linux/of.h>
 #include <linux/module.h>
 #include "governor.h"
+#include "governor_memlat.h"
 
 struct cpu_state {
 	unsigned int freq;
@@ -47,6 +48,7 @@ struct devfreq_node {
 	struct freq_map **map;
 	struct freq_map *common_map;
 	unsigned int timeout;
+	unsigned int mem_aware;
 	struct delayed_work dwork;
 	bool drop;
 	unsigned long prev_tgt;
@@ -235,6 +237,19 @@ static struct notifier_block cpufreq_trans_nb = {
 	.notifier_call = cpufreq_trans_notifier
 };
 
+static int memlat_state_notifier(struct notifier_block *nb,
+		unsigned long event, void *data)
+{
+	mutex_lock(&state_lock);
+	update_all_devfreqs();
+	mutex_unlock(&state_lock);
+	return 0;
+}
+
+static struct notifier_block memlat_nb = {
+	.notifier_call = memlat_state_notifier
+};
+
 static int register_cpufreq(void)
 {
 	int ret = 0;
@@ -259,6 +274,7 @@ static int register_cpufreq(void)
 				CPUFREQ_POLICY_NOTIFIER);
 		goto out;
 	}
+	memlat_register_notifier(&memlat_nb);
 
 	for_each_online_cpu(cpu) {
 		policy = cpufreq_cpu_get(cpu);
@@ -290,6 +306,7 @@ static int unregister_cpufreq(void)
 				CPUFREQ_POLICY_NOTIFIER);
 	cpufreq_unregister_notifier(&cpufreq_trans_nb,
 				CPUFREQ_TRANSITION_NOTIFIER);
+	memlat_unregister_notifier(&memlat_nb);
 
 	for (cpu = ARRAY_SIZE(state) - 1; cpu >= 0; cpu--) {
 		if (!state[cpu])
@@ -329,6 +346,29 @@ static unsigned int interpolate_freq(struct devfreq *df, unsigned int cpu)
 	return dev_min + mult_frac(dev_max - dev_min, cpu_percent, 100);
 }
 
+/*
+ * A cluster counts as memory intensive unless memlat monitors its CPUs
+ * and found none of them latency bound or stalled on memory in its last
+ * sample. Clusters memlat does not monitor keep the mapped vote.
+ */
+static bool cluster_mem_intensive(unsigned int cpu)
+{
+	unsigned int i;
+	bool lat_bound, stalled, monitored = false;
+
+	for_each_possible_cpu(i) {
+		if (state[i] != state[cpu])
+			continue;
+		if (memlat_get_cpu_state(i, &lat_bound, &stalled))
+			continue;
+		if (lat_bound || stalled)
+			return true;
+		monitored = true;
+	}
+
+	return !monitored;
+}
+
 static unsigned int cpu_to_dev_freq(struct devfreq *df, unsigned int cpu)
 {
 	struct freq_map *map = NULL;
@@ -347,6 +387,21 @@ static unsigned int cpu_to_dev_freq(struct devfreq *df, unsigned int cpu)
 
 	cpu_khz = state[cpu]->freq;
 
+	/*
+	 * With mem_aware, a compute bound cluster gets the lower of the
+	 * mapped vote and memlat's vote, which is the floor of the mapping
+	 * since memlat found nothing waiting on memory.
+	 */
+	if (n->mem_aware && !cluster_mem_intensive(cpu)) {
+		if (map)
+			freq = map->target_freq;
+		else if (df->profile->freq_table)
+			freq = df->profile->freq_table[0];
+		else
+			freq = df->min_freq;
+		goto out;
+	}
+
 	if (!map) {
 		freq = interpolate_freq(df, cpu);
 		goto out;
@@ -450,10 +505,12 @@ static ssize_t show_map(struct device *dev, struct device_attribute *attr,
 
 static DEVICE_ATTR(freq_map, 0444, show_map, NULL);
 gov_attr(timeout, 0U, 100U);
+gov_attr(mem_aware, 0U, 1U);
 
 static struct attribute *dev_attr[] = {
 	&dev_attr_freq_map.attr,
 	&dev_attr_timeout.attr,
+	&dev_attr_mem_aware.attr,
 	NULL,
 };
 
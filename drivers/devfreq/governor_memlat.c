@@ -24,10 +24,12 @@
 #include <linux/err.h>
 #include <linux/errno.h>
 #include <linux/mutex.h>
+#include <linux/spinlock.h>
 #include <linux/interrupt.h>
 #include <linux/platform_device.h>
 #include <linux/of.h>
 #include <linux/devfreq.h>
+#include <linux/sched.h>
 #include "governor.h"
 #include "governor_memlat.h"
 
@@ -37,6 +39,9 @@ struct memlat_node {
 	unsigned int ratio_ceil;
 	unsigned int freq_thresh_mhz;
 	unsigned int mult_factor;
+	unsigned int stall_floor;
+	unsigned int window_align;
+	unsigned int user_polling_ms;
 	bool mon_started;
 	struct list_head list;
 	void *orig_data;
@@ -51,6 +56,19 @@ static DEFINE_MUTEX(list_lock);
 static int use_cnt;
 static DEFINE_MUTEX(state_lock);
 
+/*
+ * Latest classification of each monitored CPU, for other governors that
+ * want to know whether a CPU is currently memory bound.
+ */
+struct memlat_cpu_state {
+	bool valid;
+	bool lat_bound;
+	bool stalled;
+};
+static struct memlat_cpu_state memlat_cpu_states[NR_CPUS];
+static DEFINE_SPINLOCK(cpu_state_lock);
+static BLOCKING_NOTIFIER_HEAD(memlat_notifier);
+
 #define show_attr(name) \
 static ssize_t show_##name(struct device *dev,				\
 			struct device_attribute *attr, char *buf)	\
@@ -83,6 +101,76 @@ show_attr(__attr)			\
 store_attr(__attr, min, max)		\
 static DEVICE_ATTR(__attr, 0644, show_##__attr, store_##__attr)
 
+static bool set_cpu_state(int cpu, bool valid, bool lat_bound, bool stalled)
+{
+	struct memlat_cpu_state *s;
+	unsigned long flags;
+	bool changed;
+
+	if (cpu < 0 || cpu >= NR_CPUS)
+		return false;
+
+	s = &memlat_cpu_states[cpu];
+	spin_lock_irqsave(&cpu_state_lock, flags);
+	changed = s->valid != valid || s->lat_bound != lat_bound ||
+		  s->stalled != stalled;
+	s->valid = valid;
+	s->lat_bound = lat_bound;
+	s->stalled = stalled;
+	spin_unlock_irqrestore(&cpu_state_lock, flags);
+
+	return changed;
+}
+
+/**
+ * memlat_get_cpu_state() - Report whether a CPU was memory bound
+ * @cpu:	CPU to query.
+ * @lat_bound:	Set if the CPU's instructions per miss ratio was at or below
+ *		ratio_ceil in the last sample.
+ * @stalled:	Set if the CPU's memory stall percentage was at or above
+ *		stall_floor in the last sample.
+ *
+ * Returns -ENODATA if the CPU is not being monitored by memlat.
+ */
+int memlat_get_cpu_state(int cpu, bool *lat_bound, bool *stalled)
+{
+	struct memlat_cpu_state *s;
+	unsigned long flags;
+	int ret = 0;
+
+	if (cpu < 0 || cpu >= NR_CPUS)
+		return -EINVAL;
+
+	s = &memlat_cpu_states[cpu];
+	spin_lock_irqsave(&cpu_state_lock, flags);
+	if (s->valid) {
+		*lat_bound = s->lat_bound;
+		*stalled = s->stalled;
+	} else {
+		ret = -ENODATA;
+	}
+	spin_unlock_irqrestore(&cpu_state_lock, flags);
+
+	return ret;
+}
+EXPORT_SYMBOL(memlat_get_cpu_state);
+
+/*
+ * Notifiers are called from the memlat sampling context whenever the
+ * classification of any monitored CPU changes.
+ */
+int memlat_register_notifier(struct notifier_block *nb)
+{
+	return blocking_notifier_chain_register(&memlat_notifier, nb);
+}
+EXPORT_SYMBOL(memlat_register_notifier);
+
+int memlat_unregister_notifier(struct notifier_block *nb)
+{
+	return blocking_notifier_chain_unregister(&memlat_notifier, nb);
+}
+EXPORT_SYMBOL(memlat_unregister_notifier);
+
 static unsigned long compute_dev_vote(struct devfreq *df)
 {
 	int i, lat_dev;
@@ -90,6 +178,7 @@ static unsigned long compute_dev_vote(struct devfreq *df)
 	struct memlat_hwmon *hw = node->hw;
 	unsigned long max_freq = 0;
 	unsigned int ratio;
+	bool lat_bound, stalled, changed = false;
 
 	hw->get_cnt(hw);
 
@@ -99,13 +188,24 @@ static unsigned long compute_dev_vote(struct devfreq *df)
 		if (hw->core_stats[i].mem_count)
 			ratio /= hw->core_stats[i].mem_count;
 
+		lat_bound = ratio && ratio <= node->ratio_ceil;
+		stalled = node->stall_floor &&
+			  hw->core_stats[i].stall_pct >= node->stall_floor;
+		changed |= set_cpu_state(hw->core_stats[i].id, true,
+					 lat_bound, stalled);
+
 		trace_memlat_dev_meas(dev_name(df->dev.parent),
 					hw->core_stats[i].id,
 					hw->core_stats[i].inst_count,
 					hw->core_stats[i].mem_count,
 					hw->core_stats[i].freq, ratio);
 
-		if (ratio && ratio <= node->ratio_ceil
+		/*
+		 * A core is latency bound either when it misses often
+		 * per instruction or when a large share of its cycles
+		 * is spent stalled on memory.
+		 */
+		if ((lat_bound || stalled)
 		    && hw->core_stats[i].freq >= node->freq_thresh_mhz
 		    && hw->core_stats[i].freq > max_freq) {
 			lat_dev = i;
@@ -121,6 +221,9 @@ static unsigned long compute_dev_vote(struct devfreq *df)
 					hw->core_stats[lat_dev].freq,
 					max_freq * node->mult_factor);
 
+	if (changed)
+		blocking_notifier_call_chain(&memlat_notifier, 0, NULL);
+
 	return max_freq;
 }
 
@@ -165,11 +268,19 @@ static void stop_monitor(struct devfreq *df)
 {
 	struct memlat_node *node = df->data;
 	struct memlat_hwmon *hw = node->hw;
+	bool changed = false;
+	int i;
 
 	node->mon_started = false;
 
 	devfreq_monitor_stop(df);
 	hw->stop_hwmon(hw);
+
+	for (i = 0; i < hw->num_cores; i++)
+		changed |= set_cpu_state(hw->core_stats[i].id, false,
+					 false, false);
+	if (changed)
+		blocking_notifier_call_chain(&memlat_notifier, 0, NULL);
 }
 
 static int gov_start(struct devfreq *df)
@@ -188,6 +299,7 @@ static int gov_start(struct devfreq *df)
 
 	hw->df = df;
 	node->orig_data = df->data;
+	node->user_polling_ms = df->profile->polling_ms;
 	df->data = node;
 
 	if (start_monitor(df))
@@ -215,11 +327,40 @@ static void gov_stop(struct devfreq *df)
 
 	sysfs_remove_group(&df->dev.kobj, node->attr_grp);
 	stop_monitor(df);
+	/* Don't leave a window aligned interval behind for the next governor */
+	df->profile->polling_ms = node->user_polling_ms;
 	df->data = node->orig_data;
 	node->orig_data = NULL;
 	hw->df = NULL;
 }
 
+#define MIN_MS	10U
+#define MAX_MS	500U
+
+/*
+ * Sample right after the scheduler's load tracking window rolls over, so
+ * that each sample covers one window and a memory bound phase is voted
+ * for within the window it shows up in. The devfreq monitor picks up the
+ * new polling interval when it requeues itself after this sample.
+ */
+static void align_to_window(struct devfreq *df)
+{
+	struct memlat_node *node = df->data;
+	unsigned int window_ns, sample_ms;
+	u64 remaining_ns;
+
+	if (!node->window_align ||
+	    sched_get_window_remaining(&remaining_ns, &window_ns)) {
+		df->profile->polling_ms = node->user_polling_ms;
+		return;
+	}
+
+	sample_ms = DIV_ROUND_UP_ULL(remaining_ns, NSEC_PER_MSEC);
+	if (sample_ms < MIN_MS)
+		sample_ms += DIV_ROUND_UP(window_ns, NSEC_PER_MSEC);
+	df->profile->polling_ms = min(MAX_MS, sample_ms);
+}
+
 static int devfreq_memlat_get_freq(struct devfreq *df,
 					unsigned long *freq,
 					u32 *flag)
@@ -230,17 +371,23 @@ static int devfreq_memlat_get_freq(struct devfreq *df,
 	mhz = compute_dev_vote(df);
 	*freq = mhz ? (mhz * node->mult_factor) : 0;
 
+	align_to_window(df);
+
 	return 0;
 }
 
 gov_attr(ratio_ceil, 1U, 1000U);
 gov_attr(freq_thresh_mhz, 300U, 5000U);
 gov_attr(mult_factor, 1U, 10U);
+gov_attr(stall_floor, 0U, 100U);
+gov_attr(window_align, 0U, 1U);
 
 static struct attribute *dev_attr[] = {
 	&dev_attr_ratio_ceil.attr,
 	&dev_attr_freq_thresh_mhz.attr,
 	&dev_attr_mult_factor.attr,
+	&dev_attr_stall_floor.attr,
+	&dev_attr_window_align.attr,
 	NULL,
 };
 
@@ -249,8 +396,6 @@ static struct attribute_group dev_attr_group = {
 	.attrs = dev_attr,
 };
 
-#define MIN_MS	10U
-#define MAX_MS	500U
 static int devfreq_memlat_ev_handler(struct devfreq *df,
 					unsigned int event, void *data)
 {
@@ -282,6 +427,7 @@ static int devfreq_memlat_ev_handler(struct devfreq *df,
 		sample_ms = *(unsigned int *)data;
 		sample_ms = max(MIN_MS, sample_ms);
 		sample_ms = min(MAX_MS, sample_ms);
+		((struct memlat_node *)df->data)->user_polling_ms = sample_ms;
 		devfreq_interval_update(df, &sample_ms);
 		break;
 	}
@@ -313,6 +459,8 @@ int register_memlat(struct device *dev, struct memlat_hwmon *hw)
 	node->ratio_ceil = 10;
 	node->freq_thresh_mhz = 900;
 	node->mult_factor = 8;
+	node->stall_floor = 0;
+	node->window_align = 1;
 	node->hw = hw;
 
 	mutex_lock(&list_lock);
@@ -16,6 +16,7 @@
 
 #include <linux/kernel.h>
 #include <linux/devfreq.h>
+#include <linux/notifier.h>
 
 /**
  * struct dev_stats - Device stats
@@ -23,12 +24,15 @@
  * @mem_count:			Number of memory accesses made.
  * @freq:			Effective frequency of the device in the
  *				last interval.
+ * @stall_pct:			Percentage of cycles stalled on memory in the
+ *				last interval, 0 if not monitored.
  */
 struct dev_stats {
 	int id;
 	unsigned long inst_count;
 	unsigned long mem_count;
 	unsigned long freq;
+	unsigned long stall_pct;
 };
 
 /**
@@ -68,6 +72,9 @@ struct memlat_hwmon {
 #ifdef CONFIG_DEVFREQ_GOV_MEMLAT
 int register_memlat(struct device *dev, struct memlat_hwmon *hw);
 int update_memlat(struct memlat_hwmon *hw);
+int memlat_get_cpu_state(int cpu, bool *lat_bound, bool *stalled);
+int memlat_register_notifier(struct notifier_block *nb);
+int memlat_unregister_notifier(struct notifier_block *nb);
 #else
 static inline int register_memlat(struct device *dev,
 					struct memlat_hwmon *hw)
@@ -78,6 +85,19 @@ static inline int update_memlat(struct memlat_hwmon *hw)
 {
 	return 0;
 }
+static inline int memlat_get_cpu_state(int cpu, bool *lat_bound,
+				       bool *stalled)
+{
+	return -ENODATA;
+}
+static inline int memlat_register_notifier(struct notifier_block *nb)
+{
+	return 0;
+}
+static inline int memlat_unregister_notifier(struct notifier_block *nb)
+{
+	return 0;
+}
 #endif
 
 #endif /* _GOVERNOR_BW_HWMON_H */
@@ -43,6 +43,15 @@ static DEFINE_SPINLOCK(suspend_lock);
  * frame length, but less than the idle timer.
  */
 #define CEILING			50000
+
+/*
+ * In frame mode, size the frequency so that the predicted work of the next
+ * frame completes within FRAME_TARGET percent of the observed frame period.
+ * If no frame retires for FRAME_TIMEOUT usec the content isn't sending
+ * frame markers and TZ takes over again.
+ */
+#define FRAME_TARGET		90
+#define FRAME_TIMEOUT		(2 * CEILING)
 #define TZ_RESET_ID		0x3
 #define TZ_UPDATE_ID		0x4
 #define TZ_INIT_ID		0x6
@@ -134,8 +143,60 @@ static ssize_t suspend_time_show(struct device *dev,
 	return snprintf(buf, PAGE_SIZE, "%llu\n", time_diff);
 }
 
+static void frame_reset(struct devfreq_msm_adreno_tz_data *priv)
+{
+	atomic_set(&priv->frame.count, 0);
+	priv->frame.total_time = 0;
+	priv->frame.work = 0;
+	priv->frame.predicted = 0;
+	priv->frame.period = 0;
+}
+
+static ssize_t frame_dcvs_show(struct device *dev,
+		struct device_attribute *attr,
+		char *buf)
+{
+	struct devfreq *devfreq = to_devfreq(dev);
+	struct devfreq_msm_adreno_tz_data *priv;
+	bool enable = false;
+
+	mutex_lock(&devfreq->lock);
+	priv = devfreq->data;
+	if (priv)
+		enable = priv->frame.enable;
+	mutex_unlock(&devfreq->lock);
+
+	return snprintf(buf, PAGE_SIZE, "%d\n", enable);
+}
+
+static ssize_t frame_dcvs_store(struct device *dev,
+		struct device_attribute *attr,
+		const char *buf, size_t count)
+{
+	struct devfreq *devfreq = to_devfreq(dev);
+	struct devfreq_msm_adreno_tz_data *priv;
+	unsigned int val;
+	int ret;
+
+	ret = kstrtouint(buf, 0, &val);
+	if (ret)
+		return ret;
+
+	mutex_lock(&devfreq->lock);
+	priv = devfreq->data;
+	if (priv) {
+		frame_reset(priv);
+		priv->frame.enable = val ? true : false;
+	}
+	mutex_unlock(&devfreq->lock);
+
+	return count;
+}
+
 static DEVICE_ATTR(gpu_load, 0444, gpu_load_show, NULL);
 
+static DEVICE_ATTR(frame_dcvs, 0644, frame_dcvs_show, frame_dcvs_store);
+
 static DEVICE_ATTR(suspend_time, 0444,
 		suspend_time_show,
 		NULL);
@@ -143,6 +204,7 @@ static DEVICE_ATTR(suspend_time, 0444,
 static const struct device_attribute *adreno_tz_attr_list[] = {
 		&dev_attr_gpu_load,
 		&dev_attr_suspend_time,
+		&dev_attr_frame_dcvs,
 		NULL
 };
 
@@ -338,6 +400,66 @@ static int tz_init(struct devfreq_msm_adreno_tz_data *priv,
 	return ret;
 }
 
+/*
+ * Pick a power level from the frame markers sent by the GPU driver. Returns
+ * the new level, or -ENODATA if there is no usable frame history and the
+ * TZ algorithm should decide instead.
+ */
+static int frame_get_target_level(struct devfreq *devfreq,
+		struct devfreq_msm_adreno_tz_data *priv,
+		struct devfreq_dev_status *stats, int level)
+{
+	unsigned long *freq_table = devfreq->profile->freq_table;
+	int nr = atomic_xchg(&priv->frame.count, 0);
+	u64 work, budget, needed;
+	int i;
+
+	/* Count work as busy time at the highest frequency */
+	priv->frame.total_time += stats->total_time;
+	priv->frame.work += div_u64((u64) stats->busy_time *
+			stats->current_frequency, freq_table[0]);
+
+	if (nr == 0) {
+		if (priv->frame.total_time > FRAME_TIMEOUT) {
+			frame_reset(priv);
+			return -ENODATA;
+		}
+
+		if (priv->frame.period == 0)
+			return -ENODATA;
+
+		/* The current frame is overdue, step up until it retires */
+		if (priv->frame.total_time > priv->frame.period)
+			return max(level - 1, 0);
+
+		return level;
+	}
+
+	work = div_u64(priv->frame.work, nr);
+	priv->frame.period = div_u64(priv->frame.total_time, nr);
+	priv->frame.total_time = 0;
+	priv->frame.work = 0;
+
+	/* Follow heavier frames right away, decay slowly after them */
+	if (work >= priv->frame.predicted)
+		priv->frame.predicted = work;
+	else
+		priv->frame.predicted = (priv->frame.predicted * 3 + work) >> 2;
+
+	budget = div_u64(priv->frame.period * FRAME_TARGET, 100);
+	if (budget == 0)
+		return 0;
+
+	needed = div64_u64(priv->frame.predicted * freq_table[0], budget);
+
+	/* Lowest frequency that still meets the deadline */
+	for (i = devfreq->profile->max_state - 1; i > 0; i--)
+		if (freq_table[i] >= needed)
+			break;
+
+	return i;
+}
+
 static int tz_get_target_freq(struct devfreq *devfreq, unsigned long *freq,
 				u32 *flag)
 {
@@ -364,6 +486,24 @@ static int tz_get_target_freq(struct devfreq *devfreq, unsigned long *freq,
 
 	/* Update the GPU load statistics */
 	compute_work_load(&stats, priv, devfreq);
+
+	if (priv->frame.enable && stats.total_time) {
+		level = devfreq_get_freq_level(devfreq,
+				stats.current_frequency);
+		if (level >= 0)
+			val = frame_get_target_level(devfreq, priv, &stats,
+					level);
+		else
+			val = level;
+
+		if (val >= 0) {
+			priv->bin.total_time = 0;
+			priv->bin.busy_time = 0;
+			*freq = devfreq->profile->freq_table[val];
+			return 0;
+		}
+	}
+
 	/*
 	 * Do not waste CPU cycles running this algorithm if
 	 * the GPU just started, or if less than FLOOR time
@@ -523,6 +663,7 @@ static int tz_suspend(struct devfreq *devfreq)
 
 	priv->bin.total_time = 0;
 	priv->bin.busy_time = 0;
+	frame_reset(priv);
 	return 0;
 }
 
@@ -2160,6 +2160,32 @@ static int adreno_setproperty(struct kgsl_device_private *dev_priv,
 			kgsl_context_put(context);
 		}
 		break;
+	case KGSL_PROP_CONTEXT_DEADLINE: {
+			struct kgsl_context_deadline deadline;
+			struct kgsl_context *context;
+
+			if (sizebytes != sizeof(deadline))
+				break;
+
+			if (copy_from_user(&deadline, value,
+				sizeof(deadline))) {
+				status = -EFAULT;
+				break;
+			}
+
+			context = kgsl_context_get_owner(dev_priv,
+							deadline.context_id);
+
+			if (context == NULL)
+				break;
+
+			ADRENO_CONTEXT(context)->deadline_us =
+				deadline.deadline_us;
+			status = 0;
+
+			kgsl_context_put(context);
+		}
+		break;
 	default:
 		break;
 	}
@@ -2951,6 +2977,7 @@ static const struct kgsl_functable adreno_functable = {
 	.stop_fault_timer = adreno_dispatcher_stop_fault_timer,
 	.dispatcher_halt = adreno_dispatcher_halt,
 	.dispatcher_unhalt = adreno_dispatcher_unhalt,
+	.snapshot_objects = adreno_snapshot_objects,
 };
 
 static struct platform_driver adreno_platform_driver = {
@@ -231,6 +231,12 @@ enum adreno_preempt_states {
  * @work: A work struct for the preemption worker (for 5XX)
  * @token_submit: Indicates if a preempt token has been submitted in
  * current ringbuffer (for 4XX)
+ * @trigger_time: ktime in ns at which the current preemption was triggered
+ * @avg_cost_us: Running average of the trigger to done preemption latency
+ * @skip: Don't preempt the current ringbuffer if its inflight commands are
+ * expected to retire sooner than a preemption takes (for 5XX)
+ * @skip_time: ktime in ns of the first skipped trigger while a higher
+ * priority ringbuffer is waiting, 0 if none
  */
 struct adreno_preemption {
 	atomic_t state;
@@ -238,6 +244,10 @@ struct adreno_preemption {
 	struct timer_list timer;
 	struct work_struct work;
 	bool token_submit;
+	u64 trigger_time;
+	unsigned int avg_cost_us;
+	bool skip;
+	u64 skip_time;
 };
 
 
@@ -892,6 +902,9 @@ void adreno_snapshot(struct kgsl_device *device,
 		struct kgsl_snapshot *snapshot,
 		struct kgsl_context *context);
 
+void adreno_snapshot_objects(struct kgsl_device *device,
+		struct kgsl_snapshot *snapshot);
+
 int adreno_reset(struct kgsl_device *device, int fault);
 
 void adreno_fault_skipcmd_detached(struct adreno_device *adreno_dev,
@@ -924,6 +937,9 @@ long adreno_ioctl_perfcounter_get(struct kgsl_device_private *dev_priv,
 long adreno_ioctl_perfcounter_put(struct kgsl_device_private *dev_priv,
 	unsigned int cmd, void *data);
 
+long adreno_ioctl_perfcounter_sampling(struct kgsl_device_private *dev_priv,
+	unsigned int cmd, void *data);
+
 int adreno_efuse_map(struct adreno_device *adreno_dev);
 int adreno_efuse_read_u32(struct adreno_device *adreno_dev, unsigned int offset,
 		unsigned int *val);
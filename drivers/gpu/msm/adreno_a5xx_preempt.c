@@ -55,6 +55,61 @@ static inline bool adreno_move_preempt_state(struct adreno_device *adreno_dev,
 	return (atomic_cmpxchg(&adreno_dev->preempt.state, old, new) == old);
 }
 
+/* Account the preemption into next_rb that just completed */
+static void _a5xx_preemption_account(struct adreno_device *adreno_dev)
+{
+	struct adreno_preemption *preempt = &adreno_dev->preempt;
+	struct adreno_ringbuffer *next = adreno_dev->next_rb;
+	unsigned int us, i;
+
+	us = (unsigned int) div_u64(ktime_to_ns(ktime_get()) -
+		preempt->trigger_time, NSEC_PER_USEC);
+
+	for (i = 0; i < ADRENO_PREEMPT_HIST_BUCKETS - 1; i++)
+		if (us < (ADRENO_PREEMPT_HIST_BASE_US << i))
+			break;
+
+	next->preempt_hist[i]++;
+	next->preempt_count++;
+
+	preempt->avg_cost_us = preempt->avg_cost_us ?
+		(preempt->avg_cost_us * 7 + us) / 8 : us;
+}
+
+/*
+ * If the inflight commands on the current ringbuffer are expected to retire
+ * sooner than a preemption takes then switching gains nothing for @next and
+ * costs a context save and restore - let the current ringbuffer run out
+ * instead. The estimate errs on the late side since it is based on the
+ * submit to retire time, and the wait is bounded to twice the preemption
+ * cost in case the estimate is off.
+ */
+static bool _a5xx_preemption_skip(struct adreno_device *adreno_dev,
+		struct adreno_ringbuffer *next)
+{
+	struct adreno_preemption *preempt = &adreno_dev->preempt;
+	struct adreno_ringbuffer *cur = adreno_dev->cur_rb;
+	u64 now;
+
+	if (!preempt->skip || !preempt->avg_cost_us || !cur->cmd_avg_us)
+		return false;
+
+	if ((u64) cur->dispatch_q.inflight * cur->cmd_avg_us >=
+		preempt->avg_cost_us)
+		return false;
+
+	now = ktime_to_ns(ktime_get());
+
+	if (preempt->skip_time == 0)
+		preempt->skip_time = now;
+	else if (now - preempt->skip_time >
+		(u64) preempt->avg_cost_us * 2 * NSEC_PER_USEC)
+		return false;
+
+	next->preempt_skipped++;
+	return true;
+}
+
 static void _a5xx_preemption_done(struct adreno_device *adreno_dev)
 {
 	struct kgsl_device *device = KGSL_DEVICE(adreno_dev);
@@ -88,6 +143,8 @@ static void _a5xx_preemption_done(struct adreno_device *adreno_dev)
 
 	del_timer_sync(&adreno_dev->preempt.timer);
 
+	_a5xx_preemption_account(adreno_dev);
+
 	trace_adreno_preempt_done(adreno_dev->cur_rb, adreno_dev->next_rb);
 
 	/* Clean up all the bits */
@@ -225,10 +282,27 @@ void a5xx_preemption_trigger(struct adreno_device *adreno_dev)
 				adreno_dev->cur_rb->dispatch_q.expires);
 		}
 
+		adreno_dev->preempt.skip_time = 0;
 		adreno_set_preempt_state(adreno_dev, ADRENO_PREEMPT_NONE);
 		return;
 	}
 
+	/*
+	 * The current ringbuffer is about to run out - the retire will bring
+	 * us back here to switch to the next one
+	 */
+	if (_a5xx_preemption_skip(adreno_dev, next)) {
+		_update_wptr(adreno_dev, false);
+
+		mod_timer(&adreno_dev->dispatcher.timer,
+			adreno_dev->cur_rb->dispatch_q.expires);
+
+		adreno_set_preempt_state(adreno_dev, ADRENO_PREEMPT_NONE);
+		return;
+	}
+
+	adreno_dev->preempt.skip_time = 0;
+
 	/* Turn off the dispatcher timer */
 	del_timer(&adreno_dev->dispatcher.timer);
 
@@ -271,6 +345,8 @@ void a5xx_preemption_trigger(struct adreno_device *adreno_dev)
 
 	adreno_set_preempt_state(adreno_dev, ADRENO_PREEMPT_TRIGGERED);
 
+	adreno_dev->preempt.trigger_time = ktime_to_ns(ktime_get());
+
 	/* Trigger the preemption */
 	adreno_writereg(adreno_dev, ADRENO_REG_CP_PREEMPT, 1);
 }
@@ -302,6 +378,8 @@ void a5xx_preempt_callback(struct adreno_device *adreno_dev, int bit)
 
 	del_timer(&adreno_dev->preempt.timer);
 
+	_a5xx_preemption_account(adreno_dev);
+
 	trace_adreno_preempt_done(adreno_dev->cur_rb,
 		adreno_dev->next_rb);
 
@@ -346,6 +346,44 @@ static const struct file_operations ctx_fops = {
 };
 
 
+static int preempt_stats_print(struct seq_file *s, void *unused)
+{
+	struct adreno_device *adreno_dev = s->private;
+	struct adreno_ringbuffer *rb;
+	unsigned int i, j;
+
+	seq_printf(s, "avg cost: %u us skip: %d\n",
+		adreno_dev->preempt.avg_cost_us, adreno_dev->preempt.skip);
+
+	FOR_EACH_RINGBUFFER(adreno_dev, rb, i) {
+		seq_printf(s, "rb%d: count: %u skipped: %u cmd avg: %u us\n",
+			rb->id, rb->preempt_count, rb->preempt_skipped,
+			rb->cmd_avg_us);
+
+		for (j = 0; j < ADRENO_PREEMPT_HIST_BUCKETS - 1; j++)
+			seq_printf(s, "\t<%u us: %u\n",
+				ADRENO_PREEMPT_HIST_BASE_US << j,
+				rb->preempt_hist[j]);
+
+		seq_printf(s, "\t>=%u us: %u\n",
+			ADRENO_PREEMPT_HIST_BASE_US << j, rb->preempt_hist[j]);
+	}
+
+	return 0;
+}
+
+static int preempt_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, preempt_stats_print, inode->i_private);
+}
+
+static const struct file_operations preempt_stats_fops = {
+	.open = preempt_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 void
 adreno_context_debugfs_init(struct adreno_device *adreno_dev,
 			    struct adreno_context *ctx)
@@ -383,4 +421,9 @@ void adreno_debugfs_init(struct adreno_device *adreno_dev)
 	if (adreno_is_a5xx(adreno_dev))
 		debugfs_create_file("isdb", 0644, device->d_debugfs,
 			device, &_isdb_fops);
+
+	if (adreno_is_a5xx(adreno_dev) &&
+		ADRENO_FEATURE(adreno_dev, ADRENO_PREEMPTION))
+		debugfs_create_file("preempt_stats", 0444, device->d_debugfs,
+			adreno_dev, &preempt_stats_fops);
 }
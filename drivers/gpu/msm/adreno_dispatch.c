@@ -660,6 +660,7 @@ static int sendcmd(struct adreno_device *adreno_dev,
 	mutex_unlock(&device->mutex);
 
 	cmdbatch->submit_ticks = time.ticks;
+	cmdbatch->submit_time = time.ktime;
 
 	dispatch_q->cmd_q[dispatch_q->tail] = cmdbatch;
 	dispatch_q->tail = (dispatch_q->tail + 1) %
@@ -804,6 +805,60 @@ static int dispatcher_context_sendcmds(struct adreno_device *adreno_dev,
 	return ret;
 }
 
+/*
+ * Return the deadline of the next command batch in the context queue, 0 if
+ * there is none or it has no deadline
+ */
+static u64 _drawctxt_next_deadline(struct adreno_context *drawctxt)
+{
+	struct kgsl_cmdbatch *cmdbatch;
+	u64 deadline = 0;
+
+	spin_lock(&drawctxt->lock);
+	if (drawctxt->cmdqueue_head != drawctxt->cmdqueue_tail) {
+		cmdbatch = drawctxt->cmdqueue[drawctxt->cmdqueue_head];
+		if (cmdbatch)
+			deadline = cmdbatch->deadline;
+	}
+	spin_unlock(&drawctxt->lock);
+
+	return deadline;
+}
+
+/**
+ * _next_pending_context() - Pick the next context to dispatch from
+ * @dispatcher: Pointer to the adreno dispatcher struct
+ *
+ * Among the pending contexts of the highest pending priority, pick the one
+ * whose next command batch has the earliest deadline, so that deadline
+ * contexts such as the compositor are served ahead of background work of
+ * the same priority. Contexts without a deadline keep their list order.
+ * Must be called with the plist_lock held and a non-empty pending list.
+ */
+static struct adreno_context *_next_pending_context(
+		struct adreno_dispatcher *dispatcher)
+{
+	struct adreno_context *drawctxt, *first, *best;
+	u64 deadline, best_deadline = U64_MAX;
+
+	first = plist_first_entry(&dispatcher->pending,
+		struct adreno_context, pending);
+	best = first;
+
+	plist_for_each_entry(drawctxt, &dispatcher->pending, pending) {
+		if (drawctxt->pending.prio != first->pending.prio)
+			break;
+
+		deadline = _drawctxt_next_deadline(drawctxt);
+		if (deadline && deadline < best_deadline) {
+			best = drawctxt;
+			best_deadline = deadline;
+		}
+	}
+
+	return best;
+}
+
 /**
  * _adreno_dispatcher_issuecmds() - Issue commmands from pending contexts
  * @adreno_dev: Pointer to the adreno device struct
@@ -842,9 +897,8 @@ static void _adreno_dispatcher_issuecmds(struct adreno_device *adreno_dev)
 			break;
 		}
 
-		/* Get the next entry on the list */
-		drawctxt = plist_first_entry(&dispatcher->pending,
-			struct adreno_context, pending);
+		/* Get the next entry to dispatch from */
+		drawctxt = _next_pending_context(dispatcher);
 
 		plist_del(&drawctxt->pending, &dispatcher->pending);
 
@@ -956,6 +1010,63 @@ done:
 	adreno_dispatcher_schedule(device);
 }
 
+/**
+ * _dispatcher_fast_submit() - Send commands straight from the submitter
+ * @adreno_dev: Pointer to the adreno device struct
+ * @drawctxt: Pointer to the adreno context that just queued a command
+ *
+ * If nothing is inflight and no other context is pending then there is
+ * nobody to be fair to, so send the commands of @drawctxt directly from the
+ * caller instead of going through the pending list and the issue loop.
+ * Returns true if the context queue was drained, false if the caller should
+ * queue the context with the dispatcher as usual.
+ */
+static bool _dispatcher_fast_submit(struct adreno_device *adreno_dev,
+		struct adreno_context *drawctxt)
+{
+	struct adreno_dispatcher *dispatcher = &adreno_dev->dispatcher;
+	struct kgsl_device *device = KGSL_DEVICE(adreno_dev);
+	bool drained = false;
+	bool empty;
+
+	/* Unlocked peek - these are checked again with the mutex held */
+	if (dispatcher->inflight != 0 || adreno_gpu_fault(adreno_dev) != 0 ||
+		adreno_gpu_halt(adreno_dev) != 0)
+		return false;
+
+	spin_lock(&device->submit_lock);
+	if (device->slumber == true) {
+		spin_unlock(&device->submit_lock);
+		return false;
+	}
+	device->submit_now++;
+	spin_unlock(&device->submit_lock);
+
+	if (!mutex_trylock(&dispatcher->mutex)) {
+		_decrement_submit_now(device);
+		return false;
+	}
+
+	spin_lock(&dispatcher->plist_lock);
+	empty = plist_head_empty(&dispatcher->pending);
+	spin_unlock(&dispatcher->plist_lock);
+
+	if (empty && dispatcher->inflight == 0 &&
+		adreno_gpu_fault(adreno_dev) == 0 &&
+		!kgsl_context_detached(&drawctxt->base)) {
+		dispatcher_context_sendcmds(adreno_dev, drawctxt);
+
+		spin_lock(&drawctxt->lock);
+		drained = (drawctxt->cmdqueue_head == drawctxt->cmdqueue_tail);
+		spin_unlock(&drawctxt->lock);
+	}
+
+	mutex_unlock(&dispatcher->mutex);
+	_decrement_submit_now(device);
+
+	return drained;
+}
+
 /**
  * get_timestamp() - Return the next timestamp for the context
  * @drawctxt - Pointer to an adreno draw context struct
@@ -1105,6 +1216,10 @@ int adreno_dispatcher_queue_cmd(struct adreno_device *adreno_dev,
 
 	cmdbatch->timestamp = *timestamp;
 
+	if (drawctxt->deadline_us)
+		cmdbatch->deadline = ktime_to_ns(ktime_get()) +
+			(u64) drawctxt->deadline_us * NSEC_PER_USEC;
+
 	if (cmdbatch->flags & KGSL_CMDBATCH_MARKER) {
 
 		/*
@@ -1186,6 +1301,13 @@ int adreno_dispatcher_queue_cmd(struct adreno_device *adreno_dev,
 		kgsl_pwrctrl_update_l2pc(&adreno_dev->dev,
 				KGSL_L2PC_QUEUE_TIMEOUT);
 
+	/*
+	 * If the GPU is idle and nobody else is waiting, skip the pending
+	 * list and send the command right away
+	 */
+	if (_dispatcher_fast_submit(adreno_dev, drawctxt))
+		return 0;
+
 	/* Add the context to the dispatcher pending list */
 	dispatcher_queue_context(adreno_dev, drawctxt);
 
@@ -2011,6 +2133,23 @@ static void retire_cmdbatch(struct adreno_device *adreno_dev,
 	drawctxt->ticks_index = (drawctxt->ticks_index + 1) %
 		SUBMIT_RETIRE_TICKS_SIZE;
 
+	/* Keep a running average for the preemption skip estimate */
+	if (cmdbatch->submit_time) {
+		struct adreno_ringbuffer *rb = ADRENO_CMDBATCH_RB(cmdbatch);
+		unsigned int us = (unsigned int) div_u64(
+			ktime_to_ns(ktime_get()) - cmdbatch->submit_time,
+			NSEC_PER_USEC);
+
+		rb->cmd_avg_us = rb->cmd_avg_us ?
+			(rb->cmd_avg_us * 7 + us) / 8 : us;
+	}
+
+	if (cmdbatch->flags & KGSL_CMDBATCH_END_OF_FRAME)
+		kgsl_pwrscale_frame_done(KGSL_DEVICE(adreno_dev));
+
+	if (drawctxt->perfsampler)
+		adreno_perfcounter_sample(adreno_dev, drawctxt, cmdbatch);
+
 	kgsl_cmdbatch_destroy(cmdbatch);
 }
 
@@ -486,6 +486,8 @@ void adreno_drawctxt_detach(struct kgsl_context *context)
 		kgsl_cmdbatch_destroy(list[i]);
 	}
 
+	adreno_perfcounter_sampling_stop(adreno_dev, drawctxt);
+
 	/*
 	 * internal_timestamp is set in adreno_ringbuffer_addcmds,
 	 * which holds the device mutex.
@@ -25,6 +25,7 @@ struct kgsl_device;
 struct adreno_device;
 struct kgsl_device_private;
 struct kgsl_context;
+struct adreno_perfcounter_sampler;
 
 /**
  * struct adreno_context - Adreno GPU draw context
@@ -52,6 +53,10 @@ struct kgsl_context;
  *		 be written.
  * @active_node: Linkage for nodes in active_list
  * @active_time: Time when this context last seen
+ * @deadline_us: Deadline of the command batches of this context relative to
+ *		 their submission, 0 if none
+ * @perfsampler: Perfcounters sampled when commands of this context retire,
+ *		 protected by @lock
  */
 struct adreno_context {
 	struct kgsl_context base;
@@ -81,6 +86,8 @@ struct adreno_context {
 
 	struct list_head active_node;
 	unsigned long active_time;
+	unsigned int deadline_us;
+	struct adreno_perfcounter_sampler *perfsampler;
 };
 
 /* Flag definitions for flag field in adreno_context */
@@ -113,6 +113,30 @@ static long adreno_ioctl_preemption_counters_query(
 	return 0;
 }
 
+long adreno_ioctl_perfcounter_sampling(struct kgsl_device_private *dev_priv,
+		unsigned int cmd, void *data)
+{
+	struct adreno_device *adreno_dev = ADRENO_DEVICE(dev_priv->device);
+	struct kgsl_perfcounter_sampling *param = data;
+	struct kgsl_context *context;
+	int result = 0;
+
+	context = kgsl_context_get_owner(dev_priv, param->context_id);
+	if (context == NULL)
+		return -EINVAL;
+
+	if (param->count == 0)
+		adreno_perfcounter_sampling_stop(adreno_dev,
+			ADRENO_CONTEXT(context));
+	else
+		result = adreno_perfcounter_sampling_start(adreno_dev,
+			ADRENO_CONTEXT(context), param);
+
+	kgsl_context_put(context);
+
+	return (long) result;
+}
+
 long adreno_ioctl_helper(struct kgsl_device_private *dev_priv,
 		unsigned int cmd, unsigned long arg,
 		const struct kgsl_ioctl *cmds, int len)
@@ -158,6 +182,7 @@ static struct kgsl_ioctl adreno_ioctl_funcs[] = {
 	{ IOCTL_KGSL_PERFCOUNTER_READ, adreno_ioctl_perfcounter_read },
 	{ IOCTL_KGSL_PREEMPTIONCOUNTER_QUERY,
 		adreno_ioctl_preemption_counters_query },
+	{ IOCTL_KGSL_PERFCOUNTER_SAMPLING, adreno_ioctl_perfcounter_sampling },
 };
 
 long adreno_ioctl(struct kgsl_device_private *dev_priv,
@@ -310,6 +310,231 @@ done:
 	return ret;
 }
 
+static void _sampler_free(struct adreno_device *adreno_dev,
+		struct adreno_perfcounter_sampler *sampler, unsigned int count)
+{
+	struct kgsl_device *device = KGSL_DEVICE(adreno_dev);
+	unsigned int i;
+
+	mutex_lock(&device->mutex);
+	for (i = 0; i < count; i++)
+		adreno_perfcounter_put(adreno_dev,
+			sampler->counters[i].groupid,
+			sampler->counters[i].countable, PERFCOUNTER_FLAG_NONE);
+	mutex_unlock(&device->mutex);
+
+	if (sampler->header)
+		kgsl_memdesc_unmap(&sampler->entry->memdesc);
+
+	kgsl_mem_entry_put(sampler->entry);
+	kfree(sampler);
+}
+
+/* Reserve the sampled counters and look up the register assigned to each */
+static int _sampler_get_counters(struct adreno_device *adreno_dev,
+		struct adreno_perfcounter_sampler *sampler)
+{
+	struct kgsl_device *device = KGSL_DEVICE(adreno_dev);
+	struct adreno_perfcounters *counters = ADRENO_PERFCOUNTERS(adreno_dev);
+	struct adreno_perfcount_group *group;
+	unsigned int i, j;
+	int ret;
+
+	mutex_lock(&device->mutex);
+	ret = kgsl_active_count_get(device);
+	if (ret) {
+		mutex_unlock(&device->mutex);
+		return ret;
+	}
+
+	for (i = 0; i < sampler->count; i++) {
+		struct kgsl_perfcounter_read_group *c = &sampler->counters[i];
+
+		ret = adreno_perfcounter_get(adreno_dev, c->groupid,
+			c->countable, NULL, NULL, PERFCOUNTER_FLAG_NONE);
+		if (ret)
+			break;
+
+		group = &counters->groups[c->groupid];
+		for (j = 0; j < group->reg_count; j++)
+			if (group->regs[j].countable == c->countable)
+				break;
+
+		sampler->reg[i] = j;
+	}
+
+	if (ret) {
+		while (i--)
+			adreno_perfcounter_put(adreno_dev,
+				sampler->counters[i].groupid,
+				sampler->counters[i].countable,
+				PERFCOUNTER_FLAG_NONE);
+	}
+
+	kgsl_active_count_put(device);
+	mutex_unlock(&device->mutex);
+
+	return ret;
+}
+
+/**
+ * adreno_perfcounter_sampling_start() - Sample counters on command retire
+ * @adreno_dev: Adreno device
+ * @drawctxt: Context whose command batches trigger the samples
+ * @param: Counters, ring and flags from IOCTL_KGSL_PERFCOUNTER_SAMPLING
+ *
+ * Reserve the counters and start writing them to the ring each time a
+ * command batch from @drawctxt retires, replacing any previous sampler on
+ * the context
+ */
+int adreno_perfcounter_sampling_start(struct adreno_device *adreno_dev,
+	struct adreno_context *drawctxt,
+	struct kgsl_perfcounter_sampling *param)
+{
+	struct adreno_perfcounter_sampler *sampler, *old;
+	struct kgsl_perfcounter_sample_header *header;
+	uint64_t size;
+	int ret;
+
+	if (ADRENO_PERFCOUNTERS(adreno_dev) == NULL)
+		return -EINVAL;
+
+	if (param->count == 0 || param->count > KGSL_PERFCOUNTER_SAMPLE_MAX ||
+		(param->flags & ~KGSL_PERFCOUNTER_SAMPLE_EOF))
+		return -EINVAL;
+
+	sampler = kzalloc(sizeof(*sampler), GFP_KERNEL);
+	if (sampler == NULL)
+		return -ENOMEM;
+
+	if (copy_from_user(sampler->counters, to_user_ptr(param->counters),
+		sizeof(sampler->counters[0]) * param->count)) {
+		kfree(sampler);
+		return -EFAULT;
+	}
+
+	sampler->entry = kgsl_sharedmem_find_id(drawctxt->base.proc_priv,
+		param->id);
+	if (sampler->entry == NULL) {
+		kfree(sampler);
+		return -EINVAL;
+	}
+
+	sampler->count = param->count;
+	sampler->flags = param->flags;
+	sampler->sample_size = sizeof(struct kgsl_perfcounter_sample) +
+		param->count * sizeof(uint64_t);
+
+	size = sampler->entry->memdesc.size;
+	if (size < sizeof(*header) + sampler->sample_size) {
+		ret = -EINVAL;
+		goto err;
+	}
+
+	sampler->nr_samples = (unsigned int) min_t(uint64_t, UINT_MAX,
+		div_u64(size - sizeof(*header), sampler->sample_size));
+
+	header = kgsl_memdesc_map(&sampler->entry->memdesc);
+	if (header == NULL) {
+		ret = -EINVAL;
+		goto err;
+	}
+	sampler->header = header;
+
+	ret = _sampler_get_counters(adreno_dev, sampler);
+	if (ret)
+		goto err;
+
+	header->head = 0;
+	header->count = sampler->count;
+	header->size = sampler->nr_samples;
+	header->sample_size = sampler->sample_size;
+	/* Make sure the header is out before the first sample */
+	wmb();
+
+	spin_lock(&drawctxt->lock);
+	old = drawctxt->perfsampler;
+	drawctxt->perfsampler = sampler;
+	spin_unlock(&drawctxt->lock);
+
+	if (old)
+		_sampler_free(adreno_dev, old, old->count);
+
+	return 0;
+
+err:
+	_sampler_free(adreno_dev, sampler, 0);
+	return ret;
+}
+
+/**
+ * adreno_perfcounter_sampling_stop() - Stop sampling counters for a context
+ * @adreno_dev: Adreno device
+ * @drawctxt: Context to stop sampling for
+ *
+ * Release the counters and the ring of the sampler on @drawctxt, if any.
+ * This function must be called without the device mutex held.
+ */
+void adreno_perfcounter_sampling_stop(struct adreno_device *adreno_dev,
+	struct adreno_context *drawctxt)
+{
+	struct adreno_perfcounter_sampler *sampler;
+
+	spin_lock(&drawctxt->lock);
+	sampler = drawctxt->perfsampler;
+	drawctxt->perfsampler = NULL;
+	spin_unlock(&drawctxt->lock);
+
+	if (sampler)
+		_sampler_free(adreno_dev, sampler, sampler->count);
+}
+
+/**
+ * adreno_perfcounter_sample() - Write a sample for a retired command batch
+ * @adreno_dev: Adreno device
+ * @drawctxt: Context of @cmdbatch
+ * @cmdbatch: Command batch that just retired
+ *
+ * Called by the dispatcher while the GPU is still active from the retired
+ * work. The sample is written before the head is moved so that readers of
+ * the ring never see a partial sample.
+ */
+void adreno_perfcounter_sample(struct adreno_device *adreno_dev,
+	struct adreno_context *drawctxt, struct kgsl_cmdbatch *cmdbatch)
+{
+	struct adreno_perfcounter_sampler *sampler;
+	struct kgsl_perfcounter_sample *sample;
+	unsigned int head, i;
+
+	spin_lock(&drawctxt->lock);
+	sampler = drawctxt->perfsampler;
+
+	if (sampler == NULL ||
+		((sampler->flags & KGSL_PERFCOUNTER_SAMPLE_EOF) &&
+		!(cmdbatch->flags & KGSL_CMDBATCH_END_OF_FRAME)) ||
+		!kgsl_state_is_awake(KGSL_DEVICE(adreno_dev)))
+		goto done;
+
+	/* The head is shared with user space, only trust it modulo the size */
+	head = ACCESS_ONCE(sampler->header->head);
+	sample = (void *) (sampler->header + 1) +
+		(head % sampler->nr_samples) * sampler->sample_size;
+
+	sample->time = ktime_get_ns();
+	sample->context_id = drawctxt->base.id;
+	sample->timestamp = cmdbatch->timestamp;
+
+	for (i = 0; i < sampler->count; i++)
+		sample->values[i] = adreno_perfcounter_read(adreno_dev,
+			sampler->counters[i].groupid, sampler->reg[i]);
+
+	wmb();
+	sampler->header->head = head + 1;
+
+done:
+	spin_unlock(&drawctxt->lock);
+}
+
 /**
  * adreno_perfcounter_get_groupid() - Get the performance counter ID
  * @adreno_dev: Adreno device
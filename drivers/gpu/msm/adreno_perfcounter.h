@@ -16,6 +16,9 @@
 #include "adreno.h"
 
 struct adreno_device;
+struct adreno_context;
+struct kgsl_cmdbatch;
+struct kgsl_mem_entry;
 
 /* ADRENO_PERFCOUNTERS - Given an adreno device, return the perfcounters list */
 #define ADRENO_PERFCOUNTERS(_a) \
@@ -138,4 +141,36 @@ int adreno_perfcounter_get(struct adreno_device *adreno_dev,
 int adreno_perfcounter_put(struct adreno_device *adreno_dev,
 	unsigned int groupid, unsigned int countable, unsigned int flags);
 
+/**
+ * struct adreno_perfcounter_sampler - Counters sampled on command retire
+ * @entry: Memory object holding the sample ring
+ * @header: Kernel mapping of the start of the ring
+ * @nr_samples: Number of samples that fit in the ring
+ * @sample_size: Size of each sample in bytes
+ * @count: Number of sampled counters
+ * @flags: KGSL_PERFCOUNTER_SAMPLE_* flags
+ * @counters: Group and countable of each sampled counter
+ * @reg: Register index within the group of each sampled counter
+ */
+struct adreno_perfcounter_sampler {
+	struct kgsl_mem_entry *entry;
+	struct kgsl_perfcounter_sample_header *header;
+	unsigned int nr_samples;
+	unsigned int sample_size;
+	unsigned int count;
+	unsigned int flags;
+	struct kgsl_perfcounter_read_group counters[KGSL_PERFCOUNTER_SAMPLE_MAX];
+	unsigned int reg[KGSL_PERFCOUNTER_SAMPLE_MAX];
+};
+
+int adreno_perfcounter_sampling_start(struct adreno_device *adreno_dev,
+	struct adreno_context *drawctxt,
+	struct kgsl_perfcounter_sampling *param);
+
+void adreno_perfcounter_sampling_stop(struct adreno_device *adreno_dev,
+	struct adreno_context *drawctxt);
+
+void adreno_perfcounter_sample(struct adreno_device *adreno_dev,
+	struct adreno_context *drawctxt, struct kgsl_cmdbatch *cmdbatch);
+
 #endif /* __ADRENO_PERFCOUNTER_H */
@@ -76,6 +76,13 @@ struct adreno_ringbuffer_pagetable_info {
 #define PT_INFO_OFFSET(_field) \
 	offsetof(struct adreno_ringbuffer_pagetable_info, _field)
 
+/*
+ * Preemption latency histogram: bucket i counts the latencies below
+ * ADRENO_PREEMPT_HIST_BASE_US << i, the last bucket everything above
+ */
+#define ADRENO_PREEMPT_HIST_BUCKETS 7
+#define ADRENO_PREEMPT_HIST_BASE_US 50
+
 /**
  * struct adreno_ringbuffer - Definition for an adreno ringbuffer object
  * @flags: Internal control flags for the ringbuffer
@@ -105,6 +112,12 @@ struct adreno_ringbuffer_pagetable_info {
  * or how long it has been scheduled for after preempting in
  * @starve_timer_state: Indicates the state of the wait.
  * @preempt_lock: Lock to protect the wptr pointer while it is being updated
+ * @preempt_hist: Histogram of the latencies of the preemptions into this RB
+ * @preempt_count: Number of preemptions into this RB
+ * @preempt_skipped: Number of preemptions into this RB that were skipped
+ * because the current RB was about to run out
+ * @cmd_avg_us: Running average of the submit to retire time of the command
+ * batches on this RB
  */
 struct adreno_ringbuffer {
 	uint32_t flags;
@@ -139,6 +152,10 @@ struct adreno_ringbuffer {
 	 * enough.
 	 */
 	u32 profile_index;
+	unsigned int preempt_hist[ADRENO_PREEMPT_HIST_BUCKETS];
+	unsigned int preempt_count;
+	unsigned int preempt_skipped;
+	unsigned int cmd_avg_us;
 };
 
 /* Returns the current ringbuffer */
@@ -896,6 +896,22 @@ void adreno_snapshot(struct kgsl_device *device, struct kgsl_snapshot *snapshot,
 	 */
 	kgsl_snapshot_add_section(device, KGSL_SNAPSHOT_SECTION_MEMLIST_V2,
 			snapshot, snapshot_capture_mem_list, snapshot->process);
+}
+
+/**
+ * adreno_snapshot_objects() - Dump the buffers found while taking a snapshot
+ * @device: Device being snapshotted
+ * @snapshot: Snapshot instance
+ *
+ * Copying and parsing the IBs found in the ringbuffers only needs the
+ * references taken on them in adreno_snapshot(), not the hardware. Do it from
+ * the snapshot worker so that fault recovery doesn't wait for it.
+ */
+void adreno_snapshot_objects(struct kgsl_device *device,
+		struct kgsl_snapshot *snapshot)
+{
+	unsigned int i;
+
 	/*
 	 * Make sure that the last IB1 that was being executed is dumped.
 	 * Since this was the last IB1 that was processed, we should have
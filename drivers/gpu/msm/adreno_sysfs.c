@@ -190,6 +190,18 @@ static unsigned int _preemption_show(struct adreno_device *adreno_dev)
 	return adreno_is_preemption_enabled(adreno_dev);
 }
 
+static int _preempt_skip_store(struct adreno_device *adreno_dev,
+		unsigned int val)
+{
+	adreno_dev->preempt.skip = val;
+	return 0;
+}
+
+static unsigned int _preempt_skip_show(struct adreno_device *adreno_dev)
+{
+	return adreno_dev->preempt.skip;
+}
+
 static int _hwcg_store(struct adreno_device *adreno_dev,
 		unsigned int val)
 {
@@ -314,6 +326,7 @@ static DEVICE_INT_ATTR(wake_timeout, 0644, adreno_wake_timeout);
 static ADRENO_SYSFS_BOOL(sptp_pc);
 static ADRENO_SYSFS_BOOL(lm);
 static ADRENO_SYSFS_BOOL(preemption);
+static ADRENO_SYSFS_BOOL(preempt_skip);
 static ADRENO_SYSFS_BOOL(hwcg);
 
 
@@ -328,6 +341,7 @@ static const struct device_attribute *_attr_list[] = {
 	&adreno_attr_sptp_pc.attr,
 	&adreno_attr_lm.attr,
 	&adreno_attr_preemption.attr,
+	&adreno_attr_preempt_skip.attr,
 	&adreno_attr_hwcg.attr,
 	NULL,
 };
@@ -72,10 +72,20 @@ MODULE_PARM_DESC(kgsl_mmu_type, "Type of MMU to be used for graphics");
 DEFINE_MUTEX(kgsl_mmu_sync);
 EXPORT_SYMBOL(kgsl_mmu_sync);
 
+/*
+ * Freed dma-buf imports are kept mapped on a small per process list so that
+ * importing the same buffer again (gralloc does this every frame) can reuse
+ * the attachment and the GPU mapping
+ */
+#define KGSL_DMABUF_CACHE_SIZE 8
+
 struct kgsl_dma_buf_meta {
 	struct dma_buf_attachment *attach;
 	struct dma_buf *dmabuf;
 	struct sg_table *table;
+	struct list_head node;
+	uint64_t flags;
+	bool reuse;
 };
 
 static void kgsl_mem_entry_detach_process(struct kgsl_mem_entry *entry);
@@ -284,6 +294,147 @@ static void kgsl_destroy_ion(struct kgsl_memdesc *memdesc)
 static struct kgsl_memdesc_ops kgsl_dmabuf_ops = {
 	.free = kgsl_destroy_ion,
 };
+
+static void kgsl_dmabuf_cache_release(struct kgsl_mem_entry *entry)
+{
+	kgsl_mmu_put_gpuaddr(&entry->memdesc);
+	kgsl_sharedmem_free(&entry->memdesc);
+	kfree(entry);
+}
+
+/*
+ * Park a dma-buf entry that lost its last reference on the process cache
+ * instead of destroying it. The entry goes out of the idr like a normal free
+ * but keeps its attachment, GPU address and mapping.
+ */
+static bool kgsl_dmabuf_cache_park(struct kgsl_mem_entry *entry)
+{
+	struct kgsl_process_private *private = entry->priv;
+	struct kgsl_dma_buf_meta *meta = entry->priv_data;
+	struct kgsl_dma_buf_meta *evict = NULL;
+	unsigned int type;
+
+	if (private == NULL || meta == NULL || !meta->reuse ||
+		entry->memdesc.ops != &kgsl_dmabuf_ops ||
+		!(entry->memdesc.priv & KGSL_MEMDESC_MAPPED))
+		return false;
+
+	type = kgsl_memdesc_usermem_type(&entry->memdesc);
+
+	spin_lock(&private->mem_lock);
+	if (test_bit(KGSL_PROCESS_CLOSING, &private->priv)) {
+		spin_unlock(&private->mem_lock);
+		return false;
+	}
+
+	if (entry->id != 0)
+		idr_remove(&private->mem_idr, entry->id);
+	entry->id = 0;
+	private->stats[type].cur -= entry->memdesc.size;
+
+	list_add(&meta->node, &private->dmabuf_cache);
+	if (++private->dmabuf_cache_count > KGSL_DMABUF_CACHE_SIZE) {
+		evict = list_last_entry(&private->dmabuf_cache,
+			struct kgsl_dma_buf_meta, node);
+		list_del(&evict->node);
+		private->dmabuf_cache_count--;
+	}
+	spin_unlock(&private->mem_lock);
+
+	atomic_long_sub(entry->memdesc.size, &kgsl_driver.stats.mapped);
+
+	if (evict)
+		kgsl_dmabuf_cache_release(evict->attach->priv);
+
+	entry->priv = NULL;
+	kgsl_process_private_put(private);
+
+	return true;
+}
+
+/* Take a parked entry for @dmabuf imported with @flags off the cache */
+static struct kgsl_mem_entry *
+kgsl_dmabuf_cache_get(struct kgsl_process_private *private,
+		struct dma_buf *dmabuf, uint64_t flags)
+{
+	struct kgsl_dma_buf_meta *meta;
+	struct kgsl_mem_entry *entry = NULL;
+
+	spin_lock(&private->mem_lock);
+	list_for_each_entry(meta, &private->dmabuf_cache, node) {
+		if (meta->dmabuf == dmabuf && meta->flags == flags) {
+			list_del(&meta->node);
+			private->dmabuf_cache_count--;
+			entry = meta->attach->priv;
+			break;
+		}
+	}
+	spin_unlock(&private->mem_lock);
+
+	return entry;
+}
+
+/* Give a parked entry a new id in the process */
+static int kgsl_dmabuf_cache_attach(struct kgsl_process_private *process,
+		struct kgsl_mem_entry *entry)
+{
+	int id;
+
+	if (!kgsl_process_private_get(process))
+		return -EBADF;
+
+	idr_preload(GFP_KERNEL);
+	spin_lock(&process->mem_lock);
+	id = idr_alloc(&process->mem_idr, NULL, 1, 0, GFP_NOWAIT);
+	spin_unlock(&process->mem_lock);
+	idr_preload_end();
+
+	if (id < 0) {
+		kgsl_process_private_put(process);
+		return id;
+	}
+
+	kref_init(&entry->refcount);
+	/* put this ref in the caller after the entry is committed */
+	kref_get(&entry->refcount);
+
+	entry->id = id;
+	entry->priv = process;
+	entry->pending_free = 0;
+
+	kgsl_memfree_purge(entry->memdesc.pagetable, entry->memdesc.gpuaddr,
+		entry->memdesc.size);
+
+	return 0;
+}
+
+/* Stop caching for a closing process and drop everything it has parked */
+static void kgsl_dmabuf_cache_flush(struct kgsl_process_private *private)
+{
+	struct kgsl_dma_buf_meta *meta, *tmp;
+	LIST_HEAD(list);
+
+	spin_lock(&private->mem_lock);
+	set_bit(KGSL_PROCESS_CLOSING, &private->priv);
+	list_splice_init(&private->dmabuf_cache, &list);
+	private->dmabuf_cache_count = 0;
+	spin_unlock(&private->mem_lock);
+
+	list_for_each_entry_safe(meta, tmp, &list, node) {
+		list_del(&meta->node);
+		kgsl_dmabuf_cache_release(meta->attach->priv);
+	}
+}
+#else
+static inline bool kgsl_dmabuf_cache_park(struct kgsl_mem_entry *entry)
+{
+	return false;
+}
+
+static inline void kgsl_dmabuf_cache_flush(
+		struct kgsl_process_private *private)
+{
+}
 #endif
 
 static void kgsl_destroy_anon(struct kgsl_memdesc *memdesc)
@@ -322,6 +473,9 @@ kgsl_mem_entry_destroy(struct kref *kref)
 	if (entry == NULL)
 		return;
 
+	if (kgsl_dmabuf_cache_park(entry))
+		return;
+
 	/* pull out the memtype before the flags get cleared */
 	memtype = kgsl_memdesc_usermem_type(&entry->memdesc);
 
@@ -410,9 +564,12 @@ static int kgsl_mem_entry_attach_process(struct kgsl_device *device,
 
 	/*
 	 * Map the memory if a GPU address is already assigned, either through
-	 * kgsl_mem_entry_track_gpuaddr() or via some other SVM process
+	 * kgsl_mem_entry_track_gpuaddr() or via some other SVM process. Lazy
+	 * allocations get mapped just before the next submission instead.
 	 */
-	if (entry->memdesc.gpuaddr) {
+	if (entry->memdesc.flags & KGSL_MEMFLAGS_LAZY)
+		atomic_inc(&process->lazy_count);
+	else if (entry->memdesc.gpuaddr) {
 		ret = kgsl_mmu_map(entry->memdesc.pagetable, &entry->memdesc);
 
 		if (ret)
@@ -447,6 +604,10 @@ static void kgsl_mem_entry_detach_process(struct kgsl_mem_entry *entry)
 
 	spin_unlock(&entry->priv->mem_lock);
 
+	if ((entry->memdesc.flags & KGSL_MEMFLAGS_LAZY) &&
+		!(entry->memdesc.priv & KGSL_MEMDESC_MAPPED))
+		atomic_dec(&entry->priv->lazy_count);
+
 	kgsl_mmu_put_gpuaddr(&entry->memdesc);
 
 	kgsl_process_private_put(entry->priv);
@@ -916,6 +1077,8 @@ static struct kgsl_process_private *kgsl_process_private_new(
 	spin_lock_init(&private->syncsource_lock);
 	spin_lock_init(&private->ctxt_count_lock);
 
+	INIT_LIST_HEAD(&private->dmabuf_cache);
+
 	idr_init(&private->mem_idr);
 	idr_init(&private->syncsource_idr);
 
@@ -1017,6 +1180,7 @@ static void kgsl_process_private_close(struct kgsl_device_private *dev_priv,
 	 */
 	mutex_unlock(&kgsl_driver.process_mutex);
 
+	kgsl_dmabuf_cache_flush(private);
 	process_release_memory(private);
 
 	kgsl_process_private_put(private);
@@ -1494,6 +1658,49 @@ long kgsl_ioctl_device_waittimestamp_ctxtid(
 	return result;
 }
 
+/*
+ * Populate and map the lazy allocations of the process that are not yet
+ * visible to the GPU. The GPU can't fault pages in, so this has to happen
+ * before any command that might touch them is submitted.
+ */
+static int kgsl_process_map_lazy(struct kgsl_process_private *private)
+{
+	struct kgsl_mem_entry *entry;
+	int id = 0, ret = 0;
+
+	if (atomic_read(&private->lazy_count) == 0)
+		return 0;
+
+	spin_lock(&private->mem_lock);
+	for (entry = idr_get_next(&private->mem_idr, &id); entry;
+		id++, entry = idr_get_next(&private->mem_idr, &id)) {
+
+		if (!(entry->memdesc.flags & KGSL_MEMFLAGS_LAZY) ||
+			(entry->memdesc.priv & KGSL_MEMDESC_MAPPED) ||
+			entry->memdesc.gpuaddr == 0)
+			continue;
+
+		if (kgsl_mem_entry_get(entry) == 0)
+			continue;
+		spin_unlock(&private->mem_lock);
+
+		ret = kgsl_memdesc_populate(&entry->memdesc, true);
+		if (ret > 0) {
+			atomic_dec(&private->lazy_count);
+			ret = 0;
+		}
+
+		kgsl_mem_entry_put(entry);
+		spin_lock(&private->mem_lock);
+
+		if (ret)
+			break;
+	}
+	spin_unlock(&private->mem_lock);
+
+	return ret;
+}
+
 long kgsl_ioctl_rb_issueibcmds(struct kgsl_device_private *dev_priv,
 				      unsigned int cmd, void *data)
 {
@@ -1539,6 +1746,10 @@ long kgsl_ioctl_rb_issueibcmds(struct kgsl_device_private *dev_priv,
 		result = kgsl_cmdbatch_add_ibdesc(device, cmdbatch, &ibdesc);
 	}
 
+	if (result)
+		goto done;
+
+	result = kgsl_process_map_lazy(dev_priv->process_priv);
 	if (result)
 		goto done;
 
@@ -1611,6 +1822,10 @@ long kgsl_ioctl_submit_commands(struct kgsl_device_private *dev_priv,
 	if (cmdbatch->profiling_buf_entry == NULL)
 		cmdbatch->flags &= ~KGSL_CMDBATCH_PROFILING;
 
+	result = kgsl_process_map_lazy(dev_priv->process_priv);
+	if (result)
+		goto done;
+
 	result = dev_priv->device->ftbl->issueibcmds(dev_priv, context,
 		cmdbatch, &param->timestamp);
 
@@ -1687,6 +1902,10 @@ long kgsl_ioctl_gpu_command(struct kgsl_device_private *dev_priv,
 	if (cmdbatch->profiling_buf_entry == NULL)
 		cmdbatch->flags &= ~KGSL_CMDBATCH_PROFILING;
 
+	result = kgsl_process_map_lazy(dev_priv->process_priv);
+	if (result)
+		goto done;
+
 	result = dev_priv->device->ftbl->issueibcmds(dev_priv, context,
 		cmdbatch, &param->timestamp);
 
@@ -2274,11 +2493,12 @@ static long _gpuobj_map_useraddr(struct kgsl_device *device,
 
 #ifdef CONFIG_DMA_SHARED_BUFFER
 static long _gpuobj_map_dma_buf(struct kgsl_device *device,
-		struct kgsl_pagetable *pagetable,
+		struct kgsl_process_private *private,
 		struct kgsl_mem_entry *entry,
 		struct kgsl_gpuobj_import *param,
-		int *fd)
+		int *fd, struct kgsl_mem_entry **cached)
 {
+	struct kgsl_dma_buf_meta *meta;
 	struct kgsl_gpuobj_import_dma_buf buf;
 	struct dma_buf *dmabuf;
 	int ret;
@@ -2311,18 +2531,34 @@ static long _gpuobj_map_dma_buf(struct kgsl_device *device,
 	if (IS_ERR_OR_NULL(dmabuf))
 		return (dmabuf == NULL) ? -EINVAL : PTR_ERR(dmabuf);
 
-	ret = kgsl_setup_dma_buf(device, pagetable, entry, dmabuf);
-	if (ret)
+	/* Secure buffers are never held on to after they are freed */
+	if (!(entry->memdesc.priv & KGSL_MEMDESC_SECURE)) {
+		*cached = kgsl_dmabuf_cache_get(private, dmabuf,
+			entry->memdesc.flags);
+		if (*cached) {
+			dma_buf_put(dmabuf);
+			return 0;
+		}
+	}
+
+	ret = kgsl_setup_dma_buf(device, private->pagetable, entry, dmabuf);
+	if (ret) {
 		dma_buf_put(dmabuf);
+		return ret;
+	}
 
-	return ret;
+	meta = entry->priv_data;
+	meta->flags = param->flags;
+	meta->reuse = !(entry->memdesc.priv & KGSL_MEMDESC_SECURE);
+
+	return 0;
 }
 #else
 static long _gpuobj_map_dma_buf(struct kgsl_device *device,
-		struct kgsl_pagetable *pagetable,
+		struct kgsl_process_private *private,
 		struct kgsl_mem_entry *entry,
 		struct kgsl_gpuobj_import *param,
-		int *fd)
+		int *fd, struct kgsl_mem_entry **cached)
 {
 	return -EINVAL;
 }
@@ -2333,7 +2569,7 @@ long kgsl_ioctl_gpuobj_import(struct kgsl_device_private *dev_priv,
 {
 	struct kgsl_process_private *private = dev_priv->process_priv;
 	struct kgsl_gpuobj_import *param = data;
-	struct kgsl_mem_entry *entry;
+	struct kgsl_mem_entry *entry, *cached = NULL;
 	int ret, fd = -1;
 	struct kgsl_mmu *mmu = &dev_priv->device->mmu;
 
@@ -2359,14 +2595,28 @@ long kgsl_ioctl_gpuobj_import(struct kgsl_device_private *dev_priv,
 		ret = _gpuobj_map_useraddr(dev_priv->device, private->pagetable,
 			entry, param);
 	else if (param->type == KGSL_USER_MEM_TYPE_DMABUF)
-		ret = _gpuobj_map_dma_buf(dev_priv->device, private->pagetable,
-			entry, param, &fd);
+		ret = _gpuobj_map_dma_buf(dev_priv->device, private,
+			entry, param, &fd, &cached);
 	else
 		ret = -ENOTSUPP;
 
 	if (ret)
 		goto out;
 
+	if (cached) {
+		kfree(entry);
+		entry = cached;
+
+		ret = kgsl_dmabuf_cache_attach(private, entry);
+		if (ret) {
+			kgsl_dmabuf_cache_release(entry);
+			return ret;
+		}
+
+		param->flags = entry->memdesc.flags;
+		goto attached;
+	}
+
 	if (entry->memdesc.size >= SZ_1M)
 		kgsl_memdesc_set_align(&entry->memdesc, ilog2(SZ_1M));
 	else if (entry->memdesc.size >= SZ_64K)
@@ -2378,6 +2628,7 @@ long kgsl_ioctl_gpuobj_import(struct kgsl_device_private *dev_priv,
 	if (ret)
 		goto unmap;
 
+attached:
 	param->id = entry->id;
 
 	KGSL_STATS_ADD(entry->memdesc.size, &kgsl_driver.stats.mapped,
@@ -3018,12 +3269,18 @@ static struct kgsl_mem_entry *gpumem_alloc_entry(
 		| KGSL_MEMALIGN_MASK
 		| KGSL_MEMFLAGS_USE_CPU_MAP
 		| KGSL_MEMFLAGS_SECURE
-		| KGSL_MEMFLAGS_FORCE_32BIT;
+		| KGSL_MEMFLAGS_FORCE_32BIT
+		| KGSL_MEMFLAGS_LAZY;
 
 	/* Turn off SVM if the system doesn't support it */
 	if (!kgsl_mmu_use_cpu_map(&dev_priv->device->mmu))
 		flags &= ~((uint64_t) KGSL_MEMFLAGS_USE_CPU_MAP);
 
+	/* Lazy backing needs paged memory and a GPU MMU */
+	if ((flags & KGSL_MEMFLAGS_SECURE) ||
+		kgsl_mmu_get_mmutype(dev_priv->device) == KGSL_MMU_TYPE_NONE)
+		flags &= ~((uint64_t) KGSL_MEMFLAGS_LAZY);
+
 	/* Return not supported error if secure memory isn't enabled */
 	if (!kgsl_mmu_is_secured(&dev_priv->device->mmu) &&
 			(flags & KGSL_MEMFLAGS_SECURE)) {
@@ -3533,6 +3790,10 @@ static unsigned long _gpu_set_svm_region(struct kgsl_process_private *private,
 
 	entry->memdesc.pagetable = private->pagetable;
 
+	/* Lazy allocations get mapped just before the next submission */
+	if (entry->memdesc.flags & KGSL_MEMFLAGS_LAZY)
+		return addr;
+
 	ret = kgsl_mmu_map(private->pagetable, &entry->memdesc);
 	if (ret) {
 		kgsl_mmu_put_gpuaddr(&entry->memdesc);
@@ -3806,8 +4067,10 @@ static int kgsl_mmap(struct file *file, struct vm_area_struct *vma)
 
 	vma->vm_ops = &kgsl_gpumem_vm_ops;
 
-	if (cache == KGSL_CACHEMODE_WRITEBACK
-		|| cache == KGSL_CACHEMODE_WRITETHROUGH) {
+	/* Pages of lazy allocations are faulted in as they are touched */
+	if ((cache == KGSL_CACHEMODE_WRITEBACK
+		|| cache == KGSL_CACHEMODE_WRITETHROUGH) &&
+		!(entry->memdesc.priv & KGSL_MEMDESC_LAZY)) {
 		int i;
 		unsigned long addr = vma->vm_start;
 		struct kgsl_memdesc *m = &entry->memdesc;
@@ -4104,6 +4367,8 @@ int kgsl_device_platform_probe(struct kgsl_device *device)
 	/* Initialize common sysfs entries */
 	kgsl_pwrctrl_init_sysfs(device);
 
+	kgsl_bench_init(device);
+
 	return 0;
 
 error_close_mmu:
@@ -4118,6 +4383,8 @@ EXPORT_SYMBOL(kgsl_device_platform_probe);
 
 void kgsl_device_platform_remove(struct kgsl_device *device)
 {
+	kgsl_bench_close(device);
+
 	destroy_workqueue(device->events_wq);
 
 	kgsl_device_snapshot_close(device);
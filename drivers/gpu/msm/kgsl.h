@@ -171,6 +171,8 @@ struct kgsl_memdesc_ops {
 #define KGSL_MEMDESC_CONTIG BIT(8)
 /* For global buffers, randomly assign an address from the region */
 #define KGSL_MEMDESC_RANDOM BIT(9)
+/* Not all the pages of the lazily backed memdesc have been allocated yet */
+#define KGSL_MEMDESC_LAZY BIT(10)
 
 /**
  * struct kgsl_memdesc - GPU memory object descriptor
@@ -0,0 +1,115 @@
+/* Copyright (c) 2018, The Linux Foundation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/module.h>
+#include <linux/sizes.h>
+#include <soc/qcom/msm_bench.h>
+
+#include "kgsl.h"
+#include "kgsl_device.h"
+#include "kgsl_mmu.h"
+#include "kgsl_sharedmem.h"
+
+static unsigned int kgsl_bench_size = SZ_64K;
+module_param_named(bench_size, kgsl_bench_size, uint, 0644);
+MODULE_PARM_DESC(bench_size, "Buffer size used by the kgsl benchmark");
+
+/*
+ * One iteration allocates a user-style buffer, assigns it a GPU address
+ * and maps it, then frees it again - the work behind a
+ * IOCTL_KGSL_GPUOBJ_ALLOC/FREE pair without the ioctl overhead. The
+ * buffer is mapped into the writer's own pagetable, as it would be for
+ * a real allocation from that process.
+ */
+struct kgsl_bench {
+	struct msm_bench bench;
+	struct kgsl_device *device;
+	struct kgsl_pagetable *pagetable;
+	uint64_t size;
+};
+
+static int kgsl_bench_setup(struct msm_bench *bench)
+{
+	struct kgsl_bench *kb = bench->priv;
+
+	kb->size = PAGE_ALIGN(max_t(unsigned int, kgsl_bench_size, 1));
+	bench->bytes = kb->size;
+
+	kb->pagetable = kgsl_mmu_getpagetable(&kb->device->mmu,
+					      task_tgid_nr(current));
+	if (IS_ERR_OR_NULL(kb->pagetable)) {
+		kb->pagetable = NULL;
+		return -ENODEV;
+	}
+
+	return 0;
+}
+
+static int kgsl_bench_run(struct msm_bench *bench)
+{
+	struct kgsl_bench *kb = bench->priv;
+	struct kgsl_memdesc memdesc;
+	int ret;
+
+	memset(&memdesc, 0, sizeof(memdesc));
+
+	ret = kgsl_allocate_user(kb->device, &memdesc, kb->size, 0);
+	if (ret)
+		return ret;
+
+	ret = kgsl_mmu_get_gpuaddr(kb->pagetable, &memdesc);
+	if (!ret)
+		ret = kgsl_mmu_map(kb->pagetable, &memdesc);
+
+	/* Unmaps and releases the GPU address as well */
+	kgsl_sharedmem_free(&memdesc);
+	return ret;
+}
+
+static void kgsl_bench_teardown(struct msm_bench *bench)
+{
+	struct kgsl_bench *kb = bench->priv;
+
+	kgsl_mmu_putpagetable(kb->pagetable);
+	kb->pagetable = NULL;
+}
+
+/* Only the first device probed gets a benchmark */
+static struct kgsl_bench kgsl_alloc_bench = {
+	.bench = {
+		.name		= "kgsl_alloc_map",
+		.setup		= kgsl_bench_setup,
+		.run		= kgsl_bench_run,
+		.teardown	= kgsl_bench_teardown,
+		.priv		= &kgsl_alloc_bench,
+	},
+};
+
+void kgsl_bench_init(struct kgsl_device *device)
+{
+	if (kgsl_alloc_bench.device ||
+	    kgsl_mmu_get_mmutype(device) == KGSL_MMU_TYPE_NONE)
+		return;
+
+	kgsl_alloc_bench.device = device;
+	if (msm_bench_register(&kgsl_alloc_bench.bench))
+		kgsl_alloc_bench.device = NULL;
+}
+
+void kgsl_bench_close(struct kgsl_device *device)
+{
+	if (kgsl_alloc_bench.device != device)
+		return;
+
+	msm_bench_unregister(&kgsl_alloc_bench.bench);
+	kgsl_alloc_bench.device = NULL;
+}
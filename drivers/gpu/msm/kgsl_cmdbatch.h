@@ -49,6 +49,9 @@
  * @global_ts: The ringbuffer timestamp corresponding to this cmdbatch
  * @timeout_jiffies: For a syncpoint cmdbatch the jiffies at which the
  * timer will expire
+ * @submit_time: ktime in ns at the time of cmdbatch submit
+ * @deadline: ktime in ns by which the cmdbatch should retire, 0 if the
+ * context has no deadline
  * This structure defines an atomic batch of command buffers issued from
  * userspace.
  */
@@ -74,6 +77,8 @@ struct kgsl_cmdbatch {
 	uint64_t submit_ticks;
 	unsigned int global_ts;
 	unsigned long timeout_jiffies;
+	u64 submit_time;
+	u64 deadline;
 };
 
 /**
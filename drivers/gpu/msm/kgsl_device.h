@@ -176,6 +176,8 @@ struct kgsl_functable {
 	void (*stop_fault_timer)(struct kgsl_device *device);
 	void (*dispatcher_halt)(struct kgsl_device *device);
 	void (*dispatcher_unhalt)(struct kgsl_device *device);
+	void (*snapshot_objects)(struct kgsl_device *device,
+		struct kgsl_snapshot *snapshot);
 };
 
 struct kgsl_ioctl {
@@ -413,6 +415,7 @@ struct kgsl_context {
  * @fd_count: Counter for the number of FDs for this process
  * @ctxt_count: Count for the number of contexts for this process
  * @ctxt_count_lock: Spinlock to protect ctxt_count
+ * @lazy_count: Number of lazy allocations not yet mapped to the GPU
  */
 struct kgsl_process_private {
 	unsigned long priv;
@@ -435,14 +438,19 @@ struct kgsl_process_private {
 	int fd_count;
 	atomic_t ctxt_count;
 	spinlock_t ctxt_count_lock;
+	atomic_t lazy_count;
+	struct list_head dmabuf_cache;
+	unsigned int dmabuf_cache_count;
 };
 
 /**
  * enum kgsl_process_priv_flags - Private flags for kgsl_process_private
  * @KGSL_PROCESS_INIT: Set if the process structure has been set up
+ * @KGSL_PROCESS_CLOSING: Set once freed dma-bufs may no longer be cached
  */
 enum kgsl_process_priv_flags {
 	KGSL_PROCESS_INIT = 0,
+	KGSL_PROCESS_CLOSING,
 };
 
 struct kgsl_device_private {
@@ -614,6 +622,14 @@ void kgsl_device_snapshot(struct kgsl_device *device,
 void kgsl_device_snapshot_close(struct kgsl_device *device);
 void kgsl_snapshot_save_frozen_objs(struct work_struct *work);
 
+#ifdef CONFIG_MSM_KGSL_BENCH
+void kgsl_bench_init(struct kgsl_device *device);
+void kgsl_bench_close(struct kgsl_device *device);
+#else
+static inline void kgsl_bench_init(struct kgsl_device *device) { }
+static inline void kgsl_bench_close(struct kgsl_device *device) { }
+#endif
+
 void kgsl_events_init(void);
 void kgsl_events_exit(void);
 
@@ -16,38 +16,69 @@
 #include <linux/slab.h>
 #include <linux/highmem.h>
 #include <linux/version.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 
 #include "kgsl.h"
 #include "kgsl_device.h"
 #include "kgsl_pool.h"
+#include "kgsl_debugfs.h"
 
 #define KGSL_MAX_POOLS 4
 #define KGSL_MAX_POOL_ORDER 8
 #define KGSL_MAX_RESERVED_PAGES 4096
 
+/**
+ * struct kgsl_pool_latency - Allocation latency statistics
+ * @count: Number of allocations
+ * @total_ns: Time spent in all allocations
+ * @max_ns: Longest allocation
+ */
+struct kgsl_pool_latency {
+	u64 count;
+	u64 total_ns;
+	u64 max_ns;
+};
+
 /**
  * struct kgsl_page_pool - Structure to hold information for the pool
  * @pool_order: Page order describing the size of the page
  * @page_count: Number of pages currently present in the pool
  * @reserved_pages: Number of pages reserved at init for the pool
+ * @high_watermark: Number of pages the background worker keeps in the pool
  * @allocation_allowed: Tells if reserved pool gets exhausted, can we allocate
  * from system memory
  * @list_lock: Spinlock for page list in the pool
  * @page_list: List of pages held/reserved in this pool
+ * @hit: Latency of allocations served from the pool
+ * @miss: Latency of allocations that had to go to system memory
  */
 struct kgsl_page_pool {
 	unsigned int pool_order;
 	int page_count;
 	unsigned int reserved_pages;
+	unsigned int high_watermark;
 	bool allocation_allowed;
 	spinlock_t list_lock;
 	struct list_head page_list;
+	struct kgsl_pool_latency hit;
+	struct kgsl_pool_latency miss;
 };
 
 static struct kgsl_page_pool kgsl_pools[KGSL_MAX_POOLS];
 static int kgsl_num_pools;
 static int kgsl_pool_max_pages;
 
+/* Time to hold off refilling after the shrinker ran or an allocation failed */
+#define KGSL_POOL_REFILL_BACKOFF HZ
+
+static void kgsl_pool_refill_worker(struct work_struct *work);
+static DECLARE_WORK(kgsl_pool_refill_work, kgsl_pool_refill_worker);
+static unsigned long kgsl_pool_refill_backoff;
+static struct dentry *kgsl_pool_debugfs;
+
 
 /* Returns KGSL pool corresponding to input page order*/
 static struct kgsl_page_pool *
@@ -265,10 +296,82 @@ void kgsl_pool_free_pages(struct page **pages, unsigned int pcount)
 		 */
 		struct page *p = pages[i];
 
+		/* Lazily backed allocations may have holes */
+		if (p == NULL) {
+			i++;
+			continue;
+		}
+
 		i += 1 << compound_order(p);
 		kgsl_pool_free_page(p);
 	}
 }
+
+static void _kgsl_pool_account(struct kgsl_page_pool *pool, bool hit,
+		ktime_t start)
+{
+	struct kgsl_pool_latency *lat = hit ? &pool->hit : &pool->miss;
+	u64 ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	spin_lock(&pool->list_lock);
+	lat->count++;
+	lat->total_ns += ns;
+	if (ns > lat->max_ns)
+		lat->max_ns = ns;
+	spin_unlock(&pool->list_lock);
+}
+
+static bool _kgsl_pool_needs_refill(struct kgsl_page_pool *pool)
+{
+	return pool->allocation_allowed &&
+		pool->page_count < pool->high_watermark;
+}
+
+/*
+ * Top up each pool that allows system allocations to its high watermark
+ * with pages that are zeroed ahead of time, so that kgsl_pool_alloc_page()
+ * does not have to allocate and zero them when the GPU needs memory.
+ */
+static void kgsl_pool_refill_worker(struct work_struct *work)
+{
+	int i;
+
+	for (i = 0; i < kgsl_num_pools; i++) {
+		struct kgsl_page_pool *pool = &kgsl_pools[i];
+		gfp_t gfp_mask = (kgsl_gfp_mask(pool->pool_order) |
+				__GFP_NORETRY | __GFP_NOWARN |
+				__GFP_NO_KSWAPD | __GFP_NOMEMALLOC) &
+				~__GFP_WAIT;
+
+		while (_kgsl_pool_needs_refill(pool)) {
+			struct page *page;
+
+			if (time_before(jiffies, kgsl_pool_refill_backoff))
+				return;
+
+			if (kgsl_pool_max_pages &&
+				kgsl_pool_size_total() >= kgsl_pool_max_pages)
+				return;
+
+			page = alloc_pages(gfp_mask, pool->pool_order);
+			if (page == NULL) {
+				kgsl_pool_refill_backoff = jiffies +
+					KGSL_POOL_REFILL_BACKOFF;
+				return;
+			}
+
+			_kgsl_pool_add_page(pool, page);
+			cond_resched();
+		}
+	}
+}
+
+static void kgsl_pool_queue_refill(struct kgsl_page_pool *pool)
+{
+	if (_kgsl_pool_needs_refill(pool))
+		queue_work(system_unbound_wq, &kgsl_pool_refill_work);
+}
+
 static int kgsl_pool_idx_lookup(unsigned int order)
 {
 	int i;
@@ -311,6 +414,7 @@ int kgsl_pool_alloc_page(int *page_size, struct page **pages,
 	int order = get_order(*page_size);
 	int pool_idx;
 	size_t size = 0;
+	ktime_t start;
 
 	if ((pages == NULL) || pages_len < (*page_size >> PAGE_SHIFT))
 		return -EINVAL;
@@ -355,7 +459,12 @@ int kgsl_pool_alloc_page(int *page_size, struct page **pages,
 	}
 
 	pool_idx = kgsl_pool_idx_lookup(order);
+	start = ktime_get();
 	page = _kgsl_pool_get_page(pool);
+	kgsl_pool_queue_refill(pool);
+
+	if (page != NULL)
+		_kgsl_pool_account(pool, true, start);
 
 	/* Allocate a new page if not allocated from pool */
 	if (page == NULL) {
@@ -381,6 +490,7 @@ int kgsl_pool_alloc_page(int *page_size, struct page **pages,
 		}
 
 		_kgsl_pool_zero_page(page, order);
+		_kgsl_pool_account(pool, false, start);
 	}
 
 done:
@@ -471,6 +581,9 @@ kgsl_pool_shrink_scan_objects(struct shrinker *shrinker,
 	/* Target pages represents new  pool size */
 	int target_pages = (nr > total_pages) ? 0 : (total_pages - nr);
 
+	/* Do not refill what we are asked to give back */
+	kgsl_pool_refill_backoff = jiffies + KGSL_POOL_REFILL_BACKOFF;
+
 	/* Reduce pool size to target_pages */
 	return kgsl_pool_reduce(target_pages, false);
 }
@@ -492,7 +605,7 @@ static struct shrinker kgsl_pool_shrinker = {
 };
 
 static void kgsl_pool_config(unsigned int order, unsigned int reserved_pages,
-		bool allocation_allowed)
+		unsigned int high_watermark, bool allocation_allowed)
 {
 #ifdef CONFIG_ALLOC_BUFFERS_IN_4K_CHUNKS
 	if (order > 0) {
@@ -506,6 +619,8 @@ static void kgsl_pool_config(unsigned int order, unsigned int reserved_pages,
 
 	kgsl_pools[kgsl_num_pools].pool_order = order;
 	kgsl_pools[kgsl_num_pools].reserved_pages = reserved_pages;
+	kgsl_pools[kgsl_num_pools].high_watermark = min_t(unsigned int,
+			high_watermark, KGSL_MAX_RESERVED_PAGES);
 	kgsl_pools[kgsl_num_pools].allocation_allowed = allocation_allowed;
 	spin_lock_init(&kgsl_pools[kgsl_num_pools].list_lock);
 	INIT_LIST_HEAD(&kgsl_pools[kgsl_num_pools].page_list);
@@ -520,6 +635,7 @@ static void kgsl_of_parse_mempools(struct device_node *node)
 
 	for_each_child_of_node(node, child) {
 		unsigned int index;
+		unsigned int high_watermark = 0;
 
 		if (of_property_read_u32(child, "reg", &index))
 			return;
@@ -534,11 +650,14 @@ static void kgsl_of_parse_mempools(struct device_node *node)
 		of_property_read_u32(child, "qcom,mempool-reserved",
 				&reserved_pages);
 
+		of_property_read_u32(child, "qcom,mempool-high-watermark",
+				&high_watermark);
+
 		allocation_allowed = of_property_read_bool(child,
 				"qcom,mempool-allocate");
 
 		kgsl_pool_config(ilog2(page_size >> PAGE_SHIFT), reserved_pages,
-				allocation_allowed);
+				high_watermark, allocation_allowed);
 	}
 }
 
@@ -555,8 +674,53 @@ static void kgsl_of_get_mempools(struct device_node *parent)
 	}
 }
 
+static u64 _kgsl_pool_avg_ns(struct kgsl_pool_latency *lat)
+{
+	return lat->count ? div64_u64(lat->total_ns, lat->count) : 0;
+}
+
+static int kgsl_pool_debugfs_show(struct seq_file *s, void *unused)
+{
+	int i;
+
+	seq_puts(s, "order pages reserved high_wm hits hit_avg_ns hit_max_ns misses miss_avg_ns miss_max_ns\n");
+
+	for (i = 0; i < kgsl_num_pools; i++) {
+		struct kgsl_page_pool *pool = &kgsl_pools[i];
+		struct kgsl_pool_latency hit, miss;
+		int count;
+
+		spin_lock(&pool->list_lock);
+		count = pool->page_count;
+		hit = pool->hit;
+		miss = pool->miss;
+		spin_unlock(&pool->list_lock);
+
+		seq_printf(s, "%5u %5d %8u %7u %llu %llu %llu %llu %llu %llu\n",
+			pool->pool_order, count, pool->reserved_pages,
+			pool->high_watermark,
+			hit.count, _kgsl_pool_avg_ns(&hit), hit.max_ns,
+			miss.count, _kgsl_pool_avg_ns(&miss), miss.max_ns);
+	}
+
+	return 0;
+}
+
+static int kgsl_pool_debugfs_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, kgsl_pool_debugfs_show, NULL);
+}
+
+static const struct file_operations kgsl_pool_debugfs_fops = {
+	.open = kgsl_pool_debugfs_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 void kgsl_init_page_pools(struct platform_device *pdev)
 {
+	int i;
 
 	/* Get GPU mempools data and configure pools */
 	kgsl_of_get_mempools(pdev->dev.of_node);
@@ -566,10 +730,25 @@ void kgsl_init_page_pools(struct platform_device *pdev)
 
 	/* Initialize shrinker */
 	register_shrinker(&kgsl_pool_shrinker);
+
+	kgsl_pool_debugfs = debugfs_create_file("mempools", 0444,
+			kgsl_get_debugfs_dir(), NULL, &kgsl_pool_debugfs_fops);
+
+	/* Grow the pools to their high watermark in the background */
+	kgsl_pool_refill_backoff = jiffies;
+	for (i = 0; i < kgsl_num_pools; i++)
+		kgsl_pool_queue_refill(&kgsl_pools[i]);
 }
 
 void kgsl_exit_page_pools(void)
 {
+	/* Stop growing the pools before they are released */
+	kgsl_pool_refill_backoff = jiffies + KGSL_POOL_REFILL_BACKOFF;
+	cancel_work_sync(&kgsl_pool_refill_work);
+
+	debugfs_remove(kgsl_pool_debugfs);
+	kgsl_pool_debugfs = NULL;
+
 	/* Release all pages in pools, if any.*/
 	kgsl_pool_reduce(0, true);
 
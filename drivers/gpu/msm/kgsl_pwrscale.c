@@ -119,6 +119,23 @@ void kgsl_pwrscale_busy(struct kgsl_device *device)
 }
 EXPORT_SYMBOL(kgsl_pwrscale_busy);
 
+/**
+ * kgsl_pwrscale_frame_done() - note the retirement of an end of frame
+ * @device: The device
+ *
+ * Count a frame boundary for governors that scale per frame. This is safe
+ * to call without the device mutex held.
+ */
+void kgsl_pwrscale_frame_done(struct kgsl_device *device)
+{
+	struct devfreq_msm_adreno_tz_data *data =
+		device->pwrscale.gpu_profile.private_data;
+
+	if (device->pwrscale.enabled && data)
+		atomic_inc(&data->frame.count);
+}
+EXPORT_SYMBOL(kgsl_pwrscale_frame_done);
+
 /**
  * kgsl_pwrscale_update_stats() - update device busy statistics
  * @device: The device
@@ -803,6 +820,9 @@ int kgsl_pwrscale_init(struct device *dev, const char *governor)
 	data->disable_busy_time_burst = of_property_read_bool(
 		device->pdev->dev.of_node, "qcom,disable-busy-time-burst");
 
+	data->frame.enable = of_property_read_bool(
+		device->pdev->dev.of_node, "qcom,frame-dcvs");
+
 	data->ctxt_aware_enable =
 		of_property_read_bool(device->pdev->dev.of_node,
 			"qcom,enable-ca-jump");
@@ -423,12 +423,82 @@ int kgsl_allocate_user(struct kgsl_device *device,
 		ret = kgsl_sharedmem_alloc_contig(device, memdesc, size);
 	else if (flags & KGSL_MEMFLAGS_SECURE)
 		ret = kgsl_allocate_secure(device, memdesc, size);
+	else if (flags & KGSL_MEMFLAGS_LAZY)
+		ret = kgsl_sharedmem_page_alloc_lazy(memdesc, size);
 	else
 		ret = kgsl_sharedmem_page_alloc_user(memdesc, size);
 
 	return ret;
 }
 
+/* Serializes populating the pages of lazily backed memdescs */
+static DEFINE_MUTEX(kgsl_lazy_lock);
+
+/* Allocate the missing page at @pgoff - must hold kgsl_lazy_lock */
+static int _lazy_alloc_page(struct kgsl_memdesc *memdesc, unsigned int pgoff)
+{
+	struct page *page = NULL;
+	int page_size = PAGE_SIZE;
+	unsigned int align = 0;
+	int ret;
+
+	do {
+		ret = kgsl_pool_alloc_page(&page_size, &page, 1, &align);
+	} while (ret == -EAGAIN);
+
+	if (ret <= 0)
+		return -ENOMEM;
+
+	/* The page must be zeroed before the fault path can see it */
+	smp_wmb();
+	memdesc->pages[pgoff] = page;
+
+	return 0;
+}
+
+/**
+ * kgsl_memdesc_populate() - Allocate all the pages of a lazy memdesc
+ * @memdesc: Memory descriptor to populate
+ * @map: Also map the memdesc into its GPU pagetable if it has an address
+ *
+ * Returns 1 if the memdesc was mapped into the GPU pagetable by this call, 0
+ * if there was nothing left to do or a negative error code on failure
+ */
+int kgsl_memdesc_populate(struct kgsl_memdesc *memdesc, bool map)
+{
+	unsigned int i;
+	int ret = 0;
+
+	if (!(memdesc->flags & KGSL_MEMFLAGS_LAZY))
+		return 0;
+
+	mutex_lock(&kgsl_lazy_lock);
+
+	if (memdesc->priv & KGSL_MEMDESC_LAZY) {
+		for (i = 0; i < memdesc->page_count; i++) {
+			if (memdesc->pages[i] != NULL)
+				continue;
+
+			ret = _lazy_alloc_page(memdesc, i);
+			if (ret)
+				goto done;
+		}
+
+		memdesc->priv &= ~KGSL_MEMDESC_LAZY;
+	}
+
+	if (map && memdesc->gpuaddr &&
+		!(memdesc->priv & KGSL_MEMDESC_MAPPED)) {
+		ret = kgsl_mmu_map(memdesc->pagetable, memdesc);
+		if (ret == 0)
+			ret = 1;
+	}
+
+done:
+	mutex_unlock(&kgsl_lazy_lock);
+	return ret;
+}
+
 static int kgsl_page_alloc_vmfault(struct kgsl_memdesc *memdesc,
 				struct vm_area_struct *vma,
 				struct vm_fault *vmf)
@@ -444,7 +514,22 @@ static int kgsl_page_alloc_vmfault(struct kgsl_memdesc *memdesc,
 	pgoff = offset >> PAGE_SHIFT;
 
 	if (pgoff < memdesc->page_count) {
-		struct page *page = memdesc->pages[pgoff];
+		struct page *page = ACCESS_ONCE(memdesc->pages[pgoff]);
+
+		/* Back the page of a lazy allocation on first touch */
+		if (page == NULL) {
+			mutex_lock(&kgsl_lazy_lock);
+
+			if (memdesc->pages[pgoff] == NULL &&
+				_lazy_alloc_page(memdesc, pgoff)) {
+				mutex_unlock(&kgsl_lazy_lock);
+				return VM_FAULT_OOM;
+			}
+
+			page = memdesc->pages[pgoff];
+			mutex_unlock(&kgsl_lazy_lock);
+		} else
+			smp_rmb();
 
 		get_page(page);
 		vmf->page = page;
@@ -539,6 +624,13 @@ static int kgsl_page_alloc_map_kernel(struct kgsl_memdesc *memdesc)
 	if (memdesc->size > ULONG_MAX)
 		return -ENOMEM;
 
+	/* vmap() needs every page to be there */
+	ret = kgsl_memdesc_populate(memdesc, false);
+	if (ret < 0)
+		return ret;
+
+	ret = 0;
+
 	mutex_lock(&kernel_map_global_lock);
 	if ((!memdesc->hostptr) && (memdesc->pages != NULL)) {
 		pgprot_t page_prot = pgprot_writecombine(PAGE_KERNEL);
@@ -731,6 +823,12 @@ int kgsl_cache_range_op(struct kgsl_memdesc *memdesc, uint64_t offset,
 	 * If the buffer is not to mapped to kernel, perform cache
 	 * operations after mapping to kernel.
 	 */
+	ret = kgsl_memdesc_populate(memdesc, false);
+	if (ret < 0)
+		return ret;
+
+	ret = 0;
+
 	if (memdesc->sgt != NULL)
 		sgt = memdesc->sgt;
 	else {
@@ -787,6 +885,16 @@ kgsl_sharedmem_page_alloc_user(struct kgsl_memdesc *memdesc,
 
 	align = (memdesc->flags & KGSL_MEMALIGN_MASK) >> KGSL_MEMALIGN_SHIFT;
 
+	/*
+	 * Large buffers are mostly textures and render targets - back them
+	 * with 64K aligned chunks so that the IOMMU can map them with 64K
+	 * entries instead of 4K ones and the GPU takes fewer TLB misses
+	 */
+	if (size >= SZ_1M && align < ilog2(SZ_64K)) {
+		kgsl_memdesc_set_align(memdesc, ilog2(SZ_64K));
+		align = ilog2(SZ_64K);
+	}
+
 	page_size = kgsl_get_page_size(size, align);
 
 	/*
@@ -935,6 +1043,41 @@ done:
 	return ret;
 }
 
+/**
+ * kgsl_sharedmem_page_alloc_lazy() - Set up a lazily backed allocation
+ * @memdesc: Memory descriptor of the allocation
+ * @size: Size of the allocation
+ *
+ * Only the page array is allocated here. Pages are filled in on the first
+ * CPU fault of each page, or all at once by kgsl_memdesc_populate() before
+ * the kernel or the GPU need to access the memory.
+ */
+int kgsl_sharedmem_page_alloc_lazy(struct kgsl_memdesc *memdesc,
+			uint64_t size)
+{
+	size = PAGE_ALIGN(size);
+	if (size == 0 || size > UINT_MAX)
+		return -EINVAL;
+
+	memdesc->pages = kgsl_malloc((size >> PAGE_SHIFT) *
+		sizeof(struct page *));
+	if (memdesc->pages == NULL)
+		return -ENOMEM;
+
+	memset(memdesc->pages, 0, (size >> PAGE_SHIFT) *
+		sizeof(struct page *));
+
+	memdesc->ops = &kgsl_page_alloc_ops;
+	memdesc->size = size;
+	memdesc->page_count = size >> PAGE_SHIFT;
+	memdesc->priv |= KGSL_MEMDESC_LAZY;
+
+	KGSL_STATS_ADD(memdesc->size, &kgsl_driver.stats.page_alloc,
+		&kgsl_driver.stats.page_alloc_max);
+
+	return 0;
+}
+
 void kgsl_sharedmem_free(struct kgsl_memdesc *memdesc)
 {
 	if (memdesc == NULL || memdesc->size == 0)
@@ -73,6 +73,11 @@ void kgsl_get_memory_usage(char *str, size_t len, uint64_t memflags);
 int kgsl_sharedmem_page_alloc_user(struct kgsl_memdesc *memdesc,
 				uint64_t size);
 
+int kgsl_sharedmem_page_alloc_lazy(struct kgsl_memdesc *memdesc,
+				uint64_t size);
+
+int kgsl_memdesc_populate(struct kgsl_memdesc *memdesc, bool map);
+
 #define MEMFLAGS(_flags, _mask, _shift) \
 	((unsigned int) (((_flags) & (_mask)) >> (_shift)))
 
@@ -577,7 +577,6 @@ void kgsl_device_snapshot(struct kgsl_device *device,
 	struct kgsl_snapshot_header *header = device->snapshot_memory.ptr;
 	struct kgsl_snapshot *snapshot;
 	struct timespec boot;
-	phys_addr_t pa;
 
 	if (device->snapshot_memory.ptr == NULL) {
 		KGSL_DRV_ERR(device,
@@ -639,18 +638,12 @@ void kgsl_device_snapshot(struct kgsl_device *device,
 	/* Store the instance in the device until it gets dumped */
 	device->snapshot = snapshot;
 
-	/* log buffer info to aid in ramdump fault tolerance */
-	pa = __pa(device->snapshot_memory.ptr);
-	KGSL_DRV_ERR(device, "snapshot created at pa %pa size %zd\n",
-			&pa, snapshot->size);
-
 	sysfs_notify(&device->snapshot_kobj, NULL, "timestamp");
 
 	/*
-	 * Queue a work item that will save the IB data in snapshot into
-	 * static memory to prevent loss of data due to overwriting of
-	 * memory.
-	 *
+	 * Queue a work item that will dump the IBs found above and save the
+	 * rest of the objects into memory to prevent loss of data due to
+	 * overwriting of memory. Readers wait for it on dump_gate.
 	 */
 	kgsl_schedule_work(&snapshot->work);
 }
@@ -1096,10 +1089,20 @@ void kgsl_snapshot_save_frozen_objs(struct work_struct *work)
 	struct kgsl_snapshot_object *obj, *tmp;
 	size_t size = 0;
 	void *ptr;
+	phys_addr_t pa;
 
 	if (IS_ERR_OR_NULL(device))
 		return;
 
+	/* Add the sections that don't need the hardware */
+	if (device->ftbl->snapshot_objects)
+		device->ftbl->snapshot_objects(device, snapshot);
+
+	/* log buffer info to aid in ramdump fault tolerance */
+	pa = __pa(device->snapshot_memory.ptr);
+	KGSL_DRV_ERR(device, "snapshot created at pa %pa size %zd\n",
+			&pa, snapshot->size);
+
 	kgsl_snapshot_process_ib_obj_list(snapshot);
 
 	list_for_each_entry(obj, &snapshot->obj_list, node) {
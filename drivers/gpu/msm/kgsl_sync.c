@@ -96,7 +96,20 @@ static void kgsl_fence_event_cb(struct kgsl_device *device,
 		struct kgsl_event_group *group, void *priv, int result)
 {
 	struct kgsl_fence_event_priv *ev = priv;
-	kgsl_sync_timeline_signal(ev->context->timeline, ev->timestamp);
+	unsigned int timestamp = ev->timestamp;
+	unsigned int retired;
+
+	/*
+	 * Signal up to the latest retired timestamp so that the events of the
+	 * other fences retired by the same interrupt find the timeline already
+	 * signaled and don't walk it and wake up the waiters once again
+	 */
+	if (result == KGSL_EVENT_RETIRED && !kgsl_readtimestamp(device,
+		ev->context, KGSL_TIMESTAMP_RETIRED, &retired) &&
+		timestamp_cmp(retired, timestamp) > 0)
+		timestamp = retired;
+
+	kgsl_sync_timeline_signal(ev->context->timeline, timestamp);
 	kgsl_context_put(ev->context);
 	kfree(ev);
 }
@@ -104,9 +117,22 @@ static void kgsl_fence_event_cb(struct kgsl_device *device,
 static int _add_fence_event(struct kgsl_device *device,
 	struct kgsl_context *context, unsigned int timestamp)
 {
+	struct kgsl_sync_timeline *ktimeline =
+		(struct kgsl_sync_timeline *) context->timeline;
 	struct kgsl_fence_event_priv *event;
 	int ret;
 
+	/*
+	 * Fences on the same timestamp share a single event - the timeline
+	 * signal from that event takes care of all of them
+	 */
+	spin_lock(&ktimeline->lock);
+	if (ktimeline->last_event_ts == timestamp) {
+		spin_unlock(&ktimeline->lock);
+		return 0;
+	}
+	spin_unlock(&ktimeline->lock);
+
 	event = kmalloc(sizeof(*event), GFP_KERNEL);
 	if (event == NULL)
 		return -ENOMEM;
@@ -130,6 +156,10 @@ static int _add_fence_event(struct kgsl_device *device,
 	if (ret) {
 		kgsl_context_put(context);
 		kfree(event);
+	} else {
+		spin_lock(&ktimeline->lock);
+		ktimeline->last_event_ts = timestamp;
+		spin_unlock(&ktimeline->lock);
 	}
 
 	return ret;
@@ -341,6 +371,7 @@ int kgsl_sync_timeline_create(struct kgsl_context *context)
 
 	ktimeline = (struct kgsl_sync_timeline *) context->timeline;
 	ktimeline->last_timestamp = 0;
+	ktimeline->last_event_ts = 0;
 	ktimeline->device = context->device;
 	ktimeline->context_id = context->id;
 
@@ -353,13 +384,18 @@ static void kgsl_sync_timeline_signal(struct sync_timeline *timeline,
 {
 	struct kgsl_sync_timeline *ktimeline =
 		(struct kgsl_sync_timeline *) timeline;
+	bool advanced = false;
 
 	spin_lock(&ktimeline->lock);
-	if (timestamp_cmp(timestamp, ktimeline->last_timestamp) > 0)
+	if (timestamp_cmp(timestamp, ktimeline->last_timestamp) > 0) {
 		ktimeline->last_timestamp = timestamp;
+		advanced = true;
+	}
 	spin_unlock(&ktimeline->lock);
 
-	sync_timeline_signal(timeline);
+	/* Nothing new can have signaled if the timeline didn't move */
+	if (advanced)
+		sync_timeline_signal(timeline);
 }
 
 void kgsl_sync_timeline_destroy(struct kgsl_context *context)
@@ -16,9 +16,19 @@
 #include <linux/sync.h>
 #include "kgsl_device.h"
 
+/**
+ * struct kgsl_sync_timeline - KGSL timeline for the fences of a context
+ * @timeline: The generic sync timeline
+ * @last_timestamp: Last timestamp the timeline has been signaled for
+ * @last_event_ts: Timestamp of the last fence event registered
+ * @device: The KGSL device that owns the context
+ * @context_id: ID of the context that owns the timeline
+ * @lock: Protects @last_timestamp and @last_event_ts
+ */
 struct kgsl_sync_timeline {
 	struct sync_timeline timeline;
 	unsigned int last_timestamp;
+	unsigned int last_event_ts;
 	struct kgsl_device *device;
 	u32 context_id;
 	spinlock_t lock;
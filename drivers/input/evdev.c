@@ -55,6 +55,9 @@ struct evdev_client {
 	struct list_head node;
 	int clkid;
 	bool revoked;
+	struct input_event_ring *ring; /* set once the client mmap()s a ring */
+	unsigned int ring_head; /* kernel copies; the shared header is */
+	unsigned int ring_size; /* writable by userspace */
 	unsigned int bufsize;
 	struct input_event buffer[];
 };
@@ -134,9 +137,43 @@ static void evdev_queue_syn_dropped(struct evdev_client *client)
 	spin_unlock_irqrestore(&client->buffer_lock, flags);
 }
 
+/*
+ * Deliver to the client's mmap()ed ring. Single producer (serialized by
+ * client->buffer_lock), single consumer in userspace.
+ */
+static void __pass_event_ring(struct evdev_client *client,
+			      const struct input_event *event)
+{
+	struct input_event_ring *ring = client->ring;
+	unsigned int head = client->ring_head;
+	unsigned int tail = ACCESS_ONCE(ring->tail);
+
+	/* Don't overwrite a slot until userspace is done with it */
+	smp_mb();
+
+	if (head - tail >= client->ring_size) {
+		ring->dropped++;
+		return;
+	}
+
+	ring->events[head & (client->ring_size - 1)] = *event;
+	/* Publish the slot before the new head */
+	smp_wmb();
+	client->ring_head = head + 1;
+	ACCESS_ONCE(ring->head) = client->ring_head;
+
+	if (event->type == EV_SYN && event->code == SYN_REPORT)
+		kill_fasync(&client->fasync, SIGIO, POLL_IN);
+}
+
 static void __pass_event(struct evdev_client *client,
 			 const struct input_event *event)
 {
+	if (client->ring) {
+		__pass_event_ring(client, event);
+		return;
+	}
+
 	client->buffer[client->head++] = *event;
 	client->head &= client->bufsize - 1;
 
@@ -208,7 +245,7 @@ static void evdev_events(struct input_handle *handle,
 	struct evdev_client *client;
 	ktime_t time_mono, time_real;
 
-	time_mono = ktime_get();
+	time_mono = input_get_timestamp(handle->dev);
 	time_real = ktime_mono_to_real(time_mono);
 
 	rcu_read_lock();
@@ -367,6 +404,8 @@ static int evdev_release(struct inode *inode, struct file *file)
 	if (client->use_wake_lock)
 		wake_lock_destroy(&client->wake_lock);
 
+	vfree(client->ring);
+
 	if (is_vmalloc_addr(client))
 		vfree(client);
 	else
@@ -546,12 +585,71 @@ static unsigned int evdev_poll(struct file *file, poll_table *wait)
 	else
 		mask = POLLHUP | POLLERR;
 
-	if (client->packet_head != client->tail)
+	if (client->ring) {
+		if (client->ring_head != ACCESS_ONCE(client->ring->tail))
+			mask |= POLLIN | POLLRDNORM;
+	} else if (client->packet_head != client->tail) {
 		mask |= POLLIN | POLLRDNORM;
+	}
 
 	return mask;
 }
 
+/* Largest ring a client can map, bounding the vmalloc_user() below */
+#define EVDEV_RING_MAX_EVENTS	(1U << 16)
+
+static int evdev_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct evdev_client *client = file->private_data;
+	struct input_event_ring *ring;
+	unsigned long len = vma->vm_end - vma->vm_start;
+	unsigned int size;
+	int error;
+
+	/* Slots are laid out with the native struct input_event */
+	if (input_event_size() != sizeof(struct input_event))
+		return -EINVAL;
+
+	if (vma->vm_pgoff || len <= sizeof(*ring) ||
+	    len > PAGE_ALIGN(sizeof(*ring) + EVDEV_RING_MAX_EVENTS *
+			     sizeof(struct input_event)) ||
+	    !(vma->vm_flags & VM_SHARED))
+		return -EINVAL;
+
+	size = min_t(unsigned long, (len - sizeof(*ring)) /
+		     sizeof(struct input_event), EVDEV_RING_MAX_EVENTS);
+	if (!size)
+		return -EINVAL;
+	size = rounddown_pow_of_two(size);
+
+	ring = vmalloc_user(len);
+	if (!ring)
+		return -ENOMEM;
+
+	ring->size = size;
+
+	error = remap_vmalloc_range(vma, ring, 0);
+	if (error)
+		goto err_free;
+
+	spin_lock_irq(&client->buffer_lock);
+	if (client->ring) {
+		spin_unlock_irq(&client->buffer_lock);
+		error = -EBUSY;
+		goto err_free;
+	}
+	client->ring_head = 0;
+	client->ring_size = size;
+	client->ring = ring;
+	spin_unlock_irq(&client->buffer_lock);
+
+	return 0;
+
+err_free:
+	vfree(ring);
+	return error;
+}
+
 #ifdef CONFIG_COMPAT
 
 #define BITS_PER_LONG_COMPAT (sizeof(compat_long_t) * 8)
@@ -1101,6 +1199,7 @@ static const struct file_operations evdev_fops = {
 	.read		= evdev_read,
 	.write		= evdev_write,
 	.poll		= evdev_poll,
+	.mmap		= evdev_mmap,
 	.open		= evdev_open,
 	.release	= evdev_release,
 	.unlocked_ioctl	= evdev_ioctl,
@@ -397,6 +397,11 @@ static void input_handle_event(struct input_dev *dev,
 		if (dev->num_vals >= 2)
 			input_pass_values(dev, dev->vals, dev->num_vals);
 		dev->num_vals = 0;
+		/*
+		 * A driver supplied capture time only applies to the frame
+		 * it was set for; don't let it leak into the next one.
+		 */
+		dev->timestamp = ktime_set(0, 0);
 	} else if (dev->num_vals >= dev->max_vals - 2) {
 		dev->vals[dev->num_vals++] = input_value_sync;
 		input_pass_values(dev, dev->vals, dev->num_vals);
@@ -436,6 +441,39 @@ void input_event(struct input_dev *dev,
 }
 EXPORT_SYMBOL(input_event);
 
+/**
+ * input_set_timestamp() - set timestamp for input events
+ * @dev: input device to set timestamp for
+ * @timestamp: the CLOCK_MONOTONIC time at which the event was captured
+ *
+ * Drivers whose events are read out by a threaded interrupt handler should
+ * record ktime_get() in their primary (hard) handler and pass it here
+ * before reporting, so that the time reported to userspace reflects when
+ * the hardware raised the interrupt rather than when the bus transfer
+ * finished. The timestamp is cleared after the next SYN_REPORT.
+ */
+void input_set_timestamp(struct input_dev *dev, ktime_t timestamp)
+{
+	dev->timestamp = timestamp;
+}
+EXPORT_SYMBOL(input_set_timestamp);
+
+/**
+ * input_get_timestamp() - get timestamp for input events
+ * @dev: input device to get timestamp from
+ *
+ * Returns the driver supplied timestamp of the current frame, or the
+ * current CLOCK_MONOTONIC time if the driver did not set one.
+ */
+ktime_t input_get_timestamp(struct input_dev *dev)
+{
+	if (!ktime_to_ns(dev->timestamp))
+		return ktime_get();
+
+	return dev->timestamp;
+}
+EXPORT_SYMBOL(input_get_timestamp);
+
 /**
  * input_inject_event() - send input event from input handler
  * @handle: input handle to send event through
@@ -840,6 +840,17 @@ static void ft5x06_update_fw_ver(struct ft5x06_ts_data *data)
 		data->fw_ver[0], data->fw_ver[1], data->fw_ver[2]);
 }
 
+static irqreturn_t ft5x06_ts_hardirq(int irq, void *dev_id)
+{
+	struct ft5x06_ts_data *data = dev_id;
+
+	/* Stamp the report with the time the controller raised the line */
+	if (data && data->input_dev)
+		input_set_timestamp(data->input_dev, ktime_get());
+
+	return IRQ_WAKE_THREAD;
+}
+
 static irqreturn_t ft5x06_ts_interrupt(int irq, void *dev_id)
 {
 	struct ft5x06_ts_data *data = dev_id;
@@ -2409,7 +2420,7 @@ static int ft5x06_ts_probe(struct i2c_client *client,
 
 	data->family_id = pdata->family_id;
 
-	err = request_threaded_irq(client->irq, NULL,
+	err = request_threaded_irq(client->irq, ft5x06_ts_hardirq,
 				ft5x06_ts_interrupt,
 	/*
 	* the interrupt trigger mode will be set in Device Tree with property
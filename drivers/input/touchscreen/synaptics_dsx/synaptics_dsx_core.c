@@ -1421,6 +1421,23 @@ static void synaptics_rmi4_sensor_report(struct synaptics_rmi4_data *rmi4_data)
 	return;
 }
 
+ /**
+ * synaptics_rmi4_hardirq()
+ *
+ * Primary handler for the attention irq. Records the time the sensor
+ * asserted attention so that the reported frame carries it, then wakes
+ * the ISR thread.
+ */
+static irqreturn_t synaptics_rmi4_hardirq(int irq, void *data)
+{
+	struct synaptics_rmi4_data *rmi4_data = data;
+
+	if (rmi4_data->input_dev)
+		input_set_timestamp(rmi4_data->input_dev, ktime_get());
+
+	return IRQ_WAKE_THREAD;
+}
+
  /**
  * synaptics_rmi4_irq()
  *
@@ -1473,8 +1490,10 @@ static int synaptics_rmi4_irq_enable(struct synaptics_rmi4_data *rmi4_data,
 		if (retval < 0)
 			return retval;
 
-		retval = request_threaded_irq(rmi4_data->irq, NULL,
-				synaptics_rmi4_irq, bdata->irq_flags,
+		retval = request_threaded_irq(rmi4_data->irq,
+				synaptics_rmi4_hardirq,
+				synaptics_rmi4_irq,
+				bdata->irq_flags | IRQF_ONESHOT,
 				PLATFORM_DRIVER_NAME, rmi4_data);
 		if (retval < 0) {
 			dev_err(rmi4_data->pdev->dev.parent,
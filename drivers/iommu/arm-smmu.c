@@ -2302,6 +2302,35 @@ unlock:
 }
 
 
+/*
+ * Describe the page table pages queued on @head as one sg_table, so that
+ * hyp_assign_table() can hand them to the hypervisor in a few coalesced
+ * calls instead of one hyp_assign_phys() call per page.
+ */
+static int arm_smmu_pte_info_to_sgt(struct list_head *head,
+				    struct sg_table *sgt)
+{
+	struct arm_smmu_pte_info *pte_info;
+	struct scatterlist *sg;
+	unsigned int nents = 0;
+	int ret;
+
+	list_for_each_entry(pte_info, head, entry)
+		nents++;
+
+	ret = sg_alloc_table(sgt, nents, GFP_KERNEL);
+	if (ret)
+		return ret;
+
+	sg = sgt->sgl;
+	list_for_each_entry(pte_info, head, entry) {
+		sg_set_page(sg, virt_to_page(pte_info->virt_addr),
+			    PAGE_SIZE, 0);
+		sg = sg_next(sg);
+	}
+	return 0;
+}
+
 static int arm_smmu_assign_table(struct arm_smmu_domain *smmu_domain)
 {
 	int ret = 0;
@@ -2309,17 +2338,21 @@ static int arm_smmu_assign_table(struct arm_smmu_domain *smmu_domain)
 	int dest_perms[2] = {PERM_READ | PERM_WRITE, PERM_READ};
 	int source_vmid = VMID_HLOS;
 	struct arm_smmu_pte_info *pte_info, *temp;
+	struct sg_table sgt;
 
 	if (!arm_smmu_is_master_side_secure(smmu_domain))
 		return ret;
 
-	list_for_each_entry(pte_info, &smmu_domain->pte_info_list, entry) {
-		ret = hyp_assign_phys(virt_to_phys(pte_info->virt_addr),
-					PAGE_SIZE, &source_vmid, 1,
-					dest_vmids, dest_perms, 2);
-		if (WARN_ON(ret))
-			break;
+	if (list_empty(&smmu_domain->pte_info_list))
+		return ret;
+
+	ret = arm_smmu_pte_info_to_sgt(&smmu_domain->pte_info_list, &sgt);
+	if (!ret) {
+		ret = hyp_assign_table(&sgt, &source_vmid, 1,
+				       dest_vmids, dest_perms, 2);
+		sg_free_table(&sgt);
 	}
+	WARN_ON(ret);
 
 	list_for_each_entry_safe(pte_info, temp, &smmu_domain->pte_info_list,
 							entry) {
@@ -2336,22 +2369,27 @@ static void arm_smmu_unassign_table(struct arm_smmu_domain *smmu_domain)
 	int dest_perms = PERM_READ | PERM_WRITE | PERM_EXEC;
 	int source_vmlist[2] = {VMID_HLOS, smmu_domain->secure_vmid};
 	struct arm_smmu_pte_info *pte_info, *temp;
+	struct sg_table sgt;
 
 	if (!arm_smmu_is_master_side_secure(smmu_domain))
 		return;
 
-	list_for_each_entry(pte_info, &smmu_domain->unassign_list, entry) {
-		ret = hyp_assign_phys(virt_to_phys(pte_info->virt_addr),
-				PAGE_SIZE, source_vmlist, 2,
-				&dest_vmids, &dest_perms, 1);
-		if (WARN_ON(ret))
-			break;
+	if (list_empty(&smmu_domain->unassign_list))
+		return;
 
-		free_pages_exact(pte_info->virt_addr, pte_info->size);
+	ret = arm_smmu_pte_info_to_sgt(&smmu_domain->unassign_list, &sgt);
+	if (!ret) {
+		ret = hyp_assign_table(&sgt, source_vmlist, 2,
+				       &dest_vmids, &dest_perms, 1);
+		sg_free_table(&sgt);
 	}
+	WARN_ON(ret);
 
+	/* pages still owned by the secure VM must not be reused */
 	list_for_each_entry_safe(pte_info, temp, &smmu_domain->unassign_list,
 							entry) {
+		if (!ret)
+			free_pages_exact(pte_info->virt_addr, pte_info->size);
 		list_del(&pte_info->entry);
 		kfree(pte_info);
 	}
@@ -14,6 +14,7 @@
 #include <linux/dma-mapping.h>
 #include <linux/dma-mapping-fast.h>
 #include <linux/io-pgtable-fast.h>
+#include <linux/percpu.h>
 #include <asm/cacheflush.h>
 #include <asm/dma-iommu.h>
 
@@ -24,6 +25,42 @@
 #define FAST_PAGE_MASK (~(PAGE_SIZE - 1))
 #define FAST_PTE_ADDR_MASK		((av8l_fast_iopte)0xfffffffff000)
 
+/*
+ * Only use the per-cpu IOVA caches when the IOVAs they can hold stay
+ * below 1/16th of the address space.
+ */
+#define FAST_IOVA_CACHE_MIN_PAGES \
+	(16 * 2 * FAST_IOVA_MAG_SIZE * num_possible_cpus())
+
+/*
+ * Invalidate the whole TLB. Every IOVA unmapped before this point may be
+ * re-used without another invalidation. The generation is only bumped
+ * once the invalidation has completed, so lockless readers never see a
+ * new generation while stale TLB entries may still be live. Must be
+ * called with mapping->lock held.
+ */
+static void __fast_smmu_tlbiall(struct dma_fast_smmu_mapping *mapping,
+				bool skip_sync)
+{
+	iommu_tlbiall(mapping->domain);
+	mapping->have_stale_tlbs = false;
+	av8l_fast_clear_stale_ptes(mapping->pgtbl_pmds, skip_sync);
+	smp_mb();
+	mapping->tlb_gen++;
+}
+
+/*
+ * An IOVA unmapped before @gen was sampled may have raced with a TLBIALL
+ * that was already in flight and completes as generation @gen + 1. Only
+ * the invalidation after that one is guaranteed to have started after the
+ * unmap, so the IOVA is clean once the generation has moved two past @gen.
+ */
+static bool fast_iova_gen_clean(struct dma_fast_smmu_mapping *mapping,
+				unsigned int gen)
+{
+	return (int)(ACCESS_ONCE(mapping->tlb_gen) - gen) >= 2;
+}
+
 /*
  * Checks if the allocated range (ending at @end) covered the upcoming
  * stale bit.  We don't need to know exactly where the range starts since
@@ -116,9 +153,7 @@ static dma_addr_t __fast_smmu_alloc_iova(struct dma_fast_smmu_mapping *mapping,
 				bit + nbits - 1)) {
 		bool skip_sync = dma_get_attr(DMA_ATTR_SKIP_CPU_SYNC, attrs);
 
-		iommu_tlbiall(mapping->domain);
-		mapping->have_stale_tlbs = false;
-		av8l_fast_clear_stale_ptes(mapping->pgtbl_pmds, skip_sync);
+		__fast_smmu_tlbiall(mapping, skip_sync);
 	}
 
 	return (bit << FAST_PAGE_SHIFT) + mapping->base;
@@ -230,6 +265,112 @@ static void __fast_smmu_free_iova(struct dma_fast_smmu_mapping *mapping,
 	mapping->have_stale_tlbs = true;
 }
 
+/*
+ * Single page IOVAs (the common case for network and other high rate
+ * clients) are recycled through small per-cpu magazines so most map and
+ * unmap calls never touch the bitmap or mapping->lock. IOVAs sitting in
+ * a magazine stay allocated in the bitmap. Freed IOVAs go to the dirty
+ * magazine; once the TLB has been invalidated after they were freed
+ * (either by the bitmap allocator wrapping or by a full dirty magazine
+ * with nothing left to hand out) the dirty magazine becomes the clean
+ * one, so a single TLBIALL covers a whole magazine of unmaps.
+ *
+ * All of these are called with interrupts disabled.
+ */
+static void __fast_iova_mag_swap(struct fast_iova_cache *cache)
+{
+	struct fast_iova_mag *mag = cache->clean;
+
+	cache->clean = cache->dirty;
+	cache->dirty = mag;
+}
+
+static void __fast_iova_mag_spill(struct dma_fast_smmu_mapping *mapping,
+				  struct fast_iova_mag *mag)
+{
+	spin_lock(&mapping->lock);
+	while (mag->nr)
+		__fast_smmu_free_iova(mapping, mag->iova[--mag->nr],
+				      FAST_PAGE_SIZE);
+	spin_unlock(&mapping->lock);
+}
+
+static dma_addr_t fast_iova_cache_get(struct dma_fast_smmu_mapping *mapping)
+{
+	struct fast_iova_cache *cache = this_cpu_ptr(mapping->iova_cache);
+
+	if (!cache->clean->nr && cache->dirty->nr &&
+	    fast_iova_gen_clean(mapping, cache->dirty->gen)) {
+		/* don't let IOVA reads pass the generation check */
+		smp_rmb();
+		__fast_iova_mag_swap(cache);
+	}
+
+	if (!cache->clean->nr)
+		return DMA_ERROR_CODE;
+
+	return cache->clean->iova[--cache->clean->nr];
+}
+
+/* @iova must already be unmapped */
+static void fast_iova_cache_put(struct dma_fast_smmu_mapping *mapping,
+				dma_addr_t iova, bool skip_sync)
+{
+	struct fast_iova_cache *cache = this_cpu_ptr(mapping->iova_cache);
+	unsigned int gen;
+
+	/* order the PTE clear against reading the TLB generation */
+	smp_mb();
+	gen = ACCESS_ONCE(mapping->tlb_gen);
+
+	if (cache->dirty->nr &&
+	    fast_iova_gen_clean(mapping, cache->dirty->gen)) {
+		/* already invalidated, no need to keep them apart */
+		if (!cache->clean->nr)
+			__fast_iova_mag_swap(cache);
+		else
+			__fast_iova_mag_spill(mapping, cache->dirty);
+	}
+
+	if (cache->dirty->nr == FAST_IOVA_MAG_SIZE) {
+		if (!cache->clean->nr) {
+			spin_lock(&mapping->lock);
+			/* every IOVA in the full magazine predates this */
+			__fast_smmu_tlbiall(mapping, skip_sync);
+			spin_unlock(&mapping->lock);
+			__fast_iova_mag_swap(cache);
+		} else {
+			__fast_iova_mag_spill(mapping, cache->dirty);
+		}
+	}
+
+	/* the magazine is only as clean as its most recently freed IOVA */
+	cache->dirty->gen = gen;
+	cache->dirty->iova[cache->dirty->nr++] = iova;
+}
+
+static int fast_iova_cache_init(struct dma_fast_smmu_mapping *mapping)
+{
+	int cpu;
+
+	if (mapping->num_4k_pages < FAST_IOVA_CACHE_MIN_PAGES)
+		return 0;
+
+	mapping->iova_cache = alloc_percpu(struct fast_iova_cache);
+	if (!mapping->iova_cache)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu) {
+		struct fast_iova_cache *cache =
+			per_cpu_ptr(mapping->iova_cache, cpu);
+
+		cache->clean = &cache->mags[0];
+		cache->dirty = &cache->mags[1];
+	}
+
+	return 0;
+}
+
 
 static void __fast_dma_page_cpu_to_dev(struct page *page, unsigned long off,
 				       size_t size, enum dma_data_direction dir)
@@ -288,6 +429,26 @@ static dma_addr_t fast_smmu_map_page(struct device *dev, struct page *page,
 		__fast_dma_page_cpu_to_dev(phys_to_page(phys_to_map),
 					   offset_from_phys_to_map, size, dir);
 
+	if (nptes == 1 && mapping->iova_cache) {
+		local_irq_save(flags);
+		iova = fast_iova_cache_get(mapping);
+		local_irq_restore(flags);
+
+		if (iova != DMA_ERROR_CODE) {
+			pmd = iopte_pmd_offset(mapping->pgtbl_pmds, iova);
+			if (likely(!av8l_fast_map_public(pmd, phys_to_map,
+							 len, prot))) {
+				if (!skip_sync)
+					dmac_clean_range(pmd, pmd + nptes);
+				return iova + offset_from_phys_to_map;
+			}
+			spin_lock_irqsave(&mapping->lock, flags);
+			__fast_smmu_free_iova(mapping, iova, len);
+			spin_unlock_irqrestore(&mapping->lock, flags);
+			return DMA_ERROR_CODE;
+		}
+	}
+
 	spin_lock_irqsave(&mapping->lock, flags);
 
 	iova = __fast_smmu_alloc_iova(mapping, attrs, len);
@@ -329,6 +490,16 @@ static void fast_smmu_unmap_page(struct device *dev, dma_addr_t iova,
 	if (!skip_sync)
 		__fast_dma_page_dev_to_cpu(page, offset, size, dir);
 
+	if (nptes == 1 && mapping->iova_cache) {
+		av8l_fast_unmap_public(pmd, len);
+		if (!skip_sync)
+			dmac_clean_range(pmd, pmd + nptes);
+		local_irq_save(flags);
+		fast_iova_cache_put(mapping, iova & FAST_PAGE_MASK, skip_sync);
+		local_irq_restore(flags);
+		return;
+	}
+
 	spin_lock_irqsave(&mapping->lock, flags);
 	av8l_fast_unmap_public(pmd, len);
 	if (!skip_sync)		/* TODO: should ask SMMU if coherent */
@@ -608,7 +779,12 @@ static struct dma_fast_smmu_mapping *__fast_smmu_create_mapping_sized(
 
 	spin_lock_init(&fast->lock);
 
+	if (fast_iova_cache_init(fast))
+		goto err3;
+
 	return fast;
+err3:
+	kfree(fast->bitmap);
 err2:
 	kfree(fast);
 err:
@@ -686,6 +862,7 @@ void fast_smmu_detach_device(struct device *dev,
 	dev->archdata.mapping = NULL;
 	set_dma_ops(dev, NULL);
 
+	free_percpu(mapping->fast->iova_cache);
 	kfree(mapping->fast->bitmap);
 	kfree(mapping->fast);
 }
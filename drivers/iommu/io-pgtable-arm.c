@@ -273,19 +273,21 @@ static void iopte_tblcnt_add(arm_lpae_iopte *table_ptep, int cnt)
 
 static bool suppress_map_failures;
 
-static int arm_lpae_init_pte(struct arm_lpae_io_pgtable *data,
-			     unsigned long iova, phys_addr_t paddr,
-			     arm_lpae_iopte prot, int lvl,
-			     arm_lpae_iopte *ptep, arm_lpae_iopte *prev_ptep,
-			     bool flush)
+/*
+ * Install @num consecutive leaf entries at @lvl starting at @ptep, mapping
+ * a physically contiguous range starting at @paddr. The attributes are
+ * computed once and the table entry count is updated once for the whole
+ * run, and if requested the new entries are flushed in one go.
+ */
+static int arm_lpae_init_ptes(struct arm_lpae_io_pgtable *data,
+			      phys_addr_t paddr, arm_lpae_iopte prot, int lvl,
+			      arm_lpae_iopte *ptep, arm_lpae_iopte *prev_ptep,
+			      int num, bool flush)
 {
 	arm_lpae_iopte pte = prot;
-
-	/* We require an unmap first */
-	if (*ptep & ARM_LPAE_PTE_VALID) {
-		BUG_ON(!suppress_map_failures);
-		return -EEXIST;
-	}
+	u64 pfn = paddr >> data->pg_shift;
+	u64 pfn_step = ARM_LPAE_BLOCK_SIZE(lvl, data) >> data->pg_shift;
+	int i, ret = 0;
 
 	if (data->iop.cfg.quirks & IO_PGTABLE_QUIRK_ARM_NS)
 		pte |= ARM_LPAE_PTE_NS;
@@ -296,19 +298,36 @@ static int arm_lpae_init_pte(struct arm_lpae_io_pgtable *data,
 		pte |= ARM_LPAE_PTE_TYPE_BLOCK;
 
 	pte |= ARM_LPAE_PTE_AF | ARM_LPAE_PTE_SH_IS;
-	pte |= pfn_to_iopte(paddr >> data->pg_shift, data);
 
-	*ptep = pte;
+	for (i = 0; i < num; i++, pfn += pfn_step) {
+		/* We require an unmap first */
+		if (ptep[i] & ARM_LPAE_PTE_VALID) {
+			BUG_ON(!suppress_map_failures);
+			ret = -EEXIST;
+			break;
+		}
 
-	if (flush)
-		data->iop.cfg.tlb->flush_pgtable(ptep, sizeof(*ptep),
+		ptep[i] = pte | pfn_to_iopte(pfn, data);
+	}
+
+	if (flush && i)
+		data->iop.cfg.tlb->flush_pgtable(ptep, i * sizeof(*ptep),
 						 data->iop.cookie);
 
+	if (prev_ptep && i)
+		iopte_tblcnt_add(prev_ptep, i);
 
-	if (prev_ptep)
-		iopte_tblcnt_add(prev_ptep, 1);
+	return ret;
+}
 
-	return 0;
+static int arm_lpae_init_pte(struct arm_lpae_io_pgtable *data,
+			     unsigned long iova, phys_addr_t paddr,
+			     arm_lpae_iopte prot, int lvl,
+			     arm_lpae_iopte *ptep, arm_lpae_iopte *prev_ptep,
+			     bool flush)
+{
+	return arm_lpae_init_ptes(data, paddr, prot, lvl, ptep, prev_ptep,
+				  1, flush);
 }
 
 struct map_state {
@@ -504,14 +523,25 @@ static int arm_lpae_map_sg(struct io_pgtable_ops *ops, unsigned long iova,
 			size_t pgsize = iommu_pgsize(
 				data->iop.cfg.pgsize_bitmap, iova | phys, size);
 
-			if (ms.pgtable && (iova < ms.iova_end)) {
+			if (ms.pgtable && (iova < ms.iova_end) &&
+			    pgsize == ms.pgsize) {
+				/*
+				 * Fill the rest of this segment that falls in
+				 * the current table in one pass.
+				 */
 				arm_lpae_iopte *ptep = ms.pgtable +
 					ARM_LPAE_LVL_IDX(iova, MAP_STATE_LVL,
 							 data);
-				arm_lpae_init_pte(
-					data, iova, phys, prot, MAP_STATE_LVL,
-					ptep, ms.prev_pgtable, false);
-				ms.num_pte++;
+				int num = min_t(size_t, size,
+						ms.iova_end - iova) / pgsize;
+
+				ret = arm_lpae_init_ptes(
+					data, phys, prot, MAP_STATE_LVL,
+					ptep, ms.prev_pgtable, num, false);
+				if (ret)
+					goto out_err;
+				ms.num_pte += num;
+				pgsize *= num;
 			} else {
 				ret = __arm_lpae_map(data, iova, phys, pgsize,
 						prot, lvl, ptep, NULL, &ms);
@@ -534,6 +564,10 @@ static int arm_lpae_map_sg(struct io_pgtable_ops *ops, unsigned long iova,
 	return mapped;
 
 out_err:
+	if (ms.pgtable)
+		data->iop.cfg.tlb->flush_pgtable(
+			ms.pte_start, ms.num_pte * sizeof(*ms.pte_start),
+			data->iop.cookie);
 	/* Return the size of the partial mapping so that they can be undone */
 	*size = mapped;
 	return 0;
@@ -17,6 +17,9 @@
 #include <linux/rbtree.h>
 #include <linux/mutex.h>
 #include <linux/err.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/shrinker.h>
 
 #include <linux/msm_dma_iommu_mapping.h>
 
@@ -29,6 +32,9 @@
  * @dir - The direction for the unmap.
  * @meta - Backpointer to the meta this guy belongs to.
  * @ref - for reference counting this mapping
+ * @lru - node in msm_iommu_lru while @lazy
+ * @lazy - the mapping holds an extra reference for late unmapping
+ * @stats - statistics of the device this is mapped to
  *
  * Represents a mapping of one dma_buf buffer to a particular device
  * and address range. There may exist other mappings of this buffer in
@@ -43,6 +49,9 @@ struct msm_iommu_map {
 	enum dma_data_direction dir;
 	struct msm_iommu_meta *meta;
 	struct kref ref;
+	struct list_head lru;
+	bool lazy;
+	struct msm_iommu_dev_stats *stats;
 };
 
 struct msm_iommu_meta {
@@ -53,9 +62,112 @@ struct msm_iommu_meta {
 	void *buffer;
 };
 
+/**
+ * struct msm_iommu_dev_stats - lazy mapping statistics of one device
+ * @lnode - node in msm_iommu_dev_stats_list
+ * @name - name of the device, kept as the device may go away
+ * @dev - the device, used as key
+ * @hits - map requests served by an existing mapping
+ * @misses - map requests that created a new mapping
+ * @evictions - lazy mappings dropped by the shrinker
+ */
+struct msm_iommu_dev_stats {
+	struct list_head lnode;
+	const char *name;
+	struct device *dev;
+	atomic_long_t hits;
+	atomic_long_t misses;
+	atomic_long_t evictions;
+};
+
 static struct rb_root iommu_root;
 static DEFINE_MUTEX(msm_iommu_map_mutex);
 
+/*
+ * Lazy mappings, least recently used first. A mapping is on this list for
+ * as long as it holds its late unmap reference; lock order is meta->lock
+ * then msm_iommu_lru_mutex.
+ */
+static LIST_HEAD(msm_iommu_lru);
+static DEFINE_MUTEX(msm_iommu_lru_mutex);
+static unsigned long msm_iommu_lru_count;
+
+static LIST_HEAD(msm_iommu_dev_stats_list);
+static DEFINE_MUTEX(msm_iommu_dev_stats_mutex);
+
+static struct msm_iommu_dev_stats *msm_iommu_dev_stats_get(struct device *dev)
+{
+	struct msm_iommu_dev_stats *stats;
+
+	mutex_lock(&msm_iommu_dev_stats_mutex);
+	list_for_each_entry(stats, &msm_iommu_dev_stats_list, lnode) {
+		if (stats->dev == dev)
+			goto out;
+	}
+
+	stats = kzalloc(sizeof(*stats), GFP_KERNEL);
+	if (!stats)
+		goto out;
+
+	stats->name = kstrdup(dev_name(dev), GFP_KERNEL);
+	if (!stats->name) {
+		kfree(stats);
+		stats = NULL;
+		goto out;
+	}
+	stats->dev = dev;
+	list_add_tail(&stats->lnode, &msm_iommu_dev_stats_list);
+out:
+	mutex_unlock(&msm_iommu_dev_stats_mutex);
+	return stats;
+}
+
+#define msm_iommu_stat_inc(stats, counter)			\
+	do {							\
+		if (stats)					\
+			atomic_long_inc(&(stats)->counter);	\
+	} while (0)
+
+/* Called with meta->lock held */
+static void msm_iommu_lru_add(struct msm_iommu_map *map)
+{
+	map->lazy = true;
+	mutex_lock(&msm_iommu_lru_mutex);
+	list_add_tail(&map->lru, &msm_iommu_lru);
+	msm_iommu_lru_count++;
+	mutex_unlock(&msm_iommu_lru_mutex);
+}
+
+/* Called with meta->lock held */
+static void msm_iommu_lru_touch(struct msm_iommu_map *map)
+{
+	if (!map->lazy)
+		return;
+
+	mutex_lock(&msm_iommu_lru_mutex);
+	list_move_tail(&map->lru, &msm_iommu_lru);
+	mutex_unlock(&msm_iommu_lru_mutex);
+}
+
+/* Called with meta->lock and msm_iommu_lru_mutex held */
+static void __msm_iommu_lru_del(struct msm_iommu_map *map)
+{
+	map->lazy = false;
+	list_del(&map->lru);
+	msm_iommu_lru_count--;
+}
+
+/* Called with meta->lock held */
+static void msm_iommu_lru_del(struct msm_iommu_map *map)
+{
+	if (!map->lazy)
+		return;
+
+	mutex_lock(&msm_iommu_lru_mutex);
+	__msm_iommu_lru_del(map);
+	mutex_unlock(&msm_iommu_lru_mutex);
+}
+
 static void msm_iommu_meta_add(struct msm_iommu_meta *meta)
 {
 	struct rb_root *root = &iommu_root;
@@ -161,6 +273,7 @@ static inline int __msm_dma_map_sg(struct device *dev, struct scatterlist *sg,
 {
 	struct msm_iommu_map *iommu_map;
 	struct msm_iommu_meta *iommu_meta = NULL;
+	struct msm_iommu_dev_stats *stats;
 	int ret = 0;
 	bool extra_meta_ref_taken = false;
 	int late_unmap = !dma_get_attr(DMA_ATTR_NO_DELAYED_UNMAP, attrs);
@@ -186,9 +299,12 @@ static inline int __msm_dma_map_sg(struct device *dev, struct scatterlist *sg,
 
 	mutex_unlock(&msm_iommu_map_mutex);
 
+	stats = msm_iommu_dev_stats_get(dev);
+
 	mutex_lock(&iommu_meta->lock);
 	iommu_map = msm_iommu_lookup(iommu_meta, dev);
 	if (!iommu_map) {
+		msm_iommu_stat_inc(stats, misses);
 		iommu_map = kmalloc(sizeof(*iommu_map), GFP_ATOMIC);
 
 		if (!iommu_map) {
@@ -203,18 +319,26 @@ static inline int __msm_dma_map_sg(struct device *dev, struct scatterlist *sg,
 		}
 
 		kref_init(&iommu_map->ref);
-		if (late_unmap)
-			kref_get(&iommu_map->ref);
+		iommu_map->lazy = false;
 		iommu_map->meta = iommu_meta;
 		iommu_map->sgl.dma_address = sg->dma_address;
 		iommu_map->sgl.dma_length = sg->dma_length;
+		iommu_map->nents = nents;
+		iommu_map->dir = dir;
 		iommu_map->dev = dev;
+		iommu_map->stats = stats;
 		msm_iommu_add(iommu_meta, iommu_map);
+		if (late_unmap) {
+			kref_get(&iommu_map->ref);
+			msm_iommu_lru_add(iommu_map);
+		}
 
 	} else {
 		sg->dma_address = iommu_map->sgl.dma_address;
 		sg->dma_length = iommu_map->sgl.dma_length;
 
+		msm_iommu_stat_inc(stats, hits);
+		msm_iommu_lru_touch(iommu_map);
 		kref_get(&iommu_map->ref);
 		/*
 		 * Need to do cache operations here based on "dir" in the
@@ -366,8 +490,10 @@ void msm_dma_buf_freed(void *buffer)
 	mutex_lock(&meta->lock);
 
 	list_for_each_entry_safe(iommu_map, iommu_map_next, &meta->iommu_maps,
-				 lnode)
+				 lnode) {
+		msm_iommu_lru_del(iommu_map);
 		kref_put(&iommu_map->ref, msm_iommu_map_release);
+	}
 
 	if (!list_empty(&meta->iommu_maps)) {
 		WARN(1, "%s: DMA Buffer %p being destroyed with outstanding iommu mappins!\n", __func__,
@@ -383,3 +509,91 @@ out:
 
 }
 
+static unsigned long msm_iommu_lru_count_objects(struct shrinker *shrinker,
+						 struct shrink_control *sc)
+{
+	return ACCESS_ONCE(msm_iommu_lru_count);
+}
+
+/*
+ * Drop the late unmap reference of lazy mappings nobody is currently
+ * using, oldest first. The buffer's next map request simply creates the
+ * mapping again. meta->lock is only trylocked as it ranks above the LRU
+ * lock and may be held across allocations.
+ */
+static unsigned long msm_iommu_lru_scan_objects(struct shrinker *shrinker,
+						struct shrink_control *sc)
+{
+	struct msm_iommu_map *map, *next;
+	unsigned long freed = 0;
+
+	if (!mutex_trylock(&msm_iommu_lru_mutex))
+		return SHRINK_STOP;
+
+	list_for_each_entry_safe(map, next, &msm_iommu_lru, lru) {
+		struct msm_iommu_meta *meta = map->meta;
+
+		if (freed >= sc->nr_to_scan)
+			break;
+
+		if (!mutex_trylock(&meta->lock))
+			continue;
+
+		if (atomic_read(&map->ref.refcount) == 1) {
+			msm_iommu_stat_inc(map->stats, evictions);
+			__msm_iommu_lru_del(map);
+			kref_put(&map->ref, msm_iommu_map_release);
+			freed++;
+		}
+		mutex_unlock(&meta->lock);
+	}
+
+	mutex_unlock(&msm_iommu_lru_mutex);
+	return freed;
+}
+
+static struct shrinker msm_iommu_lru_shrinker = {
+	.count_objects = msm_iommu_lru_count_objects,
+	.scan_objects = msm_iommu_lru_scan_objects,
+	.seeks = DEFAULT_SEEKS,
+};
+
+static int msm_iommu_stats_show(struct seq_file *s, void *unused)
+{
+	struct msm_iommu_dev_stats *stats;
+
+	seq_printf(s, "lazy mappings: %lu\n", ACCESS_ONCE(msm_iommu_lru_count));
+	seq_printf(s, "%-32s %12s %12s %12s\n", "device", "hits", "misses",
+		   "evictions");
+
+	mutex_lock(&msm_iommu_dev_stats_mutex);
+	list_for_each_entry(stats, &msm_iommu_dev_stats_list, lnode)
+		seq_printf(s, "%-32s %12ld %12ld %12ld\n", stats->name,
+			   atomic_long_read(&stats->hits),
+			   atomic_long_read(&stats->misses),
+			   atomic_long_read(&stats->evictions));
+	mutex_unlock(&msm_iommu_dev_stats_mutex);
+
+	return 0;
+}
+
+static int msm_iommu_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, msm_iommu_stats_show, NULL);
+}
+
+static const struct file_operations msm_iommu_stats_fops = {
+	.open		= msm_iommu_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init msm_dma_iommu_mapping_init(void)
+{
+	register_shrinker(&msm_iommu_lru_shrinker);
+	debugfs_create_file("msm_dma_iommu_mapping", 0444, NULL, NULL,
+			    &msm_iommu_stats_fops);
+	return 0;
+}
+device_initcall(msm_dma_iommu_mapping_init);
@@ -1612,18 +1612,35 @@ static int crypt_ctr_cipher(struct dm_target *ti,
 	if (!cipher_api)
 		goto bad_mem;
 
-	ret = snprintf(cipher_api, CRYPTO_MAX_ALG_NAME,
-		       "%s(%s)", chainmode, cipher);
-	if (ret < 0) {
-		kfree(cipher_api);
-		goto bad_mem;
+	/*
+	 * If a driver implements ESSIV itself (e.g. the arm64 AES CE/NEON
+	 * modes), it encrypts the sector number and the data in one pass and
+	 * only needs the plain64 sector number as IV. With several keys the
+	 * ESSIV salt covers all of them, so this only applies to one key.
+	 */
+	if (ivmode && ivopts && !strcmp(ivmode, "essiv") &&
+	    cc->tfms_count == 1) {
+		ret = snprintf(cipher_api, CRYPTO_MAX_ALG_NAME,
+			       "essiv(%s(%s),%s)", chainmode, cipher, ivopts);
+		if (ret > 0 && ret < CRYPTO_MAX_ALG_NAME &&
+		    !crypt_alloc_tfms(cc, cipher_api))
+			ivmode = "plain64";
 	}
 
-	/* Allocate cipher */
-	ret = crypt_alloc_tfms(cc, cipher_api);
-	if (ret < 0) {
-		ti->error = "Error allocating crypto tfm";
-		goto bad;
+	if (!cc->tfms) {
+		ret = snprintf(cipher_api, CRYPTO_MAX_ALG_NAME,
+			       "%s(%s)", chainmode, cipher);
+		if (ret < 0) {
+			kfree(cipher_api);
+			goto bad_mem;
+		}
+
+		/* Allocate cipher */
+		ret = crypt_alloc_tfms(cc, cipher_api);
+		if (ret < 0) {
+			ti->error = "Error allocating crypto tfm";
+			goto bad;
+		}
 	}
 
 	/* Initialize IV */
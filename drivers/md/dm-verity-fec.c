@@ -202,7 +202,9 @@ static int fec_is_erasure(struct dm_verity *v, struct dm_verity_io *io,
 
 /*
  * Read data blocks that are part of the RS block and deinterleave as much as
- * fits into buffers. Check for erasure locations if @neras is non-NULL.
+ * fits into buffers. Check for erasure locations if @neras is non-NULL;
+ * erasures are a property of the data blocks, not of the byte range being
+ * deinterleaved, so callers only need to locate them on the first pass.
  */
 static int fec_read_bufs(struct dm_verity *v, struct dm_verity_io *io,
 			 u64 rsb, u64 target, unsigned block_offset,
@@ -355,8 +357,8 @@ static int fec_alloc_bufs(struct dm_verity *v, struct dm_verity_fec_io *fio)
 }
 
 /*
- * Initialize buffers and clear erasures. fec_read_bufs() assumes buffers are
- * zeroed before deinterleaving.
+ * Initialize buffers. fec_read_bufs() assumes buffers are zeroed before
+ * deinterleaving.
  */
 static void fec_init_bufs(struct dm_verity *v, struct dm_verity_fec_io *fio)
 {
@@ -364,8 +366,6 @@ static void fec_init_bufs(struct dm_verity *v, struct dm_verity_fec_io *fio)
 
 	fec_for_each_buffer(fio, n)
 		memset(fio->bufs[n], 0, v->fec->rsn << DM_VERITY_FEC_BUF_RS_BITS);
-
-	memset(fio->erasures, 0, sizeof(fio->erasures));
 }
 
 /*
@@ -384,11 +384,18 @@ static int fec_decode_rsb(struct dm_verity *v, struct dm_verity_io *io,
 	if (unlikely(r < 0))
 		return r;
 
+	memset(fio->erasures, 0, sizeof(fio->erasures));
+
 	for (pos = 0; pos < 1 << v->data_dev_block_bits; ) {
 		fec_init_bufs(v, fio);
 
+		/*
+		 * Hashing all rsn blocks to locate erasures dominates the
+		 * cost of a pass, so do it once and reuse the result when
+		 * not all RS blocks fit into the buffers at once.
+		 */
 		r = fec_read_bufs(v, io, rsb, offset, pos,
-				  use_erasures ? &neras : NULL);
+				  (use_erasures && !pos) ? &neras : NULL);
 		if (unlikely(r < 0))
 			return r;
 
@@ -12,6 +12,11 @@
  * hash device. Setting this greatly improves performance when data and hash
  * are on the same disk on different partitions on devices with poor random
  * access behavior.
+ *
+ * In the file "/sys/module/dm_verity/parameters/parallel_blocks" you can set
+ * the number of data blocks per part when verifying a large bio: a bio of at
+ * least twice that size is split into parts hashed concurrently on several
+ * CPUs. Setting it to 0 verifies every bio in one piece.
  */
 
 #include "dm-verity.h"
@@ -28,6 +33,8 @@
 
 #define DM_VERITY_DEFAULT_PREFETCH_SIZE	262144
 
+#define DM_VERITY_DEFAULT_PARALLEL_BLOCKS	32
+
 #define DM_VERITY_MAX_CORRUPTED_ERRS	100
 
 #define DM_VERITY_OPT_LOGGING		"ignore_corruption"
@@ -41,6 +48,10 @@ static unsigned dm_verity_prefetch_cluster = DM_VERITY_DEFAULT_PREFETCH_SIZE;
 
 module_param_named(prefetch_cluster, dm_verity_prefetch_cluster, uint, S_IRUGO | S_IWUSR);
 
+static unsigned dm_verity_parallel_blocks = DM_VERITY_DEFAULT_PARALLEL_BLOCKS;
+
+module_param_named(parallel_blocks, dm_verity_parallel_blocks, uint, S_IRUGO | S_IWUSR);
+
 struct dm_verity_prefetch_work {
 	struct work_struct work;
 	struct dm_verity *v;
@@ -356,7 +367,7 @@ int verity_for_bv_block(struct dm_verity *v, struct dm_verity_io *io,
 				       size_t len))
 {
 	unsigned todo = 1 << v->data_dev_block_bits;
-	struct bio *bio = dm_bio_from_per_bio_data(io, v->ti->per_bio_data_size);
+	struct bio *bio = verity_io_bio(v, io);
 
 	do {
 		int r;
@@ -403,11 +414,87 @@ static inline void verity_bv_skip_block(struct dm_verity *v,
 					struct dm_verity_io *io,
 					struct bvec_iter *iter)
 {
-	struct bio *bio = dm_bio_from_per_bio_data(io, v->ti->per_bio_data_size);
+	struct bio *bio = verity_io_bio(v, io);
 
 	bio_advance_iter(bio, iter, 1 << v->data_dev_block_bits);
 }
 
+/*
+ * Try to verify the data block at io->iter together with the one after it
+ * using the interleaved two-message hash. This needs both blocks to be
+ * contiguous in their bio_vecs and neither to be a zero block.
+ *
+ * Returns 0 and moves io->iter past both blocks if both verified, 1 if
+ * the caller should verify the first block on its own instead (including
+ * on a mismatch, so that the usual error handling and FEC apply), or a
+ * negative error.
+ */
+static int verity_verify_2x(struct dm_verity *v, struct dm_verity_io *io,
+			    sector_t block)
+{
+	struct bio *bio = verity_io_bio(v, io);
+	struct shash_desc *desc = verity_io_hash_desc(v, io);
+	unsigned block_size = 1 << v->data_dev_block_bits;
+	struct bvec_iter iter = io->iter;
+	struct bio_vec bv1, bv2;
+	u8 *data1, *data2;
+	bool is_zero;
+	int r;
+
+	if (v->validated_blocks && test_bit(block + 1, v->validated_blocks))
+		return 1;
+
+	bv1 = bio_iter_iovec(bio, iter);
+	if (bv1.bv_len < block_size)
+		return 1;
+
+	bio_advance_iter(bio, &iter, block_size);
+	bv2 = bio_iter_iovec(bio, iter);
+	if (bv2.bv_len < block_size)
+		return 1;
+
+	r = verity_hash_for_block(v, io, block + 1,
+				  verity_io_want_digest2(v, io), &is_zero);
+	if (unlikely(r < 0))
+		return r;
+
+	if (is_zero)
+		return 1;
+
+	r = verity_hash_init(v, desc);
+	if (unlikely(r < 0))
+		return r;
+
+	data1 = kmap_atomic(bv1.bv_page);
+	data2 = kmap_atomic(bv2.bv_page);
+	r = crypto_shash_finup2x(desc, data1 + bv1.bv_offset,
+				 data2 + bv2.bv_offset, block_size,
+				 verity_io_real_digest(v, io),
+				 verity_io_real_digest2(v, io));
+	kunmap_atomic(data2);
+	kunmap_atomic(data1);
+
+	if (unlikely(r < 0)) {
+		DMERR("crypto_shash_finup2x failed: %d", r);
+		return r;
+	}
+
+	if (memcmp(verity_io_real_digest(v, io), verity_io_want_digest(v, io),
+		   v->digest_size) ||
+	    memcmp(verity_io_real_digest2(v, io), verity_io_want_digest2(v, io),
+		   v->digest_size))
+		return 1;
+
+	if (v->validated_blocks) {
+		set_bit(block, v->validated_blocks);
+		set_bit(block + 1, v->validated_blocks);
+	}
+
+	bio_advance_iter(bio, &io->iter, block_size * 2);
+
+	return 0;
+}
+
 /*
  * Verify one "dm_verity_io" structure.
  */
@@ -448,6 +535,17 @@ static int verity_verify_io(struct dm_verity_io *io)
 			continue;
 		}
 
+		if (v->finup2x && b + 1 < io->n_blocks) {
+			r = verity_verify_2x(v, io, cur_block);
+			if (unlikely(r < 0))
+				return r;
+
+			if (!r) {
+				b++;
+				continue;
+			}
+		}
+
 		r = verity_hash_init(v, desc);
 		if (unlikely(r < 0))
 			return r;
@@ -494,11 +592,89 @@ static void verity_finish_io(struct dm_verity_io *io, int error)
 	bio_endio_nodec(bio, error);
 }
 
+/*
+ * Account for one finished part of an io, ending the io with the first
+ * error seen once all of its parts are done.
+ */
+static void verity_put_io(struct dm_verity_io *io, int error)
+{
+	if (unlikely(error))
+		cmpxchg(&io->parts_error, 0, error);
+
+	if (atomic_dec_and_test(&io->parts_pending))
+		verity_finish_io(io, io->parts_error);
+}
+
+static void verity_part_work(struct work_struct *w)
+{
+	struct dm_verity_io *part = container_of(w, struct dm_verity_io, work);
+	struct dm_verity_io *io = part->parent;
+	int r;
+
+	r = verity_verify_io(part);
+	verity_fec_finish_io(part);
+	kfree(part);
+
+	verity_put_io(io, r);
+}
+
+/*
+ * Hand the leading dm_verity_parallel_blocks sized chunks of a large io
+ * over to other workers, trimming the io down to the last chunk, which is
+ * left for the caller. Chunks that cannot be allocated a part stay with
+ * the caller as well, so this never fails.
+ */
+static void verity_split_io(struct dm_verity_io *io)
+{
+	struct dm_verity *v = io->v;
+	struct bio *bio = verity_io_bio(v, io);
+	unsigned chunk = ACCESS_ONCE(dm_verity_parallel_blocks);
+	unsigned nr_parts;
+
+	atomic_set(&io->parts_pending, 1);
+	io->parts_error = 0;
+
+	if (!chunk || io->n_blocks < 2 * chunk)
+		return;
+
+	nr_parts = min_t(unsigned, DIV_ROUND_UP(io->n_blocks, chunk),
+			 num_online_cpus());
+	if (nr_parts < 2)
+		return;
+
+	chunk = DIV_ROUND_UP(io->n_blocks, nr_parts);
+
+	while (--nr_parts && io->n_blocks > chunk) {
+		struct dm_verity_io *part;
+
+		part = kmalloc(v->ti->per_bio_data_size, GFP_NOIO |
+			       __GFP_NORETRY | __GFP_NOMEMALLOC | __GFP_NOWARN);
+		if (!part)
+			break;
+
+		part->v = v;
+		part->parent = io;
+		part->block = io->block;
+		part->n_blocks = chunk;
+		part->iter = io->iter;
+		verity_fec_init_io(part);
+
+		atomic_inc(&io->parts_pending);
+		INIT_WORK(&part->work, verity_part_work);
+		queue_work(v->verify_wq, &part->work);
+
+		io->block += chunk;
+		io->n_blocks -= chunk;
+		bio_advance_iter(bio, &io->iter, chunk << v->data_dev_block_bits);
+	}
+}
+
 static void verity_work(struct work_struct *w)
 {
 	struct dm_verity_io *io = container_of(w, struct dm_verity_io, work);
 
-	verity_finish_io(io, verity_verify_io(io));
+	verity_split_io(io);
+	verity_put_io(io, verity_verify_io(io));
 }
 
 static void verity_end_io(struct bio *bio, int error)
@@ -600,6 +776,7 @@ int verity_map(struct dm_target *ti, struct bio *bio)
 
 	io = dm_per_bio_data(bio, ti->per_bio_data_size);
 	io->v = v;
+	io->parent = NULL;
 	io->orig_bi_end_io = bio->bi_end_io;
 	io->orig_bi_private = bio->bi_private;
 	io->block = bio->bi_iter.bi_sector >> (v->data_dev_block_bits - SECTOR_SHIFT);
@@ -1018,6 +1195,12 @@ int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 	v->shash_descsize =
 		sizeof(struct shash_desc) + crypto_shash_descsize(v->tfm);
 
+	/*
+	 * Pairs of blocks can only share the hash state when the salt is
+	 * hashed first, i.e. not in the version 0 format.
+	 */
+	v->finup2x = v->version >= 1 && crypto_shash_has_finup2x(v->tfm);
+
 	v->root_digest = kmalloc(v->digest_size, GFP_KERNEL);
 	if (!v->root_digest) {
 		ti->error = "Cannot allocate root digest";
@@ -1118,7 +1301,7 @@ int verity_ctr(struct dm_target *ti, unsigned argc, char **argv)
 	}
 
 	ti->per_bio_data_size = sizeof(struct dm_verity_io) +
-				v->shash_descsize + v->digest_size * 2;
+				v->shash_descsize + v->digest_size * 4;
 
 	r = verity_fec_ctr(v);
 	if (r)
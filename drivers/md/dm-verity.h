@@ -57,6 +57,7 @@ struct dm_verity {
 	int hash_failed;	/* set to 1 if hash of any block failed */
 	enum verity_mode mode;	/* mode for handling verification errors */
 	unsigned corrupted_errs;/* Number of errors for corrupted blocks */
+	bool finup2x;		/* hash pairs of data blocks together */
 
 	struct workqueue_struct *verify_wq;
 
@@ -82,14 +83,26 @@ struct dm_verity_io {
 	struct work_struct work;
 
 	/*
-	 * Three variably-size fields follow this struct:
+	 * Large bios are verified in parts on several CPUs. A part points
+	 * to the io of its bio, which tracks the parts still in flight and
+	 * the first error any of them hit.
+	 */
+	struct dm_verity_io *parent;
+	atomic_t parts_pending;
+	int parts_error;
+
+	/*
+	 * Five variably-size fields follow this struct:
 	 *
 	 * u8 hash_desc[v->shash_descsize];
 	 * u8 real_digest[v->digest_size];
 	 * u8 want_digest[v->digest_size];
+	 * u8 real_digest2[v->digest_size];
+	 * u8 want_digest2[v->digest_size];
 	 *
-	 * To access them use: verity_io_hash_desc(), verity_io_real_digest()
-	 * and verity_io_want_digest().
+	 * To access them use: verity_io_hash_desc(), verity_io_real_digest(),
+	 * verity_io_want_digest() and their *_digest2() counterparts, which
+	 * hold the second block when two blocks are hashed at once.
 	 */
 };
 
@@ -111,10 +124,31 @@ static inline u8 *verity_io_want_digest(struct dm_verity *v,
 	return (u8 *)(io + 1) + v->shash_descsize + v->digest_size;
 }
 
+static inline struct bio *verity_io_bio(struct dm_verity *v,
+					struct dm_verity_io *io)
+{
+	if (io->parent)
+		io = io->parent;
+
+	return dm_bio_from_per_bio_data(io, v->ti->per_bio_data_size);
+}
+
+static inline u8 *verity_io_real_digest2(struct dm_verity *v,
+					 struct dm_verity_io *io)
+{
+	return verity_io_want_digest(v, io) + v->digest_size;
+}
+
+static inline u8 *verity_io_want_digest2(struct dm_verity *v,
+					 struct dm_verity_io *io)
+{
+	return verity_io_real_digest2(v, io) + v->digest_size;
+}
+
 static inline u8 *verity_io_digest_end(struct dm_verity *v,
 				       struct dm_verity_io *io)
 {
-	return verity_io_want_digest(v, io) + v->digest_size;
+	return verity_io_want_digest2(v, io) + v->digest_size;
 }
 
 extern int verity_for_bv_block(struct dm_verity *v, struct dm_verity_io *io,
@@ -23,6 +23,7 @@
 #include <linux/dma-mapping.h>
 #include <linux/msm_dma_iommu_mapping.h>
 #include <linux/workqueue.h>
+#include <linux/shrinker.h>
 #include "cam_smmu_api.h"
 
 #define SCRATCH_ALLOC_START SZ_128K
@@ -35,6 +36,7 @@
 #define COOKIE_MASK ((1<<COOKIE_SIZE)-1)
 #define HANDLE_INIT (-1)
 #define CAM_SMMU_CB_MAX 2
+#define CAM_SMMU_IDLE_MAX 64
 
 #define GET_SMMU_HDL(x, y) (((x) << COOKIE_SIZE) | ((y) & COOKIE_MASK))
 #define GET_SMMU_TABLE_IDX(x) (((x) >> COOKIE_SIZE) & COOKIE_MASK)
@@ -96,6 +98,8 @@ struct cam_context_bank_info {
 	uint8_t scratch_buf_support;
 	struct scratch_mapping scratch_map;
 	struct list_head smmu_buf_list;
+	struct list_head idle_list;
+	int idle_count;
 	struct mutex lock;
 	int handle;
 	enum cam_smmu_ops_param state;
@@ -113,6 +117,7 @@ struct cam_iommu_cb_set {
 	struct work_struct smmu_work;
 	struct mutex payload_list_lock;
 	struct list_head payload_list;
+	atomic_t idle_total;
 };
 
 static struct of_device_id msm_cam_smmu_dt_match[] = {
@@ -131,6 +136,7 @@ struct cam_dma_buff_info {
 	int ref_count;
 	dma_addr_t paddr;
 	struct list_head list;
+	struct list_head idle;
 	int ion_fd;
 	size_t len;
 	size_t phys_len;
@@ -474,6 +480,8 @@ void cam_smmu_reset_iommu_table(enum cam_smmu_init_dir ops)
 	for (i = 0; i < iommu_cb_set.cb_num; i++) {
 		iommu_cb_set.cb_info[i].handle = HANDLE_INIT;
 		INIT_LIST_HEAD(&iommu_cb_set.cb_info[i].smmu_buf_list);
+		INIT_LIST_HEAD(&iommu_cb_set.cb_info[i].idle_list);
+		iommu_cb_set.cb_info[i].idle_count = 0;
 		iommu_cb_set.cb_info[i].state = CAM_SMMU_DETACH;
 		iommu_cb_set.cb_info[i].dev = NULL;
 		iommu_cb_set.cb_info[i].cb_count = 0;
@@ -687,7 +695,8 @@ static struct cam_dma_buff_info *cam_smmu_find_mapping_by_ion_index(int idx,
 
 	list_for_each_entry(mapping, &iommu_cb_set.cb_info[idx].smmu_buf_list,
 			list) {
-		if (mapping->ion_fd == ion_fd) {
+		/* idle mappings hold no client reference */
+		if (mapping->ion_fd == ion_fd && mapping->ref_count) {
 			CDBG(" find ion_fd %d\n", ion_fd);
 			return mapping;
 		}
@@ -829,6 +838,7 @@ static int cam_smmu_map_buffer_and_add_to_list(int idx, int ion_fd,
 	mapping_info->len = (size_t)sg_dma_len(table->sgl);
 	mapping_info->dir = dma_dir;
 	mapping_info->ref_count = 1;
+	INIT_LIST_HEAD(&mapping_info->idle);
 
 	/* return paddr and len to client */
 	*paddr_ptr = sg_dma_address(table->sgl);
@@ -857,6 +867,17 @@ err_out:
 	return rc;
 }
 
+static void cam_smmu_idle_del(struct cam_dma_buff_info *mapping_info,
+		int idx)
+{
+	if (list_empty(&mapping_info->idle))
+		return;
+
+	list_del_init(&mapping_info->idle);
+	iommu_cb_set.cb_info[idx].idle_count--;
+	atomic_dec(&iommu_cb_set.idle_total);
+}
+
 static int cam_smmu_unmap_buf_and_remove_from_list(
 		struct cam_dma_buff_info *mapping_info,
 		int idx)
@@ -872,6 +893,8 @@ static int cam_smmu_unmap_buf_and_remove_from_list(
 		return -EINVAL;
 	}
 
+	cam_smmu_idle_del(mapping_info, idx);
+
 	/* iommu buffer clean up */
 	msm_dma_unmap_sg(iommu_cb_set.cb_info[idx].dev,
 		mapping_info->table->sgl, mapping_info->table->nents,
@@ -889,15 +912,66 @@ static int cam_smmu_unmap_buf_and_remove_from_list(
 	return 0;
 }
 
+/*
+ * Unmap up to nr idle mappings of a context bank, oldest first.
+ * Must be called with the context bank lock held.
+ */
+static unsigned long cam_smmu_evict_idle(int idx, unsigned long nr)
+{
+	struct cam_dma_buff_info *mapping_info;
+	unsigned long freed = 0;
+
+	while (freed < nr &&
+		!list_empty(&iommu_cb_set.cb_info[idx].idle_list)) {
+		mapping_info = list_first_entry(
+			&iommu_cb_set.cb_info[idx].idle_list,
+			struct cam_dma_buff_info, idle);
+		if (cam_smmu_unmap_buf_and_remove_from_list(mapping_info,
+				idx) < 0) {
+			/* never leave a broken entry on the idle list */
+			cam_smmu_idle_del(mapping_info, idx);
+			continue;
+		}
+		freed++;
+	}
+	return freed;
+}
+
+/*
+ * An idle mapping is only valid if the fd still refers to the same
+ * dma_buf; userspace may have closed it and reused the number. The
+ * cached entry pins the old dma_buf, so a pointer compare is enough.
+ */
+static bool cam_smmu_reuse_idle(int idx, struct cam_dma_buff_info *mapping,
+	enum dma_data_direction dma_dir)
+{
+	struct dma_buf *buf;
+	bool same = false;
+
+	buf = dma_buf_get(mapping->ion_fd);
+	if (!IS_ERR_OR_NULL(buf)) {
+		same = (buf == mapping->buf && mapping->dir == dma_dir);
+		dma_buf_put(buf);
+	}
+
+	cam_smmu_idle_del(mapping, idx);
+	if (!same)
+		cam_smmu_unmap_buf_and_remove_from_list(mapping, idx);
+	return same;
+}
+
 static enum cam_smmu_buf_state cam_smmu_check_fd_in_list(int idx,
-					int ion_fd, dma_addr_t *paddr_ptr,
-					size_t *len_ptr)
+					int ion_fd, enum dma_data_direction dma_dir,
+					dma_addr_t *paddr_ptr, size_t *len_ptr)
 {
 	struct cam_dma_buff_info *mapping;
 	list_for_each_entry(mapping,
 			&iommu_cb_set.cb_info[idx].smmu_buf_list,
 			list) {
 		if (mapping->ion_fd == ion_fd) {
+			if (!mapping->ref_count &&
+				!cam_smmu_reuse_idle(idx, mapping, dma_dir))
+				return CAM_SMMU_BUFF_NOT_EXIST;
 			mapping->ref_count++;
 			*paddr_ptr = mapping->paddr;
 			*len_ptr = mapping->len;
@@ -1306,7 +1380,8 @@ int cam_smmu_get_phy_addr(int handle, int ion_fd,
 		goto get_addr_end;
 	}
 
-	buf_state = cam_smmu_check_fd_in_list(idx, ion_fd, paddr_ptr, len_ptr);
+	buf_state = cam_smmu_check_fd_in_list(idx, ion_fd, dma_dir,
+			paddr_ptr, len_ptr);
 	if (buf_state == CAM_SMMU_BUFF_EXIST) {
 		CDBG("ion_fd:%d already in the list, give same addr back",
 				 ion_fd);
@@ -1364,12 +1439,20 @@ int cam_smmu_put_phy_addr(int handle, int ion_fd)
 		goto put_addr_end;
 	}
 
-	/* unmapping one buffer from device */
-	rc = cam_smmu_unmap_buf_and_remove_from_list(mapping_info, idx);
-	if (rc < 0) {
-		pr_err("Error: unmap or remove list fail\n");
-		goto put_addr_end;
-	}
+	/*
+	 * Keep the last mapping around so that a re-prepare of the same
+	 * buffer (stream reconfig, mode switch) skips attach and map. The
+	 * idle list is bounded per bank and trimmed by the shrinker.
+	 */
+	list_add_tail(&mapping_info->idle,
+		&iommu_cb_set.cb_info[idx].idle_list);
+	iommu_cb_set.cb_info[idx].idle_count++;
+	atomic_inc(&iommu_cb_set.idle_total);
+	if (iommu_cb_set.cb_info[idx].idle_count > CAM_SMMU_IDLE_MAX)
+		cam_smmu_evict_idle(idx,
+			iommu_cb_set.cb_info[idx].idle_count -
+			CAM_SMMU_IDLE_MAX);
+	rc = 0;
 
 put_addr_end:
 	mutex_unlock(&iommu_cb_set.cb_info[idx].lock);
@@ -1396,6 +1479,7 @@ int cam_smmu_destroy_handle(int handle)
 		return -EINVAL;
 	}
 
+	cam_smmu_evict_idle(idx, ULONG_MAX);
 	if (!list_empty_careful(&iommu_cb_set.cb_info[idx].smmu_buf_list)) {
 		pr_err("Client %s buffer list is not clean!\n",
 			iommu_cb_set.cb_info[idx].name);
@@ -1416,6 +1500,34 @@ int cam_smmu_get_num_of_clients(void)
 	return iommu_cb_set.cb_num;
 }
 
+static unsigned long cam_smmu_shrink_count(struct shrinker *shrinker,
+	struct shrink_control *sc)
+{
+	return atomic_read(&iommu_cb_set.idle_total);
+}
+
+static unsigned long cam_smmu_shrink_scan(struct shrinker *shrinker,
+	struct shrink_control *sc)
+{
+	unsigned long freed = 0;
+	int i;
+
+	for (i = 0; i < iommu_cb_set.cb_num && freed < sc->nr_to_scan; i++) {
+		/* do not stall reclaim behind a client map/unmap */
+		if (!mutex_trylock(&iommu_cb_set.cb_info[i].lock))
+			continue;
+		freed += cam_smmu_evict_idle(i, sc->nr_to_scan - freed);
+		mutex_unlock(&iommu_cb_set.cb_info[i].lock);
+	}
+	return freed ? freed : SHRINK_STOP;
+}
+
+static struct shrinker cam_smmu_shrinker = {
+	.count_objects = cam_smmu_shrink_count,
+	.scan_objects = cam_smmu_shrink_scan,
+	.seeks = DEFAULT_SEEKS,
+};
+
 static void cam_smmu_release_cb(struct platform_device *pdev)
 {
 	int i = 0;
@@ -1648,6 +1760,8 @@ static int cam_smmu_probe(struct platform_device *pdev)
 	INIT_WORK(&iommu_cb_set.smmu_work, cam_smmu_page_fault_work);
 	mutex_init(&iommu_cb_set.payload_list_lock);
 	INIT_LIST_HEAD(&iommu_cb_set.payload_list);
+	atomic_set(&iommu_cb_set.idle_total, 0);
+	register_shrinker(&cam_smmu_shrinker);
 
 	return rc;
 }
@@ -1655,6 +1769,8 @@ static int cam_smmu_probe(struct platform_device *pdev)
 static int cam_smmu_remove(struct platform_device *pdev)
 {
 	/* release all the context banks and memory allocated */
+	if (of_device_is_compatible(pdev->dev.of_node, "qcom,msm-cam-smmu"))
+		unregister_shrinker(&cam_smmu_shrinker);
 	cam_smmu_reset_iommu_table(CAM_SMMU_TABLE_DEINIT);
 	if (of_device_is_compatible(pdev->dev.of_node, "qcom,msm-cam-smmu"))
 		cam_smmu_release_cb(pdev);
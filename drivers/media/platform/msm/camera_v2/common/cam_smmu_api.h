@@ -82,6 +82,11 @@ int cam_smmu_get_phy_addr(int handle,
  * @param handle: Handle to identify the CAMSMMU client (VFE, CPP, FD etc.)
  * @param ion_fd: ION handle identifying the memory buffer.
  *
+ * Dropping the last reference parks the mapping on an idle list instead
+ * of unmapping it, so a later cam_smmu_get_phy_addr() on the same buffer
+ * returns the cached address. Idle mappings are released on eviction,
+ * under memory pressure or when the handle is destroyed.
+ *
  * @return Status of operation. Negative in case of error. Zero otherwise.
  */
 int cam_smmu_put_phy_addr(int handle, int ion_fd);
@@ -97,25 +97,33 @@ struct msm_isp_bufq *msm_isp_get_bufq(
 	return NULL;
 }
 
+/*
+ * Index straight into a bufq that the caller has already resolved, so
+ * paths that hold the bufq do not validate the handle a second time.
+ */
+static inline struct msm_isp_buffer *msm_isp_bufq_get_buf(
+	struct msm_isp_bufq *bufq, uint32_t buf_index)
+{
+	if (unlikely(bufq->num_bufs <= buf_index)) {
+		pr_err("%s: Invalid buf index\n", __func__);
+		return NULL;
+	}
+	return &bufq->bufs[buf_index];
+}
+
 static struct msm_isp_buffer *msm_isp_get_buf_ptr(
 	struct msm_isp_buf_mgr *buf_mgr,
 	uint32_t bufq_handle, uint32_t buf_index)
 {
 	struct msm_isp_bufq *bufq = NULL;
-	struct msm_isp_buffer *buf_info = NULL;
 
 	bufq = msm_isp_get_bufq(buf_mgr, bufq_handle);
 	if (!bufq) {
 		pr_err("%s: Invalid bufq\n", __func__);
-		return buf_info;
+		return NULL;
 	}
 
-	if (bufq->num_bufs <= buf_index) {
-		pr_err("%s: Invalid buf index\n", __func__);
-		return buf_info;
-	}
-	buf_info = &bufq->bufs[buf_index];
-	return buf_info;
+	return msm_isp_bufq_get_buf(bufq, buf_index);
 }
 
 static uint32_t msm_isp_get_buf_handle(
@@ -379,7 +387,7 @@ static int msm_isp_buf_unprepare_all(struct msm_isp_buf_mgr *buf_mgr,
 	}
 
 	for (i = 0; i < bufq->num_bufs; i++) {
-		buf_info = msm_isp_get_buf_ptr(buf_mgr, buf_handle, i);
+		buf_info = msm_isp_bufq_get_buf(bufq, i);
 		if (!buf_info) {
 			pr_err("%s: buf not found\n", __func__);
 			return rc;
@@ -452,7 +460,7 @@ static int msm_isp_buf_unprepare(struct msm_isp_buf_mgr *buf_mgr,
 		return -EINVAL;
 	}
 
-	buf_info = msm_isp_get_buf_ptr(buf_mgr, buf_handle, buf_idx);
+	buf_info = msm_isp_bufq_get_buf(bufq, buf_idx);
 	if (!buf_info) {
 		pr_err("%s: buf not found\n", __func__);
 		return -EINVAL;
@@ -473,6 +481,18 @@ static int msm_isp_buf_unprepare(struct msm_isp_buf_mgr *buf_mgr,
 }
 
 
+static struct msm_isp_buffer *msm_isp_bufq_find_queued(
+	struct msm_isp_bufq *bufq)
+{
+	struct msm_isp_buffer *buf_info;
+
+	list_for_each_entry(buf_info, &bufq->head, list) {
+		if (buf_info->state == MSM_ISP_BUFFER_STATE_QUEUED)
+			return buf_info;
+	}
+	return NULL;
+}
+
 static int msm_isp_get_buf(struct msm_isp_buf_mgr *buf_mgr, uint32_t id,
 	uint32_t bufq_handle, uint32_t buf_index,
 	struct msm_isp_buffer **buf_info)
@@ -506,23 +526,28 @@ static int msm_isp_get_buf(struct msm_isp_buf_mgr *buf_mgr, uint32_t id,
 
 	switch (BUF_SRC(bufq->stream_id)) {
 	case MSM_ISP_BUFFER_SRC_NATIVE:
-		list_for_each_entry(temp_buf_info, &bufq->head, list) {
-			if (temp_buf_info->state ==
-					MSM_ISP_BUFFER_STATE_QUEUED) {
-				list_del_init(&temp_buf_info->list);
-				if (msm_buf_check_head_sanity(bufq) < 0) {
-					spin_unlock_irqrestore(
-						&bufq->bufq_lock, flags);
-					WARN(1, "%s buf_handle 0x%x buf_idx %d\n",
-						__func__,
-						bufq->bufq_handle,
-						temp_buf_info->buf_idx);
-					return -EFAULT;
-				}
-				*buf_info = temp_buf_info;
-				break;
-			}
+		/*
+		 * Only put_buf adds to the list and it does so on the
+		 * transition to QUEUED, so the head is normally the
+		 * buffer we want. Fall back to a walk only when a stale
+		 * entry (e.g. one dequeued by userspace) sits in front.
+		 */
+		temp_buf_info = list_first_entry_or_null(&bufq->head,
+			struct msm_isp_buffer, list);
+		if (temp_buf_info && temp_buf_info->state !=
+				MSM_ISP_BUFFER_STATE_QUEUED)
+			temp_buf_info = msm_isp_bufq_find_queued(bufq);
+		if (!temp_buf_info)
+			break;
+		list_del_init(&temp_buf_info->list);
+		if (msm_buf_check_head_sanity(bufq) < 0) {
+			spin_unlock_irqrestore(&bufq->bufq_lock, flags);
+			WARN(1, "%s buf_handle 0x%x buf_idx %d\n",
+				__func__, bufq->bufq_handle,
+				temp_buf_info->buf_idx);
+			return -EFAULT;
 		}
+		*buf_info = temp_buf_info;
 		break;
 	case MSM_ISP_BUFFER_SRC_HAL:
 		if (MSM_ISP_INVALID_BUF_INDEX == buf_index)
@@ -591,7 +616,7 @@ static int msm_isp_put_buf_unsafe(struct msm_isp_buf_mgr *buf_mgr,
 		return rc;
 	}
 
-	buf_info = msm_isp_get_buf_ptr(buf_mgr, bufq_handle, buf_index);
+	buf_info = msm_isp_bufq_get_buf(bufq, buf_index);
 	if (!buf_info) {
 		pr_err("%s: buf not found\n", __func__);
 		return rc;
@@ -642,7 +667,6 @@ static int msm_isp_put_buf(struct msm_isp_buf_mgr *buf_mgr,
 	int rc = -1;
 	unsigned long flags;
 	struct msm_isp_bufq *bufq = NULL;
-	struct msm_isp_buffer *buf_info = NULL;
 
 	bufq = msm_isp_get_bufq(buf_mgr, bufq_handle);
 	if (!bufq) {
@@ -650,12 +674,6 @@ static int msm_isp_put_buf(struct msm_isp_buf_mgr *buf_mgr,
 		return rc;
 	}
 
-	buf_info = msm_isp_get_buf_ptr(buf_mgr, bufq_handle, buf_index);
-	if (!buf_info) {
-		pr_err("%s: buf not found\n", __func__);
-		return rc;
-	}
-
 	spin_lock_irqsave(&bufq->bufq_lock, flags);
 
 	rc = msm_isp_put_buf_unsafe(buf_mgr, bufq_handle, buf_index);
@@ -684,7 +702,7 @@ static int msm_isp_update_put_buf_cnt_unsafe(
 	put_buf_mask = &bufq->put_buf_mask[pingpong_bit];
 
 	if (buf_index >= 0) {
-		buf_info = msm_isp_get_buf_ptr(buf_mgr, bufq_handle, buf_index);
+		buf_info = msm_isp_bufq_get_buf(bufq, buf_index);
 		if (!buf_info) {
 			pr_err("%s: buf not found\n", __func__);
 			return -EFAULT;
@@ -773,7 +791,7 @@ static int msm_isp_buf_done(struct msm_isp_buf_mgr *buf_mgr,
 		return -EINVAL;
 	}
 
-	buf_info = msm_isp_get_buf_ptr(buf_mgr, bufq_handle, buf_index);
+	buf_info = msm_isp_bufq_get_buf(bufq, buf_index);
 	if (!buf_info) {
 		pr_err("%s: buf not found\n", __func__);
 		return -EINVAL;
@@ -829,7 +847,7 @@ static int msm_isp_flush_buf(struct msm_isp_buf_mgr *buf_mgr, uint32_t id,
 
 	spin_lock_irqsave(&bufq->bufq_lock, flags);
 	for (i = 0; i < bufq->num_bufs; i++) {
-		buf_info = msm_isp_get_buf_ptr(buf_mgr, bufq_handle, i);
+		buf_info = msm_isp_bufq_get_buf(bufq, i);
 		if (!buf_info) {
 			pr_err("%s: buf not found\n", __func__);
 			continue;
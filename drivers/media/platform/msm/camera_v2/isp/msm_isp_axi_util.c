@@ -1513,6 +1513,31 @@ void msm_isp_axi_stream_update(struct vfe_device *vfe_dev,
 		complete(&vfe_dev->stream_config_complete);
 }
 
+static bool msm_isp_axi_cfg_changed(struct msm_vfe_axi_stream *stream_info,
+	struct msm_vfe_axi_stream_cfg_update_info *update_info)
+{
+	int i;
+	struct msm_vfe_axi_plane_cfg *cur, *new;
+
+	if (stream_info->output_format != update_info->output_format)
+		return true;
+
+	for (i = 0; i < stream_info->num_planes; i++) {
+		cur = &stream_info->plane_cfg[i];
+		new = &update_info->plane_cfg[i];
+		if (cur->output_width != new->output_width ||
+			cur->output_height != new->output_height ||
+			cur->output_stride != new->output_stride ||
+			cur->output_scan_lines != new->output_scan_lines ||
+			cur->output_plane_format != new->output_plane_format ||
+			cur->plane_addr_offset != new->plane_addr_offset ||
+			cur->csid_src != new->csid_src ||
+			cur->rdi_cid != new->rdi_cid)
+			return true;
+	}
+	return false;
+}
+
 static void msm_isp_reload_ping_pong_offset(struct vfe_device *vfe_dev,
 		struct msm_vfe_axi_stream *stream_info)
 {
@@ -3743,6 +3768,16 @@ int msm_isp_update_axi_stream(struct vfe_device *vfe_dev, void *arg)
 				&update_cmd->update_info[i];
 			stream_info = &axi_data->stream_info[HANDLE_TO_IDX(
 				update_info->stream_handle)];
+			/*
+			 * Nothing to reprogram, so do not pause the write
+			 * masters and drop frames for a repeated config.
+			 */
+			if (!msm_isp_axi_cfg_changed(stream_info,
+				update_info)) {
+				ISP_DBG("%s: stream %x config unchanged\n",
+					__func__, stream_info->stream_id);
+				continue;
+			}
 			for (j = 0; j < stream_info->num_planes; j++) {
 				stream_info->plane_cfg[j] =
 					update_info->plane_cfg[j];
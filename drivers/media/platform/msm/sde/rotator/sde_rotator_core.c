@@ -1254,9 +1254,17 @@ static void sde_rotator_done_handler(struct work_struct *work)
 		entry->item.dst_rect.x, entry->item.dst_rect.y,
 		entry->item.dst_rect.w, entry->item.dst_rect.h);
 
+	/*
+	 * Signal the output fence as soon as the hardware is done, so a
+	 * display commit waiting on it as acquire fence is not held back by
+	 * the bookkeeping below, which contends with the commit handler for
+	 * the manager lock. Cancellation flushes this work before signaling
+	 * itself, so the entry cannot be signaled twice.
+	 */
+	sde_rotator_signal_output(entry);
+
 	sde_rot_mgr_lock(mgr);
 	sde_rotator_put_hw_resource(entry->commitq, entry, entry->commitq->hw);
-	sde_rotator_signal_output(entry);
 	sde_rotator_release_entry(mgr, entry);
 	atomic_dec(&request->pending_count);
 	if (request->retireq && request->retire_work)
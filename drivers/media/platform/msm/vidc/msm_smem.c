@@ -18,17 +18,29 @@
 #include <linux/iommu.h>
 #include <linux/msm_dma_iommu_mapping.h>
 #include <linux/msm_ion.h>
+#include <linux/mutex.h>
+#include <linux/shrinker.h>
 #include <linux/slab.h>
 #include <linux/types.h>
 #include "media/msm_vidc.h"
 #include "msm_vidc_debug.h"
 #include "msm_vidc_resources.h"
 
+/* Max released user buffers kept mapped per client for re-registration */
+#define SMEM_MAP_CACHE_MAX 16
+
 struct smem_client {
 	int mem_type;
 	void *clnt;
 	struct msm_vidc_platform_resources *res;
 	enum session_type session_type;
+	struct mutex cache_lock;
+	struct list_head cache;
+	u32 cache_count;
+	u32 cache_hits;
+	u32 cache_misses;
+	u32 cache_evictions;
+	struct shrinker shrinker;
 };
 
 static int get_device_address(struct smem_client *smem_client,
@@ -236,6 +248,7 @@ static int ion_user_to_kernel(struct smem_client *client, int fd, u32 offset,
 	mem->smem_priv = hndl;
 	mem->device_addr = iova;
 	mem->size = buffer_size;
+	mem->user_mapped = true;
 	if ((u32)mem->device_addr != iova) {
 		dprintk(VIDC_ERR, "iova(%pa) truncated to %#x",
 			&iova, (u32)mem->device_addr);
@@ -416,6 +429,143 @@ static void free_ion_mem(struct smem_client *client, struct msm_smem *mem)
 	}
 }
 
+/*
+ * User buffers are frequently released and registered again with the same
+ * fd (port reconfig, dynamic buffer mode, flush). Released user mappings are
+ * parked on a small per-client cache so that re-registration only needs an
+ * ion import instead of a full share/attach/map_attachment round trip.
+ */
+static struct msm_smem *smem_cache_get(struct smem_client *client, int fd,
+		enum hal_buffer buffer_type)
+{
+	struct ion_handle *hndl;
+	struct msm_smem *mem, *found = NULL;
+
+	mutex_lock(&client->cache_lock);
+	if (list_empty(&client->cache))
+		goto exit;
+
+	hndl = ion_import_dma_buf(client->clnt, fd);
+	if (IS_ERR_OR_NULL(hndl))
+		goto exit;
+
+	list_for_each_entry(mem, &client->cache, cache_list) {
+		if (mem->smem_priv == hndl && mem->buffer_type == buffer_type) {
+			list_del_init(&mem->cache_list);
+			client->cache_count--;
+			found = mem;
+			break;
+		}
+	}
+	/* The cached mapping already holds its own handle reference */
+	ion_free(client->clnt, hndl);
+exit:
+	if (found)
+		client->cache_hits++;
+	else
+		client->cache_misses++;
+	mutex_unlock(&client->cache_lock);
+
+	if (found)
+		dprintk(VIDC_DBG, "%s: reusing mapping of fd %d at %pa\n",
+			__func__, fd, &found->device_addr);
+	return found;
+}
+
+static bool smem_cache_put(struct smem_client *client, struct msm_smem *mem)
+{
+	struct msm_smem *victim = NULL;
+
+	if (!mem->user_mapped || !mem->device_addr)
+		return false;
+
+	mutex_lock(&client->cache_lock);
+	if (client->cache_count >= SMEM_MAP_CACHE_MAX) {
+		victim = list_first_entry(&client->cache, struct msm_smem,
+				cache_list);
+		list_del_init(&victim->cache_list);
+		client->cache_count--;
+		client->cache_evictions++;
+	}
+	list_add_tail(&mem->cache_list, &client->cache);
+	client->cache_count++;
+	mutex_unlock(&client->cache_lock);
+
+	if (victim) {
+		free_ion_mem(client, victim);
+		kfree(victim);
+	}
+	return true;
+}
+
+static unsigned long smem_cache_evict(struct smem_client *client,
+		unsigned long nr, bool trylock)
+{
+	struct msm_smem *mem, *temp;
+	unsigned long freed = 0;
+	LIST_HEAD(evict);
+
+	/* Reclaim may run under cache_lock from the import path */
+	if (trylock) {
+		if (!mutex_trylock(&client->cache_lock))
+			return 0;
+	} else {
+		mutex_lock(&client->cache_lock);
+	}
+	list_for_each_entry_safe(mem, temp, &client->cache, cache_list) {
+		if (freed >= nr)
+			break;
+		list_move_tail(&mem->cache_list, &evict);
+		client->cache_count--;
+		client->cache_evictions++;
+		freed++;
+	}
+	mutex_unlock(&client->cache_lock);
+
+	list_for_each_entry_safe(mem, temp, &evict, cache_list) {
+		list_del(&mem->cache_list);
+		free_ion_mem(client, mem);
+		kfree(mem);
+	}
+	return freed;
+}
+
+static unsigned long smem_cache_shrink_count(struct shrinker *shrinker,
+		struct shrink_control *sc)
+{
+	struct smem_client *client =
+		container_of(shrinker, struct smem_client, shrinker);
+
+	return client->cache_count;
+}
+
+static unsigned long smem_cache_shrink_scan(struct shrinker *shrinker,
+		struct shrink_control *sc)
+{
+	struct smem_client *client =
+		container_of(shrinker, struct smem_client, shrinker);
+
+	return smem_cache_evict(client, sc->nr_to_scan, true) ? : SHRINK_STOP;
+}
+
+void msm_smem_get_map_cache_stats(void *clt, u32 *cached, u32 *hits,
+		u32 *misses, u32 *evictions)
+{
+	struct smem_client *client = clt;
+
+	if (!client || !cached || !hits || !misses || !evictions) {
+		dprintk(VIDC_ERR, "%s - invalid params\n", __func__);
+		return;
+	}
+
+	mutex_lock(&client->cache_lock);
+	*cached = client->cache_count;
+	*hits = client->cache_hits;
+	*misses = client->cache_misses;
+	*evictions = client->cache_evictions;
+	mutex_unlock(&client->cache_lock);
+}
+
 static void *ion_new_client(void)
 {
 	struct ion_client *client = NULL;
@@ -440,6 +590,11 @@ struct msm_smem *msm_smem_user_to_kernel(void *clt, int fd, u32 offset,
 		dprintk(VIDC_ERR, "Invalid fd: %d\n", fd);
 		return NULL;
 	}
+	if (client->mem_type == SMEM_ION) {
+		mem = smem_cache_get(client, fd, buffer_type);
+		if (mem)
+			return mem;
+	}
 	mem = kzalloc(sizeof(*mem), GFP_KERNEL);
 	if (!mem) {
 		dprintk(VIDC_ERR, "Failed to allocte shared mem\n");
@@ -572,6 +727,13 @@ void *msm_smem_new_client(enum smem_type mtype,
 			client->clnt = clnt;
 			client->res = res;
 			client->session_type = stype;
+			mutex_init(&client->cache_lock);
+			INIT_LIST_HEAD(&client->cache);
+			client->shrinker.count_objects =
+				smem_cache_shrink_count;
+			client->shrinker.scan_objects = smem_cache_shrink_scan;
+			client->shrinker.seeks = DEFAULT_SEEKS;
+			register_shrinker(&client->shrinker);
 		}
 	} else {
 		dprintk(VIDC_ERR, "Failed to create new client: mtype = %d\n",
@@ -628,6 +790,8 @@ void msm_smem_free(void *clt, struct msm_smem *mem)
 	}
 	switch (client->mem_type) {
 	case SMEM_ION:
+		if (smem_cache_put(client, mem))
+			return;
 		free_ion_mem(client, mem);
 		break;
 	default:
@@ -644,6 +808,9 @@ void msm_smem_delete_client(void *clt)
 		dprintk(VIDC_ERR, "Invalid  client passed\n");
 		return;
 	}
+	unregister_shrinker(&client->shrinker);
+	smem_cache_evict(client, ULONG_MAX, false);
+	mutex_destroy(&client->cache_lock);
 	switch (client->mem_type) {
 	case SMEM_ION:
 		ion_delete_client(client);
@@ -11,6 +11,7 @@
  *
  */
 #include <linux/slab.h>
+#include <linux/sync.h>
 #include "msm_vidc_internal.h"
 #include "msm_vidc_common.h"
 #include "vidc_hfi_api.h"
@@ -4494,7 +4495,151 @@ exit:
 	return rc;
 }
 
+/*
+ * An input buffer queued with V4L2_QCOM_BUF_FLAG_INPUT_FENCE is held here
+ * until its producer (e.g. the display writeback retire fence) signals, so
+ * the client can queue a frame to the encoder as soon as it submits it to
+ * the producer instead of waiting for it in userspace.
+ */
+struct venc_fence_buf {
+	struct list_head list;
+	struct msm_vidc_inst *inst;
+	struct sync_fence *fence;
+	struct sync_fence_waiter waiter;
+	struct work_struct work;
+	bool cancelled;
+	struct v4l2_buffer b;
+	struct v4l2_plane planes[VIDEO_MAX_PLANES];
+};
+
+static int __msm_venc_qbuf(struct msm_vidc_inst *inst, struct v4l2_buffer *b);
+
+static void msm_venc_fence_buf_free(struct venc_fence_buf *fb)
+{
+	struct msm_vidc_inst *inst = fb->inst;
+
+	sync_fence_put(fb->fence);
+	kfree(fb);
+	put_inst(inst);
+}
+
+static void msm_venc_fence_work(struct work_struct *work)
+{
+	struct venc_fence_buf *fb = container_of(work,
+			struct venc_fence_buf, work);
+	struct msm_vidc_inst *inst = fb->inst;
+	bool cancelled;
+	int rc;
+
+	mutex_lock(&inst->fence_bufs.lock);
+	list_del(&fb->list);
+	cancelled = fb->cancelled;
+	mutex_unlock(&inst->fence_bufs.lock);
+
+	if (!cancelled) {
+		rc = __msm_venc_qbuf(inst, &fb->b);
+		if (rc)
+			dprintk(VIDC_ERR,
+				"Failed to queue fenced buffer %d, %d\n",
+				fb->b.index, rc);
+	}
+
+	msm_venc_fence_buf_free(fb);
+}
+
+static void msm_venc_fence_cb(struct sync_fence *fence,
+		struct sync_fence_waiter *waiter)
+{
+	struct venc_fence_buf *fb = container_of(waiter,
+			struct venc_fence_buf, waiter);
+
+	schedule_work(&fb->work);
+}
+
+static int msm_venc_qbuf_fenced(struct msm_vidc_inst *inst,
+		struct v4l2_buffer *b)
+{
+	struct venc_fence_buf *fb;
+	int rc;
+
+	if (!b->length || b->length > VIDEO_MAX_PLANES)
+		return -EINVAL;
+
+	fb = kzalloc(sizeof(*fb), GFP_KERNEL);
+	if (!fb)
+		return -ENOMEM;
+
+	fb->fence = sync_fence_fdget(b->m.planes[0].reserved[2]);
+	if (!fb->fence) {
+		dprintk(VIDC_ERR, "Invalid input fence fd %d\n",
+			b->m.planes[0].reserved[2]);
+		kfree(fb);
+		return -EINVAL;
+	}
+
+	fb->b = *b;
+	fb->b.flags &= ~V4L2_QCOM_BUF_FLAG_INPUT_FENCE;
+	memcpy(fb->planes, b->m.planes, sizeof(*b->m.planes) * b->length);
+	fb->b.m.planes = fb->planes;
+	fb->inst = inst;
+	kref_get(&inst->kref);
+	INIT_WORK(&fb->work, msm_venc_fence_work);
+	sync_fence_waiter_init(&fb->waiter, msm_venc_fence_cb);
+
+	mutex_lock(&inst->fence_bufs.lock);
+	list_add_tail(&fb->list, &inst->fence_bufs.list);
+	rc = sync_fence_wait_async(fb->fence, &fb->waiter);
+	if (rc)
+		list_del(&fb->list);
+	mutex_unlock(&inst->fence_bufs.lock);
+
+	if (rc < 0) {
+		dprintk(VIDC_ERR, "Input fence in error state %d\n", rc);
+		msm_venc_fence_buf_free(fb);
+		return rc;
+	}
+
+	/* already signaled, nothing to defer */
+	if (rc > 0) {
+		rc = __msm_venc_qbuf(inst, &fb->b);
+		msm_venc_fence_buf_free(fb);
+	}
+
+	return rc;
+}
+
+void msm_venc_cancel_fenced_bufs(struct msm_vidc_inst *inst)
+{
+	struct venc_fence_buf *fb, *tmp;
+	LIST_HEAD(cancelled);
+
+	mutex_lock(&inst->fence_bufs.lock);
+	list_for_each_entry_safe(fb, tmp, &inst->fence_bufs.list, list) {
+		/* callback already fired, the work will drop the buffer */
+		if (sync_fence_cancel_async(fb->fence, &fb->waiter)) {
+			fb->cancelled = true;
+			continue;
+		}
+		list_move_tail(&fb->list, &cancelled);
+	}
+	mutex_unlock(&inst->fence_bufs.lock);
+
+	list_for_each_entry_safe(fb, tmp, &cancelled, list) {
+		list_del(&fb->list);
+		msm_venc_fence_buf_free(fb);
+	}
+}
+
 int msm_venc_qbuf(struct msm_vidc_inst *inst, struct v4l2_buffer *b)
+{
+	if (b->type == V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE &&
+		(b->flags & V4L2_QCOM_BUF_FLAG_INPUT_FENCE))
+		return msm_venc_qbuf_fenced(inst, b);
+
+	return __msm_venc_qbuf(inst, b);
+}
+
+static int __msm_venc_qbuf(struct msm_vidc_inst *inst, struct v4l2_buffer *b)
 {
 	struct buf_queue *q = NULL;
 	int rc = 0;
@@ -4560,6 +4705,8 @@ int msm_venc_streamoff(struct msm_vidc_inst *inst, enum v4l2_buf_type i)
 		return -EINVAL;
 	}
 	dprintk(VIDC_DBG, "Calling streamoff on port: %d\n", i);
+	if (i == V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE)
+		msm_venc_cancel_fenced_bufs(inst);
 	mutex_lock(&q->lock);
 	rc = vb2_streamoff(&q->vb2_bufq, i);
 	mutex_unlock(&q->lock);
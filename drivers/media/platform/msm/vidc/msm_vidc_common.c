@@ -3858,29 +3858,11 @@ int msm_comm_qbuf(struct msm_vidc_inst *inst, struct vb2_buffer *vb)
 		}
 	}
 
-	if (!batch_mode && etbs.count) {
-		int c = 0;
-
-		for (c = 0; c < etbs.count; ++c) {
-			struct vidc_frame_data *frame_data = &etbs.data[c];
-
-			rc = call_hfi_op(hdev, session_etb, inst->session,
-					frame_data);
-			if (rc) {
-				dprintk(VIDC_ERR, "Failed to issue etb: %d\n",
-						rc);
-				goto err_bad_input;
-			}
-
-			log_frame(inst, frame_data,
-					V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE);
-		}
-	}
-
-	if (!batch_mode && ftbs.count) {
-		int c = 0;
+	if (!batch_mode && (etbs.count || ftbs.count)) {
+		int ftb_index = 0, c = 0;
 
-		for (c = 0; atomic_read(&inst->seq_hdr_reqs) > 0; ++c) {
+		for (c = 0; ftbs.count &&
+				atomic_read(&inst->seq_hdr_reqs) > 0; ++c) {
 			rc = request_seq_header(inst, &ftbs.data[c]);
 			if (rc) {
 				dprintk(VIDC_ERR,
@@ -3892,18 +3874,28 @@ int msm_comm_qbuf(struct msm_vidc_inst *inst, struct vb2_buffer *vb)
 			atomic_dec(&inst->seq_hdr_reqs);
 		}
 
-		for (; c < ftbs.count; ++c) {
-			struct vidc_frame_data *frame_data = &ftbs.data[c];
+		/*
+		 * Hand everything that was pending to the firmware with a
+		 * single doorbell rather than one interrupt per buffer.
+		 */
+		ftb_index = c;
+		rc = call_hfi_op(hdev, session_queue_buffers, inst->session,
+				etbs.count, etbs.data,
+				ftbs.count - ftb_index, &ftbs.data[ftb_index]);
+		if (rc) {
+			dprintk(VIDC_ERR,
+				"Failed to queue %d ETBs and %d FTBs: %d\n",
+				etbs.count, ftbs.count - ftb_index, rc);
+			goto err_bad_input;
+		}
 
-			rc = call_hfi_op(hdev, session_ftb,
-					inst->session, frame_data);
-			if (rc) {
-				dprintk(VIDC_ERR, "Failed to issue ftb: %d\n",
-						rc);
-				goto err_bad_input;
-			}
+		for (c = 0; c < etbs.count; ++c) {
+			log_frame(inst, &etbs.data[c],
+					V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE);
+		}
 
-			log_frame(inst, frame_data,
+		for (c = ftb_index; c < ftbs.count; ++c) {
+			log_frame(inst, &ftbs.data[c],
 					V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
 		}
 	}
@@ -41,24 +41,25 @@ static inline int msm_dcvs_get_mbs_per_frame(struct msm_vidc_inst *inst)
 	return NUM_MBS_PER_FRAME(height, width);
 }
 
-static inline int msm_dcvs_count_active_instances(struct msm_vidc_core *core)
+/*
+ * Predicted core load: instances running DCVS contribute the load their
+ * buffer occupancy currently asks for, all others their nominal load.
+ */
+static int msm_dcvs_get_total_load(struct msm_vidc_core *core)
 {
-	int active_instances = 0;
+	int load = 0;
 	struct msm_vidc_inst *inst = NULL;
 
-	if (!core) {
-		dprintk(VIDC_ERR, "%s: Invalid args: %pK\n", __func__, core);
-		return -EINVAL;
-	}
-
 	mutex_lock(&core->lock);
 	list_for_each_entry(inst, &core->instances, list) {
-		if (inst->state >= MSM_VIDC_OPEN_DONE &&
-			inst->state < MSM_VIDC_STOP_DONE)
-			active_instances++;
+		if (inst->dcvs_mode)
+			load += inst->dcvs.load;
+		else
+			load += msm_comm_get_inst_load(inst,
+					LOAD_CALC_NO_QUIRKS);
 	}
 	mutex_unlock(&core->lock);
-	return active_instances;
+	return load;
 }
 
 static bool msm_dcvs_check_codec_supported(int fourcc,
@@ -436,7 +437,8 @@ static int msm_dcvs_enc_scale_clocks(struct msm_vidc_inst *inst)
 			dcvs->prev_freq_lowered ? "Lower" : "Higher",
 			dcvs->load, total_input_buf, fw_pending_bufs);
 
-		rc = msm_comm_scale_clocks_load(core, dcvs->load,
+		rc = msm_comm_scale_clocks_load(core,
+				msm_dcvs_get_total_load(core),
 				LOAD_CALC_NO_QUIRKS);
 		if (rc) {
 			dprintk(VIDC_PROF,
@@ -516,7 +518,8 @@ static int msm_dcvs_dec_scale_clocks(struct msm_vidc_inst *inst, bool fbd)
 			dcvs->load, total_output_buf, buffers_outside_fw,
 			dcvs->threshold_disp_buf_high, dcvs->transition_turbo);
 
-		rc = msm_comm_scale_clocks_load(core, dcvs->load,
+		rc = msm_comm_scale_clocks_load(core,
+				msm_dcvs_get_total_load(core),
 				LOAD_CALC_NO_QUIRKS);
 		if (rc) {
 			dprintk(VIDC_ERR,
@@ -575,10 +578,9 @@ static bool msm_dcvs_enc_check(struct msm_vidc_inst *inst)
 
 static bool msm_dcvs_check_supported(struct msm_vidc_inst *inst)
 {
-	int num_mbs_per_frame = 0, instance_count = 0;
+	int num_mbs_per_frame = 0;
 	long int instance_load = 0;
 	long int dcvs_limit = 0;
-	struct msm_vidc_inst *temp = NULL;
 	struct msm_vidc_core *core;
 	struct hal_buffer_requirements *output_buf_req;
 	struct dcvs_stats *dcvs;
@@ -599,9 +601,8 @@ static bool msm_dcvs_check_supported(struct msm_vidc_inst *inst)
 				"%s: dcvs limit table not found\n", __func__);
 		return false;
 	}
-	instance_count = msm_dcvs_count_active_instances(core);
 
-	if (instance_count == 1 && inst->session_type == MSM_VIDC_DECODER &&
+	if (inst->session_type == MSM_VIDC_DECODER &&
 		!msm_comm_turbo_session(inst)) {
 		num_mbs_per_frame = msm_dcvs_get_mbs_per_frame(inst);
 		instance_load = msm_comm_get_inst_load(inst,
@@ -629,17 +630,14 @@ static bool msm_dcvs_check_supported(struct msm_vidc_inst *inst)
 				__func__, HAL_BUFFER_OUTPUT);
 			return false;
 		}
-	} else if (instance_count == 1 &&
-			inst->session_type == MSM_VIDC_ENCODER &&
+	} else if (inst->session_type == MSM_VIDC_ENCODER &&
 			!msm_comm_turbo_session(inst)) {
 		if (!msm_dcvs_enc_check(inst))
 			return false;
 	} else {
 		/*
-		* For multiple instance use case with 4K, clocks will be scaled
-		* as per load in streamon, but the clocks may be scaled
-		* down as DCVS is running for first playback instance
-		* Rescaling the core clock for multiple instance use case
+		* Clocks may have been scaled down by DCVS running on other
+		* instances; rescale for the nominal load of this one.
 		*/
 		if (!dcvs->is_clock_scaled) {
 			if (!msm_comm_scale_clocks(core)) {
@@ -653,17 +651,6 @@ static bool msm_dcvs_check_supported(struct msm_vidc_inst *inst)
 					__func__);
 			}
 		}
-		/*
-		* For multiple instance use case turn OFF DCVS algorithm
-		* immediately
-		*/
-		if (instance_count > 1) {
-			mutex_lock(&core->lock);
-			list_for_each_entry(temp, &core->instances, list)
-				temp->dcvs_mode = false;
-			mutex_unlock(&core->lock);
-		}
-
 		return false;
 	}
 
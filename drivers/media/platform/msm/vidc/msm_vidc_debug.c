@@ -312,6 +312,7 @@ static ssize_t inst_info_read(struct file *file, char __user *buf,
 	struct msm_vidc_inst *inst, *temp = NULL;
 	char *dbuf, *cur, *end;
 	int i, j;
+	u32 cached, hits, misses, evictions;
 	ssize_t len = 0;
 
 	if (!idata || !idata->core || !idata->inst) {
@@ -411,6 +412,12 @@ static ssize_t inst_info_read(struct file *file, char __user *buf,
 	cur += write_str(cur, end - cur, "FTB Count: %d\n", inst->count.ftb);
 	cur += write_str(cur, end - cur, "FBD Count: %d\n", inst->count.fbd);
 
+	msm_smem_get_map_cache_stats(inst->mem_client, &cached, &hits,
+			&misses, &evictions);
+	cur += write_str(cur, end - cur,
+		"Map cache: cached %u hits %u misses %u evictions %u\n",
+		cached, hits, misses, evictions);
+
 	publish_unreleased_reference(inst, &cur, end);
 	len = simple_read_from_buffer(buf, count, ppos,
 		dbuf, cur - dbuf);
@@ -264,6 +264,7 @@ struct msm_vidc_inst {
 	struct msm_vidc_list pending_getpropq;
 	struct msm_vidc_list outputbufs;
 	struct msm_vidc_list registeredbufs;
+	struct msm_vidc_list fence_bufs;
 	struct buffer_requirements buff_req;
 	void *mem_client;
 	struct v4l2_ctrl_handler ctrl_handler;
@@ -370,6 +371,8 @@ struct context_bank_info *msm_smem_get_context_bank(void *clt,
 		bool is_secure, enum hal_buffer buffer_type);
 void msm_vidc_fw_unload_handler(struct work_struct *work);
 bool msm_smem_compare_buffers(void *clt, int fd, void *priv);
+void msm_smem_get_map_cache_stats(void *clt, u32 *cached, u32 *hits,
+		u32 *misses, u32 *evictions);
 /* XXX: normally should be in msm_vidc.h, but that's meant for public APIs,
  * whereas this is private */
 int msm_vidc_destroy(struct msm_vidc_inst *inst);
@@ -1653,6 +1653,22 @@ static int __iface_cmdq_write(struct venus_hfi_device *device, void *pkt)
 	return rc;
 }
 
+static int __session_cmdq_write(struct venus_hfi_device *device, void *pkt,
+		bool *needs_interrupt)
+{
+	bool rx_req = false;
+	int rc;
+
+	if (!needs_interrupt)
+		return __iface_cmdq_write(device, pkt);
+
+	rc = __iface_cmdq_write_relaxed(device, pkt, &rx_req);
+	if (!rc && rx_req)
+		*needs_interrupt = true;
+
+	return rc;
+}
+
 static int __iface_msgq_read(struct venus_hfi_device *device, void *pkt)
 {
 	u32 tx_req_is_set = 0;
@@ -2822,8 +2838,13 @@ static int venus_hfi_session_stop(void *session)
 	return rc;
 }
 
+/*
+ * Queues an ETB. With @needs_interrupt set the packet is written without
+ * raising the doorbell and *needs_interrupt is set if the firmware asked
+ * for one, so the caller can ring once for a whole set of packets.
+ */
 static int __session_etb(struct hal_session *session,
-		struct vidc_frame_data *input_frame, bool relaxed)
+		struct vidc_frame_data *input_frame, bool *needs_interrupt)
 {
 	int rc = 0;
 	struct venus_hfi_device *device = session->device;
@@ -2839,11 +2860,8 @@ static int __session_etb(struct hal_session *session,
 			goto err_create_pkt;
 		}
 
-		if (!relaxed)
-			rc = __iface_cmdq_write(session->device, &pkt);
-		else
-			rc = __iface_cmdq_write_relaxed(session->device,
-					&pkt, NULL);
+		rc = __session_cmdq_write(session->device, &pkt,
+				needs_interrupt);
 		if (rc)
 			goto err_create_pkt;
 	} else {
@@ -2858,11 +2876,8 @@ static int __session_etb(struct hal_session *session,
 			goto err_create_pkt;
 		}
 
-		if (!relaxed)
-			rc = __iface_cmdq_write(session->device, &pkt);
-		else
-			rc = __iface_cmdq_write_relaxed(session->device,
-					&pkt, NULL);
+		rc = __session_cmdq_write(session->device, &pkt,
+				needs_interrupt);
 		if (rc)
 			goto err_create_pkt;
 	}
@@ -2885,13 +2900,13 @@ static int venus_hfi_session_etb(void *sess,
 
 	device = session->device;
 	mutex_lock(&device->lock);
-	rc = __session_etb(session, input_frame, false);
+	rc = __session_etb(session, input_frame, NULL);
 	mutex_unlock(&device->lock);
 	return rc;
 }
 
 static int __session_ftb(struct hal_session *session,
-		struct vidc_frame_data *output_frame, bool relaxed)
+		struct vidc_frame_data *output_frame, bool *needs_interrupt)
 {
 	int rc = 0;
 	struct venus_hfi_device *device = session->device;
@@ -2904,11 +2919,7 @@ static int __session_ftb(struct hal_session *session,
 		goto err_create_pkt;
 	}
 
-	if (!relaxed)
-		rc = __iface_cmdq_write(session->device, &pkt);
-	else
-		rc = __iface_cmdq_write_relaxed(session->device,
-				&pkt, NULL);
+	rc = __session_cmdq_write(session->device, &pkt, needs_interrupt);
 
 err_create_pkt:
 	return rc;
@@ -2928,7 +2939,7 @@ static int venus_hfi_session_ftb(void *sess,
 
 	device = session->device;
 	mutex_lock(&device->lock);
-	rc = __session_ftb(session, output_frame, false);
+	rc = __session_ftb(session, output_frame, NULL);
 	mutex_unlock(&device->lock);
 	return rc;
 }
@@ -2941,6 +2952,7 @@ static int venus_hfi_session_process_batch(void *sess,
 	struct hal_session *session = sess;
 	struct venus_hfi_device *device;
 	struct hfi_cmd_session_sync_process_packet pkt;
+	bool needs_interrupt = false;
 
 	if (!session || !session->device) {
 		dprintk(VIDC_ERR, "%s: Invalid Params\n", __func__);
@@ -2951,7 +2963,7 @@ static int venus_hfi_session_process_batch(void *sess,
 
 	mutex_lock(&device->lock);
 	for (c = 0; c < num_ftbs; ++c) {
-		rc = __session_ftb(session, &ftbs[c], true);
+		rc = __session_ftb(session, &ftbs[c], &needs_interrupt);
 		if (rc) {
 			dprintk(VIDC_ERR, "Failed to queue batched ftb: %d\n",
 					rc);
@@ -2960,7 +2972,7 @@ static int venus_hfi_session_process_batch(void *sess,
 	}
 
 	for (c = 0; c < num_etbs; ++c) {
-		rc = __session_etb(session, &etbs[c], true);
+		rc = __session_etb(session, &etbs[c], &needs_interrupt);
 		if (rc) {
 			dprintk(VIDC_ERR, "Failed to queue batched etb: %d\n",
 					rc);
@@ -2982,6 +2994,48 @@ err_etbs_and_ftbs:
 	return rc;
 }
 
+static int venus_hfi_session_queue_buffers(void *sess,
+		int num_etbs, struct vidc_frame_data etbs[],
+		int num_ftbs, struct vidc_frame_data ftbs[])
+{
+	int rc = 0, c = 0;
+	struct hal_session *session = sess;
+	struct venus_hfi_device *device;
+	bool needs_interrupt = false;
+
+	if (!session || !session->device) {
+		dprintk(VIDC_ERR, "%s: Invalid Params\n", __func__);
+		return -EINVAL;
+	}
+
+	device = session->device;
+
+	mutex_lock(&device->lock);
+	for (c = 0; c < num_etbs; ++c) {
+		rc = __session_etb(session, &etbs[c], &needs_interrupt);
+		if (rc) {
+			dprintk(VIDC_ERR, "Failed to queue etb: %d\n", rc);
+			goto err_etbs_and_ftbs;
+		}
+	}
+
+	for (c = 0; c < num_ftbs; ++c) {
+		rc = __session_ftb(session, &ftbs[c], &needs_interrupt);
+		if (rc) {
+			dprintk(VIDC_ERR, "Failed to queue ftb: %d\n", rc);
+			goto err_etbs_and_ftbs;
+		}
+	}
+
+err_etbs_and_ftbs:
+	/* Kick the firmware once for whatever made it into the queue */
+	if (needs_interrupt)
+		__write_register(device, VIDC_CPU_IC_SOFTINT,
+				1 << VIDC_CPU_IC_SOFTINT_H2A_SHFT);
+	mutex_unlock(&device->lock);
+	return rc;
+}
+
 static int venus_hfi_session_parse_seq_hdr(void *sess,
 					struct vidc_seq_hdr *seq_hdr)
 {
@@ -4671,6 +4725,7 @@ static void venus_init_hfi_callbacks(struct hfi_device *hdev)
 	hdev->session_etb = venus_hfi_session_etb;
 	hdev->session_ftb = venus_hfi_session_ftb;
 	hdev->session_process_batch = venus_hfi_session_process_batch;
+	hdev->session_queue_buffers = venus_hfi_session_queue_buffers;
 	hdev->session_parse_seq_hdr = venus_hfi_session_parse_seq_hdr;
 	hdev->session_get_seq_hdr = venus_hfi_session_get_seq_hdr;
 	hdev->session_get_buf_req = venus_hfi_session_get_buf_req;
@@ -132,6 +132,8 @@ enum mmc_block_test_testcases {
 	TEST_LONG_SEQUENTIAL_WRITE,
 
 	TEST_NEW_REQ_NOTIFICATION,
+
+	TEST_BENCHMARK,
 };
 
 enum mmc_block_test_group {
@@ -153,6 +155,7 @@ struct mmc_block_test_debug {
 	struct dentry *long_sequential_read_test;
 	struct dentry *long_sequential_write_test;
 	struct dentry *new_req_notification_test;
+	struct dentry *benchmark_test;
 };
 
 static struct blk_dev_test_type *mmc_bdt;
@@ -597,6 +600,8 @@ static char *get_test_case_str(int testcase)
 		return "\"long sequential write\"";
 	case TEST_NEW_REQ_NOTIFICATION:
 		return "\"new request notification test\"";
+	case TEST_BENCHMARK:
+		return "\"benchmark\"";
 	}
 
 	return "Unknown testcase";
@@ -2561,6 +2566,90 @@ const struct file_operations new_req_notification_test_ops = {
 	.read = new_req_notification_test_read,
 };
 
+static int benchmark_post_test(struct test_iosched *tios)
+{
+	test_iosched_bench_report(tios);
+	return post_test(tios);
+}
+
+static ssize_t benchmark_test_write(struct file *file,
+				const char __user *buf,
+				size_t count,
+				loff_t *ppos)
+{
+	struct mmc_block_test_data *mbtd = file->private_data;
+	struct test_iosched *tios = mbtd->test_iosched;
+	int ret = 0;
+	int i = 0;
+	int number = -1;
+
+	pr_info("%s: -- benchmark TEST --", __func__);
+
+	sscanf(buf, "%d", &number);
+
+	if (number <= 0)
+		number = 1;
+
+	mbtd->test_group = TEST_GENERAL_GROUP;
+
+	memset(&mbtd->test_info, 0, sizeof(struct test_info));
+
+	mbtd->test_info.data = mbtd;
+	mbtd->test_info.get_test_case_str_fn = get_test_case_str;
+	mbtd->test_info.run_test_fn = test_iosched_bench_run;
+	mbtd->test_info.check_test_completion_fn =
+		test_iosched_bench_check_completion;
+	mbtd->test_info.timeout_msec = TEST_BENCH_TIMEOUT_MS;
+	mbtd->test_info.post_test_fn = benchmark_post_test;
+
+	for (i = 0 ; i < number ; ++i) {
+		pr_info("%s: Cycle # %d / %d", __func__, i+1, number);
+		pr_info("%s: ====================", __func__);
+
+		mbtd->test_info.testcase = TEST_BENCHMARK;
+		ret = test_iosched_start_test(tios, &mbtd->test_info);
+		if (ret)
+			break;
+
+		/* Allow FS requests to be dispatched */
+		msleep(1000);
+	}
+
+	return count;
+}
+
+static ssize_t benchmark_test_read(struct file *file,
+			       char __user *buffer,
+			       size_t count,
+			       loff_t *offset)
+{
+	if (!access_ok(VERIFY_WRITE, buffer, count))
+		return -EFAULT;
+
+	memset((void *)buffer, 0, count);
+
+	snprintf(buffer, count,
+		 "\nbenchmark_test\n"
+		 "=========\n"
+		 "Description:\n"
+		 "This test issues the request mix configured in utils/bench "
+		 "(read/write, random/sequential and sync/async ratios, "
+		 "request size, queue depth and seed) and reports throughput, "
+		 "IOPS and p50/p99/p99.9 latency in utils/bench/results.\n");
+
+	if (message_repeat == 1) {
+		message_repeat = 0;
+		return strnlen(buffer, count);
+	} else
+		return 0;
+}
+
+const struct file_operations benchmark_test_ops = {
+	.open = test_open,
+	.write = benchmark_test_write,
+	.read = benchmark_test_read,
+};
+
 static void mmc_block_test_debugfs_cleanup(struct mmc_block_test_data *mbtd)
 {
 	debugfs_remove(mbtd->debug.random_test_seed);
@@ -2571,6 +2660,7 @@ static void mmc_block_test_debugfs_cleanup(struct mmc_block_test_data *mbtd)
 	debugfs_remove(mbtd->debug.long_sequential_read_test);
 	debugfs_remove(mbtd->debug.long_sequential_write_test);
 	debugfs_remove(mbtd->debug.new_req_notification_test);
+	debugfs_remove(mbtd->debug.benchmark_test);
 }
 
 static int mmc_block_test_debugfs_init(struct test_iosched *tios)
@@ -2667,6 +2757,16 @@ static int mmc_block_test_debugfs_init(struct test_iosched *tios)
 	if (!mbtd->debug.long_sequential_write_test)
 		goto err_nomem;
 
+	mbtd->debug.benchmark_test = debugfs_create_file(
+					"benchmark_test",
+					S_IRUGO | S_IWUGO,
+					tests_root,
+					mbtd,
+					&benchmark_test_ops);
+
+	if (!mbtd->debug.benchmark_test)
+		goto err_nomem;
+
 	return 0;
 
 err_nomem:
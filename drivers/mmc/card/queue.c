@@ -33,6 +33,13 @@
  */
 #define DEFAULT_NUM_REQS_TO_START_PACK 17
 
+/*
+ * Number of cmdq task slots that only reads may take, so a read never
+ * waits behind a queue full of background writes. Capped at a quarter
+ * of the queue depth.
+ */
+#define MMC_CMDQ_READ_RESERVED_SLOTS	4
+
 /*
  * Prepare a MMC request. This just filters out odd stuff.
  */
@@ -81,6 +88,21 @@ static bool mmc_check_blk_queue_start_tag(struct request_queue *q,
 	return !!ret;
 }
 
+static bool mmc_cmdq_slot_allowed(struct mmc_host *host,
+				  struct mmc_queue *mq, struct request *req)
+{
+	int in_flight;
+
+	if (rq_data_dir(req) == READ ||
+	    (req->cmd_flags & (REQ_FLUSH | REQ_DISCARD)))
+		return true;
+
+	in_flight = hweight_long(host->cmdq_ctx.data_active_reqs);
+
+	return in_flight < (mq->queue->queue_tags->max_depth -
+			    mq->cmdq_read_reserved);
+}
+
 static inline void mmc_cmdq_ready_wait(struct mmc_host *host,
 					struct mmc_queue *mq)
 {
@@ -100,7 +122,8 @@ static inline void mmc_cmdq_ready_wait(struct mmc_host *host,
 	 *    be any other direct command active.
 	 * 3. cmdq state should be unhalted.
 	 * 4. cmdq state shouldn't be in error state.
-	 * 5. free tag available to process the new request.
+	 * 5. free tag available to process the new request, writes
+	 *    leave the reserved read slots free.
 	 */
 	wait_event(ctx->wait, kthread_should_stop()
 		|| (mmc_peek_request(mq) &&
@@ -111,6 +134,7 @@ static inline void mmc_cmdq_ready_wait(struct mmc_host *host,
 		&& !(!host->card->part_curr && mmc_host_cq_disable(host) &&
 			!mmc_card_suspended(host->card))
 		&& !test_bit(CMDQ_STATE_ERR, &ctx->curr_state)
+		&& mmc_cmdq_slot_allowed(host, mq, mq->cmdq_req_peeked)
 		&& !mmc_check_blk_queue_start_tag(q, mq->cmdq_req_peeked)));
 }
 
@@ -660,6 +684,9 @@ int mmc_cmdq_init(struct mmc_queue *mq, struct mmc_card *card)
 		goto free_mqrq_sg;
 	}
 
+	mq->cmdq_read_reserved = min(MMC_CMDQ_READ_RESERVED_SLOTS,
+				     q_depth / 4);
+
 	blk_queue_softirq_done(mq->queue, mmc_cmdq_softirq_done);
 	INIT_WORK(&mq->cmdq_err_work, mmc_cmdq_error_work);
 	init_completion(&mq->cmdq_shutdown_complete);
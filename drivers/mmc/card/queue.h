@@ -73,6 +73,7 @@ struct mmc_queue {
 	struct completion	cmdq_pending_req_done;
 	struct completion	cmdq_shutdown_complete;
 	struct request		*cmdq_req_peeked;
+	int			cmdq_read_reserved;
 	int (*err_check_fn) (struct mmc_card *, struct mmc_async_req *);
 	void (*packed_test_fn) (struct request_queue *, struct mmc_queue_req *);
 	void (*cmdq_shutdown)(struct mmc_queue *);
@@ -96,12 +96,26 @@ int sdhci_msm_ice_get_dev(struct sdhci_host *host)
 	return 0;
 }
 
+static void sdhci_msm_ice_invalidate_slot_cfg(struct sdhci_msm_host *msm_host)
+{
+	if (msm_host->ice.slot_cfg)
+		memset(msm_host->ice.slot_cfg, 0,
+		       NUM_SDHCI_MSM_ICE_CTRL_INFO_n_REGS *
+		       sizeof(*msm_host->ice.slot_cfg));
+}
+
 int sdhci_msm_ice_init(struct sdhci_host *host)
 {
 	struct sdhci_pltfm_host *pltfm_host = sdhci_priv(host);
 	struct sdhci_msm_host *msm_host = pltfm_host->priv;
 	int err = 0;
 
+	if (!msm_host->ice.slot_cfg)
+		msm_host->ice.slot_cfg = devm_kcalloc(&msm_host->pdev->dev,
+				NUM_SDHCI_MSM_ICE_CTRL_INFO_n_REGS,
+				sizeof(*msm_host->ice.slot_cfg), GFP_KERNEL);
+	sdhci_msm_ice_invalidate_slot_cfg(msm_host);
+
 	if (msm_host->ice.vops->init) {
 		err = msm_host->ice.vops->init(msm_host->ice.pdev,
 					msm_host,
@@ -121,8 +135,14 @@ out:
 
 void sdhci_msm_ice_cfg_reset(struct sdhci_host *host, u32 slot)
 {
+	struct sdhci_pltfm_host *pltfm_host = sdhci_priv(host);
+	struct sdhci_msm_host *msm_host = pltfm_host->priv;
+
 	writel_relaxed(SDHCI_MSM_ICE_ENABLE_BYPASS,
 		host->ioaddr + CORE_VENDOR_SPEC_ICE_CTRL_INFO_3_n + 16 * slot);
+
+	if (msm_host->ice.slot_cfg && slot < NUM_SDHCI_MSM_ICE_CTRL_INFO_n_REGS)
+		msm_host->ice.slot_cfg[slot].valid = false;
 }
 
 int sdhci_msm_ice_cfg(struct sdhci_host *host, struct mmc_request *mrq,
@@ -135,6 +155,7 @@ int sdhci_msm_ice_cfg(struct sdhci_host *host, struct mmc_request *mrq,
 	sector_t lba = 0;
 	unsigned int ctrl_info_val = 0;
 	unsigned int bypass = SDHCI_MSM_ICE_ENABLE_BYPASS;
+	struct sdhci_msm_ice_slot_cfg *cfg = NULL;
 	struct request *req;
 
 	if (msm_host->ice.state != SDHCI_MSM_ICE_STATE_ACTIVE) {
@@ -193,12 +214,29 @@ int sdhci_msm_ice_cfg(struct sdhci_host *host, struct mmc_request *mrq,
 		(bypass & MASK_SDHCI_MSM_ICE_CTRL_INFO_BYPASS)
 		 << OFFSET_SDHCI_MSM_ICE_CTRL_INFO_BYPASS;
 
+	/*
+	 * The LBA changes with every request, but the key index and bypass
+	 * mode of a slot usually stay the same: skip rewriting those.
+	 */
+	if (msm_host->ice.slot_cfg && slot < NUM_SDHCI_MSM_ICE_CTRL_INFO_n_REGS)
+		cfg = &msm_host->ice.slot_cfg[slot];
+
 	writel_relaxed((lba & 0xFFFFFFFF),
 		host->ioaddr + CORE_VENDOR_SPEC_ICE_CTRL_INFO_1_n + 16 * slot);
-	writel_relaxed(((lba >> 32) & 0xFFFFFFFF),
-		host->ioaddr + CORE_VENDOR_SPEC_ICE_CTRL_INFO_2_n + 16 * slot);
-	writel_relaxed(ctrl_info_val,
-		host->ioaddr + CORE_VENDOR_SPEC_ICE_CTRL_INFO_3_n + 16 * slot);
+	if (!cfg || !cfg->valid || cfg->lba_hi != upper_32_bits(lba))
+		writel_relaxed(((lba >> 32) & 0xFFFFFFFF),
+			host->ioaddr + CORE_VENDOR_SPEC_ICE_CTRL_INFO_2_n +
+			16 * slot);
+	if (!cfg || !cfg->valid || cfg->ctrl_info != ctrl_info_val)
+		writel_relaxed(ctrl_info_val,
+			host->ioaddr + CORE_VENDOR_SPEC_ICE_CTRL_INFO_3_n +
+			16 * slot);
+
+	if (cfg) {
+		cfg->ctrl_info = ctrl_info_val;
+		cfg->lba_hi = upper_32_bits(lba);
+		cfg->valid = true;
+	}
 
 	/* Ensure ICE registers are configured before issuing SDHCI request */
 	mb();
@@ -217,6 +255,8 @@ int sdhci_msm_ice_reset(struct sdhci_host *host)
 		return -EINVAL;
 	}
 
+	sdhci_msm_ice_invalidate_slot_cfg(msm_host);
+
 	if (msm_host->ice.vops->reset) {
 		err = msm_host->ice.vops->reset(msm_host->ice.pdev);
 		if (err) {
@@ -248,6 +288,8 @@ int sdhci_msm_ice_resume(struct sdhci_host *host)
 		return -EINVAL;
 	}
 
+	sdhci_msm_ice_invalidate_slot_cfg(msm_host);
+
 	if (msm_host->ice.vops->resume) {
 		err = msm_host->ice.vops->resume(msm_host->ice.pdev);
 		if (err) {
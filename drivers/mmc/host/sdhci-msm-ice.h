@@ -32,6 +32,16 @@
  */
 #define NUM_SDHCI_MSM_ICE_CTRL_INFO_n_REGS	32
 
+/*
+ * Shadow of the CTRL_INFO registers of a slot, so that the key index,
+ * bypass and upper LBA words are only rewritten when they change.
+ */
+struct sdhci_msm_ice_slot_cfg {
+	u32 ctrl_info;
+	u32 lba_hi;
+	bool valid;
+};
+
 #define CORE_VENDOR_SPEC_ICE_CTRL		0x300
 #define CORE_VENDOR_SPEC_ICE_CTRL_INFO_1_n	0x304
 #define CORE_VENDOR_SPEC_ICE_CTRL_INFO_2_n	0x308
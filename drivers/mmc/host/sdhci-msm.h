@@ -169,6 +169,8 @@ struct sdhci_msm_ice_data {
 	struct qcom_ice_variant_ops *vops;
 	struct platform_device *pdev;
 	int state;
+	/* ICE configuration last written for each slot */
+	struct sdhci_msm_ice_slot_cfg *slot_cfg;
 };
 
 struct sdhci_msm_host {
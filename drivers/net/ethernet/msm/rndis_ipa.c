@@ -58,6 +58,9 @@
 #define MIN_TX_ERROR_SLEEP_PERIOD 500
 #define DEFAULT_AGGR_TIME_LIMIT 1
 #define DEFAULT_AGGR_PKT_LIMIT 0
+#define AGGR_TUNE_PERIOD_MSEC 1000
+#define AGGR_TUNE_LOW_PPS 200
+#define AGGR_TUNE_HIGH_PPS 1000
 
 #define IPA_RNDIS_IPC_LOG_PAGES 50
 
@@ -197,6 +200,14 @@ enum rndis_ipa_operation {
  * This callback shall be called by the Netdev once the Netdev internal
  * state is changed to RNDIS_IPA_CONNECTED_AND_UP
  * @xmit_error_delayed_work: work item for cases where IPA driver Tx fails
+ * @aggr_tune_work: periodic work sampling traffic to tune IPA->USB aggregation
+ * @aggr_tune_enable: let aggr_tune_work turn aggregation down on light traffic
+ * @aggr_byte_limit: IPA->USB aggregation byte limit chosen on connect
+ * @aggr_last_tx: tx_packets seen by the previous aggr_tune_work run
+ * @aggr_last_rx: rx_packets seen by the previous aggr_tune_work run
+ * @dl_pps: IPA->USB packets per second over the last sample period
+ * @ul_pps: USB->IPA packets per second over the last sample period
+ * @aggr_reconfigs: number of times aggr_tune_work reprogrammed the pipe
  * @state_lock: used to protect the state variable.
  */
 struct rndis_ipa_dev {
@@ -225,6 +236,14 @@ struct rndis_ipa_dev {
 	u8 device_ethaddr[ETH_ALEN];
 	void (*device_ready_notify)(void);
 	struct delayed_work xmit_error_delayed_work;
+	struct delayed_work aggr_tune_work;
+	u32 aggr_tune_enable;
+	u32 aggr_byte_limit;
+	unsigned long aggr_last_tx;
+	unsigned long aggr_last_rx;
+	u32 dl_pps;
+	u32 ul_pps;
+	u32 aggr_reconfigs;
 	spinlock_t state_lock; /* Spinlock for the state variable.*/
 };
 
@@ -255,6 +274,7 @@ static void rndis_ipa_enable_data_path(struct rndis_ipa_dev *rndis_ipa_ctx);
 static struct sk_buff *rndis_encapsulate_skb(struct sk_buff *skb);
 static void rndis_ipa_xmit_error(struct sk_buff *skb);
 static void rndis_ipa_xmit_error_aftercare_wq(struct work_struct *work);
+static void rndis_ipa_aggr_tune_wq(struct work_struct *work);
 static void rndis_ipa_prepare_header_insertion(int eth_type,
 		const char *hdr_name, struct ipa_hdr_add *add_hdr,
 		const void *dst_mac, const void *src_mac);
@@ -556,6 +576,9 @@ int rndis_ipa_init(struct ipa_usb_init_params *params)
 		rndis_ipa_xmit_error_aftercare_wq);
 	rndis_ipa_ctx->error_msec_sleep_time =
 		MIN_TX_ERROR_SLEEP_PERIOD;
+	INIT_DELAYED_WORK(&rndis_ipa_ctx->aggr_tune_work,
+		rndis_ipa_aggr_tune_wq);
+	rndis_ipa_ctx->aggr_tune_enable = false;
 	RNDIS_IPA_DEBUG("internal data structures were set\n");
 
 	if (!params->device_ready_notify)
@@ -734,6 +757,13 @@ int rndis_ipa_pipe_connect_notify(u32 usb_to_ipa_hdl,
 	}
 	RNDIS_IPA_DEBUG("end-points configured\n");
 
+	rndis_ipa_ctx->aggr_byte_limit =
+		ipa_to_usb_ep_cfg.aggr.aggr_byte_limit;
+	rndis_ipa_ctx->aggr_last_tx = rndis_ipa_ctx->net->stats.tx_packets;
+	rndis_ipa_ctx->aggr_last_rx = rndis_ipa_ctx->net->stats.rx_packets;
+	rndis_ipa_ctx->dl_pps = 0;
+	rndis_ipa_ctx->ul_pps = 0;
+
 	netif_stop_queue(rndis_ipa_ctx->net);
 	RNDIS_IPA_DEBUG("netif_stop_queue() was called\n");
 
@@ -763,6 +793,9 @@ int rndis_ipa_pipe_connect_notify(u32 usb_to_ipa_hdl,
 	else
 		RNDIS_IPA_DEBUG("queue shall be started after open()\n");
 
+	schedule_delayed_work(&rndis_ipa_ctx->aggr_tune_work,
+		msecs_to_jiffies(AGGR_TUNE_PERIOD_MSEC));
+
 	pr_info("RNDIS_IPA NetDev pipes were connected\n");
 
 	RNDIS_IPA_LOG_EXIT();
@@ -1219,6 +1252,8 @@ int rndis_ipa_pipe_disconnect_notify(void *private)
 		rndis_ipa_ctx->during_xmit_error = false;
 	}
 
+	cancel_delayed_work_sync(&rndis_ipa_ctx->aggr_tune_work);
+
 	netif_carrier_off(rndis_ipa_ctx->net);
 	RNDIS_IPA_DEBUG("carrier_off notification was sent\n");
 
@@ -1425,6 +1460,72 @@ static void rndis_ipa_xmit_error_aftercare_wq(struct work_struct *work)
 	RNDIS_IPA_LOG_EXIT();
 }
 
+/**
+ * rndis_ipa_aggr_tune_wq() - sample traffic and tune IPA->USB aggregation
+ * @work: work_struct embedded in rndis_ipa_dev.aggr_tune_work
+ *
+ * Runs every AGGR_TUNE_PERIOD_MSEC while the pipes are connected and
+ * updates the per-direction packet rates exported on debugfs.
+ * When aggr_tune_enable is set, aggregation is dropped to one packet
+ * per transfer once the rate towards the host falls under
+ * AGGR_TUNE_LOW_PPS, so that light interactive traffic does not wait
+ * for the aggregation timer, and restored to the connect time byte
+ * limit once it rises above AGGR_TUNE_HIGH_PPS.
+ * Only packets passing through this driver are counted, traffic that
+ * IPA routes to USB in hardware is not visible here.
+ */
+static void rndis_ipa_aggr_tune_wq(struct work_struct *work)
+{
+	struct rndis_ipa_dev *rndis_ipa_ctx;
+	struct ipa_ep_cfg_aggr *aggr = &ipa_to_usb_ep_cfg.aggr;
+	unsigned long tx_packets;
+	unsigned long rx_packets;
+	bool aggregating;
+	int result;
+
+	rndis_ipa_ctx = container_of(to_delayed_work(work),
+		struct rndis_ipa_dev, aggr_tune_work);
+
+	tx_packets = rndis_ipa_ctx->net->stats.tx_packets;
+	rx_packets = rndis_ipa_ctx->net->stats.rx_packets;
+	rndis_ipa_ctx->dl_pps = (tx_packets - rndis_ipa_ctx->aggr_last_tx) *
+		MSEC_PER_SEC / AGGR_TUNE_PERIOD_MSEC;
+	rndis_ipa_ctx->ul_pps = (rx_packets - rndis_ipa_ctx->aggr_last_rx) *
+		MSEC_PER_SEC / AGGR_TUNE_PERIOD_MSEC;
+	rndis_ipa_ctx->aggr_last_tx = tx_packets;
+	rndis_ipa_ctx->aggr_last_rx = rx_packets;
+
+	if (!rndis_ipa_ctx->aggr_tune_enable ||
+		rndis_ipa_ctx->aggr_byte_limit == 0)
+		goto reschedule;
+
+	aggregating = aggr->aggr_pkt_limit != 1;
+	if (aggregating && rndis_ipa_ctx->dl_pps < AGGR_TUNE_LOW_PPS) {
+		aggr->aggr_time_limit = 0;
+		aggr->aggr_pkt_limit = 1;
+	} else if (!aggregating &&
+		rndis_ipa_ctx->dl_pps > AGGR_TUNE_HIGH_PPS) {
+		aggr->aggr_byte_limit = rndis_ipa_ctx->aggr_byte_limit;
+		aggr->aggr_time_limit = DEFAULT_AGGR_TIME_LIMIT;
+		aggr->aggr_pkt_limit = DEFAULT_AGGR_PKT_LIMIT;
+	} else {
+		goto reschedule;
+	}
+
+	result = ipa_cfg_ep_aggr(rndis_ipa_ctx->ipa_to_usb_hdl, aggr);
+	if (result) {
+		RNDIS_IPA_ERROR("failed to tune aggregation (%d)\n", result);
+		goto reschedule;
+	}
+	rndis_ipa_ctx->aggr_reconfigs++;
+	RNDIS_IPA_DEBUG("aggregation %s, dl_pps=%u\n",
+		aggregating ? "off" : "on", rndis_ipa_ctx->dl_pps);
+
+reschedule:
+	schedule_delayed_work(&rndis_ipa_ctx->aggr_tune_work,
+		msecs_to_jiffies(AGGR_TUNE_PERIOD_MSEC));
+}
+
 /**
  * rndis_ipa_prepare_header_insertion() - prepare the header insertion request
  *  for IPA driver
@@ -2301,6 +2402,34 @@ static void rndis_ipa_debugfs_init(struct rndis_ipa_dev *rndis_ipa_ctx)
 		goto fail_file;
 	}
 
+	file = debugfs_create_bool("aggr_tune_enable", flags_read_write,
+			aggr_directory, &rndis_ipa_ctx->aggr_tune_enable);
+	if (!file) {
+		RNDIS_IPA_ERROR("could not create aggr_tune_enable file\n");
+		goto fail_file;
+	}
+
+	file = debugfs_create_u32("aggr_reconfigs", flags_read_only,
+			aggr_directory, &rndis_ipa_ctx->aggr_reconfigs);
+	if (!file) {
+		RNDIS_IPA_ERROR("could not create aggr_reconfigs file\n");
+		goto fail_file;
+	}
+
+	file = debugfs_create_u32("dl_pps", flags_read_only,
+			aggr_directory, &rndis_ipa_ctx->dl_pps);
+	if (!file) {
+		RNDIS_IPA_ERROR("could not create dl_pps file\n");
+		goto fail_file;
+	}
+
+	file = debugfs_create_u32("ul_pps", flags_read_only,
+			aggr_directory, &rndis_ipa_ctx->ul_pps);
+	if (!file) {
+		RNDIS_IPA_ERROR("could not create ul_pps file\n");
+		goto fail_file;
+	}
+
 	file = debugfs_create_bool("tx_dump_enable", flags_read_write,
 			rndis_ipa_ctx->directory,
 			&rndis_ipa_ctx->tx_dump_enable);
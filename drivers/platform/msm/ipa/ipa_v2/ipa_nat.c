@@ -42,6 +42,9 @@ enum nat_table_type {
 #define IPA_TABLE_MAX_ENTRIES 1000
 #define MAX_ALLOC_NAT_SIZE (IPA_TABLE_MAX_ENTRIES * NAT_TABLE_ENTRY_SIZE_BYTE)
 
+/* Max NAT_DMA commands posted to IPA HW behind a single NO-OP */
+#define IPA_NAT_DMA_CMD_BATCH 16
+
 static int ipa_nat_vma_fault_remap(
 	 struct vm_area_struct *vma, struct vm_fault *vmf)
 {
@@ -593,12 +596,10 @@ bail:
  */
 int ipa2_nat_dma_cmd(struct ipa_ioc_nat_dma_cmd *dma)
 {
-#define NUM_OF_DESC 2
-
 	struct ipa_register_write *reg_write_nop = NULL;
 	struct ipa_nat_dma *cmd = NULL;
 	struct ipa_desc *desc = NULL;
-	u16 size = 0, cnt = 0;
+	u16 size = 0, cnt = 0, num_desc;
 	int ret = 0;
 	gfp_t flag = GFP_KERNEL | (ipa_ctx->use_dma_zone ? GFP_DMA : 0);
 
@@ -680,7 +681,7 @@ int ipa2_nat_dma_cmd(struct ipa_ioc_nat_dma_cmd *dma)
 		}
 	}
 
-	size = sizeof(struct ipa_desc) * NUM_OF_DESC;
+	size = sizeof(struct ipa_desc) * (IPA_NAT_DMA_CMD_BATCH + 1);
 	desc = kzalloc(size, GFP_KERNEL);
 	if (desc == NULL) {
 		IPAERR("Failed to alloc memory\n");
@@ -688,8 +689,7 @@ int ipa2_nat_dma_cmd(struct ipa_ioc_nat_dma_cmd *dma)
 		goto bail;
 	}
 
-	size = sizeof(struct ipa_nat_dma);
-	cmd = kzalloc(size, flag);
+	cmd = kcalloc(IPA_NAT_DMA_CMD_BATCH, sizeof(struct ipa_nat_dma), flag);
 	if (cmd == NULL) {
 		IPAERR("Failed to alloc memory\n");
 		ret = -ENOMEM;
@@ -707,31 +707,39 @@ int ipa2_nat_dma_cmd(struct ipa_ioc_nat_dma_cmd *dma)
 	reg_write_nop->skip_pipeline_clear = 0;
 	reg_write_nop->value_mask = 0x0;
 
-	desc[0].type = IPA_IMM_CMD_DESC;
-	desc[0].opcode = IPA_REGISTER_WRITE;
-	desc[0].callback = NULL;
-	desc[0].user1 = NULL;
-	desc[0].user2 = 0;
-	desc[0].len = sizeof(*reg_write_nop);
-	desc[0].pyld = (void *)reg_write_nop;
+	/*
+	 * Post the entries in batches behind a single NO-OP, so that a burst
+	 * of connection updates costs one round trip to IPA HW per batch
+	 * rather than one per entry.
+	 */
+	cnt = 0;
+	while (cnt < dma->entries) {
+		memset(desc, 0, size);
+		desc[0].type = IPA_IMM_CMD_DESC;
+		desc[0].opcode = IPA_REGISTER_WRITE;
+		desc[0].len = sizeof(*reg_write_nop);
+		desc[0].pyld = (void *)reg_write_nop;
+		num_desc = 1;
+
+		for (; cnt < dma->entries &&
+			num_desc <= IPA_NAT_DMA_CMD_BATCH; cnt++) {
+			cmd[num_desc - 1].table_index =
+				dma->dma[cnt].table_index;
+			cmd[num_desc - 1].base_addr = dma->dma[cnt].base_addr;
+			cmd[num_desc - 1].offset = dma->dma[cnt].offset;
+			cmd[num_desc - 1].data = dma->dma[cnt].data;
+
+			desc[num_desc].type = IPA_IMM_CMD_DESC;
+			desc[num_desc].opcode = IPA_NAT_DMA;
+			desc[num_desc].len = sizeof(struct ipa_nat_dma);
+			desc[num_desc].pyld = (void *)&cmd[num_desc - 1];
+			num_desc++;
+		}
 
-	for (cnt = 0; cnt < dma->entries; cnt++) {
-		cmd->table_index = dma->dma[cnt].table_index;
-		cmd->base_addr = dma->dma[cnt].base_addr;
-		cmd->offset = dma->dma[cnt].offset;
-		cmd->data = dma->dma[cnt].data;
-
-		desc[1].type = IPA_IMM_CMD_DESC;
-		desc[1].opcode = IPA_NAT_DMA;
-		desc[1].callback = NULL;
-		desc[1].user1 = NULL;
-		desc[1].user2 = 0;
-		desc[1].len = sizeof(struct ipa_nat_dma);
-		desc[1].pyld = (void *)cmd;
-
-		ret = ipa_send_cmd(NUM_OF_DESC, desc);
-		if (ret == -EPERM)
-			IPAERR("Fail to send immediate command %d\n", cnt);
+		ret = ipa_send_cmd(num_desc, desc);
+		if (ret)
+			IPAERR("Fail to send immediate commands up to %d\n",
+				cnt);
 	}
 
 bail:
@@ -4911,6 +4911,7 @@ static int ipa3_pre_init(const struct ipa3_plat_drv_res *resource_p,
 	ipa3_ctx->lan_rx_ring_size = resource_p->lan_rx_ring_size;
 	ipa3_ctx->skip_uc_pipe_reset = resource_p->skip_uc_pipe_reset;
 	ipa3_ctx->tethered_flow_control = resource_p->tethered_flow_control;
+	ipa3_ctx->wan_rx_page_recycle = resource_p->wan_rx_page_recycle;
 	ipa3_ctx->transport_prototype = resource_p->transport_prototype;
 	ipa3_ctx->ee = resource_p->ee;
 	ipa3_ctx->apply_rg10_wa = resource_p->apply_rg10_wa;
@@ -5581,6 +5582,13 @@ static int get_ipa_dts_configuration(struct platform_device *pdev,
 		ipa_drv_res->tethered_flow_control
 		? "True" : "False");
 
+	ipa_drv_res->wan_rx_page_recycle =
+		of_property_read_bool(pdev->dev.of_node,
+		"qcom,wan-rx-page-recycle");
+	IPADBG(": WAN rx page recycling = %s\n",
+		ipa_drv_res->wan_rx_page_recycle
+		? "True" : "False");
+
 	if (of_property_read_bool(pdev->dev.of_node,
 		"qcom,use-gsi"))
 		ipa_drv_res->transport_prototype = IPA_TRANSPORT_TYPE_GSI;
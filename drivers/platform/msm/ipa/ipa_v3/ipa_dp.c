@@ -49,6 +49,9 @@
 
 #define IPA_RX_BUFF_CLIENT_HEADROOM 256
 
+/* page recycling pipes keep at most this many rx pools worth of pages */
+#define IPA_RX_PAGE_POOL_FACTOR 2
+
 #define IPA_WLAN_RX_POOL_SZ 100
 #define IPA_WLAN_RX_POOL_SZ_LOW_WM 5
 #define IPA_WLAN_RX_BUFF_SZ 2048
@@ -77,7 +80,10 @@ static void ipa3_replenish_wlan_rx_cache(struct ipa3_sys_context *sys);
 static void ipa3_replenish_rx_cache(struct ipa3_sys_context *sys);
 static void ipa3_replenish_rx_work_func(struct work_struct *work);
 static void ipa3_fast_replenish_rx_cache(struct ipa3_sys_context *sys);
+static void ipa3_replenish_rx_page_recycle(struct ipa3_sys_context *sys);
+static void ipa3_recycle_rx_page_wrapper(struct ipa3_rx_pkt_wrapper *rx_pkt);
 static void ipa3_wq_handle_rx(struct work_struct *work);
+static void ipa3_napi_done_work_func(struct work_struct *work);
 static void ipa3_wq_handle_tx(struct work_struct *work);
 static void ipa3_wq_rx_common(struct ipa3_sys_context *sys, u32 size);
 static void ipa3_wlan_wq_rx_common(struct ipa3_sys_context *sys,
@@ -97,9 +103,9 @@ static int ipa_populate_tag_field(struct ipa3_desc *desc,
 		struct ipa3_tx_pkt_wrapper *tx_pkt,
 		struct ipahal_imm_cmd_pyld **tag_pyld_ret);
 static int ipa_handle_rx_core_gsi(struct ipa3_sys_context *sys,
-	bool process_all, bool in_poll_state);
+	int budget, bool in_poll_state);
 static int ipa_handle_rx_core_sps(struct ipa3_sys_context *sys,
-	bool process_all, bool in_poll_state);
+	int budget, bool in_poll_state);
 static unsigned long tag_to_pointer_wa(uint64_t tag);
 static uint64_t pointer_to_tag_wa(struct ipa3_tx_pkt_wrapper *tx_pkt);
 
@@ -886,19 +892,26 @@ static void ipa3_sps_irq_tx_no_aggr_notify(struct sps_event_notify *notify)
  *  - Call the endpoints notify function, passing the skb in the parameters
  *  - Replenish the rx cache
  */
-static int ipa3_handle_rx_core(struct ipa3_sys_context *sys, bool process_all,
+static int __ipa3_handle_rx_core(struct ipa3_sys_context *sys, int budget,
 		bool in_poll_state)
 {
 	int cnt;
 
 	if (ipa3_ctx->transport_prototype == IPA_TRANSPORT_TYPE_GSI)
-		cnt = ipa_handle_rx_core_gsi(sys, process_all, in_poll_state);
+		cnt = ipa_handle_rx_core_gsi(sys, budget, in_poll_state);
 	else
-		cnt = ipa_handle_rx_core_sps(sys, process_all, in_poll_state);
+		cnt = ipa_handle_rx_core_sps(sys, budget, in_poll_state);
 
 	return cnt;
 }
 
+static int ipa3_handle_rx_core(struct ipa3_sys_context *sys, bool process_all,
+		bool in_poll_state)
+{
+	return __ipa3_handle_rx_core(sys, process_all ? INT_MAX : 1,
+		in_poll_state);
+}
+
 /**
  * ipa3_rx_switch_to_intr_mode() - Operate the Rx data path in interrupt mode
  */
@@ -958,6 +971,31 @@ fail:
 			msecs_to_jiffies(1));
 }
 
+/**
+ * ipa3_rx_start_poll() - Hand a pipe that just entered polling mode to its
+ * poller
+ * @sys:	system pipe context
+ *
+ * NAPI pipes are polled by their client through ipa3_rx_poll(); the clock
+ * vote taken here is dropped once the pipe is back in interrupt mode. If the
+ * clocks cannot be voted from atomic context, or the pipe is not NAPI
+ * driven, the IPA workqueue takes over.
+ */
+static void ipa3_rx_start_poll(struct ipa3_sys_context *sys)
+{
+	struct ipa_active_client_logging_info log;
+
+	if (sys->ep->napi_enabled) {
+		IPA_ACTIVE_CLIENTS_PREP_SPECIAL(log, "NAPI");
+		if (!ipa3_inc_client_enable_clks_no_block(&log)) {
+			sys->ep->client_notify(sys->ep->priv,
+				IPA_CLIENT_START_POLL, 0);
+			return;
+		}
+	}
+	queue_work(sys->wq, &sys->work);
+}
+
 /**
  * ipa_rx_notify() - Callback function which is called by the SPS driver when a
  * a packet is received
@@ -1000,7 +1038,7 @@ static void ipa3_sps_irq_rx_notify(struct sps_event_notify *notify)
 			ipa3_inc_acquire_wakelock();
 			atomic_set(&sys->curr_polling_state, 1);
 			trace_intr_to_poll3(sys->ep->client);
-			queue_work(sys->wq, &sys->work);
+			ipa3_rx_start_poll(sys);
 		}
 		break;
 	default:
@@ -1187,6 +1225,9 @@ int ipa3_setup_sys_pipe(struct ipa_sys_connect_params *sys_in, u32 *clnt_hdl)
 	ep->client_notify = sys_in->notify;
 	ep->priv = sys_in->priv;
 	ep->keep_ipa_awake = sys_in->keep_ipa_awake;
+	ep->napi_enabled = sys_in->napi_enabled &&
+		IPA_CLIENT_IS_CONS(sys_in->client);
+	INIT_WORK(&ep->sys->napi_done_work, ipa3_napi_done_work_func);
 	atomic_set(&ep->avail_fifo_desc,
 		((sys_in->desc_fifo_sz/sizeof(struct sps_iovec))-1));
 
@@ -1314,8 +1355,12 @@ int ipa3_setup_sys_pipe(struct ipa_sys_connect_params *sys_in, u32 *clnt_hdl)
 		}
 	}
 
-	if (IPA_CLIENT_IS_CONS(sys_in->client))
-		ipa3_replenish_rx_cache(ep->sys);
+	if (IPA_CLIENT_IS_CONS(sys_in->client)) {
+		if (ep->sys->repl_hdlr == ipa3_replenish_rx_page_recycle)
+			ipa3_replenish_rx_page_recycle(ep->sys);
+		else
+			ipa3_replenish_rx_cache(ep->sys);
+	}
 
 	if (IPA_CLIENT_IS_WLAN_CONS(sys_in->client)) {
 		ipa3_alloc_wlan_rx_common_cache(IPA_WLAN_COMM_RX_POOL_LOW);
@@ -1787,7 +1832,65 @@ static void ipa3_wq_handle_rx(struct work_struct *work)
 	struct ipa3_sys_context *sys;
 
 	sys = container_of(work, struct ipa3_sys_context, work);
-	ipa3_handle_rx(sys);
+
+	if (sys->ep->napi_enabled) {
+		IPA_ACTIVE_CLIENTS_INC_SPECIAL("NAPI");
+		sys->ep->client_notify(sys->ep->priv,
+			IPA_CLIENT_START_POLL, 0);
+	} else {
+		ipa3_handle_rx(sys);
+	}
+}
+
+static void ipa3_napi_done_work_func(struct work_struct *work)
+{
+	struct ipa3_sys_context *sys;
+
+	sys = container_of(work, struct ipa3_sys_context, napi_done_work);
+	trace_poll_to_intr3(sys->ep->client);
+	ipa3_rx_switch_to_intr_mode(sys);
+	IPA_ACTIVE_CLIENTS_DEC_SPECIAL("NAPI");
+}
+
+/**
+ * ipa3_rx_poll() - Poll a NAPI driven consumer pipe
+ * @clnt_hdl:	[in] opaque client handle assigned by IPA to client
+ * @budget:	[in] maximum number of descriptors to process
+ *
+ * Called by the client from its NAPI poll handler after it was notified with
+ * IPA_CLIENT_START_POLL. Packets are delivered through the client's
+ * IPA_RECEIVE callback and the rx ring is replenished as they are consumed.
+ * When fewer than @budget descriptors were pending the client is notified
+ * with IPA_CLIENT_COMP_NAPI to complete its poll, after which the pipe is
+ * moved back to interrupt mode.
+ *
+ * Returns:	number of descriptors processed, negative on failure
+ */
+int ipa3_rx_poll(u32 clnt_hdl, int budget)
+{
+	struct ipa3_ep_context *ep;
+	int cnt;
+
+	if (clnt_hdl >= ipa3_ctx->ipa_num_pipes ||
+	    ipa3_ctx->ep[clnt_hdl].valid == 0) {
+		IPAERR("bad parm 0x%x\n", clnt_hdl);
+		return -EINVAL;
+	}
+
+	ep = &ipa3_ctx->ep[clnt_hdl];
+	if (!ep->napi_enabled || !ep->sys) {
+		IPAERR("pipe %u is not NAPI driven\n", clnt_hdl);
+		return -EINVAL;
+	}
+
+	cnt = __ipa3_handle_rx_core(ep->sys, budget, true);
+	if (cnt < budget) {
+		ep->client_notify(ep->priv, IPA_CLIENT_COMP_NAPI, 0);
+		if (atomic_read(&ep->sys->curr_polling_state))
+			queue_work(ep->sys->wq, &ep->sys->napi_done_work);
+	}
+
+	return cnt;
 }
 
 static void ipa3_wq_repl_rx(struct work_struct *work)
@@ -2337,6 +2440,171 @@ static void ipa3_fast_replenish_rx_cache(struct ipa3_sys_context *sys)
 	}
 }
 
+static struct ipa3_rx_pkt_wrapper *ipa3_alloc_rx_page_wrapper(
+	struct ipa3_sys_context *sys, gfp_t flag)
+{
+	struct ipa3_rx_pkt_wrapper *rx_pkt;
+
+	rx_pkt = kmem_cache_zalloc(ipa3_ctx->rx_pkt_wrapper_cache, flag);
+	if (!rx_pkt)
+		return NULL;
+
+	INIT_LIST_HEAD(&rx_pkt->link);
+	INIT_WORK(&rx_pkt->work, ipa3_wq_rx_avail);
+	rx_pkt->sys = sys;
+
+	rx_pkt->page = alloc_pages(flag | __GFP_COMP,
+		get_order(IPA_REAL_GENERIC_RX_BUFF_SZ(sys->rx_buff_sz)));
+	if (!rx_pkt->page)
+		goto fail_page_alloc;
+
+	rx_pkt->data.dma_addr = dma_map_single(ipa3_ctx->pdev,
+		page_address(rx_pkt->page) + NET_SKB_PAD, sys->rx_buff_sz,
+		DMA_FROM_DEVICE);
+	if (dma_mapping_error(ipa3_ctx->pdev, rx_pkt->data.dma_addr)) {
+		IPAERR("dma_map_single failure for page %p\n", rx_pkt->page);
+		goto fail_dma_mapping;
+	}
+
+	sys->page_pool_cnt++;
+	IPA_STATS_INC_CNT(ipa3_ctx->stats.wan_rx_page_alloc);
+	return rx_pkt;
+
+fail_dma_mapping:
+	__free_pages(rx_pkt->page,
+		get_order(IPA_REAL_GENERIC_RX_BUFF_SZ(sys->rx_buff_sz)));
+fail_page_alloc:
+	kmem_cache_free(ipa3_ctx->rx_pkt_wrapper_cache, rx_pkt);
+	return NULL;
+}
+
+static void ipa3_free_rx_page_wrapper(struct ipa3_rx_pkt_wrapper *rx_pkt)
+{
+	DEFINE_DMA_ATTRS(attrs);
+
+	/*
+	 * The stack may still be reading the page; dropping the mapping must
+	 * not invalidate what the CPU sees.
+	 */
+	dma_set_attr(DMA_ATTR_SKIP_CPU_SYNC, &attrs);
+	dma_unmap_single_attrs(ipa3_ctx->pdev, rx_pkt->data.dma_addr,
+		rx_pkt->sys->rx_buff_sz, DMA_FROM_DEVICE, &attrs);
+	put_page(rx_pkt->page);
+	rx_pkt->sys->page_pool_cnt--;
+	kmem_cache_free(ipa3_ctx->rx_pkt_wrapper_cache, rx_pkt);
+}
+
+/**
+ * ipa3_get_rx_page_wrapper() - get an Rx packet for a page recycling pipe
+ * @sys:	system pipe context
+ *
+ * Pages stay DMA-mapped for the lifetime of the pipe. A page is reused once
+ * the stack dropped every skb built on it, i.e. only the pool reference is
+ * left. A fresh page is allocated when the oldest one is still in use, as
+ * long as the pool is below its limit.
+ */
+static struct ipa3_rx_pkt_wrapper *ipa3_get_rx_page_wrapper(
+	struct ipa3_sys_context *sys)
+{
+	struct ipa3_rx_pkt_wrapper *rx_pkt = NULL;
+
+	spin_lock_bh(&sys->spinlock);
+	if (!list_empty(&sys->rcycl_list)) {
+		rx_pkt = list_first_entry(&sys->rcycl_list,
+			struct ipa3_rx_pkt_wrapper, link);
+		if (page_count(rx_pkt->page) == 1) {
+			list_del_init(&rx_pkt->link);
+		} else {
+			list_move_tail(&rx_pkt->link, &sys->rcycl_list);
+			rx_pkt = NULL;
+		}
+	}
+	spin_unlock_bh(&sys->spinlock);
+
+	if (rx_pkt) {
+		dma_sync_single_for_device(ipa3_ctx->pdev,
+			rx_pkt->data.dma_addr, sys->rx_buff_sz,
+			DMA_FROM_DEVICE);
+		IPA_STATS_INC_CNT(ipa3_ctx->stats.wan_rx_page_recycled);
+		return rx_pkt;
+	}
+
+	if (sys->page_pool_cnt >= IPA_RX_PAGE_POOL_FACTOR * sys->rx_pool_sz)
+		return NULL;
+
+	return ipa3_alloc_rx_page_wrapper(sys, GFP_NOWAIT | __GFP_NOWARN);
+}
+
+static void ipa3_replenish_rx_page_recycle(struct ipa3_sys_context *sys)
+{
+	struct ipa3_rx_pkt_wrapper *rx_pkt;
+	int ret;
+	int rx_len_cached = 0;
+	struct gsi_xfer_elem gsi_xfer_elem_one;
+
+	rx_len_cached = sys->len;
+
+	while (rx_len_cached < sys->rx_pool_sz) {
+		rx_pkt = ipa3_get_rx_page_wrapper(sys);
+		if (!rx_pkt)
+			goto fail_get_page;
+
+		list_add_tail(&rx_pkt->link, &sys->head_desc_list);
+		rx_len_cached = ++sys->len;
+
+		if (ipa3_ctx->transport_prototype ==
+				IPA_TRANSPORT_TYPE_GSI) {
+			memset(&gsi_xfer_elem_one, 0,
+				sizeof(gsi_xfer_elem_one));
+			gsi_xfer_elem_one.addr = rx_pkt->data.dma_addr;
+			gsi_xfer_elem_one.len = sys->rx_buff_sz;
+			gsi_xfer_elem_one.flags |= GSI_XFER_FLAG_EOT;
+			gsi_xfer_elem_one.flags |= GSI_XFER_FLAG_EOB;
+			gsi_xfer_elem_one.type = GSI_XFER_ELEM_DATA;
+			gsi_xfer_elem_one.xfer_user_data = rx_pkt;
+
+			ret = gsi_queue_xfer(sys->ep->gsi_chan_hdl,
+					1, &gsi_xfer_elem_one, false);
+			if (ret != GSI_STATUS_SUCCESS) {
+				IPAERR("failed to provide buffer: %d\n",
+					ret);
+				goto fail_provide_rx_buffer;
+			}
+
+			/*
+			 * As doorbell is a costly operation, notify to GSI
+			 * of new buffers if threshold is exceeded
+			 */
+			if (++sys->len_pending_xfer >= IPA_REPL_XFER_THRESH) {
+				sys->len_pending_xfer = 0;
+				gsi_start_xfer(sys->ep->gsi_chan_hdl);
+			}
+		} else {
+			ret = sps_transfer_one(sys->ep->ep_hdl,
+				rx_pkt->data.dma_addr, sys->rx_buff_sz,
+				rx_pkt, 0);
+
+			if (ret) {
+				IPAERR("sps_transfer_one failed %d\n", ret);
+				goto fail_provide_rx_buffer;
+			}
+		}
+	}
+
+	return;
+
+fail_provide_rx_buffer:
+	list_del(&rx_pkt->link);
+	rx_len_cached = --sys->len;
+	ipa3_recycle_rx_page_wrapper(rx_pkt);
+fail_get_page:
+	if (rx_len_cached - sys->len_pending_xfer == 0) {
+		IPA_STATS_INC_CNT(ipa3_ctx->stats.wan_rx_empty);
+		queue_delayed_work(sys->wq, &sys->replenish_rx_work,
+				msecs_to_jiffies(1));
+	}
+}
+
 static void ipa3_replenish_rx_work_func(struct work_struct *work)
 {
 	struct delayed_work *dwork;
@@ -2363,6 +2631,10 @@ static void ipa3_cleanup_rx(struct ipa3_sys_context *sys)
 	list_for_each_entry_safe(rx_pkt, r,
 				 &sys->head_desc_list, link) {
 		list_del(&rx_pkt->link);
+		if (rx_pkt->page) {
+			ipa3_free_rx_page_wrapper(rx_pkt);
+			continue;
+		}
 		dma_unmap_single(ipa3_ctx->pdev, rx_pkt->data.dma_addr,
 			sys->rx_buff_sz, DMA_FROM_DEVICE);
 		sys->free_skb(rx_pkt->data.skb);
@@ -2372,6 +2644,10 @@ static void ipa3_cleanup_rx(struct ipa3_sys_context *sys)
 	list_for_each_entry_safe(rx_pkt, r,
 				 &sys->rcycl_list, link) {
 		list_del(&rx_pkt->link);
+		if (rx_pkt->page) {
+			ipa3_free_rx_page_wrapper(rx_pkt);
+			continue;
+		}
 		dma_unmap_single(ipa3_ctx->pdev, rx_pkt->data.dma_addr,
 			sys->rx_buff_sz, DMA_FROM_DEVICE);
 		sys->free_skb(rx_pkt->data.skb);
@@ -2686,13 +2962,19 @@ begin:
 	return rc;
 }
 
+/* NAPI pipes are drained from softirq context and must not sleep */
+static inline gfp_t ipa3_rx_gfp(struct ipa3_sys_context *sys)
+{
+	return sys->ep->napi_enabled ? GFP_ATOMIC : GFP_KERNEL;
+}
+
 static struct sk_buff *ipa3_join_prev_skb(struct sk_buff *prev_skb,
-		struct sk_buff *skb, unsigned int len)
+		struct sk_buff *skb, unsigned int len, gfp_t flag)
 {
 	struct sk_buff *skb2;
 
 	skb2 = skb_copy_expand(prev_skb, 0,
-			len, GFP_KERNEL);
+			len, flag);
 	if (likely(skb2)) {
 		memcpy(skb_put(skb2, len),
 			skb->data, len);
@@ -2714,7 +2996,7 @@ static void ipa3_wan_rx_handle_splt_pyld(struct sk_buff *skb,
 	if (sys->len_rem <= skb->len) {
 		if (sys->prev_skb) {
 			skb2 = ipa3_join_prev_skb(sys->prev_skb, skb,
-					sys->len_rem);
+					sys->len_rem, ipa3_rx_gfp(sys));
 			if (likely(skb2)) {
 				IPADBG_LOW(
 					"removing Status element from skb and sending to WAN client");
@@ -2732,7 +3014,7 @@ static void ipa3_wan_rx_handle_splt_pyld(struct sk_buff *skb,
 	} else {
 		if (sys->prev_skb) {
 			skb2 = ipa3_join_prev_skb(sys->prev_skb, skb,
-					skb->len);
+					skb->len, ipa3_rx_gfp(sys));
 			sys->prev_skb = skb2;
 		}
 		sys->len_rem -= skb->len;
@@ -2858,7 +3140,7 @@ static int ipa3_wan_rx_pyld_hdlr(struct sk_buff *skb,
 			frame_len += IPA_DL_CHECKSUM_LENGTH;
 		IPADBG_LOW("frame_len %d\n", frame_len);
 
-		skb2 = skb_clone(skb, GFP_KERNEL);
+		skb2 = skb_clone(skb, ipa3_rx_gfp(sys));
 		if (likely(skb2)) {
 			/*
 			 * the len of actual data is smaller than expected
@@ -2964,6 +3246,36 @@ static void ipa3_recycle_rx_wrapper(struct ipa3_rx_pkt_wrapper *rx_pkt)
 	spin_unlock_bh(&rx_pkt->sys->spinlock);
 }
 
+static void ipa3_recycle_rx_page_wrapper(struct ipa3_rx_pkt_wrapper *rx_pkt)
+{
+	INIT_LIST_HEAD(&rx_pkt->link);
+	spin_lock_bh(&rx_pkt->sys->spinlock);
+	list_add_tail(&rx_pkt->link, &rx_pkt->sys->rcycl_list);
+	spin_unlock_bh(&rx_pkt->sys->spinlock);
+}
+
+/*
+ * Wrap a recycled page in an skb. The skb holds its own page reference, so
+ * the page returns to the pool once the stack frees the last user of it.
+ */
+static struct sk_buff *ipa3_build_rx_page_skb(struct ipa3_sys_context *sys,
+	struct ipa3_rx_pkt_wrapper *rx_pkt)
+{
+	struct sk_buff *skb;
+
+	dma_sync_single_for_cpu(ipa3_ctx->pdev, rx_pkt->data.dma_addr,
+		rx_pkt->len, DMA_FROM_DEVICE);
+
+	skb = build_skb(page_address(rx_pkt->page),
+		PAGE_SIZE << compound_order(rx_pkt->page));
+	if (unlikely(!skb))
+		return NULL;
+
+	get_page(rx_pkt->page);
+	skb_reserve(skb, NET_SKB_PAD);
+	return skb;
+}
+
 static void ipa3_wq_rx_common(struct ipa3_sys_context *sys, u32 size)
 {
 	struct ipa3_rx_pkt_wrapper *rx_pkt_expected;
@@ -2982,9 +3294,20 @@ static void ipa3_wq_rx_common(struct ipa3_sys_context *sys, u32 size)
 	if (size)
 		rx_pkt_expected->len = size;
 	spin_unlock_bh(&sys->spinlock);
-	rx_skb = rx_pkt_expected->data.skb;
-	dma_unmap_single(ipa3_ctx->pdev, rx_pkt_expected->data.dma_addr,
+	if (rx_pkt_expected->page) {
+		rx_skb = ipa3_build_rx_page_skb(sys, rx_pkt_expected);
+		if (unlikely(!rx_skb)) {
+			IPAERR("failed to build skb, dropping packet\n");
+			sys->free_rx_wrapper(rx_pkt_expected);
+			sys->repl_hdlr(sys);
+			return;
+		}
+	} else {
+		rx_skb = rx_pkt_expected->data.skb;
+		dma_unmap_single(ipa3_ctx->pdev,
+			rx_pkt_expected->data.dma_addr,
 			sys->rx_buff_sz, DMA_FROM_DEVICE);
+	}
 	skb_set_tail_pointer(rx_skb, rx_pkt_expected->len);
 	rx_skb->len = rx_pkt_expected->len;
 	*(unsigned int *)rx_skb->cb = rx_skb->len;
@@ -3229,6 +3552,12 @@ static int ipa3_assign_policy(struct ipa_sys_connect_params *in,
 						aggr_pkt_limit =
 					IPA_GENERIC_AGGR_PKT_LIMIT;
 				}
+				if (ipa3_ctx->wan_rx_page_recycle) {
+					sys->repl_hdlr =
+					ipa3_replenish_rx_page_recycle;
+					sys->free_rx_wrapper =
+					ipa3_recycle_rx_page_wrapper;
+				}
 			}
 		} else if (IPA_CLIENT_IS_WLAN_CONS(in->client)) {
 			IPADBG("assigning policy to client:%d",
@@ -3763,7 +4092,7 @@ static void ipa_gsi_irq_rx_notify_cb(struct gsi_chan_xfer_notify *notify)
 				GSI_CHAN_MODE_POLL);
 			ipa3_inc_acquire_wakelock();
 			atomic_set(&sys->curr_polling_state, 1);
-			queue_work(sys->wq, &sys->work);
+			ipa3_rx_start_poll(sys);
 		}
 		break;
 	default:
@@ -4076,7 +4405,7 @@ static int ipa_populate_tag_field(struct ipa3_desc *desc,
 }
 
 static int ipa_handle_rx_core_gsi(struct ipa3_sys_context *sys,
-	bool process_all, bool in_poll_state)
+	int budget, bool in_poll_state)
 {
 	int ret;
 	int cnt = 0;
@@ -4103,7 +4432,7 @@ static int ipa_handle_rx_core_gsi(struct ipa3_sys_context *sys,
 
 	while ((in_poll_state ? atomic_read(&sys->curr_polling_state) :
 			!atomic_read(&sys->curr_polling_state))) {
-		if (cnt && !process_all)
+		if (cnt >= budget)
 			break;
 
 		ret = gsi_poll_channel(sys->ep->gsi_chan_hdl,
@@ -4134,7 +4463,7 @@ static int ipa_handle_rx_core_gsi(struct ipa3_sys_context *sys,
 }
 
 static int ipa_handle_rx_core_sps(struct ipa3_sys_context *sys,
-	bool process_all, bool in_poll_state)
+	int budget, bool in_poll_state)
 {
 	struct sps_iovec iov;
 	int ret;
@@ -4143,7 +4472,7 @@ static int ipa_handle_rx_core_sps(struct ipa3_sys_context *sys,
 
 	while ((in_poll_state ? atomic_read(&sys->curr_polling_state) :
 			!atomic_read(&sys->curr_polling_state))) {
-		if (cnt && !process_all)
+		if (cnt >= budget)
 			break;
 
 		ret = sps_get_iovec(sys->ep->ep_hdl, &iov);
@@ -589,6 +589,7 @@ struct ipa3_status_stats {
  * @skip_ep_cfg: boolean field that determines if EP should be configured
  *  by IPA driver
  * @keep_ipa_awake: when true, IPA will not be clock gated
+ * @napi_enabled: consumer pipe is polled from the client's NAPI handler
  * @disconnect_in_progress: Indicates client disconnect in progress.
  * @qmi_request_sent: Indicates whether QMI request to enable clear data path
  *					request is sent or not.
@@ -626,6 +627,7 @@ struct ipa3_ep_context {
 	u32 dflt_flt6_rule_hdl;
 	bool skip_ep_cfg;
 	bool keep_ipa_awake;
+	bool napi_enabled;
 	struct ipa3_wlan_stats wstats;
 	u32 uc_offload_state;
 	bool disconnect_in_progress;
@@ -713,12 +715,14 @@ struct ipa3_sys_context {
 	unsigned int len_partial;
 	bool drop_packet;
 	struct work_struct work;
+	struct work_struct napi_done_work;
 	void (*sps_callback)(struct sps_event_notify *notify);
 	enum sps_option sps_option;
 	struct delayed_work replenish_rx_work;
 	struct work_struct repl_work;
 	void (*repl_hdlr)(struct ipa3_sys_context *sys);
 	struct ipa3_repl_ctx repl;
+	u32 page_pool_cnt;
 
 	/* ordering is important - mutable fields go above */
 	struct ipa3_ep_context *ep;
@@ -838,6 +842,7 @@ struct ipa3_desc {
  * @dma_address: DMA address of this Rx packet
  * @link: linked to the Rx packets on that pipe
  * @len: how many bytes are copied into skb's flat buffer
+ * @page: DMA-mapped page backing this Rx packet on page recycling pipes
  */
 struct ipa3_rx_pkt_wrapper {
 	struct list_head link;
@@ -845,6 +850,7 @@ struct ipa3_rx_pkt_wrapper {
 	u32 len;
 	struct work_struct work;
 	struct ipa3_sys_context *sys;
+	struct page *page;
 };
 
 /**
@@ -932,6 +938,8 @@ struct ipa3_stats {
 	u32 flow_enable;
 	u32 flow_disable;
 	u32 tx_non_linear;
+	u32 wan_rx_page_recycled;
+	u32 wan_rx_page_alloc;
 };
 
 struct ipa3_active_clients {
@@ -1353,6 +1361,7 @@ struct ipa3_context {
 	/* M-release support to know client pipes */
 	struct ipa3cm_client_info ipacm_client[IPA3_MAX_NUM_PIPES];
 	bool tethered_flow_control;
+	bool wan_rx_page_recycle;
 	bool ipa_initialization_complete;
 	struct list_head ipa_ready_cb_list;
 	struct completion init_completion_obj;
@@ -1403,6 +1412,7 @@ struct ipa3_plat_drv_res {
 	bool apply_rg10_wa;
 	bool gsi_ch20_wa;
 	bool tethered_flow_control;
+	bool wan_rx_page_recycle;
 	bool ipa_mhi_dynamic_config;
 	u32 ipa_tz_unlock_reg_num;
 	struct ipa_tz_unlock_reg_info *ipa_tz_unlock_reg;
@@ -1742,6 +1752,8 @@ int ipa3_setup_sys_pipe(struct ipa_sys_connect_params *sys_in, u32 *clnt_hdl);
 
 int ipa3_teardown_sys_pipe(u32 clnt_hdl);
 
+int ipa3_rx_poll(u32 clnt_hdl, int budget);
+
 int ipa3_sys_setup(struct ipa_sys_connect_params *sys_in,
 	unsigned long *ipa_bam_hdl,
 	u32 *ipa_pipe_num, u32 *clnt_hdl, bool en_status);
@@ -41,6 +41,9 @@ enum nat_table_type {
 #define IPA_TABLE_MAX_ENTRIES 1000
 #define MAX_ALLOC_NAT_SIZE (IPA_TABLE_MAX_ENTRIES * NAT_TABLE_ENTRY_SIZE_BYTE)
 
+/* Max NAT_DMA commands posted to IPA HW behind a single NO-OP */
+#define IPA_NAT_DMA_CMD_BATCH 16
+
 static int ipa3_nat_vma_fault_remap(
 	 struct vm_area_struct *vma, struct vm_fault *vmf)
 {
@@ -617,13 +620,11 @@ bail:
  */
 int ipa3_nat_dma_cmd(struct ipa_ioc_nat_dma_cmd *dma)
 {
-#define NUM_OF_DESC 2
-
 	struct ipahal_imm_cmd_pyld *nop_cmd_pyld = NULL;
 	struct ipahal_imm_cmd_nat_dma cmd;
-	struct ipahal_imm_cmd_pyld *cmd_pyld = NULL;
+	struct ipahal_imm_cmd_pyld *cmd_pyld[IPA_NAT_DMA_CMD_BATCH];
 	struct ipa3_desc *desc = NULL;
-	u16 size = 0, cnt = 0;
+	u16 size = 0, cnt = 0, num_desc, i;
 	int ret = 0;
 
 	IPADBG("\n");
@@ -699,7 +700,7 @@ int ipa3_nat_dma_cmd(struct ipa_ioc_nat_dma_cmd *dma)
 		}
 	}
 
-	size = sizeof(struct ipa3_desc) * NUM_OF_DESC;
+	size = sizeof(struct ipa3_desc) * (IPA_NAT_DMA_CMD_BATCH + 1);
 	desc = kzalloc(size, GFP_KERNEL);
 	if (desc == NULL) {
 		IPAERR("Failed to alloc memory\n");
@@ -715,37 +716,51 @@ int ipa3_nat_dma_cmd(struct ipa_ioc_nat_dma_cmd *dma)
 		ret = -ENOMEM;
 		goto bail;
 	}
-	desc[0].type = IPA_IMM_CMD_DESC;
-	desc[0].opcode = ipahal_imm_cmd_get_opcode(IPA_IMM_CMD_REGISTER_WRITE);
-	desc[0].callback = NULL;
-	desc[0].user1 = NULL;
-	desc[0].user2 = 0;
-	desc[0].pyld = nop_cmd_pyld->data;
-	desc[0].len = nop_cmd_pyld->len;
 
-	for (cnt = 0; cnt < dma->entries; cnt++) {
-		cmd.table_index = dma->dma[cnt].table_index;
-		cmd.base_addr = dma->dma[cnt].base_addr;
-		cmd.offset = dma->dma[cnt].offset;
-		cmd.data = dma->dma[cnt].data;
-		cmd_pyld = ipahal_construct_imm_cmd(
-			IPA_IMM_CMD_NAT_DMA, &cmd, false);
-		if (!cmd_pyld) {
-			IPAERR_RL("Fail to construct nat_dma imm cmd\n");
-			continue;
+	/*
+	 * Post the entries in batches behind a single NO-OP, so that a burst
+	 * of connection updates costs one round trip to IPA HW per batch
+	 * rather than one per entry.
+	 */
+	cnt = 0;
+	while (cnt < dma->entries) {
+		memset(desc, 0, size);
+		desc[0].type = IPA_IMM_CMD_DESC;
+		desc[0].opcode =
+			ipahal_imm_cmd_get_opcode(IPA_IMM_CMD_REGISTER_WRITE);
+		desc[0].pyld = nop_cmd_pyld->data;
+		desc[0].len = nop_cmd_pyld->len;
+		num_desc = 1;
+
+		for (; cnt < dma->entries &&
+			num_desc <= IPA_NAT_DMA_CMD_BATCH; cnt++) {
+			cmd.table_index = dma->dma[cnt].table_index;
+			cmd.base_addr = dma->dma[cnt].base_addr;
+			cmd.offset = dma->dma[cnt].offset;
+			cmd.data = dma->dma[cnt].data;
+			cmd_pyld[num_desc - 1] = ipahal_construct_imm_cmd(
+				IPA_IMM_CMD_NAT_DMA, &cmd, false);
+			if (!cmd_pyld[num_desc - 1]) {
+				IPAERR_RL("Fail to construct nat_dma imm cmd\n");
+				continue;
+			}
+			desc[num_desc].type = IPA_IMM_CMD_DESC;
+			desc[num_desc].opcode =
+				ipahal_imm_cmd_get_opcode(IPA_IMM_CMD_NAT_DMA);
+			desc[num_desc].pyld = cmd_pyld[num_desc - 1]->data;
+			desc[num_desc].len = cmd_pyld[num_desc - 1]->len;
+			num_desc++;
 		}
-		desc[1].type = IPA_IMM_CMD_DESC;
-		desc[1].opcode = ipahal_imm_cmd_get_opcode(IPA_IMM_CMD_NAT_DMA);
-		desc[1].callback = NULL;
-		desc[1].user1 = NULL;
-		desc[1].user2 = 0;
-		desc[1].pyld = cmd_pyld->data;
-		desc[1].len = cmd_pyld->len;
-
-		ret = ipa3_send_cmd(NUM_OF_DESC, desc);
-		if (ret == -EPERM)
-			IPAERR("Fail to send immediate command %d\n", cnt);
-		ipahal_destroy_imm_cmd(cmd_pyld);
+
+		if (num_desc > 1) {
+			ret = ipa3_send_cmd(num_desc, desc);
+			if (ret)
+				IPAERR("Fail to send immediate commands up to %d\n",
+					cnt);
+		}
+
+		for (i = 0; i < num_desc - 1; i++)
+			ipahal_destroy_imm_cmd(cmd_pyld[i]);
 	}
 
 bail:
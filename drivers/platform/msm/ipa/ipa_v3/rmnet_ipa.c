@@ -52,6 +52,7 @@
 #define IPA_WWAN_DEV_NAME "rmnet_ipa%d"
 
 #define IPA_WWAN_RX_SOFTIRQ_THRESH 16
+#define IPA_WWAN_NAPI_WEIGHT 64
 
 #define INVALID_MUX_ID 0xFF
 #define IPA_QUOTA_REACH_ALERT_MAX_SIZE 64
@@ -83,6 +84,7 @@ struct ipa3_rmnet_plat_drv_res {
 	bool ipa_rmnet_ssr;
 	bool ipa_loaduC;
 	bool ipa_advertise_sg_support;
+	bool ipa_napi_enable;
 };
 
 /**
@@ -95,6 +97,7 @@ struct ipa3_rmnet_plat_drv_res {
  * @ch_id: channel id
  * @lock: spinlock for mutual exclusion
  * @device_status: holds device status
+ * @napi: NAPI context polling the IPA->APPS pipe when NAPI is enabled
  *
  * WWAN private - holds all relevant info about WWAN driver
  */
@@ -109,6 +112,7 @@ struct ipa3_wwan_private {
 	spinlock_t lock;
 	struct completion resource_granted_completion;
 	enum ipa3_wwan_device_status device_status;
+	struct napi_struct napi;
 };
 
 struct rmnet_ipa3_context {
@@ -139,6 +143,7 @@ struct rmnet_ipa3_context {
 };
 
 static struct rmnet_ipa3_context *rmnet_ipa3_ctx;
+static struct ipa3_rmnet_plat_drv_res ipa3_rmnet_res = {0, };
 
 /**
 * ipa3_setup_a7_qmap_hdr() - Setup default a7 qmap hdr
@@ -1226,16 +1231,28 @@ static void apps_ipa_packet_receive_notify(void *priv,
 	int result;
 	unsigned int packet_len = skb->len;
 
-	IPAWANDBG_LOW("Rx packet was received");
-	if (evt != IPA_RECEIVE) {
+	switch (evt) {
+	case IPA_RECEIVE:
+		break;
+	case IPA_CLIENT_START_POLL:
+		napi_schedule(&rmnet_ipa3_ctx->wwan_priv->napi);
+		return;
+	case IPA_CLIENT_COMP_NAPI:
+		napi_complete(&rmnet_ipa3_ctx->wwan_priv->napi);
+		return;
+	default:
 		IPAWANERR("A none IPA_RECEIVE event in wan_ipa_receive\n");
 		return;
 	}
 
+	IPAWANDBG_LOW("Rx packet was received");
 	skb->dev = IPA_NETDEV();
 	skb->protocol = htons(ETH_P_MAP);
 
-	if (dev->stats.rx_packets % IPA_WWAN_RX_SOFTIRQ_THRESH == 0) {
+	if (ipa3_rmnet_res.ipa_napi_enable && in_serving_softirq()) {
+		/* delivered from ipa3_rmnet_poll() */
+		result = netif_receive_skb(skb);
+	} else if (dev->stats.rx_packets % IPA_WWAN_RX_SOFTIRQ_THRESH == 0) {
 		trace_rmnet_ipa_netifni3(dev->stats.rx_packets);
 		result = netif_rx_ni(skb);
 	} else {
@@ -1252,6 +1269,27 @@ static void apps_ipa_packet_receive_notify(void *priv,
 	dev->stats.rx_bytes += packet_len;
 }
 
+/**
+ * ipa3_rmnet_poll() - NAPI poll handler of the IPA->APPS pipe
+ *
+ * @napi: NAPI context
+ * @budget: maximum number of packets to receive
+ *
+ * IPA completes the poll with IPA_CLIENT_COMP_NAPI once the pipe is drained.
+ */
+static int ipa3_rmnet_poll(struct napi_struct *napi, int budget)
+{
+	int rcvd_pkts;
+
+	rcvd_pkts = ipa3_rx_poll(rmnet_ipa3_ctx->ipa3_to_apps_hdl, budget);
+	if (rcvd_pkts < 0) {
+		napi_complete(napi);
+		return 0;
+	}
+
+	return rcvd_pkts;
+}
+
 /**
  * handle3_egress_format() - Egress data format configuration
  *
@@ -1355,8 +1393,6 @@ static int handle3_egress_format(struct net_device *dev,
 	return rc;
 }
 
-static struct ipa3_rmnet_plat_drv_res ipa3_rmnet_res = {0, };
-
 /**
  * ipa3_wwan_ioctl() - I/O control for wwan network driver.
  *
@@ -1681,6 +1717,8 @@ static int ipa3_wwan_ioctl(struct net_device *dev, struct ifreq *ifr, int cmd)
 			rmnet_ipa3_ctx->ipa_to_apps_ep_cfg.desc_fifo_sz =
 				IPA_SYS_DESC_FIFO_SZ;
 			rmnet_ipa3_ctx->ipa_to_apps_ep_cfg.priv = dev;
+			rmnet_ipa3_ctx->ipa_to_apps_ep_cfg.napi_enabled =
+				ipa3_rmnet_res.ipa_napi_enable;
 
 			mutex_lock(&rmnet_ipa3_ctx->pipe_handle_guard);
 			if (atomic_read(&rmnet_ipa3_ctx->is_ssr)) {
@@ -2031,6 +2069,12 @@ static int get_ipa_rmnet_dts_configuration(struct platform_device *pdev,
 		"qcom,ipa-advertise-sg-support");
 	pr_info("IPA SG support = %s\n",
 		ipa_rmnet_drv_res->ipa_advertise_sg_support ? "True" : "False");
+
+	ipa_rmnet_drv_res->ipa_napi_enable =
+		of_property_read_bool(pdev->dev.of_node,
+		"qcom,ipa-napi-enable");
+	pr_info("IPA Napi Enable = %s\n",
+		ipa_rmnet_drv_res->ipa_napi_enable ? "True" : "False");
 	return 0;
 }
 
@@ -2211,6 +2255,10 @@ static int ipa3_wwan_probe(struct platform_device *pdev)
 	if (ipa3_rmnet_res.ipa_advertise_sg_support)
 		dev->hw_features |= NETIF_F_SG;
 
+	if (ipa3_rmnet_res.ipa_napi_enable)
+		netif_napi_add(dev, &(rmnet_ipa3_ctx->wwan_priv->napi),
+			ipa3_rmnet_poll, IPA_WWAN_NAPI_WEIGHT);
+
 	ret = register_netdev(dev);
 	if (ret) {
 		IPAWANERR("unable to register ipa_netdev %d rc=%d\n",
@@ -2218,6 +2266,9 @@ static int ipa3_wwan_probe(struct platform_device *pdev)
 		goto set_perf_err;
 	}
 
+	if (ipa3_rmnet_res.ipa_napi_enable)
+		napi_enable(&(rmnet_ipa3_ctx->wwan_priv->napi));
+
 	IPAWANDBG("IPA-WWAN devices (%s) initialization ok :>>>>\n", dev->name);
 	if (ret) {
 		IPAWANERR("default configuration failed rc=%d\n",
@@ -2278,6 +2329,10 @@ static int ipa3_wwan_remove(struct platform_device *pdev)
 	int ret;
 
 	pr_info("rmnet_ipa started deinitialization\n");
+	if (ipa3_rmnet_res.ipa_napi_enable) {
+		napi_disable(&(rmnet_ipa3_ctx->wwan_priv->napi));
+		netif_napi_del(&(rmnet_ipa3_ctx->wwan_priv->napi));
+	}
 	mutex_lock(&rmnet_ipa3_ctx->pipe_handle_guard);
 	ret = ipa3_teardown_sys_pipe(rmnet_ipa3_ctx->ipa3_to_apps_hdl);
 	if (ret < 0)
@@ -541,27 +541,16 @@ static uint64_t legacy_agg_scheme(struct msm_bus_node_device_type *bus_dev,
 	return bw_max_hz;
 }
 
-static uint64_t aggregate_bus_req(struct msm_bus_node_device_type *bus_dev,
-									int ctx)
+static void aggregate_lnodes(struct msm_bus_node_device_type *bus_dev, int ctx)
 {
-	uint64_t bw_hz = 0;
 	int i;
-	struct msm_bus_node_device_type *fab_dev = NULL;
-	uint32_t agg_scheme;
 	uint64_t max_ib = 0;
 	uint64_t max_ab = 0;
 	uint64_t sum_ab = 0;
 
-	if (!bus_dev || !bus_dev->node_info->bus_device ||
-			!to_msm_bus_node(bus_dev->node_info->bus_device)) {
-		MSM_BUS_ERR("Bus node pointer is Invalid");
-		goto exit_agg_bus_req;
-	}
-
 	bus_dev->node_bw[ctx].max_ib_cl_name = NULL;
 	bus_dev->node_bw[ctx].max_ab_cl_name = NULL;
 
-	fab_dev = to_msm_bus_node(bus_dev->node_info->bus_device);
 	for (i = 0; i < bus_dev->num_lnodes; i++) {
 		if (bus_dev->lnode_list[i].lnode_ib[ctx] > max_ib)
 			bus_dev->node_bw[ctx].max_ib_cl_name =
@@ -580,6 +569,56 @@ static uint64_t aggregate_bus_req(struct msm_bus_node_device_type *bus_dev,
 	bus_dev->node_bw[ctx].sum_ab = sum_ab;
 	bus_dev->node_bw[ctx].max_ib = max_ib;
 	bus_dev->node_bw[ctx].max_ab = max_ab;
+}
+
+/*
+ * Fold a new vote on @lnode into the cached sum/max of @bus_dev, so that
+ * the lnode list only has to be walked again when the vote holding the
+ * max ib or max ab is lowered. Fabric nodes have their max values
+ * rewritten on commit and are always rescanned.
+ */
+static void update_node_bw(struct msm_bus_node_device_type *bus_dev,
+		struct link_node *lnode, int ctx, uint64_t ib, uint64_t ab)
+{
+	struct nodebw *bw = &bus_dev->node_bw[ctx];
+	uint64_t old_ib = lnode->lnode_ib[ctx];
+	uint64_t old_ab = lnode->lnode_ab[ctx];
+
+	lnode->lnode_ib[ctx] = ib;
+	lnode->lnode_ab[ctx] = ab;
+
+	if (bus_dev->node_info->is_fab_dev ||
+		(ib < old_ib && old_ib == bw->max_ib) ||
+		(ab < old_ab && old_ab == bw->max_ab)) {
+		aggregate_lnodes(bus_dev, ctx);
+		return;
+	}
+
+	bw->sum_ab = bw->sum_ab - old_ab + ab;
+	if (ib > bw->max_ib) {
+		bw->max_ib = ib;
+		bw->max_ib_cl_name = lnode->cl_name;
+	}
+	if (ab > bw->max_ab) {
+		bw->max_ab = ab;
+		bw->max_ab_cl_name = lnode->cl_name;
+	}
+}
+
+static uint64_t aggregate_bus_req(struct msm_bus_node_device_type *bus_dev,
+									int ctx)
+{
+	uint64_t bw_hz = 0;
+	struct msm_bus_node_device_type *fab_dev = NULL;
+	uint32_t agg_scheme;
+
+	if (!bus_dev || !bus_dev->node_info->bus_device ||
+			!to_msm_bus_node(bus_dev->node_info->bus_device)) {
+		MSM_BUS_ERR("Bus node pointer is Invalid");
+		goto exit_agg_bus_req;
+	}
+
+	fab_dev = to_msm_bus_node(bus_dev->node_info->bus_device);
 
 	if (bus_dev->node_info->agg_params.agg_scheme != AGG_SCHEME_NONE)
 		agg_scheme = bus_dev->node_info->agg_params.agg_scheme;
@@ -704,6 +743,13 @@ static int update_path(struct device *src_dev, int dest, uint64_t act_req_ib,
 	int ret = 0;
 	struct rule_update_path_info *rule_node;
 	bool rules_registered = msm_rule_are_rules_registered();
+	uint64_t req_ib[NUM_CTX];
+	uint64_t req_ab[NUM_CTX];
+
+	req_ib[ACTIVE_CTX] = act_req_ib;
+	req_ab[ACTIVE_CTX] = act_req_bw;
+	req_ib[DUAL_CTX] = slp_req_ib;
+	req_ab[DUAL_CTX] = slp_req_bw;
 
 	if (IS_ERR_OR_NULL(src_dev)) {
 		MSM_BUS_ERR("%s: No source device", __func__);
@@ -722,6 +768,8 @@ static int update_path(struct device *src_dev, int dest, uint64_t act_req_ib,
 
 	while (next_dev) {
 		int i;
+		bool changed = false;
+
 		dev_info = to_msm_bus_node(next_dev);
 
 		if (curr_idx >= dev_info->num_lnodes) {
@@ -738,18 +786,34 @@ static int update_path(struct device *src_dev, int dest, uint64_t act_req_ib,
 			ret = -ENXIO;
 			goto exit_update_path;
 		}
-		lnode->lnode_ib[ACTIVE_CTX] = act_req_ib;
-		lnode->lnode_ab[ACTIVE_CTX] = act_req_bw;
-		lnode->lnode_ib[DUAL_CTX] = slp_req_ib;
-		lnode->lnode_ab[DUAL_CTX] = slp_req_bw;
 
-		for (i = 0; i < NUM_CTX; i++)
-			dev_info->node_bw[i].cur_clk_hz =
-					aggregate_bus_req(dev_info, i);
+		/*
+		 * Every hop of the path carries the same vote, so if the
+		 * source lnode already holds it there is nothing to update.
+		 */
+		if (next_dev == src_dev &&
+			!memcmp(lnode->lnode_ib, req_ib, sizeof(req_ib)) &&
+			!memcmp(lnode->lnode_ab, req_ab, sizeof(req_ab)))
+			break;
+
+		for (i = 0; i < NUM_CTX; i++) {
+			struct nodebw *bw = &dev_info->node_bw[i];
+			uint64_t sum_ab = bw->sum_ab;
+			uint64_t max_ib = bw->max_ib;
+
+			update_node_bw(dev_info, lnode, i, req_ib[i],
+								req_ab[i]);
+			if (bw->sum_ab != sum_ab || bw->max_ib != max_ib) {
+				bw->cur_clk_hz = aggregate_bus_req(dev_info, i);
+				changed = true;
+			}
+		}
 
-		add_node_to_clist(dev_info);
+		/* The node's clock and RPM votes only follow sum(ab)/max(ib) */
+		if (changed)
+			add_node_to_clist(dev_info);
 
-		if (rules_registered) {
+		if (changed && rules_registered) {
 			rule_node = &dev_info->node_info->rule;
 			rule_node->id = dev_info->node_info->id;
 			rule_node->ib = dev_info->node_bw[ACTIVE_CTX].max_ib;
@@ -220,7 +220,39 @@ static int setrate_nodeclk(struct nodeclk *nclk, long rate)
 	return ret;
 }
 
-static int send_rpm_msg(struct msm_bus_node_device_type *ndev, int ctx)
+/*
+ * RPM votes produced by one msm_bus_commit_data() call, sent together
+ * through msm_rpm_send_message_batch() once every node has been flushed.
+ */
+struct rpm_batch {
+	struct msm_rpm_batch_msg *msgs;
+	struct msm_rpm_kvp *kvps;
+	int count;
+	int max;
+};
+
+static int queue_rpm_msg(struct rpm_batch *batch, int rpm_ctx, int rsc_type,
+			int rsc_id, struct msm_rpm_kvp *rpm_kvp)
+{
+	struct msm_rpm_batch_msg *msg;
+
+	if (!batch || batch->count >= batch->max)
+		return msm_rpm_send_message(rpm_ctx, rsc_type, rsc_id,
+						rpm_kvp, 1);
+
+	batch->kvps[batch->count] = *rpm_kvp;
+	msg = &batch->msgs[batch->count];
+	msg->set = rpm_ctx;
+	msg->rsc_type = rsc_type;
+	msg->rsc_id = rsc_id;
+	msg->kvp = &batch->kvps[batch->count];
+	msg->nelems = 1;
+	batch->count++;
+	return 0;
+}
+
+static int send_rpm_msg(struct msm_bus_node_device_type *ndev, int ctx,
+			struct rpm_batch *batch)
 {
 	int ret = 0;
 	int rsc_type;
@@ -245,8 +277,8 @@ static int send_rpm_msg(struct msm_bus_node_device_type *ndev, int ctx)
 
 	if (ndev->node_info->mas_rpm_id != -1) {
 		rsc_type = RPM_BUS_MASTER_REQ;
-		ret = msm_rpm_send_message(rpm_ctx, rsc_type,
-			ndev->node_info->mas_rpm_id, &rpm_kvp, 1);
+		ret = queue_rpm_msg(batch, rpm_ctx, rsc_type,
+			ndev->node_info->mas_rpm_id, &rpm_kvp);
 		if (ret) {
 			MSM_BUS_ERR("%s: Failed to send RPM message:",
 					__func__);
@@ -262,8 +294,8 @@ static int send_rpm_msg(struct msm_bus_node_device_type *ndev, int ctx)
 
 	if (ndev->node_info->slv_rpm_id != -1) {
 		rsc_type = RPM_BUS_SLAVE_REQ;
-		ret = msm_rpm_send_message(rpm_ctx, rsc_type,
-			ndev->node_info->slv_rpm_id, &rpm_kvp, 1);
+		ret = queue_rpm_msg(batch, rpm_ctx, rsc_type,
+			ndev->node_info->slv_rpm_id, &rpm_kvp);
 		if (ret) {
 			MSM_BUS_ERR("%s: Failed to send RPM message:",
 						__func__);
@@ -280,7 +312,8 @@ exit_send_rpm_msg:
 	return ret;
 }
 
-static int flush_bw_data(struct msm_bus_node_device_type *node_info, int ctx)
+static int flush_bw_data(struct msm_bus_node_device_type *node_info, int ctx,
+			struct rpm_batch *batch)
 {
 	int ret = 0;
 
@@ -313,7 +346,7 @@ static int flush_bw_data(struct msm_bus_node_device_type *node_info, int ctx)
 							fabdev->qos_off,
 							fabdev->qos_freq);
 		} else {
-			ret = send_rpm_msg(node_info, ctx);
+			ret = send_rpm_msg(node_info, ctx, batch);
 
 			if (ret)
 				MSM_BUS_ERR("%s: Failed to send RPM msg for%d",
@@ -480,8 +513,10 @@ int msm_bus_commit_data(struct list_head *clist)
 {
 	int ret = 0;
 	int ctx;
+	int nnodes = 0;
 	struct msm_bus_node_device_type *node;
 	struct msm_bus_node_device_type *node_tmp;
+	struct rpm_batch batch = {0};
 
 	list_for_each_entry(node, clist, link) {
 		/* Aggregate the bus clocks */
@@ -489,8 +524,16 @@ int msm_bus_commit_data(struct list_head *clist)
 			msm_bus_agg_fab_clks(node);
 			msm_bus_log_fab_max_votes(node);
 		}
+		nnodes++;
 	}
 
+	/* Each node may vote once as master and once as slave per context */
+	batch.max = nnodes * NUM_CTX * 2;
+	batch.msgs = kcalloc(batch.max, sizeof(*batch.msgs), GFP_KERNEL);
+	batch.kvps = kcalloc(batch.max, sizeof(*batch.kvps), GFP_KERNEL);
+	if (!batch.msgs || !batch.kvps)
+		batch.max = 0;
+
 	list_for_each_entry_safe(node, node_tmp, clist, link) {
 		if (unlikely(node->node_info->defer_qos))
 				msm_bus_dev_init_qos(&node->dev, NULL);
@@ -500,7 +543,7 @@ int msm_bus_commit_data(struct list_head *clist)
 			if (ret)
 				MSM_BUS_ERR("%s: Err flushing clk data for:%d",
 						__func__, node->node_info->id);
-			ret = flush_bw_data(node, ctx);
+			ret = flush_bw_data(node, ctx, &batch);
 			if (ret)
 				MSM_BUS_ERR("%s: Error flushing bw data for %d",
 					__func__, node->node_info->id);
@@ -508,6 +551,15 @@ int msm_bus_commit_data(struct list_head *clist)
 		node->dirty = false;
 		list_del_init(&node->link);
 	}
+
+	if (batch.count) {
+		ret = msm_rpm_send_message_batch(batch.msgs, batch.count);
+		if (ret)
+			MSM_BUS_ERR("%s: Failed to send %d RPM bw votes",
+				__func__, batch.count);
+	}
+	kfree(batch.kvps);
+	kfree(batch.msgs);
 	return ret;
 }
 
@@ -582,25 +582,38 @@ static ssize_t qpnp_hap_dump_regs_show(struct device *dev,
 }
 
 /* play irq handler */
-static irqreturn_t qpnp_hap_play_irq(int irq, void *_hap)
+/*
+ * Load the shadow wave samples into WAVE_SAMPLE1 to WAVE_SAMPLE8.
+ * wave_samp mirrors what the registers hold, so only samples that
+ * changed are written. Must be called with wf_lock held.
+ */
+static int qpnp_hap_wf_load(struct qpnp_hap *hap)
 {
-	struct qpnp_hap *hap = _hap;
 	int i, rc;
 	u8 reg;
 
-	mutex_lock(&hap->wf_lock);
-
-	/* Configure WAVE_SAMPLE1 to WAVE_SAMPLE8 register */
-	for (i = 0; i < QPNP_HAP_WAV_SAMP_LEN && hap->wf_update; i++) {
-		reg = hap->wave_samp[i] = hap->shadow_wave_samp[i];
+	for (i = 0; i < QPNP_HAP_WAV_SAMP_LEN; i++) {
+		if (hap->wave_samp[i] == hap->shadow_wave_samp[i])
+			continue;
+		reg = hap->shadow_wave_samp[i];
 		rc = qpnp_hap_write_reg(hap, &reg,
 			QPNP_HAP_WAV_S_REG_BASE(hap->base) + i);
 		if (rc)
-			goto unlock;
+			return rc;
+		hap->wave_samp[i] = reg;
 	}
 	hap->wf_update = false;
 
-unlock:
+	return 0;
+}
+
+static irqreturn_t qpnp_hap_play_irq(int irq, void *_hap)
+{
+	struct qpnp_hap *hap = _hap;
+
+	mutex_lock(&hap->wf_lock);
+	if (hap->wf_update)
+		qpnp_hap_wf_load(hap);
 	mutex_unlock(&hap->wf_lock);
 
 	return IRQ_HANDLED;
@@ -1102,11 +1115,21 @@ static ssize_t qpnp_hap_wf_update_store(struct device *dev,
 	struct qpnp_hap *hap = container_of(timed_dev, struct qpnp_hap,
 					 timed_dev);
 
+	int rc = 0;
+
 	mutex_lock(&hap->wf_lock);
 	hap->wf_update = true;
+	/*
+	 * While the motor is idle preload the new samples right away, so
+	 * that the next play only needs the PLAY register write instead
+	 * of reprogramming the buffer from the play irq.
+	 */
+	if (hap->play_mode == QPNP_HAP_BUFFER && hap->buffer_cfg_state &&
+			!hap->state)
+		rc = qpnp_hap_wf_load(hap);
 	mutex_unlock(&hap->wf_lock);
 
-	return count;
+	return rc ? rc : count;
 }
 
 /* sysfs show for wave repeat */
@@ -1680,6 +1680,52 @@ int sps_transfer_one(struct sps_pipe *h, phys_addr_t addr, u32 size,
 }
 EXPORT_SYMBOL(sps_transfer_one);
 
+/**
+ * Queue a batch of DMA transfers on an SPS connection end point
+ *
+ */
+int sps_transfer_batch(struct sps_pipe *h, struct sps_iovec *iovec,
+		       void **user, u32 count)
+{
+	struct sps_pipe *pipe = h;
+	struct sps_bam *bam;
+	int result;
+	u32 i;
+
+	if (h == NULL) {
+		SPS_ERR(sps, "sps:%s:pipe is NULL.\n", __func__);
+		return SPS_ERROR;
+	} else if (iovec == NULL) {
+		SPS_ERR(sps, "sps:%s:iovec list is NULL.\n", __func__);
+		return SPS_ERROR;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (iovec[i].size > SPS_IOVEC_MAX_SIZE) {
+			SPS_ERR(sps,
+				"sps:%s:iovec size is invalid.\n", __func__);
+			return SPS_ERROR;
+		}
+
+		if (sps_check_iovec_flags(iovec[i].flags))
+			return SPS_ERROR;
+	}
+
+	bam = sps_bam_lock(pipe);
+	if (bam == NULL)
+		return SPS_ERROR;
+
+	SPS_DBG(bam, "sps:%s; %d descriptors.\n", __func__, count);
+
+	result = sps_bam_pipe_transfer_batch(bam, pipe->pipe_index, iovec,
+					     user, count);
+
+	sps_bam_unlock(bam);
+
+	return result;
+}
+EXPORT_SYMBOL(sps_transfer_batch);
+
 /**
  * Read event queue for an SPS connection end point
  *
@@ -1889,6 +1935,40 @@ int sps_set_config(struct sps_pipe *h, struct sps_connect *config)
 }
 EXPORT_SYMBOL(sps_set_config);
 
+/**
+ * Switch an SPS connection end point between interrupt and polling mode
+ *
+ */
+int sps_set_poll_mode(struct sps_pipe *h, bool poll)
+{
+	struct sps_pipe *pipe = h;
+	struct sps_bam *bam;
+
+	if (h == NULL) {
+		SPS_ERR(sps, "sps:%s:pipe is NULL.\n", __func__);
+		return SPS_ERROR;
+	}
+
+	bam = sps_bam_lock(pipe);
+	if (bam == NULL) {
+		SPS_ERR(sps, "sps:%s:BAM is NULL.\n", __func__);
+		return SPS_ERROR;
+	}
+
+	SPS_DBG(bam, "sps:%s; BAM: %pa; pipe index:%d, poll:%d.\n",
+		__func__, BAM_ID(bam), pipe->pipe_index, poll);
+
+	sps_bam_pipe_set_poll(bam, pipe->pipe_index, poll);
+	if (poll)
+		pipe->connect.options |= SPS_O_POLL;
+	else
+		pipe->connect.options &= ~SPS_O_POLL;
+	sps_bam_unlock(bam);
+
+	return 0;
+}
+EXPORT_SYMBOL(sps_set_poll_mode);
+
 /**
  * Set ownership of an SPS connection end point
  *
@@ -2369,6 +2449,40 @@ int sps_get_iovec(struct sps_pipe *h, struct sps_iovec *iovec)
 }
 EXPORT_SYMBOL(sps_get_iovec);
 
+/**
+ * Get a batch of processed I/O vectors (completed transfers)
+ *
+ */
+int sps_get_iovecs(struct sps_pipe *h, struct sps_iovec *iovec, u32 max,
+		   u32 *count)
+{
+	struct sps_pipe *pipe = h;
+	struct sps_bam *bam;
+	int result;
+
+	if (h == NULL) {
+		SPS_ERR(sps, "sps:%s:pipe is NULL.\n", __func__);
+		return SPS_ERROR;
+	} else if (iovec == NULL || count == NULL) {
+		SPS_ERR(sps, "sps:%s:iovec or count pointer is NULL.\n",
+			__func__);
+		return SPS_ERROR;
+	}
+
+	bam = sps_bam_lock(pipe);
+	if (bam == NULL) {
+		SPS_ERR(sps, "sps:%s:BAM is not found by handle.\n", __func__);
+		return SPS_ERROR;
+	}
+
+	result = sps_bam_pipe_get_iovecs(bam, pipe->pipe_index, iovec, max,
+					 count);
+	sps_bam_unlock(bam);
+
+	return result;
+}
+EXPORT_SYMBOL(sps_get_iovecs);
+
 /**
  * Perform timer control
  *
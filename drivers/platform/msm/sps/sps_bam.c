@@ -1554,6 +1554,21 @@ int sps_bam_pipe_transfer_one(struct sps_bam *dev,
 	return 0;
 }
 
+/* Number of descriptors that can be queued on a system-mode pipe */
+static u32 pipe_free_desc_count(struct sps_bam *dev, struct sps_pipe *pipe)
+{
+	u32 count;
+
+	if (!pipe->sys.ack_xfers && pipe->polled) {
+		sps_bam_pipe_get_unused_desc_num(dev, pipe->pipe_index,
+					&count);
+		count = pipe->desc_size / sizeof(struct sps_iovec) - count - 1;
+	} else
+		sps_bam_get_free_count(dev, pipe->pipe_index, &count);
+
+	return count;
+}
+
 /**
  * Submit a transfer to a BAM pipe
  *
@@ -1567,7 +1582,6 @@ int sps_bam_pipe_transfer(struct sps_bam *dev,
 	void *user;
 	int n;
 	int result;
-	struct sps_pipe *pipe = dev->pipes[pipe_index];
 
 	if (transfer->iovec_count == 0) {
 		SPS_ERR(dev, "sps:iovec count zero: BAM %pa pipe %d\n",
@@ -1575,13 +1589,7 @@ int sps_bam_pipe_transfer(struct sps_bam *dev,
 		return SPS_ERROR;
 	}
 
-	if (!pipe->sys.ack_xfers && pipe->polled) {
-		sps_bam_pipe_get_unused_desc_num(dev, pipe_index,
-					&count);
-		count = pipe->desc_size / sizeof(struct sps_iovec) - count - 1;
-	} else
-		sps_bam_get_free_count(dev, pipe_index, &count);
-
+	count = pipe_free_desc_count(dev, dev->pipes[pipe_index]);
 	if (count < transfer->iovec_count) {
 		SPS_ERR(dev,
 			"sps:Insufficient free desc: BAM %pa pipe %d: %d\n",
@@ -1611,6 +1619,57 @@ int sps_bam_pipe_transfer(struct sps_bam *dev,
 	return 0;
 }
 
+/**
+ * Queue a batch of independent descriptors on a BAM pipe
+ *
+ */
+int sps_bam_pipe_transfer_batch(struct sps_bam *dev, u32 pipe_index,
+				struct sps_iovec *iovec, void **user,
+				u32 count)
+{
+	struct sps_pipe *pipe = dev->pipes[pipe_index];
+	u32 start = pipe->sys.desc_offset;
+	u32 flags;
+	u32 n;
+	int result;
+
+	if (count == 0)
+		return 0;
+
+	if (pipe_free_desc_count(dev, pipe) < count) {
+		SPS_ERR(dev,
+			"sps:Insufficient free desc for batch: BAM %pa pipe %d: %d\n",
+			BAM_ID(dev), pipe_index, count);
+		return SPS_ERROR;
+	}
+
+	/* Only the last descriptor of the batch rings the doorbell */
+	for (n = 0; n < count; n++, iovec++) {
+		flags = iovec->flags;
+		if (n < count - 1)
+			flags |= SPS_IOVEC_FLAG_NO_SUBMIT;
+
+		result = sps_bam_pipe_transfer_one(dev, pipe_index,
+						 iovec->addr, iovec->size,
+						 user ? user[n] : NULL,
+						 flags);
+		if (result) {
+			/*
+			 * None of the queued descriptors reached the
+			 * hardware yet; take them back so the batch fails
+			 * as a whole.
+			 */
+			SPS_ERR(dev,
+				"sps:Batch failed at desc %d of %d: BAM %pa pipe %d\n",
+				n, count, BAM_ID(dev), pipe_index);
+			pipe->sys.desc_offset = start;
+			return SPS_ERROR;
+		}
+	}
+
+	return 0;
+}
+
 int sps_bam_pipe_inject_zlt(struct sps_bam *dev, u32 pipe_index)
 {
 	struct sps_pipe *pipe = dev->pipes[pipe_index];
@@ -2247,6 +2306,66 @@ int sps_bam_pipe_get_iovec(struct sps_bam *dev, u32 pipe_index,
 	return 0;
 }
 
+/**
+ * Get up to max processed I/O vectors
+ *
+ */
+int sps_bam_pipe_get_iovecs(struct sps_bam *dev, u32 pipe_index,
+			    struct sps_iovec *iovec, u32 max, u32 *count)
+{
+	struct sps_pipe *pipe = dev->pipes[pipe_index];
+	u32 read_offset;
+	u32 n = 0;
+
+	*count = 0;
+
+	/* Is this a valid pipe configured for get_iovec use? */
+	if (!pipe->sys.ack_xfers ||
+	    (pipe->state & BAM_STATE_BAM2BAM) != 0 ||
+	    (pipe->state & BAM_STATE_REMOTE)) {
+		return SPS_ERROR;
+	}
+
+	/* Poll the hardware once for the whole batch */
+	if ((pipe->polled || pipe->hybrid) && !pipe->sys.no_queue)
+		pipe_handler_eot(dev, pipe);
+
+	if (pipe->sys.no_queue)
+		read_offset =
+		bam_pipe_get_desc_read_offset(&dev->base, pipe_index);
+	else
+		read_offset = pipe->sys.cache_offset;
+
+	while (n < max && read_offset != pipe->sys.acked_offset) {
+		iovec[n++] = *(struct sps_iovec *) (pipe->sys.desc_buf +
+						    pipe->sys.acked_offset);
+#ifdef SPS_BAM_STATISTICS
+		pipe->sys.get_iovecs++;
+#endif /* SPS_BAM_STATISTICS */
+
+		pipe->sys.acked_offset += sizeof(struct sps_iovec);
+		if (pipe->sys.acked_offset >= pipe->desc_size)
+			pipe->sys.acked_offset = 0;
+	}
+
+	*count = n;
+
+	SPS_DBG(dev,
+		"sps:%s; pipe index:%d; %d iovecs; acked_offset:0x%x.\n",
+		__func__, pipe_index, n, pipe->sys.acked_offset);
+
+	return 0;
+}
+
+/**
+ * Switch a BAM pipe between interrupt and polled completion
+ *
+ */
+void sps_bam_pipe_set_poll(struct sps_bam *dev, u32 pipe_index, bool poll)
+{
+	pipe_set_irq(dev, pipe_index, poll);
+}
+
 /**
  * Determine whether a BAM pipe descriptor FIFO is empty
  *
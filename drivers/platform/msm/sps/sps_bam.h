@@ -461,6 +461,29 @@ int sps_bam_pipe_transfer_one(struct sps_bam *dev, u32 pipe_index, u32 addr,
 int sps_bam_pipe_transfer(struct sps_bam *dev, u32 pipe_index,
 			 struct sps_transfer *transfer);
 
+/**
+ * Submit a batch of descriptors to a BAM pipe
+ *
+ * This function queues count independent descriptors, each with its own
+ * user pointer, and rings the pipe doorbell once for the whole batch.
+ *
+ * @dev - pointer to BAM device descriptor
+ *
+ * @pipe_index - pipe index
+ *
+ * @iovec - array of count I/O vectors
+ *
+ * @user - array of count user pointers, or NULL
+ *
+ * @count - number of descriptors
+ *
+ * @return 0 on success, negative value on error
+ *
+ */
+int sps_bam_pipe_transfer_batch(struct sps_bam *dev, u32 pipe_index,
+				struct sps_iovec *iovec, void **user,
+				u32 count);
+
 /**
  * Get a BAM pipe event
  *
@@ -495,6 +518,39 @@ int sps_bam_pipe_get_event(struct sps_bam *dev, u32 pipe_index,
 int sps_bam_pipe_get_iovec(struct sps_bam *dev, u32 pipe_index,
 			   struct sps_iovec *iovec);
 
+/**
+ * Get processed I/O vectors
+ *
+ * This function fetches up to max processed I/O vectors, polling the
+ * hardware only once.
+ *
+ * @dev - pointer to BAM device descriptor
+ *
+ * @pipe_index - pipe index
+ *
+ * @iovec - array of at least max I/O vector structs (output)
+ *
+ * @max - maximum number of I/O vectors to fetch
+ *
+ * @count - number of I/O vectors fetched (output)
+ *
+ * @return 0 on success, negative value on error
+ */
+int sps_bam_pipe_get_iovecs(struct sps_bam *dev, u32 pipe_index,
+			    struct sps_iovec *iovec, u32 max, u32 *count);
+
+/**
+ * Switch a BAM pipe between interrupt and polled completion
+ *
+ * @dev - pointer to BAM device descriptor
+ *
+ * @pipe_index - pipe index
+ *
+ * @poll - true to mask the pipe interrupts, false to unmask them
+ *
+ */
+void sps_bam_pipe_set_poll(struct sps_bam *dev, u32 pipe_index, bool poll);
+
 /**
  * Determine whether a BAM pipe descriptor FIFO is empty
  *
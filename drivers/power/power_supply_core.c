@@ -30,6 +30,15 @@ EXPORT_SYMBOL_GPL(power_supply_notifier);
 
 static struct device_type power_supply_dev_type;
 
+/*
+ * Chargers and fuel gauges can call power_supply_changed() many times a
+ * second. The first change after a quiet period is dispatched right away;
+ * any further changes within this window are folded into a single
+ * notification at the end of it.
+ */
+static unsigned int change_coalesce_ms = 200;
+module_param(change_coalesce_ms, uint, S_IRUGO | S_IWUSR);
+
 static bool __power_supply_is_supplied_by(struct power_supply *supplier,
 					 struct power_supply *supply)
 {
@@ -303,7 +312,7 @@ static void power_supply_changed_work(struct work_struct *work)
 {
 	unsigned long flags;
 	struct power_supply *psy = container_of(work, struct power_supply,
-						changed_work);
+						changed_work.work);
 
 	dev_dbg(psy->dev, "%s\n", __func__);
 
@@ -317,6 +326,8 @@ static void power_supply_changed_work(struct work_struct *work)
 	 */
 	if (likely(psy->changed)) {
 		psy->changed = false;
+		psy->changed_last = jiffies;
+		psy->change_seq++;
 		spin_unlock_irqrestore(&psy->changed_lock, flags);
 		class_for_each_device(power_supply_class, NULL, psy,
 				      __power_supply_changed_work);
@@ -324,6 +335,7 @@ static void power_supply_changed_work(struct work_struct *work)
 		atomic_notifier_call_chain(&power_supply_notifier,
 				PSY_EVENT_PROP_CHANGED, psy);
 		kobject_uevent(&psy->dev->kobj, KOBJ_CHANGE);
+		sysfs_notify(&psy->dev->kobj, NULL, "change_seq");
 		spin_lock_irqsave(&psy->changed_lock, flags);
 	}
 
@@ -339,15 +351,20 @@ static void power_supply_changed_work(struct work_struct *work)
 
 void power_supply_changed(struct power_supply *psy)
 {
-	unsigned long flags;
+	unsigned long flags, next, delay = 0;
 
 	dev_dbg(psy->dev, "%s\n", __func__);
 
 	spin_lock_irqsave(&psy->changed_lock, flags);
 	psy->changed = true;
 	pm_stay_awake(psy->dev);
+	if (change_coalesce_ms && psy->change_seq) {
+		next = psy->changed_last + msecs_to_jiffies(change_coalesce_ms);
+		if (time_before(jiffies, next))
+			delay = next - jiffies;
+	}
 	spin_unlock_irqrestore(&psy->changed_lock, flags);
-	schedule_work(&psy->changed_work);
+	schedule_delayed_work(&psy->changed_work, delay);
 }
 EXPORT_SYMBOL_GPL(power_supply_changed);
 
@@ -832,7 +849,7 @@ static int __power_supply_register(struct device *parent,
 	if (rc)
 		goto dev_set_name_failed;
 
-	INIT_WORK(&psy->changed_work, power_supply_changed_work);
+	INIT_DELAYED_WORK(&psy->changed_work, power_supply_changed_work);
 
 	rc = power_supply_check_supplies(psy);
 	if (rc) {
@@ -894,7 +911,7 @@ EXPORT_SYMBOL_GPL(power_supply_register_no_ws);
 void power_supply_unregister(struct power_supply *psy)
 {
 	WARN_ON(atomic_dec_return(&psy->use_cnt));
-	cancel_work_sync(&psy->changed_work);
+	cancel_delayed_work_sync(&psy->changed_work);
 	sysfs_remove_link(&psy->dev->kobj, "powers");
 	power_supply_remove_triggers(psy);
 	psy_unregister_cooler(psy);
@@ -352,8 +352,32 @@ static struct attribute_group power_supply_attr_group = {
 	.is_visible = power_supply_attr_is_visible,
 };
 
+/*
+ * Counts dispatched change notifications. Userspace can poll() this
+ * attribute instead of parsing every uevent; it is sysfs_notify()'d once
+ * per coalesced change.
+ */
+static ssize_t change_seq_show(struct device *dev,
+			       struct device_attribute *attr, char *buf)
+{
+	struct power_supply *psy = dev_get_drvdata(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", ACCESS_ONCE(psy->change_seq));
+}
+static DEVICE_ATTR_RO(change_seq);
+
+static struct attribute *power_supply_misc_attrs[] = {
+	&dev_attr_change_seq.attr,
+	NULL,
+};
+
+static struct attribute_group power_supply_misc_attr_group = {
+	.attrs = power_supply_misc_attrs,
+};
+
 static const struct attribute_group *power_supply_attr_groups[] = {
 	&power_supply_attr_group,
+	&power_supply_misc_attr_group,
 	NULL,
 };
 
@@ -278,6 +278,24 @@ static struct fg_mem_data fg_data[FG_DATA_MAX] = {
 	DATA(BATT_ID_INFO,    0x594,   3,      1,     -EINVAL),
 };
 
+/*
+ * All of fg_data lives in 0x540 - 0x5D3. Instead of one memif transaction
+ * per item, update_sram_data() pulls these bursts into a shadow copy of
+ * the window and decodes every item from it.
+ */
+#define FG_SHADOW_BASE		0x540
+#define FG_SHADOW_LEN		0x94
+
+struct fg_shadow_burst {
+	u16	address;
+	u8	len;
+};
+
+static const struct fg_shadow_burst fg_shadow_bursts[] = {
+	{ 0x540, 0x58 },	/* CPRED_VOLTAGE .. BATT_ID_INFO */
+	{ 0x5CC, 0x08 },	/* VOLTAGE, CURRENT */
+};
+
 enum fg_mem_backup_index {
 	FG_BACKUP_SOC = 0,
 	FG_BACKUP_CYCLE_COUNT,
@@ -335,6 +353,11 @@ module_param_named(
 	sram_update_period_ms, fg_sram_update_period_ms, int, S_IRUSR | S_IWUSR
 );
 
+static int fg_sram_min_update_ms = 1000;
+module_param_named(
+	sram_min_update_ms, fg_sram_min_update_ms, int, S_IRUSR | S_IWUSR
+);
+
 static bool fg_batt_valid_ocv;
 module_param_named(batt_valid_ocv, fg_batt_valid_ocv, bool, S_IRUSR | S_IWUSR);
 
@@ -554,6 +577,9 @@ struct fg_chip {
 	const char		*batt_type;
 	const char		*batt_psy_name;
 	unsigned long		last_sram_update_time;
+	u8			sram_shadow[FG_SHADOW_LEN];
+	bool			sram_shadow_valid;
+	unsigned long		sram_shadow_jiffies;
 	unsigned long		last_temp_update_time;
 	int64_t			ocv_coeffs[12];
 	int64_t			cutoff_voltage;
@@ -2544,10 +2570,33 @@ static int64_t twos_compliment_extend(int64_t val, int nbytes)
 #define DECIKELVIN	2730
 #define SRAM_PERIOD_NO_ID_UPDATE_MS	100
 #define FULL_PERCENT_28BIT		0xFFFFFFF
+static int fg_refresh_sram_shadow(struct fg_chip *chip)
+{
+	const struct fg_shadow_burst *burst;
+	int i, rc = 0;
+
+	chip->sram_shadow_valid = false;
+	for (i = 0; i < ARRAY_SIZE(fg_shadow_bursts); i++) {
+		burst = &fg_shadow_bursts[i];
+		rc = fg_mem_read(chip,
+			&chip->sram_shadow[burst->address - FG_SHADOW_BASE],
+			burst->address, burst->len, 0, 0);
+		if (rc) {
+			pr_err("Failed to read sram burst 0x%03x rc=%d\n",
+				burst->address, rc);
+			return rc;
+		}
+	}
+
+	chip->sram_shadow_valid = true;
+	chip->sram_shadow_jiffies = jiffies;
+	return 0;
+}
+
 static int update_sram_data(struct fg_chip *chip, int *resched_ms)
 {
 	int i, j, rc = 0;
-	u8 reg[4];
+	u8 *reg;
 	int64_t temp;
 	int battid_valid = fg_is_batt_id_valid(chip);
 
@@ -2556,15 +2605,15 @@ static int update_sram_data(struct fg_chip *chip, int *resched_ms)
 		goto resched;
 
 	fg_mem_lock(chip);
-	for (i = 1; i < FG_DATA_MAX; i++) {
+	rc = fg_refresh_sram_shadow(chip);
+	if (rc)
+		pr_err("Failed to update sram data\n");
+
+	for (i = 1; i < FG_DATA_MAX && !rc; i++) {
 		if (chip->profile_loaded && i >= FG_DATA_BATT_ID)
 			continue;
-		rc = fg_mem_read(chip, reg, fg_data[i].address,
-			fg_data[i].len, fg_data[i].offset, 0);
-		if (rc) {
-			pr_err("Failed to update sram data\n");
-			break;
-		}
+		reg = &chip->sram_shadow[fg_data[i].address - FG_SHADOW_BASE
+						+ fg_data[i].offset];
 
 		temp = 0;
 		for (j = 0; j < fg_data[i].len; j++)
@@ -4698,7 +4747,10 @@ static int fg_power_set_property(struct power_supply *psy,
 		rc = set_prop_jeita_temp(chip, FG_MEM_SOFT_HOT, val->intval);
 		break;
 	case POWER_SUPPLY_PROP_UPDATE_NOW:
-		if (val->intval)
+		/* Coalesce back-to-back refresh requests onto the shadow */
+		if (val->intval && !(chip->sram_shadow_valid &&
+				time_before(jiffies, chip->sram_shadow_jiffies +
+					msecs_to_jiffies(fg_sram_min_update_ms))))
 			update_sram_data(chip, &unused);
 		break;
 	case POWER_SUPPLY_PROP_IGNORE_FALSE_NEGATIVE_ISENSE:
@@ -6097,6 +6149,7 @@ try_again:
 	}
 
 	chip->fg_restarting = true;
+	chip->sram_shadow_valid = false;
 	/*
 	 * save the temperature if the sw rbias control is active so that there
 	 * is no gap of time when there is no valid temperature read after the
@@ -8392,6 +8445,7 @@ static void ima_error_recovery_work(struct work_struct *work)
 
 	/* Block SRAM access till FG reset is complete */
 	chip->block_sram_access = true;
+	chip->sram_shadow_valid = false;
 
 	/* Release the mutex to avoid deadlock while cancelling the works */
 	mutex_unlock(&chip->ima_recovery_lock);
@@ -204,11 +204,26 @@ static void ufs_qcom_ice_cfg_work(struct work_struct *work)
  * Return: -EINVAL in-case of an error
  *         0 otherwise
  */
+static void ufs_qcom_ice_invalidate_slot_cfg(struct ufs_qcom_host *qcom_host)
+{
+	if (qcom_host->ice.slot_cfg)
+		memset(qcom_host->ice.slot_cfg, 0,
+		       NUM_QCOM_ICE_CTRL_INFO_n_REGS *
+		       sizeof(*qcom_host->ice.slot_cfg));
+}
+
 int ufs_qcom_ice_init(struct ufs_qcom_host *qcom_host)
 {
 	struct device *ufs_dev = qcom_host->hba->dev;
 	int err;
 
+	/* the host controller was reset, forget what the slots held */
+	if (!qcom_host->ice.slot_cfg)
+		qcom_host->ice.slot_cfg = devm_kcalloc(ufs_dev,
+				NUM_QCOM_ICE_CTRL_INFO_n_REGS,
+				sizeof(*qcom_host->ice.slot_cfg), GFP_KERNEL);
+	ufs_qcom_ice_invalidate_slot_cfg(qcom_host);
+
 	err = qcom_host->ice.vops->init(qcom_host->ice.pdev,
 				qcom_host,
 				ufs_qcom_ice_error_cb);
@@ -299,6 +314,7 @@ int ufs_qcom_ice_cfg_start(struct ufs_qcom_host *qcom_host,
 	sector_t lba = 0;
 	unsigned int ctrl_info_val = 0;
 	unsigned int bypass = 0;
+	struct ufs_qcom_ice_slot_cfg *cfg = NULL;
 	struct request *req;
 	char cmd_op;
 
@@ -383,21 +399,37 @@ int ufs_qcom_ice_cfg_start(struct ufs_qcom_host *qcom_host,
 		(bypass & MASK_UFS_QCOM_ICE_CTRL_INFO_BYPASS)
 		 << OFFSET_UFS_QCOM_ICE_CTRL_INFO_BYPASS;
 
+	/*
+	 * The LBA changes with every request, but the key index and bypass
+	 * mode of a slot usually stay the same: skip rewriting those.
+	 */
+	if (qcom_host->ice.slot_cfg && slot < NUM_QCOM_ICE_CTRL_INFO_n_REGS)
+		cfg = &qcom_host->ice.slot_cfg[slot];
+
 	if (qcom_host->hw_ver.major < 0x2) {
 		ufshcd_writel(qcom_host->hba, lba,
 			     (REG_UFS_QCOM_ICE_CTRL_INFO_1_n + 8 * slot));
 
-		ufshcd_writel(qcom_host->hba, ctrl_info_val,
-			     (REG_UFS_QCOM_ICE_CTRL_INFO_2_n + 8 * slot));
+		if (!cfg || !cfg->valid || cfg->ctrl_info != ctrl_info_val)
+			ufshcd_writel(qcom_host->hba, ctrl_info_val,
+				     (REG_UFS_QCOM_ICE_CTRL_INFO_2_n + 8 * slot));
 	} else {
 		ufshcd_writel(qcom_host->hba, (lba & 0xFFFFFFFF),
 			     (REG_UFS_QCOM_ICE_CTRL_INFO_1_n + 16 * slot));
 
-		ufshcd_writel(qcom_host->hba, ((lba >> 32) & 0xFFFFFFFF),
-			     (REG_UFS_QCOM_ICE_CTRL_INFO_2_n + 16 * slot));
+		if (!cfg || !cfg->valid || cfg->lba_hi != upper_32_bits(lba))
+			ufshcd_writel(qcom_host->hba, ((lba >> 32) & 0xFFFFFFFF),
+				     (REG_UFS_QCOM_ICE_CTRL_INFO_2_n + 16 * slot));
+
+		if (!cfg || !cfg->valid || cfg->ctrl_info != ctrl_info_val)
+			ufshcd_writel(qcom_host->hba, ctrl_info_val,
+				     (REG_UFS_QCOM_ICE_CTRL_INFO_3_n + 16 * slot));
+	}
 
-		ufshcd_writel(qcom_host->hba, ctrl_info_val,
-			     (REG_UFS_QCOM_ICE_CTRL_INFO_3_n + 16 * slot));
+	if (cfg) {
+		cfg->ctrl_info = ctrl_info_val;
+		cfg->lba_hi = upper_32_bits(lba);
+		cfg->valid = true;
 	}
 
 	/*
@@ -467,6 +499,8 @@ int ufs_qcom_ice_reset(struct ufs_qcom_host *qcom_host)
 	if (qcom_host->ice.state != UFS_QCOM_ICE_STATE_ACTIVE)
 		goto out;
 
+	ufs_qcom_ice_invalidate_slot_cfg(qcom_host);
+
 	if (qcom_host->ice.vops->reset) {
 		err = qcom_host->ice.vops->reset(qcom_host->ice.pdev);
 		if (err) {
@@ -517,6 +551,8 @@ int ufs_qcom_ice_resume(struct ufs_qcom_host *qcom_host)
 		return -EINVAL;
 	}
 
+	ufs_qcom_ice_invalidate_slot_cfg(qcom_host);
+
 	if (qcom_host->ice.vops->resume) {
 		err = qcom_host->ice.vops->resume(qcom_host->ice.pdev);
 		if (err) {
@@ -31,6 +31,16 @@ enum {
 };
 #define NUM_QCOM_ICE_CTRL_INFO_n_REGS		32
 
+/*
+ * Shadow of the CTRL_INFO registers of a slot, so that the key index,
+ * bypass and upper LBA words are only rewritten when they change.
+ */
+struct ufs_qcom_ice_slot_cfg {
+	u32 ctrl_info;
+	u32 lba_hi;
+	bool valid;
+};
+
 /* UFS QCOM ICE CTRL Info register offset */
 enum {
 	OFFSET_UFS_QCOM_ICE_CTRL_INFO_BYPASS     = 0,
@@ -207,6 +207,7 @@ struct ufs_qcom_bus_vote {
  *       ufs-qcom-ice.h for possible internal states)
  * @quirks:     UFS-ICE interface related quirks
  * @crypto_engine_err: crypto engine errors
+ * @slot_cfg:	ICE configuration last written for each transfer request slot
  */
 struct ufs_qcom_ice_data {
 	struct qcom_ice_variant_ops *vops;
@@ -216,6 +217,7 @@ struct ufs_qcom_ice_data {
 	u16 quirks;
 
 	bool crypto_engine_err;
+	struct ufs_qcom_ice_slot_cfg *slot_cfg;
 };
 
 /* Host controller hardware version: major.minor.step */
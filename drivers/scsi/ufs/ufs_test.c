@@ -99,6 +99,8 @@ enum ufs_test_testcases {
 	UFS_TEST_PARALLEL_READ_AND_WRITE,
 	UFS_TEST_LUN_DEPTH,
 
+	UFS_TEST_BENCHMARK,
+
 	NUM_TESTS,
 };
 
@@ -254,6 +256,8 @@ static char *ufs_test_get_test_case_str(int testcase)
 		return "UFS parallel read and write test";
 	case UFS_TEST_LUN_DEPTH:
 		return "UFS LUN depth test";
+	case UFS_TEST_BENCHMARK:
+		return "UFS benchmark";
 	}
 	return "Unknown test";
 }
@@ -441,6 +445,16 @@ static int ufs_test_show(struct seq_file *file, int test_case)
 		 "The test will test for each iteration once only reads and "
 		 "once only writes.\n";
 		break;
+	case UFS_TEST_BENCHMARK:
+		test_description = "\nufs_test_benchmark\n"
+		 "=========\n"
+		 "Description:\n"
+		 "This test issues the request mix configured in "
+		 "utils/bench (read/write, random/sequential and sync/async "
+		 "ratios, request size, queue depth and seed) and reports "
+		 "throughput, IOPS and p50/p99/p99.9 latency in "
+		 "utils/bench/results.\n";
+		break;
 	default:
 		test_description = "Unknown test";
 	}
@@ -1188,6 +1202,12 @@ static int long_seq_test_calc_throughput(struct test_iosched *test_iosched)
 	return ufs_test_post(test_iosched);
 }
 
+static int ufs_test_bench_post(struct test_iosched *test_iosched)
+{
+	test_iosched_bench_report(test_iosched);
+	return ufs_test_post(test_iosched);
+}
+
 static bool ufs_data_integrity_completion(struct test_iosched *test_iosched)
 {
 	struct ufs_test_data *utd = test_iosched->blk_dev_test_data;
@@ -1357,6 +1377,13 @@ static ssize_t ufs_test_write(struct file *file, const char __user *buf,
 	case UFS_TEST_LUN_DEPTH:
 		utd->test_info.run_test_fn = ufs_test_run_lun_depth_test;
 		break;
+	case UFS_TEST_BENCHMARK:
+		utd->test_info.timeout_msec = TEST_BENCH_TIMEOUT_MS;
+		utd->test_info.run_test_fn = test_iosched_bench_run;
+		utd->test_info.post_test_fn = ufs_test_bench_post;
+		utd->test_info.check_test_completion_fn =
+			test_iosched_bench_check_completion;
+		break;
 	default:
 		pr_err("%s: Unknown test-case: %d", __func__, test_case);
 		WARN_ON(true);
@@ -1394,6 +1421,7 @@ TEST_OPS(long_sequential_write, LONG_SEQUENTIAL_WRITE);
 TEST_OPS(long_sequential_mixed, LONG_SEQUENTIAL_MIXED);
 TEST_OPS(parallel_read_and_write, PARALLEL_READ_AND_WRITE);
 TEST_OPS(lun_depth, LUN_DEPTH);
+TEST_OPS(benchmark, BENCHMARK);
 
 static void ufs_test_debugfs_cleanup(struct test_iosched *test_iosched)
 {
@@ -1462,6 +1490,9 @@ static int ufs_test_debugfs_init(struct ufs_test_data *utd)
 	if (ret)
 		goto exit_err;
 	add_test(utd, lun_depth, LUN_DEPTH);
+	if (ret)
+		goto exit_err;
+	ret = add_test(utd, benchmark, BENCHMARK);
 	if (ret)
 		goto exit_err;
 
@@ -360,6 +360,9 @@ static int ufshcd_pltfrm_probe(struct platform_device *pdev)
 
 	ufshcd_parse_pm_levels(hba);
 
+	hba->use_blk_mq = of_property_read_bool(dev->of_node,
+						"qcom,use-blk-mq");
+
 	if (!dev->dma_mask)
 		dev->dma_mask = &dev->coherent_dma_mask;
 
@@ -40,6 +40,7 @@
 #include <linux/async.h>
 #include <scsi/ufs/ioctl.h>
 #include <linux/devfreq.h>
+#include "governor.h"
 #include <linux/nls.h>
 #include <linux/of.h>
 #include <linux/blkdev.h>
@@ -393,6 +394,15 @@ static void *gov_data = &ufshcd_ondemand_data;
 static void *gov_data;
 #endif
 
+/*
+ * Besides busy time, a window whose requests saw this many outstanding
+ * requests on average, or moved this many bytes per request on average,
+ * is reported fully busy so that deep queues and large sequential
+ * transfers scale up within one polling period.
+ */
+#define UFSHCD_CLK_SCALE_UP_DEPTH	4
+#define UFSHCD_CLK_SCALE_UP_REQ_SIZE	(256 * 1024)
+
 static struct devfreq_dev_profile ufs_devfreq_profile = {
 	.polling_ms	= 40,
 	.target		= ufshcd_devfreq_target,
@@ -1985,6 +1995,37 @@ static void ufshcd_clk_scaling_start_busy(struct ufs_hba *hba)
 	}
 }
 
+/*
+ * Must be called with host lock acquired, before the tag is set in
+ * outstanding_reqs.
+ */
+static void ufshcd_clk_scaling_account_req(struct ufs_hba *hba,
+		unsigned int task_tag)
+{
+	struct ufs_clk_scaling *scaling = &hba->clk_scaling;
+	struct scsi_cmnd *cmd = hba->lrb[task_tag].cmd;
+	struct request *rq;
+
+	if (!ufshcd_is_clkscaling_supported(hba) || !cmd)
+		return;
+
+	scaling->window_reqs++;
+	scaling->window_depth += hweight_long(hba->outstanding_reqs) + 1;
+	scaling->window_bytes += scsi_bufflen(cmd);
+
+	/*
+	 * A synchronous read issued at the low clock is waited on by
+	 * someone, scale up now rather than at the next polling window.
+	 */
+	rq = cmd->request;
+	if (rq && rq_data_dir(rq) == READ && (rq->cmd_flags & REQ_SYNC) &&
+	    !scaling->is_scaled_up && !scaling->boost &&
+	    scaling->is_allowed && !hba->pm_op_in_progress) {
+		scaling->boost = true;
+		queue_work(scaling->workq, &scaling->boost_work);
+	}
+}
+
 static void ufshcd_clk_scaling_update_busy(struct ufs_hba *hba)
 {
 	struct ufs_clk_scaling *scaling = &hba->clk_scaling;
@@ -2013,6 +2054,7 @@ int ufshcd_send_command(struct ufs_hba *hba, unsigned int task_tag)
 	hba->lrb[task_tag].issue_time_stamp = ktime_get();
 	hba->lrb[task_tag].complete_time_stamp = ktime_set(0, 0);
 	ufshcd_clk_scaling_start_busy(hba);
+	ufshcd_clk_scaling_account_req(hba, task_tag);
 	__set_bit(task_tag, &hba->outstanding_reqs);
 	ufshcd_writel(hba, 1 << task_tag, REG_UTP_TRANSFER_REQ_DOOR_BELL);
 	/* Make sure that doorbell is committed immediately */
@@ -4815,7 +4857,11 @@ static int ufshcd_slave_configure(struct scsi_device *sdev)
 	blk_queue_max_segment_size(q, PRDT_DATA_BYTE_COUNT_MAX);
 
 	sdev->autosuspend_delay = UFSHCD_AUTO_SUSPEND_DELAY_MS;
-	sdev->use_rpm_auto = 1;
+	/*
+	 * block layer runtime PM is request based and only tracks requests
+	 * on the legacy path, keep the device active when using scsi-mq
+	 */
+	sdev->use_rpm_auto = !shost_use_blk_mq(sdev->host);
 
 	return 0;
 }
@@ -8063,6 +8109,8 @@ static int ufshcd_suspend(struct ufs_hba *hba, enum ufs_pm_op pm_op)
 	if (hba->clk_scaling.is_allowed) {
 		cancel_work_sync(&hba->clk_scaling.suspend_work);
 		cancel_work_sync(&hba->clk_scaling.resume_work);
+		cancel_work_sync(&hba->clk_scaling.boost_work);
+		hba->clk_scaling.boost = false;
 		ufshcd_suspend_clkscaling(hba);
 	}
 
@@ -8975,6 +9023,8 @@ static ssize_t ufshcd_clkscale_enable_store(struct device *dev,
 
 	cancel_work_sync(&hba->clk_scaling.suspend_work);
 	cancel_work_sync(&hba->clk_scaling.resume_work);
+	cancel_work_sync(&hba->clk_scaling.boost_work);
+	hba->clk_scaling.boost = false;
 
 	hba->clk_scaling.is_allowed = value;
 
@@ -9028,6 +9078,27 @@ static void ufshcd_clk_scaling_resume_work(struct work_struct *work)
 	devfreq_resume_device(hba->devfreq);
 }
 
+static void ufshcd_clk_scaling_boost_work(struct work_struct *work)
+{
+	struct ufs_hba *hba = container_of(work, struct ufs_hba,
+					   clk_scaling.boost_work);
+	unsigned long irq_flags;
+
+	spin_lock_irqsave(hba->host->host_lock, irq_flags);
+	if (!hba->clk_scaling.boost || hba->clk_scaling.is_suspended ||
+	    hba->clk_scaling.is_scaled_up) {
+		hba->clk_scaling.boost = false;
+		spin_unlock_irqrestore(hba->host->host_lock, irq_flags);
+		return;
+	}
+	spin_unlock_irqrestore(hba->host->host_lock, irq_flags);
+
+	/* re-evaluate now, get_dev_status reports the boost as busy */
+	mutex_lock(&hba->devfreq->lock);
+	update_devfreq(hba->devfreq);
+	mutex_unlock(&hba->devfreq->lock);
+}
+
 static int ufshcd_devfreq_target(struct device *dev,
 				unsigned long *freq, u32 flags)
 {
@@ -9099,9 +9170,25 @@ static int ufshcd_devfreq_get_dev_status(struct device *dev,
 	stat->total_time = jiffies_to_usecs((long)jiffies -
 				(long)scaling->window_start_t);
 	stat->busy_time = scaling->tot_busy_t;
+
+	if (scaling->window_reqs &&
+	    (div_u64(scaling->window_depth, scaling->window_reqs) >=
+	     UFSHCD_CLK_SCALE_UP_DEPTH ||
+	     div_u64(scaling->window_bytes, scaling->window_reqs) >=
+	     UFSHCD_CLK_SCALE_UP_REQ_SIZE))
+		stat->busy_time = stat->total_time;
 start_window:
+	if (scaling->boost) {
+		stat->total_time = max_t(unsigned long, stat->total_time, 1);
+		stat->busy_time = stat->total_time;
+		scaling->boost = false;
+	}
+
 	scaling->window_start_t = jiffies;
 	scaling->tot_busy_t = 0;
+	scaling->window_reqs = 0;
+	scaling->window_depth = 0;
+	scaling->window_bytes = 0;
 
 	if (hba->outstanding_reqs) {
 		scaling->busy_start_t = ktime_get();
@@ -9260,6 +9347,15 @@ int ufshcd_init(struct ufs_hba *hba, void __iomem *mmio_base, unsigned int irq)
 		hba->is_irq_enabled = true;
 	}
 
+	/*
+	 * With scsi-mq the host wide tag set of can_queue (nutrs) tags maps
+	 * directly onto the UTRL slots, submission goes through per-cpu
+	 * software queues without the request queue lock and completions
+	 * are steered back to the submitting cpu.
+	 */
+	if (hba->use_blk_mq)
+		host->use_blk_mq = true;
+
 	/* Enable SCSI tag mapping */
 	err = scsi_init_shared_tag_map(host, host->can_queue);
 	if (err) {
@@ -9289,6 +9385,8 @@ int ufshcd_init(struct ufs_hba *hba, void __iomem *mmio_base, unsigned int irq)
 			  ufshcd_clk_scaling_suspend_work);
 		INIT_WORK(&hba->clk_scaling.resume_work,
 			  ufshcd_clk_scaling_resume_work);
+		INIT_WORK(&hba->clk_scaling.boost_work,
+			  ufshcd_clk_scaling_boost_work);
 
 		snprintf(wq_name, ARRAY_SIZE(wq_name), "ufs_clkscaling_%d",
 			 host->host_no);
@@ -488,15 +488,20 @@ struct ufs_clk_scaling {
 	unsigned long tot_busy_t;
 	unsigned long window_start_t;
 	ktime_t busy_start_t;
+	u32 window_reqs;
+	u64 window_depth;
+	u64 window_bytes;
 	struct device_attribute enable_attr;
 	struct ufs_saved_pwr_info saved_pwr_info;
 	struct workqueue_struct *workq;
 	struct work_struct suspend_work;
 	struct work_struct resume_work;
+	struct work_struct boost_work;
 	bool is_allowed;
 	bool is_busy_started;
 	bool is_suspended;
 	bool is_scaled_up;
+	bool boost;
 };
 
 /**
@@ -733,6 +738,7 @@ struct ufs_hba {
 	void *priv;
 	unsigned int irq;
 	bool is_irq_enabled;
+	bool use_blk_mq;
 
 	/* Interrupt aggregation support is broken */
 	#define UFSHCD_QUIRK_BROKEN_INTR_AGGR			UFS_BIT(0)
@@ -172,6 +172,7 @@ struct bam_ch_info {
 #define A2_PHYS_BASE		0x124C2000
 #define A2_PHYS_SIZE		0x2000
 #define DEFAULT_NUM_BUFFERS	32
+#define RX_POLL_BUDGET		16
 
 #ifndef A2_BAM_IRQ
 #define A2_BAM_IRQ -1
@@ -205,6 +206,7 @@ static int bam_mux_initialized;
 
 static int polling_mode;
 static unsigned long rx_timer_interval;
+static bool rx_refill_deferred;
 
 static LIST_HEAD(bam_rx_pool);
 static DEFINE_MUTEX(bam_rx_pool_mutexlock);
@@ -436,8 +438,16 @@ static void __queue_rx(gfp_t alloc_flags)
 		list_add_tail(&info->list_node, &bam_rx_pool);
 		rx_len_cached = ++bam_rx_pool_len;
 		current_buffer_size = buffer_size;
+		/*
+		 * Only the descriptor completing the pool updates the pipe's
+		 * write offset, which publishes the whole batch to the BAM at
+		 * once.  If the refill stops early, the rescheduled refill
+		 * publishes the descriptors queued so far.
+		 */
 		ret = bam_ops->sps_transfer_one_ptr(bam_rx_pipe,
-				info->dma_address, info->len, info, 0);
+				info->dma_address, info->len, info,
+				rx_len_cached < num_buffers ?
+					SPS_IOVEC_FLAG_NO_SUBMIT : 0);
 		if (ret) {
 			list_del(&info->list_node);
 			rx_len_cached = --bam_rx_pool_len;
@@ -471,6 +481,10 @@ fail:
 
 static void queue_rx(void)
 {
+	/* bam_dmux_rx_poll() refills once for the whole batch */
+	if (rx_refill_deferred)
+		return;
+
 	/*
 	 * Hot path.  Delays waiting for the allocation to find memory if its
 	 * not immediately available, and delays from logging allocation
@@ -1257,52 +1271,36 @@ int msm_bam_dmux_is_ch_low(uint32_t id)
 	return ret;
 }
 
-static void rx_switch_to_interrupt_mode(void)
+/**
+ * bam_dmux_rx_poll() - process completed rx descriptors
+ * @budget:	Maximum number of descriptors to process.
+ *
+ * Processes up to @budget received packets and then refills the rx pool for
+ * all of them in one go, instead of queueing a new descriptor to the BAM
+ * after every packet.  Must be called from the rx workqueue.
+ *
+ * Return: Number of descriptors processed.  Less than @budget means the pipe
+ *	   has been drained or an error occurred.
+ */
+static int bam_dmux_rx_poll(int budget)
 {
-	struct sps_connect cur_rx_conn;
 	struct sps_iovec iov;
 	struct rx_pkt_info *info;
+	int processed = 0;
 	int ret;
 
-	/*
-	 * Attempt to enable interrupts - if this fails,
-	 * continue polling and we will retry later.
-	 */
-	ret = bam_ops->sps_get_config_ptr(bam_rx_pipe, &cur_rx_conn);
-	if (ret) {
-		pr_err("%s: sps_get_config() failed %d\n", __func__, ret);
-		goto fail;
-	}
-
-	rx_register_event.options = SPS_O_EOT;
-	ret = bam_ops->sps_register_event_ptr(bam_rx_pipe, &rx_register_event);
-	if (ret) {
-		pr_err("%s: sps_register_event() failed %d\n", __func__, ret);
-		goto fail;
-	}
-
-	cur_rx_conn.options = SPS_O_AUTO_ENABLE |
-		SPS_O_EOT | SPS_O_ACK_TRANSFERS;
-	ret = bam_ops->sps_set_config_ptr(bam_rx_pipe, &cur_rx_conn);
-	if (ret) {
-		pr_err("%s: sps_set_config() failed %d\n", __func__, ret);
-		goto fail;
-	}
-	polling_mode = 0;
-	complete_all(&shutdown_completion);
-	release_wakelock();
-
-	/* handle any rx packets before interrupt was enabled */
-	while (bam_connection_is_active && !polling_mode) {
+	rx_refill_deferred = true;
+	while (processed < budget && bam_connection_is_active &&
+							!in_global_reset) {
 		ret = bam_ops->sps_get_iovec_ptr(bam_rx_pipe, &iov);
 		if (ret) {
-			pr_err("%s: sps_get_iovec failed %d\n",
+			DMUX_LOG_KERR("%s: sps_get_iovec failed %d\n",
 					__func__, ret);
 			break;
 		}
 		if (iov.addr == 0)
 			break;
-
+		++processed;
 		mutex_lock(&bam_rx_pool_mutexlock);
 		if (unlikely(list_empty(&bam_rx_pool))) {
 			DMUX_LOG_KERR("%s: have iovec %p but rx pool empty\n",
@@ -1331,6 +1329,52 @@ static void rx_switch_to_interrupt_mode(void)
 		info->sps_size = iov.size;
 		handle_bam_mux_cmd(&info->work);
 	}
+	rx_refill_deferred = false;
+
+	if (processed)
+		queue_rx();
+
+	return processed;
+}
+
+static void rx_switch_to_interrupt_mode(void)
+{
+	struct sps_connect cur_rx_conn;
+	int ret;
+
+	/*
+	 * Attempt to enable interrupts - if this fails,
+	 * continue polling and we will retry later.
+	 */
+	ret = bam_ops->sps_get_config_ptr(bam_rx_pipe, &cur_rx_conn);
+	if (ret) {
+		pr_err("%s: sps_get_config() failed %d\n", __func__, ret);
+		goto fail;
+	}
+
+	rx_register_event.options = SPS_O_EOT;
+	ret = bam_ops->sps_register_event_ptr(bam_rx_pipe, &rx_register_event);
+	if (ret) {
+		pr_err("%s: sps_register_event() failed %d\n", __func__, ret);
+		goto fail;
+	}
+
+	cur_rx_conn.options = SPS_O_AUTO_ENABLE |
+		SPS_O_EOT | SPS_O_ACK_TRANSFERS;
+	ret = bam_ops->sps_set_config_ptr(bam_rx_pipe, &cur_rx_conn);
+	if (ret) {
+		pr_err("%s: sps_set_config() failed %d\n", __func__, ret);
+		goto fail;
+	}
+	polling_mode = 0;
+	complete_all(&shutdown_completion);
+	release_wakelock();
+
+	/* handle any rx packets before interrupt was enabled */
+	while (bam_connection_is_active && !polling_mode) {
+		if (bam_dmux_rx_poll(RX_POLL_BUDGET) < RX_POLL_BUDGET)
+			break;
+	}
 	return;
 
 fail:
@@ -1366,9 +1410,8 @@ static void log_rx_timestamp(void)
 
 static void rx_timer_work_func(struct work_struct *work)
 {
-	struct sps_iovec iov;
-	struct rx_pkt_info *info;
 	int inactive_cycles = 0;
+	int processed;
 	int ret;
 	u32 buffs_unused, buffs_used;
 
@@ -1383,46 +1426,13 @@ static void rx_timer_work_func(struct work_struct *work)
 				return;
 			}
 
-			ret = bam_ops->sps_get_iovec_ptr(bam_rx_pipe, &iov);
-			if (ret) {
-				DMUX_LOG_KERR("%s: sps_get_iovec failed %d\n",
-						__func__, ret);
-				break;
+			processed = bam_dmux_rx_poll(RX_POLL_BUDGET);
+			if (processed) {
+				store_rx_timestamp();
+				inactive_cycles = 0;
 			}
-			if (iov.addr == 0)
+			if (processed < RX_POLL_BUDGET)
 				break;
-			store_rx_timestamp();
-			inactive_cycles = 0;
-			mutex_lock(&bam_rx_pool_mutexlock);
-			if (unlikely(list_empty(&bam_rx_pool))) {
-				DMUX_LOG_KERR(
-					"%s: have iovec %p but rx pool empty\n",
-					__func__, (void *)(uintptr_t)iov.addr);
-				mutex_unlock(&bam_rx_pool_mutexlock);
-				continue;
-			}
-			info = list_first_entry(&bam_rx_pool,
-					struct rx_pkt_info,	list_node);
-			if (info->dma_address != iov.addr) {
-				DMUX_LOG_KERR("%s: iovec %p != dma %p\n",
-					__func__,
-					(void *)(uintptr_t)iov.addr,
-					(void *)(uintptr_t)info->dma_address);
-				list_for_each_entry(info, &bam_rx_pool,
-						list_node) {
-					DMUX_LOG_KERR("%s: dma %p\n", __func__,
-						(void *)(uintptr_t)
-							info->dma_address);
-					if (iov.addr == info->dma_address)
-						break;
-				}
-			}
-			BUG_ON(info->dma_address != iov.addr);
-			list_del(&info->list_node);
-			--bam_rx_pool_len;
-			mutex_unlock(&bam_rx_pool_mutexlock);
-			info->sps_size = iov.size;
-			handle_bam_mux_cmd(&info->work);
 		}
 
 		if (inactive_cycles >= POLLING_INACTIVITY) {
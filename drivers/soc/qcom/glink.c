@@ -379,7 +379,11 @@ static int ch_pop_remote_rx_intent(struct channel_ctx *ctx, size_t size,
 			uint32_t *riid_ptr, size_t *intent_size, void **cookie);
 
 static struct glink_core_rx_intent *ch_push_local_rx_intent(
-		struct channel_ctx *ctx, const void *pkt_priv, size_t size);
+		struct channel_ctx *ctx, const void *pkt_priv, void *buf,
+		size_t size);
+
+static void ch_release_local_rx_intent_buf(struct channel_ctx *ctx,
+				struct glink_core_rx_intent *intent);
 
 static void ch_remove_local_rx_intent(struct channel_ctx *ctx, uint32_t liid);
 
@@ -1275,13 +1279,15 @@ void ch_push_remote_rx_intent(struct channel_ctx *ctx, size_t size,
  * ch_push_local_rx_intent() - Create an rx_intent
  * @ctx:	Local channel context
  * @pkt_priv:	Opaque private pointer provided by client to be returned later
+ * @buf:	Client provided buffer backing the intent, or NULL to have the
+ *		transport allocate one
  * @size:	Size of intent
  *
  * This functions creates a local intent and adds it to the local
  * intent list.
  */
 struct glink_core_rx_intent *ch_push_local_rx_intent(struct channel_ctx *ctx,
-		const void *pkt_priv, size_t size)
+		const void *pkt_priv, void *buf, size_t size)
 {
 	struct glink_core_rx_intent *intent;
 	unsigned long flags;
@@ -1313,9 +1319,19 @@ struct glink_core_rx_intent *ch_push_local_rx_intent(struct channel_ctx *ctx,
 		intent->id = ++ctx->max_used_liid;
 	}
 
-	/* transport is responsible for allocating/reserving for the intent */
-	ret = ctx->transport_ptr->ops->allocate_rx_intent(
+	intent->client_buf = buf ? true : false;
+	if (buf) {
+		/* the transport writes rx data straight into the client buffer */
+		intent->data = buf;
+		intent->iovec = (void *)intent;
+		intent->vprovider = rx_linear_vbuf_provider;
+		intent->pprovider = NULL;
+		ret = 0;
+	} else {
+		/* transport is responsible for allocating/reserving the intent */
+		ret = ctx->transport_ptr->ops->allocate_rx_intent(
 					ctx->transport_ptr->ops, size, intent);
+	}
 	if (ret < 0) {
 		/* intent data allocation failure */
 		GLINK_ERR_CH(ctx, "%s: unable to allocate intent sz[%zu] %d",
@@ -1430,6 +1446,7 @@ struct glink_core_rx_intent *ch_get_dummy_rx_intent(struct channel_ctx *ctx,
 	intent->pkt_size = 0;
 	intent->bounce_buf = NULL;
 	intent->pkt_priv = NULL;
+	intent->client_buf = false;
 
 	spin_lock_irqsave(&ctx->local_rx_intent_lst_lock_lhc1, flags);
 	list_add_tail(&intent->list, &ctx->local_rx_intent_list);
@@ -1626,6 +1643,29 @@ struct glink_core_rx_intent *ch_get_free_local_rx_intent(
 	return ptr_intent;
 }
 
+/**
+ * ch_release_local_rx_intent_buf() - Release the buffer backing a rx intent
+ * @ctx:	Local channel context
+ * @intent:	Pointer to the rx intent
+ *
+ * Buffers allocated by the transport are handed back to it, buffers provided
+ * by the client through glink_queue_rx_intent_buf() are only detached from
+ * the intent since the client owns them.
+ */
+void ch_release_local_rx_intent_buf(struct channel_ctx *ctx,
+				struct glink_core_rx_intent *intent)
+{
+	if (intent->client_buf) {
+		intent->data = NULL;
+		intent->iovec = NULL;
+		intent->vprovider = NULL;
+		intent->client_buf = false;
+		return;
+	}
+	ctx->transport_ptr->ops->deallocate_rx_intent(
+					ctx->transport_ptr->ops, intent);
+}
+
 /**
  * ch_purge_intent_lists() - Remove all intents for a channel
  *
@@ -1654,8 +1694,7 @@ void ch_purge_intent_lists(struct channel_ctx *ctx)
 				&ctx->local_rx_intent_list, list) {
 		ctx->notify_rx_abort(ctx, ctx->user_priv,
 				ptr_intent->pkt_priv);
-		ctx->transport_ptr->ops->deallocate_rx_intent(
-					ctx->transport_ptr->ops, ptr_intent);
+		ch_release_local_rx_intent_buf(ctx, ptr_intent);
 		list_del(&ptr_intent->list);
 		kfree(ptr_intent);
 	}
@@ -3062,15 +3101,17 @@ int glink_tx(void *handle, void *pkt_priv, void *data, size_t size,
 EXPORT_SYMBOL(glink_tx);
 
 /**
- * glink_queue_rx_intent() - Register an intent to receive data.
+ * glink_queue_rx_intent_common() - Common code to register an rx intent
  *
  * @handle:	handle returned by glink_open()
  * @pkt_priv:	opaque data type that is returned when a packet is received
- * size:	maximum size of data to receive
+ * @buf:	client buffer to receive into, NULL to use a transport buffer
+ * @size:	maximum size of data to receive
  *
  * Return: 0 for success; standard Linux error code for failure case
  */
-int glink_queue_rx_intent(void *handle, const void *pkt_priv, size_t size)
+static int glink_queue_rx_intent_common(void *handle, const void *pkt_priv,
+					void *buf, size_t size)
 {
 	struct channel_ctx *ctx = (struct channel_ctx *)handle;
 	struct glink_core_rx_intent *intent_ptr;
@@ -3088,7 +3129,7 @@ int glink_queue_rx_intent(void *handle, const void *pkt_priv, size_t size)
 		return -EBUSY;
 	}
 
-	intent_ptr = ch_push_local_rx_intent(ctx, pkt_priv, size);
+	intent_ptr = ch_push_local_rx_intent(ctx, pkt_priv, buf, size);
 	if (!intent_ptr) {
 		GLINK_ERR_CH(ctx,
 			"%s: Intent pointer allocation failed size[%zu]\n",
@@ -3113,8 +3154,48 @@ int glink_queue_rx_intent(void *handle, const void *pkt_priv, size_t size)
 	glink_put_ch_ctx(ctx);
 	return ret;
 }
+
+/**
+ * glink_queue_rx_intent() - Register an intent to receive data.
+ *
+ * @handle:	handle returned by glink_open()
+ * @pkt_priv:	opaque data type that is returned when a packet is received
+ * size:	maximum size of data to receive
+ *
+ * Return: 0 for success; standard Linux error code for failure case
+ */
+int glink_queue_rx_intent(void *handle, const void *pkt_priv, size_t size)
+{
+	return glink_queue_rx_intent_common(handle, pkt_priv, NULL, size);
+}
 EXPORT_SYMBOL(glink_queue_rx_intent);
 
+/**
+ * glink_queue_rx_intent_buf() - Register a client buffer as an rx intent.
+ *
+ * @handle:	handle returned by glink_open()
+ * @pkt_priv:	opaque data type that is returned when a packet is received
+ * @buf:	buffer the received data is written to
+ * @size:	size of @buf
+ *
+ * The transport writes the received data directly into @buf, which is then
+ * passed to the notify_rx() callback.  The buffer remains owned by the client
+ * and must stay valid until it is returned through glink_rx_done() or the
+ * intent is aborted through the notify_rx_abort() callback.  Reusing the
+ * intent keeps the same buffer.
+ *
+ * Return: 0 for success; standard Linux error code for failure case
+ */
+int glink_queue_rx_intent_buf(void *handle, const void *pkt_priv, void *buf,
+			      size_t size)
+{
+	if (!buf || !size)
+		return -EINVAL;
+
+	return glink_queue_rx_intent_common(handle, pkt_priv, buf, size);
+}
+EXPORT_SYMBOL(glink_queue_rx_intent_buf);
+
 /**
  * glink_rx_intent_exists() - Check if an intent exists.
  *
@@ -3191,12 +3272,10 @@ int glink_rx_done(void *handle, const void *ptr, bool reuse)
 					__func__, ret, ptr);
 			ret = -ENOBUFS;
 			reuse = false;
-			ctx->transport_ptr->ops->deallocate_rx_intent(
-					ctx->transport_ptr->ops, liid_ptr);
+			ch_release_local_rx_intent_buf(ctx, liid_ptr);
 		}
 	} else {
-		ctx->transport_ptr->ops->deallocate_rx_intent(
-					ctx->transport_ptr->ops, liid_ptr);
+		ch_release_local_rx_intent_buf(ctx, liid_ptr);
 	}
 	ch_remove_local_rx_intent_notified(ctx, liid_ptr, reuse);
 	/* send rx done */
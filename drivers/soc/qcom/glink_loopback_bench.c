@@ -0,0 +1,344 @@
+/* Copyright (c) 2018, The Linux Foundation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * G-Link loopback round-trip benchmark.
+ *
+ * Acts as a client of the G-Link loopback server protocol: it asks the
+ * server to open a data channel that echoes every packet back once, then
+ * times tx -> echoed rx round trips on that channel. By default it talks
+ * to the apps loopback server over the local loopback transport; edge,
+ * transport and control channel can be changed to reach a server running
+ * on a remote processor.
+ */
+
+#define pr_fmt(fmt) "glink_bench: " fmt
+
+#include <linux/completion.h>
+#include <linux/err.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <soc/qcom/glink.h>
+#include <soc/qcom/msm_bench.h>
+#include "glink_loopback_commands.h"
+
+#define GLINK_BENCH_TIMEOUT_MS	2000
+#define GLINK_BENCH_CTL_INTENTS	4
+#define GLINK_BENCH_DATA_INTENTS	8
+#define GLINK_BENCH_DATA_CH	"BENCH_CLNT"
+
+static char *edge = "local";
+module_param(edge, charp, 0644);
+MODULE_PARM_DESC(edge, "Edge of the loopback server");
+
+static char *transport = "lloop";
+module_param(transport, charp, 0644);
+MODULE_PARM_DESC(transport, "Transport to the loopback server");
+
+static char *ctl_name = "LOCAL_LOOPBACK_CLNT";
+module_param(ctl_name, charp, 0644);
+MODULE_PARM_DESC(ctl_name, "Control channel of the loopback server");
+
+static unsigned int pkt_size = 1024;
+module_param(pkt_size, uint, 0644);
+MODULE_PARM_DESC(pkt_size, "Payload size of each round trip");
+
+struct glink_bench_ch {
+	void *handle;
+	struct completion connected;
+	struct completion disconnected;
+};
+
+struct glink_bench {
+	struct glink_bench_ch ctl;
+	struct glink_bench_ch data;
+	uint32_t req_id;
+	struct resp resp;
+	struct completion resp_done;
+	struct completion echo_done;
+	struct completion tx_done;
+	void *buf;
+	size_t size;
+};
+
+static struct glink_bench glink_bench;
+
+static void glink_bench_notify_state(void *handle, const void *priv,
+				     unsigned event)
+{
+	struct glink_bench_ch *ch = (struct glink_bench_ch *)priv;
+
+	if (event == GLINK_CONNECTED)
+		complete(&ch->connected);
+	else if (event == GLINK_LOCAL_DISCONNECTED)
+		complete(&ch->disconnected);
+}
+
+static void glink_bench_ctl_rx(void *handle, const void *priv,
+			       const void *pkt_priv, const void *ptr,
+			       size_t size)
+{
+	struct glink_bench *gb = &glink_bench;
+
+	if (size >= sizeof(struct resp)) {
+		gb->resp = *(const struct resp *)ptr;
+		complete(&gb->resp_done);
+	}
+	glink_rx_done(handle, ptr, true);
+}
+
+static void glink_bench_ctl_tx_done(void *handle, const void *priv,
+				    const void *pkt_priv, const void *ptr)
+{
+	kfree(ptr);
+}
+
+static void glink_bench_data_rx(void *handle, const void *priv,
+				const void *pkt_priv, const void *ptr,
+				size_t size)
+{
+	glink_rx_done(handle, ptr, true);
+	complete(&glink_bench.echo_done);
+}
+
+static void glink_bench_data_tx_done(void *handle, const void *priv,
+				     const void *pkt_priv, const void *ptr)
+{
+	complete(&glink_bench.tx_done);
+}
+
+static int glink_bench_open(struct glink_bench_ch *ch, const char *name,
+			    bool data)
+{
+	struct glink_open_config cfg;
+
+	init_completion(&ch->connected);
+	init_completion(&ch->disconnected);
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.priv = ch;
+	cfg.transport = transport;
+	cfg.edge = edge;
+	cfg.name = name;
+	cfg.notify_state = glink_bench_notify_state;
+	if (data) {
+		cfg.notify_rx = glink_bench_data_rx;
+		cfg.notify_tx_done = glink_bench_data_tx_done;
+	} else {
+		cfg.notify_rx = glink_bench_ctl_rx;
+		cfg.notify_tx_done = glink_bench_ctl_tx_done;
+	}
+
+	ch->handle = glink_open(&cfg);
+	if (IS_ERR_OR_NULL(ch->handle)) {
+		pr_err("%s:%s:%s open failed %ld\n", transport, edge, name,
+		       PTR_ERR(ch->handle));
+		ch->handle = NULL;
+		return -ENODEV;
+	}
+
+	if (!wait_for_completion_timeout(&ch->connected,
+				msecs_to_jiffies(GLINK_BENCH_TIMEOUT_MS))) {
+		pr_err("%s:%s:%s connect timed out\n", transport, edge, name);
+		glink_close(ch->handle);
+		ch->handle = NULL;
+		return -ETIMEDOUT;
+	}
+
+	return 0;
+}
+
+static void glink_bench_close(struct glink_bench_ch *ch)
+{
+	if (!ch->handle)
+		return;
+
+	if (!glink_close(ch->handle))
+		wait_for_completion_timeout(&ch->disconnected,
+				msecs_to_jiffies(GLINK_BENCH_TIMEOUT_MS));
+	ch->handle = NULL;
+}
+
+/* Send one request to the loopback server and wait for its response */
+static int glink_bench_request(struct glink_bench *gb, uint32_t type,
+			       const union req_payload *payload)
+{
+	struct req *req;
+	int ret;
+
+	req = kzalloc(sizeof(*req), GFP_KERNEL);
+	if (!req)
+		return -ENOMEM;
+
+	req->hdr.req_id = ++gb->req_id;
+	req->hdr.req_type = type;
+	req->hdr.req_size = sizeof(*payload);
+	req->payload = *payload;
+
+	reinit_completion(&gb->resp_done);
+	ret = glink_tx(gb->ctl.handle, NULL, req, sizeof(*req),
+		       GLINK_TX_REQ_INTENT);
+	if (ret) {
+		kfree(req);
+		return ret;
+	}
+
+	if (!wait_for_completion_timeout(&gb->resp_done,
+				msecs_to_jiffies(GLINK_BENCH_TIMEOUT_MS)))
+		return -ETIMEDOUT;
+
+	if (gb->resp.req_id != gb->req_id || gb->resp.response)
+		return -EIO;
+
+	return 0;
+}
+
+static int glink_bench_setup(struct msm_bench *bench)
+{
+	struct glink_bench *gb = bench->priv;
+	union req_payload payload;
+	int i, ret;
+
+	gb->size = max_t(size_t, pkt_size, 1);
+	bench->bytes = gb->size;
+	gb->buf = kmalloc(gb->size, GFP_KERNEL);
+	if (!gb->buf)
+		return -ENOMEM;
+	memset(gb->buf, 0xa5, gb->size);
+
+	init_completion(&gb->resp_done);
+	init_completion(&gb->echo_done);
+	init_completion(&gb->tx_done);
+
+	ret = glink_bench_open(&gb->ctl, ctl_name, false);
+	if (ret)
+		goto free_buf;
+
+	for (i = 0; i < GLINK_BENCH_CTL_INTENTS; i++)
+		glink_queue_rx_intent(gb->ctl.handle, NULL,
+				      sizeof(struct resp));
+
+	memset(&payload, 0, sizeof(payload));
+	payload.open.name_len = strlen(GLINK_BENCH_DATA_CH);
+	strlcpy(payload.open.ch_name, GLINK_BENCH_DATA_CH, MAX_NAME_LEN);
+	ret = glink_bench_request(gb, OPEN, &payload);
+	if (ret)
+		goto close_ctl;
+
+	ret = glink_bench_open(&gb->data, GLINK_BENCH_DATA_CH, true);
+	if (ret)
+		goto close_ctl;
+
+	for (i = 0; i < GLINK_BENCH_DATA_INTENTS; i++)
+		glink_queue_rx_intent(gb->data.handle, NULL, gb->size);
+
+	memset(&payload, 0, sizeof(payload));
+	payload.q_rx_int_conf.num_intents = GLINK_BENCH_DATA_INTENTS;
+	payload.q_rx_int_conf.intent_size = gb->size;
+	payload.q_rx_int_conf.name_len = strlen(GLINK_BENCH_DATA_CH);
+	strlcpy(payload.q_rx_int_conf.ch_name, GLINK_BENCH_DATA_CH,
+		MAX_NAME_LEN);
+	ret = glink_bench_request(gb, QUEUE_RX_INTENT_CONFIG, &payload);
+	if (ret)
+		goto close_data;
+
+	memset(&payload, 0, sizeof(payload));
+	payload.tx_conf.echo_count = 1;
+	payload.tx_conf.transform_type = NO_TRANSFORM;
+	payload.tx_conf.name_len = strlen(GLINK_BENCH_DATA_CH);
+	strlcpy(payload.tx_conf.ch_name, GLINK_BENCH_DATA_CH, MAX_NAME_LEN);
+	ret = glink_bench_request(gb, TX_CONFIG, &payload);
+	if (ret)
+		goto close_data;
+
+	memset(&payload, 0, sizeof(payload));
+	payload.rx_done_conf.name_len = strlen(GLINK_BENCH_DATA_CH);
+	strlcpy(payload.rx_done_conf.ch_name, GLINK_BENCH_DATA_CH,
+		MAX_NAME_LEN);
+	ret = glink_bench_request(gb, RX_DONE_CONFIG, &payload);
+	if (ret)
+		goto close_data;
+
+	return 0;
+
+close_data:
+	glink_bench_close(&gb->data);
+close_ctl:
+	glink_bench_close(&gb->ctl);
+free_buf:
+	kfree(gb->buf);
+	gb->buf = NULL;
+	return ret;
+}
+
+static int glink_bench_run(struct msm_bench *bench)
+{
+	struct glink_bench *gb = bench->priv;
+	int ret;
+
+	reinit_completion(&gb->echo_done);
+	reinit_completion(&gb->tx_done);
+
+	ret = glink_tx(gb->data.handle, NULL, gb->buf, gb->size,
+		       GLINK_TX_REQ_INTENT);
+	if (ret)
+		return ret;
+
+	/* The buffer is reused, so tx_done must be seen as well */
+	if (!wait_for_completion_timeout(&gb->tx_done,
+				msecs_to_jiffies(GLINK_BENCH_TIMEOUT_MS)) ||
+	    !wait_for_completion_timeout(&gb->echo_done,
+				msecs_to_jiffies(GLINK_BENCH_TIMEOUT_MS)))
+		return -ETIMEDOUT;
+
+	return 0;
+}
+
+static void glink_bench_teardown(struct msm_bench *bench)
+{
+	struct glink_bench *gb = bench->priv;
+	union req_payload payload;
+
+	memset(&payload, 0, sizeof(payload));
+	payload.close.name_len = strlen(GLINK_BENCH_DATA_CH);
+	strlcpy(payload.close.ch_name, GLINK_BENCH_DATA_CH, MAX_NAME_LEN);
+	glink_bench_request(gb, CLOSE, &payload);
+
+	glink_bench_close(&gb->data);
+	glink_bench_close(&gb->ctl);
+	kfree(gb->buf);
+	gb->buf = NULL;
+}
+
+static struct msm_bench glink_loopback_bench = {
+	.name		= "glink_loopback",
+	.setup		= glink_bench_setup,
+	.run		= glink_bench_run,
+	.teardown	= glink_bench_teardown,
+	.priv		= &glink_bench,
+};
+
+static int __init glink_bench_init(void)
+{
+	return msm_bench_register(&glink_loopback_bench);
+}
+module_init(glink_bench_init);
+
+static void __exit glink_bench_exit(void)
+{
+	msm_bench_unregister(&glink_loopback_bench);
+}
+module_exit(glink_bench_exit);
+
+MODULE_DESCRIPTION("MSM Generic Link (G-Link) Loopback Benchmark");
+MODULE_LICENSE("GPL v2");
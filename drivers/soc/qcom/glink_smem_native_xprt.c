@@ -13,6 +13,7 @@
 #include <linux/err.h>
 #include <linux/fs.h>
 #include <linux/gfp.h>
+#include <linux/hrtimer.h>
 #include <linux/interrupt.h>
 #include <linux/io.h>
 #include <linux/ipc_logging.h>
@@ -149,6 +150,12 @@ struct mailbox_config_info {
  * @irq_line:			The incoming interrupt line.
  * @tx_irq_count:		Number of interrupts triggered.
  * @rx_irq_count:		Number of interrupts received.
+ * @tx_irq_coalesce_us:		Minimum interval between two tx interrupts, in
+ *				microseconds.  0 disables tx irq coalescing.
+ * @tx_irq_timer:		Timer raising a deferred tx interrupt.
+ * @tx_irq_last:		Time the last tx interrupt was raised.
+ * @tx_irq_pending:		A deferred tx interrupt is armed.  Protected by
+ *				@write_lock.
  * @tx_ch_desc:			Reference to the channel description structure
  *				for tx in SMEM for this edge.
  * @rx_ch_desc:			Reference to the channel description structure
@@ -179,6 +186,9 @@ struct mailbox_config_info {
  * @in_ssr:			Signals if this transport is in ssr.
  * @rx_lock:			Used to serialize concurrent instances of rx
  *				processing.
+ * @rx_read_index:		Local copy of the rx read index, advanced by
+ *				fifo_read() and published to @rx_ch_desc by
+ *				rx_publish_read_index().  Protected by @rx_lock.
  * @deferred_cmds:		List of deferred commands that need to be
  *				processed in process context.
  * @num_pw_states:		Size of @ramp_time_us.
@@ -198,6 +208,10 @@ struct edge_info {
 	uint32_t irq_line;
 	uint32_t tx_irq_count;
 	uint32_t rx_irq_count;
+	uint32_t tx_irq_coalesce_us;
+	struct hrtimer tx_irq_timer;
+	ktime_t tx_irq_last;
+	bool tx_irq_pending;
 	struct channel_desc *tx_ch_desc;
 	struct channel_desc *rx_ch_desc;
 	void __iomem *tx_fifo;
@@ -217,6 +231,7 @@ struct edge_info {
 	struct srcu_struct use_ref;
 	bool in_ssr;
 	spinlock_t rx_lock;
+	uint32_t rx_read_index;
 	struct list_head deferred_cmds;
 	uint32_t num_pw_states;
 	unsigned long *ramp_time_us;
@@ -268,6 +283,66 @@ static void send_irq(struct edge_info *einfo)
 	einfo->tx_irq_count++;
 }
 
+/**
+ * send_tx_irq() - signal the remote entity that tx data is available
+ * @einfo:	Which remote entity that should receive the irq.
+ *
+ * With tx irq coalescing enabled, an interrupt is raised right away only if
+ * none was raised in the last @einfo->tx_irq_coalesce_us.  Otherwise a timer
+ * raises a single interrupt at the end of that interval on behalf of all
+ * the writes made in the meantime, which bounds the added latency.  This
+ * function assumes that it is called with the write_lock already locked.
+ */
+static void send_tx_irq(struct edge_info *einfo)
+{
+	ktime_t now;
+
+	if (!einfo->tx_irq_coalesce_us) {
+		send_irq(einfo);
+		return;
+	}
+
+	if (einfo->tx_irq_pending)
+		return;
+
+	now = ktime_get();
+	if (ktime_us_delta(now, einfo->tx_irq_last) >=
+					einfo->tx_irq_coalesce_us) {
+		einfo->tx_irq_last = now;
+		send_irq(einfo);
+		return;
+	}
+
+	einfo->tx_irq_pending = true;
+	hrtimer_start(&einfo->tx_irq_timer,
+		      ktime_add_us(einfo->tx_irq_last,
+				   einfo->tx_irq_coalesce_us),
+		      HRTIMER_MODE_ABS);
+}
+
+/**
+ * tx_irq_timer_fn() - raise a deferred tx interrupt
+ * @timer:	tx irq timer of the edge.
+ *
+ * Return: HRTIMER_NORESTART.
+ */
+static enum hrtimer_restart tx_irq_timer_fn(struct hrtimer *timer)
+{
+	struct edge_info *einfo = container_of(timer, struct edge_info,
+					       tx_irq_timer);
+	unsigned long flags;
+
+	spin_lock_irqsave(&einfo->write_lock, flags);
+	if (einfo->tx_irq_pending) {
+		einfo->tx_irq_pending = false;
+		einfo->tx_irq_last = ktime_get();
+		send_irq(einfo);
+	}
+	spin_unlock_irqrestore(&einfo->write_lock, flags);
+
+	return HRTIMER_NORESTART;
+}
+
 /**
  * read_from_fifo() - memcpy from fifo memory
  * @dest:	Destination address.
@@ -349,14 +424,14 @@ static void *memcpy32_fromio(void *dest, const void *src, size_t num_bytes)
 }
 
 /**
- * fifo_read_avail() - how many bytes are available to be read from an edge
+ * __fifo_read_avail() - how many bytes are available to be read from an edge
  * @einfo:	The concerned edge to query.
+ * @read_index:	Read index to compute the available bytes from.
  *
  * Return: The number of bytes available to be read from edge.
  */
-static uint32_t fifo_read_avail(struct edge_info *einfo)
+static uint32_t __fifo_read_avail(struct edge_info *einfo, uint32_t read_index)
 {
-	uint32_t read_index = einfo->rx_ch_desc->read_index;
 	uint32_t write_index = einfo->rx_ch_desc->write_index;
 	uint32_t fifo_size = einfo->rx_fifo_size;
 	uint32_t bytes_avail;
@@ -395,6 +470,47 @@ static uint32_t fifo_read_avail(struct edge_info *einfo)
 	return bytes_avail;
 }
 
+/**
+ * fifo_read_avail() - how many bytes are available to be read from an edge
+ * @einfo:	The concerned edge to query.
+ *
+ * Uses the read index published to the remote side.  While rx processing is
+ * in progress, rx_fifo_avail() gives the up to date value.
+ *
+ * Return: The number of bytes available to be read from edge.
+ */
+static uint32_t fifo_read_avail(struct edge_info *einfo)
+{
+	return __fifo_read_avail(einfo, einfo->rx_ch_desc->read_index);
+}
+
+/**
+ * rx_fifo_avail() - how many bytes are left to be read during rx processing
+ * @einfo:	The concerned edge to query.
+ *
+ * This function assumes that it is called with the rx_lock already locked.
+ *
+ * Return: The number of bytes available to be read from edge.
+ */
+static uint32_t rx_fifo_avail(struct edge_info *einfo)
+{
+	return __fifo_read_avail(einfo, einfo->rx_read_index);
+}
+
+/**
+ * rx_publish_read_index() - make the data consumed so far visible remotely
+ * @einfo:	The concerned edge.
+ *
+ * fifo_read() only advances the local copy of the read index so that a whole
+ * batch of commands costs a single update of the shared descriptor.  This
+ * function assumes that it is called with the rx_lock already locked.
+ */
+static void rx_publish_read_index(struct edge_info *einfo)
+{
+	if (einfo->rx_ch_desc->read_index != einfo->rx_read_index)
+		einfo->rx_ch_desc->read_index = einfo->rx_read_index;
+}
+
 /**
  * fifo_write_avail() - how many bytes can be written to the edge
  * @einfo:	The concerned edge to query.
@@ -429,6 +545,10 @@ static uint32_t fifo_write_avail(struct edge_info *einfo)
  * @_data:	Buffer to copy the read data into.
  * @len:	The ammount of data to read in bytes.
  *
+ * Advances the local copy of the read index only, see
+ * rx_publish_read_index().  This function assumes that it is called with the
+ * rx_lock already locked.
+ *
  * Return: The number of bytes read.
  */
 static int fifo_read(struct edge_info *einfo, void *_data, int len)
@@ -436,7 +556,7 @@ static int fifo_read(struct edge_info *einfo, void *_data, int len)
 	void *ptr;
 	void *data = _data;
 	int orig_len = len;
-	uint32_t read_index = einfo->rx_ch_desc->read_index;
+	uint32_t read_index = einfo->rx_read_index;
 	uint32_t write_index = einfo->rx_ch_desc->write_index;
 	uint32_t fifo_size = einfo->rx_fifo_size;
 	uint32_t n;
@@ -463,7 +583,7 @@ static int fifo_read(struct edge_info *einfo, void *_data, int len)
 		if (read_index >= fifo_size)
 			read_index -= fifo_size;
 	}
-	einfo->rx_ch_desc->read_index = read_index;
+	einfo->rx_read_index = read_index;
 
 	return orig_len - len;
 }
@@ -536,7 +656,7 @@ static int fifo_write(struct edge_info *einfo, const void *data, int len)
 
 	len = fifo_write_body(einfo, data, len, &write_index);
 	einfo->tx_ch_desc->write_index = write_index;
-	send_irq(einfo);
+	send_tx_irq(einfo);
 
 	return orig_len - len;
 }
@@ -571,7 +691,7 @@ static int fifo_write_complex(struct edge_info *einfo,
 	len2 = fifo_write_body(einfo, data2, len2, &write_index);
 	len3 = fifo_write_body(einfo, data3, len3, &write_index);
 	einfo->tx_ch_desc->write_index = write_index;
-	send_irq(einfo);
+	send_tx_irq(einfo);
 
 	return orig_len - len1 - len2 - len3;
 }
@@ -882,7 +1002,8 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 	 * eliminating a race.
 	 */
 	spin_lock_irqsave(&einfo->rx_lock, flags);
-	while (fifo_read_avail(einfo) ||
+	einfo->rx_read_index = einfo->rx_ch_desc->read_index;
+	while (rx_fifo_avail(einfo) ||
 			(!atomic_ctx && !list_empty(&einfo->deferred_cmds))) {
 		if (einfo->in_ssr)
 			break;
@@ -908,6 +1029,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->rx_cmd_version(
 								&einfo->xprt_if,
@@ -920,6 +1042,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->rx_cmd_version_ack(
 								&einfo->xprt_if,
@@ -953,6 +1076,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				break;
 			}
 
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->rx_cmd_ch_remote_open(
 								&einfo->xprt_if,
@@ -967,6 +1091,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->
 							rx_cmd_ch_remote_close(
@@ -979,6 +1104,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->rx_cmd_ch_open_ack(
 								&einfo->xprt_if,
@@ -1021,6 +1147,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 						kfree(cmd_data);
 					break;
 				}
+				rx_publish_read_index(einfo);
 				spin_unlock_irqrestore(&einfo->rx_lock, flags);
 				einfo->xprt_if.glink_core_if_ptr->
 						rx_cmd_remote_rx_intent_put(
@@ -1052,6 +1179,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 					kfree(intents);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			for (i = 0; i < cmd.param2; ++i) {
 				einfo->xprt_if.glink_core_if_ptr->
@@ -1069,6 +1197,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->rx_cmd_tx_done(
 								&einfo->xprt_if,
@@ -1082,6 +1211,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->
 						rx_cmd_remote_rx_intent_req(
@@ -1095,6 +1225,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			granted = false;
 			if (cmd.param2 == 1)
@@ -1117,6 +1248,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->rx_cmd_ch_close_ack(
 								&einfo->xprt_if,
@@ -1124,6 +1256,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 			spin_lock_irqsave(&einfo->rx_lock, flags);
 			break;
 		case READ_NOTIF_CMD:
+			rx_publish_read_index(einfo);
 			send_irq(einfo);
 			break;
 		case SIGNALS_CMD:
@@ -1131,6 +1264,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->rx_cmd_remote_sigs(
 								&einfo->xprt_if,
@@ -1143,6 +1277,7 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 				queue_cmd(einfo, &cmd, NULL);
 				break;
 			}
+			rx_publish_read_index(einfo);
 			spin_unlock_irqrestore(&einfo->rx_lock, flags);
 			einfo->xprt_if.glink_core_if_ptr->rx_cmd_tx_done(
 								&einfo->xprt_if,
@@ -1156,6 +1291,8 @@ static void __rx_worker(struct edge_info *einfo, bool atomic_ctx)
 			break;
 		}
 	}
+	if (!einfo->in_ssr)
+		rx_publish_read_index(einfo);
 	spin_unlock_irqrestore(&einfo->rx_lock, flags);
 	srcu_read_unlock(&einfo->use_ref, rcu_id);
 }
@@ -1479,6 +1616,11 @@ static int ssr(struct glink_transport_if *if_ptr)
 
 	synchronize_srcu(&einfo->use_ref);
 
+	if (einfo->tx_irq_coalesce_us) {
+		hrtimer_cancel(&einfo->tx_irq_timer);
+		einfo->tx_irq_pending = false;
+	}
+
 	while (!list_empty(&einfo->deferred_cmds)) {
 		cmd = list_first_entry(&einfo->deferred_cmds,
 						struct deferred_cmd, list_node);
@@ -2252,6 +2394,10 @@ static int glink_smem_native_probe(struct platform_device *pdev)
 		goto missing_key;
 	}
 
+	key = "qcom,tx-irq-coalesce-us";
+	if (of_property_read_u32(node, key, &einfo->tx_irq_coalesce_us))
+		einfo->tx_irq_coalesce_us = 0;
+
 	key = "irq-reg-base";
 	r = platform_get_resource_byname(pdev, IORESOURCE_MEM, key);
 	if (!r) {
@@ -2270,6 +2416,8 @@ static int glink_smem_native_probe(struct platform_device *pdev)
 	init_xprt_cfg(einfo, subsys_name);
 	init_xprt_if(einfo);
 	spin_lock_init(&einfo->write_lock);
+	hrtimer_init(&einfo->tx_irq_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	einfo->tx_irq_timer.function = tx_irq_timer_fn;
 	init_waitqueue_head(&einfo->tx_blocked_queue);
 	init_kthread_work(&einfo->kwork, rx_worker);
 	init_kthread_worker(&einfo->kworker);
@@ -2457,6 +2605,8 @@ static int glink_rpm_native_probe(struct platform_device *pdev)
 	init_xprt_cfg(einfo, subsys_name);
 	init_xprt_if(einfo);
 	spin_lock_init(&einfo->write_lock);
+	hrtimer_init(&einfo->tx_irq_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	einfo->tx_irq_timer.function = tx_irq_timer_fn;
 	init_waitqueue_head(&einfo->tx_blocked_queue);
 	init_kthread_work(&einfo->kwork, rx_worker);
 	init_kthread_worker(&einfo->kworker);
@@ -2748,6 +2898,8 @@ static int glink_mailbox_probe(struct platform_device *pdev)
 	einfo->xprt_cfg.name = "mailbox";
 	init_xprt_if(einfo);
 	spin_lock_init(&einfo->write_lock);
+	hrtimer_init(&einfo->tx_irq_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+	einfo->tx_irq_timer.function = tx_irq_timer_fn;
 	init_waitqueue_head(&einfo->tx_blocked_queue);
 	init_kthread_work(&einfo->kwork, rx_worker);
 	init_kthread_worker(&einfo->kworker);
@@ -283,6 +283,17 @@ static void glink_xprt_sft_close_done(struct msm_ipc_router_xprt *xprt)
 	complete_all(&glink_xprtp->sft_close_complete);
 }
 
+/**
+ * glink_xprt_copy_data() - Build an rr_packet out of a received G-Link buffer
+ * @rx_work: Read work describing the received buffer.
+ *
+ * The G-Link intent is recycled as soon as this work completes, so the data
+ * has to be copied out once. It is copied into a single linear skb sized to
+ * the whole buffer; the resulting packet is handed to IPC Router as is and
+ * ends up on the destination port's rx queue without further copies.
+ *
+ * Return: Pointer to the packet on success, NULL on failure.
+ */
 static struct rr_packet *glink_xprt_copy_data(struct read_work *rx_work)
 {
 	void *buf, *pbuf, *dest_buf;
@@ -296,6 +307,14 @@ static struct rr_packet *glink_xprt_copy_data(struct read_work *rx_work)
 		return NULL;
 	}
 
+	skb = alloc_skb(rx_work->iovec_size, GFP_KERNEL);
+	if (!skb) {
+		IPC_RTR_ERR("%s: Couldn't alloc skb of size %zu\n",
+			    __func__, rx_work->iovec_size);
+		release_pkt(pkt);
+		return NULL;
+	}
+
 	do {
 		buf_size = 0;
 		if (rx_work->vbuf_provider) {
@@ -309,18 +328,18 @@ static struct rr_packet *glink_xprt_copy_data(struct read_work *rx_work)
 		if (!buf_size || !buf)
 			break;
 
-		skb = alloc_skb(buf_size, GFP_KERNEL);
-		if (!skb) {
-			IPC_RTR_ERR("%s: Couldn't alloc skb of size %zu\n",
-				    __func__, buf_size);
+		if (buf_size > skb_tailroom(skb)) {
+			IPC_RTR_ERR("%s: Buffer overflows skb %zu > %d\n",
+				    __func__, buf_size, skb_tailroom(skb));
+			kfree_skb(skb);
 			release_pkt(pkt);
 			return NULL;
 		}
 		dest_buf = skb_put(skb, buf_size);
 		memcpy(dest_buf, buf, buf_size);
-		skb_queue_tail(pkt->pkt_fragment_q, skb);
 		pkt->length += buf_size;
 	} while (buf && buf_size);
+	skb_queue_tail(pkt->pkt_fragment_q, skb);
 	return pkt;
 }
 
@@ -349,9 +368,7 @@ static void glink_xprt_read_data(struct work_struct *work)
 		goto out_read_data;
 	}
 
-	msm_ipc_router_xprt_notify(&glink_xprtp->xprt,
-				   IPC_ROUTER_XPRT_EVENT_DATA, pkt);
-	release_pkt(pkt);
+	msm_ipc_router_xprt_rx_pkt(&glink_xprtp->xprt, pkt);
 out_read_data:
 	glink_rx_done(glink_xprtp->ch_hndl, rx_work->iovec, reuse_intent);
 	kfree(rx_work);
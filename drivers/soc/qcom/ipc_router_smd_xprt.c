@@ -361,10 +361,8 @@ static void smd_xprt_read_data(struct work_struct *work)
 		if (!smd_xprtp->is_partial_in_pkt) {
 			D("%s: Packet size read %d\n",
 			  __func__, smd_xprtp->in_pkt->length);
-			msm_ipc_router_xprt_notify(&smd_xprtp->xprt,
-						IPC_ROUTER_XPRT_EVENT_DATA,
-						(void *)smd_xprtp->in_pkt);
-			release_pkt(smd_xprtp->in_pkt);
+			msm_ipc_router_xprt_rx_pkt(&smd_xprtp->xprt,
+						   smd_xprtp->in_pkt);
 			smd_xprtp->in_pkt = NULL;
 		}
 	}
@@ -0,0 +1,304 @@
+/* Copyright (c) 2018, The Linux Foundation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Microbenchmark framework for kernel hot paths.
+ *
+ * Every registered benchmark gets a file in <debugfs>/msm_bench/. Writing
+ * an iteration count to it runs the benchmark that many times in the
+ * writer's context; reading it returns the result of the last run on a
+ * single line, so results can be diffed across kernel builds:
+ *
+ *   echo 1000 > /d/msm_bench/ion_system_64k
+ *   cat /d/msm_bench/ion_system_64k
+ */
+
+#define pr_fmt(fmt) "msm_bench: " fmt
+
+#include <linux/debugfs.h>
+#include <linux/kernel.h>
+#include <linux/kref.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/sort.h>
+#include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+#include <soc/qcom/msm_bench.h>
+
+#define MSM_BENCH_DEFAULT_ITERS	1000
+#define MSM_BENCH_MAX_ITERS	100000
+
+static struct dentry *msm_bench_root;
+static DEFINE_MUTEX(msm_bench_root_lock);
+
+/*
+ * debugfs_remove() does not wait for open files, which keep calling into
+ * msm_bench_fops. The files therefore refer to this handle rather than
+ * to the benchmark: unregistering detaches the benchmark, so its owner
+ * may free it right away, and the handle goes with the last reference.
+ */
+struct msm_bench_file {
+	struct kref ref;
+	struct mutex lock;		/* serializes runs and result reads */
+	struct msm_bench *bench;	/* NULL once unregistered */
+};
+
+static void msm_bench_file_free(struct kref *ref)
+{
+	kfree(container_of(ref, struct msm_bench_file, ref));
+}
+
+static int msm_bench_cmp(const void *a, const void *b)
+{
+	u64 x = *(const u64 *)a, y = *(const u64 *)b;
+
+	if (x < y)
+		return -1;
+	return x > y;
+}
+
+static u64 msm_bench_pct(const u64 *lat, u32 n, unsigned int pct)
+{
+	return lat[div_u64((u64)(n - 1) * pct, 100)];
+}
+
+static int msm_bench_run(struct msm_bench *bench, u32 iters)
+{
+	struct msm_bench_result *res = &bench->result;
+	u64 *lat;
+	u64 start;
+	u32 i, n = 0;
+	int ret;
+
+	lat = vmalloc(iters * sizeof(*lat));
+	if (!lat)
+		return -ENOMEM;
+
+	memset(res, 0, sizeof(*res));
+
+	if (bench->setup) {
+		ret = bench->setup(bench);
+		if (ret)
+			goto out;
+	}
+
+	for (i = 0; i < iters; i++) {
+		start = ktime_get_ns();
+		ret = bench->run(bench);
+		if (ret) {
+			res->errors++;
+		} else {
+			lat[n] = ktime_get_ns() - start;
+			res->total_ns += lat[n];
+			n++;
+		}
+
+		if (fatal_signal_pending(current))
+			break;
+		cond_resched();
+	}
+
+	if (bench->teardown)
+		bench->teardown(bench);
+
+	res->iters = n;
+	if (n) {
+		sort(lat, n, sizeof(*lat), msm_bench_cmp, NULL);
+		res->min_ns = lat[0];
+		res->p50_ns = msm_bench_pct(lat, n, 50);
+		res->p90_ns = msm_bench_pct(lat, n, 90);
+		res->p99_ns = msm_bench_pct(lat, n, 99);
+		res->max_ns = lat[n - 1];
+	}
+	ret = n ? 0 : -EIO;
+out:
+	vfree(lat);
+	return ret;
+}
+
+static int msm_bench_show(struct seq_file *m, void *v)
+{
+	struct msm_bench_file *bf = m->private;
+	struct msm_bench *bench;
+	struct msm_bench_result *res;
+	u64 ops = 0, kbps = 0;
+
+	mutex_lock(&bf->lock);
+	bench = bf->bench;
+	if (!bench) {
+		mutex_unlock(&bf->lock);
+		return -ENODEV;
+	}
+	res = &bench->result;
+
+	if (res->total_ns) {
+		ops = div64_u64((u64)res->iters * NSEC_PER_SEC, res->total_ns);
+		/* KB/s rather than MB/s to keep small payloads meaningful */
+		kbps = div64_u64((u64)res->iters * bench->bytes *
+				 (NSEC_PER_SEC >> 10), res->total_ns);
+	}
+
+	seq_printf(m, "%s iters=%u errors=%u ops_per_sec=%llu kb_per_sec=%llu min_ns=%llu p50_ns=%llu p90_ns=%llu p99_ns=%llu max_ns=%llu\n",
+		   bench->name, res->iters, res->errors, ops, kbps,
+		   res->min_ns, res->p50_ns, res->p90_ns, res->p99_ns,
+		   res->max_ns);
+	mutex_unlock(&bf->lock);
+
+	return 0;
+}
+
+static int msm_bench_open(struct inode *inode, struct file *file)
+{
+	struct msm_bench_file *bf;
+	int ret;
+
+	/* i_private is cleared under the root lock on unregister */
+	mutex_lock(&msm_bench_root_lock);
+	bf = inode->i_private;
+	if (bf)
+		kref_get(&bf->ref);
+	mutex_unlock(&msm_bench_root_lock);
+	if (!bf)
+		return -ENODEV;
+
+	ret = single_open(file, msm_bench_show, bf);
+	if (ret)
+		kref_put(&bf->ref, msm_bench_file_free);
+	return ret;
+}
+
+static int msm_bench_release(struct inode *inode, struct file *file)
+{
+	struct msm_bench_file *bf =
+		((struct seq_file *)file->private_data)->private;
+
+	single_release(inode, file);
+	kref_put(&bf->ref, msm_bench_file_free);
+	return 0;
+}
+
+static ssize_t msm_bench_write(struct file *file, const char __user *ubuf,
+			       size_t count, loff_t *ppos)
+{
+	struct msm_bench_file *bf =
+		((struct seq_file *)file->private_data)->private;
+	unsigned int iters;
+	int ret;
+
+	ret = kstrtouint_from_user(ubuf, count, 0, &iters);
+	if (ret)
+		return ret;
+
+	if (!iters)
+		iters = MSM_BENCH_DEFAULT_ITERS;
+	iters = min_t(unsigned int, iters, MSM_BENCH_MAX_ITERS);
+
+	mutex_lock(&bf->lock);
+	ret = bf->bench ? msm_bench_run(bf->bench, iters) : -ENODEV;
+	mutex_unlock(&bf->lock);
+
+	return ret ? ret : count;
+}
+
+static const struct file_operations msm_bench_fops = {
+	.open		= msm_bench_open,
+	.read		= seq_read,
+	.write		= msm_bench_write,
+	.llseek		= seq_lseek,
+	.release	= msm_bench_release,
+};
+
+/**
+ * msm_bench_register() - Make a benchmark available in debugfs
+ * @bench: Benchmark to register; must stay valid until unregistered
+ *
+ * Returns 0 on success or a negative error code. Failing to register a
+ * benchmark is never fatal for the caller.
+ */
+int msm_bench_register(struct msm_bench *bench)
+{
+	struct msm_bench_file *bf;
+	int ret = 0;
+
+	if (!bench->name || !bench->run)
+		return -EINVAL;
+
+	bf = kzalloc(sizeof(*bf), GFP_KERNEL);
+	if (!bf)
+		return -ENOMEM;
+	kref_init(&bf->ref);
+	mutex_init(&bf->lock);
+	bf->bench = bench;
+	memset(&bench->result, 0, sizeof(bench->result));
+
+	mutex_lock(&msm_bench_root_lock);
+	if (!msm_bench_root) {
+		msm_bench_root = debugfs_create_dir("msm_bench", NULL);
+		if (IS_ERR_OR_NULL(msm_bench_root)) {
+			msm_bench_root = NULL;
+			ret = -ENODEV;
+			goto out;
+		}
+	}
+
+	bench->dentry = debugfs_create_file(bench->name, 0600, msm_bench_root,
+					    bf, &msm_bench_fops);
+	if (IS_ERR_OR_NULL(bench->dentry)) {
+		pr_err("failed to create %s\n", bench->name);
+		bench->dentry = NULL;
+		ret = -ENOMEM;
+		goto out;
+	}
+	bench->file = bf;
+
+out:
+	mutex_unlock(&msm_bench_root_lock);
+	if (ret)
+		kfree(bf);
+	return ret;
+}
+EXPORT_SYMBOL(msm_bench_register);
+
+/**
+ * msm_bench_unregister() - Remove a benchmark registered earlier
+ * @bench: Benchmark to remove
+ *
+ * Waits for a run in progress to finish. Files still open on the
+ * benchmark fail with -ENODEV from then on, so @bench may be freed as
+ * soon as this returns.
+ */
+void msm_bench_unregister(struct msm_bench *bench)
+{
+	struct msm_bench_file *bf;
+
+	mutex_lock(&msm_bench_root_lock);
+	bf = bench->file;
+	if (!bf) {
+		mutex_unlock(&msm_bench_root_lock);
+		return;
+	}
+
+	bench->dentry->d_inode->i_private = NULL;
+	debugfs_remove(bench->dentry);
+	bench->dentry = NULL;
+	bench->file = NULL;
+	mutex_unlock(&msm_bench_root_lock);
+
+	mutex_lock(&bf->lock);
+	bf->bench = NULL;
+	mutex_unlock(&bf->lock);
+	kref_put(&bf->ref, msm_bench_file_free);
+}
+EXPORT_SYMBOL(msm_bench_unregister);
@@ -25,6 +25,7 @@
 #include <linux/module.h>
 #include <linux/input.h>
 #include <linux/kthread.h>
+#include <linux/fb.h>
 
 static unsigned int use_input_evts_with_hi_slvt_detect;
 static struct mutex managed_cpus_lock;
@@ -80,6 +81,10 @@ struct cluster {
 	unsigned int timer_rate;
 	struct timer_list mode_exit_timer;
 	struct timer_list perf_cl_peak_mode_exit_timer;
+	/* Frame time based max freq cap */
+	unsigned int frame_cap_freq;
+	unsigned int frame_miss_cnt;
+	unsigned int frame_met_cnt;
 };
 
 struct input_events {
@@ -106,6 +111,7 @@ struct delayed_work evaluate_hotplug_work;
 struct cpu_status {
 	unsigned int min;
 	unsigned int max;
+	unsigned int frame_cap;
 };
 static DEFINE_PER_CPU(struct cpu_status, cpu_stats);
 
@@ -1569,6 +1575,10 @@ static int perf_adjust_notify(struct notifier_block *nb, unsigned long val,
 	if (val != CPUFREQ_ADJUST)
 		return NOTIFY_OK;
 
+	/* The frame time cap never overrides a min freq request */
+	if (cpu_st->frame_cap < max)
+		max = max(cpu_st->frame_cap, min);
+
 	pr_debug("msm_perf: CPU%u policy before: %u:%u kHz\n", cpu,
 						policy->min, policy->max);
 	pr_debug("msm_perf: CPU%u seting min:max %u:%u kHz\n", cpu, min, max);
@@ -1585,6 +1595,199 @@ static struct notifier_block perf_cpufreq_nb = {
 	.notifier_call = perf_adjust_notify,
 };
 
+/*
+ * Closed loop frame time mode. The display commit path reports every
+ * completed frame. As long as frames keep completing within
+ * frame_target_us, the max freq of the managed clusters is stepped down
+ * one frequency level every frame_cap_down_frames frames. Once
+ * frame_cap_up_frames consecutive frames miss the deadline, it is
+ * stepped back up one level. The clusters settle at the lowest level
+ * that still meets the deadline. Setting frame_target_us to 0 disables
+ * the mode and removes the cap.
+ */
+static unsigned int frame_target_us;
+static unsigned int frame_cap_up_frames = 2;
+module_param(frame_cap_up_frames, uint, 0644);
+static unsigned int frame_cap_down_frames = 60;
+module_param(frame_cap_down_frames, uint, 0644);
+
+/* A frame later than 1.5 target has missed a vsync */
+#define FRAME_MISSED(t)		((t) > frame_target_us + frame_target_us / 2)
+/* Longer gaps mean the display went idle, not that a frame was late */
+#define FRAME_IDLE(t)		((t) > 4 * frame_target_us)
+
+static u64 last_frame_ts;
+static struct work_struct frame_cap_work;
+
+static unsigned int frame_cap_step(struct cluster *cl, bool up)
+{
+	struct cpufreq_frequency_table *table;
+	unsigned int cur = cl->frame_cap_freq, next, f;
+	int i;
+
+	table = cpufreq_frequency_get_table(cpumask_first(cl->cpus));
+	if (!table)
+		return cur;
+
+	next = up ? UINT_MAX : 0;
+	for (i = 0; table[i].frequency != CPUFREQ_TABLE_END; i++) {
+		f = table[i].frequency;
+		if (f == CPUFREQ_ENTRY_INVALID)
+			continue;
+		if (up && f > cur && f < next)
+			next = f;
+		else if (!up && f < cur && f > next)
+			next = f;
+	}
+
+	/* Nothing below the lowest level, going past the highest uncaps */
+	if (!up && !next)
+		return cur;
+	return next;
+}
+
+static void frame_cap_update(struct cluster *cl, bool up)
+{
+	unsigned int freq = frame_cap_step(cl, up);
+	unsigned int cpu;
+
+	if (freq == cl->frame_cap_freq)
+		return;
+
+	cl->frame_cap_freq = freq;
+	for_each_cpu(cpu, cl->cpus)
+		per_cpu(cpu_stats, cpu).frame_cap = freq;
+	schedule_work(&frame_cap_work);
+}
+
+static void do_frame_cap_work(struct work_struct *work)
+{
+	unsigned int i, cpu;
+
+	get_online_cpus();
+	for (i = 0; i < num_clusters; i++) {
+		cpu = cpumask_first_and(managed_clusters[i]->cpus,
+					cpu_online_mask);
+		if (cpu < nr_cpu_ids)
+			cpufreq_update_policy(cpu);
+	}
+	put_online_cpus();
+}
+
+static void frame_cap_reset(void)
+{
+	unsigned int i, cpu;
+	struct cluster *cl;
+
+	for (i = 0; i < num_clusters; i++) {
+		cl = managed_clusters[i];
+		cl->frame_cap_freq = UINT_MAX;
+		cl->frame_miss_cnt = 0;
+		cl->frame_met_cnt = 0;
+		for_each_cpu(cpu, cl->cpus)
+			per_cpu(cpu_stats, cpu).frame_cap = UINT_MAX;
+	}
+	last_frame_ts = 0;
+	schedule_work(&frame_cap_work);
+}
+
+static int perf_fb_notify(struct notifier_block *nb, unsigned long val,
+			  void *data)
+{
+	struct fb_event *evdata = data;
+	unsigned int i, frame_time;
+	struct cluster *cl;
+	u64 now;
+
+	if (val != FB_EVENT_FRAME_DONE || !frame_target_us || !clusters_inited)
+		return NOTIFY_OK;
+
+	/* Only track the primary display */
+	if (evdata->info->node)
+		return NOTIFY_OK;
+
+	now = ktime_to_us(ktime_get());
+	frame_time = min_t(u64, now - last_frame_ts, UINT_MAX);
+	last_frame_ts = now;
+
+	for (i = 0; i < num_clusters; i++) {
+		cl = managed_clusters[i];
+		if (cpumask_empty(cl->cpus))
+			continue;
+
+		if (FRAME_IDLE(frame_time)) {
+			cl->frame_miss_cnt = 0;
+			cl->frame_met_cnt = 0;
+		} else if (FRAME_MISSED(frame_time)) {
+			cl->frame_met_cnt = 0;
+			if (++cl->frame_miss_cnt >= frame_cap_up_frames) {
+				cl->frame_miss_cnt = 0;
+				frame_cap_update(cl, true);
+			}
+		} else {
+			cl->frame_miss_cnt = 0;
+			if (++cl->frame_met_cnt >= frame_cap_down_frames) {
+				cl->frame_met_cnt = 0;
+				frame_cap_update(cl, false);
+			}
+		}
+	}
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block perf_fb_nb = {
+	.notifier_call = perf_fb_notify,
+};
+
+static int set_frame_target_us(const char *buf, const struct kernel_param *kp)
+{
+	unsigned int val;
+
+	if (!clusters_inited)
+		return -EINVAL;
+
+	if (sscanf(buf, "%u\n", &val) != 1)
+		return -EINVAL;
+
+	if (val == frame_target_us)
+		return 0;
+
+	frame_target_us = val;
+	frame_cap_reset();
+
+	return 0;
+}
+
+static int get_frame_target_us(char *buf, const struct kernel_param *kp)
+{
+	return snprintf(buf, PAGE_SIZE, "%u\n", frame_target_us);
+}
+
+static const struct kernel_param_ops param_ops_frame_target_us = {
+	.set = set_frame_target_us,
+	.get = get_frame_target_us,
+};
+module_param_cb(frame_target_us, &param_ops_frame_target_us, NULL, 0644);
+
+/* Read-only node: To display the frame time max freq cap of each CPU */
+static int get_frame_cap_freq(char *buf, const struct kernel_param *kp)
+{
+	int cnt = 0, cpu;
+
+	for_each_present_cpu(cpu) {
+		cnt += snprintf(buf + cnt, PAGE_SIZE - cnt,
+			"%d:%u ", cpu, per_cpu(cpu_stats, cpu).frame_cap);
+	}
+	cnt += snprintf(buf + cnt, PAGE_SIZE - cnt, "\n");
+	return cnt;
+}
+
+static const struct kernel_param_ops param_ops_frame_cap_freq = {
+	.get = get_frame_cap_freq,
+};
+module_param_cb(frame_cap_freq, &param_ops_frame_cap_freq, NULL, 0444);
+
 static bool check_notify_status(void)
 {
 	int i;
@@ -2641,6 +2844,7 @@ static int init_cluster_control(void)
 						DEF_PERF_CL_PEAK_ENTER_CYCLE;
 		managed_clusters[i]->perf_cl_peak_exit_cycles =
 						DEF_PERF_CL_PEAK_EXIT_CYCLE;
+		managed_clusters[i]->frame_cap_freq = UINT_MAX;
 
 		/* Initialize trigger threshold */
 		thr.perf_cl_trigger_threshold = CLUSTER_1_THRESHOLD_FREQ;
@@ -2749,8 +2953,13 @@ static int __init msm_performance_init(void)
 	cpufreq_register_notifier(&perf_cputransitions_nb,
 					CPUFREQ_TRANSITION_NOTIFIER);
 
-	for_each_present_cpu(cpu)
+	for_each_present_cpu(cpu) {
 		per_cpu(cpu_stats, cpu).max = UINT_MAX;
+		per_cpu(cpu_stats, cpu).frame_cap = UINT_MAX;
+	}
+
+	INIT_WORK(&frame_cap_work, do_frame_cap_work);
+	fb_register_client(&perf_fb_nb);
 
 	register_cpu_notifier(&msm_performance_cpu_notifier);
 
@@ -29,10 +29,15 @@
 #include <linux/tick.h>
 #include <asm/smp_plat.h>
 #include <linux/suspend.h>
+#include <linux/mm.h>
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/msm_rq_stats.h>
 
 #define MAX_LONG_SIZE 24
 #define DEFAULT_RQ_POLL_JIFFIES 1
 #define DEFAULT_DEF_TIMER_JIFFIES 5
+#define DEFAULT_STATS_PAGE_MS 20
 
 struct notifier_block freq_transition;
 struct notifier_block cpu_hotplug;
@@ -51,6 +56,21 @@ struct cpu_load_data {
 
 static DEFINE_PER_CPU(struct cpu_load_data, cpuload);
 
+/* Previous sample the stats page averages are computed against */
+struct cpu_rq_sample {
+	u64 nr_sum;
+	u64 nr_time;
+	u64 idle_time;
+	u64 wall_time;
+};
+
+static DEFINE_PER_CPU(struct cpu_rq_sample, rq_sample);
+
+static struct rq_stats_page *stats_page;
+static unsigned int stats_page_ms = DEFAULT_STATS_PAGE_MS;
+static atomic_t stats_page_users;
+static struct delayed_work stats_page_work;
+
 
 static int update_average_load(unsigned int freq, unsigned int cpu)
 {
@@ -168,6 +188,130 @@ static int cpu_hotplug_handler(struct notifier_block *nb,
 	return NOTIFY_OK;
 }
 
+/*
+ * Refresh the stats page. This is the only writer, so the page sequence
+ * count is bumped without a lock, following the seqcount protocol that
+ * userspace relies on to get a consistent copy.
+ */
+static void stats_page_work_fn(struct work_struct *work)
+{
+	struct cpu_rq_sample *sample;
+	struct rq_stats_cpu *st;
+	u64 nr_sum, nr_time, idle_time, wall_time, busy_time;
+	unsigned int cpu;
+
+	stats_page->seq++;
+	smp_wmb();
+
+	for (cpu = 0; cpu < stats_page->nr_cpus; cpu++) {
+		if (!cpu_possible(cpu))
+			continue;
+
+		sample = &per_cpu(rq_sample, cpu);
+		st = &stats_page->cpu[cpu];
+
+		nr_sum = sched_get_nr_running_sum(cpu, &nr_time);
+		if (nr_time > sample->nr_time)
+			st->nr_running_avg = div64_u64(
+				(nr_sum - sample->nr_sum) * 100,
+				nr_time - sample->nr_time);
+		sample->nr_sum = nr_sum;
+		sample->nr_time = nr_time;
+
+		idle_time = get_cpu_idle_time(cpu, &wall_time, 0);
+		if (!cpu_online(cpu)) {
+			st->busy_pct = 0;
+		} else if (wall_time > sample->wall_time) {
+			busy_time = wall_time - sample->wall_time;
+			busy_time -= min(busy_time,
+					 idle_time - sample->idle_time);
+			st->busy_pct = div64_u64(busy_time * 100,
+					wall_time - sample->wall_time);
+		}
+		sample->idle_time = idle_time;
+		sample->wall_time = wall_time;
+
+		st->online = cpu_online(cpu);
+	}
+
+	stats_page->period_ms = stats_page_ms;
+	stats_page->update_time_ns = ktime_to_ns(ktime_get());
+
+	smp_wmb();
+	stats_page->seq++;
+
+	/* Keep updating only while somebody has the page open */
+	if (atomic_read(&stats_page_users))
+		queue_delayed_work(rq_wq, &stats_page_work,
+				   msecs_to_jiffies(stats_page_ms));
+}
+
+static int stats_page_open(struct inode *inode, struct file *file)
+{
+	if (file->f_mode & FMODE_WRITE)
+		return -EPERM;
+
+	if (atomic_inc_return(&stats_page_users) == 1)
+		mod_delayed_work(rq_wq, &stats_page_work, 0);
+
+	return 0;
+}
+
+static int stats_page_release(struct inode *inode, struct file *file)
+{
+	atomic_dec(&stats_page_users);
+	return 0;
+}
+
+static int stats_page_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	if (vma->vm_pgoff || vma->vm_end - vma->vm_start > PAGE_SIZE)
+		return -EINVAL;
+
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	return vm_insert_page(vma, vma->vm_start, virt_to_page(stats_page));
+}
+
+static const struct file_operations stats_page_fops = {
+	.owner		= THIS_MODULE,
+	.open		= stats_page_open,
+	.release	= stats_page_release,
+	.mmap		= stats_page_mmap,
+	.llseek		= noop_llseek,
+};
+
+/* Read-only page of per-cpu run queue statistics at /dev/rq_stats */
+static struct miscdevice stats_page_dev = {
+	.minor	= MISC_DYNAMIC_MINOR,
+	.name	= "rq_stats",
+	.fops	= &stats_page_fops,
+	.mode	= S_IRUGO,
+};
+
+static int init_stats_page(void)
+{
+	int err;
+
+	stats_page = (struct rq_stats_page *)get_zeroed_page(GFP_KERNEL);
+	if (!stats_page)
+		return -ENOMEM;
+
+	stats_page->nr_cpus = min_t(unsigned int, nr_cpu_ids,
+				    RQ_STATS_MAX_CPUS);
+	INIT_DEFERRABLE_WORK(&stats_page_work, stats_page_work_fn);
+
+	err = misc_register(&stats_page_dev);
+	if (err) {
+		free_page((unsigned long)stats_page);
+		stats_page = NULL;
+	}
+
+	return err;
+}
+
 static int system_suspend_handler(struct notifier_block *nb,
 				unsigned long val, void *data)
 {
@@ -292,6 +436,28 @@ static struct kobj_attribute def_timer_ms_attr =
 	__ATTR(def_timer_ms, S_IWUSR | S_IRUSR, show_def_timer_ms,
 			store_def_timer_ms);
 
+static ssize_t show_stats_page_ms(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return snprintf(buf, MAX_LONG_SIZE, "%u\n", stats_page_ms);
+}
+
+static ssize_t store_stats_page_ms(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	unsigned int val = 0;
+
+	if (kstrtouint(buf, 0, &val) || !val)
+		return -EINVAL;
+
+	stats_page_ms = val;
+	return count;
+}
+
+static struct kobj_attribute stats_page_ms_attr =
+	__ATTR(stats_page_ms, S_IWUSR | S_IRUSR, show_stats_page_ms,
+			store_stats_page_ms);
+
 static ssize_t show_cpu_normalized_load(struct kobject *kobj,
 		struct kobj_attribute *attr, char *buf)
 {
@@ -308,6 +474,7 @@ static struct attribute *rq_attrs[] = {
 	&run_queue_avg_attr.attr,
 	&run_queue_poll_ms_attr.attr,
 	&hotplug_disabled_attr.attr,
+	&stats_page_ms_attr.attr,
 	NULL,
 };
 
@@ -360,6 +527,9 @@ static int __init msm_rq_stats_init(void)
 	rq_info.hotplug_disabled = 0;
 	ret = init_rq_attribs();
 
+	if (init_stats_page())
+		pr_err("msm_rq_stats: failed to create stats page\n");
+
 	rq_info.init = 1;
 
 	for_each_possible_cpu(i) {
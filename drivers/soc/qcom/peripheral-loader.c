@@ -55,6 +55,7 @@
 
 #define PIL_NUM_DESC		10
 static void __iomem *pil_info_base;
+static struct workqueue_struct *pil_wq;
 
 /**
  * proxy_timeout - Override for proxy vote timeouts
@@ -96,6 +97,9 @@ struct pil_seg {
 	int num;
 	struct list_head list;
 	bool relocated;
+	struct pil_desc *desc;
+	struct work_struct load_work;
+	int load_ret;
 };
 
 /**
@@ -714,15 +718,59 @@ static int pil_load_seg(struct pil_desc *desc, struct pil_seg *seg)
 		paddr += size;
 	}
 
-	if (desc->ops->verify_blob) {
+	return ret;
+}
+
+static void pil_load_seg_work(struct work_struct *work)
+{
+	struct pil_seg *seg = container_of(work, struct pil_seg, load_work);
+
+	seg->load_ret = pil_load_seg(seg->desc, seg);
+}
+
+/**
+ * pil_load_segs() - Load all segments of an image
+ * @desc: descriptor from pil_desc_init()
+ *
+ * The segments are read from the firmware files in parallel on an unbound
+ * workqueue.  The verify_blob() callbacks expect to be called once for each
+ * segment in order, so they run after all the segments are loaded.
+ *
+ * Returns 0 on success or -ERROR on failure.
+ */
+static int pil_load_segs(struct pil_desc *desc)
+{
+	struct pil_seg *seg;
+	int ret = 0;
+
+	list_for_each_entry(seg, &desc->priv->segs, list) {
+		seg->desc = desc;
+		seg->load_ret = 0;
+		INIT_WORK(&seg->load_work, pil_load_seg_work);
+		if (pil_wq)
+			queue_work(pil_wq, &seg->load_work);
+		else
+			pil_load_seg_work(&seg->load_work);
+	}
+
+	list_for_each_entry(seg, &desc->priv->segs, list) {
+		flush_work(&seg->load_work);
+		if (!ret)
+			ret = seg->load_ret;
+	}
+	if (ret || !desc->ops->verify_blob)
+		return ret;
+
+	list_for_each_entry(seg, &desc->priv->segs, list) {
 		ret = desc->ops->verify_blob(desc, seg->paddr, seg->sz);
 		if (ret) {
-			pil_err(desc, "Blob%u failed verification\n", num);
+			pil_err(desc, "Blob%u failed verification\n", seg->num);
 			subsys_set_error(desc->subsys_dev, firmware_error_msg);
+			return ret;
 		}
 	}
 
-	return ret;
+	return 0;
 }
 
 static int pil_parse_devicetree(struct pil_desc *desc)
@@ -778,7 +826,6 @@ int pil_boot(struct pil_desc *desc)
 	char fw_name[30];
 	const struct pil_mdt *mdt;
 	const struct elf32_hdr *ehdr;
-	struct pil_seg *seg;
 	const struct firmware *fw;
 	struct pil_priv *priv = desc->priv;
 	bool mem_protect = false;
@@ -870,11 +917,9 @@ int pil_boot(struct pil_desc *desc)
 		hyp_assign = true;
 	}
 
-	list_for_each_entry(seg, &desc->priv->segs, list) {
-		ret = pil_load_seg(desc, seg);
-		if (ret)
-			goto err_deinit_image;
-	}
+	ret = pil_load_segs(desc);
+	if (ret)
+		goto err_deinit_image;
 
 	if (desc->subsys_vmid > 0) {
 		ret =  pil_reclaim_mem(desc, priv->region_start,
@@ -1134,6 +1179,9 @@ static int __init msm_pil_init(void)
 		writel_relaxed(0, pil_info_base + (i * sizeof(u32)));
 
 out:
+	pil_wq = alloc_workqueue("pil_wq", WQ_UNBOUND | WQ_HIGHPRI, 0);
+	if (!pil_wq)
+		pr_warn("pil: could not allocate workqueue, loading segments serially\n");
 	return register_pm_notifier(&pil_pm_notifier);
 }
 device_initcall(msm_pil_init);
@@ -1141,6 +1189,8 @@ device_initcall(msm_pil_init);
 static void __exit msm_pil_exit(void)
 {
 	unregister_pm_notifier(&pil_pm_notifier);
+	if (pil_wq)
+		destroy_workqueue(pil_wq);
 	if (pil_info_base)
 		iounmap(pil_info_base);
 }
@@ -24,12 +24,17 @@
 #include <linux/uaccess.h>
 #include <linux/elf.h>
 #include <linux/wait.h>
+#include <linux/vmalloc.h>
+#include <linux/mutex.h>
 #include <soc/qcom/ramdump.h>
 #include <linux/dma-mapping.h>
 #include <linux/of.h>
 
 #define RAMDUMP_WAIT_MSECS	120000
 
+static unsigned int snapshot_max_kb = SZ_16K;
+module_param(snapshot_max_kb, uint, S_IRUGO | S_IWUSR);
+
 struct ramdump_device {
 	char name[256];
 
@@ -47,8 +52,45 @@ struct ramdump_device {
 	char *elfcore_buf;
 	struct dma_attrs attrs;
 	bool complete_ramdump;
+
+	struct mutex snapshot_lock;
+	char *snapshot_buf;
+	size_t snapshot_size;
 };
 
+static void ramdump_free_snapshot(struct ramdump_device *rd_dev)
+{
+	vfree(rd_dev->snapshot_buf);
+	rd_dev->snapshot_buf = NULL;
+	rd_dev->snapshot_size = 0;
+}
+
+/*
+ * Serves reads of a dump captured by do_elf_ramdump_snapshot().  The capture
+ * is dropped once it has been read to the end.
+ */
+static ssize_t ramdump_read_snapshot(struct ramdump_device *rd_dev,
+			char __user *buf, size_t count, loff_t *pos)
+{
+	size_t copy_size;
+
+	if (*pos >= rd_dev->snapshot_size) {
+		pr_debug("Ramdump(%s): Snapshot complete. %lld bytes read.",
+			rd_dev->name, *pos);
+		ramdump_free_snapshot(rd_dev);
+		rd_dev->data_ready = 0;
+		*pos = 0;
+		return 0;
+	}
+
+	copy_size = min_t(size_t, count, rd_dev->snapshot_size - *pos);
+	if (copy_to_user(buf, rd_dev->snapshot_buf + *pos, copy_size))
+		return -EFAULT;
+
+	*pos += copy_size;
+	return copy_size;
+}
+
 static int ramdump_open(struct inode *inode, struct file *filep)
 {
 	struct ramdump_device *rd_dev = container_of(filep->private_data,
@@ -63,7 +105,10 @@ static int ramdump_release(struct inode *inode, struct file *filep)
 	struct ramdump_device *rd_dev = container_of(filep->private_data,
 				struct ramdump_device, device);
 	rd_dev->consumer_present = 0;
-	rd_dev->data_ready = 0;
+	/* an uncollected snapshot stays available to the next reader */
+	mutex_lock(&rd_dev->snapshot_lock);
+	rd_dev->data_ready = rd_dev->snapshot_buf ? 1 : 0;
+	mutex_unlock(&rd_dev->snapshot_lock);
 	complete(&rd_dev->ramdump_complete);
 	return 0;
 }
@@ -122,6 +167,14 @@ static ssize_t ramdump_read(struct file *filep, char __user *buf, size_t count,
 	if (ret)
 		return ret;
 
+	mutex_lock(&rd_dev->snapshot_lock);
+	if (rd_dev->snapshot_buf) {
+		ret = ramdump_read_snapshot(rd_dev, buf, count, pos);
+		mutex_unlock(&rd_dev->snapshot_lock);
+		return ret;
+	}
+	mutex_unlock(&rd_dev->snapshot_lock);
+
 	if (*pos < rd_dev->elfcore_size) {
 		copy_size = rd_dev->elfcore_size - *pos;
 		copy_size = min(copy_size, count);
@@ -269,6 +322,7 @@ void *create_ramdump_device(const char *dev_name, struct device *parent)
 		 dev_name);
 
 	init_completion(&rd_dev->ramdump_complete);
+	mutex_init(&rd_dev->snapshot_lock);
 
 	rd_dev->device.minor = MISC_DYNAMIC_MINOR;
 	rd_dev->device.name = rd_dev->name;
@@ -305,6 +359,7 @@ void destroy_ramdump_device(void *dev)
 		return;
 
 	misc_deregister(&rd_dev->device);
+	ramdump_free_snapshot(rd_dev);
 	kfree(rd_dev);
 }
 EXPORT_SYMBOL(destroy_ramdump_device);
@@ -323,6 +378,11 @@ static int _do_ramdump(void *handle, struct ramdump_segment *segments,
 		return -EPIPE;
 	}
 
+	/* a live dump supersedes a snapshot that was never collected */
+	mutex_lock(&rd_dev->snapshot_lock);
+	ramdump_free_snapshot(rd_dev);
+	mutex_unlock(&rd_dev->snapshot_lock);
+
 	if (rd_dev->complete_ramdump) {
 		for (i = 0; i < nsegments-1; i++)
 			segments[i].size =
@@ -409,3 +469,112 @@ do_elf_ramdump(void *handle, struct ramdump_segment *segments, int nsegments)
 	return _do_ramdump(handle, segments, nsegments, true);
 }
 EXPORT_SYMBOL(do_elf_ramdump);
+
+static int ramdump_copy_segment(struct ramdump_device *rd_dev, char *dst,
+				struct ramdump_segment *seg)
+{
+	unsigned long done, size;
+	void *device_mem;
+
+	if (seg->v_address) {
+		memcpy_fromio(dst, seg->v_address, seg->size);
+		return 0;
+	}
+
+	init_dma_attrs(&rd_dev->attrs);
+	dma_set_attr(DMA_ATTR_SKIP_ZEROING, &rd_dev->attrs);
+	for (done = 0; done < seg->size; done += size) {
+		size = min_t(unsigned long, seg->size - done, MAX_IOREMAP_SIZE);
+		device_mem = dma_remap(rd_dev->device.parent, NULL,
+				seg->address + done, size, &rd_dev->attrs);
+		if (!device_mem)
+			return -ENOMEM;
+		memcpy_fromio(dst + done, device_mem, size);
+		dma_unremap(rd_dev->device.parent, device_mem, size);
+	}
+	return 0;
+}
+
+/**
+ * do_elf_ramdump_snapshot() - Capture an ELF ramdump for later collection
+ * @handle:	Ramdump device from create_ramdump_device().
+ * @segments:	Regions to dump.
+ * @nsegments:	Number of entries in @segments.
+ *
+ * Unlike do_elf_ramdump(), which blocks until userspace has read the dump
+ * from the live memory, the regions are copied into a kernel buffer right
+ * away so the caller can restart the subsystem immediately.  The capture
+ * is exported through the same device node and released once it has been
+ * read.  Meant for small dumps such as minimized critical-memory dumps;
+ * captures larger than the snapshot_max_kb module parameter are refused.
+ *
+ * Return: 0 on success or standard Linux error code.
+ */
+int do_elf_ramdump_snapshot(void *handle, struct ramdump_segment *segments,
+		int nsegments)
+{
+	struct ramdump_device *rd_dev = (struct ramdump_device *)handle;
+	Elf32_Phdr *phdr;
+	Elf32_Ehdr *ehdr;
+	size_t hdr_size, size;
+	char *snapshot;
+	int i, ret;
+
+	hdr_size = sizeof(*ehdr) + sizeof(*phdr) * nsegments;
+	size = hdr_size;
+	for (i = 0; i < nsegments; i++)
+		size += segments[i].size;
+
+	if (size > (size_t)snapshot_max_kb * SZ_1K) {
+		pr_err("Ramdump(%s): snapshot of %zu bytes exceeds limit\n",
+			rd_dev->name, size);
+		return -E2BIG;
+	}
+
+	snapshot = vzalloc(size);
+	if (!snapshot)
+		return -ENOMEM;
+
+	ehdr = (Elf32_Ehdr *)snapshot;
+	memcpy(ehdr->e_ident, ELFMAG, SELFMAG);
+	ehdr->e_ident[EI_CLASS] = ELFCLASS32;
+	ehdr->e_ident[EI_DATA] = ELFDATA2LSB;
+	ehdr->e_ident[EI_VERSION] = EV_CURRENT;
+	ehdr->e_ident[EI_OSABI] = ELFOSABI_NONE;
+	ehdr->e_type = ET_CORE;
+	ehdr->e_version = EV_CURRENT;
+	ehdr->e_phoff = sizeof(*ehdr);
+	ehdr->e_ehsize = sizeof(*ehdr);
+	ehdr->e_phentsize = sizeof(*phdr);
+	ehdr->e_phnum = nsegments;
+
+	size = hdr_size;
+	phdr = (Elf32_Phdr *)(ehdr + 1);
+	for (i = 0; i < nsegments; i++, phdr++) {
+		ret = ramdump_copy_segment(rd_dev, snapshot + size,
+					   &segments[i]);
+		if (ret) {
+			pr_err("Ramdump(%s): Unable to map segment %d\n",
+				rd_dev->name, i);
+			vfree(snapshot);
+			return ret;
+		}
+		phdr->p_type = PT_LOAD;
+		phdr->p_offset = size;
+		phdr->p_vaddr = phdr->p_paddr = segments[i].address;
+		phdr->p_filesz = phdr->p_memsz = segments[i].size;
+		phdr->p_flags = PF_R | PF_W | PF_X;
+		size += segments[i].size;
+	}
+
+	mutex_lock(&rd_dev->snapshot_lock);
+	ramdump_free_snapshot(rd_dev);
+	rd_dev->snapshot_buf = snapshot;
+	rd_dev->snapshot_size = size;
+	rd_dev->data_ready = 1;
+	mutex_unlock(&rd_dev->snapshot_lock);
+
+	wake_up(&rd_dev->dump_wait_q);
+	return 0;
+}
+EXPORT_SYMBOL(do_elf_ramdump_snapshot);
@@ -87,6 +87,7 @@ static struct glink_apps_rpm_data *glink_data;
 #define MAX_ERR_BUFFER_SIZE 128
 #define MAX_WAIT_ON_ACK 24
 #define INIT_ERROR 1
+#define MAX_ACT_CACHE_KVPS 4
 
 static ATOMIC_NOTIFIER_HEAD(msm_rpm_sleep_notifier);
 static bool standalone;
@@ -338,8 +339,177 @@ struct msm_rpm_request {
 	uint32_t write_idx;
 	uint8_t *buf;
 	uint32_t numbytes;
+	bool batched;
 };
 
+/*
+ * Active set values last sent to the RPM for resources voted on through
+ * msm_rpm_send_message_batch(). Only values up to 8 bytes are tracked;
+ * larger KVPs are always sent. The cache is filtered against and updated
+ * under send_mtx, together with the send itself, so it follows the order
+ * in which the RPM receives requests; an entry is dropped when a request
+ * for its resource fails.
+ */
+struct act_cache {
+	struct rb_node node;
+	uint32_t rsc_type;
+	uint32_t rsc_id;
+	uint32_t nkvps;
+	struct {
+		uint32_t key;
+		uint32_t nbytes;
+		uint64_t value;
+	} kvp[MAX_ACT_CACHE_KVPS];
+};
+static struct rb_root act_root = RB_ROOT;
+static DEFINE_SPINLOCK(act_cache_lock);
+
+static struct act_cache *act_cache_search(uint32_t type, uint32_t id)
+{
+	struct rb_node *node = act_root.rb_node;
+
+	while (node) {
+		struct act_cache *cur = rb_entry(node, struct act_cache, node);
+
+		if (type < cur->rsc_type)
+			node = node->rb_left;
+		else if (type > cur->rsc_type)
+			node = node->rb_right;
+		else if (id < cur->rsc_id)
+			node = node->rb_left;
+		else if (id > cur->rsc_id)
+			node = node->rb_right;
+		else
+			return cur;
+	}
+	return NULL;
+}
+
+static struct act_cache *act_cache_get(uint32_t type, uint32_t id)
+{
+	struct rb_node **node = &act_root.rb_node, *parent = NULL;
+	struct act_cache *s;
+
+	while (*node) {
+		struct act_cache *cur = rb_entry(*node, struct act_cache, node);
+
+		parent = *node;
+
+		if (type < cur->rsc_type)
+			node = &((*node)->rb_left);
+		else if (type > cur->rsc_type)
+			node = &((*node)->rb_right);
+		else if (id < cur->rsc_id)
+			node = &((*node)->rb_left);
+		else if (id > cur->rsc_id)
+			node = &((*node)->rb_right);
+		else
+			return cur;
+	}
+
+	s = kzalloc(sizeof(*s), GFP_ATOMIC);
+	if (!s)
+		return NULL;
+
+	s->rsc_type = type;
+	s->rsc_id = id;
+	rb_link_node(&s->node, parent, node);
+	rb_insert_color(&s->node, &act_root);
+	return s;
+}
+
+/*
+ * Forget the cached active set of a resource that is being voted on
+ * outside of a batch, or whose request failed, so the next batch resends
+ * all of its KVPs.
+ */
+static void msm_rpm_act_cache_drop(uint32_t type, uint32_t id)
+{
+	struct act_cache *s;
+	unsigned long flags;
+
+	if (RB_EMPTY_ROOT(&act_root))
+		return;
+
+	spin_lock_irqsave(&act_cache_lock, flags);
+	s = act_cache_search(type, id);
+	if (s)
+		rb_erase(&s->node, &act_root);
+	spin_unlock_irqrestore(&act_cache_lock, flags);
+
+	kfree(s);
+}
+
+/* Invalidate the KVPs of @req whose value the RPM already holds */
+static void msm_rpm_act_cache_filter(struct msm_rpm_request *req)
+{
+	struct act_cache *s;
+	unsigned long flags;
+	uint32_t i, j;
+
+	spin_lock_irqsave(&act_cache_lock, flags);
+	s = act_cache_search(req->msg_hdr.resource_type,
+			req->msg_hdr.resource_id);
+
+	for (i = 0; s && i < req->write_idx; i++) {
+		struct msm_rpm_kvp_data *k = &req->kvp[i];
+
+		if (!k->valid)
+			continue;
+
+		for (j = 0; j < s->nkvps; j++) {
+			if (s->kvp[j].key != k->key)
+				continue;
+			if (s->kvp[j].nbytes == k->nbytes &&
+				!memcmp(&s->kvp[j].value, k->value, k->nbytes)) {
+				k->valid = false;
+				req->msg_hdr.data_len -= k->nbytes +
+					sizeof(struct rpm_request_header);
+			}
+			break;
+		}
+	}
+	spin_unlock_irqrestore(&act_cache_lock, flags);
+}
+
+/* Record every KVP of an active set request sent to the RPM */
+static void msm_rpm_act_cache_update(struct msm_rpm_request *req)
+{
+	struct act_cache *s;
+	unsigned long flags;
+	uint32_t i, j;
+
+	spin_lock_irqsave(&act_cache_lock, flags);
+	s = act_cache_get(req->msg_hdr.resource_type,
+			req->msg_hdr.resource_id);
+
+	for (i = 0; s && i < req->write_idx; i++) {
+		struct msm_rpm_kvp_data *k = &req->kvp[i];
+
+		for (j = 0; j < s->nkvps; j++)
+			if (s->kvp[j].key == k->key)
+				break;
+
+		if (k->nbytes > sizeof(s->kvp[j].value)) {
+			if (j < s->nkvps)
+				s->kvp[j] = s->kvp[--s->nkvps];
+			continue;
+		}
+
+		if (j == s->nkvps) {
+			if (s->nkvps == MAX_ACT_CACHE_KVPS)
+				continue;
+			s->nkvps++;
+		}
+
+		s->kvp[j].key = k->key;
+		s->kvp[j].nbytes = k->nbytes;
+		s->kvp[j].value = 0;
+		memcpy(&s->kvp[j].value, k->value, k->nbytes);
+	}
+	spin_unlock_irqrestore(&act_cache_lock, flags);
+}
+
 /*
  * Data related to message acknowledgment
  */
@@ -1264,6 +1434,10 @@ static int msm_rpm_send_data(struct msm_rpm_request *cdata,
 			GFP_FLAG(noirq)))
 		return 1;
 
+	if (cdata->msg_hdr.set == MSM_RPM_CTX_ACTIVE_SET && !cdata->batched)
+		msm_rpm_act_cache_drop(cdata->msg_hdr.resource_type,
+				cdata->msg_hdr.resource_id);
+
 	cdata->msg_hdr.msg_id = msm_rpm_get_next_msg_id();
 
 	memcpy(cdata->buf + req_hdr_sz, &cdata->msg_hdr, msg_hdr_sz);
@@ -1305,13 +1479,23 @@ static int msm_rpm_send_data(struct msm_rpm_request *cdata,
 	return ret;
 }
 
+static DEFINE_MUTEX(send_mtx);
+
 static int _msm_rpm_send_request(struct msm_rpm_request *handle, bool noack)
 {
 	int ret;
-	static DEFINE_MUTEX(send_mtx);
+	bool cached = handle->batched &&
+		handle->msg_hdr.set == MSM_RPM_CTX_ACTIVE_SET;
 
 	mutex_lock(&send_mtx);
+	if (cached)
+		msm_rpm_act_cache_filter(handle);
 	ret = msm_rpm_send_data(handle, MSM_RPM_MSG_REQUEST_TYPE, false, noack);
+	if (cached && ret > 0)
+		msm_rpm_act_cache_update(handle);
+	else if (cached)
+		msm_rpm_act_cache_drop(handle->msg_hdr.resource_type,
+				handle->msg_hdr.resource_id);
 	mutex_unlock(&send_mtx);
 
 	return ret;
@@ -1542,6 +1726,130 @@ bail:
 }
 EXPORT_SYMBOL(msm_rpm_send_message_noirq);
 
+static inline bool msm_rpm_batch_same_rsc(const struct msm_rpm_batch_msg *a,
+		const struct msm_rpm_batch_msg *b)
+{
+	return a->set == b->set && a->rsc_type == b->rsc_type &&
+		a->rsc_id == b->rsc_id;
+}
+
+static struct msm_rpm_request *msm_rpm_batch_lookup(
+		struct msm_rpm_request **reqs, int nreqs,
+		const struct msm_rpm_batch_msg *msg)
+{
+	int i;
+
+	for (i = 0; i < nreqs; i++)
+		if (reqs[i]->msg_hdr.set == msg->set &&
+			reqs[i]->msg_hdr.resource_type == msg->rsc_type &&
+			reqs[i]->msg_hdr.resource_id == msg->rsc_id)
+			return reqs[i];
+	return NULL;
+}
+
+static int msm_rpm_batch_complete(struct msm_rpm_request *req, int msg_id)
+{
+	int rc = msm_rpm_wait_for_ack(msg_id);
+
+	/* The RPM may not hold the values cached when they were sent */
+	if (rc && req->msg_hdr.set == MSM_RPM_CTX_ACTIVE_SET) {
+		mutex_lock(&send_mtx);
+		msm_rpm_act_cache_drop(req->msg_hdr.resource_type,
+				req->msg_hdr.resource_id);
+		mutex_unlock(&send_mtx);
+	}
+	return rc;
+}
+
+int msm_rpm_send_message_batch(struct msm_rpm_batch_msg *msgs, int count)
+{
+	struct msm_rpm_request **reqs;
+	int *msg_ids;
+	int i, j, nreqs = 0, done = 0;
+	int rc = 0, ret;
+
+	if (probe_status)
+		return probe_status;
+
+	if (!msgs || count < 0)
+		return -EINVAL;
+
+	if (!count)
+		return 0;
+
+	reqs = kcalloc(count, sizeof(*reqs), GFP_NOIO);
+	msg_ids = kcalloc(count, sizeof(*msg_ids), GFP_NOIO);
+	if (!reqs || !msg_ids) {
+		rc = -ENOMEM;
+		goto bail;
+	}
+
+	/*
+	 * Fold every message aimed at the same resource and set into a
+	 * single request; a key written twice keeps its last value.
+	 */
+	for (i = 0; i < count; i++) {
+		struct msm_rpm_request *req;
+
+		req = msm_rpm_batch_lookup(reqs, nreqs, &msgs[i]);
+		if (!req) {
+			int nelems = 0;
+
+			for (j = i; j < count; j++)
+				if (msm_rpm_batch_same_rsc(&msgs[i], &msgs[j]))
+					nelems += msgs[j].nelems;
+
+			req = msm_rpm_create_request(msgs[i].set,
+					msgs[i].rsc_type, msgs[i].rsc_id,
+					nelems);
+			if (IS_ERR_OR_NULL(req)) {
+				rc = req ? PTR_ERR(req) : -ENOMEM;
+				goto bail;
+			}
+			req->batched = true;
+			reqs[nreqs++] = req;
+		}
+
+		for (j = 0; j < msgs[i].nelems; j++) {
+			rc = msm_rpm_add_kvp_data(req, msgs[i].kvp[j].key,
+					msgs[i].kvp[j].data,
+					msgs[i].kvp[j].length);
+			if (rc)
+				goto bail;
+		}
+	}
+
+	/*
+	 * Send the whole batch before waiting on any ack, but keep no more
+	 * than MAX_WAIT_ON_ACK requests in flight so as not to overrun the
+	 * channel.
+	 */
+	for (i = 0; i < nreqs; i++) {
+		if (i - done >= MAX_WAIT_ON_ACK) {
+			ret = msm_rpm_batch_complete(reqs[done],
+					msg_ids[done]);
+			if (ret && !rc)
+				rc = ret;
+			done++;
+		}
+
+		msg_ids[i] = msm_rpm_send_request(reqs[i]);
+	}
+
+	for (; done < nreqs; done++) {
+		ret = msm_rpm_batch_complete(reqs[done], msg_ids[done]);
+		if (ret && !rc)
+			rc = ret;
+	}
+bail:
+	for (i = 0; i < nreqs; i++)
+		msm_rpm_free_request(reqs[i]);
+	kfree(msg_ids);
+	kfree(reqs);
+	return rc;
+}
+EXPORT_SYMBOL(msm_rpm_send_message_batch);
+
 /**
  * During power collapse, the rpm driver disables the SMD interrupts to make
  * sure that the interrupt doesn't wakes us from sleep.
@@ -47,6 +47,7 @@ struct mem_prot_info {
 #define MEM_PROTECT_LOCK_ID2		0x0A
 #define MEM_PROTECT_LOCK_ID2_FLAT	0x11
 #define V2_CHUNK_SIZE		SZ_1M
+#define CHUNK_LIST_MAX		(PAGE_SIZE / sizeof(u32))
 #define FEATURE_ID_CP 12
 
 struct dest_vm_and_perm_info {
@@ -96,18 +97,64 @@ static int secure_buffer_change_chunk(u32 chunks,
 
 
 
+/*
+ * Lock or unlock the chunks gathered so far with a single SCM call, and
+ * update the private page flag of the @ndone scatterlist entries starting
+ * at @sg whose chunks are now all handled.
+ */
+static int secure_buffer_flush_chunks(u32 *chunk_list, u32 nchunks,
+				struct scatterlist *sg, int ndone, int lock)
+{
+	int ret;
+
+	/*
+	 * Flush the chunk list before sending the memory to the
+	 * secure environment to ensure the data is actually present
+	 * in RAM
+	 */
+	dmac_flush_range(chunk_list, (void *)chunk_list +
+			 nchunks * sizeof(*chunk_list));
+
+	ret = secure_buffer_change_chunk(virt_to_phys(chunk_list),
+			nchunks, V2_CHUNK_SIZE, lock);
+	if (ret)
+		return ret;
+
+	/*
+	 * Set or clear the private page flag to communicate the
+	 * status of the chunk to other entities
+	 */
+	for (; ndone > 0; ndone--, sg = sg_next(sg)) {
+		if (lock)
+			SetPagePrivate(sg_page(sg));
+		else
+			ClearPagePrivate(sg_page(sg));
+	}
+
+	return 0;
+}
+
+/*
+ * The chunks of all scatterlist entries are packed into one list so that
+ * a whole table costs one call into the secure world rather than one per
+ * entry; the list is only split when it outgrows a page.
+ */
 static int secure_buffer_change_table(struct sg_table *table, int lock)
 {
 	int i, j;
 	int ret = -EINVAL;
 	u32 *chunk_list;
-	struct scatterlist *sg;
+	u32 nchunks = 0;
+	int ndone = 0;
+	struct scatterlist *sg, *sg_done = table->sgl;
+
+	chunk_list = kzalloc(CHUNK_LIST_MAX * sizeof(*chunk_list),
+			     GFP_KERNEL);
+	if (!chunk_list)
+		return -ENOMEM;
 
 	for_each_sg(table->sgl, sg, table->nents, i) {
-		int nchunks;
 		int size = sg->length;
-		int chunk_list_len;
-		phys_addr_t chunk_list_phys;
 
 		/*
 		 * This should theoretically be a phys_addr_t but the protocol
@@ -122,48 +169,32 @@ static int secure_buffer_change_table(struct sg_table *table, int lock)
 			WARN(1,
 				"%s: chunk %d has invalid size: 0x%x. Must be a multiple of 0x%x\n",
 				__func__, i, size, V2_CHUNK_SIZE);
-			return -EINVAL;
+			ret = -EINVAL;
+			goto out;
 		}
 
 		base = (u32)tmp;
 
-		nchunks = size / V2_CHUNK_SIZE;
-		chunk_list_len = sizeof(u32)*nchunks;
-
-		chunk_list = kzalloc(chunk_list_len, GFP_KERNEL);
-
-		if (!chunk_list)
-			return -ENOMEM;
-
-		chunk_list_phys = virt_to_phys(chunk_list);
-		for (j = 0; j < nchunks; j++)
-			chunk_list[j] = base + j * V2_CHUNK_SIZE;
-
-		/*
-		 * Flush the chunk list before sending the memory to the
-		 * secure environment to ensure the data is actually present
-		 * in RAM
-		 */
-		dmac_flush_range(chunk_list,
-			(void *)chunk_list + chunk_list_len);
-
-		ret = secure_buffer_change_chunk(virt_to_phys(chunk_list),
-				nchunks, V2_CHUNK_SIZE, lock);
-
-		if (!ret) {
-			/*
-			 * Set or clear the private page flag to communicate the
-			 * status of the chunk to other entities
-			 */
-			if (lock)
-				SetPagePrivate(sg_page(sg));
-			else
-				ClearPagePrivate(sg_page(sg));
+		for (j = 0; j < size / V2_CHUNK_SIZE; j++) {
+			if (nchunks == CHUNK_LIST_MAX) {
+				ret = secure_buffer_flush_chunks(chunk_list,
+						nchunks, sg_done, ndone, lock);
+				if (ret)
+					goto out;
+				for (; ndone > 0; ndone--)
+					sg_done = sg_next(sg_done);
+				nchunks = 0;
+			}
+			chunk_list[nchunks++] = base + j * V2_CHUNK_SIZE;
 		}
-
-		kfree(chunk_list);
+		ndone++;
 	}
 
+	if (nchunks)
+		ret = secure_buffer_flush_chunks(chunk_list, nchunks, sg_done,
+						 ndone, lock);
+out:
+	kfree(chunk_list);
 	return ret;
 }
 
@@ -221,7 +252,8 @@ populate_dest_info(int *dest_vmids, int nelements, int *dest_perms,
 /* Must hold secure_buffer_mutex while allocated buffer is in use */
 static unsigned int get_batches_from_sgl(struct mem_prot_info *sg_table_copy,
 					 struct scatterlist *sgl,
-					 struct scatterlist **next_sgl)
+					 struct scatterlist **next_sgl,
+					 unsigned int *nents)
 {
 	u64 batch_size = 0;
 	unsigned int i = 0;
@@ -229,11 +261,24 @@ static unsigned int get_batches_from_sgl(struct mem_prot_info *sg_table_copy,
 
 	/* Ensure no zero size batches */
 	do {
-		sg_table_copy[i].addr = page_to_phys(sg_page(curr_sgl));
-		sg_table_copy[i].size = curr_sgl->length;
-		batch_size += sg_table_copy[i].size;
+		phys_addr_t addr = page_to_phys(sg_page(curr_sgl));
+
+		/*
+		 * Physically contiguous entries are merged into one section
+		 * so a call covers up to BATCH_MAX_SIZE, not only
+		 * BATCH_MAX_SECTIONS entries.
+		 */
+		if (i && sg_table_copy[i - 1].addr +
+				sg_table_copy[i - 1].size == addr) {
+			sg_table_copy[i - 1].size += curr_sgl->length;
+		} else {
+			sg_table_copy[i].addr = addr;
+			sg_table_copy[i].size = curr_sgl->length;
+			i++;
+		}
+		batch_size += curr_sgl->length;
 		curr_sgl = sg_next(curr_sgl);
-		i++;
+		(*nents)++;
 	} while (curr_sgl && i < BATCH_MAX_SECTIONS &&
 		 curr_sgl->length + batch_size < BATCH_MAX_SIZE);
 
@@ -246,6 +291,7 @@ static int batched_hyp_assign(struct sg_table *table, struct scm_desc *desc)
 	unsigned int entries_size;
 	unsigned int batch_start = 0;
 	unsigned int batches_processed;
+	unsigned int nents;
 	struct scatterlist *curr_sgl = table->sgl;
 	struct scatterlist *next_sgl;
 	int ret = 0;
@@ -257,8 +303,10 @@ static int batched_hyp_assign(struct sg_table *table, struct scm_desc *desc)
 		return -ENOMEM;
 
 	while (batch_start < table->nents) {
+		nents = 0;
 		batches_processed = get_batches_from_sgl(sg_table_copy,
-							 curr_sgl, &next_sgl);
+							 curr_sgl, &next_sgl,
+							 &nents);
 		curr_sgl = next_sgl;
 		entries_size = batches_processed * sizeof(*sg_table_copy);
 		dmac_flush_range(sg_table_copy,
@@ -274,7 +322,7 @@ static int batched_hyp_assign(struct sg_table *table, struct scm_desc *desc)
 			break;
 		}
 
-		batch_start += batches_processed;
+		batch_start += nents;
 	}
 
 	kfree(sg_table_copy);
@@ -26,6 +26,7 @@
 #include <linux/clk.h>
 #include <linux/msm-bus.h>
 #include <linux/of.h>
+#include <linux/workqueue.h>
 #include <soc/qcom/scm.h>
 #include <asm/cacheflush.h>
 #include "smcinvoke_object.h"
@@ -84,6 +85,17 @@ static bool support_clocks;
 static uint32_t ce_opp_freq_hz;
 static enum bandwidth_request_mode current_mode;
 
+/*
+ * The bus vote and CE clocks are kept on for SMCINVOKE_BW_RELEASE_DELAY_MS
+ * after the last invoke completes, so that back to back invokes do not
+ * pay for a clock enable/disable and a bus update on every call.
+ */
+#define SMCINVOKE_BW_RELEASE_DELAY_MS	100
+static bool bw_held;
+static uint32_t bw_active_cnt;
+static void smcinvoke_bw_release_work(struct work_struct *work);
+static DECLARE_DELAYED_WORK(bw_release_work, smcinvoke_bw_release_work);
+
 struct smcinvoke_clk {
 	struct clk *clks[CE_MAX_CLK];
 	uint32_t clk_access_cnt;
@@ -210,6 +222,39 @@ out:
 	return ret;
 }
 
+static void smcinvoke_bw_release_locked(void)
+{
+	if (!bw_held || bw_active_cnt)
+		return;
+	set_msm_bus_request_locked(BW_INACTIVE);
+	bw_held = false;
+}
+
+static void smcinvoke_bw_release_work(struct work_struct *work)
+{
+	mutex_lock(&smcinvoke_lock);
+	smcinvoke_bw_release_locked();
+	mutex_unlock(&smcinvoke_lock);
+}
+
+static void smcinvoke_bw_get(void)
+{
+	mutex_lock(&smcinvoke_lock);
+	bw_active_cnt++;
+	if (!bw_held && !set_msm_bus_request_locked(BW_HIGH))
+		bw_held = true;
+	mutex_unlock(&smcinvoke_lock);
+}
+
+static void smcinvoke_bw_put(void)
+{
+	mutex_lock(&smcinvoke_lock);
+	if (!--bw_active_cnt && bw_held)
+		mod_delayed_work(system_wq, &bw_release_work,
+			msecs_to_jiffies(SMCINVOKE_BW_RELEASE_DELAY_MS));
+	mutex_unlock(&smcinvoke_lock);
+}
+
 static void deinit_clocks(void)
 {
 	int i;
@@ -356,9 +401,7 @@ static int prepare_send_scm_msg(const uint8_t *in_buf, size_t in_buf_len,
 	dmac_flush_range(in_buf, in_buf + inbuf_flush_size);
 	dmac_flush_range(out_buf, out_buf + outbuf_flush_size);
 
-	mutex_lock(&smcinvoke_lock);
-	set_msm_bus_request_locked(BW_HIGH);
-	mutex_unlock(&smcinvoke_lock);
+	smcinvoke_bw_get();
 	ret = scm_call2(SMCINVOKE_TZ_CMD, &desc);
 
 	/* process listener request */
@@ -366,9 +409,7 @@ static int prepare_send_scm_msg(const uint8_t *in_buf, size_t in_buf_len,
 		desc.ret[0] == QSEOS_RESULT_BLOCKED_ON_LISTENER))
 		ret = qseecom_process_listener_from_smcinvoke(&desc);
 
-	mutex_lock(&smcinvoke_lock);
-	set_msm_bus_request_locked(BW_INACTIVE);
-	mutex_unlock(&smcinvoke_lock);
+	smcinvoke_bw_put();
 
 	*smcinvoke_result = (int32_t)desc.ret[1];
 	if (ret || desc.ret[1] || desc.ret[2] || desc.ret[0])
@@ -744,6 +785,11 @@ static int smcinvoke_remove(struct platform_device *pdev)
 {
 	int count = 1;
 
+	cancel_delayed_work_sync(&bw_release_work);
+	mutex_lock(&smcinvoke_lock);
+	smcinvoke_bw_release_locked();
+	mutex_unlock(&smcinvoke_lock);
+
 	if (support_clocks) {
 		/* ok to call with NULL */
 		msm_bus_scale_unregister_client(qsee_perf_client);
@@ -761,10 +807,14 @@ static int smcinvoke_remove(struct platform_device *pdev)
 
 static int smcinvoke_suspend(struct platform_device *pdev, pm_message_t state)
 {
-	if (current_mode == BW_HIGH)
-		return 1;
-	else
-		return 0;
+	int ret;
+
+	/* drop a vote that is only being held for the release delay */
+	mutex_lock(&smcinvoke_lock);
+	smcinvoke_bw_release_locked();
+	ret = (current_mode == BW_HIGH) ? 1 : 0;
+	mutex_unlock(&smcinvoke_lock);
+	return ret;
 }
 
 static int smcinvoke_resume(struct platform_device *pdev)
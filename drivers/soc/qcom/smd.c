@@ -1387,6 +1387,11 @@ static void handle_smd_irq(struct remote_proc_info *r_info,
 			smd_state_change(ch, ch->last_state, tmp);
 			state_change = 1;
 		}
+		if ((ch_flags & 0x3) && ch->rx_poll) {
+			/* the reader drains the fifo on its own */
+			ch->update_state(ch);
+			ch_flags &= ~0x3;
+		}
 		if (ch_flags & 0x3) {
 			ch->update_state(ch);
 			SMD_POWER_INFO(
@@ -1512,6 +1517,40 @@ static int smd_is_packet(struct smd_alloc_elm *alloc_elm)
 					SMD_CHANNEL_TYPE(alloc_elm->type));
 }
 
+static enum hrtimer_restart smd_tx_timer_fn(struct hrtimer *timer)
+{
+	struct smd_channel *ch = container_of(timer, struct smd_channel,
+						tx_timer);
+
+	if (atomic_xchg(&ch->tx_notify_pending, 0))
+		ch->notify_other_cpu(ch);
+	return HRTIMER_NORESTART;
+}
+
+/*
+ * Tell the remote side that data was written, holding the interrupt for
+ * up to tx_coalesce so that a burst of writes raises only one.
+ */
+static void smd_notify_tx(struct smd_channel *ch)
+{
+	if (!ch->tx_coalesce.tv64) {
+		ch->notify_other_cpu(ch);
+		return;
+	}
+
+	if (!atomic_xchg(&ch->tx_notify_pending, 1))
+		hrtimer_start(&ch->tx_timer, ch->tx_coalesce,
+				HRTIMER_MODE_REL);
+}
+
+/* Send any held write notification right away */
+static void smd_flush_tx_notify(struct smd_channel *ch)
+{
+	hrtimer_cancel(&ch->tx_timer);
+	if (atomic_xchg(&ch->tx_notify_pending, 0))
+		ch->notify_other_cpu(ch);
+}
+
 static int smd_stream_write(smd_channel_t *ch, const void *_data, int len,
 				bool intr_ntfy)
 {
@@ -1543,7 +1582,7 @@ static int smd_stream_write(smd_channel_t *ch, const void *_data, int len,
 	}
 
 	if (orig_len - len && intr_ntfy)
-		ch->notify_other_cpu(ch);
+		smd_notify_tx(ch);
 
 	return orig_len - len;
 }
@@ -1756,6 +1795,8 @@ static int smd_alloc_channel(struct smd_alloc_elm *alloc_elm, int table_id,
 	}
 	ch->n = alloc_elm->cid;
 	ch->type = SMD_CHANNEL_TYPE(alloc_elm->type);
+	hrtimer_init(&ch->tx_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	ch->tx_timer.function = smd_tx_timer_fn;
 
 	if (smd_alloc(ch, table_id, r_info)) {
 		kfree(ch);
@@ -1973,6 +2014,10 @@ int smd_close(smd_channel_t *ch)
 
 	SMD_INFO("smd_close(%s)\n", ch->name);
 
+	smd_flush_tx_notify(ch);
+	ch->tx_coalesce = ktime_set(0, 0);
+	ch->rx_poll = false;
+
 	spin_lock_irqsave(&smd_lock, flags);
 	list_del(&ch->ch_list);
 
@@ -2183,6 +2228,37 @@ void smd_disable_read_intr(smd_channel_t *ch)
 }
 EXPORT_SYMBOL(smd_disable_read_intr);
 
+int smd_set_rx_poll(smd_channel_t *ch, bool poll)
+{
+	unsigned long flags;
+
+	if (!ch)
+		return -EINVAL;
+
+	spin_lock_irqsave(&smd_lock, flags);
+	ch->rx_poll = poll;
+	/* hand anything that arrived while polling back to the notifier */
+	if (!poll && ch_is_open(ch) && ch->read_avail(ch))
+		ch->notify(ch->priv, SMD_EVENT_DATA);
+	spin_unlock_irqrestore(&smd_lock, flags);
+
+	return 0;
+}
+EXPORT_SYMBOL(smd_set_rx_poll);
+
+int smd_set_tx_coalesce(smd_channel_t *ch, unsigned int usecs)
+{
+	if (!ch)
+		return -EINVAL;
+
+	if (!usecs)
+		smd_flush_tx_notify(ch);
+	ch->tx_coalesce = ns_to_ktime((u64)usecs * NSEC_PER_USEC);
+
+	return 0;
+}
+EXPORT_SYMBOL(smd_set_tx_coalesce);
+
 /**
  * Enable/disable receive interrupts for the remote processor used by a
  * particular channel.
@@ -22,6 +22,7 @@
 #include <linux/remote_spinlock.h>
 #include <linux/platform_device.h>
 #include <linux/interrupt.h>
+#include <linux/hrtimer.h>
 
 #include <soc/qcom/smd.h>
 #include <soc/qcom/smsm.h>
@@ -162,6 +163,14 @@ struct smd_channel {
 
 	char is_pkt_ch;
 
+	/* reader polls the fifo; data events are not delivered */
+	bool rx_poll;
+
+	/* write notifications to the remote are held for tx_coalesce */
+	ktime_t tx_coalesce;
+	struct hrtimer tx_timer;
+	atomic_t tx_notify_pending;
+
 	/*
 	 * private internal functions to access *send and *recv.
 	 * never to be exported outside of smd
@@ -12,6 +12,7 @@
 
 #include <linux/export.h>
 #include <linux/err.h>
+#include <linux/hash.h>
 #include <linux/init.h>
 #include <linux/ipc_logging.h>
 #include <linux/kernel.h>
@@ -21,6 +22,7 @@
 #include <linux/of_platform.h>
 #include <linux/platform_device.h>
 #include <linux/printk.h>
+#include <linux/seqlock.h>
 #include <linux/slab.h>
 #include <linux/stat.h>
 #include <soc/qcom/subsystem_notif.h>
@@ -140,6 +142,25 @@ struct smem_partition_info {
 static struct smem_partition_info partitions[NUM_SMEM_SUBSYSTEMS];
 /* end smem security feature components */
 
+/*
+ * Cache of resolved item lookups.  Items never move once allocated, so a
+ * successful lookup can be served again without walking the table under the
+ * remote spinlock.  Readers are lock-free, updates are serialized by the
+ * seqlock and the whole cache is flushed when a remote subsystem restarts.
+ */
+#define SMEM_LOOKUP_CACHE_BITS 6
+#define SMEM_LOOKUP_KEY_CACHED BIT(31)
+
+struct smem_lookup_entry {
+	uint32_t key;
+	uint32_t size;
+	void *item;
+};
+
+static struct smem_lookup_entry
+		smem_lookup_cache[1 << SMEM_LOOKUP_CACHE_BITS];
+static DEFINE_SEQLOCK(smem_lookup_lock);
+
 /* Identifier for the SMEM target info struct. */
 #define SMEM_TARG_INFO_IDENTIFIER 0x49494953 /* "SIII" in little-endian. */
 
@@ -842,6 +863,89 @@ void *smem_alloc(unsigned id, unsigned size_in, unsigned to_proc,
 }
 EXPORT_SYMBOL(smem_alloc);
 
+/**
+ * smem_lookup_key - Compute the lookup cache key of an item
+ *
+ * @id:       ID of SMEM item
+ * @to_proc:  SMEM host that shares the item with apps
+ * @flags:    Item attribute flags
+ * @returns:  Cache key, 0 if the lookup cannot be cached
+ */
+static uint32_t smem_lookup_key(unsigned id, unsigned to_proc, unsigned flags)
+{
+	if (id >= SMEM_NUM_ITEMS)
+		return 0;
+
+	/* items outside of a partition are shared by all hosts */
+	if (flags & SMEM_ANY_HOST_FLAG)
+		return id + 1;
+	if (to_proc >= NUM_SMEM_SUBSYSTEMS)
+		return 0;
+	if (!partitions[to_proc].offset)
+		return id + 1;
+
+	return (id + 1) | (to_proc + 1) << 16 |
+		(flags & SMEM_ITEM_CACHED_FLAG ? SMEM_LOOKUP_KEY_CACHED : 0);
+}
+
+/**
+ * smem_lookup_cache_get - Look up a previously resolved item
+ *
+ * @key:      Cache key from smem_lookup_key()
+ * @size:     Pointer to size variable for storing the result
+ * @returns:  Pointer to SMEM item or NULL on a cache miss
+ */
+static void *smem_lookup_cache_get(uint32_t key, unsigned *size)
+{
+	struct smem_lookup_entry *e;
+	unsigned seq;
+	void *item;
+	uint32_t e_size;
+
+	e = &smem_lookup_cache[hash_32(key, SMEM_LOOKUP_CACHE_BITS)];
+	do {
+		seq = read_seqbegin(&smem_lookup_lock);
+		item = e->key == key ? e->item : NULL;
+		e_size = e->size;
+	} while (read_seqretry(&smem_lookup_lock, seq));
+
+	if (item)
+		*size = e_size;
+	return item;
+}
+
+/**
+ * smem_lookup_cache_put - Remember a resolved item
+ *
+ * @key:      Cache key from smem_lookup_key()
+ * @item:     Pointer to SMEM item
+ * @size:     Size of the SMEM item
+ */
+static void smem_lookup_cache_put(uint32_t key, void *item, unsigned size)
+{
+	struct smem_lookup_entry *e;
+	unsigned long flags;
+
+	e = &smem_lookup_cache[hash_32(key, SMEM_LOOKUP_CACHE_BITS)];
+	write_seqlock_irqsave(&smem_lookup_lock, flags);
+	e->key = key;
+	e->item = item;
+	e->size = size;
+	write_sequnlock_irqrestore(&smem_lookup_lock, flags);
+}
+
+/**
+ * smem_lookup_cache_flush - Drop all cached item lookups
+ */
+static void smem_lookup_cache_flush(void)
+{
+	unsigned long flags;
+
+	write_seqlock_irqsave(&smem_lookup_lock, flags);
+	memset(smem_lookup_cache, 0, sizeof(smem_lookup_cache));
+	write_sequnlock_irqrestore(&smem_lookup_lock, flags);
+}
+
 /**
  * smem_get_entry - Get existing item with security support
  *
@@ -855,6 +959,9 @@ EXPORT_SYMBOL(smem_alloc);
 void *smem_get_entry(unsigned id, unsigned *size, unsigned to_proc,
 								unsigned flags)
 {
+	void *item;
+	uint32_t key;
+
 	SMEM_DBG("%s(%u, %u, %u)\n", __func__, id, to_proc, flags);
 
 	/*
@@ -867,7 +974,17 @@ void *smem_get_entry(unsigned id, unsigned *size, unsigned to_proc,
 	if (!is_probe_done() && id != SMEM_SPINLOCK_ARRAY)
 		return ERR_PTR(-EPROBE_DEFER);
 
-	return __smem_get_entry_secure(id, size, to_proc, flags, false, true);
+	key = smem_lookup_key(id, to_proc, flags);
+	if (key) {
+		item = smem_lookup_cache_get(key, size);
+		if (item)
+			return item;
+	}
+
+	item = __smem_get_entry_secure(id, size, to_proc, flags, false, true);
+	if (item && key)
+		smem_lookup_cache_put(key, item, *size);
+	return item;
 }
 EXPORT_SYMBOL(smem_get_entry);
 
@@ -1100,6 +1217,7 @@ static int restart_notifier_cb(struct notifier_block *this,
 				notifier->name);
 		remote_spin_release(&remote_spinlock, notifier->processor);
 		remote_spin_release_all(notifier->processor);
+		smem_lookup_cache_flush();
 		break;
 	case SUBSYS_SOC_RESET:
 		if (!(smem_ramdump_dev && notifdata->enable_mini_ramdumps))
@@ -1115,8 +1233,13 @@ static int restart_notifier_cb(struct notifier_block *this,
 		 * changes, then num_smem_areas + 1 should be passed
 		 * into do_elf_ramdump() to dump all regions.
 		 */
-		ret = do_elf_ramdump(smem_ramdump_dev,
-				smem_ramdump_segments, 1);
+		if (notifdata->defer_mini_ramdumps &&
+						!notifdata->enable_ramdump)
+			ret = do_elf_ramdump_snapshot(smem_ramdump_dev,
+					smem_ramdump_segments, 1);
+		else
+			ret = do_elf_ramdump(smem_ramdump_dev,
+					smem_ramdump_segments, 1);
 		if (ret < 0)
 			LOG_ERR("%s: unable to dump smem %d\n", __func__, ret);
 		break;
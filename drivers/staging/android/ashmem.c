@@ -93,6 +93,15 @@ static LIST_HEAD(ashmem_lru_list);
  */
 static unsigned long lru_count;
 
+/*
+ * Purge statistics, in pages and ranges, exported read-only through
+ * /sys/module/ashmem/parameters. Protected by ashmem_mutex.
+ */
+static unsigned long ashmem_purged_pages;
+module_param_named(purged_pages, ashmem_purged_pages, ulong, S_IRUGO);
+static unsigned long ashmem_purged_ranges;
+module_param_named(purged_ranges, ashmem_purged_ranges, ulong, S_IRUGO);
+
 /**
  * ashmem_mutex - protects the list of and each individual ashmem_area
  *
@@ -100,6 +109,14 @@ static unsigned long lru_count;
  */
 static DEFINE_MUTEX(ashmem_mutex);
 
+/*
+ * Purges in flight. ashmem_shrink_scan() punches holes without holding
+ * ashmem_mutex, so pin operations wait on ashmem_shrink_wait for them
+ * to finish before handing the pages back to userspace.
+ */
+static atomic_t ashmem_shrink_inflight = ATOMIC_INIT(0);
+static DECLARE_WAIT_QUEUE_HEAD(ashmem_shrink_wait);
+
 static struct kmem_cache *ashmem_area_cachep __read_mostly;
 static struct kmem_cache *ashmem_range_cachep __read_mostly;
 
@@ -465,7 +482,6 @@ out:
 static unsigned long
 ashmem_shrink_scan(struct shrinker *shrink, struct shrink_control *sc)
 {
-	struct ashmem_range *range, *next;
 	unsigned long freed = 0;
 
 	/* We might recurse into filesystem code, so bail out if necessary */
@@ -475,19 +491,39 @@ ashmem_shrink_scan(struct shrinker *shrink, struct shrink_control *sc)
 	if (!mutex_trylock(&ashmem_mutex))
 		return -1;
 
-	list_for_each_entry_safe(range, next, &ashmem_lru_list, lru) {
+	/*
+	 * Punching the hole is the slow part, so it is done with
+	 * ashmem_mutex dropped; pin/unpin and other shrinkers keep going
+	 * meanwhile. The range is taken off the LRU and marked purged
+	 * first, and the file is pinned with get_file() because the
+	 * range and its area may go away as soon as the mutex is released.
+	 */
+	while (!list_empty(&ashmem_lru_list)) {
+		struct ashmem_range *range =
+			list_first_entry(&ashmem_lru_list, typeof(*range), lru);
 		loff_t start = range->pgstart * PAGE_SIZE;
 		loff_t end = (range->pgend + 1) * PAGE_SIZE;
+		struct file *f = range->asma->file;
 
-		range->asma->file->f_op->fallocate(range->asma->file,
-				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
-				start, end - start);
+		get_file(f);
+		atomic_inc(&ashmem_shrink_inflight);
 		range->purged = ASHMEM_WAS_PURGED;
 		lru_del(range);
 
 		freed += range_size(range);
-		if (--sc->nr_to_scan <= 0)
-			break;
+		ashmem_purged_pages += range_size(range);
+		ashmem_purged_ranges++;
+		mutex_unlock(&ashmem_mutex);
+
+		f->f_op->fallocate(f,
+				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+				start, end - start);
+		fput(f);
+		if (atomic_dec_and_test(&ashmem_shrink_inflight))
+			wake_up_all(&ashmem_shrink_wait);
+
+		if (--sc->nr_to_scan <= 0 || !mutex_trylock(&ashmem_mutex))
+			return freed;
 	}
 	mutex_unlock(&ashmem_mutex);
 	return freed;
@@ -740,6 +776,7 @@ static int ashmem_pin_unpin(struct ashmem_area *asma, unsigned long cmd,
 		return -EFAULT;
 
 	mutex_lock(&ashmem_mutex);
+	wait_event(ashmem_shrink_wait, !atomic_read(&ashmem_shrink_inflight));
 
 	if (unlikely(!asma->file))
 		goto out_unlock;
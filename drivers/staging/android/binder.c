@@ -57,6 +57,7 @@
 #include <linux/file.h>
 #include <linux/freezer.h>
 #include <linux/fs.h>
+#include <linux/ktime.h>
 #include <linux/list.h>
 #include <linux/miscdevice.h>
 #include <linux/module.h>
@@ -216,6 +217,33 @@ static inline void binder_stats_created(enum binder_stat_types type)
 	atomic_inc(&binder_stats.obj_created[type]);
 }
 
+/*
+ * Transaction latency histograms. Bucket 0 counts latencies under 1us,
+ * bucket i (0 < i < BINDER_LAT_BUCKETS - 1) counts [2^(i-1), 2^i) us and
+ * the last bucket counts everything from 2^(BINDER_LAT_BUCKETS - 2) us.
+ */
+#define BINDER_LAT_BUCKETS 16
+
+/**
+ * struct binder_lat_hist - transaction latency histograms
+ * @queue:   time from BC_TRANSACTION until a thread picks the work up
+ * @handle:  time from BR_TRANSACTION until the matching BC_REPLY
+ */
+struct binder_lat_hist {
+	atomic_t queue[BINDER_LAT_BUCKETS];
+	atomic_t handle[BINDER_LAT_BUCKETS];
+};
+
+static inline void binder_lat_add(atomic_t *hist, ktime_t start, ktime_t end)
+{
+	s64 us = ktime_us_delta(end, start);
+	int bucket = 0;
+
+	if (us > 0)
+		bucket = min_t(int, fls64(us), BINDER_LAT_BUCKETS - 1);
+	atomic_inc(&hist[bucket]);
+}
+
 struct binder_transaction_log_entry {
 	int debug_id;
 	int debug_id_done;
@@ -361,6 +389,8 @@ struct binder_error {
  *                        (invariant after initialized)
  * @async_todo:           list of async work items
  *                        (protected by @proc->inner_lock)
+ * @lat:                  latency histograms for transactions to node
+ *                        (atomics, no lock needed)
  *
  * Bookkeeping structure for binder nodes.
  */
@@ -402,6 +432,7 @@ struct binder_node {
 	};
 	bool has_async_transaction;
 	struct list_head async_todo;
+	struct binder_lat_hist lat;
 };
 
 struct binder_ref_death {
@@ -518,6 +549,8 @@ struct binder_priority {
  *                        (protected by @inner_lock)
  * @stats:                per-process binder statistics
  *                        (atomics, no lock needed)
+ * @lat:                  latency histograms for transactions to process
+ *                        (atomics, no lock needed)
  * @delivered_death:      list of delivered death notification
  *                        (protected by @inner_lock)
  * @max_threads:          cap on number of binder threads
@@ -559,6 +592,7 @@ struct binder_proc {
 
 	struct list_head todo;
 	struct binder_stats stats;
+	struct binder_lat_hist lat;
 	struct list_head delivered_death;
 	int max_threads;
 	int requested_threads;
@@ -656,6 +690,8 @@ struct binder_transaction {
 	bool    set_priority_called;
 	kuid_t	sender_euid;
 	binder_uintptr_t security_ctx;
+	ktime_t	queue_ts;	/* BC_TRANSACTION, for the queue histogram */
+	ktime_t	start_ts;	/* BR_TRANSACTION, for the handle histogram */
 	/**
 	 * @lock:  protects @from, @to_proc, and @to_thread
 	 *
@@ -1239,15 +1275,17 @@ static void binder_transaction_priority(struct task_struct *task,
 		desired_prio.sched_policy = SCHED_NORMAL;
 	}
 
-	if (node_prio.prio < t->priority.prio ||
-	    (node_prio.prio == t->priority.prio &&
+	if (node_prio.prio < desired_prio.prio ||
+	    (node_prio.prio == desired_prio.prio &&
 	     node_prio.sched_policy == SCHED_FIFO)) {
 		/*
 		 * In case the minimum priority on the node is
 		 * higher (lower value), use that priority. If
 		 * the priority is the same, but the node uses
 		 * SCHED_FIFO, prefer SCHED_FIFO, since it can
-		 * run unbounded, unlike SCHED_RR.
+		 * run unbounded, unlike SCHED_RR. Compare against
+		 * the priority actually inherited, so the node
+		 * minimum still applies when RT was not inherited.
 		 */
 		desired_prio = node_prio;
 	}
@@ -2864,6 +2902,32 @@ static struct binder_node *binder_get_node_refs_for_txn(
 	return target_node;
 }
 
+/**
+ * binder_txn_lat_reply() - account handling time of a replied transaction
+ * @proc:      process sending the reply
+ * @t:         transaction being replied to
+ *
+ * The node is only reachable through @t->buffer, which userspace may
+ * already have freed with BC_FREE_BUFFER; the buffer holds a reference
+ * on the node for as long as it is attached to @t.
+ */
+static void binder_txn_lat_reply(struct binder_proc *proc,
+				 struct binder_transaction *t)
+{
+	ktime_t now;
+
+	if (!ktime_to_ns(t->start_ts))
+		return;
+
+	now = ktime_get();
+	binder_lat_add(proc->lat.handle, t->start_ts, now);
+	binder_inner_proc_lock(proc);
+	if (t->buffer && t->buffer->target_node)
+		binder_lat_add(t->buffer->target_node->lat.handle,
+			       t->start_ts, now);
+	binder_inner_proc_unlock(proc);
+}
+
 static void binder_transaction(struct binder_proc *proc,
 			       struct binder_thread *thread,
 			       struct binder_transaction_data *tr, int reply,
@@ -3102,6 +3166,8 @@ static void binder_transaction(struct binder_proc *proc,
 	t->to_thread = target_thread;
 	t->code = tr->code;
 	t->flags = tr->flags;
+	if (!reply)
+		t->queue_ts = ktime_get();
 	if (!(t->flags & TF_ONE_WAY) &&
 	    binder_supported_policy(current->policy)) {
 		/* Inherit supported policies for synchronous transactions */
@@ -3376,6 +3442,7 @@ static void binder_transaction(struct binder_proc *proc,
 		binder_inner_proc_unlock(target_proc);
 		wake_up_interruptible_sync(&target_thread->wait);
 		binder_restore_priority(current, in_reply_to->saved_priority);
+		binder_txn_lat_reply(proc, in_reply_to);
 		binder_free_transaction(in_reply_to);
 	} else if (!(t->flags & TF_ONE_WAY)) {
 		BUG_ON(t->buffer->async_transaction != 0);
@@ -4045,6 +4112,7 @@ static int binder_thread_read(struct binder_proc *proc,
 
 	int ret = 0;
 	int wait_for_proc_work;
+	bool thread_todo_empty;
 
 	if (*consumed == 0) {
 		if (put_user(BR_NOOP, (uint32_t __user *)ptr))
@@ -4053,15 +4121,22 @@ static int binder_thread_read(struct binder_proc *proc,
 	}
 
 retry:
+	/*
+	 * Sample the thread todo list for the tracepoint in the same
+	 * inner_lock section; tracepoint arguments are evaluated even
+	 * when tracing is off, so a separate binder_worklist_empty()
+	 * would cost every read another round trip on the proc lock.
+	 */
 	binder_inner_proc_lock(proc);
 	wait_for_proc_work = binder_available_for_proc_work_ilocked(thread);
+	thread_todo_empty = binder_worklist_empty_ilocked(&thread->todo);
 	binder_inner_proc_unlock(proc);
 
 	thread->looper |= BINDER_LOOPER_STATE_WAITING;
 
 	trace_binder_wait_for_work(wait_for_proc_work,
 				   !!thread->transaction_stack,
-				   !binder_worklist_empty(proc, &thread->todo));
+				   !thread_todo_empty);
 	if (wait_for_proc_work) {
 		if (!(thread->looper & (BINDER_LOOPER_STATE_REGISTERED |
 					BINDER_LOOPER_STATE_ENTERED))) {
@@ -4294,6 +4369,11 @@ retry:
 			node_prio.prio = target_node->min_priority;
 			binder_transaction_priority(current, t, node_prio,
 						    target_node->inherit_rt);
+			t->start_ts = ktime_get();
+			binder_lat_add(proc->lat.queue, t->queue_ts,
+				       t->start_ts);
+			binder_lat_add(target_node->lat.queue, t->queue_ts,
+				       t->start_ts);
 			cmd = BR_TRANSACTION;
 		} else {
 			trd->target.ptr = 0;
@@ -5818,6 +5898,67 @@ static int binder_proc_show(struct seq_file *m, void *unused)
 	return 0;
 }
 
+/**
+ * struct binder_lat_record - binary record of the latency debugfs file
+ * @pid:     process the histograms belong to
+ * @node:    debug_id of the node, 0 for the process wide histograms
+ * @queue:   see &struct binder_lat_hist
+ * @handle:  see &struct binder_lat_hist
+ *
+ * The file is a plain array of these records: one per process followed
+ * by one per node of that process that has seen any transaction.
+ */
+struct binder_lat_record {
+	u32 pid;
+	u32 node;
+	u32 queue[BINDER_LAT_BUCKETS];
+	u32 handle[BINDER_LAT_BUCKETS];
+};
+
+static bool binder_lat_record_fill(struct binder_lat_record *rec,
+				   int pid, int node,
+				   struct binder_lat_hist *lat)
+{
+	u32 total = 0;
+	int i;
+
+	rec->pid = pid;
+	rec->node = node;
+	for (i = 0; i < BINDER_LAT_BUCKETS; i++) {
+		rec->queue[i] = atomic_read(&lat->queue[i]);
+		rec->handle[i] = atomic_read(&lat->handle[i]);
+		total |= rec->queue[i] | rec->handle[i];
+	}
+
+	return total != 0;
+}
+
+static int binder_latency_show(struct seq_file *m, void *unused)
+{
+	struct binder_lat_record rec;
+	struct binder_proc *proc;
+	struct binder_node *node;
+	struct rb_node *n;
+
+	mutex_lock(&binder_procs_lock);
+	hlist_for_each_entry(proc, &binder_procs, proc_node) {
+		binder_lat_record_fill(&rec, proc->pid, 0, &proc->lat);
+		seq_write(m, &rec, sizeof(rec));
+
+		binder_inner_proc_lock(proc);
+		for (n = rb_first(&proc->nodes); n; n = rb_next(n)) {
+			node = rb_entry(n, struct binder_node, rb_node);
+			if (binder_lat_record_fill(&rec, proc->pid,
+						   node->debug_id, &node->lat))
+				seq_write(m, &rec, sizeof(rec));
+		}
+		binder_inner_proc_unlock(proc);
+	}
+	mutex_unlock(&binder_procs_lock);
+
+	return 0;
+}
+
 static void print_binder_transaction_log_entry(struct seq_file *m,
 					struct binder_transaction_log_entry *e)
 {
@@ -5880,6 +6021,7 @@ BINDER_DEBUG_ENTRY(state);
 BINDER_DEBUG_ENTRY(stats);
 BINDER_DEBUG_ENTRY(transactions);
 BINDER_DEBUG_ENTRY(transaction_log);
+BINDER_DEBUG_ENTRY(latency);
 
 static int __init init_binder_device(const char *name)
 {
@@ -5954,6 +6096,11 @@ static int __init binder_init(void)
 				    binder_debugfs_dir_entry_root,
 				    &binder_transaction_log_failed,
 				    &binder_transaction_log_fops);
+		debugfs_create_file("latency",
+				    S_IRUGO,
+				    binder_debugfs_dir_entry_root,
+				    NULL,
+				    &binder_latency_fops);
 	}
 
 	/*
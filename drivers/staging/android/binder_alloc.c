@@ -70,14 +70,16 @@ static size_t binder_alloc_buffer_size(struct binder_alloc *alloc,
 	return (u8 *)binder_buffer_next(buffer)->data - (u8 *)buffer->data;
 }
 
+static int binder_alloc_free_class(size_t size)
+{
+	return min_t(int, fls_long(size) - 1, BINDER_ALLOC_FREE_CLASSES - 1);
+}
+
 static void binder_insert_free_buffer(struct binder_alloc *alloc,
 				      struct binder_buffer *new_buffer)
 {
-	struct rb_node **p = &alloc->free_buffers.rb_node;
-	struct rb_node *parent = NULL;
-	struct binder_buffer *buffer;
-	size_t buffer_size;
 	size_t new_buffer_size;
+	int class;
 
 	BUG_ON(!new_buffer->free);
 
@@ -87,20 +89,84 @@ static void binder_insert_free_buffer(struct binder_alloc *alloc,
 		     "%d: add free buffer, size %zd, at %pK\n",
 		      alloc->pid, new_buffer_size, new_buffer);
 
-	while (*p) {
-		parent = *p;
-		buffer = rb_entry(parent, struct binder_buffer, rb_node);
-		BUG_ON(!buffer->free);
+	/*
+	 * LIFO within a class: the most recently freed buffer most
+	 * likely still has its pages mapped.
+	 */
+	class = binder_alloc_free_class(new_buffer_size);
+	list_add(&new_buffer->free_entry, &alloc->free_lists[class]);
+	__set_bit(class, &alloc->free_classes);
+}
 
-		buffer_size = binder_alloc_buffer_size(alloc, buffer);
+/*
+ * Must be called while the buffer still has the size it was inserted
+ * with, i.e. before any neighbour is added or merged away.
+ */
+static void binder_erase_free_buffer(struct binder_alloc *alloc,
+				     struct binder_buffer *buffer)
+{
+	int class;
 
-		if (new_buffer_size < buffer_size)
-			p = &parent->rb_left;
-		else
-			p = &parent->rb_right;
+	BUG_ON(!buffer->free);
+
+	class = binder_alloc_free_class(binder_alloc_buffer_size(alloc, buffer));
+	list_del(&buffer->free_entry);
+	if (list_empty(&alloc->free_lists[class]))
+		__clear_bit(class, &alloc->free_classes);
+}
+
+/* same-class buffers looked at before splitting a larger class */
+#define BINDER_ALLOC_FREE_SCAN	8
+
+static struct binder_buffer *binder_alloc_find_free_buffer(
+		struct binder_alloc *alloc, size_t size, int is_async)
+{
+	struct list_head *head;
+	struct binder_buffer *buffer, *best = NULL;
+	size_t buffer_size, best_size = 0;
+	int class = binder_alloc_free_class(size);
+	int next, scanned = 0;
+
+	/* most small parcels are satisfied by the head of their own class */
+	head = &alloc->free_lists[class];
+	list_for_each_entry(buffer, head, free_entry) {
+		if (binder_alloc_buffer_size(alloc, buffer) >= size)
+			return buffer;
+		if (++scanned == BINDER_ALLOC_FREE_SCAN)
+			break;
 	}
-	rb_link_node(&new_buffer->rb_node, parent, p);
-	rb_insert_color(&new_buffer->rb_node, &alloc->free_buffers);
+
+	/* every buffer in a higher class is large enough */
+	next = find_next_bit(&alloc->free_classes,
+			     BINDER_ALLOC_FREE_CLASSES, class + 1);
+	if (next < BINDER_ALLOC_FREE_CLASSES) {
+		head = &alloc->free_lists[next];
+		if (!is_async)
+			return list_first_entry(head, struct binder_buffer,
+						free_entry);
+		/*
+		 * Async buffers can sit in the todo list for a long time;
+		 * carve them from the smallest buffer of the class so they
+		 * do not fragment the large regions needed by sync calls.
+		 */
+		list_for_each_entry(buffer, head, free_entry) {
+			buffer_size = binder_alloc_buffer_size(alloc, buffer);
+			if (!best || buffer_size < best_size) {
+				best = buffer;
+				best_size = buffer_size;
+			}
+		}
+		return best;
+	}
+
+	/* nothing bigger left, finish the scan of the own class */
+	if (scanned == BINDER_ALLOC_FREE_SCAN) {
+		list_for_each_entry_continue(buffer, head, free_entry) {
+			if (binder_alloc_buffer_size(alloc, buffer) >= size)
+				return buffer;
+		}
+	}
+	return NULL;
 }
 
 static void binder_insert_allocated_buffer_locked(
@@ -191,6 +257,9 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 	struct binder_lru_page *page;
 	struct vm_area_struct *vma = NULL;
 	struct mm_struct *mm = NULL;
+	struct page *new_page, *tmp;
+	LIST_HEAD(new_pages);
+	size_t nr_missing = 0;
 	bool need_mm = false;
 
 	binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
@@ -207,10 +276,25 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 
 	for (page_addr = start; page_addr < end; page_addr += PAGE_SIZE) {
 		page = &alloc->pages[(page_addr - alloc->buffer) / PAGE_SIZE];
-		if (!page->page_ptr) {
-			need_mm = true;
-			break;
+		if (!page->page_ptr)
+			nr_missing++;
+	}
+	need_mm = nr_missing > 0;
+
+	/*
+	 * Allocate all the pages the range is missing up front, so that
+	 * direct reclaim never runs with mmap_sem held for writing and the
+	 * pages can be installed in one pass below. Pages of freed buffers
+	 * stay mapped on binder_alloc_lru and are reused without coming here.
+	 */
+	while (nr_missing--) {
+		new_page = alloc_page(GFP_KERNEL | __GFP_HIGHMEM | __GFP_ZERO);
+		if (!new_page) {
+			pr_err("%d: binder_alloc_buf failed to allocate pages for %pK-%pK\n",
+				alloc->pid, start, end);
+			goto err_free_new_pages;
 		}
+		list_add_tail(&new_page->lru, &new_pages);
 	}
 
 	/* Same as mmget_not_zero() in later kernel versions */
@@ -250,22 +334,14 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 			goto err_page_ptr_cleared;
 
 		trace_binder_alloc_page_start(alloc, index);
-		page->page_ptr = alloc_page(GFP_KERNEL |
-					    __GFP_HIGHMEM |
-					    __GFP_ZERO);
-		if (!page->page_ptr) {
-			pr_err("%d: binder_alloc_buf failed for page at %pK\n",
-				alloc->pid, page_addr);
-			goto err_alloc_page_failed;
-		}
+		page->page_ptr = list_first_entry(&new_pages, struct page, lru);
+		list_del(&page->page_ptr->lru);
 		page->alloc = alloc;
 		INIT_LIST_HEAD(&page->lru);
 
 		ret = map_kernel_range_noflush((unsigned long)page_addr,
 					       PAGE_SIZE, PAGE_KERNEL,
 					       &page->page_ptr);
-		flush_cache_vmap((unsigned long)page_addr,
-				(unsigned long)page_addr + PAGE_SIZE);
 		if (ret != 1) {
 			pr_err("%d: binder_alloc_buf failed to map page at %pK in kernel\n",
 			       alloc->pid, page_addr);
@@ -286,6 +362,8 @@ static int binder_update_page_range(struct binder_alloc *alloc, int allocate,
 		trace_binder_alloc_page_end(alloc, index);
 		/* vm_insert_page does not seem to increment the refcount */
 	}
+	/* one cache flush for every kernel mapping set up above */
+	flush_cache_vmap((unsigned long)start, (unsigned long)end);
 	if (mm) {
 		up_write(&mm->mmap_sem);
 		mmput(mm);
@@ -314,16 +392,29 @@ err_vm_insert_page_failed:
 err_map_kernel_failed:
 		__free_page(page->page_ptr);
 		page->page_ptr = NULL;
-err_alloc_page_failed:
 err_page_ptr_cleared:
 		;
 	}
+	/* pages mapped before the failure were left on binder_alloc_lru */
+	if (allocate)
+		flush_cache_vmap((unsigned long)start, (unsigned long)end);
 err_no_vma:
 	if (mm) {
 		up_write(&mm->mmap_sem);
 		mmput(mm);
 	}
+	list_for_each_entry_safe(new_page, tmp, &new_pages, lru) {
+		list_del(&new_page->lru);
+		__free_page(new_page);
+	}
 	return vma ? -ENOMEM : -ESRCH;
+
+err_free_new_pages:
+	list_for_each_entry_safe(new_page, tmp, &new_pages, lru) {
+		list_del(&new_page->lru);
+		__free_page(new_page);
+	}
+	return -ENOMEM;
 }
 
 struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
@@ -332,10 +423,9 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 						  size_t extra_buffers_size,
 						  int is_async)
 {
-	struct rb_node *n = alloc->free_buffers.rb_node;
 	struct binder_buffer *buffer;
+	struct binder_buffer *new_buffer = NULL;
 	size_t buffer_size;
-	struct rb_node *best_fit = NULL;
 	void *has_page_addr;
 	void *end_page_addr;
 	size_t size, data_offsets_size;
@@ -374,22 +464,9 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 	/* Pad 0-size buffers so they get assigned unique addresses */
 	size = max(size, sizeof(void *));
 
-	while (n) {
-		buffer = rb_entry(n, struct binder_buffer, rb_node);
-		BUG_ON(!buffer->free);
-		buffer_size = binder_alloc_buffer_size(alloc, buffer);
-
-		if (size < buffer_size) {
-			best_fit = n;
-			n = n->rb_left;
-		} else if (size > buffer_size)
-			n = n->rb_right;
-		else {
-			best_fit = n;
-			break;
-		}
-	}
-	if (best_fit == NULL) {
+	buffer = binder_alloc_find_free_buffer(alloc, size, is_async);
+	if (buffer == NULL) {
+		struct rb_node *n;
 		size_t allocated_buffers = 0;
 		size_t largest_alloc_size = 0;
 		size_t total_alloc_size = 0;
@@ -406,9 +483,9 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 			if (buffer_size > largest_alloc_size)
 				largest_alloc_size = buffer_size;
 		}
-		for (n = rb_first(&alloc->free_buffers); n != NULL;
-		     n = rb_next(n)) {
-			buffer = rb_entry(n, struct binder_buffer, rb_node);
+		list_for_each_entry(buffer, &alloc->buffers, entry) {
+			if (!buffer->free)
+				continue;
 			buffer_size = binder_alloc_buffer_size(alloc, buffer);
 			free_buffers++;
 			total_free_size += buffer_size;
@@ -422,10 +499,7 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 		       total_free_size, free_buffers, largest_free_size);
 		return ERR_PTR(-ENOSPC);
 	}
-	if (n == NULL) {
-		buffer = rb_entry(best_fit, struct binder_buffer, rb_node);
-		buffer_size = binder_alloc_buffer_size(alloc, buffer);
-	}
+	buffer_size = binder_alloc_buffer_size(alloc, buffer);
 
 	binder_alloc_debug(BINDER_DEBUG_BUFFER_ALLOC,
 		     "%d: binder_alloc_buf size %zd got buffer %pK size %zd\n",
@@ -433,7 +507,6 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 
 	has_page_addr =
 		(void *)(((uintptr_t)buffer->data + buffer_size) & PAGE_MASK);
-	WARN_ON(n && buffer_size != size);
 	end_page_addr =
 		(void *)PAGE_ALIGN((uintptr_t)buffer->data + size);
 	if (end_page_addr > has_page_addr)
@@ -444,21 +517,21 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 		return ERR_PTR(ret);
 
 	if (buffer_size != size) {
-		struct binder_buffer *new_buffer;
-
 		new_buffer = kzalloc(sizeof(*buffer), GFP_KERNEL);
 		if (!new_buffer) {
 			pr_err("%s: %d failed to alloc new buffer struct\n",
 			       __func__, alloc->pid);
 			goto err_alloc_buf_struct_failed;
 		}
+	}
+
+	binder_erase_free_buffer(alloc, buffer);
+	if (new_buffer) {
 		new_buffer->data = (u8 *)buffer->data + size;
 		list_add(&new_buffer->entry, &buffer->entry);
 		new_buffer->free = 1;
 		binder_insert_free_buffer(alloc, new_buffer);
 	}
-
-	rb_erase(best_fit, &alloc->free_buffers);
 	buffer->free = 0;
 	buffer->allow_user_free = 0;
 	binder_insert_allocated_buffer_locked(alloc, buffer);
@@ -609,7 +682,7 @@ static void binder_free_buf_locked(struct binder_alloc *alloc,
 		struct binder_buffer *next = binder_buffer_next(buffer);
 
 		if (next->free) {
-			rb_erase(&next->rb_node, &alloc->free_buffers);
+			binder_erase_free_buffer(alloc, next);
 			binder_delete_free_buffer(alloc, next);
 		}
 	}
@@ -617,8 +690,8 @@ static void binder_free_buf_locked(struct binder_alloc *alloc,
 		struct binder_buffer *prev = binder_buffer_prev(buffer);
 
 		if (prev->free) {
+			binder_erase_free_buffer(alloc, prev);
 			binder_delete_free_buffer(alloc, buffer);
-			rb_erase(&prev->rb_node, &alloc->free_buffers);
 			buffer = prev;
 		}
 	}
@@ -822,12 +895,31 @@ void binder_alloc_print_allocated(struct seq_file *m,
 				  struct binder_alloc *alloc)
 {
 	struct rb_node *n;
+	struct binder_buffer *buffer;
+	size_t buffer_size;
+	size_t free_buffers = 0;
+	size_t largest_free_size = 0;
+	size_t total_free_size = 0;
 
 	mutex_lock(&alloc->mutex);
 	for (n = rb_first(&alloc->allocated_buffers); n != NULL; n = rb_next(n))
 		print_binder_buffer(m, "  buffer",
 				    rb_entry(n, struct binder_buffer, rb_node));
+	list_for_each_entry(buffer, &alloc->buffers, entry) {
+		if (!buffer->free)
+			continue;
+		buffer_size = binder_alloc_buffer_size(alloc, buffer);
+		free_buffers++;
+		total_free_size += buffer_size;
+		if (buffer_size > largest_free_size)
+			largest_free_size = buffer_size;
+	}
 	mutex_unlock(&alloc->mutex);
+	/* share of free space not usable by a single allocation */
+	if (total_free_size)
+		seq_printf(m, "  free: %zd (num: %zd largest: %zd) fragmentation %zd%%\n",
+			   total_free_size, free_buffers, largest_free_size,
+			   100 - largest_free_size * 100 / total_free_size);
 }
 
 /**
@@ -1000,9 +1092,13 @@ static struct shrinker binder_shrinker = {
  */
 void binder_alloc_init(struct binder_alloc *alloc)
 {
+	int i;
+
 	alloc->pid = current->group_leader->pid;
 	mutex_init(&alloc->mutex);
 	INIT_LIST_HEAD(&alloc->buffers);
+	for (i = 0; i < BINDER_ALLOC_FREE_CLASSES; i++)
+		INIT_LIST_HEAD(&alloc->free_lists[i]);
 }
 
 void binder_alloc_shrinker_init(void)
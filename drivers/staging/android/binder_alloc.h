@@ -29,7 +29,8 @@ struct binder_transaction;
 /**
  * struct binder_buffer - buffer used for binder transactions
  * @entry:              entry alloc->buffers
- * @rb_node:            node for allocated_buffers/free_buffers rb trees
+ * @rb_node:            node for allocated_buffers rb tree
+ * @free_entry:         entry in the alloc->free_lists size class
  * @free:               true if buffer is free
  * @allow_user_free:    describe the second member of struct blah,
  * @async_transaction:  describe the second member of struct blah,
@@ -45,8 +46,8 @@ struct binder_transaction;
  */
 struct binder_buffer {
 	struct list_head entry; /* free and allocated entries by address */
-	struct rb_node rb_node; /* free entry by size or allocated entry */
-				/* by address */
+	struct rb_node rb_node; /* allocated entry by address */
+	struct list_head free_entry; /* free entry by size class */
 	unsigned free:1;
 	unsigned allow_user_free:1;
 	unsigned async_transaction:1;
@@ -73,6 +74,13 @@ struct binder_lru_page {
 	struct binder_alloc *alloc;
 };
 
+/*
+ * Free buffers are kept on power-of-two size class lists; class n holds
+ * buffers of [2^n, 2^(n+1)) bytes. The last class also takes anything
+ * larger, which is never hit with the 4M mmap limit.
+ */
+#define BINDER_ALLOC_FREE_CLASSES	24
+
 /**
  * struct binder_alloc - per-binder proc state for binder allocator
  * @vma:                vm_area_struct passed to mmap_handler
@@ -83,8 +91,9 @@ struct binder_lru_page {
  * @buffer:             base of per-proc address space mapped via mmap
  * @user_buffer_offset: offset between user and kernel VAs for buffer
  * @buffers:            list of all buffers for this proc
- * @free_buffers:       rb tree of buffers available for allocation
- *                      sorted by size
+ * @free_lists:         lists of buffers available for allocation,
+ *                      segregated by size class
+ * @free_classes:       bitmap of non-empty @free_lists
  * @allocated_buffers:  rb tree of allocated buffers sorted by address
  * @free_async_space:   VA space available for async buffers. This is
  *                      initialized at mmap time to 1/2 the full VA space
@@ -105,7 +114,8 @@ struct binder_alloc {
 	void *buffer;
 	ptrdiff_t user_buffer_offset;
 	struct list_head buffers;
-	struct rb_root free_buffers;
+	struct list_head free_lists[BINDER_ALLOC_FREE_CLASSES];
+	unsigned long free_classes;
 	struct rb_root allocated_buffers;
 	size_t free_async_space;
 	struct binder_lru_page *pages;
@@ -20,6 +20,7 @@
 #include <linux/errno.h>
 #include <linux/err.h>
 #include <linux/dma-mapping.h>
+#include <linux/dma-contiguous.h>
 #include <linux/msm_ion.h>
 
 #include <asm/cacheflush.h>
@@ -212,6 +213,21 @@ static struct ion_heap_ops ion_cma_ops = {
 	.print_debug = ion_cma_print_debug,
 };
 
+int ion_cma_prefetch(struct ion_heap *heap, void *data)
+{
+	unsigned long len = PAGE_ALIGN((unsigned long)data);
+	struct device *dev = heap->priv;
+
+	if ((int) heap->type != ION_HEAP_TYPE_DMA || !len)
+		return -EINVAL;
+
+	/*
+	 * The buffer will come from dma_alloc_*(), which aligns CMA
+	 * allocations to their size.
+	 */
+	return dma_prepare_contiguous(dev, len >> PAGE_SHIFT, get_order(len));
+}
+
 struct ion_heap *ion_cma_heap_create(struct ion_platform_heap *data)
 {
 	struct ion_heap *heap;
@@ -20,6 +20,8 @@
 #include <linux/fs.h>
 #include <linux/list.h>
 #include <linux/module.h>
+#include <linux/percpu.h>
+#include <linux/sizes.h>
 #include <linux/slab.h>
 #include <linux/swap.h>
 #include <linux/vmalloc.h>
@@ -53,10 +55,9 @@ static void ion_page_pool_free_pages(struct ion_page_pool *pool,
 	__free_pages(page, pool->order);
 }
 
-static int ion_page_pool_add(struct ion_page_pool *pool, struct page *page,
+static void __ion_page_pool_add(struct ion_page_pool *pool, struct page *page,
 				bool prefetch)
 {
-	mutex_lock(&pool->mutex);
 	if (PageHighMem(page)) {
 		list_add_tail(&page->lru, &pool->high_items);
 		pool->high_count++;
@@ -66,7 +67,13 @@ static int ion_page_pool_add(struct ion_page_pool *pool, struct page *page,
 	}
 	if (!prefetch)
 		pool->nr_unreserved++;
+}
 
+static int ion_page_pool_add(struct ion_page_pool *pool, struct page *page,
+				bool prefetch)
+{
+	mutex_lock(&pool->mutex);
+	__ion_page_pool_add(pool, page, prefetch);
 	mutex_unlock(&pool->mutex);
 	return 0;
 }
@@ -97,21 +104,127 @@ static struct page *ion_page_pool_remove(struct ion_page_pool *pool, bool high,
 	return page;
 }
 
-void *ion_page_pool_alloc(struct ion_page_pool *pool, bool *from_pool)
+static struct ion_page_pool_pcp *ion_page_pool_this_pcp(
+						struct ion_page_pool *pool)
 {
-	struct page *page = NULL;
+	/* any cache will do if we migrate, the lock keeps it consistent */
+	return per_cpu_ptr(pool->pcp, raw_smp_processor_id());
+}
 
-	BUG_ON(!pool);
+/*
+ * Takes an item from the local per-cpu cache, refilling the cache with a
+ * batch from the shared lists when it is empty so that pool->mutex is only
+ * taken once every pcp_batch allocations.
+ */
+static struct page *ion_page_pool_pcp_alloc(struct ion_page_pool *pool)
+{
+	struct ion_page_pool_pcp *pcp = ion_page_pool_this_pcp(pool);
+	struct page *batch[ION_POOL_PCP_MAX];
+	struct page *page = NULL;
+	int nr = 0;
 
-	*from_pool = true;
+	spin_lock(&pcp->lock);
+	if (pcp->count)
+		page = pcp->pages[--pcp->count];
+	spin_unlock(&pcp->lock);
+	if (page)
+		return page;
 
-	if (mutex_trylock(&pool->mutex)) {
+	if (!mutex_trylock(&pool->mutex))
+		return NULL;
+	while (nr < pool->pcp_batch) {
 		if (pool->high_count)
-			page = ion_page_pool_remove(pool, true, false);
+			batch[nr++] = ion_page_pool_remove(pool, true, false);
 		else if (pool->low_count)
-			page = ion_page_pool_remove(pool, false, false);
+			batch[nr++] = ion_page_pool_remove(pool, false, false);
+		else
+			break;
+	}
+	mutex_unlock(&pool->mutex);
+
+	if (!nr)
+		return NULL;
+
+	page = batch[--nr];
+	spin_lock(&pcp->lock);
+	while (nr && pcp->count < pool->pcp_high)
+		pcp->pages[pcp->count++] = batch[--nr];
+	spin_unlock(&pcp->lock);
+
+	/* the cache was refilled by someone else meanwhile */
+	if (nr) {
+		mutex_lock(&pool->mutex);
+		while (nr)
+			__ion_page_pool_add(pool, batch[--nr], false);
+		mutex_unlock(&pool->mutex);
+	}
+
+	return page;
+}
+
+/*
+ * Puts an item in the local per-cpu cache, handing a batch back to the
+ * shared lists when the cache is full.
+ */
+static void ion_page_pool_pcp_free(struct ion_page_pool *pool,
+				   struct page *page)
+{
+	struct ion_page_pool_pcp *pcp = ion_page_pool_this_pcp(pool);
+	struct page *batch[ION_POOL_PCP_MAX];
+	int nr = 0;
+
+	spin_lock(&pcp->lock);
+	if (pcp->count < pool->pcp_high) {
+		pcp->pages[pcp->count++] = page;
+		spin_unlock(&pcp->lock);
+		return;
+	}
+	while (nr < pool->pcp_batch)
+		batch[nr++] = pcp->pages[--pcp->count];
+	pcp->pages[pcp->count++] = page;
+	spin_unlock(&pcp->lock);
+
+	mutex_lock(&pool->mutex);
+	while (nr)
+		__ion_page_pool_add(pool, batch[--nr], false);
+	mutex_unlock(&pool->mutex);
+}
+
+/* Moves every item held in the per-cpu caches back to the shared lists */
+static void ion_page_pool_drain_pcp(struct ion_page_pool *pool)
+{
+	struct page *batch[ION_POOL_PCP_MAX];
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct ion_page_pool_pcp *pcp = per_cpu_ptr(pool->pcp, cpu);
+		int nr;
+
+		spin_lock(&pcp->lock);
+		nr = pcp->count;
+		memcpy(batch, pcp->pages, nr * sizeof(batch[0]));
+		pcp->count = 0;
+		spin_unlock(&pcp->lock);
+
+		if (!nr)
+			continue;
+
+		mutex_lock(&pool->mutex);
+		while (nr)
+			__ion_page_pool_add(pool, batch[--nr], false);
 		mutex_unlock(&pool->mutex);
 	}
+}
+
+void *ion_page_pool_alloc(struct ion_page_pool *pool, bool *from_pool)
+{
+	struct page *page = NULL;
+
+	BUG_ON(!pool);
+
+	*from_pool = true;
+
+	page = ion_page_pool_pcp_alloc(pool);
 	if (!page) {
 		page = ion_page_pool_alloc_pages(pool);
 		*from_pool = false;
@@ -146,9 +259,11 @@ void *ion_page_pool_prefetch(struct ion_page_pool *pool, bool *from_pool)
 void *ion_page_pool_alloc_pool_only(struct ion_page_pool *pool)
 {
 	struct page *page = NULL;
+	bool drained = false;
 
 	BUG_ON(!pool);
 
+retry:
 	if (mutex_trylock(&pool->mutex)) {
 		if (pool->high_count)
 			page = ion_page_pool_remove(pool, true, false);
@@ -157,6 +272,12 @@ void *ion_page_pool_alloc_pool_only(struct ion_page_pool *pool)
 		mutex_unlock(&pool->mutex);
 	}
 
+	if (!page && !drained) {
+		ion_page_pool_drain_pcp(pool);
+		drained = true;
+		goto retry;
+	}
+
 	return page;
 }
 
@@ -167,6 +288,11 @@ void ion_page_pool_free(struct ion_page_pool *pool, struct page *page,
 
 	BUG_ON(pool->order != compound_order(page));
 
+	if (!prefetch) {
+		ion_page_pool_pcp_free(pool, page);
+		return;
+	}
+
 	ret = ion_page_pool_add(pool, page, prefetch);
 	/* FIXME? For a secure page, not hyp unassigned in this err path */
 	if (ret)
@@ -178,12 +304,42 @@ void ion_page_pool_free_immediate(struct ion_page_pool *pool, struct page *page)
 	ion_page_pool_free_pages(pool, page);
 }
 
+/*
+ * Adds one zeroed page, already cleaned from the caches, to the pool
+ * without entering reclaim. Used to fill the pool ahead of time.
+ */
+int ion_page_pool_refill(struct ion_page_pool *pool)
+{
+	gfp_t gfp_mask = (pool->gfp_mask | __GFP_NORETRY | __GFP_NOWARN |
+			  __GFP_NO_KSWAPD | __GFP_NOMEMALLOC) &
+			 ~(__GFP_WAIT | __GFP_ZERO);
+	struct page *page;
+
+	page = alloc_pages(gfp_mask, pool->order);
+	if (!page)
+		return -ENOMEM;
+
+	if (msm_ion_heap_high_order_page_zero(page, pool->order)) {
+		__free_pages(page, pool->order);
+		return -ENOMEM;
+	}
+
+	ion_page_pool_alloc_set_cache_policy(pool, page);
+
+	return ion_page_pool_add(pool, page, false);
+}
+
 int ion_page_pool_total(struct ion_page_pool *pool, bool high)
 {
 	int count = pool->low_count;
+	int cpu;
 
-	if (high)
+	/* the per-cpu caches may hold highmem pages too */
+	if (high) {
 		count += pool->high_count;
+		for_each_possible_cpu(cpu)
+			count += per_cpu_ptr(pool->pcp, cpu)->count;
+	}
 
 	return count << pool->order;
 }
@@ -202,6 +358,8 @@ int ion_page_pool_shrink(struct ion_page_pool *pool, gfp_t gfp_mask,
 	if (nr_to_scan == 0)
 		return ion_page_pool_total(pool, high);
 
+	ion_page_pool_drain_pcp(pool);
+
 	while (freed < nr_to_scan) {
 		struct page *page;
 
@@ -226,8 +384,25 @@ struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order)
 {
 	struct ion_page_pool *pool = kmalloc(sizeof(struct ion_page_pool),
 					     GFP_KERNEL);
+	int cpu;
+
 	if (!pool)
 		return NULL;
+	pool->pcp = alloc_percpu(struct ion_page_pool_pcp);
+	if (!pool->pcp) {
+		kfree(pool);
+		return NULL;
+	}
+	for_each_possible_cpu(cpu) {
+		struct ion_page_pool_pcp *pcp = per_cpu_ptr(pool->pcp, cpu);
+
+		spin_lock_init(&pcp->lock);
+		pcp->count = 0;
+	}
+	/* cache up to 256KB per cpu, but at least two items */
+	pool->pcp_high = clamp_t(int, SZ_256K >> (PAGE_SHIFT + order), 2,
+				 ION_POOL_PCP_MAX);
+	pool->pcp_batch = pool->pcp_high / 2;
 	pool->high_count = 0;
 	pool->low_count = 0;
 	pool->nr_unreserved = 0;
@@ -243,6 +418,8 @@ struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order)
 
 void ion_page_pool_destroy(struct ion_page_pool *pool)
 {
+	ion_page_pool_drain_pcp(pool);
+	free_percpu(pool->pcp);
 	kfree(pool);
 }
 
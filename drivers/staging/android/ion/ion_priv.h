@@ -408,6 +408,20 @@ void ion_carveout_free(struct ion_heap *heap, ion_phys_addr_t addr,
  * invalidated from the cache, provides a significant performance benefit on
  * many systems */
 
+#define ION_POOL_PCP_MAX	32
+
+/**
+ * struct ion_page_pool_pcp - per-cpu cache of pool items
+ * @lock:		protects the cache, only contended when it is drained
+ * @count:		number of items in the cache
+ * @pages:		the items
+ */
+struct ion_page_pool_pcp {
+	spinlock_t lock;
+	int count;
+	struct page *pages[ION_POOL_PCP_MAX];
+};
+
 /**
  * struct ion_page_pool - pagepool struct
  * @high_count:		number of highmem items in the pool
@@ -421,6 +435,10 @@ void ion_carveout_free(struct ion_heap *heap, ion_phys_addr_t addr,
  * @gfp_mask:		gfp_mask to use from alloc
  * @order:		order of pages in the pool
  * @list:		plist node for list of pools
+ * @pcp:		per-cpu caches in front of the shared lists
+ * @pcp_high:		max number of items in each per-cpu cache
+ * @pcp_batch:		number of items moved between a per-cpu cache and
+ *			the shared lists at once
  *
  * Allows you to keep a pool of pre allocated pages to use from your heap.
  * Keeping a pool of pages that is ready for dma, ie any cached mapping have
@@ -437,6 +455,9 @@ struct ion_page_pool {
 	gfp_t gfp_mask;
 	unsigned int order;
 	struct plist_node list;
+	struct ion_page_pool_pcp __percpu *pcp;
+	int pcp_high;
+	int pcp_batch;
 };
 
 struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order);
@@ -447,6 +468,7 @@ void ion_page_pool_free(struct ion_page_pool *, struct page *, bool prefetch);
 void ion_page_pool_free_immediate(struct ion_page_pool *, struct page *);
 int ion_page_pool_total(struct ion_page_pool *pool, bool high);
 void *ion_page_pool_prefetch(struct ion_page_pool *pool, bool *from_pool);
+int ion_page_pool_refill(struct ion_page_pool *pool);
 
 #ifdef CONFIG_ION_POOL_CACHE_POLICY
 static inline void ion_page_pool_alloc_set_cache_policy
@@ -18,7 +18,9 @@
 #include <asm/page.h>
 #include <linux/dma-mapping.h>
 #include <linux/err.h>
+#include <linux/freezer.h>
 #include <linux/highmem.h>
+#include <linux/kthread.h>
 #include <linux/mm.h>
 #include <linux/msm_ion.h>
 #include <linux/scatterlist.h>
@@ -63,6 +65,12 @@ struct ion_system_heap {
 	struct ion_page_pool **uncached_pools;
 	struct ion_page_pool **cached_pools;
 	struct ion_page_pool **secure_pools[VMID_LAST];
+#ifdef CONFIG_ION_SYSTEM_HEAP_POOL_REFILL
+	struct task_struct *refill_task;
+	wait_queue_head_t refill_wait;
+	/* no refilling until this time, set on shrink or failed refill */
+	unsigned long refill_backoff;
+#endif
 };
 
 struct page_info {
@@ -77,6 +85,122 @@ static int ion_heap_is_system_heap_type(enum ion_heap_type type)
 	return type == ((enum ion_heap_type)ION_HEAP_TYPE_SYSTEM);
 }
 
+#ifdef CONFIG_ION_SYSTEM_HEAP_POOL_REFILL
+#define ION_POOL_REFILL_PAGES \
+	(CONFIG_ION_SYSTEM_HEAP_POOL_REFILL_KB >> (PAGE_SHIFT - 10))
+#define ION_POOL_REFILL_BACKOFF	HZ
+
+static bool ion_system_heap_needs_refill(struct ion_system_heap *sys_heap)
+{
+	int i;
+
+	for (i = 0; i < num_orders; i++)
+		if (ion_page_pool_total(sys_heap->uncached_pools[i], true) <
+		    ION_POOL_REFILL_PAGES)
+			return true;
+
+	return false;
+}
+
+static void ion_system_heap_refill(struct ion_system_heap *sys_heap)
+{
+	int i;
+
+	for (i = 0; i < num_orders; i++) {
+		struct ion_page_pool *pool = sys_heap->uncached_pools[i];
+
+		while (ion_page_pool_total(pool, true) < ION_POOL_REFILL_PAGES) {
+			if (kthread_should_stop() ||
+			    time_before(jiffies, sys_heap->refill_backoff))
+				return;
+
+			if (ion_page_pool_refill(pool)) {
+				sys_heap->refill_backoff = jiffies +
+						ION_POOL_REFILL_BACKOFF;
+				return;
+			}
+			cond_resched();
+		}
+	}
+}
+
+static int ion_system_heap_refill_fn(void *data)
+{
+	struct ion_system_heap *sys_heap = data;
+
+	set_freezable();
+
+	while (!kthread_should_stop()) {
+		long backoff;
+
+		wait_event_freezable(sys_heap->refill_wait,
+				     ion_system_heap_needs_refill(sys_heap) ||
+				     kthread_should_stop());
+
+		backoff = (long)(sys_heap->refill_backoff - jiffies);
+		if (backoff > 0) {
+			schedule_timeout_interruptible(backoff);
+			continue;
+		}
+
+		ion_system_heap_refill(sys_heap);
+	}
+
+	return 0;
+}
+
+static void ion_system_heap_wake_refill(struct ion_system_heap *sys_heap)
+{
+	if (sys_heap->refill_task && ion_system_heap_needs_refill(sys_heap))
+		wake_up(&sys_heap->refill_wait);
+}
+
+static void ion_system_heap_init_refill(struct ion_system_heap *sys_heap)
+{
+	struct sched_param param = { .sched_priority = 0 };
+
+	init_waitqueue_head(&sys_heap->refill_wait);
+	sys_heap->refill_backoff = jiffies;
+	sys_heap->refill_task = kthread_run(ion_system_heap_refill_fn,
+					    sys_heap, "ion_pool_refill");
+	if (IS_ERR(sys_heap->refill_task)) {
+		pr_err("%s: creating thread for pool refill failed\n",
+		       __func__);
+		sys_heap->refill_task = NULL;
+		return;
+	}
+	sched_setscheduler(sys_heap->refill_task, SCHED_IDLE, &param);
+}
+
+static void ion_system_heap_stop_refill(struct ion_system_heap *sys_heap)
+{
+	if (sys_heap->refill_task)
+		kthread_stop(sys_heap->refill_task);
+	sys_heap->refill_task = NULL;
+}
+
+static void ion_system_heap_backoff_refill(struct ion_system_heap *sys_heap)
+{
+	sys_heap->refill_backoff = jiffies + ION_POOL_REFILL_BACKOFF;
+}
+#else
+static inline void ion_system_heap_wake_refill(struct ion_system_heap *h)
+{
+}
+
+static inline void ion_system_heap_init_refill(struct ion_system_heap *h)
+{
+}
+
+static inline void ion_system_heap_stop_refill(struct ion_system_heap *h)
+{
+}
+
+static inline void ion_system_heap_backoff_refill(struct ion_system_heap *h)
+{
+}
+#endif
+
 static struct page *alloc_buffer_page(struct ion_system_heap *heap,
 				      struct ion_buffer *buffer,
 				      unsigned long order,
@@ -337,6 +461,7 @@ static int ion_system_heap_allocate(struct ion_heap *heap,
 	if (nents_sync)
 		sg_free_table(&table_sync);
 	msm_ion_heap_free_pages_mem(&data);
+	ion_system_heap_wake_refill(sys_heap);
 	return 0;
 
 err_free_sg2:
@@ -484,6 +609,8 @@ static int ion_system_heap_shrink(struct ion_heap *heap, gfp_t gfp_mask,
 
 	if (!nr_to_scan)
 		only_scan = 1;
+	else
+		ion_system_heap_backoff_refill(sys_heap);
 
 	for (i = 0; i < num_orders; i++) {
 		nr_freed = 0;
@@ -702,6 +829,7 @@ struct ion_heap *ion_system_heap_create(struct ion_platform_heap *unused)
 		goto err_create_cached_pools;
 
 	heap->heap.debug_show = ion_system_heap_debug_show;
+	ion_system_heap_init_refill(heap);
 	return &heap->heap;
 
 err_create_cached_pools:
@@ -729,6 +857,8 @@ void ion_system_heap_destroy(struct ion_heap *heap)
 							heap);
 	int i, j;
 
+	ion_system_heap_stop_refill(sys_heap);
+
 	for (i = 0; i < VMID_LAST; i++) {
 		if (!is_secure_vmid_valid(i))
 			continue;
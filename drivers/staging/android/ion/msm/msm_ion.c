@@ -789,6 +789,14 @@ long msm_ion_custom_ioctl(struct ion_client *client,
 			ion_system_secure_heap_prefetch);
 		if (ret)
 			return ret;
+
+		ret = ion_walk_heaps(client, data.prefetch_data.heap_id,
+				     (enum ion_heap_type)
+				     ION_HEAP_TYPE_DMA,
+				     (void *)data.prefetch_data.len,
+				     ion_cma_prefetch);
+		if (ret)
+			return ret;
 		break;
 	}
 	case ION_IOC_DRAIN:
@@ -1074,6 +1082,7 @@ static int msm_ion_probe(struct platform_device *pdev)
 		}
 
 		ion_device_add_heap(new_dev, heaps[i]);
+		msm_ion_bench_add_heap(heaps[i]);
 	}
 	if (pdata_needs_to_be_freed)
 		free_pdata(pdata);
@@ -1101,8 +1110,10 @@ static int msm_ion_remove(struct platform_device *pdev)
 	struct ion_device *idev = platform_get_drvdata(pdev);
 	int i;
 
-	for (i = 0; i < num_heaps; i++)
+	for (i = 0; i < num_heaps; i++) {
+		msm_ion_bench_remove_heap(heaps[i]);
 		msm_ion_heap_destroy(heaps[i]);
+	}
 
 	ion_device_destroy(idev);
 	kfree(heaps);
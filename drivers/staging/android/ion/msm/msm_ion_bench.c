@@ -0,0 +1,139 @@
+/* Copyright (c) 2018, The Linux Foundation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Per-heap ION alloc/free benchmark. Every non-secure heap gets a
+ * <debugfs>/msm_bench/ion_<heap> file; one iteration allocates and frees
+ * a buffer of bench_size bytes through an in-kernel ION client.
+ */
+
+#include <linux/err.h>
+#include <linux/list.h>
+#include <linux/module.h>
+#include <linux/msm_ion.h>
+#include <linux/mutex.h>
+#include <linux/sizes.h>
+#include <linux/slab.h>
+#include <soc/qcom/msm_bench.h>
+#include "../ion_priv.h"
+
+static unsigned int bench_size = SZ_64K;
+module_param(bench_size, uint, 0644);
+MODULE_PARM_DESC(bench_size, "Buffer size allocated by the ion benchmarks");
+
+struct msm_ion_bench {
+	struct msm_bench bench;
+	struct list_head list;
+	struct ion_heap *heap;
+	struct ion_client *client;
+	size_t size;
+	char name[32];
+};
+
+static LIST_HEAD(msm_ion_benches);
+static DEFINE_MUTEX(msm_ion_benches_lock);
+
+static int msm_ion_bench_setup(struct msm_bench *bench)
+{
+	struct msm_ion_bench *ib = bench->priv;
+
+	ib->size = PAGE_ALIGN(max_t(unsigned int, bench_size, 1));
+	bench->bytes = ib->size;
+
+	ib->client = msm_ion_client_create("msm_bench");
+	if (IS_ERR_OR_NULL(ib->client)) {
+		ib->client = NULL;
+		return -ENODEV;
+	}
+
+	return 0;
+}
+
+static int msm_ion_bench_run(struct msm_bench *bench)
+{
+	struct msm_ion_bench *ib = bench->priv;
+	struct ion_handle *handle;
+
+	handle = ion_alloc(ib->client, ib->size, PAGE_SIZE,
+			   ION_HEAP(ib->heap->id), 0);
+	if (IS_ERR_OR_NULL(handle))
+		return handle ? PTR_ERR(handle) : -ENOMEM;
+
+	ion_free(ib->client, handle);
+	return 0;
+}
+
+static void msm_ion_bench_teardown(struct msm_bench *bench)
+{
+	struct msm_ion_bench *ib = bench->priv;
+
+	ion_client_destroy(ib->client);
+	ib->client = NULL;
+}
+
+/**
+ * msm_ion_bench_add_heap() - Register an alloc/free benchmark for a heap
+ * @heap: Heap just added to the ion device
+ *
+ * Secure heaps are skipped as they need a VMID and the content protection
+ * flags to allocate from.
+ */
+void msm_ion_bench_add_heap(struct ion_heap *heap)
+{
+	struct msm_ion_bench *ib;
+
+	if (ion_heap_is_system_secure_heap_type(heap->type) ||
+	    ion_heap_allow_secure_allocation(heap->type) ||
+	    heap->type == (enum ion_heap_type)ION_HEAP_TYPE_HYP_CMA)
+		return;
+
+	ib = kzalloc(sizeof(*ib), GFP_KERNEL);
+	if (!ib)
+		return;
+
+	snprintf(ib->name, sizeof(ib->name), "ion_%s", heap->name);
+	ib->heap = heap;
+	ib->bench.name = ib->name;
+	ib->bench.setup = msm_ion_bench_setup;
+	ib->bench.run = msm_ion_bench_run;
+	ib->bench.teardown = msm_ion_bench_teardown;
+	ib->bench.priv = ib;
+
+	if (msm_bench_register(&ib->bench)) {
+		kfree(ib);
+		return;
+	}
+
+	mutex_lock(&msm_ion_benches_lock);
+	list_add_tail(&ib->list, &msm_ion_benches);
+	mutex_unlock(&msm_ion_benches_lock);
+}
+
+/**
+ * msm_ion_bench_remove_heap() - Remove the benchmark of a heap, if any
+ * @heap: Heap about to be destroyed
+ */
+void msm_ion_bench_remove_heap(struct ion_heap *heap)
+{
+	struct msm_ion_bench *ib, *tmp;
+
+	mutex_lock(&msm_ion_benches_lock);
+	list_for_each_entry_safe(ib, tmp, &msm_ion_benches, list) {
+		if (ib->heap != heap)
+			continue;
+
+		list_del(&ib->list);
+		msm_bench_unregister(&ib->bench);
+		kfree(ib);
+	}
+	mutex_unlock(&msm_ion_benches_lock);
+}
@@ -66,6 +66,8 @@ void ion_secure_cma_heap_destroy(struct ion_heap *);
 
 int ion_secure_cma_prefetch(struct ion_heap *heap, void *data);
 
+int ion_cma_prefetch(struct ion_heap *heap, void *data);
+
 int ion_secure_cma_drain_pool(struct ion_heap *heap, void *unused);
 
 #else
@@ -74,6 +76,11 @@ static inline int ion_secure_cma_prefetch(struct ion_heap *heap, void *data)
 	return -ENODEV;
 }
 
+static inline int ion_cma_prefetch(struct ion_heap *heap, void *data)
+{
+	return -ENODEV;
+}
+
 static inline int ion_secure_cma_drain_pool(struct ion_heap *heap, void *unused)
 {
 	return -ENODEV;
@@ -146,4 +153,12 @@ struct sg_table *ion_create_chunked_sg_table(phys_addr_t buffer_base,
 					size_t chunk_size, size_t total_size);
 
 void show_ion_usage(struct ion_device *dev);
+
+#ifdef CONFIG_ION_MSM_BENCH
+void msm_ion_bench_add_heap(struct ion_heap *heap);
+void msm_ion_bench_remove_heap(struct ion_heap *heap);
+#else
+static inline void msm_ion_bench_add_heap(struct ion_heap *heap) { }
+static inline void msm_ion_bench_remove_heap(struct ion_heap *heap) { }
+#endif
 #endif /* _MSM_ION_PRIV_H */
@@ -47,6 +47,9 @@
 #include <linux/cpuset.h>
 #include <linux/vmpressure.h>
 #include <linux/zcache.h>
+#include <linux/kthread.h>
+#include <linux/freezer.h>
+#include <linux/wait.h>
 
 #define CREATE_TRACE_POINTS
 #include <trace/events/almk.h>
@@ -84,6 +87,10 @@ static int lmk_fast_run = 1;
 
 static unsigned long lowmem_deathpending_timeout;
 
+/* unmap the anonymous memory of killed tasks without waiting for them */
+static int lmk_reaper = 1;
+module_param_named(reaper, lmk_reaper, int, S_IRUGO | S_IWUSR);
+
 #define lowmem_print(level, x...)			\
 	do {						\
 		if (lowmem_debug_level >= (level))	\
@@ -245,6 +252,406 @@ static int test_task_state(struct task_struct *p, int state)
 
 static DEFINE_MUTEX(scan_mutex);
 
+#ifdef CONFIG_ANDROID_LMK_ADJ_BUCKETS
+/*
+ * Thread group leaders are kept on one list per oom_score_adj value, with a
+ * bitmap of the non-empty lists, so a scan only has to look at the highest
+ * populated bucket that is still eligible instead of every process.
+ *
+ * lmk_adj_lock nests inside tasklist_lock, which is also taken from irq
+ * context, so it must always be taken with interrupts disabled.
+ */
+#define LMK_ADJ_NR_BUCKETS	(OOM_SCORE_ADJ_MAX - OOM_SCORE_ADJ_MIN + 1)
+
+static DEFINE_SPINLOCK(lmk_adj_lock);
+static struct hlist_head lmk_adj_buckets[LMK_ADJ_NR_BUCKETS];
+static DECLARE_BITMAP(lmk_adj_populated, LMK_ADJ_NR_BUCKETS);
+
+/* Last task we sent SIGKILL to, protected by scan_mutex */
+static struct task_struct *lowmem_last_victim;
+
+static void __lmk_adj_insert(struct task_struct *p)
+{
+	int bucket = p->signal->oom_score_adj - OOM_SCORE_ADJ_MIN;
+
+	p->lmk_adj_bucket = bucket;
+	hlist_add_head(&p->lmk_adj_node, &lmk_adj_buckets[bucket]);
+	__set_bit(bucket, lmk_adj_populated);
+}
+
+static void __lmk_adj_remove(struct task_struct *p)
+{
+	hlist_del_init(&p->lmk_adj_node);
+	if (hlist_empty(&lmk_adj_buckets[p->lmk_adj_bucket]))
+		__clear_bit(p->lmk_adj_bucket, lmk_adj_populated);
+}
+
+/* Called with tasklist_lock held for writing when @p becomes visible */
+void lmk_adj_add(struct task_struct *p)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&lmk_adj_lock, flags);
+	__lmk_adj_insert(p);
+	spin_unlock_irqrestore(&lmk_adj_lock, flags);
+}
+
+/* Called with tasklist_lock held for writing when group leader @p is reaped */
+void lmk_adj_del(struct task_struct *p)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&lmk_adj_lock, flags);
+	if (!hlist_unhashed(&p->lmk_adj_node))
+		__lmk_adj_remove(p);
+	spin_unlock_irqrestore(&lmk_adj_lock, flags);
+}
+
+/* Called from de_thread() when @new takes over as group leader from @old */
+void lmk_adj_replace(struct task_struct *old, struct task_struct *new)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&lmk_adj_lock, flags);
+	if (!hlist_unhashed(&old->lmk_adj_node)) {
+		new->lmk_adj_bucket = old->lmk_adj_bucket;
+		hlist_add_before(&new->lmk_adj_node, &old->lmk_adj_node);
+		hlist_del_init(&old->lmk_adj_node);
+	}
+	spin_unlock_irqrestore(&lmk_adj_lock, flags);
+}
+
+/*
+ * Move @task's thread group to the bucket matching its current
+ * oom_score_adj. Must be called after signal->oom_score_adj is written,
+ * without task_lock or siglock held.
+ */
+void lmk_adj_update(struct task_struct *task)
+{
+	struct task_struct *p;
+	unsigned long flags;
+
+	read_lock(&tasklist_lock);
+	p = task->group_leader;
+	spin_lock_irqsave(&lmk_adj_lock, flags);
+	if (!hlist_unhashed(&p->lmk_adj_node) &&
+	    p->lmk_adj_bucket !=
+			p->signal->oom_score_adj - OOM_SCORE_ADJ_MIN) {
+		__lmk_adj_remove(p);
+		__lmk_adj_insert(p);
+	}
+	spin_unlock_irqrestore(&lmk_adj_lock, flags);
+	read_unlock(&tasklist_lock);
+}
+
+static bool lowmem_victim_pending(void)
+{
+	struct task_struct *victim = lowmem_last_victim;
+	bool pending = false;
+
+	if (!victim)
+		return false;
+
+	if (time_before_eq(jiffies, lowmem_deathpending_timeout) &&
+	    pid_alive(victim)) {
+		rcu_read_lock();
+		pending = test_task_flag(victim, TIF_MEMDIE) &&
+			  !test_task_flag(victim, TIF_MM_RELEASED);
+		rcu_read_unlock();
+	}
+
+	if (!pending) {
+		put_task_struct(victim);
+		lowmem_last_victim = NULL;
+	}
+
+	return pending;
+}
+
+static void lowmem_set_last_victim(struct task_struct *p)
+{
+	if (lowmem_last_victim)
+		put_task_struct(lowmem_last_victim);
+	lowmem_last_victim = p;
+}
+
+/*
+ * Return the largest task in the highest populated bucket at or above
+ * @min_score_adj with a reference held, NULL if there is none, or
+ * ERR_PTR(-EBUSY) while the previous victim is still dying.
+ */
+static struct task_struct *lowmem_select_victim(short min_score_adj,
+						int *selected_tasksize,
+						short *selected_oom_score_adj)
+{
+	struct task_struct *tsk;
+	struct task_struct *selected = NULL;
+	unsigned long min_bucket = max_t(int, min_score_adj,
+					 OOM_SCORE_ADJ_MIN) - OOM_SCORE_ADJ_MIN;
+	unsigned long bucket = LMK_ADJ_NR_BUCKETS;
+	int tasksize;
+
+	if (lowmem_victim_pending())
+		return ERR_PTR(-EBUSY);
+
+	rcu_read_lock();
+	spin_lock_irq(&lmk_adj_lock);
+	while (!selected && bucket > min_bucket) {
+		unsigned long next;
+
+		next = find_last_bit(lmk_adj_populated, bucket);
+		if (next >= bucket || next < min_bucket)
+			break;
+		bucket = next;
+
+		hlist_for_each_entry(tsk, &lmk_adj_buckets[bucket],
+				     lmk_adj_node) {
+			struct task_struct *p;
+			short oom_score_adj;
+
+			if (tsk->flags & PF_KTHREAD)
+				continue;
+
+			/* if task no longer has any memory ignore it */
+			if (test_task_flag(tsk, TIF_MM_RELEASED))
+				continue;
+
+			p = find_lock_task_mm(tsk);
+			if (!p)
+				continue;
+
+			oom_score_adj = p->signal->oom_score_adj;
+			if (oom_score_adj < min_score_adj) {
+				task_unlock(p);
+				continue;
+			}
+			tasksize = get_mm_rss(p->mm);
+			task_unlock(p);
+			if (tasksize <= 0)
+				continue;
+			if (selected) {
+				if (oom_score_adj < *selected_oom_score_adj)
+					continue;
+				if (oom_score_adj == *selected_oom_score_adj &&
+				    tasksize <= *selected_tasksize)
+					continue;
+			}
+			selected = p;
+			*selected_tasksize = tasksize;
+			*selected_oom_score_adj = oom_score_adj;
+			lowmem_print(3, "select '%s' (%d), adj %hd, size %d, to kill\n",
+				     p->comm, p->pid, oom_score_adj, tasksize);
+		}
+	}
+	if (selected)
+		get_task_struct(selected);
+	spin_unlock_irq(&lmk_adj_lock);
+	rcu_read_unlock();
+
+	return selected;
+}
+#else
+static void lowmem_set_last_victim(struct task_struct *p)
+{
+	put_task_struct(p);
+}
+
+/*
+ * Return the largest task with the highest oom_score_adj at or above
+ * @min_score_adj with a reference held, NULL if there is none, or
+ * ERR_PTR(-EBUSY) while a previous victim is still dying.
+ */
+static struct task_struct *lowmem_select_victim(short min_score_adj,
+						int *selected_tasksize,
+						short *selected_oom_score_adj)
+{
+	struct task_struct *tsk;
+	struct task_struct *selected = NULL;
+	int tasksize;
+
+	rcu_read_lock();
+	for_each_process(tsk) {
+		struct task_struct *p;
+		short oom_score_adj;
+
+		if (tsk->flags & PF_KTHREAD)
+			continue;
+
+		/* if task no longer has any memory ignore it */
+		if (test_task_flag(tsk, TIF_MM_RELEASED))
+			continue;
+
+		if (time_before_eq(jiffies, lowmem_deathpending_timeout)) {
+			if (test_task_flag(tsk, TIF_MEMDIE)) {
+				rcu_read_unlock();
+				return ERR_PTR(-EBUSY);
+			}
+		}
+
+		p = find_lock_task_mm(tsk);
+		if (!p)
+			continue;
+
+		oom_score_adj = p->signal->oom_score_adj;
+		if (oom_score_adj < min_score_adj) {
+			task_unlock(p);
+			continue;
+		}
+		tasksize = get_mm_rss(p->mm);
+		task_unlock(p);
+		if (tasksize <= 0)
+			continue;
+		if (selected) {
+			if (oom_score_adj < *selected_oom_score_adj)
+				continue;
+			if (oom_score_adj == *selected_oom_score_adj &&
+			    tasksize <= *selected_tasksize)
+				continue;
+		}
+		selected = p;
+		*selected_tasksize = tasksize;
+		*selected_oom_score_adj = oom_score_adj;
+		lowmem_print(3, "select '%s' (%d), adj %hd, size %d, to kill\n",
+			     p->comm, p->pid, oom_score_adj, tasksize);
+	}
+	if (selected)
+		get_task_struct(selected);
+	rcu_read_unlock();
+
+	return selected;
+}
+#endif
+
+#define LMK_REAP_RETRIES	10
+
+static struct task_struct *lmk_reaper_th;
+static DECLARE_WAIT_QUEUE_HEAD(lmk_reaper_wait);
+static DEFINE_SPINLOCK(lmk_reaper_lock);
+static struct task_struct *lmk_reaper_list;
+
+/*
+ * The address space can only be torn down behind the victim's back if
+ * nobody outside its thread group that is not dying as well still uses it.
+ */
+static bool lmk_mm_shared(struct task_struct *tsk, struct mm_struct *mm)
+{
+	struct task_struct *p;
+	bool shared = false;
+
+	rcu_read_lock();
+	for_each_process(p) {
+		if (same_thread_group(p, tsk) || (p->flags & PF_KTHREAD))
+			continue;
+		if (p->mm == mm && !fatal_signal_pending(p)) {
+			shared = true;
+			break;
+		}
+	}
+	rcu_read_unlock();
+
+	return shared;
+}
+
+/* Returns false if mmap_sem is contended and the reap should be retried */
+static bool lmk_reap_task(struct task_struct *tsk)
+{
+	struct task_struct *p;
+	struct mm_struct *mm;
+	struct vm_area_struct *vma;
+	bool ret = true;
+
+	p = find_lock_task_mm(tsk);
+	if (!p)
+		return true;
+
+	/* pin the page tables so exit_mmap() cannot run under us */
+	mm = p->mm;
+	if (!atomic_inc_not_zero(&mm->mm_users)) {
+		task_unlock(p);
+		return true;
+	}
+	task_unlock(p);
+
+	if (mm->core_state || lmk_mm_shared(tsk, mm))
+		goto out;
+
+	if (!down_read_trylock(&mm->mmap_sem)) {
+		ret = false;
+		goto out;
+	}
+
+	for (vma = mm->mmap; vma; vma = vma->vm_next) {
+		if (vma->vm_flags & (VM_LOCKED | VM_HUGETLB | VM_PFNMAP | VM_IO))
+			continue;
+		/* only private memory is freed by unmapping it */
+		if (vma->vm_file && (vma->vm_flags & VM_SHARED))
+			continue;
+		zap_page_range(vma, vma->vm_start,
+			       vma->vm_end - vma->vm_start, NULL);
+	}
+	up_read(&mm->mmap_sem);
+
+	lowmem_print(2, "reaped '%s' (%d), anon-rss:%lukB\n",
+		     tsk->comm, tsk->pid,
+		     get_mm_counter(mm, MM_ANONPAGES) *
+			(PAGE_SIZE / 1024));
+out:
+	mmput(mm);
+	return ret;
+}
+
+static int lmk_reaper_fn(void *unused)
+{
+	set_freezable();
+
+	while (!kthread_should_stop()) {
+		struct task_struct *tsk = NULL;
+		int attempts = 0;
+
+		wait_event_freezable(lmk_reaper_wait,
+				     lmk_reaper_list || kthread_should_stop());
+
+		spin_lock(&lmk_reaper_lock);
+		if (lmk_reaper_list) {
+			tsk = lmk_reaper_list;
+			lmk_reaper_list = tsk->lmk_reap_next;
+		}
+		spin_unlock(&lmk_reaper_lock);
+
+		if (!tsk)
+			continue;
+
+		while (!lmk_reap_task(tsk) && ++attempts < LMK_REAP_RETRIES)
+			schedule_timeout_interruptible(HZ / 10);
+
+		put_task_struct(tsk);
+	}
+
+	return 0;
+}
+
+static void lmk_queue_reap(struct task_struct *tsk)
+{
+	struct task_struct *p;
+
+	if (!lmk_reaper || !lmk_reaper_th)
+		return;
+
+	spin_lock(&lmk_reaper_lock);
+	for (p = lmk_reaper_list; p; p = p->lmk_reap_next) {
+		if (p == tsk) {
+			spin_unlock(&lmk_reaper_lock);
+			return;
+		}
+	}
+	get_task_struct(tsk);
+	tsk->lmk_reap_next = lmk_reaper_list;
+	lmk_reaper_list = tsk;
+	spin_unlock(&lmk_reaper_lock);
+
+	wake_up(&lmk_reaper_wait);
+}
+
 int can_use_cma_pages(gfp_t gfp_mask)
 {
 	int can_use = 0;
@@ -416,10 +823,8 @@ void tune_lmk_param(int *other_free, int *other_file, struct shrink_control *sc)
 
 static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 {
-	struct task_struct *tsk;
-	struct task_struct *selected = NULL;
+	struct task_struct *selected;
 	unsigned long rem = 0;
-	int tasksize;
 	int i;
 	int ret = 0;
 	short min_score_adj = OOM_SCORE_ADJ_MAX + 1;
@@ -474,64 +879,27 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 
 	selected_oom_score_adj = min_score_adj;
 
-	rcu_read_lock();
-	for_each_process(tsk) {
-		struct task_struct *p;
-		short oom_score_adj;
-
-		if (tsk->flags & PF_KTHREAD)
-			continue;
-
-		/* if task no longer has any memory ignore it */
-		if (test_task_flag(tsk, TIF_MM_RELEASED))
-			continue;
-
-		if (time_before_eq(jiffies, lowmem_deathpending_timeout)) {
-			if (test_task_flag(tsk, TIF_MEMDIE)) {
-				rcu_read_unlock();
-				mutex_unlock(&scan_mutex);
-				return 0;
-			}
-		}
-
-		p = find_lock_task_mm(tsk);
-		if (!p)
-			continue;
-
-		oom_score_adj = p->signal->oom_score_adj;
-		if (oom_score_adj < min_score_adj) {
-			task_unlock(p);
-			continue;
-		}
-		tasksize = get_mm_rss(p->mm);
-		task_unlock(p);
-		if (tasksize <= 0)
-			continue;
-		if (selected) {
-			if (oom_score_adj < selected_oom_score_adj)
-				continue;
-			if (oom_score_adj == selected_oom_score_adj &&
-			    tasksize <= selected_tasksize)
-				continue;
-		}
-		selected = p;
-		selected_tasksize = tasksize;
-		selected_oom_score_adj = oom_score_adj;
-		lowmem_print(3, "select '%s' (%d), adj %hd, size %d, to kill\n",
-			     p->comm, p->pid, oom_score_adj, tasksize);
+	selected = lowmem_select_victim(min_score_adj, &selected_tasksize,
+					&selected_oom_score_adj);
+	if (IS_ERR(selected)) {
+		mutex_unlock(&scan_mutex);
+		return 0;
 	}
+
 	if (selected) {
 		long cache_size = other_file * (long)(PAGE_SIZE / 1024);
 		long cache_limit = minfree * (long)(PAGE_SIZE / 1024);
 		long free = other_free * (long)(PAGE_SIZE / 1024);
 		trace_lowmemory_kill(selected, cache_size, cache_limit, free);
 
+		rcu_read_lock();
 		if (test_task_flag(selected, TIF_MEMDIE) &&
 		    (test_task_state(selected, TASK_UNINTERRUPTIBLE))) {
 			lowmem_print(2, "'%s' (%d) is already killed\n",
 				     selected->comm,
 				     selected->pid);
 			rcu_read_unlock();
+			put_task_struct(selected);
 			mutex_unlock(&scan_mutex);
 			return 0;
 		}
@@ -571,15 +939,16 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 		lowmem_deathpending_timeout = jiffies + HZ;
 		set_tsk_thread_flag(selected, TIF_MEMDIE);
 		send_sig(SIGKILL, selected, 0);
+		lmk_queue_reap(selected);
 		rem += selected_tasksize;
 		rcu_read_unlock();
+		lowmem_set_last_victim(selected);
 		/* give the system time to free up the memory */
 		msleep_interruptible(20);
 		trace_almk_shrink(selected_tasksize, ret,
 			other_free, other_file, selected_oom_score_adj);
 	} else {
 		trace_almk_shrink(1, ret, other_free, other_file, 0);
-		rcu_read_unlock();
 	}
 
 	lowmem_print(4, "lowmem_scan %lu, %x, return %lu\n",
@@ -596,6 +965,12 @@ static struct shrinker lowmem_shrinker = {
 
 static int __init lowmem_init(void)
 {
+	lmk_reaper_th = kthread_run(lmk_reaper_fn, NULL, "lmk_reaper");
+	if (IS_ERR(lmk_reaper_th)) {
+		pr_err("failed to start reaper thread\n");
+		lmk_reaper_th = NULL;
+	}
+
 	register_shrinker(&lowmem_shrinker);
 	vmpressure_notifier_register(&lmk_vmpr_nb);
 	return 0;
@@ -604,6 +979,8 @@ static int __init lowmem_init(void)
 static void __exit lowmem_exit(void)
 {
 	unregister_shrinker(&lowmem_shrinker);
+	if (lmk_reaper_th)
+		kthread_stop(lmk_reaper_th);
 }
 
 #ifdef CONFIG_ANDROID_LOW_MEMORY_KILLER_AUTODETECT_OOM_ADJ_VALUES
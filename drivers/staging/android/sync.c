@@ -314,6 +314,16 @@ struct sync_fence *sync_fence_create(const char *name, struct sync_pt *pt)
 }
 EXPORT_SYMBOL(sync_fence_create);
 
+/*
+ * A pt that has signaled without error adds nothing to a merged fence,
+ * so it need not be duplicated. pt->status never goes back to 0, a
+ * stale read only means the pt gets copied as before.
+ */
+static bool sync_pt_merge_skip(struct sync_pt *pt)
+{
+	return ACCESS_ONCE(pt->status) == 1;
+}
+
 static int sync_fence_copy_pts(struct sync_fence *dst, struct sync_fence *src)
 {
 	struct list_head *pos;
@@ -321,7 +331,12 @@ static int sync_fence_copy_pts(struct sync_fence *dst, struct sync_fence *src)
 	list_for_each(pos, &src->pt_list_head) {
 		struct sync_pt *orig_pt =
 			container_of(pos, struct sync_pt, pt_list);
-		struct sync_pt *new_pt = sync_pt_dup(orig_pt);
+		struct sync_pt *new_pt;
+
+		if (sync_pt_merge_skip(orig_pt))
+			continue;
+
+		new_pt = sync_pt_dup(orig_pt);
 
 		if (new_pt == NULL)
 			return -ENOMEM;
@@ -342,6 +357,9 @@ static int sync_fence_merge_pts(struct sync_fence *dst, struct sync_fence *src)
 			container_of(src_pos, struct sync_pt, pt_list);
 		bool collapsed = false;
 
+		if (sync_pt_merge_skip(src_pt))
+			continue;
+
 		list_for_each_safe(dst_pos, n, &dst->pt_list_head) {
 			struct sync_pt *dst_pt =
 				container_of(dst_pos, struct sync_pt, pt_list);
@@ -472,6 +490,12 @@ struct sync_fence *sync_fence_merge(const char *name,
 	if (err < 0)
 		goto err;
 
+	/* every pt of a and b had already signaled */
+	if (list_empty(&fence->pt_list_head)) {
+		fence->status = 1;
+		return fence;
+	}
+
 	list_for_each(pos, &fence->pt_list_head) {
 		struct sync_pt *pt =
 			container_of(pos, struct sync_pt, pt_list);
@@ -516,7 +516,9 @@ ol_rx_indication_handler(
 
     TXRX_STATS_INCR(pdev, priv.rx.normal.ppdus);
 
-    OL_RX_REORDER_TIMEOUT_MUTEX_LOCK(pdev);
+    if (peer) {
+        OL_RX_REORDER_PEER_LOCK(peer);
+    }
 
     if (htt_rx_ind_flush(pdev->htt_pdev, rx_ind_msg) && peer) {
         htt_rx_ind_flush_seq_num_range(
@@ -607,6 +609,9 @@ ol_rx_indication_handler(
 #ifdef HTT_RX_RESTORE
                 if (htt_pdev->rx_ring.rx_reset) {
                     ol_rx_trigger_restore(htt_pdev, head_msdu, tail_msdu);
+                    if (peer) {
+                        OL_RX_REORDER_PEER_UNLOCK(peer);
+                    }
                     goto exit;
                 }
 #endif
@@ -731,6 +736,9 @@ ol_rx_indication_handler(
 #ifdef HTT_RX_RESTORE
                 if (htt_pdev->rx_ring.rx_reset) {
                     ol_rx_trigger_restore(htt_pdev, msdu, tail_msdu);
+                    if (peer) {
+                        OL_RX_REORDER_PEER_UNLOCK(peer);
+                    }
                     goto exit;
                 }
 #endif
@@ -797,7 +805,9 @@ ol_rx_indication_handler(
                    seq_num_end, 0);
     }
     OL_RX_REORDER_TIMEOUT_UPDATE(peer, tid);
-    OL_RX_REORDER_TIMEOUT_MUTEX_UNLOCK(pdev);
+    if (peer) {
+        OL_RX_REORDER_PEER_UNLOCK(peer);
+    }
 
     if (pdev->rx.flags.defrag_timeout_check) {
         ol_rx_defrag_waitlist_flush(pdev);
@@ -1485,6 +1495,8 @@ void
 ol_rx_peer_init(struct ol_txrx_pdev_t *pdev, struct ol_txrx_peer_t *peer)
 {
     u_int8_t tid;
+
+    OL_RX_REORDER_PEER_LOCK_INIT(peer);
     for (tid = 0; tid < OL_TXRX_NUM_EXT_TIDS; tid++) {
         ol_rx_reorder_init(&peer->tids_rx_reorder[tid], tid);
 
@@ -1512,7 +1524,10 @@ ol_rx_peer_cleanup(struct ol_txrx_vdev_t *vdev, struct ol_txrx_peer_t *peer)
     peer->keyinstalled = 0;
     peer->last_assoc_rcvd = 0;
     peer->last_disassoc_deauth_rcvd = 0;
+    OL_RX_REORDER_PEER_LOCK(peer);
     ol_rx_reorder_peer_cleanup(vdev, peer);
+    OL_RX_REORDER_PEER_UNLOCK(peer);
+    OL_RX_REORDER_PEER_LOCK_DESTROY(peer);
     adf_os_mem_free(peer->reorder_history);
     peer->reorder_history = NULL;
 }
@@ -673,7 +673,7 @@ ol_rx_flush_handler(
         return;
     }
 
-    OL_RX_REORDER_TIMEOUT_MUTEX_LOCK(pdev);
+    OL_RX_REORDER_PEER_LOCK(peer);
 
     idx = idx_start & peer->tids_rx_reorder[tid].win_sz_mask;
     rx_reorder_array_elem = &peer->tids_rx_reorder[tid].array[idx];
@@ -686,7 +686,7 @@ ol_rx_flush_handler(
              * Assuming flush message sent seperately for frags
              * and for normal frames
              */
-            OL_RX_REORDER_TIMEOUT_MUTEX_UNLOCK(pdev);
+            OL_RX_REORDER_PEER_UNLOCK(peer);
             return;
         }
     }
@@ -701,7 +701,7 @@ ol_rx_flush_handler(
      * remaining rx holes that require the timer to be restarted.
      */
     OL_RX_REORDER_TIMEOUT_UPDATE(peer, tid);
-    OL_RX_REORDER_TIMEOUT_MUTEX_UNLOCK(pdev);
+    OL_RX_REORDER_PEER_UNLOCK(peer);
 }
 
 void
@@ -50,14 +50,17 @@ ol_rx_reorder_timeout_remove(struct ol_txrx_peer_t *peer, unsigned tid)
     ac = TXRX_TID_TO_WMM_AC(tid);
     rx_reorder_timeout_ac = &pdev->rx.reorder_timeout.access_cats[ac];
     list_elem = &peer->tids_rx_reorder[tid].timeout;
+    adf_os_spin_lock_bh(&pdev->rx.mutex);
     if (!list_elem->active) {
         /* this element has already been removed */
+        adf_os_spin_unlock_bh(&pdev->rx.mutex);
         return;
     }
     list_elem->active = 0;
     TAILQ_REMOVE(
         &rx_reorder_timeout_ac->virtual_timer_list, list_elem,
         reorder_timeout_list_elem);
+    adf_os_spin_unlock_bh(&pdev->rx.mutex);
 }
 
 static void
@@ -110,6 +113,8 @@ ol_rx_reorder_timeout_add(struct ol_txrx_peer_t *peer, u_int8_t tid)
 void
 ol_rx_reorder_timeout_update(struct ol_txrx_peer_t *peer, u_int8_t tid)
 {
+    struct ol_txrx_pdev_t *pdev;
+
     if (!peer) return;
 
     /*
@@ -118,13 +123,16 @@ ol_rx_reorder_timeout_update(struct ol_txrx_peer_t *peer, u_int8_t tid)
      */
     if (peer->tids_rx_reorder[tid].num_mpdus == 0) return;
 
+    pdev = peer->vdev->pdev;
+    adf_os_spin_lock_bh(&pdev->rx.mutex);
     /*
      * If the virtual timer for this peer-TID is already running,
      * then leave it.
      */
-    if (peer->tids_rx_reorder[tid].timeout.active) return;
-
-    ol_rx_reorder_timeout_add(peer, tid);
+    if (!peer->tids_rx_reorder[tid].timeout.active) {
+        ol_rx_reorder_timeout_add(peer, tid);
+    }
+    adf_os_spin_unlock_bh(&pdev->rx.mutex);
 }
 
 static void
@@ -135,9 +143,10 @@ ol_rx_reorder_timeout(void *arg)
 #endif
 {
     struct ol_txrx_pdev_t *pdev;
-    struct ol_rx_reorder_timeout_list_elem_t *list_elem, *tmp;
+    struct ol_rx_reorder_timeout_list_elem_t *list_elem;
     u_int32_t time_now_ms;
     struct ol_tx_reorder_cat_timeout_t *rx_reorder_timeout_ac;
+    int busy = 0;
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 15, 0)
     rx_reorder_timeout_ac = from_timer(rx_reorder_timeout_ac, t, timer);
@@ -148,38 +157,55 @@ ol_rx_reorder_timeout(void *arg)
 
     pdev = rx_reorder_timeout_ac->pdev;
     adf_os_spin_lock(&pdev->rx.mutex);
-// TODO: conditionally take mutex lock during regular rx
-    TAILQ_FOREACH_SAFE(
-        list_elem, &rx_reorder_timeout_ac->virtual_timer_list,
-        reorder_timeout_list_elem, tmp)
-    {
+    while ((list_elem =
+            TAILQ_FIRST(&rx_reorder_timeout_ac->virtual_timer_list))) {
         unsigned idx_start, idx_end;
         struct ol_txrx_peer_t *peer;
+        u_int8_t tid;
 
         if (list_elem->timestamp_ms > time_now_ms) {
             break; /* time has not expired yet for this element */
         }
 
+        peer = list_elem->peer;
+        tid = list_elem->tid;
+
+        /*
+         * The peer lock nests outside rx.mutex, so only try it here.
+         * If the rx path currently owns this peer, leave the element
+         * queued and come back to it shortly.
+         * The peer cannot go away while its element is on the list,
+         * since removing it needs rx.mutex.
+         */
+        if (!adf_os_spin_trylock_bh(&peer->reorder_lock)) {
+            busy = 1;
+            break;
+        }
+
         list_elem->active = 0;
         /* remove the expired element from the list */
         TAILQ_REMOVE(
             &rx_reorder_timeout_ac->virtual_timer_list, list_elem,
             reorder_timeout_list_elem);
-
-        peer = list_elem->peer;
+        adf_os_spin_unlock(&pdev->rx.mutex);
 
         idx_start = 0xffff; /* start from next_rel_idx */
-        ol_rx_reorder_first_hole(peer, list_elem->tid, &idx_end);
+        ol_rx_reorder_first_hole(peer, tid, &idx_end);
         ol_rx_reorder_flush(
             peer->vdev,
             peer,
-            list_elem->tid,
+            tid,
             idx_start,
             idx_end,
             htt_rx_flush_release);
+        OL_RX_REORDER_PEER_UNLOCK(peer);
+
+        adf_os_spin_lock(&pdev->rx.mutex);
     }
-    /* restart the timer if unexpired elements are left in the list */
-    if (!TAILQ_EMPTY(&rx_reorder_timeout_ac->virtual_timer_list)) {
+    if (busy) {
+        adf_os_timer_start(&rx_reorder_timeout_ac->timer, 1);
+    } else if (!TAILQ_EMPTY(&rx_reorder_timeout_ac->virtual_timer_list)) {
+        /* restart the timer if unexpired elements are left in the list */
         ol_rx_reorder_timeout_start(rx_reorder_timeout_ac, time_now_ms);
     }
     adf_os_spin_unlock(&pdev->rx.mutex);
@@ -50,10 +50,14 @@ ol_rx_reorder_timeout_peer_cleanup(struct ol_txrx_peer_t *peer);
 #define OL_RX_REORDER_TIMEOUT_UPDATE  ol_rx_reorder_timeout_update
 #define OL_RX_REORDER_TIMEOUT_PEER_TID_INIT(peer, tid) \
     (peer)->tids_rx_reorder[(tid)].timeout.active = 0
-#define OL_RX_REORDER_TIMEOUT_MUTEX_LOCK(pdev) \
-    adf_os_spin_lock(&(pdev)->rx.mutex)
-#define OL_RX_REORDER_TIMEOUT_MUTEX_UNLOCK(pdev) \
-    adf_os_spin_unlock(&(pdev)->rx.mutex)
+#define OL_RX_REORDER_PEER_LOCK_INIT(peer) \
+    adf_os_spinlock_init(&(peer)->reorder_lock)
+#define OL_RX_REORDER_PEER_LOCK_DESTROY(peer) \
+    adf_os_spinlock_destroy(&(peer)->reorder_lock)
+#define OL_RX_REORDER_PEER_LOCK(peer) \
+    adf_os_spin_lock_bh(&(peer)->reorder_lock)
+#define OL_RX_REORDER_PEER_UNLOCK(peer) \
+    adf_os_spin_unlock_bh(&(peer)->reorder_lock)
 
 #else
 
@@ -63,8 +67,10 @@ ol_rx_reorder_timeout_peer_cleanup(struct ol_txrx_peer_t *peer);
 #define OL_RX_REORDER_TIMEOUT_REMOVE(peer, tid)        /* no-op */
 #define OL_RX_REORDER_TIMEOUT_UPDATE(peer, tid)        /* no-op */
 #define OL_RX_REORDER_TIMEOUT_PEER_TID_INIT(peer, tid) /* no-op */
-#define OL_RX_REORDER_TIMEOUT_MUTEX_LOCK(pdev)         /* no-op */
-#define OL_RX_REORDER_TIMEOUT_MUTEX_UNLOCK(pdev)       /* no-op */
+#define OL_RX_REORDER_PEER_LOCK_INIT(peer)             /* no-op */
+#define OL_RX_REORDER_PEER_LOCK_DESTROY(peer)          /* no-op */
+#define OL_RX_REORDER_PEER_LOCK(peer)                  /* no-op */
+#define OL_RX_REORDER_PEER_UNLOCK(peer)                /* no-op */
 
 #endif /* QCA_SUPPORT_OL_RX_REORDER_TIMEOUT */
 
@@ -1172,6 +1172,14 @@ struct ol_txrx_peer_t {
 	 * stored in separate arrays to avoid alignment padding mem overhead
 	 */
 	struct ol_rx_reorder_t tids_rx_reorder[OL_TXRX_NUM_EXT_TIDS];
+#ifdef QCA_SUPPORT_OL_RX_REORDER_TIMEOUT
+	/*
+	 * Serializes this peer's rx reorder state between the rx indication
+	 * and flush handlers and the reorder timeout. Taken before the pdev
+	 * rx.mutex, which only protects the per-AC timeout lists.
+	 */
+	adf_os_spinlock_t reorder_lock;
+#endif
 	union htt_rx_pn_t      tids_last_pn[OL_TXRX_NUM_EXT_TIDS];
 	u_int8_t               tids_last_pn_valid[OL_TXRX_NUM_EXT_TIDS];
 	u_int16_t              tids_next_rel_idx[OL_TXRX_NUM_EXT_TIDS];
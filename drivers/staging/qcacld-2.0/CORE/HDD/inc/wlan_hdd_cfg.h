@@ -5976,6 +5976,53 @@ FG_BTC_BT_INTERVAL_PAGE_P2P_STA_DEFAULT
 #define CFG_IS_PER_CHAIN_STATS_ENABLED_MIN     (0)
 #define CFG_IS_PER_CHAIN_STATS_ENABLED_MAX     (1)
 
+/*
+ * <ini>
+ * GROEnable - Enable generic receive offload on the rx path
+ * @Min: 0
+ * @Max: 1
+ * @Default: 0
+ *
+ * When enabled, each rx chain handed to HDD is fed through the adapter's
+ * NAPI context with napi_gro_receive() and flushed at the end of the
+ * chain, so TCP segments of a flow are coalesced before reaching the
+ * stack. Has no effect unless the netdev has NETIF_F_GRO set.
+ *
+ * Related: RX_THREAD_CPU_AFFINITY_MASK
+ *
+ * Supported Feature: STA
+ * Usage: Internal/External
+ *
+ * </ini>
+ */
+#define CFG_GRO_ENABLED_NAME    "GROEnable"
+#define CFG_GRO_ENABLED_DEFAULT (0)
+#define CFG_GRO_ENABLED_MIN     (0)
+#define CFG_GRO_ENABLED_MAX     (1)
+
+/*
+ * <ini>
+ * RX_THREAD_CPU_AFFINITY_MASK - CPU mask the tlshim rx thread runs on
+ * @Min: 0
+ * @Max: 0xFF
+ * @Default: 0
+ *
+ * A non-zero mask pins the rx thread to the given CPUs and stops the
+ * bus bandwidth logic from moving it between clusters. 0 keeps the
+ * throughput based affinity switching.
+ *
+ * Related: GROEnable
+ *
+ * Supported Feature: STA
+ * Usage: Internal/External
+ *
+ * </ini>
+ */
+#define CFG_RX_THREAD_CPU_MASK_NAME    "RX_THREAD_CPU_AFFINITY_MASK"
+#define CFG_RX_THREAD_CPU_MASK_DEFAULT (0)
+#define CFG_RX_THREAD_CPU_MASK_MIN     (0)
+#define CFG_RX_THREAD_CPU_MASK_MAX     (0xFF)
+
 #ifdef WLAN_SMART_ANTENNA_FEATURE
 /*
  * <ini>
@@ -6963,6 +7010,8 @@ struct hdd_config {
    bool enable_sae_for_sap;
 #endif
    bool per_chain_stats_enabled;
+   bool enable_rx_gro;
+   uint32_t rx_thread_affinity_mask;
 
 #ifdef WLAN_SMART_ANTENNA_FEATURE
     uint32_t smart_antenna_cfg;
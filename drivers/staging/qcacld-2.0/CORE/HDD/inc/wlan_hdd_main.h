@@ -1236,6 +1236,11 @@ struct hdd_adapter_s
    struct net_device_stats stats;
    /** HDD statistics*/
    hdd_stats_t hdd_stats;
+   /** NAPI context and backlog used to feed rx frames to GRO */
+   struct napi_struct rx_napi;
+   struct sk_buff_head rx_napi_queue;
+   bool rx_napi_added;
+   bool rx_napi_enabled;
    /** linkspeed statistics */
    tSirLinkSpeedInfo ls_stats;
    /**Mib information*/
@@ -2580,11 +2585,15 @@ hdd_set_needed_headroom(struct net_device *wlan_dev, uint16_t len)
 
 #ifdef QCA_CONFIG_SMP
 int wlan_hdd_get_cpu(void);
+void hdd_set_rx_thread_affinity(hdd_context_t *hdd_ctx);
 #else
 static inline int wlan_hdd_get_cpu(void)
 {
 	return 0;
 }
+static inline void hdd_set_rx_thread_affinity(hdd_context_t *hdd_ctx)
+{
+}
 #endif
 
 const char *hdd_get_fwpath(void);
@@ -5582,6 +5582,20 @@ REG_TABLE_ENTRY g_registry_table[] =
 		     CFG_LATENCY_FLAGS_ULTRALOW_DEFAULT,
 		     CFG_LATENCY_FLAGS_ULTRALOW_MIN,
 		     CFG_LATENCY_FLAGS_ULTRALOW_MAX),
+
+	REG_VARIABLE(CFG_GRO_ENABLED_NAME, WLAN_PARAM_Integer,
+		     struct hdd_config, enable_rx_gro,
+		     VAR_FLAGS_OPTIONAL | VAR_FLAGS_RANGE_CHECK_ASSUME_DEFAULT,
+		     CFG_GRO_ENABLED_DEFAULT,
+		     CFG_GRO_ENABLED_MIN,
+		     CFG_GRO_ENABLED_MAX),
+
+	REG_VARIABLE(CFG_RX_THREAD_CPU_MASK_NAME, WLAN_PARAM_HexInteger,
+		     struct hdd_config, rx_thread_affinity_mask,
+		     VAR_FLAGS_OPTIONAL | VAR_FLAGS_RANGE_CHECK_ASSUME_DEFAULT,
+		     CFG_RX_THREAD_CPU_MASK_DEFAULT,
+		     CFG_RX_THREAD_CPU_MASK_MIN,
+		     CFG_RX_THREAD_CPU_MASK_MAX),
 };
 
 
@@ -6575,6 +6589,12 @@ void print_hdd_cfg(hdd_context_t *pHddCtx)
   hddLog(LOG2, "Name = [%s] value = [%u]",
                CFG_LATENCY_FLAGS_ULTRALOW_NAME,
                pHddCtx->cfg_ini->wlm_latency_flags_ultralow);
+  hddLog(LOG2, "Name = [%s] value = [%u]",
+               CFG_GRO_ENABLED_NAME,
+               pHddCtx->cfg_ini->enable_rx_gro);
+  hddLog(LOG2, "Name = [%s] value = [0x%x]",
+               CFG_RX_THREAD_CPU_MASK_NAME,
+               pHddCtx->cfg_ini->rx_thread_affinity_mask);
   hdd_cfg_print_sae(pHddCtx);
   hdd_cfg_print_sae_sap(pHddCtx);
 }
@@ -15695,7 +15695,8 @@ void hdd_cnss_request_bus_bandwidth(hdd_context_t *pHddCtx,
                 vos_remove_pm_qos();
                 pHddCtx->hbw_requested = false;
             }
-            if (vos_sched_handle_throughput_req(false))
+            if (!pHddCtx->cfg_ini->rx_thread_affinity_mask &&
+                vos_sched_handle_throughput_req(false))
                 hddLog(LOGE, FL("low bandwidth set rx affinity fail"));
         } else {
             if (!pHddCtx->hbw_requested) {
@@ -15703,7 +15704,8 @@ void hdd_cnss_request_bus_bandwidth(hdd_context_t *pHddCtx,
                                       DISABLE_KRAIT_IDLE_PS_VAL);
                 pHddCtx->hbw_requested = true;
             }
-            if (vos_sched_handle_throughput_req(true))
+            if (!pHddCtx->cfg_ini->rx_thread_affinity_mask &&
+                vos_sched_handle_throughput_req(true))
                 hddLog(LOGE, FL("high bandwidth set rx affinity fail"));
         }
     }
@@ -17373,6 +17375,8 @@ int hdd_wlan_startup(struct device *dev, v_VOID_t *hif_sc)
       goto err_spectral_deinit;
    }
 
+   hdd_set_rx_thread_affinity(pHddCtx);
+
    /* Register Smart Antenna Module */
    smart_antenna_attach();
 
@@ -20752,6 +20756,41 @@ int wlan_hdd_get_cpu()
 	put_cpu();
 	return cpu_index;
 }
+
+/**
+ * hdd_set_rx_thread_affinity() - pin the tlshim rx thread to configured CPUs
+ * @hdd_ctx: HDD context
+ *
+ * Applies the RX_THREAD_CPU_AFFINITY_MASK ini item. Nothing is done when
+ * the mask is 0, which leaves the rx thread to the throughput based
+ * affinity handling of the scheduler context.
+ *
+ * Return: None
+ */
+void hdd_set_rx_thread_affinity(hdd_context_t *hdd_ctx)
+{
+	pVosSchedContext sched_ctx = get_vos_sched_ctxt();
+	uint32_t mask = hdd_ctx->cfg_ini->rx_thread_affinity_mask;
+	struct cpumask cpus;
+	int cpu;
+
+	if (!mask || !sched_ctx || !sched_ctx->TlshimRxThread)
+		return;
+
+	cpumask_clear(&cpus);
+	for_each_possible_cpu(cpu) {
+		if (mask & BIT(cpu))
+			cpumask_set_cpu(cpu, &cpus);
+	}
+
+	if (cpumask_empty(&cpus) ||
+	    set_cpus_allowed_ptr(sched_ctx->TlshimRxThread, &cpus)) {
+		hddLog(LOGE, FL("failed to set rx thread affinity 0x%x"), mask);
+		return;
+	}
+
+	hddLog(LOG1, FL("rx thread affinity set to 0x%x"), mask);
+}
 #endif
 
 /**
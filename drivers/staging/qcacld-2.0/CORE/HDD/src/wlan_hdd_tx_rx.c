@@ -964,6 +964,86 @@ struct net_device_stats* hdd_stats(struct net_device *dev)
 	return dev_stats;
 }
 
+/**
+ * hdd_rx_napi_poll() - deliver queued rx frames to the stack through GRO
+ * @napi: NAPI context of the adapter
+ * @budget: maximum number of frames to deliver
+ *
+ * Runs in NET_RX softirq on the CPU that scheduled it from
+ * hdd_rx_packet_cbk(). napi_complete() flushes the frames GRO is still
+ * holding once the backlog is drained.
+ *
+ * Return: number of frames delivered
+ */
+static int hdd_rx_napi_poll(struct napi_struct *napi, int budget)
+{
+   hdd_adapter_t *pAdapter = container_of(napi, hdd_adapter_t, rx_napi);
+   unsigned int cpu_index = wlan_hdd_get_cpu();
+   struct sk_buff *skb;
+   int work_done = 0;
+
+   while (work_done < budget &&
+          (skb = skb_dequeue(&pAdapter->rx_napi_queue)) != NULL) {
+      if (napi_gro_receive(napi, skb) != GRO_DROP)
+         ++pAdapter->hdd_stats.hddTxRxStats.rxDelivered[cpu_index];
+      else
+         ++pAdapter->hdd_stats.hddTxRxStats.rxRefused[cpu_index];
+      work_done++;
+   }
+
+   if (work_done < budget) {
+      napi_complete(napi);
+      /* frames queued while NAPI_STATE_SCHED was still set */
+      if (!skb_queue_empty(&pAdapter->rx_napi_queue))
+         napi_schedule(napi);
+   }
+
+   return work_done;
+}
+
+/**
+ * hdd_rx_napi_enable() - set up rx NAPI/GRO delivery for an adapter
+ * @pAdapter: adapter being initialized
+ *
+ * The NAPI context is added once per net_device; free_netdev() removes it.
+ *
+ * Return: None
+ */
+static void hdd_rx_napi_enable(hdd_adapter_t *pAdapter)
+{
+   hdd_context_t *pHddCtx = WLAN_HDD_GET_CTX(pAdapter);
+
+   if (!pHddCtx || !pHddCtx->cfg_ini->enable_rx_gro ||
+       pAdapter->rx_napi_enabled)
+      return;
+
+   if (!pAdapter->rx_napi_added) {
+      skb_queue_head_init(&pAdapter->rx_napi_queue);
+      netif_napi_add(pAdapter->dev, &pAdapter->rx_napi, hdd_rx_napi_poll,
+                     NAPI_POLL_WEIGHT);
+      pAdapter->rx_napi_added = true;
+   }
+
+   napi_enable(&pAdapter->rx_napi);
+   pAdapter->rx_napi_enabled = true;
+}
+
+/**
+ * hdd_rx_napi_disable() - stop rx NAPI/GRO delivery for an adapter
+ * @pAdapter: adapter being deinitialized
+ *
+ * Return: None
+ */
+static void hdd_rx_napi_disable(hdd_adapter_t *pAdapter)
+{
+   if (!pAdapter->rx_napi_enabled)
+      return;
+
+   pAdapter->rx_napi_enabled = false;
+   napi_disable(&pAdapter->rx_napi);
+   skb_queue_purge(&pAdapter->rx_napi_queue);
+}
+
 /**============================================================================
   @brief hdd_init_tx_rx() - Init function to initialize Tx/RX
   modules in HDD
@@ -997,6 +1077,8 @@ VOS_STATUS hdd_init_tx_rx( hdd_adapter_t *pAdapter )
       hdd_list_init( &pAdapter->wmm_tx_queue[i], HDD_TX_QUEUE_MAX_LEN);
    }
 
+   hdd_rx_napi_enable(pAdapter);
+
    return status;
 }
 
@@ -1033,6 +1115,8 @@ VOS_STATUS hdd_deinit_tx_rx( hdd_adapter_t *pAdapter )
       hdd_list_destroy( &pAdapter->wmm_tx_queue[i] );
    }
 
+   hdd_rx_napi_disable(pAdapter);
+
    return status;
 }
 
@@ -1409,6 +1493,8 @@ VOS_STATUS hdd_rx_packet_cbk(v_VOID_t *vosContext,
 #endif /* QCA_PKT_PROTO_TRACE */
    hdd_station_ctx_t *pHddStaCtx = NULL;
    bool wake_lock = false;
+   bool use_napi;
+   bool napi_queued = false;
 
    //Sanity check on inputs
    if ((NULL == vosContext) || (NULL == rxBuf))
@@ -1439,6 +1525,13 @@ VOS_STATUS hdd_rx_packet_cbk(v_VOID_t *vosContext,
 
    cpu_index = wlan_hdd_get_cpu();
 
+   /*
+    * With GRO the chain is queued to the adapter's NAPI context and
+    * delivered in one poll, instead of one netif_rx() per frame.
+    */
+   use_napi = pAdapter->rx_napi_enabled &&
+              (pAdapter->dev->features & NETIF_F_GRO);
+
    // walk the chain until all are processed
    skb = (struct sk_buff *) rxBuf;
    pHddStaCtx = WLAN_HDD_GET_STATION_CTX_PTR(pAdapter);
@@ -1537,6 +1630,26 @@ VOS_STATUS hdd_rx_packet_cbk(v_VOID_t *vosContext,
 
       hdd_tsf_timestamp_rx(pHddCtx, skb, ktime_to_us(skb->tstamp));
 
+      if (!skb->next) {
+          if ((pHddCtx->cfg_ini->rx_wakelock_timeout) &&
+              (PACKET_BROADCAST != skb->pkt_type) &&
+              (PACKET_MULTICAST != skb->pkt_type))
+                wake_lock = true;
+
+          if (wake_lock && pHddStaCtx->conn_info.uIsAuthenticated)
+             vos_wake_lock_timeout_acquire(&pHddCtx->rx_wake_lock,
+                            pHddCtx->cfg_ini->rx_wakelock_timeout,
+                            WIFI_POWER_EVENT_WAKELOCK_HOLD_RX);
+      }
+
+      if (use_napi) {
+         /* delivery is accounted in hdd_rx_napi_poll() */
+         skb_queue_tail(&pAdapter->rx_napi_queue, skb);
+         napi_queued = true;
+         skb = skb_next;
+         continue;
+      }
+
       /*
        * If this is not a last packet on the chain
        * Just put packet into backlog queue, not scheduling RX sirq
@@ -1550,15 +1663,6 @@ VOS_STATUS hdd_rx_packet_cbk(v_VOID_t *vosContext,
          rxstat = netif_rx(skb);
 #endif
       } else {
-          if ((pHddCtx->cfg_ini->rx_wakelock_timeout) &&
-              (PACKET_BROADCAST != skb->pkt_type) &&
-              (PACKET_MULTICAST != skb->pkt_type))
-                wake_lock = true;
-
-          if (wake_lock && pHddStaCtx->conn_info.uIsAuthenticated)
-             vos_wake_lock_timeout_acquire(&pHddCtx->rx_wake_lock,
-                            pHddCtx->cfg_ini->rx_wakelock_timeout,
-                            WIFI_POWER_EVENT_WAKELOCK_HOLD_RX);
           /*
            * This is the last packet on the chain
            * Scheduling rx sirq
@@ -1580,6 +1684,13 @@ VOS_STATUS hdd_rx_packet_cbk(v_VOID_t *vosContext,
       skb = skb_next;
    }
 
+   if (napi_queued) {
+      /* run the poll on this CPU as soon as bottom halves are enabled */
+      local_bh_disable();
+      napi_schedule(&pAdapter->rx_napi);
+      local_bh_enable();
+   }
+
 #if (LINUX_VERSION_CODE < KERNEL_VERSION(4,11,0))
    pAdapter->dev->last_rx = jiffies;
 #endif
@@ -153,6 +153,18 @@ adf_os_spin_lock_bh(adf_os_spinlock_t   *lock)
 
 void adf_os_spin_lock_bh_outline(adf_os_spinlock_t *lock);
 
+/**
+ * @brief try to lock the spinlock mutex in soft irq context
+ *
+ * @param[in] lock  spinlock object pointer
+ * @retval    nonzero if the lock was taken, 0 if it is held elsewhere
+ */
+static inline int
+adf_os_spin_trylock_bh(adf_os_spinlock_t *lock)
+{
+    return __adf_os_spin_trylock_bh(lock);
+}
+
 /**
  * @brief unlocks the spinlock mutex in soft irq context
  *
@@ -155,6 +155,19 @@ __adf_os_spin_lock_bh(__adf_os_spinlock_t *lock)
 	}
 
 }
+static inline int
+__adf_os_spin_trylock_bh(__adf_os_spinlock_t *lock)
+{
+	if (likely(irqs_disabled() || in_softirq()))
+		return spin_trylock(&lock->spinlock);
+
+	if (spin_trylock_bh(&lock->spinlock)) {
+		lock->flags |= ADF_OS_LINUX_UNLOCK_BH;
+		return 1;
+	}
+	return 0;
+}
+
 static inline void
 __adf_os_spin_unlock_bh(__adf_os_spinlock_t *lock)
 {
@@ -188,6 +188,11 @@ static bool online_core;
 static bool cluster_info_probed;
 static bool cluster_info_nodes_called;
 static bool in_suspend, retry_in_progress;
+static bool pid_ctrl_enabled;
+static uint32_t *pid_dyn_power_coeff;
+static int pid_dyn_power_coeff_cnt;
+static int64_t pid_err_integral;
+static int32_t pid_prev_err;
 static int *tsens_id_map;
 static int *zone_id_tsens_map;
 static DEFINE_MUTEX(vdd_rstr_mutex);
@@ -1029,9 +1034,25 @@ static struct notifier_block msm_thermal_cpufreq_notifier = {
 static void update_cpu_freq(int cpu)
 {
 	int ret = 0;
+	uint32_t max_freq_req, min_freq_req;
 	cpumask_t mask;
 
+	cpumask_clear(&mask);
 	get_cluster_mask(cpu, &mask);
+	if (SYNC_CORE(cpu)) {
+		max_freq_req = cpus[cpu].parent_ptr->limited_max_freq;
+		min_freq_req = cpus[cpu].parent_ptr->limited_min_freq;
+	} else {
+		max_freq_req = cpus[cpu].limited_max_freq;
+		min_freq_req = cpus[cpu].limited_min_freq;
+	}
+	/*
+	 * Let the scheduler see the new ceiling right away so that task
+	 * placement stops treating a throttled cluster as full capacity,
+	 * instead of waiting for the cpufreq policy update below.
+	 */
+	sched_update_cpu_freq_min_max(&mask, min_freq_req, max_freq_req);
+
 	if (cpu_online(cpu)) {
 		if ((cpumask_intersects(&mask, &throttling_mask))
 			&& (cpus[cpu].limited_max_freq
@@ -1724,6 +1745,186 @@ static void do_cluster_freq_ctrl(long temp)
 	put_online_cpus();
 }
 
+/* PID gains are fixed point values with PID_FRAC_BITS fractional bits */
+#define PID_FRAC_BITS 10
+#define pid_int_to_frac(x) ((int64_t)(x) << PID_FRAC_BITS)
+#define pid_frac_to_int(x) ((x) >> PID_FRAC_BITS)
+#define pid_mul_frac(x, y) (((int64_t)(x) * (y)) >> PID_FRAC_BITS)
+
+/*
+ * Dynamic power of the online cores of a cluster at the frequency table
+ * index, in mW: capacitance * MHz * mV^2 / 10^9 per core. The voltage
+ * comes from the CPU OPP table; 1V is assumed when it is not available.
+ */
+static uint32_t pid_cluster_power(struct cluster_info *cluster_ptr,
+		int freq_idx, int online_cnt)
+{
+	uint32_t freq_khz = cluster_ptr->freq_table[freq_idx].frequency;
+	uint32_t coeff, voltage_mv = 0;
+	struct device *cpu_dev;
+	struct dev_pm_opp *opp;
+	uint64_t power;
+
+	if (cluster_ptr->cluster_id < 0 ||
+		cluster_ptr->cluster_id >= pid_dyn_power_coeff_cnt)
+		return 0;
+	coeff = pid_dyn_power_coeff[cluster_ptr->cluster_id];
+
+	cpu_dev = get_cpu_device(first_cpu(cluster_ptr->cluster_cores));
+	if (cpu_dev) {
+		rcu_read_lock();
+		opp = dev_pm_opp_find_freq_exact(cpu_dev,
+				(unsigned long)freq_khz * 1000, true);
+		if (!IS_ERR(opp))
+			voltage_mv = dev_pm_opp_get_voltage(opp) / 1000;
+		rcu_read_unlock();
+	}
+	if (!voltage_mv)
+		voltage_mv = 1000;
+
+	power = (uint64_t)coeff * (freq_khz / 1000) * voltage_mv * voltage_mv;
+	do_div(power, 1000000000);
+
+	return (uint32_t)power * online_cnt;
+}
+
+static void pid_set_cluster_limit(struct cluster_info *cluster_ptr,
+		int freq_idx, long temp)
+{
+	int _cpu;
+
+	if (freq_idx == cluster_ptr->freq_idx)
+		return;
+
+	cluster_ptr->freq_idx = freq_idx;
+	for_each_cpu_mask(_cpu, cluster_ptr->cluster_cores) {
+		if (!(msm_thermal_info.bootup_freq_control_mask & BIT(_cpu)))
+			continue;
+		pr_debug("Limiting CPU%d max frequency to %u. Temp:%ld\n",
+			_cpu, cluster_ptr->freq_table[freq_idx].frequency, temp);
+		cpus[_cpu].limited_max_freq = min(
+			cluster_ptr->freq_table[freq_idx].frequency,
+			cpus[_cpu].vdd_max_freq);
+	}
+}
+
+/*
+ * Power allocator style mitigation: a PID loop on the boot sensor turns
+ * the distance to limit_temp_degC into a power budget around the
+ * sustainable power. The part of the budget not reserved for the GPU is
+ * split between clusters in proportion to the power they draw at their
+ * current frequency, and each cluster is capped at the highest frequency
+ * that fits its share. This replaces the fixed frequency steps with a
+ * limit that converges instead of oscillating around the threshold.
+ */
+static void do_pid_freq_ctrl(long temp)
+{
+	struct cluster_info *cluster_ptr = NULL;
+	uint32_t req[NR_CPUS] = {0}, online[NR_CPUS] = {0};
+	uint32_t total_req = 0, max_power, budget, cur_freq;
+	int32_t err, switch_on_temp;
+	int64_t p, i, d, power_range;
+	uint32_t _cluster, _cpu;
+	int idx;
+
+	switch_on_temp = msm_thermal_info.limit_temp_degC -
+		msm_thermal_info.temp_hysteresis_degC;
+
+	get_online_cpus();
+	max_power = msm_thermal_info.pid_gpu_power_mw;
+	for (_cluster = 0; _cluster < core_ptr->entity_count; _cluster++) {
+		cluster_ptr = &core_ptr->child_entity_ptr[_cluster];
+		if (!cluster_ptr->freq_table || _cluster >= NR_CPUS)
+			continue;
+
+		cur_freq = 0;
+		for_each_cpu_mask(_cpu, cluster_ptr->cluster_cores) {
+			if (!cpu_online(_cpu))
+				continue;
+			if (!online[_cluster]++)
+				cur_freq = cpufreq_quick_get(_cpu);
+		}
+		if (!online[_cluster])
+			continue;
+
+		max_power += pid_cluster_power(cluster_ptr,
+			cluster_ptr->freq_idx_high, online[_cluster]);
+		for (idx = cluster_ptr->freq_idx_high;
+			idx > cluster_ptr->freq_idx_low; idx--)
+			if (cluster_ptr->freq_table[idx].frequency <= cur_freq)
+				break;
+		req[_cluster] = pid_cluster_power(cluster_ptr, idx,
+					online[_cluster]);
+		total_req += req[_cluster];
+	}
+
+	if (temp < switch_on_temp) {
+		/* Below the switch on temperature, release all limits */
+		pid_err_integral = 0;
+		pid_prev_err = 0;
+		for (_cluster = 0; _cluster < core_ptr->entity_count;
+			_cluster++) {
+			cluster_ptr = &core_ptr->child_entity_ptr[_cluster];
+			if (cluster_ptr->freq_table)
+				pid_set_cluster_limit(cluster_ptr,
+					cluster_ptr->freq_idx_high, temp);
+		}
+		goto update_freq;
+	}
+
+	err = pid_int_to_frac(msm_thermal_info.limit_temp_degC - temp);
+	p = pid_mul_frac(err < 0 ? msm_thermal_info.pid_k_po :
+			msm_thermal_info.pid_k_pu, err);
+
+	/* Only integrate close to the control temperature, with anti windup */
+	if (err < pid_int_to_frac(msm_thermal_info.pid_integral_cutoff_degC)) {
+		int64_t i_next = pid_err_integral + err;
+
+		if (abs64(pid_mul_frac(msm_thermal_info.pid_k_i, i_next))
+			< pid_int_to_frac(max_power))
+			pid_err_integral = i_next;
+	}
+	i = pid_mul_frac(msm_thermal_info.pid_k_i, pid_err_integral);
+	d = pid_mul_frac(msm_thermal_info.pid_k_d, err - pid_prev_err);
+	pid_prev_err = err;
+
+	power_range = msm_thermal_info.pid_sustainable_power_mw +
+		pid_frac_to_int(p + i + d);
+	power_range = clamp_t(int64_t, power_range, 0, max_power);
+	budget = (power_range > msm_thermal_info.pid_gpu_power_mw) ?
+		(uint32_t)power_range - msm_thermal_info.pid_gpu_power_mw : 0;
+
+	for (_cluster = 0; _cluster < core_ptr->entity_count; _cluster++) {
+		uint64_t granted;
+
+		cluster_ptr = &core_ptr->child_entity_ptr[_cluster];
+		if (!cluster_ptr->freq_table || _cluster >= NR_CPUS ||
+			!online[_cluster])
+			continue;
+
+		if (total_req) {
+			granted = (uint64_t)budget * req[_cluster];
+			do_div(granted, total_req);
+		} else {
+			granted = budget / core_ptr->entity_count;
+		}
+
+		for (idx = cluster_ptr->freq_idx_high;
+			idx > cluster_ptr->freq_idx_low; idx--)
+			if (pid_cluster_power(cluster_ptr, idx,
+				online[_cluster]) <= granted)
+				break;
+		pid_set_cluster_limit(cluster_ptr, idx, temp);
+	}
+	pr_debug("temp:%ld budget:%u req:%u p:%lld i:%lld d:%lld\n", temp,
+		budget, total_req, pid_frac_to_int(p), pid_frac_to_int(i),
+		pid_frac_to_int(d));
+
+update_freq:
+	update_cluster_freq();
+	put_online_cpus();
+}
+
 /* If freq table exists, then we can send freq request */
 static int check_freq_table(void)
 {
@@ -3642,6 +3843,8 @@ static void do_freq_control(long temp)
 	uint32_t cpu = 0;
 	uint32_t max_freq = cpus[cpu].limited_max_freq;
 
+	if (core_ptr && pid_ctrl_enabled)
+		return do_pid_freq_ctrl(temp);
 	if (core_ptr)
 		return do_cluster_freq_ctrl(temp);
 	if (!freq_table_get)
@@ -7252,6 +7455,71 @@ PROBE_FREQ_EXIT:
 	return ret;
 }
 
+static int probe_pid_ctrl(struct device_node *node,
+		struct msm_thermal_data *data,
+		struct platform_device *pdev)
+{
+	char *key = NULL;
+	int ret = 0, cnt;
+	int32_t temp_range;
+
+	key = "qcom,pid-sustainable-power";
+	ret = of_property_read_u32(node, key,
+			&data->pid_sustainable_power_mw);
+	if (ret)
+		goto PROBE_PID_EXIT;
+
+	key = "qcom,pid-dyn-power-coeff";
+	cnt = of_property_count_u32_elems(node, key);
+	if (cnt <= 0) {
+		ret = cnt ? cnt : -EINVAL;
+		goto PROBE_PID_EXIT;
+	}
+	pid_dyn_power_coeff = devm_kzalloc(&pdev->dev,
+			sizeof(uint32_t) * cnt, GFP_KERNEL);
+	if (!pid_dyn_power_coeff) {
+		ret = -ENOMEM;
+		goto PROBE_PID_EXIT;
+	}
+	ret = of_property_read_u32_array(node, key, pid_dyn_power_coeff, cnt);
+	if (ret)
+		goto PROBE_PID_EXIT;
+	pid_dyn_power_coeff_cnt = cnt;
+
+	/* Optional properties, gains default like the power allocator */
+	temp_range = max_t(int32_t, data->temp_hysteresis_degC, 1);
+	data->pid_k_po = data->pid_k_pu =
+		div_s64(pid_int_to_frac(2 * data->pid_sustainable_power_mw),
+			temp_range);
+	data->pid_k_i = pid_int_to_frac(10) / 1000;
+	data->pid_k_d = 0;
+	data->pid_integral_cutoff_degC = 0;
+	data->pid_gpu_power_mw = 0;
+	of_property_read_u32(node, "qcom,pid-k-po", &data->pid_k_po);
+	of_property_read_u32(node, "qcom,pid-k-pu", &data->pid_k_pu);
+	of_property_read_u32(node, "qcom,pid-k-i", &data->pid_k_i);
+	of_property_read_u32(node, "qcom,pid-k-d", &data->pid_k_d);
+	of_property_read_u32(node, "qcom,pid-integral-cutoff",
+			&data->pid_integral_cutoff_degC);
+	of_property_read_u32(node, "qcom,pid-gpu-power",
+			&data->pid_gpu_power_mw);
+
+	pid_ctrl_enabled = true;
+
+PROBE_PID_EXIT:
+	if (ret) {
+		dev_dbg(&pdev->dev,
+		"%s:Failed reading node=%s, key=%s. err=%d. KTM continues\n",
+			__func__, node->full_name, key, ret);
+		if (pid_dyn_power_coeff)
+			devm_kfree(&pdev->dev, pid_dyn_power_coeff);
+		pid_dyn_power_coeff = NULL;
+		pid_dyn_power_coeff_cnt = 0;
+		pid_ctrl_enabled = false;
+	}
+	return ret;
+}
+
 static void thermal_boot_config_read(struct seq_file *m, void *data)
 {
 
@@ -7277,6 +7545,15 @@ static void thermal_boot_config_read(struct seq_file *m, void *data)
 			msm_thermal_info.core_control_mask);
 	seq_printf(m, "reset threshold:%d degC\n",
 			msm_thermal_info.therm_reset_temp_degC);
+	if (!pid_ctrl_enabled)
+		return;
+	seq_printf(m, "pid sustainable power:%u mW\n",
+			msm_thermal_info.pid_sustainable_power_mw);
+	seq_printf(m, "pid gpu power:%u mW\n",
+			msm_thermal_info.pid_gpu_power_mw);
+	seq_printf(m, "pid k_po:%d k_pu:%d k_i:%d k_d:%d\n",
+			msm_thermal_info.pid_k_po, msm_thermal_info.pid_k_pu,
+			msm_thermal_info.pid_k_i, msm_thermal_info.pid_k_d);
 }
 
 static void thermal_emergency_config_read(struct seq_file *m, void *data)
@@ -7652,6 +7929,7 @@ static int msm_thermal_dev_probe(struct platform_device *pdev)
 	ret = probe_cc(node, &data, pdev);
 
 	ret = probe_freq_mitigation(node, &data, pdev);
+	ret = probe_pid_ctrl(node, &data, pdev);
 	ret = probe_cx_phase_ctrl(node, &data, pdev);
 	ret = probe_gfx_phase_ctrl(node, &data, pdev);
 	ret = probe_therm_reset(node, &data, pdev);
@@ -157,6 +157,11 @@ struct ffs_io_data {
 
 	struct usb_ep *ep;
 	struct usb_request *req;
+
+	/* zero-copy AIO: pinned user pages mapped straight into req->sg */
+	struct page **pages;
+	unsigned int nr_pages;
+	struct sg_table sgt;
 };
 
 struct ffs_desc_helper {
@@ -650,6 +655,92 @@ static void ffs_epfile_io_complete(struct usb_ep *_ep, struct usb_request *req)
 	}
 }
 
+/*
+ * AIO transfers at least this large are done without a bounce buffer when
+ * the UDC can take a scatterlist; below it the copy is cheaper than
+ * pinning pages.
+ */
+#define FFS_SG_MIN_LEN		(4 * PAGE_SIZE)
+#define FFS_SG_MAX_PAGES	256
+
+static void ffs_release_sg(struct ffs_io_data *io_data)
+{
+	unsigned int i;
+
+	for (i = 0; i < io_data->nr_pages; i++) {
+		if (io_data->read)
+			set_page_dirty_lock(io_data->pages[i]);
+		put_page(io_data->pages[i]);
+	}
+	sg_free_table(&io_data->sgt);
+	kfree(io_data->pages);
+	io_data->pages = NULL;
+	io_data->nr_pages = 0;
+}
+
+/* Pin the user iovec and describe it as a scatterlist, one entry a page */
+static int ffs_build_sg(struct ffs_io_data *io_data)
+{
+	struct scatterlist *sg;
+	struct page **pages;
+	unsigned long start, nr = 0, i;
+	size_t len, off, chunk;
+	int n, j, ret;
+
+	for (i = 0; i < io_data->nr_segs; i++) {
+		start = (unsigned long)io_data->iovec[i].iov_base;
+		len = io_data->iovec[i].iov_len;
+		if (len)
+			nr += ((start + len + PAGE_SIZE - 1) >> PAGE_SHIFT) -
+				(start >> PAGE_SHIFT);
+	}
+	if (!nr || nr > FFS_SG_MAX_PAGES)
+		return -EINVAL;
+
+	io_data->nr_pages = 0;
+	io_data->pages = kcalloc(nr, sizeof(*io_data->pages), GFP_KERNEL);
+	if (!io_data->pages)
+		return -ENOMEM;
+
+	ret = sg_alloc_table(&io_data->sgt, nr, GFP_KERNEL);
+	if (ret) {
+		kfree(io_data->pages);
+		io_data->pages = NULL;
+		return ret;
+	}
+
+	sg = io_data->sgt.sgl;
+	for (i = 0; i < io_data->nr_segs; i++) {
+		start = (unsigned long)io_data->iovec[i].iov_base;
+		len = io_data->iovec[i].iov_len;
+		if (!len)
+			continue;
+
+		off = start & ~PAGE_MASK;
+		n = ((start + len + PAGE_SIZE - 1) >> PAGE_SHIFT) -
+			(start >> PAGE_SHIFT);
+		ret = get_user_pages_fast(start & PAGE_MASK, n, io_data->read,
+				&io_data->pages[io_data->nr_pages]);
+		if (ret > 0)
+			io_data->nr_pages += ret;
+		if (ret < n) {
+			ffs_release_sg(io_data);
+			return ret < 0 ? ret : -EFAULT;
+		}
+
+		pages = &io_data->pages[io_data->nr_pages - n];
+		for (j = 0; j < n; j++) {
+			chunk = min_t(size_t, len, PAGE_SIZE - off);
+			sg_set_page(sg, pages[j], chunk, off);
+			sg = sg_next(sg);
+			len -= chunk;
+			off = 0;
+		}
+	}
+
+	return 0;
+}
+
 static void ffs_user_copy_worker(struct work_struct *work)
 {
 	struct ffs_io_data *io_data = container_of(work, struct ffs_io_data,
@@ -657,7 +748,12 @@ static void ffs_user_copy_worker(struct work_struct *work)
 	int ret = io_data->req->status ? io_data->req->status :
 					 io_data->req->actual;
 
-	if (io_data->read && ret > 0) {
+	if (io_data->pages) {
+		/* Data already landed in (or came from) the user pages */
+		if (ret > 0)
+			ret = min_t(int, ret, io_data->len);
+		ffs_release_sg(io_data);
+	} else if (io_data->read && ret > 0) {
 		int i;
 		size_t pos = 0;
 
@@ -716,6 +812,7 @@ static ssize_t ffs_epfile_io(struct file *file, struct ffs_io_data *io_data)
 	int halt;
 	size_t extra_buf_alloc = 0;
 	bool first_read = false;
+	bool sg_supported = false;
 
 	pr_debug("%s: len %zu, read %d\n", __func__, io_data->len,
 			io_data->read);
@@ -795,16 +892,30 @@ retry:
 			   io_data->len;
 
 		extra_buf_alloc = gadget->extra_buf_alloc;
+		sg_supported = gadget->sg_supported;
 		spin_unlock_irq(&epfile->ffs->eps_lock);
 
-		if (!io_data->read)
+		/*
+		 * Large AIO transfers go zero-copy when the controller does
+		 * scatter-gather and needs neither padding nor extra room.
+		 */
+		if (io_data->aio && sg_supported && !extra_buf_alloc &&
+		    io_data->len >= FFS_SG_MIN_LEN &&
+		    data_len == io_data->len)
+			ffs_build_sg(io_data);
+
+		if (io_data->aio && io_data->pages)
+			data = NULL;
+		else if (!io_data->read)
 			data = kmalloc(data_len + extra_buf_alloc,
 					GFP_KERNEL);
 		else
 			data = kmalloc(data_len, GFP_KERNEL);
-		if (unlikely(!data))
+		if (unlikely(!data && !(io_data->aio && io_data->pages)))
 			return -ENOMEM;
-		if (io_data->aio && !io_data->read) {
+		if (io_data->aio && io_data->pages) {
+			/* nothing to copy */
+		} else if (io_data->aio && !io_data->read) {
 			int i;
 			size_t pos = 0;
 			for (i = 0; i < io_data->nr_segs; i++) {
@@ -869,7 +980,13 @@ retry:
 			if (unlikely(!req))
 				goto error_lock;
 
-			req->buf      = data;
+			if (io_data->pages) {
+				req->buf     = NULL;
+				req->sg      = io_data->sgt.sgl;
+				req->num_sgs = io_data->sgt.nents;
+			} else {
+				req->buf     = data;
+			}
 			req->length   = data_len;
 
 			io_data->buf = data;
@@ -1004,6 +1121,8 @@ error_lock:
 	mutex_unlock(&epfile->mutex);
 error:
 	kfree(data);
+	if (io_data->aio && io_data->pages)
+		ffs_release_sg(io_data);
 	if (ret < 0)
 		pr_err_ratelimited("Error: returning %zd value\n", ret);
 	return ret;
@@ -1099,6 +1218,7 @@ static ssize_t ffs_epfile_aio_write(struct kiocb *kiocb,
 
 	io_data->aio = true;
 	io_data->read = false;
+	io_data->pages = NULL;
 	io_data->kiocb = kiocb;
 	io_data->iovec = iovec;
 	io_data->nr_segs = nr_segs;
@@ -1135,6 +1255,7 @@ static ssize_t ffs_epfile_aio_read(struct kiocb *kiocb,
 
 	io_data->aio = true;
 	io_data->read = true;
+	io_data->pages = NULL;
 	io_data->kiocb = kiocb;
 	io_data->iovec = iovec_copy;
 	io_data->nr_segs = nr_segs;
@@ -50,9 +50,8 @@ struct f_hidg {
 
 	/* send report */
 	struct mutex			lock;
-	bool				write_pending;
+	struct list_head		idle_in_req;
 	wait_queue_head_t		write_queue;
-	struct usb_request		*req;
 
 	int				minor;
 	struct cdev			cdev;
@@ -240,14 +239,18 @@ static ssize_t f_hidg_read(struct file *file, char __user *buffer,
 
 static void f_hidg_req_complete(struct usb_ep *ep, struct usb_request *req)
 {
-	struct f_hidg *hidg = (struct f_hidg *)ep->driver_data;
+	struct f_hidg *hidg = (struct f_hidg *)req->context;
+	unsigned long flags;
 
-	if (req->status != 0) {
+	if (req->status != 0 && req->status != -ESHUTDOWN) {
 		ERROR(hidg->func.config->cdev,
 			"End Point Request ERROR: %d\n", req->status);
 	}
 
-	hidg->write_pending = 0;
+	spin_lock_irqsave(&hidg->spinlock, flags);
+	list_add_tail(&req->list, &hidg->idle_in_req);
+	spin_unlock_irqrestore(&hidg->spinlock, flags);
+
 	wake_up(&hidg->write_queue);
 }
 
@@ -255,6 +258,8 @@ static ssize_t f_hidg_write(struct file *file, const char __user *buffer,
 			    size_t count, loff_t *offp)
 {
 	struct f_hidg *hidg  = file->private_data;
+	struct usb_request *req;
+	unsigned long flags;
 	ssize_t status = -ENOMEM;
 
 	if (!access_ok(VERIFY_READ, buffer, count))
@@ -262,7 +267,7 @@ static ssize_t f_hidg_write(struct file *file, const char __user *buffer,
 
 	mutex_lock(&hidg->lock);
 
-#define WRITE_COND (!hidg->write_pending)
+#define WRITE_COND (!list_empty(&hidg->idle_in_req))
 
 	/* write queue */
 	while (!WRITE_COND) {
@@ -277,35 +282,49 @@ static ssize_t f_hidg_write(struct file *file, const char __user *buffer,
 		mutex_lock(&hidg->lock);
 	}
 
+	/*
+	 * Only writers take requests off the idle list and they are
+	 * serialised by hidg->lock, so the list cannot have drained
+	 * since WRITE_COND was checked.
+	 */
+	spin_lock_irqsave(&hidg->spinlock, flags);
+	req = list_first_entry(&hidg->idle_in_req, struct usb_request, list);
+	list_del(&req->list);
+	spin_unlock_irqrestore(&hidg->spinlock, flags);
+
 	count  = min_t(unsigned, count, hidg->report_length);
-	status = copy_from_user(hidg->req->buf, buffer, count);
+	status = copy_from_user(req->buf, buffer, count);
 
 	if (status != 0) {
 		ERROR(hidg->func.config->cdev,
 			"copy_from_user error\n");
-		mutex_unlock(&hidg->lock);
-		return -EINVAL;
+		status = -EINVAL;
+		goto put_req;
 	}
 
-	hidg->req->status   = 0;
-	hidg->req->zero     = 0;
-	hidg->req->length   = count;
-	hidg->req->complete = f_hidg_req_complete;
-	hidg->req->context  = hidg;
-	hidg->write_pending = 1;
+	req->status   = 0;
+	req->zero     = 0;
+	req->length   = count;
 
-	status = usb_ep_queue(hidg->in_ep, hidg->req, GFP_ATOMIC);
+	status = usb_ep_queue(hidg->in_ep, req, GFP_ATOMIC);
 	if (status < 0) {
 		ERROR(hidg->func.config->cdev,
 			"usb_ep_queue error on int endpoint %zd\n", status);
-		hidg->write_pending = 0;
-		wake_up(&hidg->write_queue);
-	} else {
-		status = count;
+		goto put_req;
 	}
 
 	mutex_unlock(&hidg->lock);
 
+	return count;
+
+put_req:
+	spin_lock_irqsave(&hidg->spinlock, flags);
+	list_add(&req->list, &hidg->idle_in_req);
+	spin_unlock_irqrestore(&hidg->spinlock, flags);
+	wake_up(&hidg->write_queue);
+
+	mutex_unlock(&hidg->lock);
+
 	return status;
 }
 
@@ -572,9 +591,13 @@ static int __init hidg_bind(struct usb_configuration *c, struct usb_function *f)
 {
 	struct usb_ep		*ep;
 	struct f_hidg		*hidg = func_to_hidg(f);
+	struct usb_request	*req, *tmp;
 	int			status;
+	int			i;
 	dev_t			dev;
 
+	INIT_LIST_HEAD(&hidg->idle_in_req);
+
 	/* allocate instance-specific interface IDs, and patch descriptors */
 	status = usb_interface_id(c, f);
 	if (status < 0)
@@ -595,15 +618,19 @@ static int __init hidg_bind(struct usb_configuration *c, struct usb_function *f)
 	ep->driver_data = c->cdev;	/* claim */
 	hidg->out_ep = ep;
 
-	/* preallocate request and buffer */
+	/*
+	 * preallocate requests and buffers, so that userspace can queue
+	 * several reports and have one sent on every polling interval
+	 */
 	status = -ENOMEM;
-	hidg->req = usb_ep_alloc_request(hidg->in_ep, GFP_KERNEL);
-	if (!hidg->req)
-		goto fail;
-
-	hidg->req->buf = kmalloc(hidg->report_length, GFP_KERNEL);
-	if (!hidg->req->buf)
-		goto fail;
+	for (i = 0; i < hidg->qlen; i++) {
+		req = hidg_alloc_ep_req(hidg->in_ep, hidg->report_length);
+		if (!req)
+			goto fail;
+		req->complete = f_hidg_req_complete;
+		req->context  = hidg;
+		list_add_tail(&req->list, &hidg->idle_in_req);
+	}
 
 	/* set descriptor dynamic values */
 	hidg_interface_desc.bInterfaceSubClass = hidg->bInterfaceSubClass;
@@ -647,10 +674,9 @@ fail_free_descs:
 	usb_free_all_descriptors(f);
 fail:
 	ERROR(f->config->cdev, "hidg_bind FAILED\n");
-	if (hidg->req != NULL) {
-		kfree(hidg->req->buf);
-		if (hidg->in_ep != NULL)
-			usb_ep_free_request(hidg->in_ep, hidg->req);
+	list_for_each_entry_safe(req, tmp, &hidg->idle_in_req, list) {
+		list_del(&req->list);
+		free_ep_req(hidg->in_ep, req);
 	}
 
 	return status;
@@ -659,15 +685,20 @@ fail:
 static void hidg_unbind(struct usb_configuration *c, struct usb_function *f)
 {
 	struct f_hidg *hidg = func_to_hidg(f);
+	struct usb_request *req, *tmp;
 
 	device_destroy(hidg_class, MKDEV(major, hidg->minor));
 	cdev_del(&hidg->cdev);
 
-	/* disable/free request and end point */
+	/*
+	 * disable end point, which gives back every queued request,
+	 * then free the requests
+	 */
 	usb_ep_disable(hidg->in_ep);
-	usb_ep_dequeue(hidg->in_ep, hidg->req);
-	kfree(hidg->req->buf);
-	usb_ep_free_request(hidg->in_ep, hidg->req);
+	list_for_each_entry_safe(req, tmp, &hidg->idle_in_req, list) {
+		list_del(&req->list);
+		free_ep_req(hidg->in_ep, req);
+	}
 
 	usb_free_all_descriptors(f);
 
@@ -698,6 +698,24 @@ static int sleep_thread(struct fsg_common *common, bool can_freeze)
 
 /*-------------------------------------------------------------------------*/
 
+/*
+ * vfs_read() of buffer N+1 already overlaps the IN transfer of buffer N,
+ * but only as far as the page cache is ahead of us.  Keep the backing
+ * file's readahead window at least as deep as the buffer ring so that
+ * with a deep ring the block layer has the whole ring's worth of reads
+ * in flight instead of stalling the thread on every 16k buffer.
+ */
+static void fsg_lun_update_readahead(struct fsg_common *common,
+				     struct fsg_lun *curlun)
+{
+	struct file	*filp = curlun->filp;
+	unsigned int	ra_pages;
+
+	ra_pages = (common->fsg_num_buffers * FSG_BUFLEN) >> PAGE_CACHE_SHIFT;
+	if (filp->f_ra.ra_pages < ra_pages)
+		filp->f_ra.ra_pages = ra_pages;
+}
+
 static int do_read(struct fsg_common *common)
 {
 	struct fsg_lun		*curlun = common->curlun;
@@ -739,6 +757,8 @@ static int do_read(struct fsg_common *common)
 	if (unlikely(amount_left == 0))
 		return -EIO;		/* No default reply */
 
+	fsg_lun_update_readahead(common, curlun);
+
 	for (;;) {
 		/*
 		 * Figure out how much we need to read:
@@ -2981,10 +3001,11 @@ EXPORT_SYMBOL_GPL(fsg_common_put);
 /* check if fsg_num_buffers is within a valid range */
 static inline int fsg_num_buffers_validate(unsigned int fsg_num_buffers)
 {
-	if (fsg_num_buffers >= 2 && fsg_num_buffers <= 4)
+	if (fsg_num_buffers >= FSG_MIN_NUM_BUFFERS &&
+	    fsg_num_buffers <= FSG_MAX_NUM_BUFFERS)
 		return 0;
 	pr_err("fsg_num_buffers %u is out of range (%d to %d)\n",
-	       fsg_num_buffers, 2, 4);
+	       fsg_num_buffers, FSG_MIN_NUM_BUFFERS, FSG_MAX_NUM_BUFFERS);
 	return -EINVAL;
 }
 
@@ -30,6 +30,7 @@
 #include <linux/debugfs.h>
 #include <linux/types.h>
 #include <linux/file.h>
+#include <linux/backing-dev.h>
 #include <linux/device.h>
 #include <linux/miscdevice.h>
 
@@ -87,6 +88,9 @@ module_param(mtp_tx_req_len, uint, S_IRUGO | S_IWUSR);
 unsigned int mtp_tx_reqs = MTP_TX_REQ_MAX;
 module_param(mtp_tx_reqs, uint, S_IRUGO | S_IWUSR);
 
+/* upper bound of the readahead window send_file_work() asks for */
+#define MTP_TX_RA_MAX_BYTES	(4 * 1024 * 1024)
+
 static const char mtp_shortname[] = DRIVER_NAME "_usb";
 
 struct mtp_dev {
@@ -552,8 +556,13 @@ static int mtp_create_bulk_endpoints(struct mtp_dev *dev,
 	dev->ep_intr = ep;
 
 retry_tx_alloc:
-	if (mtp_tx_req_len > MTP_BULK_BUFFER_SIZE)
-		mtp_tx_reqs = 4;
+	/*
+	 * Large buffers default to a shallower queue to bound memory, but
+	 * an explicitly configured mtp_tx_reqs is honoured.
+	 */
+	if (dev->mtp_tx_req_len > MTP_BULK_BUFFER_SIZE &&
+	    dev->mtp_tx_reqs == MTP_TX_REQ_MAX)
+		dev->mtp_tx_reqs = 4;
 
 	/* now allocate requests for our endpoints */
 	for (i = 0; i < dev->mtp_tx_reqs; i++) {
@@ -797,6 +806,29 @@ static ssize_t mtp_write(struct file *fp, const char __user *buf,
 }
 
 /* read from a local file and write to USB */
+/*
+ * Treat the source file like POSIX_FADV_SEQUENTIAL, with a window at least
+ * as deep as the tx request queue, so page cache readahead keeps ahead of
+ * vfs_read() and the IN endpoint does not idle waiting on storage.
+ */
+static void mtp_tx_readahead(struct mtp_dev *dev, struct file *filp)
+{
+	struct backing_dev_info *bdi = filp->f_mapping->backing_dev_info;
+	unsigned long pages;
+
+	pages = DIV_ROUND_UP(min_t(unsigned long,
+			dev->mtp_tx_reqs * dev->mtp_tx_req_len,
+			MTP_TX_RA_MAX_BYTES), PAGE_SIZE);
+	if (bdi)
+		pages = max_t(unsigned long, pages, bdi->ra_pages * 2);
+
+	if (filp->f_ra.ra_pages < pages)
+		filp->f_ra.ra_pages = pages;
+	spin_lock(&filp->f_lock);
+	filp->f_mode &= ~FMODE_RANDOM;
+	spin_unlock(&filp->f_lock);
+}
+
 static void send_file_work(struct work_struct *data)
 {
 	struct mtp_dev *dev = container_of(data, struct mtp_dev,
@@ -825,6 +857,8 @@ static void send_file_work(struct work_struct *data)
 
 	DBG(cdev, "send_file_work(%lld %lld)\n", offset, count);
 
+	mtp_tx_readahead(dev, filp);
+
 	if (dev->xfer_send_header) {
 		hdr_size = sizeof(struct mtp_data_header);
 		count += hdr_size;
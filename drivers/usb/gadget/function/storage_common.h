@@ -129,6 +129,10 @@ static inline bool fsg_lun_is_open(struct fsg_lun *curlun)
 /* Default size of buffer length. */
 #define FSG_BUFLEN	((u32)16384)
 
+/* Bounds on the depth of the data buffer ring */
+#define FSG_MIN_NUM_BUFFERS	2
+#define FSG_MAX_NUM_BUFFERS	32
+
 /* Maximal number of LUNs supported in mass storage function */
 #define FSG_MAX_LUNS	8
 /*
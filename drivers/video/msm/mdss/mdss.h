@@ -79,6 +79,8 @@ struct mdss_debug_inf {
 struct mdss_perf_tune {
 	unsigned long min_mdp_clk;
 	u64 min_bus_vote;
+	/* percentage drop required before lowering the bus or clock vote */
+	u32 vote_hysteresis;
 };
 
 #define MDSS_IRQ_SUSPEND	-1
@@ -17,6 +17,8 @@
 #include <linux/debugfs.h>
 #include <linux/uaccess.h>
 #include <linux/dma-buf.h>
+#include <linux/percpu.h>
+#include <linux/vmalloc.h>
 
 #include "mdss.h"
 #include "mdss_mdp.h"
@@ -41,15 +43,17 @@
 #define MDSS_XLOG_PRINT_ENTRY	256
 
 /*
- * xlog keeps this number of entries in memory for debug purpose. This
- * number must be greater than print entry to prevent out of bound xlog
- * entry array access.
+ * xlog keeps this number of entries per cpu in memory for debug purpose.
+ * Each cpu logs into its own ring without any shared lock, so xlog can
+ * stay enabled without costing frame time. Must be a power of two.
  */
-#define MDSS_XLOG_ENTRY	(MDSS_XLOG_PRINT_ENTRY * 4)
+#define MDSS_XLOG_CPU_ENTRY	256
 #define MDSS_XLOG_MAX_DATA 15
 #define MDSS_XLOG_BUF_MAX 512
 #define MDSS_XLOG_BUF_ALIGN 32
+#define MDSS_XLOG_NAME_LEN 32
 
+/* serializes the dump side only, loggers never take it */
 DEFINE_SPINLOCK(xlock);
 
 struct tlog {
@@ -62,11 +66,30 @@ struct tlog {
 	int pid;
 };
 
+struct mdss_xlog_cpu {
+	struct tlog logs[MDSS_XLOG_CPU_ENTRY];
+	u32 curr;	/* number of entries logged on this cpu */
+	u32 next;	/* next entry to dump as text */
+};
+
+/*
+ * fixed-size record exported through the xlog/dump_bin debugfs node,
+ * records of each cpu are in order, merge by time in userspace
+ */
+struct mdss_xlog_bin_rec {
+	u64 time;
+	u32 cpu;
+	u32 counter;
+	s32 pid;
+	s32 line;
+	u32 data_cnt;
+	u32 data[MDSS_XLOG_MAX_DATA];
+	char name[MDSS_XLOG_NAME_LEN];
+};
+
 struct mdss_dbg_xlog {
-	struct tlog logs[MDSS_XLOG_ENTRY];
-	u32 first;
-	u32 last;
-	u32 curr;
+	struct mdss_xlog_cpu __percpu *cpu_logs;
+	s64 prev_time;
 	struct dentry *xlog;
 	u32 xlog_enable;
 	u32 panic_on_err;
@@ -94,13 +117,18 @@ void mdss_xlog(const char *name, int line, int flag, ...)
 	unsigned long flags;
 	int i, val = 0;
 	va_list args;
+	struct mdss_xlog_cpu *xc;
 	struct tlog *log;
 
-	if (!mdss_xlog_is_enabled(flag))
+	if (!mdss_xlog_is_enabled(flag) || !mdss_dbg_xlog.cpu_logs)
 		return;
 
-	spin_lock_irqsave(&xlock, flags);
-	log = &mdss_dbg_xlog.logs[mdss_dbg_xlog.curr];
+	local_irq_save(flags);
+	xc = this_cpu_ptr(mdss_dbg_xlog.cpu_logs);
+	log = &xc->logs[xc->curr & (MDSS_XLOG_CPU_ENTRY - 1)];
+	/* invalidate the slot while it is rewritten, see mdss_xlog_bin_open */
+	log->counter = U32_MAX;
+	smp_wmb();
 	log->time = ktime_to_us(ktime_get());
 	log->name = name;
 	log->line = line;
@@ -118,62 +146,81 @@ void mdss_xlog(const char *name, int line, int flag, ...)
 	}
 	va_end(args);
 	log->data_cnt = i;
-	mdss_dbg_xlog.curr = (mdss_dbg_xlog.curr + 1) % MDSS_XLOG_ENTRY;
-	mdss_dbg_xlog.last++;
+	smp_wmb();
+	log->counter = xc->curr;
+	xc->curr++;
 
-	spin_unlock_irqrestore(&xlock, flags);
+	local_irq_restore(flags);
 }
 
-/* always dump the last entries which are not dumped yet */
-static bool __mdss_xlog_dump_calc_range(void)
+/* oldest entry not dumped yet across all cpus, called with xlock held */
+static struct mdss_xlog_cpu *__mdss_xlog_oldest_cpu(int *log_cpu)
 {
-	static u32 next;
-	bool need_dump = true;
-	unsigned long flags;
-	struct mdss_dbg_xlog *xlog = &mdss_dbg_xlog;
-
-	spin_lock_irqsave(&xlock, flags);
-
-	xlog->first = next;
-
-	if (xlog->last == xlog->first) {
-		need_dump = false;
-		goto dump_exit;
+	struct mdss_xlog_cpu *xc, *oldest = NULL;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		xc = per_cpu_ptr(mdss_dbg_xlog.cpu_logs, cpu);
+		if (xc->next == xc->curr)
+			continue;
+
+		if (!oldest ||
+		    xc->logs[xc->next & (MDSS_XLOG_CPU_ENTRY - 1)].time <
+		    oldest->logs[oldest->next & (MDSS_XLOG_CPU_ENTRY - 1)].time) {
+			oldest = xc;
+			*log_cpu = cpu;
+		}
 	}
 
-	if (xlog->last < xlog->first) {
-		xlog->first %= MDSS_XLOG_ENTRY;
-		if (xlog->last < xlog->first)
-			xlog->last += MDSS_XLOG_ENTRY;
+	return oldest;
+}
+
+/*
+ * always dump the last entries which are not dumped yet, skipping the
+ * ones overwritten since and keeping at most MDSS_XLOG_PRINT_ENTRY of
+ * them. Called with xlock held.
+ */
+static struct tlog *__mdss_xlog_dump_next(int *log_cpu)
+{
+	struct mdss_xlog_cpu *xc;
+	u32 pending = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		xc = per_cpu_ptr(mdss_dbg_xlog.cpu_logs, cpu);
+		if (xc->curr - xc->next > MDSS_XLOG_CPU_ENTRY)
+			xc->next = xc->curr - MDSS_XLOG_CPU_ENTRY;
+		pending += xc->curr - xc->next;
 	}
 
-	if ((xlog->last - xlog->first) > MDSS_XLOG_PRINT_ENTRY) {
-		pr_warn("xlog buffer overflow before dump: %d\n",
-			xlog->last - xlog->first);
-		xlog->first = xlog->last - MDSS_XLOG_PRINT_ENTRY;
+	if (pending > MDSS_XLOG_PRINT_ENTRY) {
+		pr_warn("xlog buffer overflow before dump: %d\n", pending);
+		while (pending-- > MDSS_XLOG_PRINT_ENTRY)
+			__mdss_xlog_oldest_cpu(&cpu)->next++;
 	}
-	next = xlog->first + 1;
 
-dump_exit:
-	spin_unlock_irqrestore(&xlock, flags);
+	xc = __mdss_xlog_oldest_cpu(log_cpu);
+	if (!xc)
+		return NULL;
 
-	return need_dump;
+	return &xc->logs[xc->next++ & (MDSS_XLOG_CPU_ENTRY - 1)];
 }
 
 static ssize_t mdss_xlog_dump_entry(char *xlog_buf, ssize_t xlog_buf_size)
 {
-	int i;
+	int i, cpu;
 	ssize_t off = 0;
-	struct tlog *log, *prev_log;
+	struct tlog *log;
 	unsigned long flags;
 
-	spin_lock_irqsave(&xlock, flags);
+	if (!mdss_dbg_xlog.cpu_logs)
+		return 0;
 
-	log = &mdss_dbg_xlog.logs[mdss_dbg_xlog.first %
-		MDSS_XLOG_ENTRY];
+	spin_lock_irqsave(&xlock, flags);
 
-	prev_log = &mdss_dbg_xlog.logs[(mdss_dbg_xlog.first - 1) %
-		MDSS_XLOG_ENTRY];
+	log = __mdss_xlog_dump_next(&cpu);
+	if (!log)
+		goto dump_exit;
 
 	off = snprintf((xlog_buf + off), (xlog_buf_size - off), "%s:%-4d",
 		log->name, log->line);
@@ -184,8 +231,10 @@ static ssize_t mdss_xlog_dump_entry(char *xlog_buf, ssize_t xlog_buf_size)
 	}
 
 	off += snprintf((xlog_buf + off), (xlog_buf_size - off),
-		"=>[%-8d:%-11llu:%9llu][%-4d]:", mdss_dbg_xlog.first,
-		log->time, (log->time - prev_log->time), log->pid);
+		"=>[%-8d:%-11llu:%9llu][%-4d:%d]:", log->counter,
+		log->time, (log->time - mdss_dbg_xlog.prev_time), log->pid,
+		cpu);
+	mdss_dbg_xlog.prev_time = log->time;
 
 	for (i = 0; i < log->data_cnt; i++)
 		off += snprintf((xlog_buf + off), (xlog_buf_size - off),
@@ -193,6 +242,7 @@ static ssize_t mdss_xlog_dump_entry(char *xlog_buf, ssize_t xlog_buf_size)
 
 	off += snprintf((xlog_buf + off), (xlog_buf_size - off), "\n");
 
+dump_exit:
 	spin_unlock_irqrestore(&xlock, flags);
 
 	return off;
@@ -202,10 +252,8 @@ static void mdss_xlog_dump_all(void)
 {
 	char xlog_buf[MDSS_XLOG_BUF_MAX];
 
-	while (__mdss_xlog_dump_calc_range()) {
-		mdss_xlog_dump_entry(xlog_buf, MDSS_XLOG_BUF_MAX);
+	while (mdss_xlog_dump_entry(xlog_buf, MDSS_XLOG_BUF_MAX) > 0)
 		pr_info("%s", xlog_buf);
-	}
 }
 
 u32 get_dump_range(struct dump_offset *range_node, size_t max_offset)
@@ -681,9 +729,9 @@ static ssize_t mdss_xlog_dump_read(struct file *file, char __user *buff,
 	ssize_t len = 0;
 	char xlog_buf[MDSS_XLOG_BUF_MAX];
 
-	if (__mdss_xlog_dump_calc_range()) {
-		len = mdss_xlog_dump_entry(xlog_buf, MDSS_XLOG_BUF_MAX);
-		if (len < 0 || len > count) {
+	len = mdss_xlog_dump_entry(xlog_buf, MDSS_XLOG_BUF_MAX);
+	if (len > 0) {
+		if (len > count) {
 			pr_err("len is more than the size of user buffer\n");
 			return 0;
 		}
@@ -716,10 +764,91 @@ static const struct file_operations mdss_xlog_fops = {
 	.write = mdss_xlog_dump_write,
 };
 
-int mdss_create_xlog_debug(struct mdss_debug_data *mdd)
+struct mdss_xlog_bin_snapshot {
+	size_t size;
+	struct mdss_xlog_bin_rec recs[0];
+};
+
+/* snapshot all cpu rings at open so the reader sees a stable copy */
+static int mdss_xlog_bin_open(struct inode *inode, struct file *file)
 {
-	int i;
+	struct mdss_xlog_bin_snapshot *snap;
+	struct mdss_xlog_bin_rec *rec;
+	struct mdss_xlog_cpu *xc;
+	struct tlog *log;
+	u32 i, first, curr;
+	int cpu;
 
+	if (!mdss_dbg_xlog.cpu_logs)
+		return -ENODEV;
+
+	snap = vzalloc(sizeof(*snap) + sizeof(*rec) *
+		MDSS_XLOG_CPU_ENTRY * num_possible_cpus());
+	if (!snap)
+		return -ENOMEM;
+
+	rec = snap->recs;
+	for_each_possible_cpu(cpu) {
+		xc = per_cpu_ptr(mdss_dbg_xlog.cpu_logs, cpu);
+		curr = ACCESS_ONCE(xc->curr);
+		smp_rmb();
+		first = curr > MDSS_XLOG_CPU_ENTRY ?
+			curr - MDSS_XLOG_CPU_ENTRY : 0;
+
+		for (i = first; i != curr; i++) {
+			log = &xc->logs[i & (MDSS_XLOG_CPU_ENTRY - 1)];
+			if (ACCESS_ONCE(log->counter) != i)
+				continue;
+			smp_rmb();
+
+			rec->time = log->time;
+			rec->cpu = cpu;
+			rec->counter = log->counter;
+			rec->pid = log->pid;
+			rec->line = log->line;
+			rec->data_cnt = min_t(u32, log->data_cnt,
+				MDSS_XLOG_MAX_DATA);
+			memcpy(rec->data, log->data,
+				sizeof(u32) * rec->data_cnt);
+			strlcpy(rec->name, log->name, sizeof(rec->name));
+
+			/* skip the entry if its cpu rewrote it while copying */
+			smp_rmb();
+			if (ACCESS_ONCE(log->counter) != i)
+				continue;
+			rec++;
+		}
+	}
+	snap->size = (char *)rec - (char *)snap->recs;
+
+	file->private_data = snap;
+	return 0;
+}
+
+static ssize_t mdss_xlog_bin_read(struct file *file, char __user *buff,
+		size_t count, loff_t *ppos)
+{
+	struct mdss_xlog_bin_snapshot *snap = file->private_data;
+
+	return simple_read_from_buffer(buff, count, ppos, snap->recs,
+		snap->size);
+}
+
+static int mdss_xlog_bin_release(struct inode *inode, struct file *file)
+{
+	vfree(file->private_data);
+	return 0;
+}
+
+static const struct file_operations mdss_xlog_bin_fops = {
+	.open = mdss_xlog_bin_open,
+	.read = mdss_xlog_bin_read,
+	.llseek = default_llseek,
+	.release = mdss_xlog_bin_release,
+};
+
+int mdss_create_xlog_debug(struct mdss_debug_data *mdd)
+{
 	mdss_dbg_xlog.xlog = debugfs_create_dir("xlog", mdd->root);
 	if (IS_ERR_OR_NULL(mdss_dbg_xlog.xlog)) {
 		pr_err("debugfs_create_dir fail, error %ld\n",
@@ -731,11 +860,14 @@ int mdss_create_xlog_debug(struct mdss_debug_data *mdd)
 	INIT_WORK(&mdss_dbg_xlog.xlog_dump_work, xlog_debug_work);
 	mdss_dbg_xlog.work_panic = false;
 
-	for (i = 0; i < MDSS_XLOG_ENTRY; i++)
-		mdss_dbg_xlog.logs[i].counter = i;
+	mdss_dbg_xlog.cpu_logs = alloc_percpu(struct mdss_xlog_cpu);
+	if (!mdss_dbg_xlog.cpu_logs)
+		pr_err("fail to allocate xlog buffers\n");
 
 	debugfs_create_file("dump", 0644, mdss_dbg_xlog.xlog, NULL,
 						&mdss_xlog_fops);
+	debugfs_create_file("dump_bin", 0444, mdss_dbg_xlog.xlog, NULL,
+						&mdss_xlog_bin_fops);
 	debugfs_create_u32("enable", 0644, mdss_dbg_xlog.xlog,
 			    &mdss_dbg_xlog.xlog_enable);
 	debugfs_create_bool("panic", 0644, mdss_dbg_xlog.xlog,
@@ -526,6 +526,7 @@ struct mdss_dsi_ctrl_pdata {
 	dma_addr_t dma_addr;
 	bool cmd_cfg_restore;
 	bool do_unicast;
+	bool cmd_tx_batch;
 
 	bool idle_enabled;
 	int horizontal_idle_cnt;
@@ -1650,6 +1650,27 @@ static int mdss_dsi_cmd_dma_tpg_tx(struct mdss_dsi_ctrl_pdata *ctrl,
 	return ret;
 }
 
+/*
+ * With cmd_tx_batch set, a command marked last that needs no delay is
+ * kept in the dma buffer and sent together with the following ones, so
+ * a panel on/off sequence needs one trigger and completion per delay
+ * rather than per command.
+ */
+static bool mdss_dsi_cmd_batch_next(struct mdss_dsi_ctrl_pdata *ctrl,
+	struct dsi_buf *tp, struct dsi_cmd_desc *cm, int cnt)
+{
+	struct dsi_cmd_desc *next = cm + 1;
+	int next_len;
+
+	if (!ctrl->cmd_tx_batch || !cnt || cm->dchdr.wait)
+		return false;
+
+	next_len = DSI_HOST_HDR_SIZE + ALIGN(next->dchdr.dlen, 4);
+
+	/* keep room for the 8 byte alignment done by mdss_dsi_buf_init */
+	return (tp->len + next_len) <= (tp->size - 8);
+}
+
 static int mdss_dsi_cmds2buf_tx(struct mdss_dsi_ctrl_pdata *ctrl,
 			struct dsi_cmd_desc *cmds, int cnt, int use_dma_tpg)
 {
@@ -1672,7 +1693,10 @@ static int mdss_dsi_cmds2buf_tx(struct mdss_dsi_ctrl_pdata *ctrl,
 			return 0;
 		}
 		tot += len;
-		if (dchdr->last) {
+		if (dchdr->last && mdss_dsi_cmd_batch_next(ctrl, tp, cm, cnt)) {
+			/* only the final packet of the dma may carry LAST */
+			*tp->hdr &= ~DSI_HDR_LAST;
+		} else if (dchdr->last) {
 			tp->data = tp->start; /* begin of buf */
 
 			wait = mdss_dsi_wait4video_eng_busy(ctrl);
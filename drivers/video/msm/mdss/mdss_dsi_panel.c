@@ -2062,6 +2062,9 @@ static int mdss_dsi_parse_panel_features(struct device_node *np,
 	pinfo->allow_phy_power_off = of_property_read_bool(np,
 		"qcom,panel-allow-phy-poweroff");
 
+	ctrl->cmd_tx_batch = of_property_read_bool(np,
+		"qcom,mdss-dsi-cmd-tx-batch");
+
 	mdss_dsi_parse_esd_params(np, ctrl);
 
 	if (pinfo->panel_ack_disabled && pinfo->esd_check_enabled) {
@@ -3441,7 +3441,16 @@ int mdss_fb_atomic_commit(struct fb_info *info,
 		}
 		return ret;
 	} else {
-		ret = mdss_fb_pan_idle(mfd);
+		/*
+		 * Once the frame in flight has released its kickoff, its
+		 * acquire fences and commit data have been consumed and the
+		 * next frame can be prepared while it is still being
+		 * displayed. Mode switches still drain the pipeline fully.
+		 */
+		if (mfd->switch_state == MDSS_MDP_NO_UPDATE_REQUESTED)
+			ret = mdss_fb_wait_for_kickoff(mfd);
+		else
+			ret = mdss_fb_pan_idle(mfd);
 		if (ret) {
 			pr_err("pan display idle call failed, ret: %d\n", ret);
 			return ret;
@@ -3458,11 +3467,11 @@ int mdss_fb_atomic_commit(struct fb_info *info,
 	}
 
 	wait_for_finish = commit_v1->flags & MDP_COMMIT_WAIT_FOR_FINISH;
+
+	mutex_lock(&mfd->mdp_sync_pt_data.sync_mutex);
 	mfd->msm_fb_backup.atomic_commit = true;
 	mfd->msm_fb_backup.disp_commit.l_roi =  commit_v1->left_roi;
 	mfd->msm_fb_backup.disp_commit.r_roi =  commit_v1->right_roi;
-
-	mutex_lock(&mfd->mdp_sync_pt_data.sync_mutex);
 	atomic_inc(&mfd->mdp_sync_pt_data.commit_cnt);
 	atomic_inc(&mfd->commits_pending);
 	atomic_inc(&mfd->kickoff_pending);
@@ -3643,10 +3652,19 @@ void mdss_panelinfo_to_fb_var(struct mdss_panel_info *pinfo,
 static int __mdss_fb_perform_commit(struct msm_fb_data_type *mfd)
 {
 	struct msm_sync_pt_data *sync_pt_data = &mfd->mdp_sync_pt_data;
-	struct msm_fb_backup_type *fb_backup = &mfd->msm_fb_backup;
+	struct msm_fb_backup_type *fb_backup = &mfd->msm_fb_inflight;
 	int ret = -ENOSYS;
 	u32 new_dsi_mode, dynamic_dsi_switch = 0;
 
+	/*
+	 * Take a private copy of the queued commit so the next one can be
+	 * staged in msm_fb_backup as soon as this one releases its kickoff.
+	 */
+	mutex_lock(&sync_pt_data->sync_mutex);
+	*fb_backup = mfd->msm_fb_backup;
+	mfd->msm_fb_backup.atomic_commit = false;
+	mutex_unlock(&sync_pt_data->sync_mutex);
+
 	if (!sync_pt_data->async_wait_fences)
 		mdss_fb_wait_for_fence(sync_pt_data);
 	sync_pt_data->flushed = false;
@@ -3686,7 +3704,6 @@ static int __mdss_fb_perform_commit(struct msm_fb_data_type *mfd)
 		else
 			pr_warn("no kickoff function setup for fb%d\n",
 				mfd->index);
-		fb_backup->atomic_commit = false;
 	} else {
 		ret = mdss_fb_pan_display_sub(&fb_backup->disp_commit.var,
 				&fb_backup->info);
@@ -3721,6 +3738,15 @@ skip_commit:
 	return ret;
 }
 
+static void mdss_fb_notify_frame_done(struct msm_fb_data_type *mfd)
+{
+	struct fb_event event;
+
+	event.info = mfd->fbi;
+	event.data = NULL;
+	fb_notifier_call_chain(FB_EVENT_FRAME_DONE, &event);
+}
+
 static int __mdss_fb_display_thread(void *data)
 {
 	struct msm_fb_data_type *mfd = data;
@@ -3750,6 +3776,9 @@ static int __mdss_fb_display_thread(void *data)
 		ret = __mdss_fb_perform_commit(mfd);
 		MDSS_XLOG(mfd->index, XLOG_FUNC_EXIT);
 
+		if (!ret)
+			mdss_fb_notify_frame_done(mfd);
+
 		atomic_dec(&mfd->commits_pending);
 		wake_up_all(&mfd->idle_wait_q);
 	}
@@ -344,6 +344,7 @@ struct msm_fb_data_type {
 	atomic_t ioctl_ref_cnt;
 
 	struct msm_fb_backup_type msm_fb_backup;
+	struct msm_fb_backup_type msm_fb_inflight;
 	struct completion power_set_comp;
 	u32 is_power_setting;
 
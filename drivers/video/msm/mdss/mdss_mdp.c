@@ -4126,6 +4126,10 @@ static int mdss_mdp_parse_dt_misc(struct platform_device *pdev)
 	mdss_mdp_parse_dt_fudge_factors(pdev, "qcom,mdss-clk-factor",
 		&mdata->clk_factor);
 
+	mdata->perf_tune.vote_hysteresis = PERF_VOTE_HYSTERESIS_PCT;
+	of_property_read_u32(pdev->dev.of_node, "qcom,mdss-vote-hysteresis",
+		&mdata->perf_tune.vote_hysteresis);
+
 	rc = of_property_read_u32(pdev->dev.of_node,
 			"qcom,max-bandwidth-low-kbps", &mdata->max_bw_low);
 	if (rc)
@@ -78,6 +78,7 @@
 #define PERF_CALC_PIPE_CALC_SMP_SIZE	BIT(2)
 
 #define PERF_SINGLE_PIPE_BW_FLOOR 1200000000
+#define PERF_VOTE_HYSTERESIS_PCT 10
 #define CURSOR_PIPE_LEFT 0
 #define CURSOR_PIPE_RIGHT 1
 
@@ -991,6 +992,11 @@ struct mdss_overlay_private {
 	bool mixer_swap;
 	u32 resources_state;
 
+	/* layer configuration accepted by the last full validation */
+	u32 validated_cfg_hash;
+	int validated_cfg_cnt;
+	u64 validated_cfg_bw;
+
 	/* list of buffers that can be reused */
 	struct list_head bufs_chunks;
 	struct list_head bufs_pool;
@@ -1706,6 +1712,7 @@ int mdss_mdp_get_prefetch_lines(struct mdss_panel_info *pinfo);
 int mdss_mdp_perf_bw_check(struct mdss_mdp_ctl *ctl,
 		struct mdss_mdp_pipe **left_plist, int left_cnt,
 		struct mdss_mdp_pipe **right_plist, int right_cnt);
+int mdss_mdp_perf_bw_recheck(struct mdss_mdp_ctl *ctl, u64 bw_ctl);
 int mdss_mdp_perf_bw_check_pipe(struct mdss_mdp_perf_params *perf,
 		struct mdss_mdp_pipe *pipe);
 int mdss_mdp_get_pipe_overlap_bw(struct mdss_mdp_pipe *pipe,
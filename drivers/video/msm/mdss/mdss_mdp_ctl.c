@@ -1675,24 +1675,27 @@ static int mdss_mdp_set_threshold_max_bandwidth(struct mdss_mdp_ctl *ctl)
 	return max;
 }
 
-int mdss_mdp_perf_bw_check(struct mdss_mdp_ctl *ctl,
-		struct mdss_mdp_pipe **left_plist, int left_cnt,
-		struct mdss_mdp_pipe **right_plist, int right_cnt)
+/**
+ * mdss_mdp_perf_bw_recheck() - check pending bandwidth against the limits
+ * @ctl:	control path whose layer configuration is being validated
+ * @bw_ctl:	bandwidth previously calculated for the configuration
+ *
+ * Used when the layer configuration is unchanged since its last validation,
+ * so the per-pipe bandwidth calculation can be reused. The sum across all
+ * interfaces and the thresholds are still evaluated since they depend on
+ * the state of the other displays.
+ */
+int mdss_mdp_perf_bw_recheck(struct mdss_mdp_ctl *ctl, u64 bw_ctl)
 {
 	struct mdss_data_type *mdata = ctl->mdata;
-	struct mdss_mdp_perf_params perf;
 	u32 bw, threshold, i, mode_switch, max_bw;
 	u64 bw_sum_of_intfs = 0;
 	bool is_video_mode;
 
-	/* we only need bandwidth check on real-time clients (interfaces) */
 	if (ctl->intf_type == MDSS_MDP_NO_INTF)
 		return 0;
 
-	__mdss_mdp_perf_calc_ctl_helper(ctl, &perf,
-			left_plist, left_cnt, right_plist, right_cnt,
-			PERF_CALC_PIPE_CALC_SMP_SIZE);
-	ctl->bw_pending = perf.bw_ctl;
+	ctl->bw_pending = bw_ctl;
 
 	for (i = 0; i < mdata->nctl; i++) {
 		struct mdss_mdp_ctl *temp = mdata->ctl_off + i;
@@ -1731,6 +1734,23 @@ int mdss_mdp_perf_bw_check(struct mdss_mdp_ctl *ctl,
 	return 0;
 }
 
+int mdss_mdp_perf_bw_check(struct mdss_mdp_ctl *ctl,
+		struct mdss_mdp_pipe **left_plist, int left_cnt,
+		struct mdss_mdp_pipe **right_plist, int right_cnt)
+{
+	struct mdss_mdp_perf_params perf;
+
+	/* we only need bandwidth check on real-time clients (interfaces) */
+	if (ctl->intf_type == MDSS_MDP_NO_INTF)
+		return 0;
+
+	__mdss_mdp_perf_calc_ctl_helper(ctl, &perf,
+			left_plist, left_cnt, right_plist, right_cnt,
+			PERF_CALC_PIPE_CALC_SMP_SIZE);
+
+	return mdss_mdp_perf_bw_recheck(ctl, perf.bw_ctl);
+}
+
 static u32 mdss_mdp_get_max_pipe_bw(struct mdss_mdp_pipe *pipe)
 {
 
@@ -2242,6 +2262,25 @@ static bool is_traffic_shaper_enabled(struct mdss_data_type *mdata)
 	return false;
 }
 
+/*
+ * Lowering a vote is only worth a bus or clock request once the drop is
+ * larger than the hysteresis, so that small frame to frame variations
+ * keep the current vote. Increases and releases always go through.
+ */
+static inline bool mdss_mdp_perf_vote_drop(struct mdss_data_type *mdata,
+		u64 cur, u64 new)
+{
+	u32 hysteresis = mdata->perf_tune.vote_hysteresis;
+
+	if (new >= cur)
+		return false;
+
+	if (!new || !hysteresis)
+		return true;
+
+	return div_u64((cur - new) * 100, cur) >= hysteresis;
+}
+
 static void mdss_mdp_ctl_perf_update(struct mdss_mdp_ctl *ctl,
 		int params_changed, bool stop_req)
 {
@@ -2288,8 +2327,10 @@ static void mdss_mdp_ctl_perf_update(struct mdss_mdp_ctl *ctl,
 		 */
 		if ((params_changed && ((new->bw_ctl > old->bw_ctl) ||
 			(new->bw_writeback > old->bw_writeback))) ||
-		    (!params_changed && ((new->bw_ctl < old->bw_ctl) ||
-			(new->bw_writeback < old->bw_writeback))) ||
+		    (!params_changed && (mdss_mdp_perf_vote_drop(mdata,
+				old->bw_ctl, new->bw_ctl) ||
+			mdss_mdp_perf_vote_drop(mdata,
+				old->bw_writeback, new->bw_writeback))) ||
 			(stop_req && mdss_mdp_is_nrt_ctl_path(ctl))) {
 
 			pr_debug("c=%d p=%d new_bw=%llu,old_bw=%llu\n",
@@ -2316,7 +2357,8 @@ static void mdss_mdp_ctl_perf_update(struct mdss_mdp_ctl *ctl,
 		 */
 		if ((params_changed && (new->mdp_clk_rate > old->mdp_clk_rate))
 			 || (!params_changed &&
-			 (new->mdp_clk_rate < old->mdp_clk_rate) &&
+			 mdss_mdp_perf_vote_drop(mdata, old->mdp_clk_rate,
+				new->mdp_clk_rate) &&
 			(false == is_traffic_shaper_enabled(mdata)))) {
 			old->mdp_clk_rate = new->mdp_clk_rate;
 			update_clk = 1;
@@ -31,6 +31,7 @@
 #define STOP_TIMEOUT(hz) msecs_to_jiffies((1000 / hz) * (6 + 2))
 #define POWER_COLLAPSE_TIME msecs_to_jiffies(100)
 #define CMD_MODE_IDLE_TIMEOUT msecs_to_jiffies(16 * 4)
+#define CMD_MODE_DAMAGE_IDLE_TIMEOUT msecs_to_jiffies(16)
 #define INPUT_EVENT_HANDLER_DELAY_USECS (16000 * 4)
 #define AUTOREFRESH_MAX_FRAME_CNT 6
 
@@ -104,6 +105,10 @@ struct mdss_mdp_cmd_ctx {
 	struct mdss_mdp_cmd_ctx *sync_ctx; /* for partial update */
 	u32 pp_timeout_report_cnt;
 	bool pingpong_split_slave;
+
+	/* content damage of the last kickoff, see mdss_mdp_cmd_track_damage */
+	ktime_t last_damage_time;
+	bool damage_idle;
 };
 
 struct mdss_mdp_cmd_ctx mdss_mdp_cmd_ctx_list[MAX_SESSIONS];
@@ -728,6 +733,8 @@ int mdss_mdp_resource_control(struct mdss_mdp_ctl *ctl, u32 sw_event)
 			/* start work item to shut down after delay */
 			schedule_delayed_work(
 					&ctx->delayed_off_clk_work,
+					ctx->damage_idle ?
+					CMD_MODE_DAMAGE_IDLE_TIMEOUT :
 					CMD_MODE_IDLE_TIMEOUT);
 		}
 
@@ -2673,6 +2680,30 @@ static void __mdss_mdp_kickoff(struct mdss_mdp_ctl *ctl,
  * for left+right case, pingpong_done is enabled for both and
  * only the last pingpong_done should trigger the notification
  */
+/*
+ * mdss_mdp_cmd_track_damage() - classify the damage of the frame kicked off
+ *
+ * A partial update that arrives after the panel has been idle for longer
+ * than the idle timeout is typical of static content with small periodic
+ * changes (clock, cursor). Nothing else is expected to follow, so resources
+ * are released one frame after its transfer instead of after the full idle
+ * timeout. Full frame or back to back updates keep the default timeout to
+ * avoid toggling clocks during animations.
+ */
+static void mdss_mdp_cmd_track_damage(struct mdss_mdp_ctl *ctl,
+	struct mdss_mdp_cmd_ctx *ctx)
+{
+	ktime_t now = ktime_get();
+	bool isolated, partial;
+
+	isolated = ktime_to_ms(ktime_sub(now, ctx->last_damage_time)) >
+		jiffies_to_msecs(CMD_MODE_IDLE_TIMEOUT);
+	partial = (ctl->roi.w * ctl->roi.h) < (ctl->width * ctl->height);
+
+	ctx->damage_idle = isolated && partial;
+	ctx->last_damage_time = now;
+}
+
 static int mdss_mdp_cmd_kickoff(struct mdss_mdp_ctl *ctl, void *arg)
 {
 	struct mdss_mdp_ctl *sctl = NULL, *mctl = ctl;
@@ -2727,6 +2758,8 @@ static int mdss_mdp_cmd_kickoff(struct mdss_mdp_ctl *ctl, void *arg)
 	MDSS_XLOG(ctl->num, ctx->current_pp_num,
 		ctl->roi.x, ctl->roi.y, ctl->roi.w, ctl->roi.h);
 
+	mdss_mdp_cmd_track_damage(ctl, ctx);
+
 	atomic_inc(&ctx->koff_cnt);
 	if (sctx)
 		atomic_inc(&sctx->koff_cnt);
@@ -24,6 +24,7 @@
 #include <linux/sync.h>
 #include <linux/sw_sync.h>
 #include <linux/file.h>
+#include <linux/jhash.h>
 
 #include <soc/qcom/event_timer.h>
 #include "mdss.h"
@@ -985,6 +986,75 @@ static struct mdss_mdp_pipe *__find_layer_in_validate_q(
 	return found ? pipe : NULL;
 }
 
+/*
+ * __layer_cfg_hash() - hash the geometry of a layer list
+ *
+ * Covers the same parameters as __compare_layer_config() along with the pipe
+ * assignment and panel frame rate, so that a list which only swaps buffers
+ * hashes to the same value as the one last validated.
+ */
+static u32 __layer_cfg_hash(struct msm_fb_data_type *mfd,
+	struct mdp_input_layer *layer_list, int layer_count)
+{
+	u32 hash = mdss_panel_get_framerate(mfd->panel_info,
+			FPS_RESOLUTION_HZ);
+	int i;
+
+	for (i = 0; i < layer_count; i++) {
+		struct mdp_input_layer *layer = &layer_list[i];
+		u32 cfg[] = {
+			layer->pipe_ndx, layer->flags, layer->z_order,
+			layer->horz_deci, layer->vert_deci, layer->alpha,
+			layer->transp_mask, layer->bg_color, layer->blend_op,
+			layer->color_space, layer->buffer.width,
+			layer->buffer.height, layer->buffer.format,
+		};
+
+		hash = jhash2(cfg, ARRAY_SIZE(cfg), hash);
+		hash = jhash(&layer->src_rect, sizeof(layer->src_rect), hash);
+		hash = jhash(&layer->dst_rect, sizeof(layer->dst_rect), hash);
+		if ((layer->flags & SCALER_ENABLED) && layer->scale)
+			hash = jhash(layer->scale,
+				sizeof(struct mdp_scale_data_v2), hash);
+	}
+
+	return hash;
+}
+
+/*
+ * __layer_cfg_cached() - check if a layer list matches the last validation
+ *
+ * The list is only considered cached when it hashes to the configuration
+ * accepted by the last full validation and every layer still matches its
+ * pipe in the used list. Layers carrying post processing data always take
+ * the full path since their pp config has to be programmed.
+ */
+static bool __layer_cfg_cached(struct mdss_overlay_private *mdp5_data,
+	struct mdss_mdp_validate_info_t *validate_info_list, int layer_count,
+	u32 hash)
+{
+	struct mdss_mdp_pipe *pipe;
+	int i;
+
+	if (!layer_count || (layer_count != mdp5_data->validated_cfg_cnt) ||
+	    (hash != mdp5_data->validated_cfg_hash))
+		return false;
+
+	for (i = 0; i < layer_count; i++) {
+		if (validate_info_list[i].layer->flags & MDP_LAYER_PP)
+			return false;
+
+		pipe = __find_layer_in_validate_q(&validate_info_list[i],
+				mdp5_data);
+		if (!pipe)
+			return false;
+
+		pipe->dirty = false;
+	}
+
+	return true;
+}
+
 static bool __find_pipe_in_list(struct list_head *head,
 	int pipe_ndx, struct mdss_mdp_pipe **out_pipe,
 	enum mdss_mdp_pipe_rect rect_num)
@@ -1652,6 +1722,7 @@ static int __validate_layers(struct msm_fb_data_type *mfd,
 	enum layer_pipe_q pipe_q_type;
 	enum layer_zorder_used zorder_used[MDSS_MDP_MAX_STAGE] = {0};
 	enum mdss_mdp_pipe_rect rect_num;
+	u32 cfg_hash;
 
 	ret = mutex_lock_interruptible(&mdp5_data->ov_lock);
 	if (ret)
@@ -1716,6 +1787,24 @@ static int __validate_layers(struct msm_fb_data_type *mfd,
 	force_validate = (mfd->switch_state != MDSS_MDP_NO_UPDATE_REQUESTED);
 	mutex_unlock(&mfd->switch_lock);
 
+	/*
+	 * Layer geometry is the same as the last validated frame: skip the
+	 * z_order, pipe and bandwidth calculations and only recheck the
+	 * cached bandwidth against the current limits.
+	 */
+	cfg_hash = __layer_cfg_hash(mfd, layer_list, layer_count);
+	if (!force_validate && __layer_cfg_cached(mdp5_data,
+			validate_info_list, layer_count, cfg_hash)) {
+		ret = mdss_mdp_perf_bw_recheck(mdp5_data->ctl,
+				mdp5_data->validated_cfg_bw);
+		if (ret) {
+			pr_err("bw validation check failed: %d\n", ret);
+			goto validate_exit;
+		}
+		i = layer_count;
+		goto validate_skip;
+	}
+
 	for (i = 0; i < layer_count; i++) {
 		enum layer_zorder_used z = LAYER_ZORDER_NONE;
 
@@ -1914,6 +2003,10 @@ static int __validate_layers(struct msm_fb_data_type *mfd,
 		goto validate_exit;
 	}
 
+	mdp5_data->validated_cfg_hash = cfg_hash;
+	mdp5_data->validated_cfg_cnt = layer_count;
+	mdp5_data->validated_cfg_bw = mdp5_data->ctl->bw_pending;
+
 validate_skip:
 	__handle_free_list(mdp5_data, validate_info_list, layer_count);
 
@@ -1928,6 +2021,8 @@ validate_exit:
 			left_lm_layers, right_lm_layers,
 			rec_release_ndx[0], rec_release_ndx[1],
 			rec_destroy_ndx[0], rec_destroy_ndx[1], ret);
+	if (IS_ERR_VALUE(ret))
+		mdp5_data->validated_cfg_cnt = 0;
 	mutex_lock(&mdp5_data->list_lock);
 	list_for_each_entry_safe(pipe, tmp, &mdp5_data->pipes_used, list) {
 		if (IS_ERR_VALUE(ret)) {
@@ -2685,6 +2685,10 @@ int mdss_mdp_pp_resume(struct msm_fb_data_type *mfd)
 	disp_num = mfd->index;
 	pp_sts = mdss_pp_res->pp_disp_sts[disp_num];
 
+	/* LUT contents were lost with the power collapse */
+	if (pp_driver_ops.lut_cache_reset)
+		pp_driver_ops.lut_cache_reset();
+
 	if (pp_sts.pa_sts & PP_STS_ENABLE) {
 		flags |= PP_FLAGS_DIRTY_PA;
 		pa_v2_cache_cfg = &mdss_pp_res->pa_v2_disp_cfg[disp_num];
@@ -106,6 +106,7 @@ struct mdp_pp_driver_ops {
 	int (*get_hist_isr_info)(u32 *isr_mask);
 	bool (*is_sspp_hist_supp)(void);
 	void (*gamut_clk_gate_en)(char __iomem *base_addr);
+	void (*lut_cache_reset)(void);
 };
 
 struct mdss_pp_res_type_v1_7 {
@@ -15,6 +15,7 @@
 #define pr_fmt(fmt)	"%s: " fmt, __func__
 
 #include <linux/uaccess.h>
+#include <linux/jhash.h>
 #include "mdss_fb.h"
 #include "mdss_mdp.h"
 #include "mdss_mdp_pp.h"
@@ -242,6 +243,7 @@ static int pp_gamut_get_version(u32 *version);
 static int pp_dither_get_version(u32 *version);
 static int pp_hist_lut_get_version(u32 *version);
 static void pp_gamut_clock_gating_en(char __iomem *base_addr);
+static void pp_lut_cache_reset(void);
 
 void *pp_get_driver_ops_v1_7(struct mdp_pp_driver_ops *ops)
 {
@@ -301,9 +303,60 @@ void *pp_get_driver_ops_v1_7(struct mdp_pp_driver_ops *ops)
 	ops->get_hist_isr_info = pp_get_hist_isr;
 	ops->is_sspp_hist_supp = pp_is_sspp_hist_supp;
 	ops->gamut_clk_gate_en = pp_gamut_clock_gating_en;
+	ops->lut_cache_reset = pp_lut_cache_reset;
 	return &config_data;
 }
 
+/*
+ * Hashes of the LUT tables last programmed in the IGC and GC blocks. Color
+ * transitions typically resend every LUT although only one feature (such as
+ * PCC) changes, so tables identical to the ones already in hardware are not
+ * rewritten. Entries are keyed by the LUT register address and IGC block
+ * mask. Callers hold mdss_pp_mutex.
+ */
+#define PP_LUT_CACHE_SIZE 8
+
+static struct pp_lut_cache_entry {
+	char __iomem *addr;
+	u32 sel;
+	u32 hash;
+} pp_lut_cache[PP_LUT_CACHE_SIZE];
+static u32 pp_lut_cache_next;
+
+static void pp_lut_cache_reset(void)
+{
+	memset(pp_lut_cache, 0, sizeof(pp_lut_cache));
+}
+
+/*
+ * pp_lut_cache_update() - record a LUT about to be programmed
+ *
+ * Returns true if the same table is already programmed at @addr, in which
+ * case the caller can skip writing the LUT registers.
+ */
+static bool pp_lut_cache_update(char __iomem *addr, u32 sel, u32 hash)
+{
+	struct pp_lut_cache_entry *entry;
+	int i;
+
+	for (i = 0; i < PP_LUT_CACHE_SIZE; i++) {
+		entry = &pp_lut_cache[i];
+		if (entry->addr == addr && entry->sel == sel) {
+			if (entry->hash == hash)
+				return true;
+			entry->hash = hash;
+			return false;
+		}
+	}
+
+	entry = &pp_lut_cache[pp_lut_cache_next];
+	pp_lut_cache_next = (pp_lut_cache_next + 1) % PP_LUT_CACHE_SIZE;
+	entry->addr = addr;
+	entry->sel = sel;
+	entry->hash = hash;
+	return false;
+}
+
 static void pp_opmode_config(int location, struct pp_sts_type *pp_sts,
 		u32 *opmode, int side)
 {
@@ -1756,6 +1809,16 @@ static int pp_igc_set_config(char __iomem *base_addr,
 	}
 	c1 = c0 + 4;
 	c2 = c1 + 4;
+	if (block_type == DSPP) {
+		u32 hash = jhash2(lut_data->c0_c1_data, IGC_LUT_ENTRIES, 0);
+
+		hash = jhash2(lut_data->c2_data, IGC_LUT_ENTRIES, hash);
+		if (pp_lut_cache_update(c0, lut_cfg_data->block, hash)) {
+			pr_debug("igc table unchanged for mask %d\n",
+				lut_cfg_data->block);
+			goto bail_out;
+		}
+	}
 	data = IGC_INDEX_UPDATE | IGC_CONFIG_MASK(lut_cfg_data->block);
 	pr_debug("data %x block type %d mask %x\n",
 		  data, lut_cfg_data->block,
@@ -1919,6 +1982,13 @@ static int pp_pgc_set_config(char __iomem *base_addr,
 	c0 = base_addr + PGC_C0_LUT_INDEX;
 	c1 = c0 + PGC_C1C2_LUT_OFF;
 	c2 = c1 + PGC_C1C2_LUT_OFF;
+	val = jhash2(pgc_data_v17->c0_data, PGC_LUT_ENTRIES, 0);
+	val = jhash2(pgc_data_v17->c1_data, PGC_LUT_ENTRIES, val);
+	val = jhash2(pgc_data_v17->c2_data, PGC_LUT_ENTRIES, val);
+	if (pp_lut_cache_update(c0, block_type, val)) {
+		pr_debug("gc table unchanged for block %d\n", block_type);
+		goto set_ops;
+	}
 	/*  set the indexes to zero */
 	writel_relaxed(0, c0 + PGC_INDEX_OFF);
 	writel_relaxed(0, c1 + PGC_INDEX_OFF);
@@ -24,6 +24,8 @@
 #include <linux/msm-bus.h>
 #include <linux/msm-bus-board.h>
 #include <linux/regulator/consumer.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 #include "mdss_rotator_internal.h"
 #include "mdss_mdp.h"
@@ -71,6 +73,7 @@ static struct msm_bus_scale_pdata rot_reg_bus_scale_table = {
 
 static struct mdss_rot_mgr *rot_mgr;
 static void mdss_rotator_work_handler(struct kthread_work *work);
+static void mdss_rotator_prep_work_handler(struct kthread_work *work);
 
 static int mdss_rotator_bus_scale_set_quota(struct mdss_rot_bus_data_type *bus,
 		u64 quota)
@@ -868,6 +871,20 @@ static int mdss_rotator_init_queue(struct mdss_rot_mgr *mgr)
 		}
 		sched_setscheduler(mgr->queues[i].thread, SCHED_FIFO, &param);
 
+		snprintf(name, sizeof(name), "rot_prep_%d", i);
+		init_kthread_worker(&mgr->queues[i].prep_worker);
+		mgr->queues[i].prep_thread = kthread_run(kthread_worker_fn,
+						&mgr->queues[i].prep_worker,
+						name);
+		if (IS_ERR(mgr->queues[i].prep_thread)) {
+			pr_err("Unable to start rotator prep thread: %d", i);
+			mgr->queues[i].prep_thread = NULL;
+			ret = -ENOMEM;
+			break;
+		}
+		sched_setscheduler(mgr->queues[i].prep_thread, SCHED_FIFO,
+				   &param);
+
 		snprintf(name, sizeof(name), "rot_timeline_%d", i);
 		pr_debug("timeline name=%s\n", name);
 		mgr->queues[i].timeline.timeline =
@@ -899,6 +916,9 @@ static void mdss_rotator_deinit_queue(struct mdss_rot_mgr *mgr)
 		if (mgr->queues[i].thread)
 			kthread_stop(mgr->queues[i].thread);
 
+		if (mgr->queues[i].prep_thread)
+			kthread_stop(mgr->queues[i].prep_thread);
+
 		if (mgr->queues[i].timeline.timeline) {
 			struct sync_timeline *obj;
 			obj = (struct sync_timeline *)
@@ -1034,6 +1054,8 @@ static void mdss_rotator_queue_request(struct mdss_rot_mgr *mgr,
 		entry = req->entries + i;
 		queue = entry->queue;
 		entry->output_fence = NULL;
+		entry->queued_time = ktime_get();
+		queue_kthread_work(&queue->prep_worker, &entry->prep_work);
 		queue_kthread_work(&queue->worker, &entry->commit_work);
 	}
 }
@@ -1545,6 +1567,9 @@ static int mdss_rotator_add_request(struct mdss_rot_mgr *mgr,
 
 		init_kthread_work(&entry->commit_work,
 				  mdss_rotator_work_handler);
+		init_kthread_work(&entry->prep_work,
+				  mdss_rotator_prep_work_handler);
+		init_completion(&entry->prep_done);
 
 		ret = mdss_rotator_create_fence(entry);
 		if (ret) {
@@ -1596,6 +1621,7 @@ static void mdss_rotator_cancel_request(struct mdss_rot_mgr *mgr,
 	 */
 	for (i = req->count - 1; i >= 0; i--) {
 		entry = req->entries + i;
+		flush_kthread_work(&entry->prep_work);
 		flush_kthread_work(&entry->commit_work);
 	}
 
@@ -1794,6 +1820,7 @@ static int mdss_rotator_kickoff_entry(struct mdss_rot_hw_resource *hw,
 		.priv_data = entry,
 	};
 
+	entry->kickoff_time = ktime_get();
 	ret = mdss_mdp_writeback_display_commit(hw->ctl, &wb_args);
 	return ret;
 }
@@ -1842,22 +1869,42 @@ static int mdss_rotator_commit_entry(struct mdss_rot_hw_resource *hw,
 	return ret;
 }
 
-static int mdss_rotator_handle_entry(struct mdss_rot_hw_resource *hw,
-	struct mdss_rot_entry *entry)
+/*
+ * Runs on the queue prepare worker, so the input fence wait and buffer
+ * mapping of an entry overlap with the hw processing of the previous one.
+ * The commit worker waits on prep_done before touching the entry buffers.
+ */
+static void mdss_rotator_prep_work_handler(struct kthread_work *work)
 {
+	struct mdss_rot_entry *entry;
 	int ret;
 
+	entry = container_of(work, struct mdss_rot_entry, prep_work);
+
 	ret = mdss_rotator_wait_for_input(entry);
 	if (ret) {
 		pr_err("wait for input buffer failed %d\n", ret);
-		return ret;
+		goto done;
 	}
 
 	ret = mdss_rotator_map_and_check_data(entry);
-	if (ret) {
+	if (ret)
 		pr_err("fail to prepare input/output data %d\n", ret);
+
+done:
+	entry->prep_ret = ret;
+	entry->prepared_time = ktime_get();
+	complete(&entry->prep_done);
+}
+
+static int mdss_rotator_handle_entry(struct mdss_rot_hw_resource *hw,
+	struct mdss_rot_entry *entry)
+{
+	int ret;
+
+	ret = entry->prep_ret;
+	if (ret)
 		return ret;
-	}
 
 	ret = mdss_rotator_commit_entry(hw, entry);
 	if (ret)
@@ -1866,12 +1913,30 @@ static int mdss_rotator_handle_entry(struct mdss_rot_hw_resource *hw,
 	return ret;
 }
 
+static void mdss_rotator_record_timing(struct mdss_rot_mgr *mgr,
+	struct mdss_rot_entry *entry, int status)
+{
+	struct mdss_rot_timing *t;
+
+	mutex_lock(&mgr->timing_lock);
+	t = &mgr->timing[mgr->timing_idx];
+	t->session_id = entry->item.session_id;
+	t->wb_idx = entry->item.wb_idx;
+	t->status = status;
+	t->queued_time = entry->queued_time;
+	t->prepared_time = entry->prepared_time;
+	t->kickoff_time = entry->kickoff_time;
+	t->done_time = entry->done_time;
+	mgr->timing_idx = (mgr->timing_idx + 1) % MDSS_ROT_TIMING_HISTORY;
+	mutex_unlock(&mgr->timing_lock);
+}
+
 static void mdss_rotator_work_handler(struct kthread_work *work)
 {
 	struct mdss_rot_entry *entry;
 	struct mdss_rot_entry_container *request;
 	struct mdss_rot_hw_resource *hw;
-	int ret;
+	int ret = -ENODEV;
 
 	entry = container_of(work, struct mdss_rot_entry, commit_work);
 	request = entry->request;
@@ -1881,6 +1946,9 @@ static void mdss_rotator_work_handler(struct kthread_work *work)
 		return;
 	}
 
+	/* buffers must not be released while the prepare worker uses them */
+	wait_for_completion(&entry->prep_done);
+
 	hw = mdss_rotator_get_hw_resource(entry->queue, entry);
 	if (!hw) {
 		pr_err("no hw for the queue\n");
@@ -1903,6 +1971,8 @@ static void mdss_rotator_work_handler(struct kthread_work *work)
 	mdss_rotator_put_hw_resource(entry->queue, hw);
 
 get_hw_res_err:
+	entry->done_time = ktime_get();
+	mdss_rotator_record_timing(rot_mgr, entry, ret);
 	mdss_rotator_signal_output(entry);
 	mdss_rotator_release_entry(rot_mgr, entry);
 	atomic_dec(&request->pending_count);
@@ -2596,6 +2666,60 @@ static struct attribute_group mdss_rotator_fs_attr_group = {
 	.attrs = mdss_rotator_fs_attrs
 };
 
+static int mdss_rotator_timing_show(struct seq_file *s, void *data)
+{
+	struct mdss_rot_mgr *mgr = s->private;
+	struct mdss_rot_timing *t;
+	u32 i, idx;
+
+	seq_puts(s, "session wb status queued_us prep_us wait_us hw_us\n");
+
+	mutex_lock(&mgr->timing_lock);
+	for (i = 0; i < MDSS_ROT_TIMING_HISTORY; i++) {
+		idx = (mgr->timing_idx + i) % MDSS_ROT_TIMING_HISTORY;
+		t = &mgr->timing[idx];
+		if (!ktime_to_us(t->queued_time))
+			continue;
+
+		seq_printf(s, "%u %u %d %lld %lld %lld %lld\n",
+			t->session_id, t->wb_idx, t->status,
+			ktime_to_us(t->queued_time),
+			ktime_us_delta(t->prepared_time, t->queued_time),
+			ktime_to_us(t->kickoff_time) ?
+			ktime_us_delta(t->kickoff_time, t->prepared_time) : 0,
+			ktime_to_us(t->kickoff_time) ?
+			ktime_us_delta(t->done_time, t->kickoff_time) : 0);
+	}
+	mutex_unlock(&mgr->timing_lock);
+
+	return 0;
+}
+
+static int mdss_rotator_timing_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mdss_rotator_timing_show, inode->i_private);
+}
+
+static const struct file_operations mdss_rotator_timing_fops = {
+	.open = mdss_rotator_timing_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static void mdss_rotator_debugfs_init(struct mdss_rot_mgr *mgr)
+{
+	mgr->debugfs_root = debugfs_create_dir(DRIVER_NAME, NULL);
+	if (IS_ERR_OR_NULL(mgr->debugfs_root)) {
+		pr_debug("debugfs_create_dir for rotator failed\n");
+		mgr->debugfs_root = NULL;
+		return;
+	}
+
+	debugfs_create_file("timing", 0444, mgr->debugfs_root, mgr,
+			    &mdss_rotator_timing_fops);
+}
+
 static const struct file_operations mdss_rotator_fops = {
 	.owner = THIS_MODULE,
 	.open = mdss_rotator_open,
@@ -2881,6 +3005,7 @@ static int mdss_rotator_probe(struct platform_device *pdev)
 	mutex_init(&rot_mgr->lock);
 	mutex_init(&rot_mgr->clk_lock);
 	mutex_init(&rot_mgr->bus_lock);
+	mutex_init(&rot_mgr->timing_lock);
 	atomic_set(&rot_mgr->device_suspended, 0);
 	ret = mdss_rotator_init_queue(rot_mgr);
 	if (ret) {
@@ -2932,6 +3057,8 @@ static int mdss_rotator_probe(struct platform_device *pdev)
 		pr_err("res_init failed %d\n", ret);
 		goto error_res_init;
 	}
+
+	mdss_rotator_debugfs_init(rot_mgr);
 	return 0;
 
 error_res_init:
@@ -2959,6 +3086,7 @@ static int mdss_rotator_remove(struct platform_device *dev)
 		return -ENODEV;
 
 	sysfs_remove_group(&rot_mgr->device->kobj, &mdss_rotator_fs_attr_group);
+	debugfs_remove_recursive(mgr->debugfs_root);
 
 	mdss_rotator_release_all(mgr);
 
@@ -22,6 +22,8 @@
 #include <linux/mutex.h>
 #include <linux/types.h>
 #include <linux/cdev.h>
+#include <linux/completion.h>
+#include <linux/ktime.h>
 
 #include  "mdss_mdp.h"
 
@@ -31,6 +33,9 @@
  */
 #define MDSS_MDP_DEFINING_FLAG_BITS MDP_ROTATION_90
 
+/* number of completed entries kept for the debugfs timing history */
+#define MDSS_ROT_TIMING_HISTORY 32
+
 struct mdss_rot_entry;
 struct mdss_rot_perf;
 
@@ -69,9 +74,16 @@ struct mdss_rot_hw_resource {
 	struct mdss_rot_entry *workload;
 };
 
+/*
+ * each queue has two workers: the prepare worker waits for the input
+ * fence and maps the buffers of the next entry while the commit worker
+ * drives the writeback hw for the current one.
+ */
 struct mdss_rot_queue {
 	struct kthread_worker worker;
 	struct task_struct *thread;
+	struct kthread_worker prep_worker;
+	struct task_struct *prep_thread;
 	struct mdss_rot_timeline timeline;
 	struct mutex hw_lock;
 	struct mdss_rot_hw_resource *hw;
@@ -88,6 +100,9 @@ struct mdss_rot_entry_container {
 struct mdss_rot_entry {
 	struct mdp_rotation_item item;
 	struct kthread_work commit_work;
+	struct kthread_work prep_work;
+	struct completion prep_done;
+	int prep_ret;
 
 	struct mdss_rot_queue *queue;
 	struct mdss_rot_entry_container *request;
@@ -109,6 +124,21 @@ struct mdss_rot_entry {
 
 	struct mdss_rot_perf *perf;
 	bool work_assigned; /* Used when cleaning up work_distribution */
+
+	ktime_t queued_time;
+	ktime_t prepared_time;
+	ktime_t kickoff_time;
+	ktime_t done_time;
+};
+
+struct mdss_rot_timing {
+	u32 session_id;
+	u32 wb_idx;
+	int status;
+	ktime_t queued_time;
+	ktime_t prepared_time;
+	ktime_t kickoff_time;
+	ktime_t done_time;
 };
 
 struct mdss_rot_perf {
@@ -182,6 +212,11 @@ struct mdss_rot_mgr {
 	struct clk *rot_clk[MDSS_CLK_ROTATOR_END_IDX];
 	int rot_enable_clk_cnt;
 
+	struct dentry *debugfs_root;
+	struct mutex timing_lock;
+	struct mdss_rot_timing timing[MDSS_ROT_TIMING_HISTORY];
+	u32 timing_idx;
+
 	bool has_downscale;
 	bool has_ubwc;
 };
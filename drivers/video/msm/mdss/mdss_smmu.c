@@ -699,6 +699,7 @@ int mdss_smmu_probe(struct platform_device *pdev)
 	const struct of_device_id *match;
 	struct dss_module_power *mp;
 	int disable_htw = 1;
+	int fast = 1, atomic_ctx = 1;
 	char name[MAX_CLIENT_NAME_LEN];
 	const __be32 *address = NULL, *size = NULL;
 
@@ -808,6 +809,29 @@ int mdss_smmu_probe(struct platform_device *pdev)
 			pr_err("couldn't set secure pixel vmid\n");
 			goto release_mapping;
 		}
+	} else if (of_property_read_bool(pdev->dev.of_node,
+			"qcom,fast-map")) {
+		/*
+		 * Fast mapping ops use a preallocated page table and skip the
+		 * generic iommu map path, which cuts the per-frame cost of
+		 * mapping layer buffers. The domain attribute must be set
+		 * before the first attach, which then installs the fast ops.
+		 */
+		rc = iommu_domain_set_attr(mdss_smmu->mmu_mapping->domain,
+			DOMAIN_ATTR_ATOMIC, &atomic_ctx);
+		if (rc) {
+			pr_err("couldn't set domain as atomic\n");
+			goto release_mapping;
+		}
+
+		rc = iommu_domain_set_attr(mdss_smmu->mmu_mapping->domain,
+			DOMAIN_ATTR_FAST, &fast);
+		if (rc) {
+			pr_err("couldn't set fast map\n");
+			goto release_mapping;
+		}
+		pr_debug("iommu v2 domain[%d] uses fast map\n",
+			smmu_domain.domain);
 	}
 
 	if (!mdata->handoff_pending)
@@ -1009,8 +1009,15 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 	unsigned long flags;
 	struct epitem *epi = ep_item_from_wait(wait);
 	struct eventpoll *ep = epi->ep;
+	__u32 events = ACCESS_ONCE(epi->event.events);
 
-	spin_lock_irqsave(&ep->lock, flags);
+	/*
+	 * The event mask is checked before taking ep->lock, so wakeups the
+	 * item is not interested in (e.g. write space on a socket that is
+	 * only polled for input) never disable IRQs or touch the lock.
+	 * ep_modify() does not change the mask under ep->lock either, it
+	 * relies on polling the file after publishing the new mask.
+	 */
 
 	/*
 	 * If the event mask does not contain any poll(2) event, we consider the
@@ -1018,8 +1025,8 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 	 * EPOLLONESHOT bit that disables the descriptor when an event is received,
 	 * until the next EPOLL_CTL_MOD will be issued.
 	 */
-	if (!(epi->event.events & ~EP_PRIVATE_BITS))
-		goto out_unlock;
+	if (!(events & ~EP_PRIVATE_BITS))
+		goto out;
 
 	/*
 	 * Check the events coming with the callback. At this stage, not
@@ -1027,8 +1034,10 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 	 * callback. We need to be able to handle both cases here, hence the
 	 * test for "key" != NULL before the event match test.
 	 */
-	if (key && !((unsigned long) key & epi->event.events))
-		goto out_unlock;
+	if (key && !((unsigned long) key & events))
+		goto out;
+
+	spin_lock_irqsave(&ep->lock, flags);
 
 	/*
 	 * If we are transferring events to userspace, we can hold no locks
@@ -1074,7 +1083,7 @@ out_unlock:
 	if (pwake)
 		ep_poll_safewake(&ep->poll_wait);
 
-
+out:
 	if ((unsigned long)key & POLLFREE) {
 		/*
 		 * If we race with ep_remove_wait_queue() it can miss
@@ -1431,8 +1440,8 @@ static int ep_modify(struct eventpoll *ep, struct epitem *epi, struct epoll_even
 	 *    we do not miss events from ep_poll_callback if an
 	 *    event occurs immediately after we call f_op->poll().
 	 *    We need this because we did not take ep->lock while
-	 *    changing epi above (but ep_poll_callback does take
-	 *    ep->lock).
+	 *    changing epi above (and ep_poll_callback reads the
+	 *    event mask before taking ep->lock).
 	 *
 	 * 2) We also need to ensure we do not miss _past_ events
 	 *    when calling f_op->poll().  This barrier also
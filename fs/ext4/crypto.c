@@ -35,6 +35,7 @@
 #include <linux/scatterlist.h>
 #include <linux/spinlock_types.h>
 #include <linux/namei.h>
+#include <linux/percpu.h>
 
 #include "ext4_extents.h"
 #include "xattr.h"
@@ -53,6 +54,21 @@ MODULE_PARM_DESC(num_prealloc_crypto_ctxs,
 
 static mempool_t *ext4_bounce_page_pool;
 
+/*
+ * Bounce pages released on write completion are parked on a small per-cpu
+ * stack and handed straight to the next ext4_encrypt() on that cpu, so a
+ * steady write-out does not bounce pages through the page allocator (and
+ * the mempool reserve) once per page.
+ */
+#define EXT4_PERCPU_BOUNCE_PAGES	16
+
+struct ext4_bounce_cache {
+	unsigned int nr;
+	struct page *pages[EXT4_PERCPU_BOUNCE_PAGES];
+};
+
+static DEFINE_PER_CPU(struct ext4_bounce_cache, ext4_bounce_cache);
+
 static LIST_HEAD(ext4_free_crypto_ctxs);
 static DEFINE_SPINLOCK(ext4_crypto_ctx_lock);
 
@@ -68,12 +84,56 @@ struct kmem_cache *ext4_crypt_info_cachep;
  *
  * If there's a bounce page in the context, this frees that.
  */
+static struct page *ext4_get_cached_bounce_page(void)
+{
+	struct ext4_bounce_cache *bc;
+	struct page *page = NULL;
+	unsigned long flags;
+
+	local_irq_save(flags);
+	bc = this_cpu_ptr(&ext4_bounce_cache);
+	if (bc->nr)
+		page = bc->pages[--bc->nr];
+	local_irq_restore(flags);
+	return page;
+}
+
+static void ext4_free_bounce_page(struct page *page)
+{
+	struct ext4_bounce_cache *bc;
+	unsigned long flags;
+
+	local_irq_save(flags);
+	bc = this_cpu_ptr(&ext4_bounce_cache);
+	if (bc->nr < EXT4_PERCPU_BOUNCE_PAGES) {
+		bc->pages[bc->nr++] = page;
+		page = NULL;
+	}
+	local_irq_restore(flags);
+
+	if (page)
+		mempool_free(page, ext4_bounce_page_pool);
+}
+
+static void ext4_drain_bounce_caches(void)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct ext4_bounce_cache *bc = per_cpu_ptr(&ext4_bounce_cache,
+							   cpu);
+
+		while (bc->nr)
+			__free_page(bc->pages[--bc->nr]);
+	}
+}
+
 void ext4_release_crypto_ctx(struct ext4_crypto_ctx *ctx)
 {
 	unsigned long flags;
 
 	if (ctx->flags & EXT4_WRITE_PATH_FL && ctx->w.bounce_page)
-		mempool_free(ctx->w.bounce_page, ext4_bounce_page_pool);
+		ext4_free_bounce_page(ctx->w.bounce_page);
 	ctx->w.bounce_page = NULL;
 	ctx->w.control_page = NULL;
 	if (ctx->flags & EXT4_CTX_REQUIRES_FREE_ENCRYPT_FL) {
@@ -109,11 +169,9 @@ struct ext4_crypto_ctx *ext4_get_crypto_ctx(struct inode *inode,
 	 * We first try getting the ctx from a free list because in
 	 * the common case the ctx will have an allocated and
 	 * initialized crypto tfm, so it's probably a worthwhile
-	 * optimization. For the bounce page, we first try getting it
-	 * from the kernel allocator because that's just about as fast
-	 * as getting it from a list and because a cache of free pages
-	 * should generally be a "last resort" option for a filesystem
-	 * to be able to do its job.
+	 * optimization. For the bounce page, we first try the per-cpu
+	 * stack of recently released pages, then the mempool, whose
+	 * reserve is the "last resort" when the kernel allocator fails.
 	 */
 	spin_lock_irqsave(&ext4_crypto_ctx_lock, flags);
 	ctx = list_first_entry_or_null(&ext4_free_crypto_ctxs,
@@ -155,6 +213,7 @@ void ext4_exit_crypto(void)
 	list_for_each_entry_safe(pos, n, &ext4_free_crypto_ctxs, free_list)
 		kmem_cache_free(ext4_crypto_ctx_cachep, pos);
 	INIT_LIST_HEAD(&ext4_free_crypto_ctxs);
+	ext4_drain_bounce_caches();
 	if (ext4_bounce_page_pool)
 		mempool_destroy(ext4_bounce_page_pool);
 	ext4_bounce_page_pool = NULL;
@@ -315,7 +374,10 @@ static int ext4_page_crypto(struct inode *inode,
 static struct page *alloc_bounce_page(struct ext4_crypto_ctx *ctx,
 				      gfp_t gfp_flags)
 {
-	ctx->w.bounce_page = mempool_alloc(ext4_bounce_page_pool, gfp_flags);
+	ctx->w.bounce_page = ext4_get_cached_bounce_page();
+	if (ctx->w.bounce_page == NULL)
+		ctx->w.bounce_page = mempool_alloc(ext4_bounce_page_pool,
+						   gfp_flags);
 	if (ctx->w.bounce_page == NULL)
 		return ERR_PTR(-ENOMEM);
 	ctx->flags |= EXT4_WRITE_PATH_FL;
@@ -16,7 +16,9 @@
 #include <keys/encrypted-type.h>
 #include <keys/user-type.h>
 #include <linux/crypto.h>
+#include <linux/dcache.h>
 #include <linux/gfp.h>
+#include <linux/hash.h>
 #include <linux/kernel.h>
 #include <linux/key.h>
 #include <linux/list.h>
@@ -29,6 +31,140 @@
 #include "ext4_crypto.h"
 #include "xattr.h"
 
+/*
+ * Decrypted names of a directory's entries, hung off its ext4_crypt_info
+ * so readdir does not run the filename cipher again for names it has
+ * already seen.  The cache goes away together with the key material,
+ * when the crypt info is freed at inode eviction, and is capped at
+ * EXT4_FNAME_CACHE_MAX entries with the oldest entry dropped first.
+ */
+#define EXT4_FNAME_CACHE_BITS	6
+#define EXT4_FNAME_CACHE_MAX	512
+
+struct ext4_fname_cache_entry {
+	struct hlist_node	hnode;
+	struct list_head	lru;
+	unsigned int		hash;
+	u32			clen;	/* ciphertext length */
+	u32			plen;	/* plaintext length */
+	unsigned char		data[];	/* ciphertext, then plaintext */
+};
+
+struct ext4_fname_cache {
+	spinlock_t		lock;
+	unsigned int		count;
+	struct list_head	lru;
+	struct hlist_head	buckets[1 << EXT4_FNAME_CACHE_BITS];
+};
+
+static struct ext4_fname_cache *ext4_fname_cache_get(struct ext4_crypt_info *ci)
+{
+	struct ext4_fname_cache *cache = ACCESS_ONCE(ci->ci_fname_cache);
+	int i;
+
+	if (cache)
+		return cache;
+
+	cache = kmalloc(sizeof(*cache), GFP_NOFS | __GFP_NOWARN);
+	if (!cache)
+		return NULL;
+	spin_lock_init(&cache->lock);
+	cache->count = 0;
+	INIT_LIST_HEAD(&cache->lru);
+	for (i = 0; i < ARRAY_SIZE(cache->buckets); i++)
+		INIT_HLIST_HEAD(&cache->buckets[i]);
+
+	if (cmpxchg(&ci->ci_fname_cache, NULL, cache) != NULL) {
+		kfree(cache);
+		cache = ci->ci_fname_cache;
+	}
+	return cache;
+}
+
+void ext4_fname_cache_free(struct ext4_fname_cache *cache)
+{
+	struct ext4_fname_cache_entry *ce, *tmp;
+
+	if (!cache)
+		return;
+
+	list_for_each_entry_safe(ce, tmp, &cache->lru, lru) {
+		memzero_explicit(ce->data, ce->clen + ce->plen);
+		kfree(ce);
+	}
+	kfree(cache);
+}
+
+static int ext4_fname_cache_lookup(struct ext4_crypt_info *ci,
+				   const struct ext4_str *iname,
+				   struct ext4_str *oname)
+{
+	struct ext4_fname_cache *cache = ACCESS_ONCE(ci->ci_fname_cache);
+	struct ext4_fname_cache_entry *ce;
+	unsigned int hash;
+	int res = -ENOENT;
+
+	if (!cache)
+		return res;
+
+	hash = full_name_hash(iname->name, iname->len);
+	spin_lock(&cache->lock);
+	hlist_for_each_entry(ce, &cache->buckets[hash_32(hash,
+					EXT4_FNAME_CACHE_BITS)], hnode) {
+		if (ce->hash != hash || ce->clen != iname->len ||
+		    memcmp(ce->data, iname->name, iname->len))
+			continue;
+		memcpy(oname->name, ce->data + ce->clen, ce->plen);
+		oname->len = ce->plen;
+		res = oname->len;
+		break;
+	}
+	spin_unlock(&cache->lock);
+	return res;
+}
+
+static void ext4_fname_cache_insert(struct ext4_crypt_info *ci,
+				    const struct ext4_str *iname,
+				    const struct ext4_str *oname)
+{
+	struct ext4_fname_cache *cache = ext4_fname_cache_get(ci);
+	struct ext4_fname_cache_entry *ce, *old = NULL;
+	unsigned int hash;
+
+	if (!cache)
+		return;
+
+	ce = kmalloc(sizeof(*ce) + iname->len + oname->len,
+		     GFP_NOFS | __GFP_NOWARN);
+	if (!ce)
+		return;
+	hash = full_name_hash(iname->name, iname->len);
+	ce->hash = hash;
+	ce->clen = iname->len;
+	ce->plen = oname->len;
+	memcpy(ce->data, iname->name, iname->len);
+	memcpy(ce->data + ce->clen, oname->name, oname->len);
+
+	spin_lock(&cache->lock);
+	if (cache->count >= EXT4_FNAME_CACHE_MAX) {
+		old = list_first_entry(&cache->lru,
+				       struct ext4_fname_cache_entry, lru);
+		hlist_del(&old->hnode);
+		list_del(&old->lru);
+		cache->count--;
+	}
+	hlist_add_head(&ce->hnode,
+		       &cache->buckets[hash_32(hash, EXT4_FNAME_CACHE_BITS)]);
+	list_add_tail(&ce->lru, &cache->lru);
+	cache->count++;
+	spin_unlock(&cache->lock);
+
+	if (old) {
+		memzero_explicit(old->data, old->clen + old->plen);
+		kfree(old);
+	}
+}
+
 /**
  * ext4_dir_crypt_complete() -
  */
@@ -157,6 +293,11 @@ static int ext4_fname_decrypt(struct inode *inode,
 	if (iname->len <= 0 || iname->len > lim)
 		return -EIO;
 
+	res = ext4_fname_cache_lookup(ci, iname, oname);
+	if (res >= 0)
+		return res;
+	res = 0;
+
 	tmp_in[0].name = iname->name;
 	tmp_in[0].len = iname->len;
 	tmp_out[0].name = oname->name;
@@ -193,6 +334,7 @@ static int ext4_fname_decrypt(struct inode *inode,
 	}
 
 	oname->len = strnlen(oname->name, iname->len);
+	ext4_fname_cache_insert(ci, iname, oname);
 	return oname->len;
 }
 
@@ -89,6 +89,7 @@ void ext4_free_crypt_info(struct ext4_crypt_info *ci)
 		return;
 
 	crypto_free_ablkcipher(ci->ci_ctfm);
+	ext4_fname_cache_free(ci->ci_fname_cache);
 	kmem_cache_free(ext4_crypt_info_cachep, ci);
 }
 
@@ -155,6 +156,7 @@ int ext4_get_encryption_info(struct inode *inode)
 	crypt_info->ci_data_mode = ctx.contents_encryption_mode;
 	crypt_info->ci_filename_mode = ctx.filenames_encryption_mode;
 	crypt_info->ci_ctfm = NULL;
+	crypt_info->ci_fname_cache = NULL;
 	memcpy(crypt_info->ci_master_key, ctx.master_key_descriptor,
 	       sizeof(crypt_info->ci_master_key));
 	if (S_ISREG(inode->i_mode))
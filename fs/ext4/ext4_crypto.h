@@ -73,11 +73,14 @@ struct ext4_encryption_key {
         __u32 size;
 } __attribute__((__packed__));
 
+struct ext4_fname_cache;
+
 struct ext4_crypt_info {
 	char		ci_data_mode;
 	char		ci_filename_mode;
 	char		ci_flags;
 	struct crypto_ablkcipher *ci_ctfm;
+	struct ext4_fname_cache *ci_fname_cache; /* decrypted dir entry names */
 	char		ci_master_key[EXT4_KEY_DESCRIPTOR_SIZE];
 };
 
@@ -407,7 +407,9 @@ data_copy:
 
 	/* Even in case of data=writeback it is reasonable to pin
 	 * inode to transaction, to prevent unexpected data loss */
-	*err = ext4_jbd2_file_inode(handle, orig_inode);
+	*err = ext4_jbd2_inode_add_write(handle, orig_inode,
+			((loff_t)orig_page_offset << PAGE_CACHE_SHIFT) + from,
+			replaced_size);
 
 unlock_pages:
 	unlock_page(pagep[0]);
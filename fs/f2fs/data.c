@@ -834,6 +834,7 @@ struct page *f2fs_get_read_data_page(struct inode *inode, pgoff_t index,
 	err = f2fs_get_dnode_of_data(&dn, index, LOOKUP_NODE);
 	if (err)
 		goto put_err;
+	f2fs_cache_read_extent(&dn);
 	f2fs_put_dnode(&dn);
 
 	if (unlikely(dn.data_blkaddr == NULL_ADDR)) {
@@ -1177,6 +1178,9 @@ next_dnode:
 	last_ofs_in_node = ofs_in_node = dn.ofs_in_node;
 	end_offset = ADDRS_PER_PAGE(dn.node_page, inode);
 
+	if (!create && flag != F2FS_GET_BLOCK_PRECACHE)
+		f2fs_cache_read_extent(&dn);
+
 next_block:
 	blkaddr = datablock_addr(dn.inode, dn.node_page, dn.ofs_in_node);
 
@@ -787,6 +787,44 @@ void f2fs_update_extent_cache(struct dnode_of_data *dn)
 	f2fs_update_extent_tree_range(dn->inode, fofs, blkaddr, 1);
 }
 
+/*
+ * On a read-side extent cache miss, cache the whole run of physically
+ * contiguous blocks of @dn's node page around dn->ofs_in_node, so that
+ * following random reads of large read-mostly files (APKs, OBBs) hit the
+ * cache instead of walking node pages again. Runs shorter than
+ * F2FS_MIN_EXTENT_LEN are not worth an extent node.
+ */
+void f2fs_cache_read_extent(struct dnode_of_data *dn)
+{
+	struct inode *inode = dn->inode;
+	unsigned int end_offset, start, end;
+	block_t blkaddr = dn->data_blkaddr;
+	pgoff_t fofs;
+
+	if (!f2fs_may_extent_tree(inode) ||
+			!__is_valid_data_blkaddr(blkaddr))
+		return;
+
+	end_offset = ADDRS_PER_PAGE(dn->node_page, inode);
+	start = dn->ofs_in_node;
+	end = dn->ofs_in_node + 1;
+
+	while (start > 0 && datablock_addr(inode, dn->node_page, start - 1) ==
+			blkaddr - (dn->ofs_in_node - start + 1))
+		start--;
+	while (end < end_offset && datablock_addr(inode, dn->node_page, end) ==
+			blkaddr + (end - dn->ofs_in_node))
+		end++;
+
+	if (end - start < F2FS_MIN_EXTENT_LEN)
+		return;
+
+	fofs = f2fs_start_bidx_of_node(ofs_of_node(dn->node_page), inode);
+	f2fs_update_extent_tree_range(inode, fofs + start,
+			blkaddr - (dn->ofs_in_node - start), end - start);
+	stat_inc_read_fill_ext(F2FS_I_SB(inode));
+}
+
 void f2fs_update_extent_cache_range(struct dnode_of_data *dn,
 				pgoff_t fofs, block_t blkaddr, unsigned int len)
 
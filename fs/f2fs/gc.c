@@ -13,6 +13,8 @@
 #include <linux/kthread.h>
 #include <linux/delay.h>
 #include <linux/freezer.h>
+#include <linux/genhd.h>
+#include <linux/fb.h>
 
 #include "f2fs.h"
 #include "node.h"
@@ -20,6 +22,21 @@
 #include "gc.h"
 #include <trace/events/f2fs.h>
 
+/*
+ * f2fs only tracks its own in-flight pages, check the whole disk so that
+ * I/O to other partitions (or not yet accounted by f2fs) also counts.
+ */
+static bool bdev_is_busy(struct f2fs_sb_info *sbi)
+{
+	int i;
+
+	for (i = 0; i < sbi->s_ndevs; i++)
+		if (part_in_flight(&FDEV(i).bdev->bd_disk->part0))
+			return true;
+
+	return part_in_flight(&sbi->sb->s_bdev->bd_disk->part0);
+}
+
 static int gc_thread_func(void *data)
 {
 	struct f2fs_sb_info *sbi = data;
@@ -70,6 +87,8 @@ static int gc_thread_func(void *data)
 		 * 2. IO subsystem is idle by checking the # of writeback pages.
 		 * 3. IO subsystem is idle by checking the # of requests in
 		 *    bdev's request list.
+		 * 4. While the screen is on, only when free space is short;
+		 *    while it is off, as often as screen_off_sleep_time.
 		 *
 		 * Note) We have to avoid triggering GCs frequently.
 		 * Because it is possible that some segments can be
@@ -87,17 +106,26 @@ static int gc_thread_func(void *data)
 			goto next;
 		}
 
-		if (!is_idle(sbi, GC_TIME)) {
+		if (!is_idle(sbi, GC_TIME) || bdev_is_busy(sbi)) {
 			increase_sleep_time(gc_th, &wait_ms);
 			mutex_unlock(&sbi->gc_mutex);
 			stat_io_skip_bggc_count(sbi);
 			goto next;
 		}
 
-		if (has_enough_invalid_blocks(sbi))
-			decrease_sleep_time(gc_th, &wait_ms);
-		else
+		if (has_enough_invalid_blocks(sbi)) {
+			if (gc_th->screen_state == GC_SCREEN_OFF)
+				wait_ms = gc_th->screen_off_sleep_time;
+			else
+				decrease_sleep_time(gc_th, &wait_ms);
+		} else {
 			increase_sleep_time(gc_th, &wait_ms);
+			if (gc_th->screen_state == GC_SCREEN_ON) {
+				mutex_unlock(&sbi->gc_mutex);
+				stat_io_skip_bggc_count(sbi);
+				goto next;
+			}
+		}
 do_gc:
 		stat_inc_bggc_count(sbi);
 
@@ -117,6 +145,46 @@ next:
 	return 0;
 }
 
+#ifdef CONFIG_FB
+static int gc_fb_notifier_call(struct notifier_block *nb,
+				unsigned long event, void *data)
+{
+	struct f2fs_gc_kthread *gc_th = container_of(nb,
+				struct f2fs_gc_kthread, fb_notifier);
+	struct fb_event *evdata = data;
+	int blank;
+
+	if (event != FB_EVENT_BLANK || !evdata || !evdata->data)
+		return NOTIFY_OK;
+
+	blank = *(int *)evdata->data;
+	if (blank == FB_BLANK_UNBLANK) {
+		gc_th->screen_state = GC_SCREEN_ON;
+	} else if (blank == FB_BLANK_POWERDOWN) {
+		gc_th->screen_state = GC_SCREEN_OFF;
+		gc_th->gc_wake = 1;
+		wake_up_interruptible_all(&gc_th->gc_wait_queue_head);
+	}
+	return NOTIFY_OK;
+}
+
+static void gc_register_fb_notifier(struct f2fs_gc_kthread *gc_th)
+{
+	gc_th->fb_notifier.notifier_call = gc_fb_notifier_call;
+	if (fb_register_client(&gc_th->fb_notifier))
+		gc_th->fb_notifier.notifier_call = NULL;
+}
+
+static void gc_unregister_fb_notifier(struct f2fs_gc_kthread *gc_th)
+{
+	if (gc_th->fb_notifier.notifier_call)
+		fb_unregister_client(&gc_th->fb_notifier);
+}
+#else
+static void gc_register_fb_notifier(struct f2fs_gc_kthread *gc_th) {}
+static void gc_unregister_fb_notifier(struct f2fs_gc_kthread *gc_th) {}
+#endif
+
 int f2fs_start_gc_thread(struct f2fs_sb_info *sbi)
 {
 	struct f2fs_gc_kthread *gc_th;
@@ -133,8 +201,10 @@ int f2fs_start_gc_thread(struct f2fs_sb_info *sbi)
 	gc_th->min_sleep_time = DEF_GC_THREAD_MIN_SLEEP_TIME;
 	gc_th->max_sleep_time = DEF_GC_THREAD_MAX_SLEEP_TIME;
 	gc_th->no_gc_sleep_time = DEF_GC_THREAD_NOGC_SLEEP_TIME;
+	gc_th->screen_off_sleep_time = DEF_GC_THREAD_SCREEN_OFF_SLEEP_TIME;
 
 	gc_th->gc_wake= 0;
+	gc_th->screen_state = GC_SCREEN_UNKNOWN;
 
 	sbi->gc_thread = gc_th;
 	init_waitqueue_head(&sbi->gc_thread->gc_wait_queue_head);
@@ -144,7 +214,9 @@ int f2fs_start_gc_thread(struct f2fs_sb_info *sbi)
 		err = PTR_ERR(gc_th->f2fs_gc_task);
 		kvfree(gc_th);
 		sbi->gc_thread = NULL;
+		goto out;
 	}
+	gc_register_fb_notifier(gc_th);
 out:
 	return err;
 }
@@ -154,6 +226,7 @@ void f2fs_stop_gc_thread(struct f2fs_sb_info *sbi)
 	struct f2fs_gc_kthread *gc_th = sbi->gc_thread;
 	if (!gc_th)
 		return;
+	gc_unregister_fb_notifier(gc_th);
 	kthread_stop(gc_th->f2fs_gc_task);
 	kvfree(gc_th);
 	sbi->gc_thread = NULL;
@@ -268,6 +341,13 @@ static unsigned int get_cb_cost(struct f2fs_sb_info *sbi, unsigned int segno)
 		age = 100 - div64_u64(100 * (mtime - sit_i->min_mtime),
 				sit_i->max_mtime - sit_i->min_mtime);
 
+	/*
+	 * Blocks of hot segments tend to be invalidated by the user soon
+	 * anyway; let them age rather than copying data that will die.
+	 */
+	if (IS_HOT(get_seg_entry(sbi, start)->type))
+		age >>= 1;
+
 	return UINT_MAX - ((100 * (100 - u) * age) / (100 + u));
 }
 
@@ -14,6 +14,7 @@
 #define DEF_GC_THREAD_MIN_SLEEP_TIME	30000	/* milliseconds */
 #define DEF_GC_THREAD_MAX_SLEEP_TIME	60000
 #define DEF_GC_THREAD_NOGC_SLEEP_TIME	300000	/* wait 5 min */
+#define DEF_GC_THREAD_SCREEN_OFF_SLEEP_TIME	1000	/* 1 sec */
 #define LIMIT_INVALID_BLOCK	40 /* percentage over total user space */
 #define LIMIT_FREE_BLOCK	40 /* percentage over invalid + free space */
 
@@ -22,6 +23,13 @@
 /* Search max. number of dirty segments to select a victim segment */
 #define DEF_MAX_VICTIM_SEARCH 4096 /* covers 8GB */
 
+/* display state as last reported through the fb notifier */
+enum {
+	GC_SCREEN_UNKNOWN,	/* no blank/unblank event seen yet */
+	GC_SCREEN_ON,
+	GC_SCREEN_OFF,
+};
+
 struct f2fs_gc_kthread {
 	struct task_struct *f2fs_gc_task;
 	wait_queue_head_t gc_wait_queue_head;
@@ -31,9 +39,16 @@ struct f2fs_gc_kthread {
 	unsigned int min_sleep_time;
 	unsigned int max_sleep_time;
 	unsigned int no_gc_sleep_time;
+	unsigned int screen_off_sleep_time;
 
 	/* for changing gc mode */
 	unsigned int gc_wake;
+
+	/* GC runs eagerly while the screen is off, sparingly while it's on */
+	int screen_state;
+#ifdef CONFIG_FB
+	struct notifier_block fb_notifier;
+#endif
 };
 
 struct gc_inode_list {
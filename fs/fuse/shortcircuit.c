@@ -22,6 +22,7 @@ void fuse_setup_shortcircuit(struct fuse_conn *fc, struct fuse_req *req)
 	int daemon_fd;
 	struct file *rw_lower_file = NULL;
 	struct fuse_open_out *open_out;
+	struct super_block *lower_sb;
 	int open_out_index;
 
 	req->private_lower_rw_file = NULL;
@@ -44,9 +45,23 @@ void fuse_setup_shortcircuit(struct fuse_conn *fc, struct fuse_req *req)
 	if (daemon_fd < 0)
 		return;
 
-	rw_lower_file = fget_raw(daemon_fd);
+	rw_lower_file = fget(daemon_fd);
 	if (!rw_lower_file)
 		return;
+
+	/*
+	 * Only bind files that can serve the I/O themselves. Refusing fuse
+	 * files and deeply stacked ones also keeps a daemon from building a
+	 * recursion through its own mount.
+	 */
+	lower_sb = file_inode(rw_lower_file)->i_sb;
+	if (!rw_lower_file->f_op->read_iter ||
+	    !rw_lower_file->f_op->write_iter ||
+	    lower_sb->s_magic == FUSE_SUPER_MAGIC ||
+	    lower_sb->s_stack_depth >= FILESYSTEM_MAX_STACK_DEPTH) {
+		fput(rw_lower_file);
+		return;
+	}
 	req->private_lower_rw_file = rw_lower_file;
 }
 
@@ -65,6 +80,10 @@ static ssize_t fuse_shortcircuit_read_write_iter(struct kiocb *iocb,
 	lower_file = ff->rw_lower_file;
 	fc = ff->fc;
 
+	/* the daemon's fd must allow what the fuse file was opened for */
+	if (!(lower_file->f_mode & (do_write ? FMODE_WRITE : FMODE_READ)))
+		return -EBADF;
+
 	/* lock lower file to prevent it from being released */
 	get_file(lower_file);
 	iocb->ki_filp = lower_file;
@@ -72,8 +91,6 @@ static ssize_t fuse_shortcircuit_read_write_iter(struct kiocb *iocb,
 	lower_inode = file_inode(lower_file);
 
 	if (do_write) {
-		if (!lower_file->f_op->write_iter)
-			return -EIO;
 		ret_val = lower_file->f_op->write_iter(iocb, iter);
 
 		if (ret_val >= 0 || ret_val == -EIOCBQUEUED) {
@@ -83,8 +100,6 @@ static ssize_t fuse_shortcircuit_read_write_iter(struct kiocb *iocb,
 			fsstack_copy_attr_times(fuse_inode, lower_inode);
 		}
 	} else {
-		if (!lower_file->f_op->read_iter)
-			return -EIO;
 		ret_val = lower_file->f_op->read_iter(iocb, iter);
 		if (ret_val >= 0 || ret_val == -EIOCBQUEUED)
 			fsstack_copy_attr_atime(fuse_inode, lower_inode);
@@ -2413,9 +2413,11 @@ void jbd2_journal_refile_buffer(journal_t *journal, struct journal_head *jh)
 }
 
 /*
- * File inode in the inode list of the handle's transaction
+ * File inode in the inode list of the handle's transaction, covering the
+ * byte range [start_byte, end_byte] of its data
  */
-int jbd2_journal_file_inode(handle_t *handle, struct jbd2_inode *jinode)
+static int __jbd2_journal_file_inode(handle_t *handle,
+		struct jbd2_inode *jinode, loff_t start_byte, loff_t end_byte)
 {
 	transaction_t *transaction = handle->h_transaction;
 	journal_t *journal;
@@ -2440,12 +2442,26 @@ int jbd2_journal_file_inode(handle_t *handle, struct jbd2_inode *jinode)
 	 * and if jinode->i_next_transaction == transaction, commit code
 	 * will only file the inode where we want it.
 	 */
-	if (jinode->i_transaction == transaction ||
-	    jinode->i_next_transaction == transaction)
+	if ((jinode->i_transaction == transaction ||
+	    jinode->i_next_transaction == transaction) &&
+	    jinode->i_dirty_start <= start_byte &&
+	    jinode->i_dirty_end >= end_byte)
 		return 0;
 
 	spin_lock(&journal->j_list_lock);
 
+	/*
+	 * The commit writes out and waits on the union of all ranges
+	 * filed against the inode, not the whole mapping.
+	 */
+	if (jinode->i_dirty_end) {
+		jinode->i_dirty_start = min(jinode->i_dirty_start, start_byte);
+		jinode->i_dirty_end = max(jinode->i_dirty_end, end_byte);
+	} else {
+		jinode->i_dirty_start = start_byte;
+		jinode->i_dirty_end = end_byte;
+	}
+
 	if (jinode->i_transaction == transaction ||
 	    jinode->i_next_transaction == transaction)
 		goto done;
@@ -2476,6 +2492,22 @@ done:
 	return 0;
 }
 
+int jbd2_journal_file_inode(handle_t *handle, struct jbd2_inode *jinode)
+{
+	return __jbd2_journal_file_inode(handle, jinode, 0, LLONG_MAX);
+}
+
+/*
+ * Like jbd2_journal_file_inode(), but only the @length bytes at
+ * @start_byte need to reach the disk before the transaction commits.
+ */
+int jbd2_journal_inode_ranged_write(handle_t *handle,
+		struct jbd2_inode *jinode, loff_t start_byte, loff_t length)
+{
+	return __jbd2_journal_file_inode(handle, jinode, start_byte,
+			start_byte + length - 1);
+}
+
 /*
  * File truncate and transaction commit interact with each other in a
  * non-trivial way.  If a transaction writing data block A is
@@ -933,6 +933,8 @@ err_sighand:
 	unlock_task_sighand(task, &flags);
 err_task_lock:
 	task_unlock(task);
+	if (!err)
+		lmk_adj_update(task);
 	put_task_struct(task);
 out:
 	return err < 0 ? err : count;
@@ -1022,6 +1024,8 @@ err_sighand:
 	unlock_task_sighand(task, &flags);
 err_task_lock:
 	task_unlock(task);
+	if (!err)
+		lmk_adj_update(task);
 	put_task_struct(task);
 out:
 	return err < 0 ? err : count;
@@ -2645,6 +2649,60 @@ static int proc_tgid_io_accounting(struct seq_file *m, struct pid_namespace *ns,
 }
 #endif /* CONFIG_TASK_IO_ACCOUNTING */
 
+#ifdef CONFIG_TASK_IO_LATENCY
+static int do_io_latency(struct task_struct *task, struct seq_file *m, int whole)
+{
+	struct task_io_accounting acct = task->ioac;
+	unsigned long flags;
+	int result, i;
+
+	result = mutex_lock_killable(&task->signal->cred_guard_mutex);
+	if (result)
+		return result;
+
+	if (!ptrace_may_access(task, PTRACE_MODE_READ_FSCREDS)) {
+		result = -EACCES;
+		goto out_unlock;
+	}
+
+	if (whole && lock_task_sighand(task, &flags)) {
+		struct task_struct *t = task;
+
+		task_io_accounting_add(&acct, &task->signal->ioac);
+		while_each_thread(task, t)
+			task_io_accounting_add(&acct, &t->ioac);
+
+		unlock_task_sighand(task, &flags);
+	}
+
+	seq_printf(m, "wait_total_us: %llu\n"
+		      "service_total_us: %llu\n"
+		      "%-10s %10s %10s\n",
+		   div_u64(acct.io_wait_ns, NSEC_PER_USEC),
+		   div_u64(acct.io_service_ns, NSEC_PER_USEC),
+		   "bucket_us", "wait", "service");
+	for (i = 0; i < TASK_IO_LAT_BUCKETS; i++)
+		seq_printf(m, "%-10lu %10u %10u\n",
+			   i ? 1UL << (i - 1) : 0UL,
+			   acct.io_wait_hist[i], acct.io_service_hist[i]);
+out_unlock:
+	mutex_unlock(&task->signal->cred_guard_mutex);
+	return result;
+}
+
+static int proc_tid_io_latency(struct seq_file *m, struct pid_namespace *ns,
+			       struct pid *pid, struct task_struct *task)
+{
+	return do_io_latency(task, m, 0);
+}
+
+static int proc_tgid_io_latency(struct seq_file *m, struct pid_namespace *ns,
+				struct pid *pid, struct task_struct *task)
+{
+	return do_io_latency(task, m, 1);
+}
+#endif /* CONFIG_TASK_IO_LATENCY */
+
 #ifdef CONFIG_USER_NS
 static int proc_id_map_open(struct inode *inode, struct file *file,
 	const struct seq_operations *seq_ops)
@@ -2886,6 +2944,9 @@ static const struct pid_entry tgid_base_stuff[] = {
 #ifdef CONFIG_TASK_IO_ACCOUNTING
 	ONE("io",	S_IRUSR, proc_tgid_io_accounting),
 #endif
+#ifdef CONFIG_TASK_IO_LATENCY
+	ONE("io_latency", S_IRUSR, proc_tgid_io_latency),
+#endif
 #ifdef CONFIG_HARDWALL
 	ONE("hardwall",   S_IRUGO, proc_pid_hardwall),
 #endif
@@ -3275,6 +3336,9 @@ static const struct pid_entry tid_base_stuff[] = {
 #ifdef CONFIG_TASK_IO_ACCOUNTING
 	ONE("io",	S_IRUSR, proc_tid_io_accounting),
 #endif
+#ifdef CONFIG_TASK_IO_LATENCY
+	ONE("io_latency", S_IRUSR, proc_tid_io_latency),
+#endif
 #ifdef CONFIG_HARDWALL
 	ONE("hardwall",   S_IRUGO, proc_pid_hardwall),
 #endif
@@ -1438,6 +1438,17 @@ cont:
 		if (!page)
 			continue;
 
+		/*
+		 * A page referenced since the last pass is part of the working
+		 * set: clear the access bit and only take it next time round
+		 * if it stays untouched until then.
+		 */
+		if (rp->skip_young &&
+		    ptep_test_and_clear_young(vma, addr, pte)) {
+			rp->nr_young++;
+			continue;
+		}
+
 		if (isolate_lru_page(page))
 			continue;
 
@@ -1480,6 +1491,8 @@ struct reclaim_param reclaim_task_anon(struct task_struct *task,
 
 	rp.nr_reclaimed = 0;
 	rp.nr_scanned = 0;
+	rp.skip_young = true;
+	rp.nr_young = 0;
 	get_task_struct(task);
 	mm = get_task_mm(task);
 	if (!mm)
@@ -1512,6 +1525,13 @@ struct reclaim_param reclaim_task_anon(struct task_struct *task,
 
 	flush_tlb_mm(mm);
 	up_read(&mm->mmap_sem);
+
+	if (rp.nr_young + rp.nr_scanned) {
+		int hot_pct = (rp.nr_young * 100) /
+				(rp.nr_young + rp.nr_scanned);
+
+		mm->reclaim_hot_pct = (mm->reclaim_hot_pct + hot_pct) / 2;
+	}
 	mmput(mm);
 out:
 	put_task_struct(task);
@@ -1594,6 +1614,9 @@ static ssize_t reclaim_write(struct file *file, const char __user *buf,
 
 	rp.nr_to_reclaim = ~0;
 	rp.nr_reclaimed = 0;
+	rp.nr_scanned = 0;
+	rp.skip_young = false;
+	rp.nr_young = 0;
 	reclaim_walk.private = &rp;
 
 	down_read(&mm->mmap_sem);
@@ -67,6 +67,13 @@ void get_derived_permission_new(struct dentry *parent, struct dentry *dentry,
 	struct qstr q_media = QSTR_LITERAL("media");
 	struct qstr q_cache = QSTR_LITERAL("cache");
 
+	/*
+	 * Sample the generation before deriving, so a packagelist update
+	 * racing with us leaves the dentry looking stale rather than current.
+	 */
+	if (SDCARDFS_D(dentry))
+		SDCARDFS_D(dentry)->perm_gen = get_packagelist_gen();
+
 	/* By default, each inode inherits from its parent.
 	 * the properties are maintained on its private fields
 	 * because the inode attributes will be modified with that of
@@ -150,6 +157,13 @@ void get_derived_permission(struct dentry *parent, struct dentry *dentry)
 	get_derived_permission_new(parent, dentry, &dentry->d_name);
 }
 
+/* true if @dentry's derived state was computed against the current packagelist */
+bool derived_permission_is_current(struct dentry *dentry)
+{
+	return SDCARDFS_D(dentry) &&
+		SDCARDFS_D(dentry)->perm_gen == get_packagelist_gen();
+}
+
 static appid_t get_type(const char *name)
 {
 	const char *ext = strrchr(name, '.');
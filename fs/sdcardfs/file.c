@@ -173,7 +173,6 @@ static int sdcardfs_mmap(struct file *file, struct vm_area_struct *vma)
 	int err = 0;
 	bool willwrite;
 	struct file *lower_file;
-	const struct vm_operations_struct *saved_vm_ops = NULL;
 
 	/* this might be deferred to mmap's writepage */
 	willwrite = ((vma->vm_flags | VM_SHARED | VM_WRITE) == vma->vm_flags);
@@ -196,32 +195,21 @@ static int sdcardfs_mmap(struct file *file, struct vm_area_struct *vma)
 	}
 
 	/*
-	 * find and save lower vm_ops.
-	 *
-	 * XXX: the VFS should have a cleaner way of finding the lower vm_ops
+	 * Hand the vma over to the lower file entirely: it maps the lower
+	 * page cache with the lower vm_ops, so faults and page_mkwrite go
+	 * straight to the lower filesystem.  The caller keeps its own
+	 * reference on @file for the rest of mmap_region().
 	 */
-	if (!SDCARDFS_F(file)->lower_vm_ops) {
-		err = lower_file->f_op->mmap(lower_file, vma);
-		if (err) {
-			pr_err("sdcardfs: lower mmap failed %d\n", err);
-			goto out;
-		}
-		saved_vm_ops = vma->vm_ops; /* save: came from lower ->mmap */
+	vma->vm_file = get_file(lower_file);
+	err = lower_file->f_op->mmap(lower_file, vma);
+	if (err) {
+		pr_err("sdcardfs: lower mmap failed %d\n", err);
+		vma->vm_file = file;
+		fput(lower_file);
+		goto out;
 	}
-
-	/*
-	 * Next 3 lines are all I need from generic_file_mmap.  I definitely
-	 * don't want its test for ->readpage which returns -ENOEXEC.
-	 */
+	fput(file);
 	file_accessed(file);
-	vma->vm_ops = &sdcardfs_vm_ops;
-
-	file->f_mapping->a_ops = &sdcardfs_aops; /* set our aops */
-	if (!SDCARDFS_F(file)->lower_vm_ops) /* save for our ->fault */
-		SDCARDFS_F(file)->lower_vm_ops = saved_vm_ops;
-	vma->vm_private_data = file;
-	get_file(lower_file);
-	vma->vm_file = lower_file;
 
 out:
 	return err;
@@ -275,6 +263,13 @@ static int sdcardfs_open(struct inode *inode, struct file *file)
 		}
 	} else {
 		sdcardfs_set_lower_file(file, lower_file);
+		/*
+		 * Our inode never caches pages itself; point the file at the
+		 * lower mapping so that fadvise, readahead and sync_file_range
+		 * act on the page cache that actually holds the data.
+		 */
+		if (S_ISREG(inode->i_mode))
+			file->f_mapping = lower_file->f_mapping;
 	}
 
 	if (err)
@@ -295,10 +290,8 @@ static int sdcardfs_flush(struct file *file, fl_owner_t id)
 	struct file *lower_file = NULL;
 
 	lower_file = sdcardfs_lower_file(file);
-	if (lower_file && lower_file->f_op && lower_file->f_op->flush) {
-		filemap_write_and_wait(file->f_mapping);
+	if (lower_file && lower_file->f_op && lower_file->f_op->flush)
 		err = lower_file->f_op->flush(lower_file, id);
-	}
 
 	return err;
 }
@@ -326,15 +319,11 @@ static int sdcardfs_fsync(struct file *file, loff_t start, loff_t end,
 	struct path lower_path;
 	struct dentry *dentry = file->f_path.dentry;
 
-	err = __generic_file_fsync(file, start, end, datasync);
-	if (err)
-		goto out;
-
+	/* all data and metadata live in the lower file */
 	lower_file = sdcardfs_lower_file(file);
 	sdcardfs_get_lower_path(dentry, &lower_path);
 	err = vfs_fsync_range(lower_file, start, end, datasync);
 	sdcardfs_put_lower_path(dentry, &lower_path);
-out:
 	return err;
 }
 
@@ -36,6 +36,7 @@ struct hashtable_entry {
 	struct hlist_node dlist; /* for deletion cleanup */
 	struct qstr key;
 	atomic_t value;
+	struct rcu_head rcu;
 };
 
 static DEFINE_HASHTABLE(package_to_appid, 8);
@@ -45,6 +46,23 @@ static DEFINE_HASHTABLE(ext_to_groupid, 8);
 
 static struct kmem_cache *hashtable_entry_cachep;
 
+/*
+ * Bumped on every change to the tables above. Dentries remember the value
+ * their derived permissions were computed against, so lookups can tell
+ * whether they are still current without deriving them again.
+ */
+static atomic_t packagelist_gen = ATOMIC_INIT(1);
+
+unsigned int get_packagelist_gen(void)
+{
+	return atomic_read(&packagelist_gen);
+}
+
+static inline void packagelist_changed(void)
+{
+	atomic_inc(&packagelist_gen);
+}
+
 static unsigned int full_name_case_hash(const unsigned char *name, unsigned int len)
 {
 	unsigned long hash = init_name_hash();
@@ -296,8 +314,10 @@ static int insert_packagelist_entry(const struct qstr *key, appid_t value)
 
 	mutex_lock(&sdcardfs_super_list_lock);
 	err = insert_packagelist_appid_entry_locked(key, value);
-	if (!err)
+	if (!err) {
+		packagelist_changed();
 		fixup_all_perms_name(key);
+	}
 	mutex_unlock(&sdcardfs_super_list_lock);
 
 	return err;
@@ -309,6 +329,8 @@ static int insert_ext_gid_entry(const struct qstr *key, appid_t value)
 
 	mutex_lock(&sdcardfs_super_list_lock);
 	err = insert_ext_gid_entry_locked(key, value);
+	if (!err)
+		packagelist_changed();
 	mutex_unlock(&sdcardfs_super_list_lock);
 
 	return err;
@@ -320,8 +342,10 @@ static int insert_userid_exclude_entry(const struct qstr *key, userid_t value)
 
 	mutex_lock(&sdcardfs_super_list_lock);
 	err = insert_userid_exclude_entry_locked(key, value);
-	if (!err)
+	if (!err) {
+		packagelist_changed();
 		fixup_all_perms_name_userid(key, value);
+	}
 	mutex_unlock(&sdcardfs_super_list_lock);
 
 	return err;
@@ -333,6 +357,11 @@ static void free_hashtable_entry(struct hashtable_entry *entry)
 	kmem_cache_free(hashtable_entry_cachep, entry);
 }
 
+static void free_hashtable_entry_rcu(struct rcu_head *head)
+{
+	free_hashtable_entry(container_of(head, struct hashtable_entry, rcu));
+}
+
 static void remove_packagelist_entry_locked(const struct qstr *key)
 {
 	struct hashtable_entry *hash_cur;
@@ -353,15 +382,15 @@ static void remove_packagelist_entry_locked(const struct qstr *key)
 			break;
 		}
 	}
-	synchronize_rcu();
 	hlist_for_each_entry_safe(hash_cur, h_t, &free_list, dlist)
-		free_hashtable_entry(hash_cur);
+		call_rcu(&hash_cur->rcu, free_hashtable_entry_rcu);
 }
 
 static void remove_packagelist_entry(const struct qstr *key)
 {
 	mutex_lock(&sdcardfs_super_list_lock);
 	remove_packagelist_entry_locked(key);
+	packagelist_changed();
 	fixup_all_perms_name(key);
 	mutex_unlock(&sdcardfs_super_list_lock);
 }
@@ -374,8 +403,7 @@ static void remove_ext_gid_entry_locked(const struct qstr *key, gid_t group)
 	hash_for_each_possible_rcu(ext_to_groupid, hash_cur, hlist, hash) {
 		if (qstr_case_eq(key, &hash_cur->key) && atomic_read(&hash_cur->value) == group) {
 			hash_del_rcu(&hash_cur->hlist);
-			synchronize_rcu();
-			free_hashtable_entry(hash_cur);
+			call_rcu(&hash_cur->rcu, free_hashtable_entry_rcu);
 			break;
 		}
 	}
@@ -385,6 +413,7 @@ static void remove_ext_gid_entry(const struct qstr *key, gid_t group)
 {
 	mutex_lock(&sdcardfs_super_list_lock);
 	remove_ext_gid_entry_locked(key, group);
+	packagelist_changed();
 	mutex_unlock(&sdcardfs_super_list_lock);
 }
 
@@ -401,16 +430,15 @@ static void remove_userid_all_entry_locked(userid_t userid)
 			hlist_add_head(&hash_cur->dlist, &free_list);
 		}
 	}
-	synchronize_rcu();
-	hlist_for_each_entry_safe(hash_cur, h_t, &free_list, dlist) {
-		free_hashtable_entry(hash_cur);
-	}
+	hlist_for_each_entry_safe(hash_cur, h_t, &free_list, dlist)
+		call_rcu(&hash_cur->rcu, free_hashtable_entry_rcu);
 }
 
 static void remove_userid_all_entry(userid_t userid)
 {
 	mutex_lock(&sdcardfs_super_list_lock);
 	remove_userid_all_entry_locked(userid);
+	packagelist_changed();
 	fixup_all_perms_userid(userid);
 	mutex_unlock(&sdcardfs_super_list_lock);
 }
@@ -424,8 +452,7 @@ static void remove_userid_exclude_entry_locked(const struct qstr *key, userid_t
 		if (qstr_case_eq(key, &hash_cur->key) &&
 				atomic_read(&hash_cur->value) == userid) {
 			hash_del_rcu(&hash_cur->hlist);
-			synchronize_rcu();
-			free_hashtable_entry(hash_cur);
+			call_rcu(&hash_cur->rcu, free_hashtable_entry_rcu);
 			break;
 		}
 	}
@@ -435,6 +462,7 @@ static void remove_userid_exclude_entry(const struct qstr *key, userid_t userid)
 {
 	mutex_lock(&sdcardfs_super_list_lock);
 	remove_userid_exclude_entry_locked(key, userid);
+	packagelist_changed();
 	fixup_all_perms_name_userid(key, userid);
 	mutex_unlock(&sdcardfs_super_list_lock);
 }
@@ -882,5 +910,7 @@ void packagelist_exit(void)
 {
 	configfs_sdcardfs_exit();
 	packagelist_destroy();
+	/* wait for entries still queued by call_rcu() */
+	rcu_barrier();
 	kmem_cache_destroy(hashtable_entry_cachep);
 }
@@ -136,7 +136,6 @@ extern const struct inode_operations sdcardfs_symlink_iops;
 extern const struct super_operations sdcardfs_sops;
 extern const struct dentry_operations sdcardfs_ci_dops;
 extern const struct address_space_operations sdcardfs_aops, sdcardfs_dummy_aops;
-extern const struct vm_operations_struct sdcardfs_vm_ops;
 
 extern int sdcardfs_init_inode_cache(void);
 extern void sdcardfs_destroy_inode_cache(void);
@@ -154,7 +153,6 @@ extern int sdcardfs_interpose(struct dentry *dentry, struct super_block *sb,
 /* file private data */
 struct sdcardfs_file_info {
 	struct file *lower_file;
-	const struct vm_operations_struct *lower_vm_ops;
 };
 
 struct sdcardfs_inode_data {
@@ -188,6 +186,7 @@ struct sdcardfs_dentry_info {
 	spinlock_t lock;	/* protects lower_path */
 	struct path lower_path;
 	struct path orig_path;
+	unsigned int perm_gen;	/* packagelist gen of the derived perms */
 };
 
 struct sdcardfs_mount_options {
@@ -490,6 +489,7 @@ extern struct list_head sdcardfs_super_list;
 extern appid_t get_appid(const char *app_name);
 extern appid_t get_ext_gid(const char *app_name);
 extern appid_t is_excluded(const char *app_name, userid_t userid);
+extern unsigned int get_packagelist_gen(void);
 extern int check_caller_access_to_name(struct inode *parent_node, const struct qstr *name);
 extern int packagelist_init(void);
 extern void packagelist_exit(void);
@@ -506,6 +506,7 @@ struct limit_search {
 extern void setup_derived_state(struct inode *inode, perm_t perm,
 			userid_t userid, uid_t uid);
 extern void get_derived_permission(struct dentry *parent, struct dentry *dentry);
+extern bool derived_permission_is_current(struct dentry *dentry);
 extern void get_derived_permission_new(struct dentry *parent, struct dentry *dentry, const struct qstr *name);
 extern void fixup_perms_recursive(struct dentry *dentry, struct limit_search *limit);
 
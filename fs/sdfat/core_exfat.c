@@ -1126,19 +1126,36 @@ void free_alloc_bmp(struct super_block *sb)
  * If the value of "clu" is 0, it means cluster 2 which is
  * the first cluster of cluster heap.
  */
-static s32 set_alloc_bitmap(struct super_block *sb, u32 clu)
+static s32 set_alloc_bitmap(struct super_block *sb, u32 clu, u32 max)
 {
-	s32 i, b;
+	u32 i, b, end, run;
 	u64 sector;
+	unsigned long *map;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
 	i = clu >> (sb->s_blocksize_bits + 3);
 	b = clu & (u32)((sb->s_blocksize << 3) - 1);
 
+	/*
+	 * Take the whole run of free clusters following @clu, up to @max,
+	 * that lives in this bitmap sector, so a large allocation dirties
+	 * each bitmap buffer once instead of once per cluster.
+	 */
+	end = b + min(max, fsi->num_clusters - CLUS_BASE - clu);
+	end = min(end, (u32)(sb->s_blocksize << 3));
+
+	map = (unsigned long *)(fsi->vol_amap[i]->b_data);
+	run = find_next_bit(map, end, b) - b;
+	if (WARN_ON(!run))
+		return -EIO;
+
 	sector = CLUS_TO_SECT(fsi, fsi->map_clu) + i;
-	bitmap_set((unsigned long *)(fsi->vol_amap[i]->b_data), b, 1);
+	bitmap_set(map, b, run);
+
+	if (write_sect(sb, sector, fsi->vol_amap[i], 0))
+		return -EIO;
 
-	return write_sect(sb, sector, fsi->vol_amap[i], 0);
+	return (s32)run;
 } /* end of set_alloc_bitmap */
 
 /* WARN :
@@ -1337,6 +1354,7 @@ static s32 exfat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p
 	s32 ret = -ENOSPC;
 	u32 num_clusters = 0, total_cnt;
 	u32 hint_clu, new_clu, last_clu = CLUS_EOF;
+	s32 run;
 	FS_INFO_T *fsi = &(SDFAT_SB(sb)->fsi);
 
 	total_cnt = fsi->num_clusters - CLUS_BASE;
@@ -1392,32 +1410,38 @@ static s32 exfat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p
 		}
 
 		/* update allocation bitmap */
-		if (set_alloc_bitmap(sb, new_clu - CLUS_BASE)) {
+		run = set_alloc_bitmap(sb, new_clu - CLUS_BASE, num_alloc);
+		if (run < 0) {
 			ret = -EIO;
 			goto error;
 		}
 
-		num_clusters++;
+		num_clusters += run;
+		num_alloc -= run;
+
+		if (IS_CLUS_EOF(p_chain->dir))
+			p_chain->dir = new_clu;
 
 		/* update FAT table */
-		if (p_chain->flags == 0x01) {
+		for (; p_chain->flags == 0x01 && run > 0; run--, new_clu++) {
 			if (fat_ent_set(sb, new_clu, CLUS_EOF)) {
 				ret = -EIO;
 				goto error;
 			}
-		}
 
-		if (IS_CLUS_EOF(p_chain->dir)) {
-			p_chain->dir = new_clu;
-		} else if (p_chain->flags == 0x01) {
-			if (fat_ent_set(sb, last_clu, new_clu)) {
-				ret = -EIO;
-				goto error;
+			if (!IS_CLUS_EOF(last_clu)) {
+				if (fat_ent_set(sb, last_clu, new_clu)) {
+					ret = -EIO;
+					goto error;
+				}
 			}
+			last_clu = new_clu;
 		}
-		last_clu = new_clu;
+		/* new_clu points one past the run from here on */
+		new_clu += run;
+		last_clu = new_clu - 1;
 
-		if ((--num_alloc) == 0) {
+		if (num_alloc == 0) {
 			fsi->clu_srch_ptr = hint_clu;
 			fsi->used_clusters += num_clusters;
 
@@ -1425,7 +1449,7 @@ static s32 exfat_alloc_cluster(struct super_block *sb, u32 num_alloc, CHAIN_T *p
 			return 0;
 		}
 
-		hint_clu = new_clu + 1;
+		hint_clu = new_clu;
 		if (hint_clu >= fsi->num_clusters) {
 			hint_clu = CLUS_BASE;
 
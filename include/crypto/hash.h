@@ -72,6 +72,9 @@ struct shash_alg {
 		     unsigned int len, u8 *out);
 	int (*digest)(struct shash_desc *desc, const u8 *data,
 		      unsigned int len, u8 *out);
+	int (*finup2x)(struct shash_desc *desc, const u8 *data1,
+		       const u8 *data2, unsigned int len, u8 *out1,
+		       u8 *out2);
 	int (*export)(struct shash_desc *desc, void *out);
 	int (*import)(struct shash_desc *desc, const void *in);
 	int (*setkey)(struct crypto_shash *tfm, const u8 *key,
@@ -362,4 +365,18 @@ int crypto_shash_final(struct shash_desc *desc, u8 *out);
 int crypto_shash_finup(struct shash_desc *desc, const u8 *data,
 		       unsigned int len, u8 *out);
 
+/*
+ * Finish two messages of the same length that share the state in desc,
+ * e.g. a salted prefix, interleaving their processing where the
+ * implementation supports it.
+ */
+static inline bool crypto_shash_has_finup2x(struct crypto_shash *tfm)
+{
+	return crypto_shash_alg(tfm)->finup2x != NULL;
+}
+
+int crypto_shash_finup2x(struct shash_desc *desc, const u8 *data1,
+			 const u8 *data2, unsigned int len, u8 *out1,
+			 u8 *out2);
+
 #endif	/* _CRYPTO_HASH_H */
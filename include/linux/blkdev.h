@@ -168,6 +168,11 @@ struct request {
 	struct request_list *rl;		/* rl this rq is alloced from */
 	unsigned long long start_time_ns;
 	unsigned long long io_start_time_ns;    /* when passed to hardware */
+#endif
+#ifdef CONFIG_TASK_IO_LATENCY
+	struct task_struct *io_lat_task;	/* submitter, holds a reference */
+	u64 io_lat_queue_ns;			/* when created from a bio */
+	u64 io_lat_issue_ns;			/* when handed to the driver */
 #endif
 	/* Number of scatter-gather DMA addr+len pairs after
 	 * physical address coalescing is performed.
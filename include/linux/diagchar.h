@@ -68,6 +68,33 @@
 #define DIAG_IOCTL_HDLC_TOGGLE	38
 #define DIAG_IOCTL_QUERY_CON_ALL	40
 
+/*
+ * Memory device mode log ring, created by mmap() of /dev/diag at offset 0
+ * by the process that owns the memory device session. Once mapped, local
+ * log data is appended here instead of being queued for read(). The
+ * kernel advances head; the logging daemon consumes records from tail,
+ * stores the new tail and waits for more with poll(). Each record is a
+ * struct diag_md_ring_rec followed by len bytes of data, padded to
+ * DIAG_MD_RING_ALIGN. A record with DIAG_MD_RING_REC_WRAP set carries no
+ * data and means the next record is at offset 0.
+ */
+#define DIAG_MD_RING_ALIGN	8
+#define DIAG_MD_RING_REC_WRAP	0x1
+
+struct diag_md_ring {
+	uint32_t head;
+	uint32_t tail;
+	uint32_t size;
+	uint32_t dropped;
+	uint32_t reserved[4];
+	uint8_t data[0];
+};
+
+struct diag_md_ring_rec {
+	uint32_t len;
+	uint32_t flags;
+};
+
 /* PC Tools IDs */
 #define APQ8060_TOOLS_ID	4062
 #define AO8960_TOOLS_ID		4064
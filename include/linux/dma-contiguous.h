@@ -113,6 +113,8 @@ static inline int dma_declare_contiguous(struct device *dev, phys_addr_t size,
 
 struct page *dma_alloc_from_contiguous(struct device *dev, size_t count,
 				       unsigned int order);
+int dma_prepare_contiguous(struct device *dev, size_t count,
+			   unsigned int align);
 bool dma_release_from_contiguous(struct device *dev, struct page *pages,
 				 int count);
 
@@ -150,6 +152,13 @@ struct page *dma_alloc_from_contiguous(struct device *dev, size_t count,
 	return NULL;
 }
 
+static inline
+int dma_prepare_contiguous(struct device *dev, size_t count,
+			   unsigned int align)
+{
+	return -ENOSYS;
+}
+
 static inline
 bool dma_release_from_contiguous(struct device *dev, struct page *pages,
 				 int count)
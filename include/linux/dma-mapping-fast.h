@@ -16,6 +16,26 @@
 #include <linux/iommu.h>
 #include <linux/io-pgtable-fast.h>
 
+#define FAST_IOVA_MAG_SIZE	32
+
+/* A stack of single page IOVAs, all unmapped before @gen was sampled */
+struct fast_iova_mag {
+	unsigned int	nr;
+	unsigned int	gen;
+	dma_addr_t	iova[FAST_IOVA_MAG_SIZE];
+};
+
+/*
+ * Per-cpu cache of freed single page IOVAs. @clean holds IOVAs whose
+ * TLB entries are known to be invalidated and that can be handed out
+ * again right away, @dirty collects IOVAs freed since.
+ */
+struct fast_iova_cache {
+	struct fast_iova_mag	*clean;
+	struct fast_iova_mag	*dirty;
+	struct fast_iova_mag	mags[2];
+};
+
 struct dma_fast_smmu_mapping {
 	struct device		*dev;
 	struct iommu_domain	*domain;
@@ -28,6 +48,9 @@ struct dma_fast_smmu_mapping {
 	unsigned long	next_start;
 	unsigned long	upcoming_stale_bit;
 	bool		have_stale_tlbs;
+	unsigned int	tlb_gen;
+
+	struct fast_iova_cache __percpu *iova_cache;
 
 	dma_addr_t	pgtbl_dma_handle;
 	av8l_fast_iopte	*pgtbl_pmds;
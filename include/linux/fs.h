@@ -421,6 +421,7 @@ struct address_space {
 	unsigned long		nrpages;	/* number of total pages */
 	unsigned long		nrshadows;	/* number of shadow entries */
 	pgoff_t			writeback_index;/* writeback starts here */
+	unsigned long		nr_ra_wasted;	/* readahead marks reclaimed unread */
 	const struct address_space_operations *a_ops;	/* methods */
 	unsigned long		flags;		/* error bits/gfp mask */
 	struct backing_dev_info *backing_dev_info; /* device readahead, etc */
@@ -816,6 +817,8 @@ struct file_ra_state {
 
 	unsigned int ra_pages;		/* Maximum readahead window */
 	unsigned int mmap_miss;		/* Cache miss stat for mmap accesses */
+	unsigned int wasted;		/* mapping->nr_ra_wasted last seen */
+	unsigned int shrink;		/* window is ra_pages >> shrink */
 	loff_t prev_pos;		/* Cache last read() position */
 };
 
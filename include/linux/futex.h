@@ -85,4 +85,20 @@ static inline void futex_exit_recursive(struct task_struct *tsk) { }
 static inline void futex_exit_release(struct task_struct *tsk) { }
 static inline void futex_exec_release(struct task_struct *tsk) { }
 #endif
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+static inline void futex_mm_init(struct mm_struct *mm)
+{
+	mm->futex_hash = NULL;
+	mm->futex_hash_mask = 0;
+}
+
+void futex_mm_clone(struct mm_struct *mm, unsigned long clone_flags);
+void futex_mm_release(struct mm_struct *mm);
+#else
+static inline void futex_mm_init(struct mm_struct *mm) { }
+static inline void futex_mm_clone(struct mm_struct *mm,
+				  unsigned long clone_flags) { }
+static inline void futex_mm_release(struct mm_struct *mm) { }
+#endif
 #endif
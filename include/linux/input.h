@@ -117,6 +117,9 @@ struct input_value {
  * @vals: array of values queued in the current frame
  * @devres_managed: indicates that devices is managed with devres framework
  *	and needs not be explicitly unregistered or freed.
+ * @timestamp: CLOCK_MONOTONIC time the current frame was captured, as set
+ *	by input_set_timestamp(); zero means "use the time of delivery".
+ *	Reset after every SYN_REPORT.
  */
 struct input_dev {
 	const char *name;
@@ -187,6 +190,8 @@ struct input_dev {
 	struct input_value *vals;
 
 	bool devres_managed;
+
+	ktime_t timestamp;
 };
 #define to_input_dev(d) container_of(d, struct input_dev, dev)
 
@@ -421,6 +426,9 @@ static inline void input_mt_sync(struct input_dev *dev)
 
 void input_set_capability(struct input_dev *dev, unsigned int type, unsigned int code);
 
+void input_set_timestamp(struct input_dev *dev, ktime_t timestamp);
+ktime_t input_get_timestamp(struct input_dev *dev);
+
 /**
  * input_set_events_per_packet - tell handlers about the driver event rate
  * @dev: the input device used by the driver
@@ -97,10 +97,14 @@ enum ipa_aggr_mode {
  * invoked for on data path
  * @IPA_RECEIVE: data is struct sk_buff
  * @IPA_WRITE_DONE: data is struct sk_buff
+ * @IPA_CLIENT_START_POLL: NAPI pipe has data, schedule the poll; no data
+ * @IPA_CLIENT_COMP_NAPI: NAPI pipe is drained, complete the poll; no data
  */
 enum ipa_dp_evt_type {
 	IPA_RECEIVE,
 	IPA_WRITE_DONE,
+	IPA_CLIENT_START_POLL,
+	IPA_CLIENT_COMP_NAPI,
 };
 
 /**
@@ -610,6 +614,8 @@ struct ipa_ext_intf {
  * @skip_ep_cfg: boolean field that determines if EP should be configured
  *  by IPA driver
  * @keep_ipa_awake: when true, IPA will not be clock gated
+ * @napi_enabled: when true, a consumer pipe is polled by the client's NAPI
+ *  handler through ipa3_rx_poll() instead of by the IPA workqueue
  */
 struct ipa_sys_connect_params {
 	struct ipa_ep_cfg ipa_ep_cfg;
@@ -619,6 +625,7 @@ struct ipa_sys_connect_params {
 	ipa_notify_cb notify;
 	bool skip_ep_cfg;
 	bool keep_ipa_awake;
+	bool napi_enabled;
 };
 
 /**
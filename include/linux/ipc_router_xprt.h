@@ -150,6 +150,8 @@ struct msm_ipc_router_xprt {
 void msm_ipc_router_xprt_notify(struct msm_ipc_router_xprt *xprt,
 				unsigned event,
 				void *data);
+void msm_ipc_router_xprt_rx_pkt(struct msm_ipc_router_xprt *xprt,
+				struct rr_packet *pkt);
 
 /**
  * create_pkt() - Create a Router packet
@@ -21,14 +21,32 @@ int ksm_madvise(struct vm_area_struct *vma, unsigned long start,
 		unsigned long end, int advice, unsigned long *vm_flags);
 int __ksm_enter(struct mm_struct *mm);
 void __ksm_exit(struct mm_struct *mm);
+int ksm_enable_merge_any(struct mm_struct *mm);
+unsigned long __ksm_vma_flags(unsigned long vm_flags);
 
 static inline int ksm_fork(struct mm_struct *mm, struct mm_struct *oldmm)
 {
-	if (test_bit(MMF_VM_MERGEABLE, &oldmm->flags))
+	if (test_bit(MMF_VM_MERGEABLE, &oldmm->flags)) {
+		if (test_bit(MMF_VM_MERGE_ANY, &oldmm->flags))
+			set_bit(MMF_VM_MERGE_ANY, &mm->flags);
 		return __ksm_enter(mm);
+	}
 	return 0;
 }
 
+/*
+ * New anonymous private vmas of an mm that was made mergeable as a whole
+ * (see ksm_enable_merge_any) start out VM_MERGEABLE, so that they can
+ * still be merged with their mergeable neighbours.
+ */
+static inline unsigned long ksm_vma_flags(struct mm_struct *mm,
+		struct file *file, unsigned long vm_flags)
+{
+	if (!file && test_bit(MMF_VM_MERGE_ANY, &mm->flags))
+		return __ksm_vma_flags(vm_flags);
+	return vm_flags;
+}
+
 static inline void ksm_exit(struct mm_struct *mm)
 {
 	if (test_bit(MMF_VM_MERGEABLE, &mm->flags))
@@ -87,6 +105,12 @@ static inline void ksm_exit(struct mm_struct *mm)
 {
 }
 
+static inline unsigned long ksm_vma_flags(struct mm_struct *mm,
+		struct file *file, unsigned long vm_flags)
+{
+	return vm_flags;
+}
+
 static inline int PageKsm(struct page *page)
 {
 	return 0;
@@ -170,6 +170,9 @@ static inline void mem_cgroup_count_vm_event(struct mm_struct *mm,
 		return;
 	__mem_cgroup_count_vm_event(mm, idx);
 }
+
+void mem_cgroup_workingset_refault(struct page *page, bool activate);
+bool mem_cgroup_refault_protected(struct page *page);
 #ifdef CONFIG_TRANSPARENT_HUGEPAGE
 void mem_cgroup_split_huge_fixup(struct page *head);
 #endif
@@ -345,6 +348,16 @@ static inline
 void mem_cgroup_count_vm_event(struct mm_struct *mm, enum vm_event_item idx)
 {
 }
+
+static inline void mem_cgroup_workingset_refault(struct page *page,
+						 bool activate)
+{
+}
+
+static inline bool mem_cgroup_refault_protected(struct page *page)
+{
+	return false;
+}
 #endif /* CONFIG_MEMCG */
 
 #if !defined(CONFIG_MEMCG) || !defined(CONFIG_DEBUG_VM)
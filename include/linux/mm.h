@@ -2220,6 +2220,10 @@ struct reclaim_param {
 	int nr_to_reclaim;
 	/* pages reclaimed */
 	int nr_reclaimed;
+	/* leave pages referenced since the last pass alone and age them */
+	bool skip_young;
+	/* referenced pages skipped */
+	int nr_young;
 };
 extern struct reclaim_param reclaim_task_anon(struct task_struct *task,
 		int nr_to_reclaim);
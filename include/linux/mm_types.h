@@ -318,6 +318,9 @@ struct vm_area_struct {
 	struct file * vm_file;		/* File we map to (can be NULL). */
 	void * vm_private_data;		/* was vm_pte (shared mem) */
 
+#ifdef CONFIG_SWAP
+	atomic_long_t swap_readahead_info; /* last fault, window and hits */
+#endif
 #ifndef CONFIG_MMU
 	struct vm_region *vm_region;	/* NOMMU mapping region */
 #endif
@@ -442,6 +445,11 @@ struct mm_struct {
 #ifdef CONFIG_MMU_NOTIFIER
 	struct mmu_notifier_mm *mmu_notifier_mm;
 #endif
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+	/* see futex_mm_clone() */
+	struct futex_hash_bucket *futex_hash;
+	unsigned int futex_hash_mask;
+#endif
 #if defined(CONFIG_TRANSPARENT_HUGEPAGE) && !USE_SPLIT_PMD_PTLOCKS
 	pgtable_t pmd_huge_pte; /* protected by page_table_lock */
 #endif
@@ -474,6 +482,10 @@ struct mm_struct {
 #ifdef CONFIG_MSM_APP_SETTINGS
 	int app_setting;
 #endif
+#ifdef CONFIG_PROCESS_RECLAIM
+	/* Percentage of anon pages process reclaim found referenced */
+	int reclaim_hot_pct;
+#endif
 
 	struct work_struct async_put_work;
 };
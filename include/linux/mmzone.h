@@ -265,6 +265,22 @@ enum zone_watermarks {
 #define low_wmark_pages(z) (z->watermark[WMARK_LOW])
 #define high_wmark_pages(z) (z->watermark[WMARK_HIGH])
 
+/*
+ * Highest order cached on the per-cpu lists.  Besides single pages, ION,
+ * the GPU page pools and the network stack mostly allocate order-1 to
+ * order-4 blocks.
+ */
+#define PCP_MAX_ORDER		4
+
+struct per_cpu_pages_order {
+	int count;		/* number of blocks in the list */
+	int high;		/* high watermark, emptying needed */
+	int batch;		/* chunk size for buddy add/remove */
+
+	/* Lists of blocks, one per migrate type stored on the pcp-lists */
+	struct list_head lists[MIGRATE_PCPTYPES];
+};
+
 struct per_cpu_pages {
 	int count;		/* number of pages in the list */
 	int high;		/* high watermark, emptying needed */
@@ -272,6 +288,9 @@ struct per_cpu_pages {
 
 	/* Lists of pages, one per migrate type stored on the pcp-lists */
 	struct list_head lists[MIGRATE_PCPTYPES];
+
+	/* Order-1 to PCP_MAX_ORDER blocks, indexed by order - 1 */
+	struct per_cpu_pages_order orders[PCP_MAX_ORDER];
 };
 
 struct per_cpu_pageset {
@@ -1007,6 +1007,32 @@ int sps_register_event(struct sps_pipe *h, struct sps_register_event *reg);
 int sps_transfer_one(struct sps_pipe *h, phys_addr_t addr, u32 size,
 		     void *user, u32 flags);
 
+/**
+ * Queue a batch of DMA transfers on an SPS connection end point
+ *
+ * This function queues count independent descriptors on a system-mode
+ * pipe under a single lock and rings the pipe doorbell once. Unlike
+ * sps_transfer(), every descriptor keeps its own flags and user pointer,
+ * so a client can recycle a pool of pre-mapped buffers in one call.
+ * The batch is rejected as a whole if there are not enough free
+ * descriptors or any descriptor cannot be queued; on error none of the
+ * descriptors is handed to the hardware.
+ *
+ * @h - client context for SPS connection end point
+ *
+ * @iovec - array of count I/O vectors; upper address bits are passed in
+ * the flags as for sps_transfer()
+ *
+ * @user - array of count user pointers, or NULL
+ *
+ * @count - number of descriptors
+ *
+ * @return 0 on success, negative value on error
+ *
+ */
+int sps_transfer_batch(struct sps_pipe *h, struct sps_iovec *iovec,
+		       void **user, u32 count);
+
 /**
  * Read event queue for an SPS connection end point
  *
@@ -1036,6 +1062,26 @@ int sps_get_event(struct sps_pipe *h, struct sps_event_notify *event);
  */
 int sps_get_iovec(struct sps_pipe *h, struct sps_iovec *iovec);
 
+/**
+ * Get a batch of processed I/O vectors (completed transfers)
+ *
+ * This function fetches up to max processed I/O vectors under a single
+ * lock, polling the hardware once for the whole batch.
+ *
+ * @h - client context for SPS connection end point
+ *
+ * @iovec - array of at least max I/O vector structs (output)
+ *
+ * @max - maximum number of I/O vectors to fetch
+ *
+ * @count - number of I/O vectors fetched (output)
+ *
+ * @return 0 on success, negative value on error
+ *
+ */
+int sps_get_iovecs(struct sps_pipe *h, struct sps_iovec *iovec, u32 max,
+		   u32 *count);
+
 /**
  * Enable an SPS connection end point
  *
@@ -1156,6 +1202,24 @@ int sps_device_reset(unsigned long dev);
  */
 int sps_set_config(struct sps_pipe *h, struct sps_connect *config);
 
+/**
+ * Switch an SPS connection end point between interrupt and polling mode
+ *
+ * This function masks or unmasks the pipe interrupts without the full
+ * reconfiguration done by sps_set_config(), so clients can poll a pipe
+ * with sps_get_iovecs() during traffic bursts and go back to interrupts
+ * once it drains. Completions that happen while the pipe is polled are
+ * signalled when interrupts are enabled again.
+ *
+ * @h - client context for SPS connection end point
+ *
+ * @poll - true to poll the pipe, false to use interrupts
+ *
+ * @return 0 on success, negative value on error
+ *
+ */
+int sps_set_poll_mode(struct sps_pipe *h, bool poll);
+
 /**
  * Set ownership of an SPS connection end point
  *
@@ -1507,6 +1571,19 @@ static inline int sps_get_iovec(struct sps_pipe *h, struct sps_iovec *iovec)
 	return -EPERM;
 }
 
+static inline int sps_get_iovecs(struct sps_pipe *h, struct sps_iovec *iovec,
+				 u32 max, u32 *count)
+{
+	return -EPERM;
+}
+
+static inline int sps_transfer_batch(struct sps_pipe *h,
+				     struct sps_iovec *iovec, void **user,
+				     u32 count)
+{
+	return -EPERM;
+}
+
 static inline int sps_flow_on(struct sps_pipe *h)
 {
 	return -EPERM;
@@ -1538,6 +1615,11 @@ static inline int sps_set_config(struct sps_pipe *h, struct sps_connect *config)
 	return -EPERM;
 }
 
+static inline int sps_set_poll_mode(struct sps_pipe *h, bool poll)
+{
+	return -EPERM;
+}
+
 static inline int sps_set_owner(struct sps_pipe *h, enum sps_owner owner,
 		  struct sps_satellite *connect)
 {
@@ -3,6 +3,7 @@
 
 #include <linux/devfreq.h>
 #include <linux/notifier.h>
+#include <linux/atomic.h>
 
 #define ADRENO_DEVFREQ_NOTIFY_SUBMIT	1
 #define ADRENO_DEVFREQ_NOTIFY_RETIRE	2
@@ -46,6 +47,14 @@ struct devfreq_msm_adreno_tz_data {
 		unsigned int *index;
 		uint64_t *ib;
 	} bus;
+	struct {
+		atomic_t count;
+		u64 total_time;
+		u64 work;
+		u64 predicted;
+		u64 period;
+		bool enable;
+	} frame;
 	unsigned int device_id;
 	bool is_64;
 	bool disable_busy_time_burst;
@@ -13,6 +13,9 @@
 #ifndef __MSM_RTB_H__
 #define __MSM_RTB_H__
 
+#include <linux/compiler.h>
+#include <linux/types.h>
+
 /*
  * These numbers are used from the kernel command line and sysfs
  * to control filtering. Remove items from here with extreme caution.
@@ -37,16 +40,51 @@ struct msm_rtb_platform_data {
 };
 
 #if defined(CONFIG_MSM_RTB)
+extern uint32_t msm_rtb_log_mask;
+
+int __uncached_logk_pc(enum logk_event_type log_type, void *caller,
+				void *data);
+int __uncached_logk(enum logk_event_type log_type, void *data);
+
+/*
+ * Types outside CONFIG_MSM_RTB_EVENT_MASK are dropped at compile time
+ * when the type is a constant, which is the case for the readl/writel
+ * hooks. Everything else is gated on the runtime mask without a call.
+ */
+static __always_inline int msm_rtb_type_enabled(enum logk_event_type log_type)
+{
+	uint32_t bit = 1 << (log_type & ~LOGTYPE_NOPC);
+
+	if (__builtin_constant_p(log_type) &&
+	    !(bit & CONFIG_MSM_RTB_EVENT_MASK))
+		return 0;
+
+	return bit & ACCESS_ONCE(msm_rtb_log_mask);
+}
+
 /*
  * returns 1 if data was logged, 0 otherwise
  */
-int uncached_logk_pc(enum logk_event_type log_type, void *caller,
-				void *data);
+static __always_inline int uncached_logk_pc(enum logk_event_type log_type,
+					    void *caller, void *data)
+{
+	if (!msm_rtb_type_enabled(log_type))
+		return 0;
+
+	return __uncached_logk_pc(log_type, caller, data);
+}
 
 /*
  * returns 1 if data was logged, 0 otherwise
  */
-int uncached_logk(enum logk_event_type log_type, void *data);
+static __always_inline int uncached_logk(enum logk_event_type log_type,
+					 void *data)
+{
+	if (!msm_rtb_type_enabled(log_type))
+		return 0;
+
+	return __uncached_logk(log_type, data);
+}
 
 #define ETB_WAYPOINT  do { \
 				BRANCH_TO_NEXT_ISTR; \
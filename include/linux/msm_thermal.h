@@ -76,6 +76,13 @@ struct msm_thermal_data {
 	int32_t vdd_mx_temp_hyst_degC;
 	int32_t vdd_mx_sensor_id;
 	int32_t therm_reset_temp_degC;
+	uint32_t pid_sustainable_power_mw;
+	uint32_t pid_gpu_power_mw;
+	int32_t pid_k_po;
+	int32_t pid_k_pu;
+	int32_t pid_k_i;
+	int32_t pid_k_d;
+	int32_t pid_integral_cutoff_degC;
 };
 
 enum sensor_id_type {
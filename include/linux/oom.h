@@ -96,6 +96,30 @@ extern void dump_tasks(const struct mem_cgroup *memcg,
 		const nodemask_t *nodemask);
 
 /* sysctls */
+#ifdef CONFIG_ANDROID_LMK_ADJ_BUCKETS
+extern void lmk_adj_add(struct task_struct *p);
+extern void lmk_adj_del(struct task_struct *p);
+extern void lmk_adj_replace(struct task_struct *old, struct task_struct *new);
+extern void lmk_adj_update(struct task_struct *task);
+#else
+static inline void lmk_adj_add(struct task_struct *p)
+{
+}
+
+static inline void lmk_adj_del(struct task_struct *p)
+{
+}
+
+static inline void lmk_adj_replace(struct task_struct *old,
+				   struct task_struct *new)
+{
+}
+
+static inline void lmk_adj_update(struct task_struct *task)
+{
+}
+#endif
+
 extern int sysctl_oom_dump_tasks;
 extern int sysctl_oom_kill_allocating_task;
 extern int sysctl_panic_on_oom;
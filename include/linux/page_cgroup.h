@@ -6,6 +6,7 @@ enum {
 	PCG_USED = 0x01,	/* This page is charged to a memcg */
 	PCG_MEM = 0x02,		/* This page holds a memory charge */
 	PCG_MEMSW = 0x04,	/* This page holds a memory+swap charge */
+	PCG_REFAULT = 0x08,	/* Refaulted into a protected memcg */
 };
 
 struct pglist_data;
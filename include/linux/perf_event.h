@@ -579,6 +579,7 @@ extern void perf_pmu_migrate_context(struct pmu *pmu,
 				int src_cpu, int dst_cpu);
 extern u64 perf_event_read_value(struct perf_event *event,
 				 u64 *enabled, u64 *running);
+extern u64 perf_event_read_local(struct perf_event *event);
 
 extern struct dentry *perf_create_debug_dir(void);
 
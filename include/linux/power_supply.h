@@ -375,9 +375,11 @@ struct power_supply {
 
 	/* private */
 	struct device *dev;
-	struct work_struct changed_work;
+	struct delayed_work changed_work;
 	spinlock_t changed_lock;
 	bool changed;
+	unsigned long changed_last;
+	unsigned int change_seq;
 	atomic_t use_cnt;
 #ifdef CONFIG_THERMAL
 	struct thermal_zone_device *tzd;
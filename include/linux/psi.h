@@ -0,0 +1,86 @@
+#ifndef _LINUX_PSI_H
+#define _LINUX_PSI_H
+
+#include <linux/types.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+#include <linux/list.h>
+#include <linux/workqueue.h>
+
+struct seq_file;
+struct file;
+struct poll_table_struct;
+struct mem_cgroup;
+
+enum psi_states {
+	PSI_MEM_SOME,		/* at least one task stalled on memory */
+	PSI_MEM_FULL,		/* stalled tasks and nothing else runnable */
+	NR_PSI_STATES,
+};
+
+/**
+ * struct psi_group - memory stall state of the system or of a memcg
+ * @lock:		protects the stall state and @total
+ * @nr_stalled:		tasks currently inside a memstall section
+ * @state_mask:		bitmask of the enum psi_states currently active
+ * @state_start:	time of the last state change, in ns
+ * @total:		accumulated time spent in each state, in ns
+ * @avgs_lock:		serializes updates of the running averages
+ * @avgs_work:		periodic update of @avg while there is activity
+ * @avg_total:		@total as of the last average update
+ * @avg_last_update:	time of the last average update, in ns
+ * @avg:		10s/60s/300s running averages, FIXED_1 percent
+ * @trigger_lock:	protects @triggers
+ * @triggers:		list of struct psi_trigger
+ * @nr_triggers:	number of entries on @triggers
+ * @poll_work:		evaluates @triggers while there is activity
+ * @poll_delay:		@poll_work period, in jiffies
+ */
+struct psi_group {
+	spinlock_t lock;
+	unsigned int nr_stalled;
+	unsigned int state_mask;
+	u64 state_start;
+	u64 total[NR_PSI_STATES];
+
+	struct mutex avgs_lock;
+	struct delayed_work avgs_work;
+	u64 avg_total[NR_PSI_STATES];
+	u64 avg_last_update;
+	unsigned long avg[NR_PSI_STATES][3];
+
+	struct mutex trigger_lock;
+	struct list_head triggers;
+	unsigned int nr_triggers;
+	struct delayed_work poll_work;
+	unsigned long poll_delay;
+};
+
+#ifdef CONFIG_PSI
+extern void psi_memstall_enter(unsigned long *flags);
+extern void psi_memstall_leave(unsigned long *flags);
+
+extern void psi_group_init(struct psi_group *group);
+extern void psi_group_cleanup(struct psi_group *group);
+extern int psi_show(struct seq_file *m, struct psi_group *group);
+
+#ifdef CONFIG_MEMCG
+extern struct psi_group *memcg_to_psi(struct mem_cgroup *memcg);
+extern struct mem_cgroup *mem_cgroup_psi_get(void);
+extern void mem_cgroup_psi_put(struct mem_cgroup *memcg);
+#else
+static inline struct psi_group *memcg_to_psi(struct mem_cgroup *memcg)
+{
+	return NULL;
+}
+static inline struct mem_cgroup *mem_cgroup_psi_get(void)
+{
+	return NULL;
+}
+static inline void mem_cgroup_psi_put(struct mem_cgroup *memcg) {}
+#endif /* CONFIG_MEMCG */
+#else
+static inline void psi_memstall_enter(unsigned long *flags) {}
+static inline void psi_memstall_leave(unsigned long *flags) {}
+#endif /* CONFIG_PSI */
+#endif /* _LINUX_PSI_H */
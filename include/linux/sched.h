@@ -177,8 +177,24 @@ extern void sched_update_nr_prod(int cpu, long delta, bool inc);
 extern void sched_get_nr_running_avg(int *avg, int *iowait_avg, int *big_avg,
 				     unsigned int *max_nr,
 				     unsigned int *big_max_nr);
+extern u64 sched_get_nr_running_sum(int cpu, u64 *time);
 extern u64 sched_get_cpu_last_busy_time(int cpu);
 
+#if defined(CONFIG_HOTPLUG_CPU) && !defined(CONFIG_SCHED_QHMP)
+extern int sched_isolate_cpu(int cpu);
+extern int sched_unisolate_cpu(int cpu);
+#else
+static inline int sched_isolate_cpu(int cpu)
+{
+	return -EINVAL;
+}
+
+static inline int sched_unisolate_cpu(int cpu)
+{
+	return 0;
+}
+#endif
+
 extern void calc_global_load(unsigned long ticks);
 
 #if defined(CONFIG_SMP) && defined(CONFIG_NO_HZ_COMMON)
@@ -491,6 +507,8 @@ static inline int get_dumpable(struct mm_struct *mm)
 
 #define MMF_HAS_UPROBES		19	/* has uprobes */
 #define MMF_RECALC_UPROBES	20	/* MMF_HAS_UPROBES can be wrong */
+#define MMF_VM_MERGE_ANY	21	/* KSM may merge any anonymous vma */
+#define MMF_FUTEX_HASH		22	/* private futex hash set up attempted */
 
 #define MMF_INIT_MASK		(MMF_DUMPABLE_MASK | MMF_DUMP_FILTER_MASK)
 
@@ -1219,6 +1237,12 @@ struct sched_statistics {
 	u64			nr_wakeups_affine_attempts;
 	u64			nr_wakeups_passive;
 	u64			nr_wakeups_idle;
+
+#ifdef CONFIG_SCHED_PMU_STATS
+	u64			pmu_cycles;
+	u64			pmu_instructions;
+	u64			pmu_l2_misses;
+#endif
 };
 #endif
 
@@ -1422,6 +1446,9 @@ struct task_struct {
 	struct list_head grp_list;
 	u64 cpu_cycles;
 #endif
+#ifdef CONFIG_SCHED_LATENCY_MONITOR
+	u64 latmon_wake_ts;
+#endif
 #ifdef CONFIG_CGROUP_SCHED
 	struct task_group *sched_task_group;
 #endif
@@ -1461,6 +1488,13 @@ struct task_struct {
 #endif
 
 	struct list_head tasks;
+#ifdef CONFIG_ANDROID_LMK_ADJ_BUCKETS
+	struct hlist_node lmk_adj_node;
+	int lmk_adj_bucket;
+#endif
+#ifdef CONFIG_ANDROID_LOW_MEMORY_KILLER
+	struct task_struct *lmk_reap_next;
+#endif
 #ifdef CONFIG_SMP
 	struct plist_node pushable_tasks;
 	struct rb_node pushable_dl_tasks;
@@ -1851,6 +1885,10 @@ struct task_struct {
 		unsigned int may_oom:1;
 	} memcg_oom;
 #endif
+#ifdef CONFIG_PSI
+	/* memcg charged with the current memstall section */
+	struct mem_cgroup *psi_memcg;
+#endif
 #ifdef CONFIG_UPROBES
 	struct uprobe_task *utask;
 #endif
@@ -2105,6 +2143,7 @@ struct sched_load {
 	unsigned long prev_load;
 	unsigned long new_task_load;
 	unsigned long predicted_load;
+	unsigned long top_task_load;
 };
 
 #if defined(CONFIG_SCHED_QHMP) || !defined(CONFIG_SCHED_HMP)
@@ -2118,6 +2157,8 @@ int sched_update_freq_max_load(const cpumask_t *cpumask);
 
 #if defined(CONFIG_SCHED_FREQ_INPUT)
 extern int sched_set_window(u64 window_start, unsigned int window_size);
+extern int sched_get_window_remaining(u64 *remaining_ns,
+				      unsigned int *window_ns);
 extern unsigned long sched_get_busy(int cpu);
 extern void sched_get_cpus_busy(struct sched_load *busy,
 				const struct cpumask *query_cpus);
@@ -2127,6 +2168,11 @@ static inline int sched_set_window(u64 window_start, unsigned int window_size)
 {
 	return -EINVAL;
 }
+static inline int sched_get_window_remaining(u64 *remaining_ns,
+					     unsigned int *window_ns)
+{
+	return -EINVAL;
+}
 static inline unsigned long sched_get_busy(int cpu)
 {
 	return 0;
@@ -2161,6 +2207,7 @@ static inline void sched_set_io_is_busy(int val) {};
 #define PF_KTHREAD	0x00200000	/* I am a kernel thread */
 #define PF_RANDOMIZE	0x00400000	/* randomize virtual address space */
 #define PF_SWAPWRITE	0x00800000	/* Allowed to write to swap */
+#define PF_MEMSTALL	0x01000000	/* Stalled due to lack of memory */
 #define PF_NO_SETAFFINITY 0x04000000	/* Userland is not allowed to meddle with cpus_allowed */
 #define PF_MCE_EARLY    0x08000000      /* Early kill for mce process policy */
 #define PF_MUTEX_TESTER	0x20000000	/* Thread belongs to the rt mutex tester */
@@ -3280,6 +3327,10 @@ struct migration_notify_data {
 	int load;
 };
 
+/* Events sent on load_alert_notifier_head, data is the cpu */
+#define SCHED_LOAD_ALERT	0	/* cpu load changed significantly */
+#define SCHED_WINDOW_ROLLOVER	1	/* cpu started a new window */
+
 extern struct atomic_notifier_head load_alert_notifier_head;
 
 extern long sched_setaffinity(pid_t pid, const struct cpumask *new_mask);
@@ -3289,6 +3340,15 @@ extern long sched_getaffinity(pid_t pid, struct cpumask *mask);
 extern struct task_group root_task_group;
 #endif /* CONFIG_CGROUP_SCHED */
 
+#ifdef CONFIG_CGROUP_SCHEDTUNE
+extern bool schedtune_task_foreground(struct task_struct *p);
+#else
+static inline bool schedtune_task_foreground(struct task_struct *p)
+{
+	return false;
+}
+#endif /* CONFIG_CGROUP_SCHEDTUNE */
+
 extern int task_can_switch_user(struct user_struct *up,
 					struct task_struct *tsk);
 
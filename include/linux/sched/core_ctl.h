@@ -0,0 +1,10 @@
+#ifndef _SCHED_CORE_CTL_H
+#define _SCHED_CORE_CTL_H
+
+#ifdef CONFIG_SCHED_CORE_CTL
+extern void core_ctl_check(void);
+#else
+static inline void core_ctl_check(void) {}
+#endif
+
+#endif /* _SCHED_CORE_CTL_H */
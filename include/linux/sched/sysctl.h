@@ -174,6 +174,13 @@ extern int sched_max_latency_sysctl(struct ctl_table *table, int write,
 #endif
 #endif
 
+#ifdef CONFIG_SCHED_PMU_STATS
+extern unsigned int sysctl_sched_pmu_stats;
+extern int sched_pmu_stats_handler(struct ctl_table *table, int write,
+				   void __user *buffer, size_t *lenp,
+				   loff_t *ppos);
+#endif
+
 extern int sysctl_sched_rr_timeslice;
 extern int sched_rr_timeslice;
 
@@ -0,0 +1,50 @@
+#ifndef _LINUX_SCHED_ENERGY_H
+#define _LINUX_SCHED_ENERGY_H
+
+#include <linux/threads.h>
+
+struct capacity_state {
+	unsigned long cap;	/* compute capacity */
+	unsigned long power;	/* power consumption at this compute capacity */
+};
+
+struct idle_state {
+	unsigned long power;	/* power consumption in this idle state */
+};
+
+struct sched_group_energy {
+	unsigned int nr_idle_states;	/* number of idle states */
+	struct idle_state *idle_states;	/* ptr to idle state array */
+	unsigned int nr_cap_states;	/* number of capacity states */
+	struct capacity_state *cap_states; /* ptr to capacity state array */
+};
+
+/*
+ * Levels of the "sched-energy-costs" phandle list of a cpu node: the
+ * core itself, then the cluster it belongs to.
+ */
+enum {
+	SD_LEVEL0,
+	SD_LEVEL1,
+	NR_SD_LEVELS
+};
+
+#define for_each_possible_sd_level(level) \
+	for (level = 0; level < NR_SD_LEVELS; level++)
+
+#ifdef CONFIG_SMP
+extern struct sched_group_energy *sge_array[NR_CPUS][NR_SD_LEVELS];
+
+extern void init_sched_energy_costs(void);
+extern unsigned long sched_energy_busy_power(int cpu, unsigned long util);
+#else
+static inline void init_sched_energy_costs(void) {}
+
+static inline unsigned long sched_energy_busy_power(int cpu,
+						    unsigned long util)
+{
+	return 0;
+}
+#endif
+
+#endif /* _LINUX_SCHED_ENERGY_H */
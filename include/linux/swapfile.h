@@ -11,7 +11,10 @@ extern spinlock_t swap_avail_lock;
 extern struct plist_head swap_avail_head;
 extern struct swap_info_struct *swap_info[];
 extern int try_to_unuse(unsigned int, bool, unsigned long);
-extern int swap_ratio(struct swap_info_struct **si);
+extern int swap_ratio(struct swap_info_struct **si, bool cold);
+extern bool swap_ratio_timed(struct swap_info_struct *si);
+extern void swap_ratio_write_done(struct swap_info_struct *si,
+				  unsigned long start);
 extern void setup_swap_ratio(struct swap_info_struct *p, int prio);
 extern bool is_swap_ratio_group(int prio);
 
@@ -8,6 +8,9 @@
  * Blame Andrew Morton for all this.
  */
 
+/* log2 microsecond buckets; the last one collects everything above 256ms */
+#define TASK_IO_LAT_BUCKETS	20
+
 struct task_io_accounting {
 #ifdef CONFIG_TASK_XACCT
 	/* bytes read */
@@ -44,4 +47,17 @@ struct task_io_accounting {
 	 */
 	u64 cancelled_write_bytes;
 #endif /* CONFIG_TASK_IO_ACCOUNTING */
+
+#ifdef CONFIG_TASK_IO_LATENCY
+	/*
+	 * Time the block requests submitted by this task spent queued before
+	 * being dispatched to the driver, and time spent between dispatch and
+	 * completion, in nanoseconds.  The histograms count requests per
+	 * log2 microsecond bucket, see task_io_lat_bucket().
+	 */
+	u64 io_wait_ns;
+	u64 io_service_ns;
+	u32 io_wait_hist[TASK_IO_LAT_BUCKETS];
+	u32 io_service_hist[TASK_IO_LAT_BUCKETS];
+#endif /* CONFIG_TASK_IO_LATENCY */
 };
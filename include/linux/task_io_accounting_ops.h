@@ -5,6 +5,7 @@
 #define __TASK_IO_ACCOUNTING_OPS_INCLUDED
 
 #include <linux/sched.h>
+#include <linux/math64.h>
 
 #ifdef CONFIG_TASK_IO_ACCOUNTING
 static inline void task_io_account_read(size_t bytes)
@@ -45,12 +46,60 @@ static inline void task_io_accounting_init(struct task_io_accounting *ioac)
 	memset(ioac, 0, sizeof(*ioac));
 }
 
+#ifdef CONFIG_TASK_IO_LATENCY
+/*
+ * Bucket 0 counts sub-microsecond latencies, bucket b > 0 counts
+ * [2^(b-1), 2^b) microseconds.
+ */
+static inline unsigned int task_io_lat_bucket(u64 ns)
+{
+	return min_t(unsigned int, fls64(div_u64(ns, NSEC_PER_USEC)),
+		     TASK_IO_LAT_BUCKETS - 1);
+}
+
+/*
+ * Called from the request completion path, possibly on another CPU than
+ * the one @tsk runs on.  The counters are statistics only, so a rare lost
+ * update between concurrent completions is tolerated rather than paying
+ * for atomics on every request.
+ */
+static inline void task_io_account_latency(struct task_struct *tsk,
+					   u64 wait_ns, u64 service_ns)
+{
+	struct task_io_accounting *ioac = &tsk->ioac;
+
+	ioac->io_wait_ns += wait_ns;
+	ioac->io_service_ns += service_ns;
+	ioac->io_wait_hist[task_io_lat_bucket(wait_ns)]++;
+	ioac->io_service_hist[task_io_lat_bucket(service_ns)]++;
+}
+
+static inline void task_io_latency_add(struct task_io_accounting *dst,
+				       struct task_io_accounting *src)
+{
+	int i;
+
+	dst->io_wait_ns += src->io_wait_ns;
+	dst->io_service_ns += src->io_service_ns;
+	for (i = 0; i < TASK_IO_LAT_BUCKETS; i++) {
+		dst->io_wait_hist[i] += src->io_wait_hist[i];
+		dst->io_service_hist[i] += src->io_service_hist[i];
+	}
+}
+#else
+static inline void task_io_latency_add(struct task_io_accounting *dst,
+				       struct task_io_accounting *src)
+{
+}
+#endif /* CONFIG_TASK_IO_LATENCY */
+
 static inline void task_blk_io_accounting_add(struct task_io_accounting *dst,
 						struct task_io_accounting *src)
 {
 	dst->read_bytes += src->read_bytes;
 	dst->write_bytes += src->write_bytes;
 	dst->cancelled_write_bytes += src->cancelled_write_bytes;
+	task_io_latency_add(dst, src);
 }
 
 #else
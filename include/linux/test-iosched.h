@@ -20,6 +20,8 @@
 #ifndef _LINUX_TEST_IOSCHED_H
 #define _LINUX_TEST_IOSCHED_H
 
+#include <linux/random.h>
+
 /*
  * Patterns definitions for read/write requests data
  */
@@ -30,6 +32,9 @@
 #define BIO_U32_SIZE 1024
 #define TEST_BIO_SIZE		PAGE_SIZE	/* use one page bios */
 
+/* Benchmark runs may be long, allow them more than the default timeout */
+#define TEST_BENCH_TIMEOUT_MS	(10 * 60 * 1000)
+
 struct test_iosched;
 
 typedef int (prepare_test_fn) (struct test_iosched *);
@@ -82,6 +87,8 @@ enum req_unique_type {
  * @start_sector:	The start sector for read/write requests
  * @sector_range:	Range of the test, starting from start_sector
  *			(in sectors)
+ * @bench_root:		Benchmark configuration and results directory,
+ *			under @debug_utils_root
  */
 struct test_debug {
 	struct dentry *debug_root;
@@ -90,6 +97,7 @@ struct test_debug {
 	struct dentry *debug_test_result;
 	struct dentry *start_sector;
 	struct dentry *sector_range;
+	struct dentry *bench_root;
 };
 
 /**
@@ -110,6 +118,8 @@ struct test_debug {
  *			verify the data
  * @req_id:		A unique ID to identify a test request
  *			to ease the debugging of the test cases
+ * @issue_time:		When a benchmark request was queued, for
+ *			its completion latency
  */
 struct test_request {
 	struct list_head queuelist;
@@ -121,6 +131,7 @@ struct test_request {
 	int is_err_expected;
 	int wr_rd_data_pattern;
 	int req_id;
+	ktime_t issue_time;
 };
 
 /**
@@ -155,6 +166,82 @@ struct test_info {
 	unsigned long test_byte_count;
 };
 
+/**
+ * struct test_bench_cfg - benchmark workload, set through debugfs
+ * @num_reqs:		Number of requests issued per run
+ * @queue_depth:	Maximum number of requests outstanding at once
+ * @read_pct:		Percentage of reads, the rest are writes
+ * @random_pct:		Percentage of requests to random LBAs, the rest
+ *			continue sequentially from the previous one
+ * @sync_pct:		Percentage of requests flagged REQ_SYNC
+ * @bios_per_req:	Request size, in TEST_BIO_SIZE units
+ * @seed:		Workload generator seed; a given seed always
+ *			produces the same request sequence
+ */
+struct test_bench_cfg {
+	u32 num_reqs;
+	u32 queue_depth;
+	u32 read_pct;
+	u32 random_pct;
+	u32 sync_pct;
+	u32 bios_per_req;
+	u32 seed;
+};
+
+/**
+ * struct test_bench_result - results of the last benchmark run
+ * @completed:		Number of requests completed
+ * @errors:		Number of requests completed with an error
+ * @bytes:		Bytes transferred by successful requests
+ * @duration_us:	Wall time of the run
+ * @kib_per_sec:	Throughput
+ * @iops:		Completed requests per second
+ * @min_us:		Latency, from queueing to completion
+ * @p50_us:
+ * @p99_us:
+ * @p999_us:
+ * @max_us:
+ */
+struct test_bench_result {
+	u32 completed;
+	u32 errors;
+	u64 bytes;
+	u64 duration_us;
+	u64 kib_per_sec;
+	u64 iops;
+	u32 min_us;
+	u32 p50_us;
+	u32 p99_us;
+	u32 p999_us;
+	u32 max_us;
+};
+
+/**
+ * struct test_bench - benchmark state
+ * @cfg:		The workload
+ * @res:		Results of the last completed run
+ * @rnd:		Workload generator state, seeded from @cfg.seed
+ * @lat_us:		Per request latency samples of the current run
+ * @nr_reqs:		Requests to issue in the current run
+ * @nr_issued:		Requests queued so far in the current run
+ * @nr_completed:	Requests completed so far in the current run
+ * @nr_errors:		Requests completed with an error
+ * @bytes:		Bytes transferred by successful requests
+ * @wait_q:		Woken on every completion, to refill the queue
+ */
+struct test_bench {
+	struct test_bench_cfg cfg;
+	struct test_bench_result res;
+	struct rnd_state rnd;
+	u32 *lat_us;
+	u32 nr_reqs;
+	u32 nr_issued;
+	u32 nr_completed;
+	u32 nr_errors;
+	u64 bytes;
+	wait_queue_head_t wait_q;
+};
+
 /**
  * struct blk_dev_test_type - identifies block device test
  * @list:		list head pointer
@@ -213,6 +300,7 @@ struct blk_dev_test_type {
  *			flush request, therefore disqualifying
  *			the results
  * @blk_dev_test_data:	associated specific block device test utility
+ * @bench:		Benchmark workload, state and results
  */
 struct test_iosched {
 	struct list_head queue;
@@ -240,6 +328,7 @@ struct test_iosched {
 	bool ignore_round;
 	bool notified_urgent;
 	void *blk_dev_test_data;
+	struct test_bench bench;
 };
 
 extern int test_iosched_start_test(struct test_iosched *,
@@ -274,4 +363,8 @@ extern void check_test_completion(struct test_iosched *);
 
 extern int compare_buffer_to_pattern(struct test_request *test_rq);
 
+extern int test_iosched_bench_run(struct test_iosched *);
+extern bool test_iosched_bench_check_completion(struct test_iosched *);
+extern void test_iosched_bench_report(struct test_iosched *);
+
 #endif /* _LINUX_TEST_IOSCHED_H */
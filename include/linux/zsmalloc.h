@@ -36,10 +36,19 @@ enum zs_mapmode {
 
 struct zs_pool;
 
-struct zs_pool *zs_create_pool(char *name, gfp_t flags);
+struct zs_class_stats {
+	unsigned int size;		/* object size of the class */
+	unsigned long obj_allocated;	/* objects the class' zspages hold */
+	unsigned long obj_used;		/* objects in use */
+	unsigned long almost_full;	/* zspages in ZS_ALMOST_FULL */
+	unsigned long almost_empty;	/* zspages in ZS_ALMOST_EMPTY */
+	unsigned long pages_used;	/* pages backing the class */
+};
+
+struct zs_pool *zs_create_pool(char *name);
 void zs_destroy_pool(struct zs_pool *pool);
 
-unsigned long zs_malloc(struct zs_pool *pool, size_t size);
+unsigned long zs_malloc(struct zs_pool *pool, size_t size, gfp_t flags);
 void zs_free(struct zs_pool *pool, unsigned long obj);
 
 void *zs_map_object(struct zs_pool *pool, unsigned long handle,
@@ -47,6 +56,11 @@ void *zs_map_object(struct zs_pool *pool, unsigned long handle,
 void zs_unmap_object(struct zs_pool *pool, unsigned long handle);
 
 unsigned long zs_get_total_pages(struct zs_pool *pool);
+unsigned int zs_lookup_class_size(struct zs_pool *pool, size_t size);
+unsigned int zs_get_nr_size_classes(void);
+bool zs_get_class_stats(struct zs_pool *pool, unsigned int idx,
+			struct zs_class_stats *stats);
 unsigned long zs_compact(struct zs_pool *pool);
+unsigned long zs_get_bg_migrated(struct zs_pool *pool);
 
 #endif
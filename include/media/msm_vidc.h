@@ -68,6 +68,8 @@ struct msm_smem {
 	void *smem_priv;
 	enum hal_buffer buffer_type;
 	struct dma_mapping_info mapping_info;
+	struct list_head cache_list;
+	bool user_mapped;
 };
 
 enum smem_cache_ops {
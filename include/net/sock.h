@@ -242,6 +242,7 @@ struct cg_proto;
   *	@sk_allocation: allocation mode
   *	@sk_pacing_rate: Pacing rate (if supported by transport/packet scheduler)
   *	@sk_max_pacing_rate: Maximum pacing rate (%SO_MAX_PACING_RATE)
+  *	@sk_pacing_status: Pacing status (requested, handled by sch_fq)
   *	@sk_sndbuf: size of send buffer in bytes
   *	@sk_flags: %SO_LINGER (l_onoff), %SO_BROADCAST, %SO_KEEPALIVE,
   *		   %SO_OOBINLINE settings, %SO_TIMESTAMPING settings
@@ -387,6 +388,7 @@ struct sock {
 	gfp_t			sk_allocation;
 	u32			sk_pacing_rate; /* bytes per second */
 	u32			sk_max_pacing_rate;
+	u32			sk_pacing_status; /* see enum sk_pacing */
 	netdev_features_t	sk_route_caps;
 	netdev_features_t	sk_route_nocaps;
 	int			sk_gso_type;
@@ -439,6 +441,16 @@ struct sock {
 	void                    (*sk_destruct)(struct sock *sk);
 };
 
+/* Pacing requested by the transport (TCP internal pacing or sch_fq).
+ * sch_fq sets SK_PACING_FQ on sockets it sees, so that TCP can skip its
+ * own hrtimer based pacing when the qdisc already does the job.
+ */
+enum sk_pacing {
+	SK_PACING_NONE		= 0,
+	SK_PACING_NEEDED	= 1,
+	SK_PACING_FQ		= 2,
+};
+
 #define __sk_user_data(sk) ((*((void __rcu **)&(sk)->sk_user_data)))
 
 #define rcu_dereference_sk_user_data(sk)	rcu_dereference(__sk_user_data((sk)))
@@ -33,7 +33,10 @@ int boot_stats_exit(void);
 unsigned long long int msm_timer_get_sclk_ticks(void);
 #else
 static inline int boot_stats_init(void) { return 0; }
-unsigned long long int msm_timer_get_sclk_ticks(void) { return 0; }
+static inline unsigned long long int msm_timer_get_sclk_ticks(void)
+{
+	return 0;
+}
 #endif
 
 #ifdef CONFIG_MSM_BOOT_TIME_MARKER
@@ -41,6 +44,6 @@ unsigned long long int msm_timer_get_sclk_ticks(void) { return 0; }
 static inline int boot_marker_enabled(void) { return 1; }
 void place_marker(const char *name);
 #else
-inline void place_marker(char *name);
+static inline void place_marker(const char *name) { }
 static inline int boot_marker_enabled(void) { return 0; }
 #endif
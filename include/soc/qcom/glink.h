@@ -191,6 +191,20 @@ int glink_tx(void *handle, void *pkt_priv, void *data, size_t size,
  */
 int glink_queue_rx_intent(void *handle, const void *pkt_priv, size_t size);
 
+/**
+ * glink_queue_rx_intent_buf() - Register a client buffer as an rx intent.
+ *
+ * @handle:	handle returned by glink_open()
+ * @pkt_priv:	opaque data type that is returned when a packet is received
+ * @buf:	buffer the received data is written to, owned by the client
+ *		until returned through glink_rx_done() or notify_rx_abort()
+ * @size:	size of @buf
+ *
+ * Return: 0 for success; standard Linux error code for failure case
+ */
+int glink_queue_rx_intent_buf(void *handle, const void *pkt_priv, void *buf,
+			      size_t size);
+
 /**
  * glink_rx_intent_exists() - Check if an intent of size exists.
  *
@@ -362,6 +376,12 @@ static inline int glink_queue_rx_intent(void *handle, const void *pkt_priv,
 	return -ENODEV;
 }
 
+static inline int glink_queue_rx_intent_buf(void *handle, const void *pkt_priv,
+					    void *buf, size_t size)
+{
+	return -ENODEV;
+}
+
 static inline bool glink_rx_intent_exists(void *handle, size_t size)
 {
 	return -ENODEV;
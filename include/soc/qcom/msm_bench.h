@@ -0,0 +1,80 @@
+/* Copyright (c) 2018, The Linux Foundation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __MSM_BENCH_H__
+#define __MSM_BENCH_H__
+
+#include <linux/mutex.h>
+#include <linux/types.h>
+
+struct dentry;
+struct msm_bench_file;
+
+/**
+ * struct msm_bench_result - summary of the last run of a benchmark
+ * @iters:	Number of timed iterations that completed
+ * @errors:	Number of iterations whose run() callback failed
+ * @total_ns:	Sum of the latencies of all completed iterations
+ * @min_ns:	Fastest iteration
+ * @p50_ns:	Median iteration latency
+ * @p90_ns:	90th percentile iteration latency
+ * @p99_ns:	99th percentile iteration latency
+ * @max_ns:	Slowest iteration
+ */
+struct msm_bench_result {
+	u32 iters;
+	u32 errors;
+	u64 total_ns;
+	u64 min_ns;
+	u64 p50_ns;
+	u64 p90_ns;
+	u64 p99_ns;
+	u64 max_ns;
+};
+
+/**
+ * struct msm_bench - a timed kernel microbenchmark
+ * @name:	Name of the debugfs file, unique among benchmarks
+ * @bytes:	Bytes processed by one iteration, used to report KB/s; 0 if
+ *		the benchmark has no meaningful payload size
+ * @setup:	Optional, called once before the timed loop
+ * @run:	One timed iteration; returns 0 or a negative error code
+ * @teardown:	Optional, called once after the timed loop if setup succeeded
+ * @priv:	Owner's private data
+ *
+ * The remaining fields are owned by the framework.
+ */
+struct msm_bench {
+	const char *name;
+	size_t bytes;
+	int (*setup)(struct msm_bench *bench);
+	int (*run)(struct msm_bench *bench);
+	void (*teardown)(struct msm_bench *bench);
+	void *priv;
+
+	struct dentry *dentry;
+	struct msm_bench_file *file;
+	struct msm_bench_result result;
+};
+
+#ifdef CONFIG_MSM_BENCH
+int msm_bench_register(struct msm_bench *bench);
+void msm_bench_unregister(struct msm_bench *bench);
+#else
+static inline int msm_bench_register(struct msm_bench *bench)
+{
+	return 0;
+}
+static inline void msm_bench_unregister(struct msm_bench *bench) { }
+#endif
+
+#endif
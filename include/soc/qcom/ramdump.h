@@ -28,6 +28,8 @@ extern int do_ramdump(void *handle, struct ramdump_segment *segments,
 		int nsegments);
 extern int do_elf_ramdump(void *handle, struct ramdump_segment *segments,
 		int nsegments);
+extern int do_elf_ramdump_snapshot(void *handle,
+		struct ramdump_segment *segments, int nsegments);
 
 #else
 static inline void *create_ramdump_device(const char *dev_name,
@@ -51,6 +53,12 @@ static inline int do_elf_ramdump(void *handle, struct ramdump_segment *segments,
 {
 	return -ENODEV;
 }
+
+static inline int do_elf_ramdump_snapshot(void *handle,
+		struct ramdump_segment *segments, int nsegments)
+{
+	return -ENODEV;
+}
 #endif /* CONFIG_MSM_SUBSYSTEM_RESTART */
 
 #endif
@@ -31,6 +31,22 @@ struct msm_rpm_kvp {
 	uint32_t length;
 	uint8_t *data;
 };
+
+/**
+ * struct msm_rpm_batch_msg - one message of an msm_rpm_send_message_batch()
+ * @set: active or sleep set
+ * @rsc_type: resource type
+ * @rsc_id: resource id
+ * @kvp: array of KVP data
+ * @nelems: number of KVPs in @kvp
+ */
+struct msm_rpm_batch_msg {
+	enum msm_rpm_set set;
+	uint32_t rsc_type;
+	uint32_t rsc_id;
+	struct msm_rpm_kvp *kvp;
+	int nelems;
+};
 #ifdef CONFIG_MSM_RPM_SMD
 /**
  * msm_rpm_request() - Creates a parent element to identify the
@@ -214,6 +230,20 @@ void *msm_rpm_send_message_noack(enum msm_rpm_set set, uint32_t rsc_type,
 int msm_rpm_send_message_noirq(enum msm_rpm_set set, uint32_t rsc_type,
 		uint32_t rsc_id, struct msm_rpm_kvp *kvp, int nelems);
 
+/**
+ * msm_rpm_send_message_batch() - Send a group of messages and wait for all
+ * of their acks. Messages to the same resource and set are merged into one
+ * request, and active set KVPs whose value the RPM has already acked for a
+ * previous batch are not sent again. A bounded number of requests is kept
+ * in flight instead of waiting on each ack in turn.
+ *
+ * @msgs: array of messages; the KVP data must stay valid until return.
+ * @count: number of messages in @msgs.
+ *
+ * returns 0 on success or the first error seen.
+ */
+int msm_rpm_send_message_batch(struct msm_rpm_batch_msg *msgs, int count);
+
 /**
  * msm_rpm_driver_init() - Initialization function that registers for a
  * rpm platform driver.
@@ -291,6 +321,12 @@ static inline void *msm_rpm_send_message_noack(enum msm_rpm_set set,
 	return NULL;
 }
 
+static inline int msm_rpm_send_message_batch(struct msm_rpm_batch_msg *msgs,
+		int count)
+{
+	return 0;
+}
+
 static inline int msm_rpm_wait_for_ack(uint32_t msg_id)
 {
 	return 0;
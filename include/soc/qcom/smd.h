@@ -127,6 +127,31 @@ void smd_enable_read_intr(smd_channel_t *ch);
  */
 void smd_disable_read_intr(smd_channel_t *ch);
 
+/**
+ * smd_set_rx_poll() - Switch a channel between notified and polled reads
+ * @ch:      open channel handle
+ * @poll:    true to stop SMD_EVENT_DATA notifications for this channel
+ * @returns: 0 for success; < 0 for failure
+ *
+ * While polling, the client drains the channel with smd_read_avail() and
+ * smd_read(). Pair with smd_mask_receive_interrupt() to also stop the
+ * edge interrupt during a bulk transfer. When polling is turned off and
+ * data is already waiting, an SMD_EVENT_DATA notification is raised.
+ */
+int smd_set_rx_poll(smd_channel_t *ch, bool poll);
+
+/**
+ * smd_set_tx_coalesce() - Hold write interrupts to the remote processor
+ * @ch:      open channel handle
+ * @usecs:   longest time a write notification may be held; 0 disables
+ * @returns: 0 for success; < 0 for failure
+ *
+ * Writes within @usecs of the first pending one share a single interrupt
+ * to the remote side. Any held interrupt is sent when coalescing is
+ * disabled or the channel is closed.
+ */
+int smd_set_tx_coalesce(smd_channel_t *ch, unsigned int usecs);
+
 /**
  * Enable/disable receive interrupts for the remote processor used by a
  * particular channel.
@@ -320,6 +345,16 @@ static inline void smd_disable_read_intr(smd_channel_t *ch)
 {
 }
 
+static inline int smd_set_rx_poll(smd_channel_t *ch, bool poll)
+{
+	return -ENODEV;
+}
+
+static inline int smd_set_tx_coalesce(smd_channel_t *ch, unsigned int usecs)
+{
+	return -ENODEV;
+}
+
 static inline int smd_mask_receive_interrupt(smd_channel_t *ch, bool mask,
 		const struct cpumask *cpumask)
 {
@@ -97,6 +97,8 @@ struct subsys_desc {
  * @enable_ramdump: ramdumps disabled if set to 0
  * @enable_mini_ramdumps: enable flag for minimized critical-memory-only
  * ramdumps
+ * @defer_mini_ramdumps: capture minimized ramdumps in a kernel buffer for
+ * later collection instead of waiting for userspace to read them
  * @no_auth: set if subsystem does not use PIL to bring it out of reset
  * @pdev: subsystem platform device pointer
  */
@@ -104,6 +106,7 @@ struct notif_data {
 	bool crashed;
 	int enable_ramdump;
 	int enable_mini_ramdumps;
+	bool defer_mini_ramdumps;
 	bool no_auth;
 	struct platform_device *pdev;
 };
@@ -43,6 +43,7 @@ enum {
 
 enum {
 	ADM_MEM_MAP_INDEX_SOURCE_TRACKING = ADM_MAX_CAL_TYPES,
+	ADM_MEM_MAP_INDEX_CAL_ARENA,
 	ADM_MEM_MAP_INDEX_MAX
 };
 
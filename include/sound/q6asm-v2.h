@@ -341,6 +341,8 @@ int q6asm_memory_unmap(struct audio_client *ac, phys_addr_t buf_add,
 
 struct audio_buffer *q6asm_shared_io_buf(struct audio_client *ac, int dir);
 
+struct audio_buffer *q6asm_shared_pos_buf(struct audio_client *ac);
+
 int q6asm_shared_io_free(struct audio_client *ac, int dir);
 
 int q6asm_get_shared_pos(struct audio_client *ac, uint32_t *si, uint32_t *msw,
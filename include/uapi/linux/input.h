@@ -162,6 +162,31 @@ struct input_keymap_entry {
 
 #define EVIOCSCLOCKID		_IOW('E', 0xa0, int)			/* Set clockid to be used for timestamps */
 
+/**
+ * struct input_event_ring - shared event ring of an evdev client
+ * @head: index of the next slot the kernel will fill (written by kernel)
+ * @tail: index of the next slot userspace will consume (written by user)
+ * @size: number of slots in @events, always a power of two
+ * @dropped: number of events discarded because the ring was full
+ * @events: event slots, indexed modulo @size
+ *
+ * mmap()ing an event device at offset 0 creates a ring sized to fit the
+ * mapping, of at most 65536 slots; larger mappings are rejected with
+ * -EINVAL. From then on events for that file descriptor are delivered
+ * to the ring instead of through read(); poll() reports POLLIN while
+ * @head != @tail. The kernel publishes slots before advancing @head, and
+ * userspace must finish with a slot before advancing @tail past it.
+ * Timestamps follow EVIOCSCLOCKID, as for read().
+ */
+struct input_event_ring {
+	__u32 head;
+	__u32 tail;
+	__u32 size;
+	__u32 dropped;
+	__u32 reserved[4];
+	struct input_event events[0];
+};
+
 /*
  * IDs.
  */
@@ -123,6 +123,11 @@
 #define KGSL_MEMFLAGS_GPUREADONLY 0x01000000U
 #define KGSL_MEMFLAGS_GPUWRITEONLY 0x02000000U
 #define KGSL_MEMFLAGS_FORCE_32BIT 0x100000000ULL
+/*
+ * Back the allocation lazily: pages are populated on first CPU access and
+ * the remainder when the owning process first submits GPU commands
+ */
+#define KGSL_MEMFLAGS_LAZY        0x200000000ULL
 
 /* Memory caching hints */
 #define KGSL_CACHEMODE_MASK       0x0C000000U
@@ -314,6 +319,7 @@ enum kgsl_timestamp_type {
 #define KGSL_PROP_DEVICE_QDSS_STM	0x19
 #define KGSL_PROP_SECURE_BUFFER_ALIGNMENT 0x23
 #define KGSL_PROP_SECURE_CTXT_SUPPORT 0x24
+#define KGSL_PROP_CONTEXT_DEADLINE	0x25
 
 struct kgsl_shadowprop {
 	unsigned long gpuaddr;
@@ -326,6 +332,17 @@ struct kgsl_qdss_stm_prop {
 	uint64_t size;
 };
 
+/**
+ * struct kgsl_context_deadline - argument to KGSL_PROP_CONTEXT_DEADLINE
+ * @context_id: Context to set the deadline for
+ * @deadline_us: Time after submission by which the command batches of the
+ * context should be done, 0 to clear the deadline
+ */
+struct kgsl_context_deadline {
+	unsigned int context_id;
+	unsigned int deadline_us;
+};
+
 struct kgsl_version {
 	unsigned int drv_major;
 	unsigned int drv_minor;
@@ -1462,4 +1479,68 @@ struct kgsl_gpuobj_set_info {
 #define IOCTL_KGSL_GPUOBJ_SET_INFO \
 	_IOW(KGSL_IOC_TYPE, 0x4C, struct kgsl_gpuobj_set_info)
 
+/**
+ * struct kgsl_perfcounter_sample_header - Start of a perfcounter sample ring
+ * @head: Number of samples written so far, bumped by the kernel after each
+ * sample is complete
+ * @count: Number of counter values in each sample
+ * @size: Number of samples that fit in the ring
+ * @sample_size: Size of each sample in bytes
+ *
+ * The header is followed by @size samples. Sample N is stored at index
+ * (N % @size).
+ */
+struct kgsl_perfcounter_sample_header {
+	unsigned int head;
+	unsigned int count;
+	unsigned int size;
+	unsigned int sample_size;
+};
+
+/**
+ * struct kgsl_perfcounter_sample - One sample in a perfcounter sample ring
+ * @time: CPU time of the sample in nanoseconds (CLOCK_MONOTONIC)
+ * @context_id: Context of the command batch that retired
+ * @timestamp: Timestamp of the command batch that retired
+ * @values: Counter values in the order they were requested
+ */
+struct kgsl_perfcounter_sample {
+	uint64_t time;
+	unsigned int context_id;
+	unsigned int timestamp;
+	uint64_t values[0];
+};
+
+#define KGSL_PERFCOUNTER_SAMPLE_MAX 16
+
+/* Only sample when a command batch flagged as end of frame retires */
+#define KGSL_PERFCOUNTER_SAMPLE_EOF 0x1
+
+/**
+ * struct kgsl_perfcounter_sampling - argument to
+ * IOCTL_KGSL_PERFCOUNTER_SAMPLING
+ * @counters: Pointer to an array of struct kgsl_perfcounter_read_group
+ * naming the counters to sample, the value members are ignored
+ * @count: Number of entries in @counters, 0 to stop sampling
+ * @context_id: Context whose command batches trigger the samples
+ * @id: GPU memory object ID of the sample ring
+ * @flags: KGSL_PERFCOUNTER_SAMPLE_* flags
+ *
+ * Sample the listed counters into the ring each time a command batch from
+ * the context retires, so that they can be read through the mmap of the
+ * ring instead of IOCTL_KGSL_PERFCOUNTER_READ. Several contexts of a process
+ * may share one ring. Starting again replaces the previous counters and
+ * ring of the context.
+ */
+struct kgsl_perfcounter_sampling {
+	uint64_t __user counters;
+	unsigned int count;
+	unsigned int context_id;
+	unsigned int id;
+	unsigned int flags;
+};
+
+#define IOCTL_KGSL_PERFCOUNTER_SAMPLING \
+	_IOW(KGSL_IOC_TYPE, 0x4D, struct kgsl_perfcounter_sampling)
+
 #endif /* _UAPI_MSM_KGSL_H */
@@ -0,0 +1,57 @@
+/* Copyright (c) 2016, The Linux Foundation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _UAPI_MSM_RQ_STATS_H
+#define _UAPI_MSM_RQ_STATS_H
+
+#include <linux/types.h>
+
+#define RQ_STATS_MAX_CPUS	32
+
+/**
+ * struct rq_stats_cpu - run queue statistics of one cpu
+ * @nr_running_avg:	average nr_running over the last period, times 100
+ * @busy_pct:		percentage of the last period the cpu was not idle
+ * @online:		non-zero if the cpu is online
+ */
+struct rq_stats_cpu {
+	__u32 nr_running_avg;
+	__u32 busy_pct;
+	__u32 online;
+	__u32 reserved;
+};
+
+/**
+ * struct rq_stats_page - layout of the page mmap()ed from /dev/rq_stats
+ * @seq:		sequence count, odd while the page is being updated
+ * @nr_cpus:		number of valid entries in @cpu
+ * @period_ms:		update period of the page
+ * @update_time_ns:	CLOCK_MONOTONIC time of the last update
+ * @cpu:		per-cpu statistics
+ *
+ * Readers must retry while @seq is odd or changed across the read:
+ *
+ *	do {
+ *		seq = page->seq;	(followed by a read barrier)
+ *		... copy out the fields ...
+ *	} while ((seq & 1) || (read barrier, page->seq != seq));
+ */
+struct rq_stats_page {
+	__u32 seq;
+	__u32 nr_cpus;
+	__u32 period_ms;
+	__u32 reserved;
+	__u64 update_time_ns;
+	struct rq_stats_cpu cpu[RQ_STATS_MAX_CPUS];
+};
+
+#endif /* _UAPI_MSM_RQ_STATS_H */
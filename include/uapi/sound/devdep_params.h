@@ -66,4 +66,34 @@ struct dts_eagle_param_desc {
 	uint32_t device;
 } __packed;
 
+/*
+ * Shared memory export for pull/push mode (no-irq) PCM front ends.
+ * MMAP_DATA_FD returns a dma-buf fd of the circular sample buffer and
+ * MMAP_POS_FD one of the DSP position buffer laid out as
+ * struct snd_pcm_shared_pos. Both are read/written by userspace directly,
+ * without per period syscalls or DSP commands.
+ */
+struct snd_pcm_mmap_fd {
+	int32_t dir;
+	int32_t fd;
+	int32_t size;
+	int32_t actual_size;
+};
+
+/*
+ * frame_counter is zero until the DSP has published a position and is
+ * bumped on every update; re-read until it is stable around index.
+ */
+struct snd_pcm_shared_pos {
+	uint32_t frame_counter;
+	uint32_t index;
+	uint32_t wall_clock_us_lsw;
+	uint32_t wall_clock_us_msw;
+};
+
+#define SNDRV_PCM_IOCTL_MMAP_DATA_FD\
+		_IOWR('U', 0xd2, struct snd_pcm_mmap_fd)
+#define SNDRV_PCM_IOCTL_MMAP_POS_FD\
+		_IOWR('U', 0xd3, struct snd_pcm_mmap_fd)
+
 #endif
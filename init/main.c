@@ -79,6 +79,8 @@
 #include <linux/random.h>
 #include <linux/list.h>
 
+#include <soc/qcom/boot_stats.h>
+
 #include <asm/io.h>
 #include <asm/bugs.h>
 #include <asm/setup.h>
@@ -863,6 +865,15 @@ static void __init do_initcall_level(int level)
 
 	for (fn = initcall_levels[level]; fn < initcall_levels[level+1]; fn++)
 		do_one_initcall(*fn);
+
+	/* boot markers are only available once the subsys level has run */
+	if (level >= 4) {
+		char marker[40];
+
+		snprintf(marker, sizeof(marker), "M - %s initcalls done",
+			 initcall_level_names[level]);
+		place_marker(marker);
+	}
 }
 
 static void __init do_initcalls(void)
@@ -965,6 +976,7 @@ static int __ref kernel_init(void *unused)
 	kernel_init_freeable();
 	/* need to finish all async __init code before freeing the memory */
 	async_synchronize_full();
+	place_marker("M - async probe done");
 	free_initmem();
 	mark_readonly();
 	system_state = SYSTEM_RUNNING;
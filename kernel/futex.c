@@ -261,6 +261,89 @@ static unsigned long __read_mostly futex_hashsize;
 
 static struct futex_hash_bucket *futex_queues;
 
+static void futex_hash_init(struct futex_hash_bucket *fhb, unsigned long size)
+{
+	unsigned long i;
+
+	for (i = 0; i < size; i++) {
+		atomic_set(&fhb[i].waiters, 0);
+		plist_head_init(&fhb[i].chain);
+		spin_lock_init(&fhb[i].lock);
+	}
+}
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+/*
+ * PROCESS_PRIVATE futex keys are only ever looked up by tasks using the
+ * mm they belong to, so a multi-threaded process can hash them into a
+ * table of its own and stop sharing (and bouncing) buckets with every
+ * other process in the system.
+ *
+ * Which table a key hashes to must never change while a waiter may be
+ * queued, as the waker would then look in the wrong place. The table is
+ * therefore set up exactly once, when the mm gains its first additional
+ * user: at that point the only task that could have used a private
+ * futex of this mm is the one calling clone(), and it is not waiting.
+ * vfork() children are skipped since they are about to exec. If the
+ * allocation fails the mm keeps using the global table for good.
+ *
+ * The number of threads that can contend on the table at any one time
+ * is bounded by the number of CPUs, so size it from that rather than
+ * from a thread count that is not known yet and cannot be followed
+ * without rehashing queued waiters.
+ */
+void futex_mm_clone(struct mm_struct *mm, unsigned long clone_flags)
+{
+	struct futex_hash_bucket *fhb;
+	unsigned long size;
+
+	if (clone_flags & CLONE_VFORK)
+		return;
+
+	if (test_and_set_bit(MMF_FUTEX_HASH, &mm->flags))
+		return;
+
+	size = roundup_pow_of_two(4 * num_possible_cpus());
+	size = clamp(size, 16UL, futex_hashsize);
+
+	fhb = kcalloc(size, sizeof(*fhb), GFP_KERNEL | __GFP_NOWARN);
+	if (!fhb)
+		return;
+
+	futex_hash_init(fhb, size);
+	mm->futex_hash_mask = size - 1;
+	mm->futex_hash = fhb;
+}
+
+/* Called from __mmdrop(), no task can be queued on the table anymore. */
+void futex_mm_release(struct mm_struct *mm)
+{
+	kfree(mm->futex_hash);
+	mm->futex_hash = NULL;
+}
+
+static inline struct futex_hash_bucket *
+futex_private_hb(union futex_key *key, u32 hash)
+{
+	struct mm_struct *mm;
+
+	if (key->both.offset & (FUT_OFF_INODE | FUT_OFF_MMSHARED))
+		return NULL;
+
+	mm = key->private.mm;
+	if (!mm->futex_hash)
+		return NULL;
+
+	return &mm->futex_hash[hash & mm->futex_hash_mask];
+}
+#else
+static inline struct futex_hash_bucket *
+futex_private_hb(union futex_key *key, u32 hash)
+{
+	return NULL;
+}
+#endif
+
 #ifdef CONFIG_COMPAT
 static void compat_exit_robust_list(struct task_struct *curr);
 #else
@@ -319,6 +402,10 @@ static struct futex_hash_bucket *hash_futex(union futex_key *key)
 {
 	u32 hash = jhash2((u32 *)key, offsetof(typeof(*key), both.offset) / 4,
 			  key->both.offset);
+	struct futex_hash_bucket *hb = futex_private_hb(key, hash);
+
+	if (hb)
+		return hb;
 
 	return &futex_queues[hash & (futex_hashsize - 1)];
 }
@@ -3577,7 +3664,6 @@ static void __init futex_detect_cmpxchg(void)
 static int __init futex_init(void)
 {
 	unsigned int futex_shift;
-	unsigned long i;
 
 #if CONFIG_BASE_SMALL
 	futex_hashsize = 16;
@@ -3593,12 +3679,7 @@ static int __init futex_init(void)
 	futex_hashsize = 1UL << futex_shift;
 
 	futex_detect_cmpxchg();
-
-	for (i = 0; i < futex_hashsize; i++) {
-		atomic_set(&futex_queues[i].waiters, 0);
-		plist_head_init(&futex_queues[i].chain);
-		spin_lock_init(&futex_queues[i].lock);
-	}
+	futex_hash_init(futex_queues, futex_hashsize);
 
 	return 0;
 }
@@ -44,6 +44,7 @@
 #include <linux/rculist.h>
 #include <linux/poll.h>
 #include <linux/irq_work.h>
+#include <linux/kthread.h>
 #include <linux/utsname.h>
 #include <linux/ctype.h>
 
@@ -1493,6 +1494,62 @@ static inline int can_use_console(unsigned int cpu)
 	return cpu_online(cpu) || have_callable_console();
 }
 
+/*
+ * With printk.synchronous=0 printk() only stores the message and wakes
+ * printk_kthread, which feeds the consoles. Slow serial consoles then no
+ * longer stall whoever happens to be logging. Printing falls back to the
+ * caller while oopsing, before the kthread exists and outside of normal
+ * system operation, so that nothing is lost on panic or shutdown.
+ */
+static bool __read_mostly printk_sync = true;
+module_param_named(synchronous, printk_sync, bool, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(synchronous, "make printing to console synchronous");
+
+static struct task_struct *printk_kthread;
+static bool printk_kthread_need_flush;
+
+static inline bool can_printk_async(void)
+{
+	return !printk_sync && printk_kthread && !oops_in_progress &&
+		system_state == SYSTEM_RUNNING;
+}
+
+static int printk_kthread_func(void *data)
+{
+	while (1) {
+		set_current_state(TASK_INTERRUPTIBLE);
+		if (!printk_kthread_need_flush)
+			schedule();
+		__set_current_state(TASK_RUNNING);
+
+		/*
+		 * Clear the flag before taking the console: console_unlock()
+		 * rechecks for new records, so anything stored after this
+		 * point is either printed in this pass or sets the flag again.
+		 */
+		printk_kthread_need_flush = false;
+		console_lock();
+		console_unlock();
+	}
+
+	return 0;
+}
+
+static int __init printk_kthread_init(void)
+{
+	struct task_struct *task;
+
+	task = kthread_run(printk_kthread_func, NULL, "printk");
+	if (IS_ERR(task)) {
+		pr_err("printk: unable to create printing thread\n");
+		return PTR_ERR(task);
+	}
+	printk_kthread = task;
+
+	return 0;
+}
+late_initcall(printk_kthread_init);
+
 /*
  * Try to get console ownership to actually show the kernel
  * messages from a 'printk'. Return true (and with the
@@ -1789,7 +1846,10 @@ asmlinkage int vprintk_emit(int facility, int level,
 	local_irq_restore(flags);
 
 	/* If called from the scheduler, we can not call up(). */
-	if (!in_sched) {
+	if (!in_sched && can_printk_async()) {
+		printk_kthread_need_flush = true;
+		wake_up_process(printk_kthread);
+	} else if (!in_sched) {
 		lockdep_off();
 		/*
 		 * Disable preemption to avoid being preempted while holding
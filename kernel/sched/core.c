@@ -79,6 +79,8 @@
 #include <linux/syscore_ops.h>
 #include <linux/list_sort.h>
 #include <linux/prefetch.h>
+#include <linux/sched/core_ctl.h>
+#include <linux/sched_energy.h>
 
 #include <asm/switch_to.h>
 #include <asm/tlb.h>
@@ -2063,7 +2065,7 @@ void check_for_freq_change(struct rq *rq, bool check_pred, bool check_groups)
 		return;
 
 	atomic_notifier_call_chain(
-		&load_alert_notifier_head, 0,
+		&load_alert_notifier_head, SCHED_LOAD_ALERT,
 		(void *)(long)cpu);
 }
 
@@ -2292,11 +2294,12 @@ static inline u32 calc_pred_demand(struct rq *rq, struct task_struct *p)
 /*
  * predictive demand of a task is calculated at the window roll-over.
  * if the task current window busy time exceeds the predicted
- * demand, update it here to reflect the task needs.
+ * demand, update it here to reflect the task needs. With the
+ * WINDOW_STATS_PREDICT policy the demand is raised along with it.
  */
 void update_task_pred_demand(struct rq *rq, struct task_struct *p, int event)
 {
-	u32 new, old;
+	u32 new, old, demand;
 
 	if (is_idle_task(p) || exiting_task(p))
 		return;
@@ -2322,20 +2325,185 @@ void update_task_pred_demand(struct rq *rq, struct task_struct *p, int event)
 	if (old >= new)
 		return;
 
+	demand = p->ravg.demand;
+	if (sched_window_stats_policy == WINDOW_STATS_PREDICT)
+		demand = max(demand, new);
+
 	if (task_on_rq_queued(p) && (!task_has_dl_policy(p) ||
 				!p->dl.dl_throttled))
-		p->sched_class->fixup_hmp_sched_stats(rq, p,
-				p->ravg.demand,
-				new);
+		p->sched_class->fixup_hmp_sched_stats(rq, p, demand, new);
 
+	p->ravg.demand = demand;
 	p->ravg.pred_demand = new;
 }
 
+static inline int load_to_index(u32 load)
+{
+	u32 index = load / (sched_ravg_window / NUM_LOAD_INDICES);
+
+	return min_t(u32, index, NUM_LOAD_INDICES - 1);
+}
+
+static inline void top_tasks_inc(struct rq *rq, int table, int index)
+{
+	if (++rq->top_tasks[table][index] == 1)
+		__set_bit(NUM_LOAD_INDICES - index - 1,
+			  rq->top_tasks_bitmap[table]);
+}
+
+static inline void top_tasks_dec(struct rq *rq, int table, int index)
+{
+	if (!--rq->top_tasks[table][index])
+		__clear_bit(NUM_LOAD_INDICES - index - 1,
+			    rq->top_tasks_bitmap[table]);
+}
+
+/* Index of the heaviest non-empty bucket in @table, 0 if it is empty */
+static int get_top_index(struct rq *rq, int table)
+{
+	int bit = find_first_bit(rq->top_tasks_bitmap[table],
+				 NUM_LOAD_INDICES);
+
+	if (bit >= NUM_LOAD_INDICES)
+		return 0;
+	return NUM_LOAD_INDICES - 1 - bit;
+}
+
+static void clear_top_tasks_table(struct rq *rq, int table)
+{
+	memset(rq->top_tasks[table], 0, sizeof(rq->top_tasks[table]));
+	bitmap_zero(rq->top_tasks_bitmap[table], NUM_LOAD_INDICES);
+}
+
+static void reset_top_tasks(struct rq *rq)
+{
+	clear_top_tasks_table(rq, 0);
+	clear_top_tasks_table(rq, 1);
+	rq->curr_table = 0;
+	rq->prev_top = rq->curr_top = 0;
+}
+
+static void rollover_top_tasks(struct rq *rq, bool full_window)
+{
+	int curr = rq->curr_table;
+	int prev = 1 - curr;
+	int curr_top = rq->curr_top;
+
+	clear_top_tasks_table(rq, prev);
+
+	if (full_window) {
+		curr_top = 0;
+		clear_top_tasks_table(rq, curr);
+	}
+
+	rq->curr_table = prev;
+	rq->prev_top = curr_top;
+	rq->curr_top = 0;
+}
+
+/*
+ * Move @p's entries in the top task tables of its cpu to reflect its new
+ * curr/prev_window, given its curr_window before the update.
+ */
+static void update_top_tasks(struct task_struct *p, struct rq *rq,
+			     u32 old_curr_window, bool new_window,
+			     bool full_window)
+{
+	int curr = rq->curr_table;
+	int prev = 1 - curr;
+	u32 curr_window = p->ravg.curr_window;
+	u32 prev_window = p->ravg.prev_window;
+	int old_index, new_index, prev_index;
+
+	if (old_curr_window == curr_window && !new_window)
+		return;
+
+	old_index = load_to_index(old_curr_window);
+	new_index = load_to_index(curr_window);
+
+	if (!new_window) {
+		if (old_curr_window)
+			top_tasks_dec(rq, curr, old_index);
+		if (curr_window) {
+			top_tasks_inc(rq, curr, new_index);
+			rq->curr_top = max(rq->curr_top, new_index);
+		}
+		return;
+	}
+
+	/*
+	 * The window rolled over for @p, so its old curr_window entry now
+	 * lives in the prev table, unless a full window elapsed and the
+	 * tables got cleared.
+	 */
+	if (!full_window && old_curr_window)
+		top_tasks_dec(rq, prev, old_index);
+	if (prev_window) {
+		prev_index = load_to_index(prev_window);
+		top_tasks_inc(rq, prev, prev_index);
+		rq->prev_top = max(rq->prev_top, prev_index);
+	}
+	if (curr_window) {
+		top_tasks_inc(rq, curr, new_index);
+		rq->curr_top = max(rq->curr_top, new_index);
+	}
+}
+
+static void migrate_top_tasks(struct task_struct *p, struct rq *src_rq,
+			      struct rq *dst_rq)
+{
+	u32 curr_window = p->ravg.curr_window;
+	u32 prev_window = p->ravg.prev_window;
+	int src, dst, index;
+
+	if (curr_window) {
+		src = src_rq->curr_table;
+		dst = dst_rq->curr_table;
+		index = load_to_index(curr_window);
+
+		top_tasks_dec(src_rq, src, index);
+		top_tasks_inc(dst_rq, dst, index);
+		dst_rq->curr_top = max(dst_rq->curr_top, index);
+		if (index == src_rq->curr_top)
+			src_rq->curr_top = get_top_index(src_rq, src);
+	}
+
+	if (prev_window) {
+		src = 1 - src_rq->curr_table;
+		dst = 1 - dst_rq->curr_table;
+		index = load_to_index(prev_window);
+
+		top_tasks_dec(src_rq, src, index);
+		top_tasks_inc(dst_rq, dst, index);
+		dst_rq->prev_top = max(dst_rq->prev_top, index);
+		if (index == src_rq->prev_top)
+			src_rq->prev_top = get_top_index(src_rq, src);
+	}
+}
+
+/*
+ * Busy time of the heaviest task on @rq in the last window, with the
+ * resolution of a load bucket.  Unlike prev_runnable_sum it is not
+ * inflated by many small tasks.
+ */
+static u64 top_task_load(struct rq *rq)
+{
+	int prev = 1 - rq->curr_table;
+	int index = rq->prev_top;
+
+	if (!index && !test_bit(NUM_LOAD_INDICES - 1,
+				rq->top_tasks_bitmap[prev]))
+		return 0;
+	if (index == NUM_LOAD_INDICES - 1)
+		return sched_ravg_window;
+	return (u64)(index + 1) * (sched_ravg_window / NUM_LOAD_INDICES);
+}
+
 /*
  * Account cpu activity in its busy time counters (rq->curr/prev_runnable_sum)
  */
-static void update_cpu_busy_time(struct task_struct *p, struct rq *rq,
-				 int event, u64 wallclock, u64 irqtime)
+static void __update_cpu_busy_time(struct task_struct *p, struct rq *rq,
+				   int event, u64 wallclock, u64 irqtime)
 {
 	int new_window, full_window = 0;
 	int p_is_curr_task = (p == rq->curr);
@@ -2606,6 +2774,24 @@ static void update_cpu_busy_time(struct task_struct *p, struct rq *rq,
 	BUG();
 }
 
+static void update_cpu_busy_time(struct task_struct *p, struct rq *rq,
+				 int event, u64 wallclock, u64 irqtime)
+{
+	u32 old_curr_window = p->ravg.curr_window;
+	bool new_window = p->ravg.mark_start < rq->window_start;
+	bool full_window = new_window &&
+		rq->window_start - p->ravg.mark_start >= sched_ravg_window;
+
+	if (new_window && p == rq->curr)
+		rollover_top_tasks(rq, full_window);
+
+	__update_cpu_busy_time(p, rq, event, wallclock, irqtime);
+
+	if (!is_idle_task(p) && !exiting_task(p))
+		update_top_tasks(p, rq, old_curr_window, new_window,
+				 full_window);
+}
+
 static inline u32 predict_and_update_buckets(struct rq *rq,
 			struct task_struct *p, u32 runtime) {
 
@@ -2843,6 +3029,7 @@ static void update_history(struct rq *rq, struct task_struct *p,
 	}
 
 	p->ravg.sum = 0;
+	pred_demand = predict_and_update_buckets(rq, p, runtime);
 
 	if (sched_window_stats_policy == WINDOW_STATS_RECENT) {
 		demand = runtime;
@@ -2852,10 +3039,11 @@ static void update_history(struct rq *rq, struct task_struct *p,
 		avg = div64_u64(sum, sched_ravg_hist_size);
 		if (sched_window_stats_policy == WINDOW_STATS_AVG)
 			demand = avg;
+		else if (sched_window_stats_policy == WINDOW_STATS_PREDICT)
+			demand = max(avg, pred_demand);
 		else
 			demand = max(avg, runtime);
 	}
-	pred_demand = predict_and_update_buckets(rq, p, runtime);
 
 	/*
 	 * A throttled deadline sched class task gets dequeued without
@@ -3114,6 +3302,7 @@ static inline void set_window_start(struct rq *rq)
 #ifdef CONFIG_SCHED_FREQ_INPUT
 		rq->curr_runnable_sum = rq->prev_runnable_sum = 0;
 		rq->nt_curr_runnable_sum = rq->nt_prev_runnable_sum = 0;
+		reset_top_tasks(rq);
 #endif
 		raw_spin_unlock(&sync_rq->lock);
 	}
@@ -3251,6 +3440,7 @@ void reset_all_window_stats(u64 window_start, unsigned int window_size)
 #ifdef CONFIG_SCHED_FREQ_INPUT
 		rq->curr_runnable_sum = rq->prev_runnable_sum = 0;
 		rq->nt_curr_runnable_sum = rq->nt_prev_runnable_sum = 0;
+		reset_top_tasks(rq);
 #endif
 		reset_cpu_hmp_stats(cpu, 1);
 	}
@@ -3302,7 +3492,7 @@ void sched_get_cpus_busy(struct sched_load *busy,
 	const int cpus = cpumask_weight(query_cpus);
 	u64 load[cpus], group_load[cpus];
 	u64 nload[cpus], ngload[cpus];
-	u64 pload[cpus];
+	u64 pload[cpus], tload[cpus];
 	unsigned int cur_freq[cpus], max_freq[cpus];
 	int notifier_sent[cpus];
 	int early_detection[cpus];
@@ -3341,6 +3531,7 @@ void sched_get_cpus_busy(struct sched_load *busy,
 		nload[i] = rq->nt_prev_runnable_sum;
 		pload[i] = rq->hmp_stats.pred_demands_sum;
 		rq->old_estimated_time = pload[i];
+		tload[i] = top_task_load(rq);
 
 		if (load[i] > max_prev_sum) {
 			max_prev_sum = load[i];
@@ -3401,6 +3592,7 @@ void sched_get_cpus_busy(struct sched_load *busy,
 		load[i] = scale_load_to_cpu(load[i], cpu);
 		nload[i] = scale_load_to_cpu(nload[i], cpu);
 		pload[i] = scale_load_to_cpu(pload[i], cpu);
+		tload[i] = scale_load_to_cpu(tload[i], cpu);
 skip_early:
 		i++;
 	}
@@ -3419,6 +3611,7 @@ skip_early:
 			busy[i].prev_load = div64_u64(sched_ravg_window,
 							NSEC_PER_USEC);
 			busy[i].new_task_load = 0;
+			busy[i].top_task_load = 0;
 			goto exit_early;
 		}
 
@@ -3434,20 +3627,28 @@ skip_early:
 						    cpu_max_possible_freq(cpu));
 			nload[i] = scale_load_to_freq(nload[i], max_freq[i],
 						    cpu_max_possible_freq(cpu));
+			tload[i] = scale_load_to_freq(tload[i], max_freq[i],
+						    cpu_max_possible_freq(cpu));
 		} else {
 			load[i] = scale_load_to_freq(load[i], max_freq[i],
 						     cur_freq[i]);
 			nload[i] = scale_load_to_freq(nload[i], max_freq[i],
 						      cur_freq[i]);
+			tload[i] = scale_load_to_freq(tload[i], max_freq[i],
+						      cur_freq[i]);
 			if (load[i] > window_size)
 				load[i] = window_size;
 			if (nload[i] > window_size)
 				nload[i] = window_size;
+			if (tload[i] > window_size)
+				tload[i] = window_size;
 
 			load[i] = scale_load_to_freq(load[i], cur_freq[i],
 						    cpu_max_possible_freq(cpu));
 			nload[i] = scale_load_to_freq(nload[i], cur_freq[i],
 						    cpu_max_possible_freq(cpu));
+			tload[i] = scale_load_to_freq(tload[i], cur_freq[i],
+						    cpu_max_possible_freq(cpu));
 		}
 		pload[i] = scale_load_to_freq(pload[i], max_freq[i],
 					     rq->cluster->max_possible_freq);
@@ -3455,6 +3656,7 @@ skip_early:
 		busy[i].prev_load = div64_u64(load[i], NSEC_PER_USEC);
 		busy[i].new_task_load = div64_u64(nload[i], NSEC_PER_USEC);
 		busy[i].predicted_load = div64_u64(pload[i], NSEC_PER_USEC);
+		busy[i].top_task_load = div64_u64(tload[i], NSEC_PER_USEC);
 
 exit_early:
 		trace_sched_get_busy(cpu, busy[i].prev_load,
@@ -3470,6 +3672,32 @@ void sched_set_io_is_busy(int val)
 	sched_io_is_busy = val;
 }
 
+/*
+ * Report how long it is until the current load tracking window rolls
+ * over, so that periodic samplers outside the scheduler can align their
+ * sampling with the windows.
+ */
+int sched_get_window_remaining(u64 *remaining_ns, unsigned int *window_ns)
+{
+	struct rq *rq = cpu_rq(raw_smp_processor_id());
+	u64 now, ws, delta;
+
+	if (sched_use_pelt)
+		return -EINVAL;
+
+	now = sched_ktime_clock();
+	ws = ACCESS_ONCE(rq->window_start);
+	if (!ws || now < ws)
+		return -EAGAIN;
+
+	div64_u64_rem(now - ws, sched_ravg_window, &delta);
+	*remaining_ns = sched_ravg_window - delta;
+	*window_ns = sched_ravg_window;
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(sched_get_window_remaining);
+
 int sched_set_window(u64 window_start, unsigned int window_size)
 {
 	u64 now, cur_jiffies, jiffy_ktime_ns;
@@ -3552,6 +3780,8 @@ static void fixup_busy_time(struct task_struct *p, int new_cpu)
 
 	update_task_cpu_cycles(p, new_cpu);
 
+	migrate_top_tasks(p, src_rq, dest_rq);
+
 	new_task = is_new_task(p);
 	/* Protected by rq_lock */
 	grp = p->grp;
@@ -4559,6 +4789,7 @@ static int __set_cpus_allowed_ptr(struct task_struct *p,
 	unsigned long flags;
 	struct rq *rq;
 	unsigned int dest_cpu;
+	cpumask_t allowed_mask;
 	int ret = 0;
 
 	rq = task_rq_lock(p, &flags);
@@ -4575,10 +4806,14 @@ static int __set_cpus_allowed_ptr(struct task_struct *p,
 	if (cpumask_equal(&p->cpus_allowed, new_mask))
 		goto out;
 
-	dest_cpu = cpumask_any_and(cpu_active_mask, new_mask);
+	cpumask_andnot(&allowed_mask, new_mask, cpu_isolated_mask);
+	dest_cpu = cpumask_any_and(cpu_active_mask, &allowed_mask);
 	if (dest_cpu >= nr_cpu_ids) {
-		ret = -EINVAL;
-		goto out;
+		dest_cpu = cpumask_any_and(cpu_active_mask, new_mask);
+		if (dest_cpu >= nr_cpu_ids) {
+			ret = -EINVAL;
+			goto out;
+		}
 	}
 
 	do_set_cpus_allowed(p, new_mask);
@@ -4893,6 +5128,7 @@ static int select_fallback_rq(int cpu, struct task_struct *p)
 	int nid = cpu_to_node(cpu);
 	const struct cpumask *nodemask = NULL;
 	enum { cpuset, possible, fail } state = cpuset;
+	bool allow_iso = false;
 	int dest_cpu;
 
 	/*
@@ -4909,6 +5145,8 @@ static int select_fallback_rq(int cpu, struct task_struct *p)
 				continue;
 			if (!cpu_active(dest_cpu))
 				continue;
+			if (cpu_isolated(dest_cpu))
+				continue;
 			if (cpumask_test_cpu(dest_cpu, tsk_cpus_allowed(p)))
 				return dest_cpu;
 		}
@@ -4919,10 +5157,21 @@ static int select_fallback_rq(int cpu, struct task_struct *p)
 		for_each_cpu(dest_cpu, tsk_cpus_allowed(p)) {
 			if (!is_cpu_allowed(p, dest_cpu))
 				continue;
+			if (!allow_iso && cpu_isolated(dest_cpu))
+				continue;
 
 			goto out;
 		}
 
+		/*
+		 * An isolated CPU is still online, prefer it over breaking
+		 * the affinity of the task.
+		 */
+		if (!allow_iso) {
+			allow_iso = true;
+			continue;
+		}
+
 		switch (state) {
 		case cpuset:
 			/* No more Mr. Nice Guy. */
@@ -4976,7 +5225,7 @@ int select_task_rq(struct task_struct *p, int cpu, int sd_flags, int wake_flags)
 	 *   not worry about this generic constraint ]
 	 */
 	if (unlikely(!cpumask_test_cpu(cpu, tsk_cpus_allowed(p)) ||
-		     !cpu_online(cpu)))
+		     !cpu_online(cpu) || cpu_isolated(cpu)))
 		cpu = select_fallback_rq(task_cpu(p), p);
 
 	return cpu;
@@ -5056,6 +5305,7 @@ ttwu_do_wakeup(struct rq *rq, struct task_struct *p, int wake_flags)
 {
 	check_preempt_curr(rq, p, wake_flags);
 	trace_sched_wakeup(p, true);
+	sched_latmon_wakeup(rq, p);
 
 	p->state = TASK_RUNNING;
 #ifdef CONFIG_SMP
@@ -6338,6 +6588,27 @@ static bool early_detection_notify(struct rq *rq, u64 wallclock)
 }
 #endif /* CONFIG_SCHED_HMP */
 
+#ifdef CONFIG_SCHED_HMP
+/*
+ * Has @rq moved into a window that has not been reported yet? The window
+ * may have been rolled over by the tick or by any earlier __schedule()
+ * or wakeup. Called with rq->lock held.
+ */
+static inline bool sched_window_rollover(struct rq *rq)
+{
+	if (rq->window_start == rq->last_notified_window_start)
+		return false;
+
+	rq->last_notified_window_start = rq->window_start;
+	return true;
+}
+#else
+static inline bool sched_window_rollover(struct rq *rq)
+{
+	return false;
+}
+#endif
+
 /*
  * This function gets called by the timer code, with HZ frequency.
  * We call it with interrupts disabled.
@@ -6348,7 +6619,7 @@ void scheduler_tick(void)
 	struct rq *rq = cpu_rq(cpu);
 	struct task_struct *curr = rq->curr;
 	u64 wallclock;
-	bool early_notif;
+	bool early_notif, window_rollover;
 	u32 old_load;
 	struct related_thread_group *grp;
 
@@ -6364,11 +6635,16 @@ void scheduler_tick(void)
 	wallclock = sched_ktime_clock();
 	update_task_ravg(rq->curr, rq, TASK_UPDATE, wallclock, 0);
 	early_notif = early_detection_notify(rq, wallclock);
+	window_rollover = sched_window_rollover(rq);
 	raw_spin_unlock(&rq->lock);
 
 	if (early_notif)
 		atomic_notifier_call_chain(&load_alert_notifier_head,
-					0, (void *)(long)cpu);
+					SCHED_LOAD_ALERT, (void *)(long)cpu);
+
+	if (window_rollover)
+		atomic_notifier_call_chain(&load_alert_notifier_head,
+				SCHED_WINDOW_ROLLOVER, (void *)(long)cpu);
 
 	perf_event_task_tick();
 
@@ -6378,6 +6654,8 @@ void scheduler_tick(void)
 #endif
 	rq_last_tick_reset(rq);
 
+	core_ctl_check();
+
 	rcu_read_lock();
 	grp = task_related_thread_group(curr);
 	if (update_preferred_cluster(grp, curr, old_load))
@@ -6681,6 +6959,8 @@ need_resched:
 		++*switch_count;
 
 		set_task_last_switch_out(prev, wallclock);
+		sched_latmon_switch(rq, next);
+		sched_pmu_switch(prev);
 
 		context_switch(rq, prev, next); /* unlocks the rq */
 		/*
@@ -8714,13 +8994,20 @@ static struct task_struct fake_task = {
  * Called with rq->lock held even though we'er in stop_machine() and
  * there's no concurrency possible, we hold the required locks anyway
  * because of lock validation efforts.
+ *
+ * When isolating a cpu, @migrate_pinned_tasks is false and tasks which
+ * cannot run anywhere else are left on the rq.
  */
-static void migrate_tasks(unsigned int dead_cpu)
+static void migrate_tasks(unsigned int dead_cpu, bool migrate_pinned_tasks)
 {
 	struct rq *rq = cpu_rq(dead_cpu);
-	struct task_struct *next, *stop = rq->stop;
+	struct task_struct *next, *tmp, *stop = rq->stop;
+	LIST_HEAD(pinned_tasks);
+	cpumask_t avail_cpus;
 	int dest_cpu;
 
+	cpumask_andnot(&avail_cpus, cpu_online_mask, cpu_isolated_mask);
+
 	/*
 	 * Fudge the rq selection such that the below task selection loop
 	 * doesn't get stuck on the currently eligible stop task.
@@ -8751,6 +9038,18 @@ static void migrate_tasks(unsigned int dead_cpu)
 		BUG_ON(!next);
 		next->sched_class->put_prev_task(rq, next);
 
+		/*
+		 * Park the pinned tasks off the rq so that they are not
+		 * picked again, and put them back once we're done.
+		 */
+		if (!migrate_pinned_tasks && (is_per_cpu_kthread(next) ||
+		    !cpumask_intersects(&avail_cpus, tsk_cpus_allowed(next)))) {
+			dequeue_task(rq, next, DEQUEUE_SAVE);
+			next->on_rq = TASK_ON_RQ_MIGRATING;
+			list_add(&next->se.group_node, &pinned_tasks);
+			continue;
+		}
+
 		/* Find suitable destination for @next, with force if needed. */
 		dest_cpu = select_fallback_rq(dead_cpu, next);
 		raw_spin_unlock(&rq->lock);
@@ -8760,8 +9059,98 @@ static void migrate_tasks(unsigned int dead_cpu)
 		raw_spin_lock(&rq->lock);
 	}
 
+	list_for_each_entry_safe(next, tmp, &pinned_tasks, se.group_node) {
+		list_del_init(&next->se.group_node);
+		next->on_rq = TASK_ON_RQ_QUEUED;
+		enqueue_task(rq, next, ENQUEUE_RESTORE);
+	}
+
 	rq->stop = stop;
 }
+
+static DEFINE_MUTEX(cpu_isolation_lock);
+
+static int do_isolation_work_cpu_stop(void *data)
+{
+	unsigned int cpu = smp_processor_id();
+	struct rq *rq = cpu_rq(cpu);
+
+	local_irq_disable();
+	raw_spin_lock(&rq->lock);
+	migrate_tasks(cpu, false);
+	raw_spin_unlock(&rq->lock);
+	local_irq_enable();
+
+	return 0;
+}
+
+/**
+ * sched_isolate_cpu - take a cpu out of the scheduler while keeping it online
+ * @cpu: the cpu to isolate
+ *
+ * The cpu is removed from the sched domains so that it is neither used
+ * by load balancing nor picked at wakeup, and the tasks queued on it
+ * are pushed to the other online cpus. Per-cpu kthreads and tasks that
+ * are only allowed on isolated cpus keep running there.  Unlike a cpu
+ * offline this does not go through the hotplug notifiers, so it is
+ * cheap to undo with sched_unisolate_cpu().
+ *
+ * Returns 0 on success or -EINVAL if @cpu is offline or is the last
+ * cpu available to the scheduler.
+ */
+int sched_isolate_cpu(int cpu)
+{
+	cpumask_t avail_cpus;
+	int ret = 0;
+
+	mutex_lock(&cpu_isolation_lock);
+	cpu_maps_update_begin();
+
+	if (!cpu_online(cpu)) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	if (cpu_isolated(cpu))
+		goto out;
+
+	cpumask_andnot(&avail_cpus, cpu_online_mask, cpu_isolated_mask);
+	cpumask_clear_cpu(cpu, &avail_cpus);
+	if (cpumask_empty(&avail_cpus)) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	set_cpu_isolated(cpu, true);
+	rebuild_sched_domains();
+	stop_one_cpu(cpu, do_isolation_work_cpu_stop, NULL);
+out:
+	cpu_maps_update_done();
+	mutex_unlock(&cpu_isolation_lock);
+	return ret;
+}
+
+/**
+ * sched_unisolate_cpu - give an isolated cpu back to the scheduler
+ * @cpu: the cpu to unisolate
+ *
+ * Returns 0 on success, or if @cpu was not isolated.
+ */
+int sched_unisolate_cpu(int cpu)
+{
+	mutex_lock(&cpu_isolation_lock);
+	cpu_maps_update_begin();
+
+	if (cpu_isolated(cpu)) {
+		set_cpu_isolated(cpu, false);
+		if (cpu_online(cpu))
+			rebuild_sched_domains();
+	}
+
+	cpu_maps_update_done();
+	mutex_unlock(&cpu_isolation_lock);
+	return 0;
+}
 #endif /* CONFIG_HOTPLUG_CPU */
 
 #if defined(CONFIG_SCHED_DEBUG) && defined(CONFIG_SYSCTL)
@@ -9014,7 +9403,7 @@ migration_call(struct notifier_block *nfb, unsigned long action, void *hcpu)
 			BUG_ON(!cpumask_test_cpu(cpu, rq->rd->span));
 			set_rq_offline(rq);
 		}
-		migrate_tasks(cpu);
+		migrate_tasks(cpu, true);
 		BUG_ON(rq->nr_running != 1); /* the migration thread */
 		raw_spin_unlock_irqrestore(&rq->lock, flags);
 		break;
@@ -9022,6 +9411,7 @@ migration_call(struct notifier_block *nfb, unsigned long action, void *hcpu)
 	case CPU_DEAD:
 		clear_hmp_request(cpu);
 		calc_load_migrate(rq);
+		set_cpu_isolated(cpu, false);
 		break;
 #endif
 	}
@@ -10604,6 +10994,10 @@ void partition_sched_domains(int ndoms_new, cpumask_var_t doms_new[],
 
 	mutex_lock(&sched_domains_mutex);
 
+	/* Isolated cpus stay online but are kept out of every domain */
+	for (i = 0; doms_new && i < ndoms_new; i++)
+		cpumask_andnot(doms_new[i], doms_new[i], cpu_isolated_mask);
+
 	/* always unregister in case we don't destroy any domains */
 	unregister_sched_domain_sysctl();
 
@@ -10630,6 +11024,7 @@ match1:
 		n = 0;
 		doms_new = &fallback_doms;
 		cpumask_andnot(doms_new[0], cpu_active_mask, cpu_isolated_map);
+		cpumask_andnot(doms_new[0], doms_new[0], cpu_isolated_mask);
 		WARN_ON_ONCE(dattr_new);
 	}
 
@@ -10762,6 +11157,7 @@ void __init sched_init_smp(void)
 	hotcpu_notifier(cpuset_cpu_active, CPU_PRI_CPUSET_ACTIVE);
 	hotcpu_notifier(cpuset_cpu_inactive, CPU_PRI_CPUSET_INACTIVE);
 
+	init_sched_energy_costs();
 	update_cluster_topology();
 
 	init_hrtick();
@@ -11803,6 +12199,49 @@ static int cpu_upmigrate_discourage_write_u64(struct cgroup_subsys_state *css,
 	return 0;
 }
 
+static u64 cpu_prefer_idle_read_u64(struct cgroup_subsys_state *css,
+				    struct cftype *cft)
+{
+	struct task_group *tg = css_tg(css);
+
+	return tg->prefer_idle;
+}
+
+static int cpu_prefer_idle_write_u64(struct cgroup_subsys_state *css,
+				     struct cftype *cft, u64 prefer_idle)
+{
+	struct task_group *tg = css_tg(css);
+
+	tg->prefer_idle = prefer_idle > 0;
+
+	return 0;
+}
+
+static u64 cpu_min_capacity_read_u64(struct cgroup_subsys_state *css,
+				     struct cftype *cft)
+{
+	struct task_group *tg = css_tg(css);
+
+	return tg->min_capacity;
+}
+
+/*
+ * Tasks of the group are only woken on clusters whose capacity is at
+ * least this percentage of the most capable cluster.
+ */
+static int cpu_min_capacity_write_u64(struct cgroup_subsys_state *css,
+				      struct cftype *cft, u64 min_capacity)
+{
+	struct task_group *tg = css_tg(css);
+
+	if (min_capacity > 100)
+		return -EINVAL;
+
+	tg->min_capacity = min_capacity;
+
+	return 0;
+}
+
 #endif	/* CONFIG_SCHED_HMP */
 
 #ifdef CONFIG_FAIR_GROUP_SCHED
@@ -12110,6 +12549,16 @@ static struct cftype cpu_files[] = {
 		.read_u64 = cpu_upmigrate_discourage_read_u64,
 		.write_u64 = cpu_upmigrate_discourage_write_u64,
 	},
+	{
+		.name = "prefer_idle",
+		.read_u64 = cpu_prefer_idle_read_u64,
+		.write_u64 = cpu_prefer_idle_write_u64,
+	},
+	{
+		.name = "min_capacity",
+		.read_u64 = cpu_min_capacity_read_u64,
+		.write_u64 = cpu_min_capacity_write_u64,
+	},
 #endif
 #ifdef CONFIG_FAIR_GROUP_SCHED
 	{
@@ -19,6 +19,7 @@
 #include <linux/kthread.h>
 #include <linux/sched.h>
 #include <linux/sched/rt.h>
+#include <linux/sched/core_ctl.h>
 #include <linux/mutex.h>
 
 #include <trace/events/sched.h>
@@ -51,6 +52,7 @@ struct cluster_data {
 	spinlock_t pending_lock;
 	bool is_big_cluster;
 	int nrrun;
+	int nrrun_pred;
 	bool nrrun_changed;
 	struct timer_list timer;
 	struct task_struct *hotplug_thread;
@@ -58,6 +60,8 @@ struct cluster_data {
 	struct kobject kobj;
 	struct list_head pending_lru;
 	bool disabled;
+	bool isolation;
+	unsigned int nr_isolated_cpus;
 };
 
 struct cpu_data {
@@ -71,6 +75,7 @@ struct cpu_data {
 	struct list_head sib;
 	struct list_head pending_sib;
 	bool always_online_cpu;
+	bool isolated_by_us;
 };
 
 static DEFINE_PER_CPU(struct cpu_data, cpu_state);
@@ -89,6 +94,15 @@ static void wake_up_hotplug_thread(struct cluster_data *state);
 static void add_to_pending_lru(struct cpu_data *state);
 static void update_lru(struct cluster_data *cluster);
 
+/*
+ * In isolation mode the cpus that are not needed stay online and are
+ * only isolated, so count the cpus the scheduler can actually use.
+ */
+static unsigned int get_active_cpu_count(const struct cluster_data *cluster)
+{
+	return cluster->online_cpus - cluster->nr_isolated_cpus;
+}
+
 /* ========================= sysfs interface =========================== */
 
 static ssize_t store_min_cpus(struct cluster_data *state,
@@ -266,7 +280,8 @@ static ssize_t show_cpus(const struct cluster_data *state, char *buf)
 	list_for_each_entry(c, &state->lru, sib) {
 		count += snprintf(buf + count, PAGE_SIZE - count,
 				  "CPU%u (%s)\n", c->cpu,
-				  c->online ? "Online" : "Offline");
+				  !c->online ? "Offline" :
+				  c->isolated_by_us ? "Isolated" : "Online");
 	}
 	spin_unlock_irqrestore(&state_lock, flags);
 	return count;
@@ -282,6 +297,11 @@ static ssize_t show_online_cpus(const struct cluster_data *state, char *buf)
 	return snprintf(buf, PAGE_SIZE, "%u\n", state->online_cpus);
 }
 
+static ssize_t show_active_cpus(const struct cluster_data *state, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%u\n", get_active_cpu_count(state));
+}
+
 static ssize_t show_global_state(const struct cluster_data *state, char *buf)
 {
 	struct cpu_data *c;
@@ -301,6 +321,8 @@ static ssize_t show_global_state(const struct cluster_data *state, char *buf)
 					"\tCPU: %u\n", c->cpu);
 		count += snprintf(buf + count, PAGE_SIZE - count,
 					"\tOnline: %u\n", c->online);
+		count += snprintf(buf + count, PAGE_SIZE - count,
+					"\tIsolated: %u\n", c->isolated_by_us);
 		count += snprintf(buf + count, PAGE_SIZE - count,
 					"\tRejected: %u\n", c->rejected);
 		count += snprintf(buf + count, PAGE_SIZE - count,
@@ -312,6 +334,9 @@ static ssize_t show_global_state(const struct cluster_data *state, char *buf)
 					"\tIs busy: %u\n", c->is_busy);
 		count += snprintf(buf + count, PAGE_SIZE - count,
 					"\tNr running: %u\n", cluster->nrrun);
+		count += snprintf(buf + count, PAGE_SIZE - count,
+				"\tPredicted nr running: %u\n",
+				cluster->nrrun_pred);
 		count += snprintf(buf + count, PAGE_SIZE - count,
 			"\tAvail CPUs: %u\n", cluster->avail_cpus);
 		count += snprintf(buf + count, PAGE_SIZE - count,
@@ -388,6 +413,30 @@ static ssize_t show_disable(const struct cluster_data *state, char *buf)
 	return snprintf(buf, PAGE_SIZE, "%u\n", state->disabled);
 }
 
+static ssize_t store_isolation(struct cluster_data *state,
+				const char *buf, size_t count)
+{
+	unsigned int val;
+
+	if (sscanf(buf, "%u\n", &val) != 1)
+		return -EINVAL;
+
+	val = !!val;
+
+	if (state->isolation == val)
+		return count;
+
+	state->isolation = val;
+	wake_up_hotplug_thread(state);
+
+	return count;
+}
+
+static ssize_t show_isolation(const struct cluster_data *state, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%u\n", state->isolation);
+}
+
 static ssize_t show_always_online_cpu(const struct cluster_data *state, char *buf)
 {
 	struct cpu_data *c;
@@ -453,10 +502,12 @@ core_ctl_attr_rw(is_big_cluster);
 core_ctl_attr_ro(cpus);
 core_ctl_attr_ro(need_cpus);
 core_ctl_attr_ro(online_cpus);
+core_ctl_attr_ro(active_cpus);
 core_ctl_attr_ro(global_state);
 core_ctl_attr_rw(not_preferred);
 core_ctl_attr_rw(disable);
 core_ctl_attr_rw(always_online_cpu);
+core_ctl_attr_rw(isolation);
 
 static struct attribute *default_attrs[] = {
 	&min_cpus.attr,
@@ -469,10 +520,12 @@ static struct attribute *default_attrs[] = {
 	&cpus.attr,
 	&need_cpus.attr,
 	&online_cpus.attr,
+	&active_cpus.attr,
 	&global_state.attr,
 	&not_preferred.attr,
 	&disable.attr,
 	&always_online_cpu.attr,
+	&isolation.attr,
 	NULL
 };
 
@@ -520,8 +573,22 @@ static struct kobj_type ktype_core_ctl = {
 static unsigned int rq_avg_period_ms = RQ_AVG_DEFAULT_MS;
 
 static s64 rq_avg_timestamp_ms;
+static unsigned long rq_avg_next_check;
 static struct timer_list rq_avg_timer;
 
+/*
+ * Extrapolate the nr_running trend over one more period, so that a
+ * ramp up brings cpus back now instead of one period later. A ramp
+ * down is not extrapolated and still goes through offline_delay_ms.
+ */
+static int predict_nrrun(int old_nrrun, int nrrun)
+{
+	if (nrrun > old_nrrun)
+		return nrrun + (nrrun - old_nrrun);
+
+	return nrrun;
+}
+
 static void update_running_avg(bool trigger_update)
 {
 	int avg, iowait_avg, big_avg, old_nrrun;
@@ -539,6 +606,8 @@ static void update_running_avg(bool trigger_update)
 		return;
 	}
 	rq_avg_timestamp_ms = now;
+	rq_avg_next_check = jiffies +
+		msecs_to_jiffies(rq_avg_period_ms - RQ_AVG_TOLERANCE);
 	sched_get_nr_running_avg(&avg, &iowait_avg, &big_avg,
 				 &max_nr, &big_max_nr);
 
@@ -549,6 +618,7 @@ static void update_running_avg(bool trigger_update)
 			continue;
 		old_nrrun = cluster->nrrun;
 		cluster->nrrun = cluster->is_big_cluster ? big_avg : avg;
+		cluster->nrrun_pred = predict_nrrun(old_nrrun, cluster->nrrun);
 		cluster->max_nr = cluster->is_big_cluster ? big_max_nr : max_nr;
 		if (cluster->nrrun != old_nrrun) {
 			if (trigger_update)
@@ -566,11 +636,11 @@ static unsigned int apply_task_need(const struct cluster_data *cluster,
 				    unsigned int new_need)
 {
 	/* Online all cores if there are enough tasks */
-	if (cluster->nrrun >= cluster->task_thres)
+	if (cluster->nrrun_pred >= cluster->task_thres)
 		return cluster->num_cpus;
 
 	/* only online more cores if there are tasks to run */
-	if (cluster->nrrun > new_need)
+	if (cluster->nrrun_pred > new_need)
 		new_need = new_need + 1;
 
 	/*
@@ -599,6 +669,21 @@ static void rq_avg_timer_func(unsigned long not_used)
 	mod_timer(&rq_avg_timer, round_to_nw_start());
 }
 
+/**
+ * core_ctl_check - sample the nr_running averages from the scheduler tick
+ *
+ * rq_avg_timer is deferrable and can be held off by idle cpus, so a load
+ * spike would otherwise wait for it before cpus are brought back. Called
+ * from scheduler_tick() once rq->lock has been dropped.
+ */
+void core_ctl_check(void)
+{
+	if (time_before(jiffies, ACCESS_ONCE(rq_avg_next_check)))
+		return;
+
+	update_running_avg(true);
+}
+
 /* ======================= load based core count  ====================== */
 
 static unsigned int apply_limits(const struct cluster_data *cluster,
@@ -620,7 +705,8 @@ static bool eval_need(struct cluster_data *cluster)
 		return 0;
 
 	spin_lock_irqsave(&state_lock, flags);
-	thres_idx = cluster->online_cpus ? cluster->online_cpus - 1 : 0;
+	thres_idx = get_active_cpu_count(cluster);
+	thres_idx = thres_idx ? thres_idx - 1 : 0;
 	list_for_each_entry(c, &cluster->lru, sib) {
 		if (c->busy >= cluster->busy_up_thres[thres_idx] ||
 			sched_cpu_high_irqload(c->cpu))
@@ -797,6 +883,106 @@ static void update_lru(struct cluster_data *cluster)
 	spin_unlock_irqrestore(&pending_lru_lock, flags);
 }
 
+static void move_cpu_lru(struct cpu_data *c)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&state_lock, flags);
+	list_del(&c->sib);
+	list_add_tail(&c->sib, &c->cluster->lru);
+	spin_unlock_irqrestore(&state_lock, flags);
+}
+
+static void try_to_isolate(struct cluster_data *cluster, unsigned int need,
+			   bool force)
+{
+	struct cpu_data *c, *tmp;
+	unsigned long flags;
+
+	list_for_each_entry_safe(c, tmp, &cluster->lru, sib) {
+		if (!c->online || c->isolated_by_us || c->always_online_cpu)
+			continue;
+
+		if (get_active_cpu_count(cluster) <= need)
+			break;
+
+		/* Don't isolate busy CPUs unless above max_cpus. */
+		if (!force && c->is_busy)
+			continue;
+
+		pr_debug("Trying to isolate CPU%u\n", c->cpu);
+		if (sched_isolate_cpu(c->cpu)) {
+			pr_debug("Unable to isolate CPU%u\n", c->cpu);
+			continue;
+		}
+
+		spin_lock_irqsave(&state_lock, flags);
+		c->isolated_by_us = true;
+		cluster->nr_isolated_cpus++;
+		spin_unlock_irqrestore(&state_lock, flags);
+		move_cpu_lru(c);
+	}
+}
+
+static void __try_to_unisolate(struct cluster_data *cluster,
+			       unsigned int need, bool not_preferred)
+{
+	struct cpu_data *c, *tmp;
+	unsigned long flags;
+
+	list_for_each_entry_safe(c, tmp, &cluster->lru, sib) {
+		if (c->not_preferred != not_preferred)
+			continue;
+
+		if (get_active_cpu_count(cluster) >= need)
+			break;
+
+		if (c->isolated_by_us) {
+			pr_debug("Trying to unisolate CPU%u\n", c->cpu);
+			sched_unisolate_cpu(c->cpu);
+
+			spin_lock_irqsave(&state_lock, flags);
+			c->isolated_by_us = false;
+			cluster->nr_isolated_cpus--;
+			spin_unlock_irqrestore(&state_lock, flags);
+			move_cpu_lru(c);
+		} else if (cluster->isolation && !c->online && !c->rejected) {
+			/* Left offline while in hotplug mode */
+			pr_debug("Trying to Online CPU%u\n", c->cpu);
+			if (core_ctl_online_core(c->cpu))
+				pr_debug("Unable to Online CPU%u\n", c->cpu);
+		}
+	}
+}
+
+static void try_to_unisolate(struct cluster_data *cluster, unsigned int need)
+{
+	__try_to_unisolate(cluster, need, false);
+	__try_to_unisolate(cluster, need, true);
+}
+
+/*
+ * Isolation keeps the unneeded cpus online, so bringing one back only
+ * needs its sched domains rebuilt instead of a full cpu_up().
+ */
+static void do_isolation(struct cluster_data *cluster, unsigned int need)
+{
+	unsigned int active_cpus = get_active_cpu_count(cluster);
+
+	if (active_cpus > need) {
+		try_to_isolate(cluster, need, false);
+
+		/*
+		 * If the number of active CPUs is within the limits, then
+		 * don't force any busy CPUs to be isolated.
+		 */
+		if (get_active_cpu_count(cluster) > cluster->max_cpus)
+			try_to_isolate(cluster, cluster->max_cpus, true);
+	} else if (active_cpus < need) {
+		try_to_unisolate(cluster, need);
+	}
+}
+
 static void __ref do_hotplug(struct cluster_data *cluster)
 {
 	unsigned int need;
@@ -806,6 +992,15 @@ static void __ref do_hotplug(struct cluster_data *cluster)
 	pr_debug("Trying to adjust group %u to %u\n", cluster->first_cpu, need);
 
 	mutex_lock(&lru_lock);
+	if (cluster->isolation) {
+		do_isolation(cluster, need);
+		goto done;
+	}
+
+	/* Isolation was just turned off, give the isolated CPUs back. */
+	if (cluster->nr_isolated_cpus)
+		try_to_unisolate(cluster, cluster->num_cpus);
+
 	if (cluster->online_cpus > need) {
 		list_for_each_entry_safe(c, tmp, &cluster->lru, sib) {
 			if (!c->online || c->always_online_cpu)
@@ -947,9 +1142,10 @@ static int __ref cpu_callback(struct notifier_block *nfb,
 		/*
 		 * If a CPU is in the process of coming up, mark it as online
 		 * so that there's no race with hotplug thread bringing up more
-		 * CPUs than necessary.
+		 * CPUs than necessary. In isolation mode an extra CPU is
+		 * isolated instead.
 		 */
-		if (!cluster->disabled &&
+		if (!cluster->disabled && !cluster->isolation &&
 			apply_limits(cluster, cluster->need_cpus) <=
 				 cluster->online_cpus) {
 			pr_debug("Prevent CPU%d onlining\n", cpu);
@@ -1012,6 +1208,12 @@ static int __ref cpu_callback(struct notifier_block *nfb,
 			cluster->avail_cpus--;
 		}
 
+		/* The scheduler drops the isolation of a dead CPU */
+		if (state->isolated_by_us) {
+			state->isolated_by_us = false;
+			cluster->nr_isolated_cpus--;
+		}
+
 		state->online = false;
 		state->busy = 0;
 		cluster->online_cpus--;
@@ -1083,6 +1285,7 @@ static int cluster_init(const struct cpumask *mask)
 	cluster->offline_delay_ms = 100;
 	cluster->task_thres = UINT_MAX;
 	cluster->nrrun = cluster->num_cpus;
+	cluster->nrrun_pred = cluster->num_cpus;
 	INIT_LIST_HEAD(&cluster->lru);
 	INIT_LIST_HEAD(&cluster->pending_lru);
 	init_timer(&cluster->timer);
@@ -29,7 +29,7 @@ static bool __read_mostly cpufreq_driver_slow;
 static struct cpufreq_governor cpufreq_gov_sched;
 #endif
 
-static DEFINE_PER_CPU(unsigned long, enabled);
+static DEFINE_PER_CPU(struct cpufreq_policy *, enabled_policy);
 DEFINE_PER_CPU(struct sched_capacity_reqs, cpu_sched_capacity_reqs);
 
 /**
@@ -38,6 +38,7 @@ DEFINE_PER_CPU(struct sched_capacity_reqs, cpu_sched_capacity_reqs);
  * @down_throttle: next throttling period expiry if decreasing OPP
  * @up_throttle_nsec: throttle period length in nanoseconds if increasing OPP
  * @down_throttle_nsec: throttle period length in nanoseconds if decreasing OPP
+ *	Both rate limits apply to the worker thread and to fast switching.
  * @task: worker thread for dvfs transition that may block/sleep
  * @irq_work: callback used to wake up worker thread
  * @requested_freq: last frequency requested by the sched governor
@@ -149,6 +150,36 @@ static int cpufreq_sched_thread(void *data)
 	return 0;
 }
 
+/*
+ * Switch the frequency right from scheduler context, for drivers that
+ * can do it without sleeping. A request that is throttled is dropped
+ * here and retried on the next capacity request.
+ */
+static void cpufreq_sched_fast_switch(struct cpufreq_policy *policy,
+				      struct gov_data *gd, unsigned int freq)
+{
+	ktime_t now = ktime_get();
+	ktime_t throttle = freq < policy->cur ?
+		gd->down_throttle : gd->up_throttle;
+
+	if (!ktime_after(now, throttle)) {
+		trace_cpufreq_sched_throttled(
+			ktime_to_us(ktime_sub(throttle, now)));
+		return;
+	}
+
+	if (!cpufreq_driver_has_fast_switch()) {
+		cpufreq_sched_try_driver_target(policy, freq);
+		return;
+	}
+
+	if (!cpufreq_driver_fast_switch(policy, freq))
+		return;
+
+	gd->up_throttle = ktime_add_ns(now, gd->up_throttle_nsec);
+	gd->down_throttle = ktime_add_ns(now, gd->down_throttle_nsec);
+}
+
 static void cpufreq_sched_irq_work(struct irq_work *irq_work)
 {
 	struct gov_data *gd;
@@ -168,22 +199,17 @@ static void update_fdomain_capacity_request(int cpu)
 	unsigned long capacity = 0;
 
 	/*
-	 * Avoid grabbing the policy if possible. A test is still
-	 * required after locking the CPU's policy to avoid racing
-	 * with the governor changing.
+	 * We run with the rq lock held, so the policy can't go away under
+	 * us: cpufreq_sched_stop() waits for a sched RCU grace period after
+	 * clearing it.
 	 */
-	if (!per_cpu(enabled, cpu))
-		return;
-
-	policy = cpufreq_cpu_get(cpu);
-	if (IS_ERR_OR_NULL(policy))
+	policy = per_cpu(enabled_policy, cpu);
+	if (!policy)
 		return;
 
-	if (policy->governor != &cpufreq_gov_sched ||
-	    !policy->governor_data)
-		goto out;
-
 	gd = policy->governor_data;
+	if (!gd)
+		return;
 
 	/* find max capacity requested by cpus in this policy */
 	for_each_cpu(cpu_tmp, policy->cpus) {
@@ -198,7 +224,7 @@ static void update_fdomain_capacity_request(int cpu)
 	if (cpufreq_frequency_table_target(policy, policy->freq_table,
 					   freq_new, CPUFREQ_RELATION_L,
 					   &index_new))
-		goto out;
+		return;
 	freq_new = policy->freq_table[index_new].frequency;
 
 	if (freq_new > policy->max)
@@ -209,22 +235,18 @@ static void update_fdomain_capacity_request(int cpu)
 
 	trace_cpufreq_sched_request_opp(cpu, capacity, freq_new,
 					gd->requested_freq);
-	if (freq_new == gd->requested_freq)
-		goto out;
+
+	/* A fast switch may have been throttled, retry it then */
+	if (freq_new == gd->requested_freq &&
+	    (cpufreq_driver_slow || freq_new == policy->cur))
+		return;
 
 	gd->requested_freq = freq_new;
 
-	/*
-	 * Throttling is not yet supported on platforms with fast cpufreq
-	 * drivers.
-	 */
 	if (cpufreq_driver_slow)
 		irq_work_queue_on(&gd->irq_work, cpu);
 	else
-		cpufreq_sched_try_driver_target(policy, freq_new);
-
-out:
-	cpufreq_cpu_put(policy);
+		cpufreq_sched_fast_switch(policy, gd, freq_new);
 }
 
 void update_cpu_capacity_request(int cpu, bool request)
@@ -346,7 +368,7 @@ static int cpufreq_sched_start(struct cpufreq_policy *policy)
 	int cpu;
 
 	for_each_cpu(cpu, policy->cpus)
-		per_cpu(enabled, cpu) = 1;
+		per_cpu(enabled_policy, cpu) = policy;
 
 	return 0;
 }
@@ -371,7 +393,10 @@ static int cpufreq_sched_stop(struct cpufreq_policy *policy)
 	int cpu;
 
 	for_each_cpu(cpu, policy->cpus)
-		per_cpu(enabled, cpu) = 0;
+		per_cpu(enabled_policy, cpu) = NULL;
+
+	/* Wait for the requests still running from scheduler context */
+	synchronize_sched();
 
 	return 0;
 }
@@ -492,7 +517,7 @@ static int __init cpufreq_sched_init(void)
 	int cpu;
 
 	for_each_cpu(cpu, cpu_possible_mask)
-		per_cpu(enabled, cpu) = 0;
+		per_cpu(enabled_policy, cpu) = NULL;
 	return cpufreq_register_governor(&cpufreq_gov_sched);
 }
 
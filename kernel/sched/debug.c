@@ -655,6 +655,11 @@ void proc_sched_show_task(struct task_struct *p, struct seq_file *m)
 	P(se.statistics.nr_wakeups_affine_attempts);
 	P(se.statistics.nr_wakeups_passive);
 	P(se.statistics.nr_wakeups_idle);
+#ifdef CONFIG_SCHED_PMU_STATS
+	P(se.statistics.pmu_cycles);
+	P(se.statistics.pmu_instructions);
+	P(se.statistics.pmu_l2_misses);
+#endif
 
 #if defined(CONFIG_SMP) && defined(CONFIG_FAIR_GROUP_SCHED)
 	__P(load_avg);
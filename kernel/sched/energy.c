@@ -15,6 +15,14 @@
  *
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Each cpu node points to one energy node per level through its
+ * "sched-energy-costs" phandle list: first the core, then the cluster.
+ * An energy node has
+ *  - "busy-cost-data": <capacity power> pairs, one per frequency, in
+ *    ascending capacity order. Capacity is out of SCHED_CAPACITY_SCALE
+ *    for the most capable cpu of the system at its highest frequency.
+ *  - "idle-cost-data": the power of each idle state, shallowest first.
  */
 #define pr_fmt(fmt) "sched-energy: " fmt
 
@@ -25,6 +33,7 @@
 #include <linux/printk.h>
 #include <linux/sched.h>
 #include <linux/sched_energy.h>
+#include <linux/slab.h>
 #include <linux/stddef.h>
 
 struct sched_group_energy *sge_array[NR_CPUS][NR_SD_LEVELS];
@@ -42,6 +51,7 @@ static void free_resources(void)
 				kfree(sge->idle_states);
 				kfree(sge);
 			}
+			sge_array[cpu][sd_level] = NULL;
 		}
 	}
 }
@@ -60,12 +70,13 @@ void init_sched_energy_costs(void)
 		cn = of_get_cpu_node(cpu, NULL);
 		if (!cn) {
 			pr_warn("CPU device node missing for CPU %d\n", cpu);
-			return;
+			goto out;
 		}
 
 		if (!of_find_property(cn, "sched-energy-costs", NULL)) {
 			pr_warn("CPU device node has no sched-energy-costs\n");
-			return;
+			of_node_put(cn);
+			goto out;
 		}
 
 		for_each_possible_sd_level(sd_level) {
@@ -74,18 +85,23 @@ void init_sched_energy_costs(void)
 				break;
 
 			prop = of_find_property(cp, "busy-cost-data", NULL);
-			if (!prop || !prop->value) {
+			nstates = prop ? (prop->length / sizeof(u32)) / 2 : 0;
+			if (!nstates || !prop->value) {
 				pr_warn("No busy-cost data, skipping sched_energy init\n");
-				goto out;
+				goto put_out;
 			}
 
 			sge = kcalloc(1, sizeof(struct sched_group_energy),
 				      GFP_NOWAIT);
+			if (!sge)
+				goto put_out;
+			sge_array[cpu][sd_level] = sge;
 
-			nstates = (prop->length / sizeof(u32)) / 2;
 			cap_states = kcalloc(nstates,
 					     sizeof(struct capacity_state),
 					     GFP_NOWAIT);
+			if (!cap_states)
+				goto put_out;
 
 			for (i = 0, val = prop->value; i < nstates; i++) {
 				cap_states[i].cap = be32_to_cpup(val++);
@@ -96,15 +112,17 @@ void init_sched_energy_costs(void)
 			sge->cap_states = cap_states;
 
 			prop = of_find_property(cp, "idle-cost-data", NULL);
-			if (!prop || !prop->value) {
+			nstates = prop ? prop->length / sizeof(u32) : 0;
+			if (!nstates || !prop->value) {
 				pr_warn("No idle-cost data, skipping sched_energy init\n");
-				goto out;
+				goto put_out;
 			}
 
-			nstates = (prop->length / sizeof(u32));
 			idle_states = kcalloc(nstates,
 					      sizeof(struct idle_state),
 					      GFP_NOWAIT);
+			if (!idle_states)
+				goto put_out;
 
 			for (i = 0, val = prop->value; i < nstates; i++)
 				idle_states[i].power = be32_to_cpup(val++);
@@ -112,13 +130,48 @@ void init_sched_energy_costs(void)
 			sge->nr_idle_states = nstates;
 			sge->idle_states = idle_states;
 
-			sge_array[cpu][sd_level] = sge;
+			of_node_put(cp);
 		}
+		of_node_put(cn);
 	}
 
 	pr_info("Sched-energy-costs installed from DT\n");
 	return;
 
+put_out:
+	of_node_put(cp);
+	of_node_put(cn);
 out:
 	free_resources();
 }
+
+/**
+ * sched_energy_busy_power - busy power of a cpu from the DT energy model
+ * @cpu: the cpu
+ * @util: capacity the cpu has to provide, out of SCHED_CAPACITY_SCALE
+ *
+ * Sums, over the core and cluster levels, the power of the lowest
+ * capacity state that fits @util, or of the highest one if none does.
+ * Returns 0 when no energy model was installed.
+ */
+unsigned long sched_energy_busy_power(int cpu, unsigned long util)
+{
+	struct sched_group_energy *sge;
+	unsigned long power = 0;
+	int sd_level, i;
+
+	for_each_possible_sd_level(sd_level) {
+		sge = sge_array[cpu][sd_level];
+		if (!sge)
+			break;
+
+		for (i = 0; i < sge->nr_cap_states - 1; i++) {
+			if (sge->cap_states[i].cap >= util)
+				break;
+		}
+
+		power += sge->cap_states[i].power;
+	}
+
+	return power;
+}
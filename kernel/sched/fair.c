@@ -30,6 +30,7 @@
 #include <linux/mempolicy.h>
 #include <linux/migrate.h>
 #include <linux/task_work.h>
+#include <linux/sched_energy.h>
 
 #include "sched.h"
 #include <trace/events/sched.h>
@@ -2547,6 +2548,16 @@ static inline int upmigrate_discouraged(struct task_struct *p)
 	return task_group(p)->upmigrate_discouraged;
 }
 
+static inline int task_group_prefer_idle(struct task_struct *p)
+{
+	return task_group(p)->prefer_idle;
+}
+
+static inline unsigned int task_group_min_capacity(struct task_struct *p)
+{
+	return task_group(p)->min_capacity;
+}
+
 #else
 
 static inline int upmigrate_discouraged(struct task_struct *p)
@@ -2554,6 +2565,16 @@ static inline int upmigrate_discouraged(struct task_struct *p)
 	return 0;
 }
 
+static inline int task_group_prefer_idle(struct task_struct *p)
+{
+	return 0;
+}
+
+static inline unsigned int task_group_min_capacity(struct task_struct *p)
+{
+	return 0;
+}
+
 #endif
 
 /* Is a task "big" on its current cpu */
@@ -2751,13 +2772,26 @@ unsigned int power_cost(int cpu, u64 demand)
 	struct rq *rq = cpu_rq(cpu);
 	unsigned int pc;
 
-	if (!per_cpu_info || !per_cpu_info[cpu].ptable)
+	if (!per_cpu_info || !per_cpu_info[cpu].ptable) {
+		/*
+		 * Without msm-core power data, use the energy model from
+		 * DT if there is one. Task demand is relative to the most
+		 * capable cpu at its highest frequency, like the capacity
+		 * states of the model.
+		 */
+		pc = sched_energy_busy_power(cpu,
+			div64_u64(demand << SCHED_CAPACITY_SHIFT,
+				  max_task_load()));
+		if (pc)
+			goto static_cost;
+
 		/* When power aware scheduling is not in use, or CPU
 		 * power data is not available, just use the CPU
 		 * capacity as a rough stand-in for real CPU power
 		 * numbers, assuming bigger CPUs are more power
 		 * hungry. */
 		return cpu_max_possible_capacity(cpu);
+	}
 
 	rcu_read_lock();
 	max_load = rcu_dereference(per_cpu(freq_max_load, cpu));
@@ -2795,6 +2829,7 @@ unsigned int power_cost(int cpu, u64 demand)
 unlock:
 	rcu_read_unlock();
 
+static_cost:
 	if (idle_cpu(cpu) && rq->cstate) {
 		total_static_pwr_cost += rq->static_cpu_pwr_cost;
 		if (rq->cluster->dstate)
@@ -2925,13 +2960,27 @@ acceptable_capacity(struct sched_cluster *cluster, struct cpu_select_env *env)
 	return 1;
 }
 
+/* Is the cluster below the minimum capacity of the task's group */
+static inline int
+below_min_capacity(struct sched_cluster *cluster, struct task_struct *p)
+{
+	unsigned int min_capacity = task_group_min_capacity(p);
+
+	if (!min_capacity)
+		return 0;
+
+	return cluster->max_possible_capacity * 100 <
+			min_capacity * max_possible_capacity;
+}
+
 static int
 skip_cluster(struct sched_cluster *cluster, struct cpu_select_env *env)
 {
 	if (!test_bit(cluster->id, env->candidate_list))
 		return 1;
 
-	if (!acceptable_capacity(cluster, env)) {
+	if (!acceptable_capacity(cluster, env) ||
+	    below_min_capacity(cluster, env->p)) {
 		__clear_bit(cluster->id, env->candidate_list);
 		return 1;
 	}
@@ -3021,6 +3070,9 @@ struct cpu_select_env *env, struct cluster_cpu_stats *stats)
 			sched_irqload(i), power_cost(i, task_load(env->p) +
 					cpu_cravg_sync(i, env->sync)), 0);
 
+			if (cpu_isolated(i))
+				continue;
+
 			update_spare_capacity(stats, env, i, next->capacity,
 					  cpu_load_sync(i, env->sync));
 		}
@@ -3174,6 +3226,7 @@ static void find_best_cpu_in_cluster(struct sched_cluster *c,
 	struct cpumask search_cpus;
 
 	cpumask_and(&search_cpus, tsk_cpus_allowed(env->p), &c->cpus);
+	cpumask_andnot(&search_cpus, &search_cpus, cpu_isolated_mask);
 	if (env->ignore_prev_cpu)
 		cpumask_clear_cpu(env->prev_cpu, &search_cpus);
 
@@ -3220,11 +3273,14 @@ static inline void init_cluster_cpu_stats(struct cluster_cpu_stats *stats)
  * cpus on either performance or power. PF_WAKE_UP_IDLE allows external kernel
  * module to pass a strong hint to scheduler that the task in question should be
  * woken to idle cpu, generally to improve performance.
+ *
+ * The cpu cgroup of the task can ask for the same with prefer_idle, so that
+ * latency sensitive groups are spread on idle cpus while the others pack.
  */
 static inline int wake_to_idle(struct task_struct *p)
 {
 	return (current->flags & PF_WAKE_UP_IDLE) ||
-				(p->flags & PF_WAKE_UP_IDLE);
+		(p->flags & PF_WAKE_UP_IDLE) || task_group_prefer_idle(p);
 }
 
 static inline bool
@@ -3241,13 +3297,24 @@ bias_to_prev_cpu(struct cpu_select_env *env, struct cluster_cpu_stats *stats)
 
 	prev_cpu = env->prev_cpu;
 	if (!cpumask_test_cpu(prev_cpu, tsk_cpus_allowed(task)) ||
-					unlikely(!cpu_active(prev_cpu)))
+					unlikely(!cpu_active(prev_cpu)) ||
+					cpu_isolated(prev_cpu))
 		return false;
 
 	if (task->ravg.mark_start - task->last_cpu_selected_ts >=
 				sched_long_cpu_selection_threshold)
 		return false;
 
+	/*
+	 * Unbound kworkers (bound ones never get here) run short background
+	 * work that gains little from cache affinity. Don't pull their
+	 * previous CPU out of a low power C-state for it; the cluster search
+	 * below breaks ties in favour of CPUs that are already awake.
+	 */
+	if ((task->flags & PF_WQ_WORKER) && idle_cpu(prev_cpu) &&
+	    cpu_rq(prev_cpu)->cstate)
+		return false;
+
 	/*
 	 * This function should be used by task wake up path only as it's
 	 * assuming p->last_switch_out_ts as last sleep time.
@@ -3294,6 +3361,7 @@ cluster_allowed(struct task_struct *p, struct sched_cluster *cluster)
 	cpumask_t tmp_mask;
 
 	cpumask_and(&tmp_mask, &cluster->cpus, cpu_active_mask);
+	cpumask_andnot(&tmp_mask, &tmp_mask, cpu_isolated_mask);
 	cpumask_and(&tmp_mask, &tmp_mask, &p->cpus_allowed);
 
 	return !cpumask_empty(&tmp_mask);
@@ -3343,7 +3411,7 @@ static int select_best_cpu(struct task_struct *p, int target, int reason,
 			if (sysctl_sched_prefer_sync_wakee_to_waker &&
 				cpu_rq(cpu)->nr_running == 1 &&
 				cpumask_test_cpu(cpu, tsk_cpus_allowed(p)) &&
-				cpu_active(cpu)) {
+				cpu_active(cpu) && !cpu_isolated(cpu)) {
 				fast_path = true;
 				target = cpu;
 				goto out;
@@ -0,0 +1,157 @@
+/*
+ * Scheduler wakeup latency monitor
+ *
+ * Records, per CPU and per scheduling class, how long woken tasks wait
+ * before they get the CPU. Updates happen from the wakeup and context
+ * switch paths with the local rq->lock held, so the per-cpu data needs
+ * no further locking on the write side; readers may see a histogram
+ * that is a few samples behind, which is fine for monitoring.
+ *
+ * /proc/sched_latency shows the worst case and a log2(usec) histogram.
+ * It can be poll()ed: POLLPRI is signalled whenever a CPU sees a new
+ * maximum since the file was last read. Writing to it resets the stats.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ */
+
+#include <linux/init.h>
+#include <linux/irq_work.h>
+#include <linux/poll.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/wait.h>
+
+#include "sched.h"
+
+#define LATMON_BUCKETS	16
+
+enum {
+	LATMON_RT,	/* stop, deadline and rt */
+	LATMON_FAIR,
+	LATMON_NR_CLASSES,
+};
+
+static const char * const latmon_class_names[LATMON_NR_CLASSES] = {
+	"rt", "fair",
+};
+
+struct latmon_cpu {
+	u64 max[LATMON_NR_CLASSES];
+	u32 hist[LATMON_NR_CLASSES][LATMON_BUCKETS];
+};
+
+static DEFINE_PER_CPU(struct latmon_cpu, latmon_cpu);
+
+static atomic_t latmon_event = ATOMIC_INIT(0);
+static DECLARE_WAIT_QUEUE_HEAD(latmon_wait);
+
+/*
+ * The recording side runs under rq->lock, where taking the waitqueue
+ * lock is not allowed; defer the wakeup of pollers to irq_work.
+ */
+static void latmon_notify(struct irq_work *work)
+{
+	wake_up_interruptible(&latmon_wait);
+}
+
+static DEFINE_PER_CPU(struct irq_work, latmon_work) = {
+	.func = latmon_notify,
+};
+
+static inline int latmon_bucket(u64 delta)
+{
+	int b = fls64(delta >> 10);	/* ~usec */
+
+	return min(b, LATMON_BUCKETS - 1);
+}
+
+void sched_latmon_record(struct rq *rq, struct task_struct *p, u64 delta)
+{
+	struct latmon_cpu *lc = this_cpu_ptr(&latmon_cpu);
+	int class = p->prio < MAX_RT_PRIO ? LATMON_RT : LATMON_FAIR;
+
+	lc->hist[class][latmon_bucket(delta)]++;
+
+	if (delta > lc->max[class]) {
+		lc->max[class] = delta;
+		atomic_inc(&latmon_event);
+		irq_work_queue(this_cpu_ptr(&latmon_work));
+	}
+}
+
+static int latmon_show(struct seq_file *m, void *v)
+{
+	int cpu, class, b;
+
+	m->private = (void *)(long)atomic_read(&latmon_event);
+
+	seq_printf(m, "# max in usec, then bucket i counts waits of [2^(i-1), 2^i) usec\n");
+	for_each_possible_cpu(cpu) {
+		struct latmon_cpu *lc = &per_cpu(latmon_cpu, cpu);
+
+		for (class = 0; class < LATMON_NR_CLASSES; class++) {
+			seq_printf(m, "cpu%d %-4s %llu", cpu,
+				   latmon_class_names[class],
+				   div_u64(ACCESS_ONCE(lc->max[class]),
+					   NSEC_PER_USEC));
+			for (b = 0; b < LATMON_BUCKETS; b++)
+				seq_printf(m, " %u",
+					   ACCESS_ONCE(lc->hist[class][b]));
+			seq_putc(m, '\n');
+		}
+	}
+
+	return 0;
+}
+
+static int latmon_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, latmon_show, NULL);
+}
+
+static unsigned int latmon_poll(struct file *file, poll_table *wait)
+{
+	struct seq_file *m = file->private_data;
+
+	poll_wait(file, &latmon_wait, wait);
+
+	if ((long)m->private != atomic_read(&latmon_event))
+		return POLLIN | POLLRDNORM | POLLPRI;
+
+	return POLLIN | POLLRDNORM;
+}
+
+static ssize_t latmon_write(struct file *file, const char __user *buf,
+			    size_t count, loff_t *ppos)
+{
+	unsigned long flags;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct rq *rq = cpu_rq(cpu);
+
+		raw_spin_lock_irqsave(&rq->lock, flags);
+		memset(&per_cpu(latmon_cpu, cpu), 0, sizeof(struct latmon_cpu));
+		raw_spin_unlock_irqrestore(&rq->lock, flags);
+	}
+
+	return count;
+}
+
+static const struct file_operations latmon_fops = {
+	.open		= latmon_open,
+	.read		= seq_read,
+	.write		= latmon_write,
+	.poll		= latmon_poll,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init latmon_init(void)
+{
+	proc_create("sched_latency", 0644, NULL, &latmon_fops);
+	return 0;
+}
+late_initcall(latmon_init);
@@ -0,0 +1,189 @@
+/*
+ * Per-task PMU counter statistics
+ *
+ * While kernel.sched_pmu_stats is set, every online CPU carries pinned
+ * kernel counters for cycles, instructions and L2 refills. At each
+ * context switch the delta since the previous switch on that CPU is
+ * charged to the outgoing task's schedstats, so /proc/<pid>/sched shows
+ * what the task consumed without having to attach perf to it.
+ *
+ * The counters are read with perf_event_read_local(), which touches
+ * only the local PMU and is therefore fine under rq->lock.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ */
+
+#include <linux/cpu.h>
+#include <linux/init.h>
+#include <linux/mutex.h>
+#include <linux/perf_event.h>
+#include <linux/sysctl.h>
+
+#include "sched.h"
+
+/* ARMv8 common event L2D_CACHE_REFILL, implemented by A53 and Kryo */
+#define PMU_L2D_CACHE_REFILL	0x17
+
+enum {
+	PMU_CYCLES,
+	PMU_INSTRUCTIONS,
+	PMU_L2_MISSES,
+	PMU_NR_COUNTERS,
+};
+
+static struct perf_event_attr sched_pmu_attr[PMU_NR_COUNTERS] = {
+	[PMU_CYCLES] = {
+		.type		= PERF_TYPE_HARDWARE,
+		.config		= PERF_COUNT_HW_CPU_CYCLES,
+		.size		= sizeof(struct perf_event_attr),
+		.pinned		= 1,
+	},
+	[PMU_INSTRUCTIONS] = {
+		.type		= PERF_TYPE_HARDWARE,
+		.config		= PERF_COUNT_HW_INSTRUCTIONS,
+		.size		= sizeof(struct perf_event_attr),
+		.pinned		= 1,
+	},
+	[PMU_L2_MISSES] = {
+		.type		= PERF_TYPE_RAW,
+		.config		= PMU_L2D_CACHE_REFILL,
+		.size		= sizeof(struct perf_event_attr),
+		.pinned		= 1,
+	},
+};
+
+struct sched_pmu_cpu {
+	struct perf_event *event[PMU_NR_COUNTERS];
+	u64 last[PMU_NR_COUNTERS];
+};
+
+static DEFINE_PER_CPU(struct sched_pmu_cpu, sched_pmu_cpu);
+static DEFINE_MUTEX(sched_pmu_mutex);
+
+unsigned int sysctl_sched_pmu_stats;
+
+/* Called with rq->lock held, just before @prev is switched out. */
+void __sched_pmu_switch(struct task_struct *prev)
+{
+	struct sched_pmu_cpu *pc = this_cpu_ptr(&sched_pmu_cpu);
+	u64 delta[PMU_NR_COUNTERS];
+	int i;
+
+	for (i = 0; i < PMU_NR_COUNTERS; i++) {
+		struct perf_event *event = ACCESS_ONCE(pc->event[i]);
+		u64 val;
+
+		delta[i] = 0;
+		if (!event)
+			continue;
+
+		val = perf_event_read_local(event);
+		delta[i] = val - pc->last[i];
+		pc->last[i] = val;
+	}
+
+	prev->se.statistics.pmu_cycles += delta[PMU_CYCLES];
+	prev->se.statistics.pmu_instructions += delta[PMU_INSTRUCTIONS];
+	prev->se.statistics.pmu_l2_misses += delta[PMU_L2_MISSES];
+}
+
+static void sched_pmu_start_cpu(int cpu)
+{
+	struct sched_pmu_cpu *pc = &per_cpu(sched_pmu_cpu, cpu);
+	struct perf_event *event;
+	int i;
+
+	for (i = 0; i < PMU_NR_COUNTERS; i++) {
+		if (pc->event[i])
+			continue;
+
+		event = perf_event_create_kernel_counter(&sched_pmu_attr[i],
+							 cpu, NULL, NULL, NULL);
+		if (IS_ERR(event)) {
+			pr_debug("sched_pmu: cpu%d counter %d: %ld\n",
+				 cpu, i, PTR_ERR(event));
+			continue;
+		}
+
+		/* A new counter starts from zero */
+		pc->last[i] = 0;
+		smp_wmb();
+		ACCESS_ONCE(pc->event[i]) = event;
+	}
+}
+
+static void sched_pmu_stop_cpu(int cpu)
+{
+	struct sched_pmu_cpu *pc = &per_cpu(sched_pmu_cpu, cpu);
+	struct perf_event *event[PMU_NR_COUNTERS];
+	int i;
+
+	for (i = 0; i < PMU_NR_COUNTERS; i++) {
+		event[i] = pc->event[i];
+		ACCESS_ONCE(pc->event[i]) = NULL;
+	}
+
+	/* Wait for context switches still reading the old counters */
+	synchronize_sched();
+
+	for (i = 0; i < PMU_NR_COUNTERS; i++)
+		if (event[i])
+			perf_event_release_kernel(event[i]);
+}
+
+static int sched_pmu_cpu_callback(struct notifier_block *nfb,
+				  unsigned long action, void *hcpu)
+{
+	int cpu = (long)hcpu;
+
+	if (!sysctl_sched_pmu_stats)
+		return NOTIFY_OK;
+
+	switch (action & ~CPU_TASKS_FROZEN) {
+	case CPU_ONLINE:
+	case CPU_DOWN_FAILED:
+		sched_pmu_start_cpu(cpu);
+		break;
+	case CPU_DOWN_PREPARE:
+		sched_pmu_stop_cpu(cpu);
+		break;
+	}
+
+	return NOTIFY_OK;
+}
+
+int sched_pmu_stats_handler(struct ctl_table *table, int write,
+			    void __user *buffer, size_t *lenp, loff_t *ppos)
+{
+	unsigned int old;
+	int ret, cpu;
+
+	mutex_lock(&sched_pmu_mutex);
+	get_online_cpus();
+
+	old = sysctl_sched_pmu_stats;
+	ret = proc_dointvec_minmax(table, write, buffer, lenp, ppos);
+	if (ret || !write || old == sysctl_sched_pmu_stats)
+		goto out;
+
+	for_each_online_cpu(cpu) {
+		if (sysctl_sched_pmu_stats)
+			sched_pmu_start_cpu(cpu);
+		else
+			sched_pmu_stop_cpu(cpu);
+	}
+
+out:
+	put_online_cpus();
+	mutex_unlock(&sched_pmu_mutex);
+	return ret;
+}
+
+static int __init sched_pmu_init(void)
+{
+	hotcpu_notifier(sched_pmu_cpu_callback, 0);
+	return 0;
+}
+late_initcall(sched_pmu_init);
@@ -1133,6 +1133,7 @@ static struct sched_cluster init_cluster = {
 	.load_scale_factor	=	1024,
 	.cur_freq		=	1,
 	.max_freq		=	1,
+	.max_mitigated_freq	=	UINT_MAX,
 	.min_freq		=	1,
 	.max_possible_freq	=	1,
 	.mostly_idle_freq	=	1,
@@ -1199,6 +1200,7 @@ static void add_cluster(struct cpufreq_policy *policy)
 	cpumask_copy(&cluster->cpus, policy->related_cpus);
 	cluster->cur_freq = policy->cur;
 	cluster->max_freq = policy->max;
+	cluster->max_mitigated_freq = UINT_MAX;
 	cluster->min_freq = policy->min;
 	cluster->max_possible_freq = policy->cpuinfo.max_freq;
 	cluster->efficiency = arch_get_cpu_efficiency(cpu);
@@ -1888,7 +1890,7 @@ void check_for_freq_change(struct rq *rq)
 	trace_sched_freq_alert(cpu, rq->old_busy_time, rq->prev_runnable_sum);
 
 	atomic_notifier_call_chain(
-		&load_alert_notifier_head, 0,
+		&load_alert_notifier_head, SCHED_LOAD_ALERT,
 		(void *)(long)cpu);
 }
 
@@ -2723,6 +2725,7 @@ void sched_get_cpus_busy(struct sched_load *busy,
 
 		busy[i].prev_load = div64_u64(load[i], NSEC_PER_USEC);
 		busy[i].new_task_load = 0;
+		busy[i].top_task_load = 0;
 
 		trace_sched_get_busy(cpu, busy[i].prev_load);
 		i++;
@@ -2745,6 +2748,32 @@ void sched_set_io_is_busy(int val)
 	sched_io_is_busy = val;
 }
 
+/*
+ * Report how long it is until the current load tracking window rolls
+ * over, so that periodic samplers outside the scheduler can align their
+ * sampling with the windows.
+ */
+int sched_get_window_remaining(u64 *remaining_ns, unsigned int *window_ns)
+{
+	struct rq *rq = cpu_rq(raw_smp_processor_id());
+	u64 now, ws, delta;
+
+	if (sched_use_pelt)
+		return -EINVAL;
+
+	now = sched_ktime_clock();
+	ws = ACCESS_ONCE(rq->window_start);
+	if (!ws || now < ws)
+		return -EAGAIN;
+
+	div64_u64_rem(now - ws, sched_ravg_window, &delta);
+	*remaining_ns = sched_ravg_window - delta;
+	*window_ns = sched_ravg_window;
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(sched_get_window_remaining);
+
 int sched_set_window(u64 window_start, unsigned int window_size)
 {
 	u64 now, cur_jiffies, jiffy_ktime_ns;
@@ -2891,7 +2920,7 @@ capacity_scale_cpu_efficiency(struct sched_cluster *cluster)
  */
 static unsigned long capacity_scale_cpu_freq(struct sched_cluster *cluster)
 {
-	return (1024 * cluster->max_freq) / min_max_freq;
+	return (1024 * cluster_max_freq(cluster)) / min_max_freq;
 }
 
 /*
@@ -2912,7 +2941,8 @@ load_scale_cpu_efficiency(struct sched_cluster *cluster)
  */
 static inline unsigned long load_scale_cpu_freq(struct sched_cluster *cluster)
 {
-	return DIV_ROUND_UP(1024 * max_possible_freq, cluster->max_freq);
+	return DIV_ROUND_UP(1024 * max_possible_freq,
+			   cluster_max_freq(cluster));
 }
 
 static int compute_capacity(struct sched_cluster *cluster)
@@ -2980,6 +3010,44 @@ static void check_for_up_down_migrate_update(const struct cpumask *cpus)
 	update_up_down_migrate();
 }
 
+void sched_update_cpu_freq_min_max(const cpumask_t *cpus, u32 fmin, u32 fmax)
+{
+	struct cpumask cpumask;
+	struct sched_cluster *cluster;
+	unsigned int orig_max_freq;
+	int i, update_capacity = 0;
+
+	cpumask_copy(&cpumask, cpus);
+	for_each_cpu(i, &cpumask) {
+		cluster = cpu_rq(i)->cluster;
+		cpumask_andnot(&cpumask, &cpumask, &cluster->cpus);
+
+		orig_max_freq = cpu_max_freq(i);
+		cluster->max_mitigated_freq = fmax;
+
+		update_capacity += (orig_max_freq != cpu_max_freq(i));
+	}
+
+	if (!update_capacity)
+		return;
+
+	pre_big_small_task_count_change(cpu_possible_mask);
+
+	cpumask_copy(&cpumask, cpus);
+	for_each_cpu(i, &cpumask) {
+		cluster = cpu_rq(i)->cluster;
+		cpumask_andnot(&cpumask, &cpumask, &cluster->cpus);
+
+		cluster->capacity = compute_capacity(cluster);
+		cluster->load_scale_factor = compute_load_scale_factor(cluster);
+		check_for_up_down_migrate_update(&cluster->cpus);
+	}
+
+	__update_min_max_capacity();
+
+	post_big_small_task_count_change(cpu_possible_mask);
+}
+
 static int cpufreq_notifier_policy(struct notifier_block *nb,
 		unsigned long val, void *data)
 {
@@ -3077,7 +3145,7 @@ static int cpufreq_notifier_policy(struct notifier_block *nb,
 		}
 
 		mplsf = div_u64(((u64) cluster->load_scale_factor) *
-			cluster->max_possible_freq, cluster->max_freq);
+			cluster->max_possible_freq, cluster_max_freq(cluster));
 
 		if (mplsf > highest_mplsf)
 			highest_mplsf = mplsf;
@@ -5122,6 +5190,27 @@ unsigned long long task_sched_runtime(struct task_struct *p)
 	return ns;
 }
 
+#ifdef CONFIG_SCHED_HMP
+/*
+ * Has @rq moved into a window that has not been reported yet? The window
+ * may have been rolled over by the tick or by any earlier __schedule()
+ * or wakeup. Called with rq->lock held.
+ */
+static inline bool sched_window_rollover(struct rq *rq)
+{
+	if (rq->window_start == rq->last_notified_window_start)
+		return false;
+
+	rq->last_notified_window_start = rq->window_start;
+	return true;
+}
+#else
+static inline bool sched_window_rollover(struct rq *rq)
+{
+	return false;
+}
+#endif
+
 /*
  * This function gets called by the timer code, with HZ frequency.
  * We call it with interrupts disabled.
@@ -5132,6 +5221,7 @@ void scheduler_tick(void)
 	struct rq *rq = cpu_rq(cpu);
 	struct task_struct *curr = rq->curr;
 	u32 old_load;
+	bool window_rollover;
 	struct related_thread_group *grp;
 
 	sched_clock_tick();
@@ -5145,8 +5235,13 @@ void scheduler_tick(void)
 	update_cpu_load_active(rq);
 	calc_global_load_tick(rq);
 	update_task_ravg(rq->curr, rq, TASK_UPDATE, sched_ktime_clock(), 0);
+	window_rollover = sched_window_rollover(rq);
 	raw_spin_unlock(&rq->lock);
 
+	if (window_rollover)
+		atomic_notifier_call_chain(&load_alert_notifier_head,
+				SCHED_WINDOW_ROLLOVER, (void *)(long)cpu);
+
 	perf_event_task_tick();
 
 #ifdef CONFIG_SMP
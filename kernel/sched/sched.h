@@ -254,6 +254,8 @@ struct task_group {
 	bool notify_on_migrate;
 #ifdef CONFIG_SCHED_HMP
 	bool upmigrate_discouraged;
+	bool prefer_idle;
+	unsigned int min_capacity;
 #endif
 
 #ifdef CONFIG_FAIR_GROUP_SCHED
@@ -650,6 +652,12 @@ extern struct root_domain def_root_domain;
 
 #endif /* CONFIG_SMP */
 
+#ifdef CONFIG_SCHED_FREQ_INPUT
+/* Busy time buckets per window tracked for the heaviest task on a cpu */
+#define NUM_LOAD_INDICES	100
+#define NUM_TRACKED_WINDOWS	2
+#endif
+
 /*
  * This is the main, per-CPU runqueue data structure.
  *
@@ -749,6 +757,7 @@ struct rq {
 	struct hmp_sched_stats hmp_stats;
 
 	u64 window_start;
+	u64 last_notified_window_start;
 	unsigned long hmp_flags;
 
 	u64 cur_irqload;
@@ -770,6 +779,17 @@ struct rq {
 	u64 prev_runnable_sum;
 	u64 nt_curr_runnable_sum;
 	u64 nt_prev_runnable_sum;
+
+	/*
+	 * Number of tasks by busy time bucket, for the current and the
+	 * previous window; curr_table selects the current one.  The bitmaps
+	 * have bit NUM_LOAD_INDICES - 1 - index set for each non-empty
+	 * bucket, so the heaviest bucket is the first set bit.
+	 */
+	u16 top_tasks[NUM_TRACKED_WINDOWS][NUM_LOAD_INDICES];
+	DECLARE_BITMAP(top_tasks_bitmap[NUM_TRACKED_WINDOWS], NUM_LOAD_INDICES);
+	u8 curr_table;
+	int prev_top, curr_top;
 #endif
 
 #ifdef CONFIG_IRQ_TIME_ACCOUNTING
@@ -1001,7 +1021,8 @@ extern void init_new_task_load(struct task_struct *p);
 #define WINDOW_STATS_MAX		1
 #define WINDOW_STATS_MAX_RECENT_AVG	2
 #define WINDOW_STATS_AVG		3
-#define WINDOW_STATS_INVALID_POLICY	4
+#define WINDOW_STATS_PREDICT		4
+#define WINDOW_STATS_INVALID_POLICY	5
 
 extern struct mutex policy_mutex;
 extern unsigned int sched_ravg_window;
@@ -2391,4 +2412,49 @@ static inline u64 irq_time_read(int cpu)
  */
 extern bool task_may_not_preempt(struct task_struct *task, int cpu);
 
+#ifdef CONFIG_SCHED_LATENCY_MONITOR
+extern void sched_latmon_record(struct rq *rq, struct task_struct *p,
+				u64 delta);
+
+/*
+ * Stamp @p when it becomes runnable. A task that is still current (woken
+ * before it got to schedule out) never waited for the CPU, so leave it
+ * unstamped.
+ */
+static inline void sched_latmon_wakeup(struct rq *rq, struct task_struct *p)
+{
+	if (!task_running(rq, p))
+		p->latmon_wake_ts = rq_clock(rq);
+}
+
+/* Called with rq->lock held when @next is about to get the CPU. */
+static inline void sched_latmon_switch(struct rq *rq, struct task_struct *next)
+{
+	u64 ts = next->latmon_wake_ts;
+
+	if (!ts)
+		return;
+
+	next->latmon_wake_ts = 0;
+	if ((s64)(rq_clock(rq) - ts) > 0)
+		sched_latmon_record(rq, next, rq_clock(rq) - ts);
+}
+#else
+static inline void sched_latmon_wakeup(struct rq *rq, struct task_struct *p) { }
+static inline void sched_latmon_switch(struct rq *rq, struct task_struct *next) { }
+#endif
+
+#ifdef CONFIG_SCHED_PMU_STATS
+extern void __sched_pmu_switch(struct task_struct *prev);
+
+/* Charge the counts since the last switch on this CPU to @prev. */
+static inline void sched_pmu_switch(struct task_struct *prev)
+{
+	if (sysctl_sched_pmu_stats)
+		__sched_pmu_switch(prev);
+}
+#else
+static inline void sched_pmu_switch(struct task_struct *prev) { }
+#endif
+
 #endif /* CONFIG_SCHED_QHMP */
@@ -27,6 +27,7 @@ static DEFINE_PER_CPU(u64, last_time);
 static DEFINE_PER_CPU(u64, nr_big_prod_sum);
 static DEFINE_PER_CPU(u64, nr);
 static DEFINE_PER_CPU(u64, nr_max);
+static DEFINE_PER_CPU(u64, nr_prod_total);
 
 static DEFINE_PER_CPU(unsigned long, iowait_prod_sum);
 static DEFINE_PER_CPU(spinlock_t, nr_lock) = __SPIN_LOCK_UNLOCKED(nr_lock);
@@ -188,12 +189,40 @@ void sched_update_nr_prod(int cpu, long delta, bool inc)
 	update_last_busy_time(cpu, !inc, nr_running, curr_time);
 
 	per_cpu(nr_prod_sum, cpu) += nr_running * diff;
+	per_cpu(nr_prod_total, cpu) += nr_running * diff;
 	per_cpu(nr_big_prod_sum, cpu) += nr_eligible_big_tasks(cpu) * diff;
 	per_cpu(iowait_prod_sum, cpu) += nr_iowait_cpu(cpu) * diff;
 	spin_unlock_irqrestore(&per_cpu(nr_lock, cpu), flags);
 }
 EXPORT_SYMBOL(sched_update_nr_prod);
 
+/**
+ * sched_get_nr_running_sum
+ * @cpu: The core id to query
+ * @time: Returns the sched_clock() time the sum was taken at
+ * @return: Sum of nr_running over time on @cpu, in task-nanoseconds
+ *
+ * The sum is never reset, so unlike sched_get_nr_running_avg() this may
+ * be used by any number of callers. The average nr_running between two
+ * calls is the difference of the sums divided by the difference of the
+ * times.
+ */
+u64 sched_get_nr_running_sum(int cpu, u64 *time)
+{
+	unsigned long flags;
+	u64 curr_time, sum;
+
+	spin_lock_irqsave(&per_cpu(nr_lock, cpu), flags);
+	curr_time = sched_clock();
+	sum = per_cpu(nr_prod_total, cpu) +
+		per_cpu(nr, cpu) * (curr_time - per_cpu(last_time, cpu));
+	spin_unlock_irqrestore(&per_cpu(nr_lock, cpu), flags);
+
+	*time = curr_time;
+	return sum;
+}
+EXPORT_SYMBOL(sched_get_nr_running_sum);
+
 u64 sched_get_cpu_last_busy_time(int cpu)
 {
 	return atomic64_read(&per_cpu(last_busy_time, cpu));
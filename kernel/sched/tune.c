@@ -549,6 +549,24 @@ int schedtune_prefer_idle(struct task_struct *p)
 	return prefer_idle;
 }
 
+/*
+ * A task is considered foreground when its group is either boosted or
+ * latency sensitive, which is how Android configures top-app.
+ */
+bool schedtune_task_foreground(struct task_struct *p)
+{
+	struct schedtune *st;
+	bool fg;
+
+	rcu_read_lock();
+	st = task_schedtune(p);
+	fg = st->boost > 0 || st->prefer_idle;
+	rcu_read_unlock();
+
+	return fg;
+}
+EXPORT_SYMBOL_GPL(schedtune_task_foreground);
+
 static u64
 prefer_idle_read(struct cgroup_subsys_state *css, struct cftype *cft)
 {
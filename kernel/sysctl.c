@@ -135,6 +135,7 @@ static unsigned long zero_ul;
 static unsigned long one_ul = 1;
 static unsigned long long_max = LONG_MAX;
 static int one_hundred = 100;
+static int one_thousand = 1000;
 #ifdef CONFIG_PRINTK
 static int ten_thousand = 10000;
 #endif
@@ -641,6 +642,15 @@ static struct ctl_table kern_table[] = {
 		.extra2		= &one,
 	},
 #endif /* CONFIG_SMP */
+	{
+		.procname	= "timer_deferrable_slack_ms",
+		.data		= &sysctl_timer_deferrable_slack_ms,
+		.maxlen		= sizeof(unsigned int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &zero,
+		.extra2		= &one_thousand,
+	},
 #ifdef CONFIG_NUMA_BALANCING
 	{
 		.procname	= "numa_balancing_scan_delay_ms",
@@ -747,6 +757,17 @@ static struct ctl_table kern_table[] = {
 	},
 #endif
 #endif
+#ifdef CONFIG_SCHED_PMU_STATS
+	{
+		.procname	= "sched_pmu_stats",
+		.data		= &sysctl_sched_pmu_stats,
+		.maxlen		= sizeof(unsigned int),
+		.mode		= 0644,
+		.proc_handler	= sched_pmu_stats_handler,
+		.extra1		= &zero,
+		.extra2		= &one,
+	},
+#endif
 #ifdef CONFIG_PROVE_LOCKING
 	{
 		.procname	= "prove_locking",
@@ -1871,6 +1892,13 @@ static struct ctl_table vm_table[] = {
 		.mode		= 0644,
 		.proc_handler	= proc_dointvec_minmax,
 	},
+	{
+		.procname	= "swap_ratio_adaptive",
+		.data		= &sysctl_swap_ratio_adaptive,
+		.maxlen		= sizeof(sysctl_swap_ratio_adaptive),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+	},
 #endif
 #ifdef CONFIG_HAVE_ARCH_MMAP_RND_BITS
 	{
@@ -43,6 +43,8 @@
 #include <linux/slab.h>
 #include <linux/compat.h>
 #include <linux/random.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 #include <asm/uaccess.h>
 #include <asm/unistd.h>
@@ -897,6 +899,22 @@ int mod_timer_pending(struct timer_list *timer, unsigned long expires)
 }
 EXPORT_SYMBOL(mod_timer_pending);
 
+/*
+ * Upper bound on the slack given to deferrable timers that have no
+ * explicit slack set. Deferrable timers already accept running late, so
+ * letting them drift onto a coarser power-of-two jiffy boundary makes
+ * timers armed by unrelated drivers on every CPU expire together.
+ */
+unsigned int sysctl_timer_deferrable_slack_ms = 100;
+
+struct timer_slack_stats {
+	unsigned long	armed;
+	unsigned long	grouped;
+	unsigned long	fired;
+	unsigned long	fired_deferrable;
+};
+static DEFINE_PER_CPU(struct timer_slack_stats, timer_slack_stats);
+
 /*
  * Decide where to put the timer while taking the slack into account
  *
@@ -915,6 +933,21 @@ unsigned long apply_slack(struct timer_list *timer, unsigned long expires)
 
 	if (timer->slack >= 0) {
 		expires_limit = expires + timer->slack;
+	} else if (tbase_get_deferrable(timer->base) &&
+		   sysctl_timer_deferrable_slack_ms) {
+		long delta = expires - jiffies;
+		unsigned long slack;
+
+		this_cpu_inc(timer_slack_stats.armed);
+		if (delta <= 0)
+			return expires;
+
+		slack = min_t(unsigned long, delta / 4,
+			msecs_to_jiffies(sysctl_timer_deferrable_slack_ms));
+		if (!slack)
+			return expires;
+
+		expires_limit = expires + slack;
 	} else {
 		long delta = expires - jiffies;
 
@@ -933,6 +966,10 @@ unsigned long apply_slack(struct timer_list *timer, unsigned long expires)
 
 	expires_limit = expires_limit & ~(mask);
 
+	if (timer->slack < 0 && tbase_get_deferrable(timer->base) &&
+	    expires_limit != expires)
+		this_cpu_inc(timer_slack_stats.grouped);
+
 	return expires_limit;
 }
 
@@ -1289,6 +1326,10 @@ static inline void __run_timers(struct tvec_base *base)
 			irqsafe = tbase_get_irqsafe(timer->base);
 
 			timer_stats_account_timer(timer);
+			if (tbase_get_deferrable(timer->base))
+				this_cpu_inc(timer_slack_stats.fired_deferrable);
+			else
+				this_cpu_inc(timer_slack_stats.fired);
 
 			base->running_timer = timer;
 			detach_expired_timer(timer, base);
@@ -1814,6 +1855,44 @@ void __init init_timers(void)
 	open_softirq(TIMER_SOFTIRQ, run_timer_softirq);
 }
 
+#ifdef CONFIG_DEBUG_FS
+static int timer_slack_stats_show(struct seq_file *m, void *unused)
+{
+	struct timer_slack_stats *st;
+	int cpu;
+
+	seq_printf(m, "deferrable slack: %u ms\n",
+		   sysctl_timer_deferrable_slack_ms);
+	seq_puts(m, "cpu  def_armed  def_grouped  fired  def_fired\n");
+	for_each_possible_cpu(cpu) {
+		st = &per_cpu(timer_slack_stats, cpu);
+		seq_printf(m, "%3d %10lu %12lu %6lu %10lu\n", cpu, st->armed,
+			   st->grouped, st->fired, st->fired_deferrable);
+	}
+	return 0;
+}
+
+static int timer_slack_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, timer_slack_stats_show, NULL);
+}
+
+static const struct file_operations timer_slack_stats_fops = {
+	.open		= timer_slack_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init timer_slack_debugfs_init(void)
+{
+	debugfs_create_file("timer_slack_stats", S_IRUGO, NULL, NULL,
+			    &timer_slack_stats_fops);
+	return 0;
+}
+late_initcall(timer_slack_debugfs_init);
+#endif
+
 /**
  * msleep - sleep safely even with waitqueue interruptions
  * @msecs: Time in milliseconds to sleep for
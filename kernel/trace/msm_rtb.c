@@ -66,10 +66,19 @@ struct msm_rtb_state {
 	int initialized;
 	uint32_t filter;
 	int step_size;
+	int seg_entries;
 };
 
 #if defined(CONFIG_MSM_RTB_SEPARATE_CPUS)
+/*
+ * Each cpu owns a contiguous segment of seg_entries slots and its own
+ * sequence counter, so loggers on different cpus never touch the same
+ * index or buffer lines. The idx stored in an entry is still
+ * seq * step_size + cpu, so entries from all segments sort into one
+ * global order the same way as before.
+ */
 DEFINE_PER_CPU(atomic_t, msm_rtb_idx_cpu);
+static DEFINE_PER_CPU(struct msm_rtb_layout *, msm_rtb_seg_cpu);
 #else
 static atomic_t msm_rtb_idx;
 #endif
@@ -79,13 +88,60 @@ static struct msm_rtb_state msm_rtb = {
 	.enabled = 1,
 };
 
-module_param_named(filter, msm_rtb.filter, uint, 0644);
-module_param_named(enable, msm_rtb.enabled, int, 0644);
+/*
+ * Event types that currently get logged: the runtime filter, limited to
+ * the types compiled in, or 0 while RTB is disabled or not yet set up.
+ * Tested inline by uncached_logk() before anything else is touched.
+ */
+uint32_t msm_rtb_log_mask __read_mostly;
+EXPORT_SYMBOL(msm_rtb_log_mask);
+
+static void msm_rtb_update_mask(void)
+{
+	if (msm_rtb.initialized && msm_rtb.enabled)
+		msm_rtb_log_mask = msm_rtb.filter & CONFIG_MSM_RTB_EVENT_MASK;
+	else
+		msm_rtb_log_mask = 0;
+}
+
+static int msm_rtb_set_filter(const char *val, const struct kernel_param *kp)
+{
+	int ret;
+
+	ret = param_set_uint(val, kp);
+	if (!ret)
+		msm_rtb_update_mask();
+	return ret;
+}
+
+static int msm_rtb_set_enable(const char *val, const struct kernel_param *kp)
+{
+	int ret;
+
+	ret = param_set_int(val, kp);
+	if (!ret)
+		msm_rtb_update_mask();
+	return ret;
+}
+
+static struct kernel_param_ops msm_rtb_filter_ops = {
+	.set = msm_rtb_set_filter,
+	.get = param_get_uint,
+};
+
+static struct kernel_param_ops msm_rtb_enable_ops = {
+	.set = msm_rtb_set_enable,
+	.get = param_get_int,
+};
+
+module_param_cb(filter, &msm_rtb_filter_ops, &msm_rtb.filter, 0644);
+module_param_cb(enable, &msm_rtb_enable_ops, &msm_rtb.enabled, 0644);
 
 static int msm_rtb_panic_notifier(struct notifier_block *this,
 					unsigned long event, void *ptr)
 {
 	msm_rtb.enabled = 0;
+	msm_rtb_update_mask();
 	return NOTIFY_DONE;
 }
 
@@ -96,8 +152,7 @@ static struct notifier_block msm_rtb_panic_blk = {
 
 int notrace msm_rtb_event_should_log(enum logk_event_type log_type)
 {
-	return msm_rtb.initialized && msm_rtb.enabled &&
-		((1 << (log_type & ~LOGTYPE_NOPC)) & msm_rtb.filter);
+	return (1 << (log_type & ~LOGTYPE_NOPC)) & msm_rtb_log_mask;
 }
 EXPORT_SYMBOL(msm_rtb_event_should_log);
 
@@ -141,12 +196,9 @@ static void msm_rtb_write_cyclecount(struct msm_rtb_layout *start)
 }
 
 static void uncached_logk_pc_idx(enum logk_event_type log_type, uint64_t caller,
-				 uint64_t data, int idx)
+				 uint64_t data, int idx,
+				 struct msm_rtb_layout *start)
 {
-	struct msm_rtb_layout *start;
-
-	start = &msm_rtb.rtb[idx & (msm_rtb.nentries - 1)];
-
 	msm_rtb_emit_sentinel(start);
 	msm_rtb_write_type(log_type, start);
 	msm_rtb_write_caller(caller, start);
@@ -159,20 +211,21 @@ static void uncached_logk_pc_idx(enum logk_event_type log_type, uint64_t caller,
 	return;
 }
 
-static void uncached_logk_timestamp(int idx)
+static void uncached_logk_timestamp(int idx, struct msm_rtb_layout *start)
 {
 	unsigned long long timestamp;
 
 	timestamp = sched_clock();
 	uncached_logk_pc_idx(LOGK_TIMESTAMP|LOGTYPE_NOPC,
 			(uint64_t)lower_32_bits(timestamp),
-			(uint64_t)upper_32_bits(timestamp), idx);
+			(uint64_t)upper_32_bits(timestamp), idx, start);
 }
 
 #if defined(CONFIG_MSM_RTB_SEPARATE_CPUS)
-static int msm_rtb_get_idx(void)
+static int msm_rtb_get_idx(struct msm_rtb_layout **start)
 {
-	int cpu, i, offset;
+	struct msm_rtb_layout *seg;
+	int cpu, seq, mask;
 	atomic_t *index;
 
 	/*
@@ -182,23 +235,22 @@ static int msm_rtb_get_idx(void)
 	cpu = raw_smp_processor_id();
 
 	index = &per_cpu(msm_rtb_idx_cpu, cpu);
+	seg = per_cpu(msm_rtb_seg_cpu, cpu);
+	mask = msm_rtb.seg_entries - 1;
 
-	i = atomic_add_return(msm_rtb.step_size, index);
-	i -= msm_rtb.step_size;
+	seq = atomic_inc_return(index) - 1;
 
-	/* Check if index has wrapped around */
-	offset = (i & (msm_rtb.nentries - 1)) -
-		 ((i - msm_rtb.step_size) & (msm_rtb.nentries - 1));
-	if (offset < 0) {
-		uncached_logk_timestamp(i);
-		i = atomic_add_return(msm_rtb.step_size, index);
-		i -= msm_rtb.step_size;
+	/* Start every lap of the segment with a timestamp */
+	if (!(seq & mask)) {
+		uncached_logk_timestamp(seq * msm_rtb.step_size + cpu, seg);
+		seq = atomic_inc_return(index) - 1;
 	}
 
-	return i;
+	*start = &seg[seq & mask];
+	return seq * msm_rtb.step_size + cpu;
 }
 #else
-static int msm_rtb_get_idx(void)
+static int msm_rtb_get_idx(struct msm_rtb_layout **start)
 {
 	int i, offset;
 
@@ -209,42 +261,46 @@ static int msm_rtb_get_idx(void)
 	offset = (i & (msm_rtb.nentries - 1)) -
 		 ((i - 1) & (msm_rtb.nentries - 1));
 	if (offset < 0) {
-		uncached_logk_timestamp(i);
+		uncached_logk_timestamp(i,
+				&msm_rtb.rtb[i & (msm_rtb.nentries - 1)]);
 		i = atomic_inc_return(&msm_rtb_idx);
 		i--;
 	}
 
+	*start = &msm_rtb.rtb[i & (msm_rtb.nentries - 1)];
 	return i;
 }
 #endif
 
-int notrace uncached_logk_pc(enum logk_event_type log_type, void *caller,
+int notrace __uncached_logk_pc(enum logk_event_type log_type, void *caller,
 				void *data)
 {
+	struct msm_rtb_layout *start;
 	int i;
 
 	if (!msm_rtb_event_should_log(log_type))
 		return 0;
 
-	i = msm_rtb_get_idx();
+	i = msm_rtb_get_idx(&start);
 	uncached_logk_pc_idx(log_type, (uint64_t)((unsigned long) caller),
-				(uint64_t)((unsigned long) data), i);
+				(uint64_t)((unsigned long) data), i, start);
 
 	return 1;
 }
-EXPORT_SYMBOL(uncached_logk_pc);
+EXPORT_SYMBOL(__uncached_logk_pc);
 
-noinline int notrace uncached_logk(enum logk_event_type log_type, void *data)
+noinline int notrace __uncached_logk(enum logk_event_type log_type, void *data)
 {
-	return uncached_logk_pc(log_type, __builtin_return_address(0), data);
+	return __uncached_logk_pc(log_type, __builtin_return_address(0), data);
 }
-EXPORT_SYMBOL(uncached_logk);
+EXPORT_SYMBOL(__uncached_logk);
 
 static int msm_rtb_probe(struct platform_device *pdev)
 {
 	struct msm_rtb_platform_data *d = pdev->dev.platform_data;
 #if defined(CONFIG_MSM_RTB_SEPARATE_CPUS)
 	unsigned int cpu;
+	int i;
 #endif
 	int ret;
 
@@ -296,19 +352,31 @@ static int msm_rtb_probe(struct platform_device *pdev)
 
 
 #if defined(CONFIG_MSM_RTB_SEPARATE_CPUS)
+	msm_rtb.step_size = num_possible_cpus();
+	msm_rtb.seg_entries = __rounddown_pow_of_two(msm_rtb.nentries /
+						     msm_rtb.step_size);
+	if (msm_rtb.seg_entries < 2) {
+		dma_free_coherent(&pdev->dev, msm_rtb.size, msm_rtb.rtb,
+				  msm_rtb.phys);
+		return -EINVAL;
+	}
+
+	i = 0;
 	for_each_possible_cpu(cpu) {
-		atomic_t *a = &per_cpu(msm_rtb_idx_cpu, cpu);
-		atomic_set(a, cpu);
+		atomic_set(&per_cpu(msm_rtb_idx_cpu, cpu), 0);
+		per_cpu(msm_rtb_seg_cpu, cpu) =
+				&msm_rtb.rtb[i++ * msm_rtb.seg_entries];
 	}
-	msm_rtb.step_size = num_possible_cpus();
 #else
 	atomic_set(&msm_rtb_idx, 0);
 	msm_rtb.step_size = 1;
+	msm_rtb.seg_entries = msm_rtb.nentries;
 #endif
 
 	atomic_notifier_chain_register(&panic_notifier_list,
 						&msm_rtb_panic_blk);
 	msm_rtb.initialized = 1;
+	msm_rtb_update_mask();
 	return 0;
 }
 
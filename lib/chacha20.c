@@ -0,0 +1,56 @@
+/*
+ * ChaCha20 256-bit cipher algorithm, RFC7539
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <linux/kernel.h>
+#include <linux/export.h>
+#include <linux/bitops.h>
+#include <asm/byteorder.h>
+#include <crypto/chacha20.h>
+
+#define CHACHA20_QR(a, b, c, d) do {			\
+	a += b; d = rol32(d ^ a, 16);			\
+	c += d; b = rol32(b ^ c, 12);			\
+	a += b; d = rol32(d ^ a, 8);			\
+	c += d; b = rol32(b ^ c, 7);			\
+} while (0)
+
+/**
+ * chacha20_block - generate one ChaCha20 keystream block
+ * @state: 16 word input state: constants, key, block counter and nonce
+ * @stream: output buffer of CHACHA20_BLOCK_SIZE bytes
+ *
+ * The block counter in @state[12] is incremented.
+ */
+void chacha20_block(u32 *state, void *stream)
+{
+	u32 x[16];
+	__le32 *out = stream;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(x); i++)
+		x[i] = state[i];
+
+	for (i = 0; i < 20; i += 2) {
+		CHACHA20_QR(x[0], x[4], x[8],  x[12]);
+		CHACHA20_QR(x[1], x[5], x[9],  x[13]);
+		CHACHA20_QR(x[2], x[6], x[10], x[14]);
+		CHACHA20_QR(x[3], x[7], x[11], x[15]);
+
+		CHACHA20_QR(x[0], x[5], x[10], x[15]);
+		CHACHA20_QR(x[1], x[6], x[11], x[12]);
+		CHACHA20_QR(x[2], x[7], x[8],  x[13]);
+		CHACHA20_QR(x[3], x[4], x[9],  x[14]);
+	}
+
+	for (i = 0; i < ARRAY_SIZE(x); i++)
+		out[i] = cpu_to_le32(x[i] + state[i]);
+
+	state[12]++;
+}
+EXPORT_SYMBOL(chacha20_block);
@@ -18,6 +18,10 @@
 #include <linux/errno.h>
 #include <linux/io.h>
 #include <linux/string.h>
+#include <linux/hashtable.h>
+#include <linux/rcupdate.h>
+#include <linux/spinlock.h>
+#include <linux/notifier.h>
 #include <linux/qmi_encdec.h>
 
 #include "qmi_encdec_priv.h"
@@ -92,6 +96,16 @@ static int _qmi_kernel_decode(struct elem_info *ei_array,
 static struct elem_info *skip_to_next_elem(struct elem_info *ei_array,
 					   int level);
 
+#ifdef CONFIG_QMI_ENCDEC_PRECOMPILE
+struct qmi_elem_prog;
+
+static struct qmi_elem_prog *qmi_prog_get(struct elem_info *ei_array);
+static int qmi_prog_encode(struct qmi_elem_prog *prog, void *out_buf,
+			   void *in_c_struct, uint32_t out_buf_len);
+static int qmi_prog_decode(struct qmi_elem_prog *prog, void *out_c_struct,
+			   void *in_buf, uint32_t in_buf_len);
+#endif
+
 /**
  * qmi_calc_max_msg_len() - Calculate the maximum length of a QMI message
  * @ei_array: Struct info array describing the structure.
@@ -231,6 +245,9 @@ int qmi_kernel_encode(struct msg_desc *desc,
 {
 	int enc_level = 1;
 	int ret, calc_max_msg_len, calc_min_msg_len;
+#ifdef CONFIG_QMI_ENCDEC_PRECOMPILE
+	struct qmi_elem_prog *prog;
+#endif
 
 	if (!desc)
 		return -EINVAL;
@@ -257,8 +274,19 @@ int qmi_kernel_encode(struct msg_desc *desc,
 	if (desc->max_msg_len < out_buf_len)
 		return -ETOOSMALL;
 
+#ifdef CONFIG_QMI_ENCDEC_PRECOMPILE
+	rcu_read_lock();
+	prog = qmi_prog_get(desc->ei_array);
+	if (prog)
+		ret = qmi_prog_encode(prog, out_buf, in_c_struct, out_buf_len);
+	else
+		ret = _qmi_kernel_encode(desc->ei_array, out_buf,
+					 in_c_struct, out_buf_len, enc_level);
+	rcu_read_unlock();
+#else
 	ret = _qmi_kernel_encode(desc->ei_array, out_buf,
 				 in_c_struct, out_buf_len, enc_level);
+#endif
 	if (ret == -ETOOSMALL) {
 		calc_max_msg_len = qmi_calc_max_msg_len(desc->ei_array, 1);
 		pr_err("%s: Calc. len %d != Out buf len %d\n",
@@ -286,13 +314,10 @@ EXPORT_SYMBOL(qmi_kernel_encode);
 static int qmi_encode_basic_elem(void *buf_dst, void *buf_src,
 				 uint32_t elem_len, uint32_t elem_size)
 {
-	uint32_t i, rc = 0;
-
-	for (i = 0; i < elem_len; i++) {
-		QMI_ENCDEC_ENCODE_N_BYTES(buf_dst, buf_src, elem_size);
-		rc += elem_size;
-	}
+	uint32_t rc = elem_len * elem_size;
 
+	/* Basic elements are laid out the same way on the wire */
+	QMI_ENCDEC_ENCODE_N_BYTES(buf_dst, buf_src, rc);
 	return rc;
 }
 
@@ -580,6 +605,9 @@ int qmi_kernel_decode(struct msg_desc *desc, void *out_c_struct,
 {
 	int dec_level = 1;
 	int rc = 0;
+#ifdef CONFIG_QMI_ENCDEC_PRECOMPILE
+	struct qmi_elem_prog *prog;
+#endif
 
 	if (!desc || !desc->ei_array)
 		return -EINVAL;
@@ -590,8 +618,19 @@ int qmi_kernel_decode(struct msg_desc *desc, void *out_c_struct,
 	if (desc->max_msg_len < in_buf_len)
 		return -EINVAL;
 
+#ifdef CONFIG_QMI_ENCDEC_PRECOMPILE
+	rcu_read_lock();
+	prog = qmi_prog_get(desc->ei_array);
+	if (prog)
+		rc = qmi_prog_decode(prog, out_c_struct, in_buf, in_buf_len);
+	else
+		rc = _qmi_kernel_decode(desc->ei_array, out_c_struct,
+					in_buf, in_buf_len, dec_level);
+	rcu_read_unlock();
+#else
 	rc = _qmi_kernel_decode(desc->ei_array, out_c_struct,
 				in_buf, in_buf_len, dec_level);
+#endif
 	if (rc < 0)
 		return rc;
 	else
@@ -617,13 +656,10 @@ EXPORT_SYMBOL(qmi_kernel_decode);
 static int qmi_decode_basic_elem(void *buf_dst, void *buf_src,
 				 uint32_t elem_len, uint32_t elem_size)
 {
-	uint32_t i, rc = 0;
-
-	for (i = 0; i < elem_len; i++) {
-		QMI_ENCDEC_DECODE_N_BYTES(buf_dst, buf_src, elem_size);
-		rc += elem_size;
-	}
+	uint32_t rc = elem_len * elem_size;
 
+	/* Basic elements are laid out the same way in the C structure */
+	QMI_ENCDEC_DECODE_N_BYTES(buf_dst, buf_src, rc);
 	return rc;
 }
 
@@ -876,5 +912,543 @@ static int _qmi_kernel_decode(struct elem_info *ei_array,
 	}
 	return decoded_bytes;
 }
+
+#ifdef CONFIG_QMI_ENCDEC_PRECOMPILE
+/*
+ * Precompiled element tables
+ *
+ * The generic encoder/decoder re-derives, for every message, facts that
+ * only depend on the element info table: where each TLV ends, which entry
+ * a received TLV type maps to and whether a nested structure can simply
+ * be copied. The first time a top level table is used it is compiled into
+ * a flat sequence of ops holding that information and cached, keyed by
+ * the table address. Only tables living in kernel or module static data
+ * are cached; the cache entries of a module are dropped when it goes away.
+ * Tables that cannot be cached keep going through the generic walker.
+ */
+
+#define QMI_PROG_HASH_BITS 6
+#define QMI_PROG_NO_OP U16_MAX
+
+/**
+ * qmi_elem_op - Compiled form of one top level element info entry
+ * @ei: Element info entry the op has been compiled from.
+ * @next: Index of the first op of the following TLV.
+ * @flat_size: Wire size of one instance of a struct element that can be
+ *             copied verbatim to/from the C structure, 0 otherwise.
+ */
+struct qmi_elem_op {
+	struct elem_info *ei;
+	uint16_t next;
+	uint32_t flat_size;
+};
+
+/**
+ * qmi_elem_prog - Compiled top level element info table
+ * @node: Node in the program cache.
+ * @rcu: RCU head used to free the program.
+ * @ei_array: Element info table the program has been compiled from.
+ * @tlv_index: First op corresponding to each TLV type.
+ * @num_ops: Number of ops in the program.
+ * @ops: Ops, one per element info entry.
+ */
+struct qmi_elem_prog {
+	struct hlist_node node;
+	struct rcu_head rcu;
+	struct elem_info *ei_array;
+	uint16_t tlv_index[U8_MAX + 1];
+	uint16_t num_ops;
+	struct qmi_elem_op ops[0];
+};
+
+static DEFINE_HASHTABLE(qmi_prog_hash, QMI_PROG_HASH_BITS);
+static DEFINE_SPINLOCK(qmi_prog_lock);
+
+/**
+ * qmi_calc_flat_size() - Check whether a structure can be copied verbatim
+ * @ei_array: Struct info array describing the structure.
+ * @struct_size: Size of the C structure.
+ *
+ * @return: Wire size of the structure if its wire format matches its C
+ *          layout byte for byte, 0 otherwise.
+ *
+ * This is the case when all the members are basic data types or static
+ * arrays of them, laid out back to back with no padding in between or at
+ * the end of the C structure.
+ */
+static uint32_t qmi_calc_flat_size(struct elem_info *ei_array,
+				   uint32_t struct_size)
+{
+	struct elem_info *temp_ei;
+	uint32_t flat_size = 0;
+
+	if (!ei_array)
+		return 0;
+
+	for (temp_ei = ei_array; temp_ei->data_type != QMI_EOTI; temp_ei++) {
+		switch (temp_ei->data_type) {
+		case QMI_UNSIGNED_1_BYTE:
+		case QMI_UNSIGNED_2_BYTE:
+		case QMI_UNSIGNED_4_BYTE:
+		case QMI_UNSIGNED_8_BYTE:
+		case QMI_SIGNED_2_BYTE_ENUM:
+		case QMI_SIGNED_4_BYTE_ENUM:
+			break;
+		default:
+			return 0;
+		}
+
+		if (temp_ei->offset != flat_size)
+			return 0;
+
+		if (temp_ei->is_array == NO_ARRAY)
+			flat_size += temp_ei->elem_size;
+		else if (temp_ei->is_array == STATIC_ARRAY)
+			flat_size += temp_ei->elem_len * temp_ei->elem_size;
+		else
+			return 0;
+	}
+
+	return flat_size == struct_size ? flat_size : 0;
+}
+
+/**
+ * qmi_prog_compile() - Compile a top level element info table
+ * @ei_array: Struct info array describing the message.
+ *
+ * @return: Compiled program on success, NULL on failure.
+ */
+static struct qmi_elem_prog *qmi_prog_compile(struct elem_info *ei_array)
+{
+	struct qmi_elem_prog *prog;
+	struct qmi_elem_op *op;
+	uint32_t num_ops = 0;
+	uint16_t i, j;
+
+	while (ei_array[num_ops].data_type != QMI_EOTI)
+		if (++num_ops >= QMI_PROG_NO_OP)
+			return NULL;
+
+	prog = kzalloc(sizeof(*prog) + num_ops * sizeof(*op), GFP_ATOMIC);
+	if (!prog)
+		return NULL;
+
+	prog->ei_array = ei_array;
+	prog->num_ops = num_ops;
+	memset(prog->tlv_index, 0xFF, sizeof(prog->tlv_index));
+	for (i = 0; i < num_ops; i++) {
+		op = &prog->ops[i];
+		op->ei = &ei_array[i];
+
+		if (prog->tlv_index[op->ei->tlv_type] == QMI_PROG_NO_OP)
+			prog->tlv_index[op->ei->tlv_type] = i;
+
+		for (j = i + 1; j < num_ops; j++)
+			if (ei_array[j].tlv_type != op->ei->tlv_type)
+				break;
+		op->next = j;
+
+		if (op->ei->data_type == QMI_STRUCT)
+			op->flat_size = qmi_calc_flat_size(op->ei->ei_array,
+							   op->ei->elem_size);
+	}
+
+	return prog;
+}
+
+/**
+ * qmi_prog_lookup() - Find the compiled program of an element info table
+ * @ei_array: Struct info array describing the message.
+ *
+ * @return: Compiled program, if cached. Must be called under RCU read lock.
+ */
+static struct qmi_elem_prog *qmi_prog_lookup(struct elem_info *ei_array)
+{
+	struct qmi_elem_prog *prog;
+
+	hash_for_each_possible_rcu(qmi_prog_hash, prog, node,
+				   (unsigned long)ei_array)
+		if (prog->ei_array == ei_array)
+			return prog;
+
+	return NULL;
+}
+
+/**
+ * qmi_prog_add() - Compile an element info table and cache the program
+ * @ei_array: Struct info array describing the message.
+ */
+static void qmi_prog_add(struct elem_info *ei_array)
+{
+	struct qmi_elem_prog *prog;
+	unsigned long flags;
+
+	if (!core_kernel_data((unsigned long)ei_array) &&
+	    !is_module_address((unsigned long)ei_array))
+		return;
+
+	prog = qmi_prog_compile(ei_array);
+	if (!prog)
+		return;
+
+	spin_lock_irqsave(&qmi_prog_lock, flags);
+	if (qmi_prog_lookup(ei_array)) {
+		spin_unlock_irqrestore(&qmi_prog_lock, flags);
+		kfree(prog);
+		return;
+	}
+	hash_add_rcu(qmi_prog_hash, &prog->node, (unsigned long)ei_array);
+	spin_unlock_irqrestore(&qmi_prog_lock, flags);
+}
+
+/**
+ * qmi_prog_get() - Get the compiled program of an element info table
+ * @ei_array: Struct info array describing the message.
+ *
+ * @return: Compiled program, compiling it on first use, or NULL if the
+ *          table cannot be compiled. Must be called under RCU read lock.
+ */
+static struct qmi_elem_prog *qmi_prog_get(struct elem_info *ei_array)
+{
+	struct qmi_elem_prog *prog;
+
+	prog = qmi_prog_lookup(ei_array);
+	if (!prog) {
+		qmi_prog_add(ei_array);
+		prog = qmi_prog_lookup(ei_array);
+	}
+	return prog;
+}
+
+/**
+ * qmi_prog_encode() - Encode a message through its compiled program
+ * @prog: Compiled program of the message.
+ * @out_buf: Buffer to hold the encoded QMI message.
+ * @in_c_struct: Pointer to the C structure to be encoded.
+ * @out_buf_len: Available space in the encode buffer.
+ *
+ * @return: Number of bytes of encoded information, on success.
+ *          < 0 on error.
+ *
+ * Produces the same output as _qmi_kernel_encode() at encode level 1.
+ */
+static int qmi_prog_encode(struct qmi_elem_prog *prog, void *out_buf,
+			   void *in_c_struct, uint32_t out_buf_len)
+{
+	struct qmi_elem_op *op;
+	struct elem_info *temp_ei;
+	uint8_t opt_flag_value = 0;
+	uint32_t data_len_value = 0, data_len_sz;
+	uint8_t *buf_dst = (uint8_t *)out_buf;
+	uint8_t *tlv_pointer = buf_dst;
+	uint32_t tlv_len = 0;
+	uint32_t encoded_bytes = 0;
+	uint32_t copy_len;
+	void *buf_src;
+	int rc;
+	uint16_t i = 0;
+
+	buf_dst = buf_dst + (TLV_LEN_SIZE + TLV_TYPE_SIZE);
+	while (i < prog->num_ops) {
+		op = &prog->ops[i];
+		temp_ei = op->ei;
+		buf_src = in_c_struct + temp_ei->offset;
+
+		if (temp_ei->is_array == NO_ARRAY) {
+			data_len_value = 1;
+		} else if (temp_ei->is_array == STATIC_ARRAY) {
+			data_len_value = temp_ei->elem_len;
+		} else if (data_len_value <= 0 ||
+			    temp_ei->elem_len < data_len_value) {
+			pr_err("%s: Invalid data length\n", __func__);
+			return -EINVAL;
+		}
+
+		switch (temp_ei->data_type) {
+		case QMI_OPT_FLAG:
+			memcpy(&opt_flag_value, buf_src, sizeof(uint8_t));
+			i = opt_flag_value ? i + 1 : op->next;
+			continue;
+
+		case QMI_DATA_LEN:
+			data_len_value = 0;
+			memcpy(&data_len_value, buf_src, temp_ei->elem_size);
+			data_len_sz = temp_ei->elem_size == sizeof(uint8_t) ?
+					sizeof(uint8_t) : sizeof(uint16_t);
+			if ((data_len_sz + encoded_bytes + TLV_LEN_SIZE +
+			    TLV_TYPE_SIZE) > out_buf_len) {
+				pr_err("%s: Too Small Buffer @DATA_LEN\n",
+					__func__);
+				return -ETOOSMALL;
+			}
+			memcpy(buf_dst, &data_len_value, data_len_sz);
+			buf_dst += data_len_sz;
+			encoded_bytes += data_len_sz;
+			tlv_len += data_len_sz;
+			if (data_len_value) {
+				i++;
+				continue;
+			}
+			i = op->next;
+			goto encode_tlv;
+
+		case QMI_UNSIGNED_1_BYTE:
+		case QMI_UNSIGNED_2_BYTE:
+		case QMI_UNSIGNED_4_BYTE:
+		case QMI_UNSIGNED_8_BYTE:
+		case QMI_SIGNED_2_BYTE_ENUM:
+		case QMI_SIGNED_4_BYTE_ENUM:
+			copy_len = data_len_value * temp_ei->elem_size;
+			if ((copy_len + encoded_bytes + TLV_LEN_SIZE +
+			    TLV_TYPE_SIZE) > out_buf_len) {
+				pr_err("%s: Too Small Buffer @data_type:%d\n",
+					__func__, temp_ei->data_type);
+				return -ETOOSMALL;
+			}
+			memcpy(buf_dst, buf_src, copy_len);
+			QMI_ENCODE_LOG_ELEM(1, data_len_value,
+				temp_ei->elem_size, buf_src);
+			rc = copy_len;
+			break;
+
+		case QMI_STRUCT:
+			if (op->flat_size) {
+				copy_len = data_len_value * op->flat_size;
+				if ((copy_len + encoded_bytes + TLV_LEN_SIZE +
+				    TLV_TYPE_SIZE) > out_buf_len) {
+					pr_err("%s: Too Small Buffer @STRUCT\n",
+						__func__);
+					return -ETOOSMALL;
+				}
+				memcpy(buf_dst, buf_src, copy_len);
+				rc = copy_len;
+			} else {
+				rc = qmi_encode_struct_elem(temp_ei, buf_dst,
+					buf_src, data_len_value,
+					(out_buf_len - encoded_bytes), 2);
+				if (rc < 0)
+					return rc;
+			}
+			break;
+
+		case QMI_STRING:
+			rc = qmi_encode_string_elem(temp_ei, buf_dst, buf_src,
+				out_buf_len - encoded_bytes, 1);
+			if (rc < 0)
+				return rc;
+			break;
+
+		default:
+			pr_err("%s: Unrecognized data type\n", __func__);
+			return -EINVAL;
+		}
+		buf_dst += rc;
+		encoded_bytes += rc;
+		tlv_len += rc;
+		i++;
+
+encode_tlv:
+		QMI_ENCDEC_ENCODE_TLV(temp_ei->tlv_type, tlv_len, tlv_pointer);
+		QMI_ENCODE_LOG_TLV(temp_ei->tlv_type, tlv_len);
+		encoded_bytes += (TLV_TYPE_SIZE + TLV_LEN_SIZE);
+		tlv_pointer = buf_dst;
+		tlv_len = 0;
+		buf_dst = buf_dst + TLV_LEN_SIZE + TLV_TYPE_SIZE;
+	}
+	QMI_ENCODE_LOG_MSG(out_buf, encoded_bytes);
+	return encoded_bytes;
+}
+
+/**
+ * qmi_prog_decode() - Decode a message through its compiled program
+ * @prog: Compiled program of the message.
+ * @out_c_struct: Buffer to hold the decoded C struct.
+ * @in_buf: Buffer containing the QMI message to be decoded.
+ * @in_buf_len: Length of the QMI message to be decoded.
+ *
+ * @return: Number of bytes of decoded information, on success.
+ *          < 0 on error.
+ *
+ * Produces the same C structure as _qmi_kernel_decode() at decode level 1.
+ */
+static int qmi_prog_decode(struct qmi_elem_prog *prog, void *out_c_struct,
+			   void *in_buf, uint32_t in_buf_len)
+{
+	struct qmi_elem_op *op;
+	struct elem_info *temp_ei;
+	uint8_t opt_flag_value = 1;
+	uint32_t data_len_value = 0, data_len_sz;
+	uint8_t *buf_dst;
+	uint8_t *tlv_pointer;
+	uint32_t tlv_len = 0;
+	uint32_t tlv_type;
+	uint32_t decoded_bytes = 0;
+	uint32_t copy_len;
+	void *buf_src = in_buf;
+	uint16_t i;
+	int rc;
+
+	QMI_DECODE_LOG_MSG(in_buf, in_buf_len);
+	while (decoded_bytes < in_buf_len) {
+		if (in_buf_len - decoded_bytes < TLV_TYPE_SIZE + TLV_LEN_SIZE) {
+			pr_err("%s: Truncated TLV header\n", __func__);
+			return -EFAULT;
+		}
+		tlv_pointer = buf_src;
+		QMI_ENCDEC_DECODE_TLV(&tlv_type, &tlv_len, tlv_pointer);
+		QMI_DECODE_LOG_TLV(tlv_type, tlv_len);
+		buf_src += (TLV_TYPE_SIZE + TLV_LEN_SIZE);
+		decoded_bytes += (TLV_TYPE_SIZE + TLV_LEN_SIZE);
+
+		i = prog->tlv_index[tlv_type];
+		if (i == QMI_PROG_NO_OP && tlv_type < OPTIONAL_TLV_TYPE_START) {
+			pr_err("%s: Inval element info\n", __func__);
+			return -EINVAL;
+		} else if (i == QMI_PROG_NO_OP) {
+			UPDATE_DECODE_VARIABLES(buf_src, decoded_bytes, tlv_len);
+			continue;
+		}
+		op = &prog->ops[i];
+		temp_ei = op->ei;
+
+		buf_dst = out_c_struct + temp_ei->offset;
+		if (temp_ei->data_type == QMI_OPT_FLAG) {
+			memcpy(buf_dst, &opt_flag_value, sizeof(uint8_t));
+			if (++i >= prog->num_ops)
+				return -EINVAL;
+			op = &prog->ops[i];
+			temp_ei = op->ei;
+			buf_dst = out_c_struct + temp_ei->offset;
+		}
+
+		if (temp_ei->data_type == QMI_DATA_LEN) {
+			data_len_value = 0;
+			data_len_sz = temp_ei->elem_size == sizeof(uint8_t) ?
+					sizeof(uint8_t) : sizeof(uint16_t);
+			if (in_buf_len - decoded_bytes < data_len_sz ||
+			    tlv_len < data_len_sz) {
+				pr_err("%s: Truncated data len in TLV %d\n",
+					__func__, tlv_type);
+				return -EFAULT;
+			}
+			memcpy(&data_len_value, buf_src, data_len_sz);
+			memcpy(buf_dst, &data_len_value, sizeof(uint32_t));
+			if (++i >= prog->num_ops)
+				return -EINVAL;
+			op = &prog->ops[i];
+			temp_ei = op->ei;
+			buf_dst = out_c_struct + temp_ei->offset;
+			tlv_len -= data_len_sz;
+			UPDATE_DECODE_VARIABLES(buf_src, decoded_bytes,
+						data_len_sz);
+		}
+
+		if (temp_ei->is_array == NO_ARRAY) {
+			data_len_value = 1;
+		} else if (temp_ei->is_array == STATIC_ARRAY) {
+			data_len_value = temp_ei->elem_len;
+		} else if (data_len_value > temp_ei->elem_len) {
+			pr_err("%s: Data len %d > max spec %d\n",
+				__func__, data_len_value, temp_ei->elem_len);
+			return -ETOOSMALL;
+		}
+
+		switch (temp_ei->data_type) {
+		case QMI_UNSIGNED_1_BYTE:
+		case QMI_UNSIGNED_2_BYTE:
+		case QMI_UNSIGNED_4_BYTE:
+		case QMI_UNSIGNED_8_BYTE:
+		case QMI_SIGNED_2_BYTE_ENUM:
+		case QMI_SIGNED_4_BYTE_ENUM:
+			copy_len = data_len_value * temp_ei->elem_size;
+			if (copy_len > in_buf_len - decoded_bytes) {
+				pr_err("%s: Elem len %d > Input Buffer Len %d\n",
+					__func__, copy_len,
+					in_buf_len - decoded_bytes);
+				return -EFAULT;
+			}
+			memcpy(buf_dst, buf_src, copy_len);
+			QMI_DECODE_LOG_ELEM(1, data_len_value,
+				temp_ei->elem_size, buf_dst);
+			rc = copy_len;
+			break;
+
+		case QMI_STRUCT:
+			if (op->flat_size) {
+				/*
+				 * Same acceptance as qmi_decode_struct_elem():
+				 * up to data_len_value whole instances filling
+				 * the TLV exactly.
+				 */
+				if (tlv_len > data_len_value * op->flat_size ||
+				    tlv_len % op->flat_size ||
+				    tlv_len > in_buf_len - decoded_bytes) {
+					pr_err("%s: Fault in decoding: tl(%d), el(%d)\n",
+						__func__, tlv_len,
+						data_len_value);
+					return -EFAULT;
+				}
+				memcpy(buf_dst, buf_src, tlv_len);
+				rc = tlv_len;
+			} else {
+				rc = qmi_decode_struct_elem(temp_ei, buf_dst,
+					buf_src, data_len_value, tlv_len, 2);
+				if (rc < 0)
+					return rc;
+			}
+			break;
+
+		case QMI_STRING:
+			rc = qmi_decode_string_elem(temp_ei, buf_dst, buf_src,
+						     tlv_len, 1);
+			if (rc < 0)
+				return rc;
+			break;
+
+		default:
+			pr_err("%s: Unrecognized data type\n", __func__);
+			return -EINVAL;
+		}
+		UPDATE_DECODE_VARIABLES(buf_src, decoded_bytes, rc);
+	}
+	return decoded_bytes;
+}
+
+#ifdef CONFIG_MODULES
+static int qmi_prog_module_notify(struct notifier_block *nb,
+				  unsigned long action, void *data)
+{
+	struct module *mod = data;
+	struct qmi_elem_prog *prog;
+	struct hlist_node *tmp;
+	unsigned long flags;
+	int bkt;
+
+	if (action != MODULE_STATE_GOING)
+		return NOTIFY_DONE;
+
+	spin_lock_irqsave(&qmi_prog_lock, flags);
+	hash_for_each_safe(qmi_prog_hash, bkt, tmp, prog, node) {
+		if (!within_module_core((unsigned long)prog->ei_array, mod))
+			continue;
+		hash_del_rcu(&prog->node);
+		kfree_rcu(prog, rcu);
+	}
+	spin_unlock_irqrestore(&qmi_prog_lock, flags);
+	return NOTIFY_OK;
+}
+
+static struct notifier_block qmi_prog_module_nb = {
+	.notifier_call = qmi_prog_module_notify,
+};
+
+static int __init qmi_encdec_init(void)
+{
+	return register_module_notifier(&qmi_prog_module_nb);
+}
+core_initcall(qmi_encdec_init);
+#endif
+#endif
+
 MODULE_DESCRIPTION("QMI kernel enc/dec");
 MODULE_LICENSE("GPL v2");
@@ -38,6 +38,7 @@
 #include <linux/kmemleak.h>
 #include <trace/events/cma.h>
 #include <linux/io.h>
+#include <linux/workqueue.h>
 
 #include "cma.h"
 
@@ -93,6 +94,9 @@ static void cma_clear_bitmap(struct cma *cma, unsigned long pfn,
 	mutex_unlock(&cma->lock);
 }
 
+static void cma_prepare_workfn(struct work_struct *work);
+static void cma_reserve_expire_workfn(struct work_struct *work);
+
 static int __init cma_activate_area(struct cma *cma)
 {
 	int bitmap_size = BITS_TO_LONGS(cma_bitmap_maxno(cma)) * sizeof(long);
@@ -129,6 +133,8 @@ static int __init cma_activate_area(struct cma *cma)
 	} while (--i);
 
 	mutex_init(&cma->lock);
+	INIT_WORK(&cma->prepare_work, cma_prepare_workfn);
+	INIT_DELAYED_WORK(&cma->reserve_expire_work, cma_reserve_expire_workfn);
 
 #ifdef CONFIG_CMA_DEBUGFS
 	INIT_HLIST_HEAD(&cma->mem_head);
@@ -374,16 +380,8 @@ err:
 	return ret;
 }
 
-/**
- * cma_alloc() - allocate pages from contiguous area
- * @cma:   Contiguous memory region for which the allocation is performed.
- * @count: Requested number of pages.
- * @align: Requested alignment of pages (in PAGE_SIZE order).
- *
- * This function allocates part of contiguous memory on specific
- * contiguous memory area.
- */
-struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align)
+static struct page *__cma_alloc(struct cma *cma, size_t count,
+				unsigned int align)
 {
 	unsigned long mask, offset, pfn, start = 0;
 	unsigned long bitmap_maxno, bitmap_no, bitmap_count;
@@ -470,6 +468,156 @@ struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align)
 	return page;
 }
 
+/*
+ * How long a window migrated by cma_prepare() is held for the allocation
+ * it was prepared for before its pages are given back.
+ */
+#define CMA_RESERVE_TIMEOUT	(2 * HZ)
+
+static void cma_release_reserve(struct cma *cma)
+{
+	unsigned long pfn;
+	size_t count;
+
+	mutex_lock(&cma->lock);
+	pfn = cma->reserve_pfn;
+	count = cma->reserve_count;
+	cma->reserve_count = 0;
+	mutex_unlock(&cma->lock);
+
+	if (count) {
+		free_contig_range(pfn, count);
+		cma_clear_bitmap(cma, pfn, count);
+	}
+}
+
+static void cma_reserve_expire_workfn(struct work_struct *work)
+{
+	struct cma *cma = container_of(to_delayed_work(work), struct cma,
+				       reserve_expire_work);
+
+	cma_release_reserve(cma);
+}
+
+static void cma_prepare_workfn(struct work_struct *work)
+{
+	struct cma *cma = container_of(work, struct cma, prepare_work);
+	struct page *page;
+	size_t count;
+	unsigned int align;
+	bool fits;
+
+	mutex_lock(&cma->lock);
+	count = cma->prepare_count;
+	align = cma->prepare_align;
+	fits = cma->reserve_count >= count;
+	mutex_unlock(&cma->lock);
+
+	/* A big enough window is already waiting, just keep it longer */
+	if (!fits) {
+		cma_release_reserve(cma);
+		page = __cma_alloc(cma, count, align);
+		if (!page)
+			return;
+
+		mutex_lock(&cma->lock);
+		cma->reserve_pfn = page_to_pfn(page);
+		cma->reserve_count = count;
+		mutex_unlock(&cma->lock);
+	}
+
+	mod_delayed_work(system_wq, &cma->reserve_expire_work,
+			 CMA_RESERVE_TIMEOUT);
+}
+
+/*
+ * Hand out the start of the prepared window if it satisfies the request,
+ * and give the unused tail of the window back.
+ */
+static struct page *cma_claim_reserve(struct cma *cma, size_t count,
+				      unsigned int align)
+{
+	unsigned long mask, offset, pfn, used_pfn, end_pfn;
+
+	mask = cma_bitmap_aligned_mask(cma, align);
+	offset = cma_bitmap_aligned_offset(cma, align);
+
+	mutex_lock(&cma->lock);
+	pfn = cma->reserve_pfn;
+	if (count > cma->reserve_count ||
+	    ((((pfn - cma->base_pfn) >> cma->order_per_bit) + offset) & mask)) {
+		mutex_unlock(&cma->lock);
+		return NULL;
+	}
+	end_pfn = pfn + cma->reserve_count;
+	cma->reserve_count = 0;
+	mutex_unlock(&cma->lock);
+
+	cancel_delayed_work(&cma->reserve_expire_work);
+
+	used_pfn = pfn + (cma_bitmap_pages_to_bits(cma, count) <<
+			  cma->order_per_bit);
+	if (pfn + count < end_pfn)
+		free_contig_range(pfn + count, end_pfn - (pfn + count));
+	if (used_pfn < end_pfn)
+		cma_clear_bitmap(cma, used_pfn, end_pfn - used_pfn);
+
+	trace_cma_alloc(pfn, pfn_to_page(pfn), count, align);
+	return pfn_to_page(pfn);
+}
+
+/**
+ * cma_alloc() - allocate pages from contiguous area
+ * @cma:   Contiguous memory region for which the allocation is performed.
+ * @count: Requested number of pages.
+ * @align: Requested alignment of pages (in PAGE_SIZE order).
+ *
+ * This function allocates part of contiguous memory on specific
+ * contiguous memory area.
+ */
+struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align)
+{
+	struct page *page;
+
+	if (!cma || !cma->count || !count)
+		return NULL;
+
+	page = cma_claim_reserve(cma, count, align);
+	if (page)
+		return page;
+
+	return __cma_alloc(cma, count, align);
+}
+
+/**
+ * cma_prepare() - migrate pages ahead of an expected allocation
+ * @cma:   Contiguous memory region the allocation will be made from.
+ * @count: Expected number of pages.
+ * @align: Expected alignment of pages (in PAGE_SIZE order).
+ *
+ * Moves movable pages out of a suitable window of the area in the
+ * background, so that a cma_alloc() of at most @count pages arriving
+ * shortly after only has to claim pages that are already free instead
+ * of stalling on migration.  The window is given back if no allocation
+ * claims it within CMA_RESERVE_TIMEOUT.
+ */
+int cma_prepare(struct cma *cma, size_t count, unsigned int align)
+{
+	if (!cma || !cma->count || !count)
+		return -EINVAL;
+
+	if (cma_bitmap_pages_to_bits(cma, count) > cma_bitmap_maxno(cma))
+		return -EINVAL;
+
+	mutex_lock(&cma->lock);
+	cma->prepare_count = count;
+	cma->prepare_align = align;
+	mutex_unlock(&cma->lock);
+
+	queue_work(system_unbound_wq, &cma->prepare_work);
+	return 0;
+}
+
 /**
  * cma_release() - release allocated pages
  * @cma:   Contiguous memory region for which the allocation is performed.
@@ -1,12 +1,21 @@
 #ifndef __MM_CMA_H__
 #define __MM_CMA_H__
 
+#include <linux/workqueue.h>
+
 struct cma {
 	unsigned long   base_pfn;
 	unsigned long   count;
 	unsigned long   *bitmap;
 	unsigned int order_per_bit; /* Order of pages represented by one bit */
 	struct mutex    lock;
+	/* pre-migrated window, see cma_prepare(); protected by @lock */
+	size_t		prepare_count;
+	unsigned int	prepare_align;
+	unsigned long	reserve_pfn;
+	size_t		reserve_count;
+	struct work_struct prepare_work;
+	struct delayed_work reserve_expire_work;
 #ifdef CONFIG_CMA_DEBUGFS
 	struct hlist_head mem_head;
 	spinlock_t mem_head_lock;
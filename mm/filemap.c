@@ -35,6 +35,7 @@
 #include <linux/memcontrol.h>
 #include <linux/cleancache.h>
 #include <linux/rmap.h>
+#include <linux/psi.h>
 #include "internal.h"
 
 #define CREATE_TRACE_POINTS
@@ -636,7 +637,11 @@ int add_to_page_cache_lru(struct page *page, struct address_space *mapping,
 		 * recently, in which case it should be activated like
 		 * any other repeatedly accessed page.
 		 */
-		if (shadow && workingset_refault(shadow)) {
+		bool active = shadow && workingset_refault(shadow);
+
+		if (shadow)
+			mem_cgroup_workingset_refault(page, active);
+		if (active) {
 			SetPageActive(page);
 			workingset_activation(page);
 		} else
@@ -686,25 +691,52 @@ wait_queue_head_t *page_waitqueue(struct page *page)
 }
 EXPORT_SYMBOL(page_waitqueue);
 
+/*
+ * Pages found to be refaulting from the workingset are added to the
+ * page cache active. Waiting for such a page to be read back in is a
+ * memory stall rather than plain IO.
+ */
+static inline bool page_refault_wait(struct page *page, int bit_nr)
+{
+	return bit_nr == PG_locked && !PageUptodate(page) && PageActive(page);
+}
+
 void wait_on_page_bit(struct page *page, int bit_nr)
 {
 	DEFINE_WAIT_BIT(wait, &page->flags, bit_nr);
+	unsigned long pflags;
+	bool refault;
 
-	if (test_bit(bit_nr, &page->flags))
+	if (test_bit(bit_nr, &page->flags)) {
+		refault = page_refault_wait(page, bit_nr);
+		if (refault)
+			psi_memstall_enter(&pflags);
 		__wait_on_bit(page_waitqueue(page), &wait, bit_wait_io,
 							TASK_UNINTERRUPTIBLE);
+		if (refault)
+			psi_memstall_leave(&pflags);
+	}
 }
 EXPORT_SYMBOL(wait_on_page_bit);
 
 int wait_on_page_bit_killable(struct page *page, int bit_nr)
 {
 	DEFINE_WAIT_BIT(wait, &page->flags, bit_nr);
+	unsigned long pflags;
+	bool refault;
+	int ret;
 
 	if (!test_bit(bit_nr, &page->flags))
 		return 0;
 
-	return __wait_on_bit(page_waitqueue(page), &wait,
-			     bit_wait_io, TASK_KILLABLE);
+	refault = page_refault_wait(page, bit_nr);
+	if (refault)
+		psi_memstall_enter(&pflags);
+	ret = __wait_on_bit(page_waitqueue(page), &wait,
+			    bit_wait_io, TASK_KILLABLE);
+	if (refault)
+		psi_memstall_leave(&pflags);
+	return ret;
 }
 
 int wait_on_page_bit_killable_timeout(struct page *page,
@@ -820,18 +852,32 @@ EXPORT_SYMBOL_GPL(page_endio);
 void __lock_page(struct page *page)
 {
 	DEFINE_WAIT_BIT(wait, &page->flags, PG_locked);
+	bool refault = page_refault_wait(page, PG_locked);
+	unsigned long pflags;
 
+	if (refault)
+		psi_memstall_enter(&pflags);
 	__wait_on_bit_lock(page_waitqueue(page), &wait, bit_wait_io,
 							TASK_UNINTERRUPTIBLE);
+	if (refault)
+		psi_memstall_leave(&pflags);
 }
 EXPORT_SYMBOL(__lock_page);
 
 int __lock_page_killable(struct page *page)
 {
 	DEFINE_WAIT_BIT(wait, &page->flags, PG_locked);
+	bool refault = page_refault_wait(page, PG_locked);
+	unsigned long pflags;
+	int ret;
 
-	return __wait_on_bit_lock(page_waitqueue(page), &wait,
+	if (refault)
+		psi_memstall_enter(&pflags);
+	ret = __wait_on_bit_lock(page_waitqueue(page), &wait,
 					bit_wait_io, TASK_KILLABLE);
+	if (refault)
+		psi_memstall_leave(&pflags);
+	return ret;
 }
 EXPORT_SYMBOL_GPL(__lock_page_killable);
 
@@ -1850,7 +1896,7 @@ static void do_sync_mmap_readahead(struct vm_area_struct *vma,
 	/*
 	 * mmap read-around
 	 */
-	ra_pages = max_sane_readahead(ra->ra_pages);
+	ra_pages = ra_window_pages(mapping, ra);
 	ra->start = max_t(long, 0, offset - ra_pages / 2);
 	ra->size = ra_pages;
 	ra->async_size = ra_pages / 4;
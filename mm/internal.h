@@ -36,6 +36,9 @@ static inline unsigned long ra_submit(struct file_ra_state *ra,
 					ra->start, ra->size, ra->async_size);
 }
 
+extern unsigned long ra_window_pages(struct address_space *mapping,
+		struct file_ra_state *ra);
+
 /*
  * Turn a non-refcounted page (->_count == 0) into refcounted with
  * a count of one.
@@ -1822,6 +1822,70 @@ static int ksm_scan_thread(void *nothing)
 	return 0;
 }
 
+static bool vma_flags_mergeable(unsigned long vm_flags)
+{
+	/*
+	 * Be somewhat over-protective for now!
+	 */
+	if (vm_flags & (VM_SHARED  | VM_MAYSHARE   |
+			VM_PFNMAP  | VM_IO      | VM_DONTEXPAND |
+			VM_HUGETLB | VM_NONLINEAR | VM_MIXEDMAP))
+		return false;
+
+#ifdef VM_SAO
+	if (vm_flags & VM_SAO)
+		return false;
+#endif
+	return true;
+}
+
+unsigned long __ksm_vma_flags(unsigned long vm_flags)
+{
+	if (vma_flags_mergeable(vm_flags))
+		vm_flags |= VM_MERGEABLE;
+	return vm_flags;
+}
+
+/**
+ * ksm_enable_merge_any - make all anonymous memory of an mm mergeable
+ * @mm: the mm to enroll
+ *
+ * Marks every anonymous private vma of @mm VM_MERGEABLE, as if the task
+ * had madvised them, and has vmas created later on start out mergeable
+ * too.  This lets a memcg hand its tasks to ksmd without their
+ * cooperation, e.g. zygote forked apps sent to the background, whose
+ * heaps drift apart after copy-on-write.  The rate at which ksmd scans
+ * is still bounded by pages_to_scan and sleep_millisecs.
+ */
+int ksm_enable_merge_any(struct mm_struct *mm)
+{
+	struct vm_area_struct *vma;
+	int err = 0;
+
+	if (test_bit(MMF_VM_MERGE_ANY, &mm->flags))
+		return 0;
+
+	down_write(&mm->mmap_sem);
+	if (test_bit(MMF_VM_MERGE_ANY, &mm->flags))
+		goto out;
+
+	if (!test_bit(MMF_VM_MERGEABLE, &mm->flags)) {
+		err = __ksm_enter(mm);
+		if (err)
+			goto out;
+	}
+	set_bit(MMF_VM_MERGE_ANY, &mm->flags);
+
+	for (vma = mm->mmap; vma; vma = vma->vm_next) {
+		if (vma->vm_file)
+			continue;
+		vma->vm_flags = __ksm_vma_flags(vma->vm_flags);
+	}
+out:
+	up_write(&mm->mmap_sem);
+	return err;
+}
+
 int ksm_madvise(struct vm_area_struct *vma, unsigned long start,
 		unsigned long end, int advice, unsigned long *vm_flags)
 {
@@ -1830,18 +1894,10 @@ int ksm_madvise(struct vm_area_struct *vma, unsigned long start,
 
 	switch (advice) {
 	case MADV_MERGEABLE:
-		/*
-		 * Be somewhat over-protective for now!
-		 */
-		if (*vm_flags & (VM_MERGEABLE | VM_SHARED  | VM_MAYSHARE   |
-				 VM_PFNMAP    | VM_IO      | VM_DONTEXPAND |
-				 VM_HUGETLB | VM_NONLINEAR | VM_MIXEDMAP))
+		if (*vm_flags & VM_MERGEABLE)
 			return 0;		/* just ignore the advice */
-
-#ifdef VM_SAO
-		if (*vm_flags & VM_SAO)
+		if (!vma_flags_mergeable(*vm_flags))
 			return 0;
-#endif
 
 		if (!test_bit(MMF_VM_MERGEABLE, &mm->flags)) {
 			err = __ksm_enter(mm);
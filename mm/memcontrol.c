@@ -50,12 +50,14 @@
 #include <linux/fs.h>
 #include <linux/seq_file.h>
 #include <linux/vmpressure.h>
+#include <linux/psi.h>
 #include <linux/mm_inline.h>
 #include <linux/page_cgroup.h>
 #include <linux/cpu.h>
 #include <linux/oom.h>
 #include <linux/lockdep.h>
 #include <linux/file.h>
+#include <linux/ksm.h>
 #include "internal.h"
 #include <net/sock.h>
 #include <net/ip.h>
@@ -102,6 +104,9 @@ enum mem_cgroup_events_index {
 	MEM_CGROUP_EVENTS_PGPGOUT,	/* # of pages paged out */
 	MEM_CGROUP_EVENTS_PGFAULT,	/* # of page-faults */
 	MEM_CGROUP_EVENTS_PGMAJFAULT,	/* # of major page-faults */
+	MEM_CGROUP_EVENTS_WORKINGSET_REFAULT,	/* # of cache refaults */
+	MEM_CGROUP_EVENTS_WORKINGSET_ACTIVATE,	/* # of refaults activated */
+	MEM_CGROUP_EVENTS_WORKINGSET_PROTECT,	/* # of refaults kept active */
 	MEM_CGROUP_EVENTS_NSTATS,
 };
 
@@ -110,6 +115,9 @@ static const char * const mem_cgroup_events_names[] = {
 	"pgpgout",
 	"pgfault",
 	"pgmajfault",
+	"workingset_refault",
+	"workingset_activate",
+	"workingset_protect",
 };
 
 static const char * const mem_cgroup_lru_names[] = {
@@ -292,6 +300,11 @@ struct mem_cgroup {
 	/* vmpressure notifications */
 	struct vmpressure vmpressure;
 
+#ifdef CONFIG_PSI
+	/* memory stall information */
+	struct psi_group psi;
+#endif
+
 	/* css_online() has been completed */
 	int initialized;
 
@@ -335,6 +348,15 @@ struct mem_cgroup {
 	 * mem_cgroup ? And what type of charges should we move ?
 	 */
 	unsigned long move_charge_at_immigrate;
+	/*
+	 * Keep file pages that refault into this cgroup on the active
+	 * list for one extra aging cycle.
+	 */
+	bool refault_protect;
+#ifdef CONFIG_KSM
+	/* Hand the anonymous memory of member tasks to ksmd */
+	bool ksm_merge;
+#endif
 	/*
 	 * set > 0 if pages under this cgroup are moving to other cgroup.
 	 */
@@ -1043,6 +1065,37 @@ static struct mem_cgroup *get_mem_cgroup_from_mm(struct mm_struct *mm)
 	return memcg;
 }
 
+#ifdef CONFIG_PSI
+/* Stalls in the root memcg are accounted to the system-wide group only */
+struct psi_group *memcg_to_psi(struct mem_cgroup *memcg)
+{
+	if (!memcg || mem_cgroup_is_root(memcg))
+		return NULL;
+	return &memcg->psi;
+}
+
+/* Pins the memcg that the memory stalls of current are charged to */
+struct mem_cgroup *mem_cgroup_psi_get(void)
+{
+	if (mem_cgroup_disabled() || !root_mem_cgroup)
+		return NULL;
+	return get_mem_cgroup_from_mm(current->mm);
+}
+
+void mem_cgroup_psi_put(struct mem_cgroup *memcg)
+{
+	if (memcg)
+		css_put(&memcg->css);
+}
+
+static int mem_cgroup_psi_read(struct seq_file *m, void *v)
+{
+	struct mem_cgroup *memcg = mem_cgroup_from_css(seq_css(m));
+
+	return psi_show(m, memcg_to_psi(memcg));
+}
+#endif
+
 /*
  * Returns a next (in a pre-order walk) alive memcg (with elevated css
  * ref. count) or NULL if the whole root's subtree has been visited.
@@ -1293,6 +1346,70 @@ out:
 }
 EXPORT_SYMBOL(__mem_cgroup_count_vm_event);
 
+/**
+ * mem_cgroup_workingset_refault - account a page cache refault
+ * @page: the refaulting page, charged and locked
+ * @activate: whether the refault distance activated the page
+ *
+ * If the page's memcg has refault protection enabled, an activated
+ * refault is also marked so that the next deactivation attempt by
+ * shrink_active_list() leaves it on the active list.
+ */
+void mem_cgroup_workingset_refault(struct page *page, bool activate)
+{
+	struct page_cgroup *pc;
+	struct mem_cgroup *memcg;
+
+	if (mem_cgroup_disabled())
+		return;
+
+	VM_BUG_ON_PAGE(!PageLocked(page), page);
+
+	pc = lookup_page_cgroup(page);
+	if (!PageCgroupUsed(pc))
+		return;
+
+	memcg = pc->mem_cgroup;
+	this_cpu_inc(memcg->stat->events[MEM_CGROUP_EVENTS_WORKINGSET_REFAULT]);
+	if (!activate)
+		return;
+	this_cpu_inc(memcg->stat->events[MEM_CGROUP_EVENTS_WORKINGSET_ACTIVATE]);
+	if (memcg->refault_protect)
+		pc->flags |= PCG_REFAULT;
+}
+
+/**
+ * mem_cgroup_refault_protected - check and consume refault protection
+ * @page: isolated file page about to be deactivated
+ *
+ * Returns %true if @page refaulted into a memcg that has refault
+ * protection enabled and has not been protected since.  The protection
+ * is consumed, so a page gets at most one extra trip around the active
+ * list per refault.
+ */
+bool mem_cgroup_refault_protected(struct page *page)
+{
+	struct page_cgroup *pc;
+	struct mem_cgroup *memcg;
+
+	if (mem_cgroup_disabled())
+		return false;
+
+	pc = lookup_page_cgroup(page);
+	if (likely(!(pc->flags & PCG_REFAULT)))
+		return false;
+	pc->flags &= ~PCG_REFAULT;
+
+	if (!PageCgroupUsed(pc))
+		return false;
+	memcg = pc->mem_cgroup;
+	if (!memcg->refault_protect)
+		return false;
+
+	this_cpu_inc(memcg->stat->events[MEM_CGROUP_EVENTS_WORKINGSET_PROTECT]);
+	return true;
+}
+
 /**
  * mem_cgroup_zone_lruvec - get the lru list vector for a zone and memcg
  * @zone: zone of the wanted lruvec
@@ -4447,6 +4564,77 @@ static int mem_cgroup_swappiness_write(struct cgroup_subsys_state *css,
 	return 0;
 }
 
+static u64 mem_cgroup_refault_protect_read(struct cgroup_subsys_state *css,
+					   struct cftype *cft)
+{
+	return mem_cgroup_from_css(css)->refault_protect;
+}
+
+static int mem_cgroup_refault_protect_write(struct cgroup_subsys_state *css,
+					    struct cftype *cft, u64 val)
+{
+	struct mem_cgroup *memcg = mem_cgroup_from_css(css);
+
+	if (val > 1)
+		return -EINVAL;
+
+	memcg->refault_protect = val;
+	return 0;
+}
+
+#ifdef CONFIG_KSM
+static u64 mem_cgroup_ksm_merge_read(struct cgroup_subsys_state *css,
+				     struct cftype *cft)
+{
+	return mem_cgroup_from_css(css)->ksm_merge;
+}
+
+static int mem_cgroup_ksm_merge_write(struct cgroup_subsys_state *css,
+				      struct cftype *cft, u64 val)
+{
+	struct mem_cgroup *memcg = mem_cgroup_from_css(css);
+	struct css_task_iter it;
+	struct task_struct *task;
+	int ret = 0;
+
+	if (val > 1)
+		return -EINVAL;
+
+	/*
+	 * Clearing the flag only stops enrolling new tasks; pages that
+	 * were already merged stay merged until ksmd is told to unmerge.
+	 */
+	memcg->ksm_merge = val;
+	if (!val)
+		return 0;
+
+	css_task_iter_start(css, &it);
+	while (!ret && (task = css_task_iter_next(&it))) {
+		struct mm_struct *mm = get_task_mm(task);
+
+		if (!mm)
+			continue;
+		ret = ksm_enable_merge_any(mm);
+		mmput(mm);
+	}
+	css_task_iter_end(&it);
+
+	return ret;
+}
+
+static void mem_cgroup_ksm_attach(struct mem_cgroup *memcg,
+				  struct mm_struct *mm)
+{
+	if (memcg->ksm_merge)
+		ksm_enable_merge_any(mm);
+}
+#else
+static void mem_cgroup_ksm_attach(struct mem_cgroup *memcg,
+				  struct mm_struct *mm)
+{
+}
+#endif
+
 static void __mem_cgroup_threshold(struct mem_cgroup *memcg, bool swap)
 {
 	struct mem_cgroup_threshold_ary *t;
@@ -5141,6 +5329,18 @@ static struct cftype mem_cgroup_files[] = {
 		.read_u64 = mem_cgroup_swappiness_read,
 		.write_u64 = mem_cgroup_swappiness_write,
 	},
+	{
+		.name = "refault_protect",
+		.read_u64 = mem_cgroup_refault_protect_read,
+		.write_u64 = mem_cgroup_refault_protect_write,
+	},
+#ifdef CONFIG_KSM
+	{
+		.name = "ksm_merge",
+		.read_u64 = mem_cgroup_ksm_merge_read,
+		.write_u64 = mem_cgroup_ksm_merge_write,
+	},
+#endif
 	{
 		.name = "move_charge_at_immigrate",
 		.read_u64 = mem_cgroup_move_charge_read,
@@ -5155,6 +5355,12 @@ static struct cftype mem_cgroup_files[] = {
 	{
 		.name = "pressure_level",
 	},
+#ifdef CONFIG_PSI
+	{
+		.name = "pressure",
+		.seq_show = mem_cgroup_psi_read,
+	},
+#endif
 #ifdef CONFIG_NUMA
 	{
 		.name = "numa_stat",
@@ -5274,6 +5480,9 @@ static struct mem_cgroup *mem_cgroup_alloc(void)
 	if (!memcg->stat)
 		goto out_free;
 	spin_lock_init(&memcg->pcp_counter_lock);
+#ifdef CONFIG_PSI
+	psi_group_init(&memcg->psi);
+#endif
 	return memcg;
 
 out_free:
@@ -5297,6 +5506,9 @@ static void __mem_cgroup_free(struct mem_cgroup *memcg)
 	int node;
 
 	mem_cgroup_remove_from_trees(memcg);
+#ifdef CONFIG_PSI
+	psi_group_cleanup(&memcg->psi);
+#endif
 
 	for_each_node(node)
 		free_mem_cgroup_per_zone_info(memcg, node);
@@ -5409,6 +5621,7 @@ mem_cgroup_css_online(struct cgroup_subsys_state *css)
 	memcg->use_hierarchy = parent->use_hierarchy;
 	memcg->oom_kill_disable = parent->oom_kill_disable;
 	memcg->swappiness = mem_cgroup_swappiness(parent);
+	memcg->refault_protect = parent->refault_protect;
 
 	if (parent->use_hierarchy) {
 		res_counter_init(&memcg->res, &parent->res);
@@ -6118,6 +6331,7 @@ static void mem_cgroup_move_task(struct cgroup_subsys_state *css,
 	if (mm) {
 		if (mc.to)
 			mem_cgroup_move_charge(mm);
+		mem_cgroup_ksm_attach(mem_cgroup_from_css(css), mm);
 		mmput(mm);
 	}
 	if (mc.to)
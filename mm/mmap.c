@@ -35,6 +35,7 @@
 #include <linux/perf_event.h>
 #include <linux/audit.h>
 #include <linux/khugepaged.h>
+#include <linux/ksm.h>
 #include <linux/uprobes.h>
 #include <linux/rbtree_augmented.h>
 #include <linux/sched/sysctl.h>
@@ -1653,6 +1654,8 @@ munmap_back:
 		vm_flags |= VM_ACCOUNT;
 	}
 
+	vm_flags = ksm_vma_flags(mm, file, vm_flags);
+
 	/*
 	 * Can we just expand an old mapping?
 	 */
@@ -2745,6 +2748,7 @@ static unsigned long do_brk(unsigned long addr, unsigned long len)
 	int error;
 
 	flags = VM_DATA_DEFAULT_FLAGS | VM_ACCOUNT | mm->def_flags;
+	flags = ksm_vma_flags(mm, NULL, flags);
 
 	error = get_unmapped_area(NULL, addr, len, 0, MAP_FIXED);
 	if (error & ~PAGE_MASK)
@@ -60,6 +60,7 @@
 #include <linux/page-debug-flags.h>
 #include <linux/hugetlb.h>
 #include <linux/sched/rt.h>
+#include <linux/psi.h>
 
 #include <asm/sections.h>
 #include <asm/tlbflush.h>
@@ -767,6 +768,61 @@ static void free_pcppages_bulk(struct zone *zone, int count,
 	spin_unlock(&zone->lock);
 }
 
+static inline bool pcp_allowed_order(unsigned int order)
+{
+	return order && order <= PCP_MAX_ORDER;
+}
+
+static inline struct per_cpu_pages_order *pcp_order(struct per_cpu_pages *pcp,
+						    unsigned int order)
+{
+	return &pcp->orders[order - 1];
+}
+
+/*
+ * Frees a number of blocks from the PCP lists of an order above 0, and
+ * updates pcpo->count accordingly.  The lists are drained in migratetype
+ * order, taking the coldest blocks first.
+ */
+static void free_pcppages_bulk_order(struct zone *zone, int count,
+				     struct per_cpu_pages_order *pcpo,
+				     unsigned int order)
+{
+	int migratetype;
+	unsigned long nr_scanned;
+
+	spin_lock(&zone->lock);
+	nr_scanned = zone_page_state(zone, NR_PAGES_SCANNED);
+	if (nr_scanned)
+		__mod_zone_page_state(zone, NR_PAGES_SCANNED, -nr_scanned);
+
+	count = min(pcpo->count, count);
+	pcpo->count -= count;
+	for (migratetype = 0; count && migratetype < MIGRATE_PCPTYPES;
+	     migratetype++) {
+		struct list_head *list = &pcpo->lists[migratetype];
+
+		while (count && !list_empty(list)) {
+			struct page *page;
+			int mt;
+
+			page = list_entry(list->prev, struct page, lru);
+			list_del(&page->lru);
+
+			mt = get_freepage_migratetype(page);
+			VM_BUG_ON_PAGE(is_migrate_isolate(mt), page);
+			if (unlikely(has_isolate_pageblock(zone)))
+				mt = get_pageblock_migratetype(page);
+
+			__free_one_page(page, page_to_pfn(page), zone,
+					order, mt);
+			trace_mm_page_pcpu_drain(page, order, mt);
+			count--;
+		}
+	}
+	spin_unlock(&zone->lock);
+}
+
 static void free_one_page(struct zone *zone,
 				struct page *page, unsigned long pfn,
 				unsigned int order,
@@ -827,7 +883,28 @@ static void __free_pages_ok(struct page *page, unsigned int order)
 	local_irq_save(flags);
 	__count_vm_events(PGFREE, 1 << order);
 	set_freepage_migratetype(page, migratetype);
-	free_one_page(page_zone(page), page, pfn, order, migratetype);
+	if (pcp_allowed_order(order) && !is_migrate_isolate(migratetype)) {
+		struct zone *zone = page_zone(page);
+		struct per_cpu_pages_order *pcpo;
+
+		/* Blocks on the pcp lists are handed out as any order */
+		if (unlikely(PageCompound(page)) &&
+		    unlikely(destroy_compound_page(page, order)))
+			goto out;
+
+		/* Treat RESERVE as movable, as free_hot_cold_page() does */
+		if (migratetype >= MIGRATE_PCPTYPES)
+			migratetype = MIGRATE_MOVABLE;
+
+		pcpo = pcp_order(&this_cpu_ptr(zone->pageset)->pcp, order);
+		list_add(&page->lru, &pcpo->lists[migratetype]);
+		pcpo->count++;
+		if (pcpo->count >= pcpo->high)
+			free_pcppages_bulk_order(zone, ACCESS_ONCE(pcpo->batch),
+						 pcpo, order);
+	} else
+		free_one_page(page_zone(page), page, pfn, order, migratetype);
+out:
 	local_irq_restore(flags);
 }
 
@@ -1419,6 +1496,49 @@ static struct list_head *get_populated_pcp_list(struct zone *zone,
 	return list;
 }
 
+/*
+ * Same as get_populated_pcp_list(), for the lists of an order above 0.
+ */
+static struct list_head *get_populated_pcp_order_list(struct zone *zone,
+			unsigned int order, struct per_cpu_pages_order *pcpo,
+			int migratetype, int cold)
+{
+	struct list_head *list = &pcpo->lists[migratetype];
+
+	if (list_empty(list)) {
+		pcpo->count += rmqueue_bulk(zone, order,
+				pcpo->batch, list,
+				migratetype, cold);
+
+		if (list_empty(list))
+			list = NULL;
+	}
+	return list;
+}
+
+static bool pcp_orders_populated(struct per_cpu_pages *pcp)
+{
+	unsigned int order;
+
+	for (order = 1; order <= PCP_MAX_ORDER; order++)
+		if (pcp_order(pcp, order)->count)
+			return true;
+	return false;
+}
+
+static void drain_pcp_orders(struct zone *zone, struct per_cpu_pages *pcp)
+{
+	unsigned int order;
+
+	for (order = 1; order <= PCP_MAX_ORDER; order++) {
+		struct per_cpu_pages_order *pcpo = pcp_order(pcp, order);
+
+		if (pcpo->count)
+			free_pcppages_bulk_order(zone, pcpo->count, pcpo,
+						 order);
+	}
+}
+
 #ifdef CONFIG_NUMA
 /*
  * Called from the vmstat counter updater to drain pagesets of this
@@ -1468,6 +1588,7 @@ static void drain_pages(unsigned int cpu)
 			free_pcppages_bulk(zone, pcp->count, pcp);
 			pcp->count = 0;
 		}
+		drain_pcp_orders(zone, pcp);
 		local_irq_restore(flags);
 	}
 }
@@ -1511,7 +1632,7 @@ void drain_all_pages(void)
 		bool has_pcps = false;
 		for_each_populated_zone(zone) {
 			pcp = per_cpu_ptr(zone->pageset, cpu);
-			if (pcp->pcp.count) {
+			if (pcp->pcp.count || pcp_orders_populated(&pcp->pcp)) {
 				has_pcps = true;
 				break;
 			}
@@ -1736,6 +1857,20 @@ struct page *buffered_rmqueue(struct zone *preferred_zone,
 	struct page *page = NULL;
 	bool cold = ((gfp_flags & __GFP_COLD) != 0);
 
+	if (unlikely(gfp_flags & __GFP_NOFAIL)) {
+		/*
+		 * __GFP_NOFAIL is not to be used in new code.
+		 *
+		 * All __GFP_NOFAIL callers should be fixed so that they
+		 * properly detect and handle allocation failures.
+		 *
+		 * We most definitely don't want callers attempting to
+		 * allocate greater than order-1 page units with
+		 * __GFP_NOFAIL.
+		 */
+		WARN_ON_ONCE(order > 1);
+	}
+
 again:
 	if (likely(order == 0)) {
 		struct per_cpu_pages *pcp;
@@ -1770,20 +1905,34 @@ again:
 
 		list_del(&page->lru);
 		pcp->count--;
-	} else {
-		if (unlikely(gfp_flags & __GFP_NOFAIL)) {
-			/*
-			 * __GFP_NOFAIL is not to be used in new code.
-			 *
-			 * All __GFP_NOFAIL callers should be fixed so that they
-			 * properly detect and handle allocation failures.
-			 *
-			 * We most definitely don't want callers attempting to
-			 * allocate greater than order-1 page units with
-			 * __GFP_NOFAIL.
-			 */
-			WARN_ON_ONCE(order > 1);
+	} else if (pcp_allowed_order(order)) {
+		struct per_cpu_pages_order *pcpo;
+		struct list_head *list = NULL;
+
+		local_irq_save(flags);
+		pcpo = pcp_order(&this_cpu_ptr(zone->pageset)->pcp, order);
+
+		if (migratetype == MIGRATE_MOVABLE &&
+			gfp_flags & __GFP_CMA) {
+			list = get_populated_pcp_order_list(zone, order, pcpo,
+					get_cma_migrate_type(), cold);
 		}
+
+		if (list == NULL) {
+			list = get_populated_pcp_order_list(zone, order, pcpo,
+				migratetype, cold);
+			if (unlikely(list == NULL))
+				goto failed;
+		}
+
+		if (cold)
+			page = list_entry(list->prev, struct page, lru);
+		else
+			page = list_entry(list->next, struct page, lru);
+
+		list_del(&page->lru);
+		pcpo->count--;
+	} else {
 		spin_lock_irqsave(&zone->lock, flags);
 		if (migratetype == MIGRATE_MOVABLE && gfp_flags & __GFP_CMA)
 			page = __rmqueue_cma(zone, order);
@@ -2503,11 +2652,13 @@ __alloc_pages_direct_compact(gfp_t gfp_mask, unsigned int order,
 {
 	struct zone *last_compact_zone = NULL;
 	unsigned long compact_result;
+	unsigned long pflags;
 	struct page *page;
 
 	if (!order)
 		return NULL;
 
+	psi_memstall_enter(&pflags);
 	current->flags |= PF_MEMALLOC;
 	compact_result = try_to_compact_pages(zonelist, order, gfp_mask,
 						nodemask, mode,
@@ -2515,6 +2666,7 @@ __alloc_pages_direct_compact(gfp_t gfp_mask, unsigned int order,
 						alloc_flags, classzone_idx,
 						&last_compact_zone);
 	current->flags &= ~PF_MEMALLOC;
+	psi_memstall_leave(&pflags);
 
 	switch (compact_result) {
 	case COMPACT_DEFERRED:
@@ -2586,12 +2738,14 @@ __perform_reclaim(gfp_t gfp_mask, unsigned int order, struct zonelist *zonelist,
 		  nodemask_t *nodemask)
 {
 	struct reclaim_state reclaim_state;
+	unsigned long pflags;
 	int progress;
 
 	cond_resched();
 
 	/* We now go into synchronous reclaim */
 	cpuset_memory_pressure_bump();
+	psi_memstall_enter(&pflags);
 	current->flags |= PF_MEMALLOC;
 	lockdep_set_current_reclaim_state(gfp_mask);
 	reclaim_state.reclaimed_slab = 0;
@@ -2602,6 +2756,7 @@ __perform_reclaim(gfp_t gfp_mask, unsigned int order, struct zonelist *zonelist,
 	current->reclaim_state = NULL;
 	lockdep_clear_current_reclaim_state();
 	current->flags &= ~PF_MEMALLOC;
+	psi_memstall_leave(&pflags);
 
 	cond_resched();
 
@@ -4502,6 +4657,8 @@ static int zone_batchsize(struct zone *zone)
 static void pageset_update(struct per_cpu_pages *pcp, unsigned long high,
 		unsigned long batch)
 {
+	unsigned int order;
+
        /* start with a fail safe value for batch */
 	pcp->batch = 1;
 	smp_wmb();
@@ -4511,6 +4668,23 @@ static void pageset_update(struct per_cpu_pages *pcp, unsigned long high,
 	smp_wmb();
 
 	pcp->batch = batch;
+
+	/*
+	 * Each higher order may hold up to a quarter of the order-0 high
+	 * watermark worth of pages, and moves a quarter of that at once.
+	 */
+	for (order = 1; order <= PCP_MAX_ORDER; order++) {
+		struct per_cpu_pages_order *pcpo = pcp_order(pcp, order);
+		unsigned long order_high = (high >> 2) >> order;
+
+		pcpo->batch = 1;
+		smp_wmb();
+
+		pcpo->high = order_high;
+		smp_wmb();
+
+		pcpo->batch = max(1UL, order_high >> 2);
+	}
 }
 
 /* a companion to pageset_set_high() */
@@ -4523,6 +4697,7 @@ static void pageset_init(struct per_cpu_pageset *p)
 {
 	struct per_cpu_pages *pcp;
 	int migratetype;
+	unsigned int order;
 
 	memset(p, 0, sizeof(*p));
 
@@ -4530,6 +4705,13 @@ static void pageset_init(struct per_cpu_pageset *p)
 	pcp->count = 0;
 	for (migratetype = 0; migratetype < MIGRATE_PCPTYPES; migratetype++)
 		INIT_LIST_HEAD(&pcp->lists[migratetype]);
+	for (order = 1; order <= PCP_MAX_ORDER; order++) {
+		struct per_cpu_pages_order *pcpo = pcp_order(pcp, order);
+
+		for (migratetype = 0; migratetype < MIGRATE_PCPTYPES;
+		     migratetype++)
+			INIT_LIST_HEAD(&pcpo->lists[migratetype]);
+	}
 }
 
 static void setup_pageset(struct per_cpu_pageset *p, unsigned long batch)
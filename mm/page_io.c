@@ -15,6 +15,8 @@
 #include <linux/gfp.h>
 #include <linux/pagemap.h>
 #include <linux/swap.h>
+#include <linux/swapfile.h>
+#include <linux/ktime.h>
 #include <linux/bio.h>
 #include <linux/swapops.h>
 #include <linux/buffer_head.h>
@@ -46,11 +48,33 @@ static struct bio *get_swap_bio(gfp_t gfp_flags,
 	return bio;
 }
 
+/*
+ * Async swap-out latency is sampled one write at a time per device,
+ * see __swap_writepage(). A failed write releases the sample without
+ * recording it.
+ */
+static void swap_write_sampled(struct page *page, bool uptodate)
+{
+	struct swap_info_struct *sis = page_swap_info(page);
+	unsigned long start;
+
+	if (READ_ONCE(sis->lat_sample_page) != page)
+		return;
+
+	start = READ_ONCE(sis->lat_sample_start);
+	if (start && uptodate)
+		swap_ratio_write_done(sis, start);
+	WRITE_ONCE(sis->lat_sample_start, 0);
+	smp_wmb();
+	WRITE_ONCE(sis->lat_sample_page, NULL);
+}
+
 void end_swap_bio_write(struct bio *bio, int err)
 {
 	const int uptodate = test_bit(BIO_UPTODATE, &bio->bi_flags);
 	struct page *page = bio->bi_io_vec[0].bv_page;
 
+	swap_write_sampled(page, uptodate);
 	if (!uptodate) {
 		SetPageError(page);
 		/*
@@ -259,6 +283,10 @@ int __swap_writepage(struct page *page, struct writeback_control *wbc,
 	struct bio *bio;
 	int ret, rw = WRITE;
 	struct swap_info_struct *sis = page_swap_info(page);
+	unsigned long start = 0;
+
+	if (swap_ratio_timed(sis))
+		start = (unsigned long)ktime_get_ns();
 
 	if (sis->flags & SWP_FILE) {
 		struct kiocb kiocb;
@@ -288,6 +316,8 @@ int __swap_writepage(struct page *page, struct writeback_control *wbc,
 						kiocb.ki_pos);
 		if (ret == PAGE_SIZE) {
 			count_vm_event(PSWPOUT);
+			if (start)
+				swap_ratio_write_done(sis, start);
 			ret = 0;
 		} else {
 			/*
@@ -313,6 +343,8 @@ int __swap_writepage(struct page *page, struct writeback_control *wbc,
 			      page, wbc);
 	if (!ret) {
 		count_vm_event(PSWPOUT);
+		if (start)
+			swap_ratio_write_done(sis, start);
 		return 0;
 	}
 
@@ -327,6 +359,9 @@ int __swap_writepage(struct page *page, struct writeback_control *wbc,
 	if (wbc->sync_mode == WB_SYNC_ALL)
 		rw |= REQ_SYNC;
 	count_vm_event(PSWPOUT);
+	if (start && !READ_ONCE(sis->lat_sample_page) &&
+	    !cmpxchg(&sis->lat_sample_page, NULL, page))
+		WRITE_ONCE(sis->lat_sample_start, start);
 	set_page_writeback(page);
 	unlock_page(page);
 	submit_bio(rw, bio);
@@ -38,6 +38,14 @@ module_param_named(enable_process_reclaim, enable_process_reclaim, int,
 int per_swap_size = SWAP_CLUSTER_MAX * 32;
 module_param_named(per_swap_size, per_swap_size, int, S_IRUGO | S_IWUSR);
 
+/*
+ * The number of pages tried in the next run. It doubles up to
+ * per_swap_size while reclaim_avg_efficiency stays at or above
+ * swap_opt_eff and halves down to SWAP_CLUSTER_MAX when it drops below.
+ */
+static int swap_target = SWAP_CLUSTER_MAX * 32;
+module_param_named(swap_target, swap_target, int, S_IRUGO);
+
 int reclaim_avg_efficiency;
 module_param_named(reclaim_avg_efficiency, reclaim_avg_efficiency,
 			int, S_IRUGO);
@@ -144,7 +152,12 @@ static void swap_fn(struct work_struct *work)
 			continue;
 		}
 
-		tasksize = get_mm_counter(p->mm, MM_ANONPAGES);
+		/*
+		 * Rank tasks by the anon memory that was not referenced when
+		 * we last went through them rather than by their whole size.
+		 */
+		tasksize = get_mm_counter(p->mm, MM_ANONPAGES) *
+				(100 - p->mm->reclaim_hot_pct) / 100;
 		task_unlock(p);
 
 		if (tasksize <= 0)
@@ -181,9 +194,12 @@ static void swap_fn(struct work_struct *work)
 
 	rcu_read_unlock();
 
+	swap_target = clamp_t(int, swap_target, SWAP_CLUSTER_MAX,
+				max_t(int, per_swap_size, SWAP_CLUSTER_MAX));
+
 	while (si--) {
 		nr_to_reclaim =
-			(selected[si].tasksize * per_swap_size) / total_sz;
+			(selected[si].tasksize * swap_target) / total_sz;
 		/* scan atleast a page */
 		if (!nr_to_reclaim)
 			nr_to_reclaim = 1;
@@ -192,7 +208,7 @@ static void swap_fn(struct work_struct *work)
 
 		trace_process_reclaim(selected[si].tasksize,
 				selected[si].oom_score_adj, rp.nr_scanned,
-				rp.nr_reclaimed, per_swap_size, total_sz,
+				rp.nr_reclaimed, swap_target, total_sz,
 				nr_to_reclaim);
 		total_scan += rp.nr_scanned;
 		total_reclaimed += rp.nr_reclaimed;
@@ -214,6 +230,12 @@ static void swap_fn(struct work_struct *work)
 		reclaim_avg_efficiency =
 			(efficiency + reclaim_avg_efficiency) / 2;
 		trace_process_reclaim_eff(efficiency, reclaim_avg_efficiency);
+
+		if (reclaim_avg_efficiency >= swap_opt_eff)
+			swap_target = min(swap_target * 2, per_swap_size);
+		else
+			swap_target = max_t(int, swap_target / 2,
+						SWAP_CLUSTER_MAX);
 	}
 }
 
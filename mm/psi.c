@@ -0,0 +1,555 @@
+/*
+ * Memory pressure stall information
+ *
+ * Tracks the time tasks spend waiting on memory: direct reclaim, direct
+ * compaction and waiting for refaulting workingset pages to be read
+ * back in. Unlike the vmpressure scanned/reclaimed ratio this measures
+ * the latency impact of memory shortage on the workload.
+ *
+ * Two states are tracked for the system and for each memcg:
+ *
+ *	some: at least one task of the group is stalled
+ *	full: tasks of the group are stalled and the stalled tasks are
+ *	      all that is runnable on the system, i.e. no CPU is doing
+ *	      productive work
+ *
+ * The full state is evaluated on stall transitions and on the periodic
+ * average update, so it is an approximation without scheduler hooks.
+ *
+ * For each state the total stall time and 10s/60s/300s running averages
+ * are exported in /proc/pressure/memory and memory.pressure of memcgs:
+ *
+ *	some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+ *	full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+ *
+ * Writing "<some|full> <threshold us> <window us>" to an open descriptor
+ * of /proc/pressure/memory sets up a trigger: poll() then reports
+ * POLLPRI once the stall time within a window exceeds the threshold, at
+ * most once per window.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ */
+
+#include <linux/sched.h>
+#include <linux/ktime.h>
+#include <linux/slab.h>
+#include <linux/fs.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/poll.h>
+#include <linux/uaccess.h>
+#include <linux/init.h>
+#include <linux/memcontrol.h>
+#include <linux/psi.h>
+
+/* Running averages are updated every 2s, like the load average every 5s */
+#define PSI_FREQ	(2 * HZ + 1)
+#define EXP_10s		1677		/* 1/exp(2s/10s) as fixed-point */
+#define EXP_60s		1981		/* 1/exp(2s/60s) */
+#define EXP_300s	2034		/* 1/exp(2s/300s) */
+
+/* Beyond this all averages have decayed to zero anyway */
+#define PSI_MAX_MISSED	2000
+
+#define LOAD_INT(x) ((x) >> FSHIFT)
+#define LOAD_FRAC(x) LOAD_INT(((x) & (FIXED_1-1)) * 100)
+
+/* Trigger windows, in us */
+#define PSI_WINDOW_MIN_US	500000
+#define PSI_WINDOW_MAX_US	10000000
+
+struct psi_trigger {
+	struct psi_group *group;
+	struct list_head node;
+	enum psi_states state;
+	/* stall time in ns within @win_size that fires the trigger */
+	u64 threshold;
+	u64 win_size;
+	u64 win_start;
+	u64 win_value;
+	u64 prev_growth;
+	u64 last_event;
+	int event;
+	wait_queue_head_t event_wait;
+};
+
+static void psi_avgs_work(struct work_struct *work);
+static void psi_poll_work(struct work_struct *work);
+
+static struct psi_group psi_system = {
+	.lock = __SPIN_LOCK_UNLOCKED(psi_system.lock),
+	.avgs_lock = __MUTEX_INITIALIZER(psi_system.avgs_lock),
+	.avgs_work = __DELAYED_WORK_INITIALIZER(psi_system.avgs_work,
+						psi_avgs_work, 0),
+	.trigger_lock = __MUTEX_INITIALIZER(psi_system.trigger_lock),
+	.triggers = LIST_HEAD_INIT(psi_system.triggers),
+	.poll_work = __DELAYED_WORK_INITIALIZER(psi_system.poll_work,
+						psi_poll_work, 0),
+};
+
+static void record_times(struct psi_group *group, u64 now)
+{
+	u64 delta = now - group->state_start;
+
+	group->state_start = now;
+	if (group->state_mask & (1 << PSI_MEM_SOME))
+		group->total[PSI_MEM_SOME] += delta;
+	if (group->state_mask & (1 << PSI_MEM_FULL))
+		group->total[PSI_MEM_FULL] += delta;
+}
+
+static void set_state(struct psi_group *group, bool full)
+{
+	group->state_mask = 0;
+	if (group->nr_stalled) {
+		group->state_mask |= 1 << PSI_MEM_SOME;
+		if (full)
+			group->state_mask |= 1 << PSI_MEM_FULL;
+	}
+}
+
+/* Sleeping stalled tasks count as not runnable, which is full too */
+static bool system_full(void)
+{
+	return psi_system.nr_stalled &&
+	       psi_system.nr_stalled >= nr_running();
+}
+
+static void psi_schedule_work(struct psi_group *group)
+{
+	if (!delayed_work_pending(&group->avgs_work))
+		schedule_delayed_work(&group->avgs_work, PSI_FREQ);
+	if (group->nr_triggers && !delayed_work_pending(&group->poll_work))
+		schedule_delayed_work(&group->poll_work, group->poll_delay);
+}
+
+static void psi_group_change(struct psi_group *group, int delta, u64 now,
+			     bool full)
+{
+	spin_lock(&group->lock);
+	record_times(group, now);
+	group->nr_stalled += delta;
+	set_state(group, full);
+	spin_unlock(&group->lock);
+
+	if (delta > 0)
+		psi_schedule_work(group);
+}
+
+/*
+ * Snapshot of the stall times including the currently running state.
+ * Also re-evaluates the full state, which may have changed without a
+ * stall transition.
+ */
+static u64 psi_group_totals(struct psi_group *group, u64 total[])
+{
+	bool full = system_full();
+	u64 now;
+	int s;
+
+	spin_lock(&group->lock);
+	now = ktime_get_ns();
+	record_times(group, now);
+	set_state(group, full);
+	for (s = 0; s < NR_PSI_STATES; s++)
+		total[s] = group->total[s];
+	spin_unlock(&group->lock);
+
+	return now;
+}
+
+#ifdef CONFIG_MEMCG
+static void memcg_psi_change(struct mem_cgroup *memcg, int delta, u64 now,
+			     bool full)
+{
+	struct psi_group *group;
+
+	for (; (group = memcg_to_psi(memcg)); memcg = parent_mem_cgroup(memcg))
+		psi_group_change(group, delta, now, full);
+}
+#else
+static inline void memcg_psi_change(struct mem_cgroup *memcg, int delta,
+				    u64 now, bool full)
+{
+}
+#endif
+
+static void psi_change(struct mem_cgroup *memcg, int delta)
+{
+	u64 now = ktime_get_ns();
+	bool full;
+
+	spin_lock(&psi_system.lock);
+	record_times(&psi_system, now);
+	psi_system.nr_stalled += delta;
+	full = system_full();
+	set_state(&psi_system, full);
+	spin_unlock(&psi_system.lock);
+
+	if (delta > 0)
+		psi_schedule_work(&psi_system);
+
+	memcg_psi_change(memcg, delta, now, full);
+}
+
+/**
+ * psi_memstall_enter - mark the beginning of a memory stall section
+ * @flags: flags to handle nested sections
+ *
+ * Marks the calling task as being stalled due to a lack of memory,
+ * such as waiting for a refault or performing reclaim.
+ */
+void psi_memstall_enter(unsigned long *flags)
+{
+	*flags = current->flags & PF_MEMSTALL;
+	if (*flags)
+		return;
+
+	current->flags |= PF_MEMSTALL;
+	current->psi_memcg = mem_cgroup_psi_get();
+	psi_change(current->psi_memcg, 1);
+}
+
+/**
+ * psi_memstall_leave - mark the end of a memory stall section
+ * @flags: flags to handle nested memstall sections
+ *
+ * Marks the calling task as no longer stalled due to lack of memory.
+ */
+void psi_memstall_leave(unsigned long *flags)
+{
+	struct mem_cgroup *memcg;
+
+	if (*flags)
+		return;
+
+	memcg = current->psi_memcg;
+	current->psi_memcg = NULL;
+	psi_change(memcg, -1);
+	mem_cgroup_psi_put(memcg);
+	current->flags &= ~PF_MEMSTALL;
+}
+
+static void calc_avgs(unsigned long avg[3], int missed, u64 time, u64 period)
+{
+	static const unsigned long exp[3] = { EXP_10s, EXP_60s, EXP_300s };
+	unsigned long pct;
+	int i, n;
+
+	pct = div64_u64(time * 100, period) * FIXED_1;
+	for (i = 0; i < 3; i++) {
+		for (n = 0; n < missed && avg[i]; n++) {
+			CALC_LOAD(avg[i], exp[i], 0);
+		}
+		CALC_LOAD(avg[i], exp[i], pct);
+	}
+}
+
+/* Returns true if there was stall activity since the last update */
+static bool update_averages(struct psi_group *group)
+{
+	u64 total[NR_PSI_STATES];
+	u64 now, period, sample;
+	bool active = false;
+	int missed, s;
+
+	now = psi_group_totals(group, total);
+	period = now - group->avg_last_update;
+	if (group->avg_last_update &&
+	    period < jiffies_to_nsecs(PSI_FREQ) - NSEC_PER_MSEC)
+		return true;
+
+	missed = 0;
+	if (group->avg_last_update)
+		missed = min_t(u64, div64_u64(period,
+				jiffies_to_nsecs(PSI_FREQ)), PSI_MAX_MISSED);
+	if (missed)
+		missed--;
+	group->avg_last_update = now;
+
+	for (s = 0; s < NR_PSI_STATES; s++) {
+		sample = min(total[s] - group->avg_total[s], period);
+		group->avg_total[s] = total[s];
+		if (sample)
+			active = true;
+		calc_avgs(group->avg[s], missed, sample, period);
+	}
+	return active;
+}
+
+static void psi_avgs_work(struct work_struct *work)
+{
+	struct psi_group *group = container_of(to_delayed_work(work),
+					       struct psi_group, avgs_work);
+	bool active;
+
+	mutex_lock(&group->avgs_lock);
+	active = update_averages(group);
+	mutex_unlock(&group->avgs_lock);
+
+	/* Go quiet once the group has no stalls, the next one restarts us */
+	if (active || READ_ONCE(group->nr_stalled))
+		schedule_delayed_work(&group->avgs_work, PSI_FREQ);
+}
+
+/*
+ * Stall growth within the last window. The part of the previous window
+ * still covered by a sliding window is approximated from its growth.
+ */
+static u64 window_update(struct psi_trigger *t, u64 now, u64 value)
+{
+	u64 elapsed = now - t->win_start;
+	u64 growth = value - t->win_value;
+
+	if (elapsed > t->win_size) {
+		t->win_start = now;
+		t->win_value = value;
+		t->prev_growth = growth;
+	} else {
+		growth += div64_u64(t->prev_growth * (t->win_size - elapsed),
+				    t->win_size);
+	}
+	return growth;
+}
+
+static void psi_poll_work(struct work_struct *work)
+{
+	struct psi_group *group = container_of(to_delayed_work(work),
+					       struct psi_group, poll_work);
+	u64 total[NR_PSI_STATES];
+	struct psi_trigger *t;
+	bool active = false;
+	u64 now, growth;
+
+	mutex_lock(&group->trigger_lock);
+	now = psi_group_totals(group, total);
+	list_for_each_entry(t, &group->triggers, node) {
+		growth = window_update(t, now, total[t->state]);
+		if (growth)
+			active = true;
+		if (growth < t->threshold)
+			continue;
+		/* Limit event signaling to once per window */
+		if (now < t->last_event + t->win_size)
+			continue;
+		t->last_event = now;
+		t->event = 1;
+		wake_up_interruptible(&t->event_wait);
+	}
+	if (group->nr_triggers && (active || READ_ONCE(group->nr_stalled)))
+		schedule_delayed_work(&group->poll_work, group->poll_delay);
+	mutex_unlock(&group->trigger_lock);
+}
+
+/* Caller holds trigger_lock */
+static void update_poll_delay(struct psi_group *group)
+{
+	struct psi_trigger *t;
+	u64 period = U64_MAX;
+
+	/* Sample the shortest window ten times */
+	list_for_each_entry(t, &group->triggers, node)
+		period = min(period, div_u64(t->win_size, 10));
+	group->poll_delay = max_t(unsigned long, nsecs_to_jiffies(period), 1);
+}
+
+static struct psi_trigger *psi_trigger_create(struct psi_group *group,
+					      char *buf)
+{
+	struct psi_trigger *t;
+	u64 total[NR_PSI_STATES];
+	enum psi_states state;
+	u32 threshold_us;
+	u32 window_us;
+
+	if (sscanf(buf, "some %u %u", &threshold_us, &window_us) == 2)
+		state = PSI_MEM_SOME;
+	else if (sscanf(buf, "full %u %u", &threshold_us, &window_us) == 2)
+		state = PSI_MEM_FULL;
+	else
+		return ERR_PTR(-EINVAL);
+
+	if (window_us < PSI_WINDOW_MIN_US || window_us > PSI_WINDOW_MAX_US)
+		return ERR_PTR(-EINVAL);
+	if (threshold_us == 0 || threshold_us > window_us)
+		return ERR_PTR(-EINVAL);
+
+	t = kzalloc(sizeof(*t), GFP_KERNEL);
+	if (!t)
+		return ERR_PTR(-ENOMEM);
+
+	t->group = group;
+	t->state = state;
+	t->threshold = (u64)threshold_us * NSEC_PER_USEC;
+	t->win_size = (u64)window_us * NSEC_PER_USEC;
+	init_waitqueue_head(&t->event_wait);
+
+	mutex_lock(&group->trigger_lock);
+	t->win_start = psi_group_totals(group, total);
+	t->win_value = total[state];
+	list_add(&t->node, &group->triggers);
+	group->nr_triggers++;
+	update_poll_delay(group);
+	mutex_unlock(&group->trigger_lock);
+
+	return t;
+}
+
+static void psi_trigger_destroy(struct psi_trigger *t)
+{
+	struct psi_group *group = t->group;
+	bool idle;
+
+	mutex_lock(&group->trigger_lock);
+	list_del(&t->node);
+	group->nr_triggers--;
+	update_poll_delay(group);
+	idle = !group->nr_triggers;
+	mutex_unlock(&group->trigger_lock);
+
+	if (idle)
+		cancel_delayed_work_sync(&group->poll_work);
+	kfree(t);
+}
+
+/**
+ * psi_group_init - initialize a psi group
+ * @group: group embedded in a memcg
+ */
+void psi_group_init(struct psi_group *group)
+{
+	spin_lock_init(&group->lock);
+	mutex_init(&group->avgs_lock);
+	INIT_DELAYED_WORK(&group->avgs_work, psi_avgs_work);
+	mutex_init(&group->trigger_lock);
+	INIT_LIST_HEAD(&group->triggers);
+	INIT_DELAYED_WORK(&group->poll_work, psi_poll_work);
+	group->state_start = ktime_get_ns();
+}
+
+/**
+ * psi_group_cleanup - stop the deferred work of a psi group
+ * @group: group that is about to be freed, without stalled tasks
+ */
+void psi_group_cleanup(struct psi_group *group)
+{
+	WARN_ON_ONCE(group->nr_stalled || !list_empty(&group->triggers));
+	cancel_delayed_work_sync(&group->avgs_work);
+	cancel_delayed_work_sync(&group->poll_work);
+}
+
+/**
+ * psi_show - print the some/full averages and totals of a group
+ * @m: seq_file for output via seq_printf()
+ * @group: group to print, %NULL for the system-wide group
+ */
+int psi_show(struct seq_file *m, struct psi_group *group)
+{
+	u64 total[NR_PSI_STATES];
+	int s;
+
+	if (!group)
+		group = &psi_system;
+	mutex_lock(&group->avgs_lock);
+	update_averages(group);
+	psi_group_totals(group, total);
+	for (s = 0; s < NR_PSI_STATES; s++) {
+		unsigned long *avg = group->avg[s];
+
+		seq_printf(m, "%s avg10=%lu.%02lu avg60=%lu.%02lu avg300=%lu.%02lu total=%llu\n",
+			   s == PSI_MEM_FULL ? "full" : "some",
+			   LOAD_INT(avg[0]), LOAD_FRAC(avg[0]),
+			   LOAD_INT(avg[1]), LOAD_FRAC(avg[1]),
+			   LOAD_INT(avg[2]), LOAD_FRAC(avg[2]),
+			   div_u64(total[s], NSEC_PER_USEC));
+	}
+	mutex_unlock(&group->avgs_lock);
+
+	return 0;
+}
+
+static int psi_memory_show(struct seq_file *m, void *v)
+{
+	return psi_show(m, NULL);
+}
+
+static int psi_memory_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, psi_memory_show, NULL);
+}
+
+static ssize_t psi_memory_write(struct file *file, const char __user *user_buf,
+				size_t nbytes, loff_t *ppos)
+{
+	struct seq_file *seq = file->private_data;
+	struct psi_trigger *t;
+	char buf[32];
+	size_t buf_size;
+
+	if (!nbytes)
+		return -EINVAL;
+
+	buf_size = min(nbytes, sizeof(buf) - 1);
+	if (copy_from_user(buf, user_buf, buf_size))
+		return -EFAULT;
+	buf[buf_size] = '\0';
+
+	/* One trigger per open file */
+	mutex_lock(&seq->lock);
+	if (seq->private) {
+		mutex_unlock(&seq->lock);
+		return -EBUSY;
+	}
+	t = psi_trigger_create(&psi_system, buf);
+	if (IS_ERR(t)) {
+		mutex_unlock(&seq->lock);
+		return PTR_ERR(t);
+	}
+	seq->private = t;
+	mutex_unlock(&seq->lock);
+
+	return nbytes;
+}
+
+static unsigned int psi_memory_poll(struct file *file, poll_table *wait)
+{
+	struct seq_file *seq = file->private_data;
+	struct psi_trigger *t = seq->private;
+
+	if (!t)
+		return DEFAULT_POLLMASK | POLLERR | POLLPRI;
+
+	poll_wait(file, &t->event_wait, wait);
+	if (cmpxchg(&t->event, 1, 0) == 1)
+		return DEFAULT_POLLMASK | POLLPRI;
+
+	return DEFAULT_POLLMASK;
+}
+
+static int psi_memory_release(struct inode *inode, struct file *file)
+{
+	struct seq_file *seq = file->private_data;
+
+	if (seq->private)
+		psi_trigger_destroy(seq->private);
+	return single_release(inode, file);
+}
+
+static const struct file_operations psi_memory_fops = {
+	.open		= psi_memory_open,
+	.read		= seq_read,
+	.write		= psi_memory_write,
+	.poll		= psi_memory_poll,
+	.llseek		= seq_lseek,
+	.release	= psi_memory_release,
+};
+
+static int __init psi_proc_init(void)
+{
+	proc_mkdir("pressure", NULL);
+	proc_create("pressure/memory", 0666, NULL, &psi_memory_fops);
+	return 0;
+}
+module_init(psi_proc_init);
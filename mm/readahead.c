@@ -263,6 +263,31 @@ unsigned long max_sane_readahead(unsigned long nr)
 	return min(nr, MAX_READAHEAD);
 }
 
+#define RA_SHRINK_MAX	3
+#define RA_MIN_PAGES	4UL
+/*
+ * Maximum window for the next readahead on this file.  Every time reclaim
+ * has thrown away readahead marks of this mapping unread since we last
+ * looked, the window is halved (down to 1/8 of ra_pages); every marker
+ * that does get hit earns one step back.  Files whose readahead keeps
+ * getting evicted before use, typically sparse mmaps, so stop filling
+ * the page cache with pages nobody touches.
+ */
+unsigned long ra_window_pages(struct address_space *mapping,
+			      struct file_ra_state *ra)
+{
+	unsigned int wasted = ACCESS_ONCE(mapping->nr_ra_wasted);
+	unsigned long pages = max_sane_readahead(ra->ra_pages);
+
+	if (unlikely(wasted != ra->wasted)) {
+		ra->wasted = wasted;
+		if (ra->shrink < RA_SHRINK_MAX)
+			ra->shrink++;
+	}
+
+	return max(pages >> ra->shrink, min(pages, RA_MIN_PAGES));
+}
+
 /*
  * Set the initial window size, round to next power of 2 and square
  * Small size is not dependant on max value - only a one-page read is regarded
@@ -404,7 +429,7 @@ ondemand_readahead(struct address_space *mapping,
 		   unsigned long req_size)
 {
 	struct backing_dev_info *bdi = inode_to_bdi(mapping->host);
-	unsigned long max_pages = max_sane_readahead(ra->ra_pages);
+	unsigned long max_pages = ra_window_pages(mapping, ra);
 	unsigned long add_pages;
 	pgoff_t prev_offset;
 
@@ -577,6 +602,10 @@ page_cache_async_readahead(struct address_space *mapping,
 
 	ClearPageReadahead(page);
 
+	/* the previous window was used, let it grow back */
+	if (ra->shrink)
+		ra->shrink--;
+
 	/*
 	 * Defer asynchronous read-ahead on IO congestion.
 	 */
@@ -14,12 +14,16 @@
 #include <linux/mm_types.h>
 #include <linux/swapfile.h>
 #include <linux/swap.h>
+#include <linux/ktime.h>
 
 #define SWAP_RATIO_GROUP_START (SWAP_FLAG_PRIO_MASK - 9) /* 32758 */
 #define SWAP_RATIO_GROUP_END (SWAP_FLAG_PRIO_MASK) /* 32767 */
 #define SWAP_FAST_WRITES (SWAPFILE_CLUSTER * (SWAP_CLUSTER_MAX / 8))
 #define SWAP_SLOW_WRITES SWAPFILE_CLUSTER
 
+/* Below this much free space the fast device share is scaled down */
+#define SWAP_RATIO_FREE_LOW	25
+
 /*
  * The fast/slow swap write ratio.
  * 100 indicates that all writes should
@@ -30,6 +34,12 @@ int sysctl_swap_ratio = 100;
 /* Enable the swap ratio feature */
 int sysctl_swap_ratio_enable;
 
+/*
+ * Adapt the ratio to the measured write latency and the free space
+ * of the fast device.
+ */
+int sysctl_swap_ratio_adaptive = 1;
+
 static bool is_same_group(struct swap_info_struct *a,
 		struct swap_info_struct *b)
 {
@@ -45,6 +55,36 @@ static bool is_same_group(struct swap_info_struct *a,
 	return false;
 }
 
+/*
+ * Weight the configured share of writes going to the fast device @si
+ * by the write latency of both devices, so that each gets writes in
+ * inverse proportion to its latency, and back off from @si as it
+ * runs out of space. A full zram device then no longer adds latency
+ * to swap-out.
+ */
+static int swap_ratio_adapt(struct swap_info_struct *si,
+			struct swap_info_struct *n, int ratio)
+{
+	unsigned long fast_lat = READ_ONCE(si->write_lat);
+	unsigned long slow_lat = READ_ONCE(n->write_lat);
+	unsigned int free_pct;
+	u64 div;
+
+	if (fast_lat && slow_lat) {
+		div = (u64)ratio * slow_lat + (u64)(100 - ratio) * fast_lat;
+		if (div)
+			ratio = div64_u64((u64)ratio * slow_lat * 100, div);
+	}
+
+	if (si->pages) {
+		free_pct = (si->pages - si->inuse_pages) * 100ULL / si->pages;
+		if (free_pct < SWAP_RATIO_FREE_LOW)
+			ratio = ratio * free_pct / SWAP_RATIO_FREE_LOW;
+	}
+
+	return ratio;
+}
+
 /* Caller must hold swap_avail_lock */
 static int calculate_write_pending(struct swap_info_struct *si,
 			struct swap_info_struct *n)
@@ -60,6 +100,9 @@ static int calculate_write_pending(struct swap_info_struct *si,
 	if ((n->flags & SWP_FAST) || !is_same_group(si, n))
 		return -ENODEV;
 
+	if (sysctl_swap_ratio_adaptive)
+		ratio = swap_ratio_adapt(si, n, ratio);
+
 	si->max_writes = ratio ? SWAP_FAST_WRITES : 0;
 	n->max_writes  = ratio ? (SWAP_FAST_WRITES * 100) /
 			ratio - SWAP_FAST_WRITES : SWAP_SLOW_WRITES;
@@ -68,13 +111,13 @@ static int calculate_write_pending(struct swap_info_struct *si,
 	n->write_pending = n->max_writes;
 
 #if defined(CONFIG_TRACING) && defined(DEBUG)
-	trace_printk("%u, %u\n", si->max_writes, n->max_writes);
+	trace_printk("%d: %u, %u\n", ratio, si->max_writes, n->max_writes);
 #endif
 
 	return 0;
 }
 
-static int swap_ratio_slow(struct swap_info_struct **si)
+static int swap_ratio_slow(struct swap_info_struct **si, bool cold)
 {
 	struct swap_info_struct *n = NULL;
 	int ret = 0;
@@ -100,6 +143,20 @@ static int swap_ratio_slow(struct swap_info_struct **si)
 	spin_lock(&n->lock);
 	spin_lock(&swap_avail_lock);
 
+	if (cold) {
+		/*
+		 * Cold pages bypass the ratio and go to the slow device,
+		 * without using up its pending writes.
+		 */
+		if (((*si)->flags & SWP_FAST) && !(n->flags & SWP_FAST) &&
+		    is_same_group(*si, n)) {
+			spin_unlock(&(*si)->lock);
+			*si = n;
+			goto skip;
+		}
+		goto exit;
+	}
+
 	if ((*si)->flags & SWP_FAST) {
 		if ((*si)->write_pending) {
 			(*si)->write_pending--;
@@ -188,13 +245,33 @@ void setup_swap_ratio(struct swap_info_struct *p, int prio)
 	}
 }
 
-int swap_ratio(struct swap_info_struct **si)
+int swap_ratio(struct swap_info_struct **si, bool cold)
 {
 	if (!sysctl_swap_ratio_enable)
 		return -ENODEV;
 
 	if (is_swap_ratio_group((*si)->prio))
-		return swap_ratio_slow(si);
+		return swap_ratio_slow(si, cold);
 	else
 		return -ENODEV;
 }
+
+/* Whether swap-out latency of @si is sampled for the adaptive ratio */
+bool swap_ratio_timed(struct swap_info_struct *si)
+{
+	return sysctl_swap_ratio_enable && sysctl_swap_ratio_adaptive &&
+		is_swap_ratio_group(si->prio);
+}
+
+/*
+ * Account a swap-out to @si submitted at @start, in ns truncated to
+ * unsigned long. Latencies are averaged with a 1/8 weight for the
+ * new sample.
+ */
+void swap_ratio_write_done(struct swap_info_struct *si, unsigned long start)
+{
+	unsigned long lat = (unsigned long)ktime_get_ns() - start;
+	unsigned long avg = READ_ONCE(si->write_lat);
+
+	WRITE_ONCE(si->write_lat, avg ? avg - (avg >> 3) + (lat >> 3) : lat);
+}
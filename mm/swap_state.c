@@ -18,6 +18,7 @@
 #include <linux/pagevec.h>
 #include <linux/migrate.h>
 #include <linux/page_cgroup.h>
+#include <linux/moduleparam.h>
 
 #include <asm/pgtable.h>
 #include "internal.h"
@@ -69,6 +70,32 @@ unsigned long total_swapcache_pages(void)
 
 static atomic_t swapin_readahead_hits = ATOMIC_INIT(4);
 
+/*
+ * Per-vma swap-in readahead state in vma->swap_readahead_info: the page
+ * aligned address of the last fault, the readahead window used for it
+ * and the number of readahead hits since.
+ */
+#define SWAP_RA_WIN_SHIFT	(PAGE_SHIFT / 2)
+#define SWAP_RA_HITS_MASK	((1UL << SWAP_RA_WIN_SHIFT) - 1)
+#define SWAP_RA_HITS_MAX	SWAP_RA_HITS_MASK
+#define SWAP_RA_WIN_MASK	(~PAGE_MASK & ~SWAP_RA_HITS_MASK)
+
+#define SWAP_RA_HITS(v)		((v) & SWAP_RA_HITS_MASK)
+#define SWAP_RA_WIN(v)		(((v) & SWAP_RA_WIN_MASK) >> SWAP_RA_WIN_SHIFT)
+#define SWAP_RA_ADDR(v)		((v) & PAGE_MASK)
+
+#define SWAP_RA_VAL(addr, win, hits)				\
+	(((addr) & PAGE_MASK) |					\
+	 (((win) << SWAP_RA_WIN_SHIFT) & SWAP_RA_WIN_MASK) |	\
+	 ((hits) & SWAP_RA_HITS_MASK))
+
+/* Upper bound of the vma readahead window, as a page_cluster order */
+#define SWAP_RA_ORDER_CEILING	3
+#define SWAP_RA_PTE_MAX		(1 << SWAP_RA_ORDER_CEILING)
+
+static bool swap_vma_ra_enabled = true;
+module_param_named(vma_readahead, swap_vma_ra_enabled, bool, 0644);
+
 void show_swap_cache_info(void)
 {
 	printk("%lu pages in swap cache\n", total_swapcache_pages());
@@ -164,11 +191,13 @@ void __delete_from_swap_cache(struct page *page)
 /**
  * add_to_swap - allocate swap space for a page
  * @page: page we want to move to swap
+ * @list: list for the tail pages if @page is split
+ * @cold: @page is unlikely to be used again soon
  *
  * Allocate swap space for the page and add the page to the
  * swap cache.  Caller needs to hold the page lock. 
  */
-int add_to_swap(struct page *page, struct list_head *list)
+int add_to_swap(struct page *page, struct list_head *list, bool cold)
 {
 	swp_entry_t entry;
 	int err;
@@ -176,7 +205,7 @@ int add_to_swap(struct page *page, struct list_head *list)
 	VM_BUG_ON_PAGE(!PageLocked(page), page);
 	VM_BUG_ON_PAGE(!PageUptodate(page), page);
 
-	entry = get_swap_page();
+	entry = __get_swap_page(cold);
 	if (!entry.val)
 		return 0;
 
@@ -282,16 +311,27 @@ void free_pages_and_swap_cache(struct page **pages, int nr)
  * lock getting page table operations atomic even if we drop the page
  * lock before returning.
  */
-struct page * lookup_swap_cache(swp_entry_t entry)
+struct page * lookup_swap_cache(swp_entry_t entry, struct vm_area_struct *vma,
+				 unsigned long addr)
 {
 	struct page *page;
+	unsigned long ra_val, hits;
 
 	page = find_get_page(swap_address_space(entry), entry.val);
 
 	if (page) {
 		INC_CACHE_INFO(find_success);
-		if (TestClearPageReadahead(page))
+		if (TestClearPageReadahead(page)) {
 			atomic_inc(&swapin_readahead_hits);
+			if (vma) {
+				ra_val = atomic_long_read(
+						&vma->swap_readahead_info);
+				hits = SWAP_RA_HITS(ra_val);
+				if (hits < SWAP_RA_HITS_MAX)
+					atomic_long_set(&vma->swap_readahead_info,
+							ra_val + 1);
+			}
+		}
 	}
 
 	INC_CACHE_INFO(find_total);
@@ -394,22 +434,20 @@ struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
 	return found_page;
 }
 
-static unsigned long swapin_nr_pages(unsigned long offset)
+static unsigned int __swapin_nr_pages(unsigned long prev_offset,
+				      unsigned long offset,
+				      int hits,
+				      int max_pages,
+				      int prev_win)
 {
-	static unsigned long prev_offset;
-	unsigned int pages, max_pages, last_ra;
-	static atomic_t last_readahead_pages;
-
-	max_pages = 1 << ACCESS_ONCE(page_cluster);
-	if (max_pages <= 1)
-		return 1;
+	unsigned int pages, last_ra;
 
 	/*
 	 * This heuristic has been found to work well on both sequential and
 	 * random loads, swapping to hard disk or to SSD: please don't ask
 	 * what the "+ 2" means, it just happens to work well, that's all.
 	 */
-	pages = atomic_xchg(&swapin_readahead_hits, 0) + 2;
+	pages = hits + 2;
 	if (pages == 2) {
 		/*
 		 * We can have no readahead hits to judge by: but must not get
@@ -418,7 +456,6 @@ static unsigned long swapin_nr_pages(unsigned long offset)
 		 */
 		if (offset != prev_offset + 1 && offset != prev_offset - 1)
 			pages = 1;
-		prev_offset = offset;
 	} else {
 		unsigned int roundup = 4;
 		while (roundup < pages)
@@ -430,9 +467,28 @@ static unsigned long swapin_nr_pages(unsigned long offset)
 		pages = max_pages;
 
 	/* Don't shrink readahead too fast */
-	last_ra = atomic_read(&last_readahead_pages) / 2;
+	last_ra = prev_win / 2;
 	if (pages < last_ra)
 		pages = last_ra;
+
+	return pages;
+}
+
+static unsigned long swapin_nr_pages(unsigned long offset)
+{
+	static unsigned long prev_offset;
+	unsigned int hits, pages, max_pages;
+	static atomic_t last_readahead_pages;
+
+	max_pages = 1 << ACCESS_ONCE(page_cluster);
+	if (max_pages <= 1)
+		return 1;
+
+	hits = atomic_xchg(&swapin_readahead_hits, 0);
+	pages = __swapin_nr_pages(prev_offset, offset, hits, max_pages,
+				  atomic_read(&last_readahead_pages));
+	if (!hits)
+		prev_offset = offset;
 	atomic_set(&last_readahead_pages, pages);
 
 	return pages;
@@ -494,3 +550,121 @@ struct page *swapin_readahead(swp_entry_t entry, gfp_t gfp_mask,
 skip:
 	return read_swap_cache_async(entry, gfp_mask, vma, addr);
 }
+
+/*
+ * Clamp the readahead window [fpfn - left, fpfn + right) to the vma and
+ * to the page table of @faddr, so that all ptes can be read at once.
+ */
+static void swap_ra_clamp_pfn(struct vm_area_struct *vma,
+			      unsigned long faddr,
+			      unsigned long lpfn,
+			      unsigned long rpfn,
+			      unsigned long *start,
+			      unsigned long *end)
+{
+	*start = max3(lpfn, PFN_DOWN(vma->vm_start),
+		      PFN_DOWN(faddr & PMD_MASK));
+	*end = min3(rpfn, PFN_DOWN(vma->vm_end),
+		    PFN_DOWN((faddr & PMD_MASK) + PMD_SIZE));
+}
+
+/**
+ * swap_vma_readahead - swap in pages around a faulting address
+ * @fentry: swap entry of the faulting page
+ * @gfp_mask: memory allocation flags
+ * @vma: user vma the faulting address belongs to
+ * @faddr: faulting address
+ *
+ * Returns the struct page for @fentry and @faddr, after queueing swapin.
+ *
+ * Unlike swapin_readahead(), which reads ahead in swap offset order,
+ * this reads the swap entries of the ptes around @faddr: what is close
+ * in the vma is likely to be used together, wherever it landed on the
+ * swap device. The window is sized from the readahead hits of this vma
+ * and whether the fault continues a sequential pattern, so a vma with
+ * random access quickly stops reading ahead. Entries on fast swap
+ * devices such as zram are never read ahead, random access is cheap
+ * there and speculative reads only cost decompression and memory.
+ *
+ * Caller must hold down_read on the vma->vm_mm.
+ */
+struct page *swap_vma_readahead(swp_entry_t fentry, gfp_t gfp_mask,
+				struct vm_area_struct *vma, unsigned long faddr)
+{
+	pte_t ptes[SWAP_RA_PTE_MAX];
+	unsigned long ra_val, pfn, fpfn, start, end, addr;
+	unsigned int max_win, hits, prev_win, win, left;
+	struct blk_plug plug;
+	struct page *page;
+	swp_entry_t entry;
+	pmd_t *pmd;
+	pte_t *pte;
+	int i, nr;
+
+	if (!swap_vma_ra_enabled)
+		return swapin_readahead(fentry, gfp_mask, vma, faddr);
+
+	max_win = 1 << min_t(unsigned int, ACCESS_ONCE(page_cluster),
+			     SWAP_RA_ORDER_CEILING);
+	if (max_win <= 1 || is_swap_fast(fentry))
+		goto skip;
+
+	faddr &= PAGE_MASK;
+	fpfn = PFN_DOWN(faddr);
+	ra_val = atomic_long_read(&vma->swap_readahead_info);
+	pfn = PFN_DOWN(SWAP_RA_ADDR(ra_val));
+	prev_win = SWAP_RA_WIN(ra_val);
+	hits = SWAP_RA_HITS(ra_val);
+	win = __swapin_nr_pages(pfn, fpfn, hits, max_win, prev_win);
+	atomic_long_set(&vma->swap_readahead_info,
+			SWAP_RA_VAL(faddr, win, 0));
+	if (win == 1)
+		goto skip;
+
+	/* Read ahead in the direction of a sequential pattern */
+	if (fpfn == pfn + 1) {
+		swap_ra_clamp_pfn(vma, faddr, fpfn, fpfn + win, &start, &end);
+	} else if (pfn == fpfn + 1) {
+		swap_ra_clamp_pfn(vma, faddr, fpfn - win + 1, fpfn + 1,
+				  &start, &end);
+	} else {
+		left = (win - 1) / 2;
+		swap_ra_clamp_pfn(vma, faddr, fpfn - left, fpfn + win - left,
+				  &start, &end);
+	}
+	/* A window wrapping below zero ends up empty here */
+	if (end <= start + 1)
+		goto skip;
+	nr = end - start;
+
+	pmd = mm_find_pmd(vma->vm_mm, faddr);
+	if (!pmd)
+		goto skip;
+
+	/* The ptes are only a hint, read_swap_cache_async() checks them */
+	pte = pte_offset_map(pmd, start << PAGE_SHIFT);
+	for (i = 0; i < nr; i++)
+		ptes[i] = pte[i];
+	pte_unmap(pte);
+
+	blk_start_plug(&plug);
+	for (i = 0, addr = start << PAGE_SHIFT; i < nr;
+	     i++, addr += PAGE_SIZE) {
+		if (!is_swap_pte(ptes[i]))
+			continue;
+		entry = pte_to_swp_entry(ptes[i]);
+		if (unlikely(non_swap_entry(entry)) || is_swap_fast(entry))
+			continue;
+		page = read_swap_cache_async(entry, gfp_mask, vma, addr);
+		if (!page)
+			continue;
+		if (addr != faddr)
+			SetPageReadahead(page);
+		page_cache_release(page);
+	}
+	blk_finish_plug(&plug);
+
+	lru_add_drain();	/* Push any new pages onto the LRU now */
+skip:
+	return read_swap_cache_async(fentry, gfp_mask, vma, faddr);
+}
@@ -657,7 +657,11 @@ no_page:
 	return 0;
 }
 
-swp_entry_t get_swap_page(void)
+/*
+ * @cold entries are steered to the slow device of a swap ratio group,
+ * keeping the fast device for pages that are likely to be swapped in.
+ */
+swp_entry_t __get_swap_page(bool cold)
 {
 	struct swap_info_struct *si, *next;
 	pgoff_t offset;
@@ -677,7 +681,7 @@ start_over:
 			int ret;
 
 			spin_unlock(&swap_avail_lock);
-			ret = swap_ratio(&si);
+			ret = swap_ratio(&si, cold);
 			if (0 > ret) {
 				/*
 				 * Error. Start again with swap
@@ -742,6 +746,11 @@ noswap:
 	return (swp_entry_t) {0};
 }
 
+swp_entry_t get_swap_page(void)
+{
+	return __get_swap_page(false);
+}
+
 /* The only caller of this function is now suspend routine */
 swp_entry_t get_swap_page_of_type(int type)
 {
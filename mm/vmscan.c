@@ -627,6 +627,15 @@ static int __remove_mapping(struct address_space *mapping, struct page *page,
 		if (reclaimed && page_is_file_cache(page) &&
 		    !mapping_exiting(mapping))
 			shadow = workingset_eviction(mapping, page);
+		/*
+		 * A clean page still carrying PG_readahead (which shares
+		 * its bit with PG_reclaim, but writeback is over by now)
+		 * is a readahead mark nobody reached: the tail of that
+		 * window was read for nothing.  Let readahead on this
+		 * file back off.
+		 */
+		if (reclaimed && PageReadahead(page))
+			mapping->nr_ra_wasted++;
 		__delete_from_page_cache(page, shadow);
 		spin_unlock_irq(&mapping->tree_lock);
 
@@ -994,7 +1003,11 @@ static unsigned long shrink_page_list(struct list_head *page_list,
 		if (PageAnon(page) && !PageSwapCache(page)) {
 			if (!(sc->gfp_mask & __GFP_IO))
 				goto keep_locked;
-			if (!add_to_swap(page, page_list))
+			/*
+			 * Pages reclaimed from a target vma were picked
+			 * by per-process reclaim as cold.
+			 */
+			if (!add_to_swap(page, page_list, !!sc->target_vma))
 				goto activate_locked;
 			may_enter_fs = 1;
 
@@ -1863,6 +1876,17 @@ static void shrink_active_list(unsigned long nr_to_scan,
 			}
 		}
 
+		/*
+		 * File pages that refaulted into a memcg with refault
+		 * protection (e.g. the foreground app) just proved the
+		 * cache is thrashing; give them one more trip as well.
+		 */
+		if (page_is_file_cache(page) &&
+		    mem_cgroup_refault_protected(page)) {
+			list_add(&page->lru, &l_active);
+			continue;
+		}
+
 		ClearPageActive(page);	/* we are de-activating */
 		if (IS_ENABLED(CONFIG_ZCACHE))
 			/*
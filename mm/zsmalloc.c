@@ -68,6 +68,9 @@
 #include <linux/debugfs.h>
 #include <linux/zsmalloc.h>
 #include <linux/zpool.h>
+#include <linux/kthread.h>
+#include <linux/freezer.h>
+#include <linux/wait.h>
 
 /*
  * This must be power of 2 and greater than of equal to sizeof(link_free).
@@ -173,14 +176,14 @@ enum zs_stat_type {
 	NR_ZS_STAT_TYPE,
 };
 
-#ifdef CONFIG_ZSMALLOC_STAT
-
-static struct dentry *zs_stat_root;
-
 struct zs_size_stat {
 	unsigned long objs[NR_ZS_STAT_TYPE];
 };
 
+#ifdef CONFIG_ZSMALLOC_STAT
+
+static struct dentry *zs_stat_root;
+
 #endif
 
 /*
@@ -204,6 +207,21 @@ static int zs_size_classes;
  */
 static const int fullness_threshold_frac = 4;
 
+/*
+ * Background compaction: a class is handed to the pool's compaction
+ * thread once at least bg_compact_threshold percent of its zspages are
+ * ZS_ALMOST_EMPTY and enough objects are unused to free a zspage. Each
+ * pass over a class runs for at most bg_compact_budget_us, then the
+ * thread sleeps for bg_compact_interval_ms before it carries on.
+ * A threshold of 0 disables background compaction.
+ */
+static unsigned int bg_compact_threshold = 25;
+module_param(bg_compact_threshold, uint, 0644);
+static unsigned int bg_compact_budget_us = 2000;
+module_param(bg_compact_budget_us, uint, 0644);
+static unsigned int bg_compact_interval_ms = 20;
+module_param(bg_compact_interval_ms, uint, 0644);
+
 struct size_class {
 	/*
 	 * Size of objects stored in this class. Must be multiple
@@ -217,9 +235,8 @@ struct size_class {
 	/* huge object: pages_per_zspage == 1 && maxobj_per_zspage == 1 */
 	bool huge;
 
-#ifdef CONFIG_ZSMALLOC_STAT
+	/* protected by lock, also kept without CONFIG_ZSMALLOC_STAT */
 	struct zs_size_stat stats;
-#endif
 
 	spinlock_t lock;
 
@@ -252,9 +269,16 @@ struct zs_pool {
 	struct size_class **size_class;
 	struct kmem_cache *handle_cachep;
 
-	gfp_t flags;	/* allocation flags used when growing pool */
 	atomic_long_t pages_allocated;
 
+	/* background compaction, see bg_compact_threshold */
+	struct task_struct *compactd;
+	wait_queue_head_t compact_wait;
+	/* classes waiting for compactd, one bit per class index */
+	unsigned long *compact_classes;
+	/* no. of objects migrated by compactd */
+	atomic_long_t bg_migrated;
+
 #ifdef CONFIG_ZSMALLOC_STAT
 	struct dentry *stat_dentry;
 #endif
@@ -293,10 +317,10 @@ static void destroy_handle_cache(struct zs_pool *pool)
 		kmem_cache_destroy(pool->handle_cachep);
 }
 
-static unsigned long alloc_handle(struct zs_pool *pool)
+static unsigned long alloc_handle(struct zs_pool *pool, gfp_t gfp)
 {
 	return (unsigned long)kmem_cache_alloc(pool->handle_cachep,
-		pool->flags & ~__GFP_HIGHMEM);
+		gfp & ~__GFP_HIGHMEM);
 }
 
 static void free_handle(struct zs_pool *pool, unsigned long handle)
@@ -320,7 +344,7 @@ static void record_obj(unsigned long handle, unsigned long obj)
 
 static void *zs_zpool_create(char *name, gfp_t gfp, struct zpool_ops *zpool_ops)
 {
-	return zs_create_pool(name, gfp);
+	return zs_create_pool(name);
 }
 
 static void zs_zpool_destroy(void *pool)
@@ -331,7 +355,7 @@ static void zs_zpool_destroy(void *pool)
 static int zs_zpool_malloc(void *pool, size_t size, gfp_t gfp,
 			unsigned long *handle)
 {
-	*handle = zs_malloc(pool, size);
+	*handle = zs_malloc(pool, size, gfp);
 	return *handle ? 0 : -1;
 }
 static void zs_zpool_free(void *pool, unsigned long handle)
@@ -449,8 +473,6 @@ static int get_size_class_index(int size)
 	return min(zs_size_classes - 1, idx);
 }
 
-#ifdef CONFIG_ZSMALLOC_STAT
-
 static inline void zs_stat_inc(struct size_class *class,
 				enum zs_stat_type type, unsigned long cnt)
 {
@@ -469,6 +491,8 @@ static inline unsigned long zs_stat_get(struct size_class *class,
 	return class->stats.objs[type];
 }
 
+#ifdef CONFIG_ZSMALLOC_STAT
+
 static int __init zs_stat_init(void)
 {
 	if (!debugfs_initialized())
@@ -585,22 +609,6 @@ static void zs_pool_stat_destroy(struct zs_pool *pool)
 
 #else /* CONFIG_ZSMALLOC_STAT */
 
-static inline void zs_stat_inc(struct size_class *class,
-				enum zs_stat_type type, unsigned long cnt)
-{
-}
-
-static inline void zs_stat_dec(struct size_class *class,
-				enum zs_stat_type type, unsigned long cnt)
-{
-}
-
-static inline unsigned long zs_stat_get(struct size_class *class,
-				enum zs_stat_type type)
-{
-	return 0;
-}
-
 static int __init zs_stat_init(void)
 {
 	return 0;
@@ -1383,12 +1391,13 @@ static unsigned long obj_malloc(struct page *first_page,
  * zs_malloc - Allocate block of given size from pool.
  * @pool: pool to allocate from
  * @size: size of block to allocate
+ * @gfp: gfp flags when allocating object
  *
  * On success, handle to the allocated object is returned,
  * otherwise 0.
  * Allocation requests with size > ZS_MAX_ALLOC_SIZE will fail.
  */
-unsigned long zs_malloc(struct zs_pool *pool, size_t size)
+unsigned long zs_malloc(struct zs_pool *pool, size_t size, gfp_t gfp)
 {
 	unsigned long handle, obj;
 	struct size_class *class;
@@ -1397,7 +1406,7 @@ unsigned long zs_malloc(struct zs_pool *pool, size_t size)
 	if (unlikely(!size || size > ZS_MAX_ALLOC_SIZE))
 		return 0;
 
-	handle = alloc_handle(pool);
+	handle = alloc_handle(pool, gfp);
 	if (!handle)
 		return 0;
 
@@ -1410,7 +1419,7 @@ unsigned long zs_malloc(struct zs_pool *pool, size_t size)
 
 	if (!first_page) {
 		spin_unlock(&class->lock);
-		first_page = alloc_zspage(class, pool->flags);
+		first_page = alloc_zspage(class, gfp);
 		if (unlikely(!first_page)) {
 			free_handle(pool, handle);
 			return 0;
@@ -1435,6 +1444,96 @@ unsigned long zs_malloc(struct zs_pool *pool, size_t size)
 }
 EXPORT_SYMBOL_GPL(zs_malloc);
 
+/**
+ * zs_lookup_class_size - size of the class an object would be stored in
+ * @pool: pool the object would be allocated from
+ * @size: size of the object
+ *
+ * Lets a user such as zram tell whether shrinking an object would
+ * actually save memory: objects of different sizes that map to the
+ * same class occupy the same space.
+ */
+unsigned int zs_lookup_class_size(struct zs_pool *pool, size_t size)
+{
+	struct size_class *class;
+
+	class = pool->size_class[get_size_class_index(size + ZS_HANDLE_SIZE)];
+	return class->size;
+}
+EXPORT_SYMBOL_GPL(zs_lookup_class_size);
+
+/**
+ * zs_get_nr_size_classes - number of size class slots of a pool
+ *
+ * Upper bound for the @idx argument of zs_get_class_stats().
+ */
+unsigned int zs_get_nr_size_classes(void)
+{
+	return zs_size_classes;
+}
+EXPORT_SYMBOL_GPL(zs_get_nr_size_classes);
+
+/**
+ * zs_get_class_stats - occupancy of a single size class
+ * @pool: pool to inspect
+ * @idx: size class index, below zs_get_nr_size_classes()
+ * @stats: filled in on success
+ *
+ * Neighbouring sizes that need the same zspage geometry share one
+ * class. Returns false for the indices merged into another class so
+ * that every class is reported exactly once.
+ */
+bool zs_get_class_stats(struct zs_pool *pool, unsigned int idx,
+			struct zs_class_stats *stats)
+{
+	struct size_class *class = pool->size_class[idx];
+	unsigned long objs_per_zspage;
+
+	if (class->index != idx)
+		return false;
+
+	spin_lock(&class->lock);
+	stats->obj_allocated = zs_stat_get(class, OBJ_ALLOCATED);
+	stats->obj_used = zs_stat_get(class, OBJ_USED);
+	stats->almost_full = zs_stat_get(class, CLASS_ALMOST_FULL);
+	stats->almost_empty = zs_stat_get(class, CLASS_ALMOST_EMPTY);
+	spin_unlock(&class->lock);
+
+	objs_per_zspage = get_maxobj_per_zspage(class->size,
+			class->pages_per_zspage);
+	stats->size = class->size;
+	stats->pages_used = stats->obj_allocated / objs_per_zspage *
+			class->pages_per_zspage;
+	return true;
+}
+EXPORT_SYMBOL_GPL(zs_get_class_stats);
+
+/*
+ * Should compactd look at this class? Caller holds class->lock.
+ */
+static bool zs_class_fragmented(struct size_class *class)
+{
+	unsigned long obj_allocated, obj_used;
+	unsigned long objs_per_zspage, nr_zspages;
+	unsigned int threshold = READ_ONCE(bg_compact_threshold);
+
+	if (!threshold)
+		return false;
+
+	obj_allocated = zs_stat_get(class, OBJ_ALLOCATED);
+	obj_used = zs_stat_get(class, OBJ_USED);
+	objs_per_zspage = get_maxobj_per_zspage(class->size,
+			class->pages_per_zspage);
+
+	/* migration can only free a zspage if that many objects are unused */
+	if (obj_allocated - obj_used < objs_per_zspage)
+		return false;
+
+	nr_zspages = obj_allocated / objs_per_zspage;
+	return zs_stat_get(class, CLASS_ALMOST_EMPTY) * 100 >=
+		nr_zspages * threshold;
+}
+
 static void obj_free(struct zs_pool *pool, struct size_class *class,
 			unsigned long obj)
 {
@@ -1469,6 +1568,7 @@ static void obj_free(struct zs_pool *pool, struct size_class *class,
 
 void zs_free(struct zs_pool *pool, unsigned long handle)
 {
+	bool wake_compactd;
 	struct page *first_page, *f_page;
 	unsigned long obj, f_objidx;
 	int class_idx;
@@ -1496,10 +1596,15 @@ void zs_free(struct zs_pool *pool, unsigned long handle)
 				&pool->pages_allocated);
 		free_zspage(first_page);
 	}
+	wake_compactd = zs_class_fragmented(class) &&
+		!test_and_set_bit(class->index, pool->compact_classes);
 	spin_unlock(&class->lock);
 	unpin_tag(handle);
 
 	free_handle(pool, handle);
+
+	if (wake_compactd)
+		wake_up(&pool->compact_wait);
 }
 EXPORT_SYMBOL_GPL(zs_free);
 
@@ -1715,8 +1820,13 @@ static struct page *isolate_source_page(struct size_class *class)
 	return page;
 }
 
+/*
+ * Compact @class. If @deadline (in local_clock() ns) is non-zero, stop
+ * after the first source zspage that finishes past it and set *@partial.
+ */
 static unsigned long __zs_compact(struct zs_pool *pool,
-				struct size_class *class)
+				struct size_class *class, u64 deadline,
+				bool *partial)
 {
 	int nr_to_migrate;
 	struct zs_compact_control cc;
@@ -1756,6 +1866,10 @@ static unsigned long __zs_compact(struct zs_pool *pool,
 		putback_zspage(pool, class, src_page);
 		spin_unlock(&class->lock);
 		nr_total_migrated += cc.nr_migrated;
+		if (deadline && local_clock() > deadline) {
+			*partial = true;
+			return nr_total_migrated;
+		}
 		cond_resched();
 		spin_lock(&class->lock);
 	}
@@ -1780,16 +1894,79 @@ unsigned long zs_compact(struct zs_pool *pool)
 			continue;
 		if (class->index != i)
 			continue;
-		nr_migrated += __zs_compact(pool, class);
+		nr_migrated += __zs_compact(pool, class, 0, NULL);
 	}
 
 	return nr_migrated;
 }
 EXPORT_SYMBOL_GPL(zs_compact);
 
+/**
+ * zs_get_bg_migrated - objects migrated by background compaction
+ * @pool: pool to inspect
+ */
+unsigned long zs_get_bg_migrated(struct zs_pool *pool)
+{
+	return atomic_long_read(&pool->bg_migrated);
+}
+EXPORT_SYMBOL_GPL(zs_get_bg_migrated);
+
+static bool zs_compactd_has_work(struct zs_pool *pool)
+{
+	return !bitmap_empty(pool->compact_classes, zs_size_classes);
+}
+
+/*
+ * Per-pool background compaction thread. Classes are queued by zs_free()
+ * and compacted largest first, in slices of bg_compact_budget_us so the
+ * thread never holds a class for long and reclaim does not have to
+ * wait for compaction.
+ */
+static int zs_compactd(void *data)
+{
+	struct zs_pool *pool = data;
+	struct size_class *class;
+	bool partial;
+	u64 deadline;
+	int i;
+
+	set_freezable();
+	set_user_nice(current, MAX_NICE);
+
+	while (!kthread_should_stop()) {
+		wait_event_freezable(pool->compact_wait,
+			zs_compactd_has_work(pool) || kthread_should_stop());
+		if (kthread_should_stop())
+			break;
+
+		partial = false;
+		deadline = local_clock() +
+			(u64)READ_ONCE(bg_compact_budget_us) * NSEC_PER_USEC;
+		for (i = zs_size_classes - 1; i >= 0; i--) {
+			if (!test_and_clear_bit(i, pool->compact_classes))
+				continue;
+
+			class = pool->size_class[i];
+			atomic_long_add(__zs_compact(pool, class, deadline,
+						&partial), &pool->bg_migrated);
+			if (partial) {
+				/* carry on with this class in the next slice */
+				set_bit(i, pool->compact_classes);
+				break;
+			}
+		}
+
+		if (partial)
+			schedule_timeout_interruptible(
+				msecs_to_jiffies(bg_compact_interval_ms));
+	}
+
+	return 0;
+}
+
 /**
  * zs_create_pool - Creates an allocation pool to work from.
- * @flags: allocation flags used to allocate pool metadata
+ * @name: pool name to be created
  *
  * This function must be called before anything when using
  * the zsmalloc allocator.
@@ -1797,7 +1974,7 @@ EXPORT_SYMBOL_GPL(zs_compact);
  * On success, a pointer to the newly created pool is returned,
  * otherwise NULL.
  */
-struct zs_pool *zs_create_pool(char *name, gfp_t flags)
+struct zs_pool *zs_create_pool(char *name)
 {
 	int i;
 	struct zs_pool *pool;
@@ -1867,11 +2044,22 @@ struct zs_pool *zs_create_pool(char *name, gfp_t flags)
 		prev_class = class;
 	}
 
-	pool->flags = flags;
-
 	if (zs_pool_stat_create(name, pool))
 		goto err;
 
+	init_waitqueue_head(&pool->compact_wait);
+	pool->compact_classes = kcalloc(BITS_TO_LONGS(zs_size_classes),
+			sizeof(unsigned long), GFP_KERNEL);
+	if (!pool->compact_classes)
+		goto err;
+
+	pool->compactd = kthread_run(zs_compactd, pool, "zs_compactd/%s",
+			name);
+	if (IS_ERR(pool->compactd)) {
+		pool->compactd = NULL;
+		goto err;
+	}
+
 	return pool;
 
 err:
@@ -1884,6 +2072,10 @@ void zs_destroy_pool(struct zs_pool *pool)
 {
 	int i;
 
+	if (pool->compactd)
+		kthread_stop(pool->compactd);
+	kfree(pool->compact_classes);
+
 	zs_pool_stat_destroy(pool);
 
 	for (i = 0; i < zs_size_classes; i++) {
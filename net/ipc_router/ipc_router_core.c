@@ -3364,12 +3364,60 @@ int msm_ipc_router_read(struct msm_ipc_port *port_ptr,
 		__pm_relax(port_ptr->port_rx_ws);
 	*read_pkt = pkt;
 	mutex_unlock(&port_ptr->port_rx_q_lock_lhc3);
-	if (pkt->hdr.control_flag & CONTROL_FLAG_CONFIRM_RX)
-		msm_ipc_router_send_resume_tx(&pkt->hdr);
+	msm_ipc_router_read_done(pkt);
 
 	return pkt->length;
 }
 
+/**
+ * msm_ipc_router_read_batch() - Dequeue several messages from a local port
+ * @port_ptr: Pointer to the local port.
+ * @batch: List to which the dequeued packets are appended.
+ * @max_pkts: Maximum number of packets to dequeue.
+ *
+ * @return: Number of packets dequeued, -EAGAIN if none are pending,
+ *	    standard Linux error code otherwise.
+ *
+ * All the packets are moved under a single acquisition of the port's rx
+ * queue lock. The Resume_Tx owed for a packet with the confirm_rx flag set
+ * is not sent here; the caller must pass every packet to
+ * msm_ipc_router_read_done() when it is actually consumed, so that the
+ * remote flow control keeps tracking what the reader processed.
+ */
+int msm_ipc_router_read_batch(struct msm_ipc_port *port_ptr,
+			      struct list_head *batch, int max_pkts)
+{
+	struct rr_packet *pkt, *tmp_pkt;
+	int n = 0;
+
+	if (!port_ptr || !batch || max_pkts <= 0)
+		return -EINVAL;
+
+	mutex_lock(&port_ptr->port_rx_q_lock_lhc3);
+	list_for_each_entry_safe(pkt, tmp_pkt, &port_ptr->port_rx_q, list) {
+		list_move_tail(&pkt->list, batch);
+		if (++n == max_pkts)
+			break;
+	}
+	if (n && list_empty(&port_ptr->port_rx_q))
+		__pm_relax(port_ptr->port_rx_ws);
+	mutex_unlock(&port_ptr->port_rx_q_lock_lhc3);
+
+	return n ? n : -EAGAIN;
+}
+
+/**
+ * msm_ipc_router_read_done() - Complete the read of a dequeued message
+ * @pkt: Packet that has been consumed by the reader.
+ *
+ * Sends the Resume_Tx to the sender if the packet asked for a confirmation.
+ */
+void msm_ipc_router_read_done(struct rr_packet *pkt)
+{
+	if (pkt->hdr.control_flag & CONTROL_FLAG_CONFIRM_RX)
+		msm_ipc_router_send_resume_tx(&pkt->hdr);
+}
+
 /**
  * msm_ipc_router_rx_data_wait() - Wait for new message destined to a local port.
  * @port_ptr: Pointer to the local port
@@ -4222,13 +4270,55 @@ static void xprt_close_worker(struct work_struct *work)
 	kfree(xprt_work);
 }
 
+/**
+ * ipc_router_queue_rx_pkt() - Queue a received packet to the xprt rx list
+ * @xprt_info: Transport on which the packet was received.
+ * @pkt: Packet to be queued. Consumed by this function.
+ */
+static void ipc_router_queue_rx_pkt(struct msm_ipc_router_xprt_info *xprt_info,
+				    struct rr_packet *pkt)
+{
+	struct msm_ipc_router_remote_port *rport_ptr = NULL;
+	int ret;
+
+	if (pkt->length < calc_rx_header_size(xprt_info) ||
+	    pkt->length > MAX_IPC_PKT_SIZE) {
+		IPC_RTR_ERR("%s: Invalid pkt length %d\n",
+			    __func__, pkt->length);
+		release_pkt(pkt);
+		return;
+	}
+
+	ret = extract_header(pkt);
+	if (ret < 0) {
+		release_pkt(pkt);
+		return;
+	}
+
+	pkt->ws_need = true;
+
+	if (pkt->hdr.type == IPC_ROUTER_CTRL_CMD_DATA)
+		rport_ptr = ipc_router_get_rport_ref(pkt->hdr.src_node_id,
+						     pkt->hdr.src_port_id);
+
+	mutex_lock(&xprt_info->rx_lock_lhb2);
+	list_add_tail(&pkt->list, &xprt_info->pkt_list);
+	/* check every pkt is from SENSOR services or not*/
+	if (is_sensor_port(rport_ptr))
+		pkt->ws_need = false;
+	else
+		__pm_stay_awake(&xprt_info->ws);
+
+	mutex_unlock(&xprt_info->rx_lock_lhb2);
+	queue_work(xprt_info->workqueue, &xprt_info->read_data);
+}
+
 void msm_ipc_router_xprt_notify(struct msm_ipc_router_xprt *xprt,
 				unsigned event,
 				void *data)
 {
 	struct msm_ipc_router_xprt_info *xprt_info = xprt->priv;
 	struct msm_ipc_router_xprt_work *xprt_work;
-	struct msm_ipc_router_remote_port *rport_ptr = NULL;
 	struct rr_packet *pkt;
 	int ret;
 
@@ -4281,36 +4371,42 @@ void msm_ipc_router_xprt_notify(struct msm_ipc_router_xprt *xprt,
 	if (!pkt)
 		return;
 
-	if (pkt->length < calc_rx_header_size(xprt_info) ||
-	    pkt->length > MAX_IPC_PKT_SIZE) {
-		IPC_RTR_ERR("%s: Invalid pkt length %d\n",
-			    __func__, pkt->length);
-		release_pkt(pkt);
+	ipc_router_queue_rx_pkt(xprt_info, pkt);
+}
+
+/**
+ * msm_ipc_router_xprt_rx_pkt() - Hand a received packet over to IPC Router
+ * @xprt: Transport on which the packet was received.
+ * @pkt: Packet received. Ownership is transferred to IPC Router.
+ *
+ * Unlike an IPC_ROUTER_XPRT_EVENT_DATA notification, the packet is not
+ * cloned: the transport-built rr_packet itself is queued for processing and
+ * eventually lands on the destination port's rx queue. The transport must
+ * not touch or release @pkt after this call.
+ */
+void msm_ipc_router_xprt_rx_pkt(struct msm_ipc_router_xprt *xprt,
+				struct rr_packet *pkt)
+{
+	struct msm_ipc_router_xprt_info *xprt_info = xprt->priv;
+	int ret;
+
+	if (!pkt)
 		return;
-	}
 
-	ret = extract_header(pkt);
+	ret = ipc_router_core_init();
 	if (ret < 0) {
+		IPC_RTR_ERR("%s: Error %d initializing IPC Router\n",
+			    __func__, ret);
 		release_pkt(pkt);
 		return;
 	}
 
-	pkt->ws_need = true;
-
-	if (pkt->hdr.type == IPC_ROUTER_CTRL_CMD_DATA)
-		rport_ptr = ipc_router_get_rport_ref(pkt->hdr.src_node_id,
-						     pkt->hdr.src_port_id);
-
-	mutex_lock(&xprt_info->rx_lock_lhb2);
-	list_add_tail(&pkt->list, &xprt_info->pkt_list);
-	/* check every pkt is from SENSOR services or not*/
-	if (is_sensor_port(rport_ptr))
-		pkt->ws_need = false;
-	else
-		__pm_stay_awake(&xprt_info->ws);
+	while (!xprt_info) {
+		msleep(100);
+		xprt_info = xprt->priv;
+	}
 
-	mutex_unlock(&xprt_info->rx_lock_lhb2);
-	queue_work(xprt_info->workqueue, &xprt_info->read_data);
+	ipc_router_queue_rx_pkt(xprt_info, pkt);
 }
 
 /**
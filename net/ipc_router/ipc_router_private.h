@@ -79,6 +79,7 @@ struct msm_ipc_sock {
 	struct sock sk;
 	struct msm_ipc_port *port;
 	void *default_node_vote_info;
+	struct list_head rx_batch;
 };
 
 /**
@@ -107,6 +108,9 @@ int msm_ipc_router_send_to(struct msm_ipc_port *src,
 int msm_ipc_router_read(struct msm_ipc_port *port_ptr,
 			struct rr_packet **pkt,
 			size_t buf_len);
+int msm_ipc_router_read_batch(struct msm_ipc_port *port_ptr,
+			      struct list_head *batch, int max_pkts);
+void msm_ipc_router_read_done(struct rr_packet *pkt);
 
 int msm_ipc_router_recv_from(struct msm_ipc_port *port_ptr,
 		      struct rr_packet **pkt,
@@ -42,6 +42,14 @@
 #define SIZE_MAX ((size_t)-1)
 #endif
 
+/*
+ * Maximum number of messages pulled off the port's rx queue in one go.
+ * The batch is parked on the socket and drained by subsequent recvmsg()
+ * calls, so that a recvmmsg() loop pays the port locking and wakeup cost
+ * once per batch rather than once per message.
+ */
+#define IPC_ROUTER_RX_BATCH 8
+
 static int sockets_enabled;
 static struct proto msm_ipc_proto;
 static const struct proto_ops msm_ipc_proto_ops;
@@ -231,6 +239,7 @@ static int msm_ipc_router_create(struct net *net,
 	port_ptr->check_send_permissions = msm_ipc_check_send_permissions;
 	msm_ipc_sk(sk)->port = port_ptr;
 	msm_ipc_sk(sk)->default_node_vote_info = NULL;
+	INIT_LIST_HEAD(&msm_ipc_sk(sk)->rx_batch);
 
 	return 0;
 }
@@ -378,11 +387,31 @@ out_sendmsg:
 	return ret;
 }
 
+/**
+ * msm_ipc_router_curr_pkt_size() - Size of the next message to be received
+ * @sk: Socket to be checked. Called with the socket lock held.
+ *
+ * @return: Size of the message at the head of the socket's rx batch or, if
+ *	    the batch is empty, of the port's rx queue. 0 if none is pending.
+ */
+static int msm_ipc_router_curr_pkt_size(struct sock *sk)
+{
+	struct list_head *rx_batch = &msm_ipc_sk(sk)->rx_batch;
+	struct rr_packet *pkt;
+
+	if (list_empty(rx_batch))
+		return msm_ipc_router_get_curr_pkt_size(msm_ipc_sk_port(sk));
+
+	pkt = list_first_entry(rx_batch, struct rr_packet, list);
+	return pkt->hdr.size;
+}
+
 static int msm_ipc_router_recvmsg(struct kiocb *iocb, struct socket *sock,
 				  struct msghdr *m, size_t buf_len, int flags)
 {
 	struct sock *sk = sock->sk;
 	struct msm_ipc_port *port_ptr = msm_ipc_sk_port(sk);
+	struct list_head *rx_batch = &msm_ipc_sk(sk)->rx_batch;
 	struct rr_packet *pkt;
 	long timeout;
 	int ret;
@@ -392,27 +421,39 @@ static int msm_ipc_router_recvmsg(struct kiocb *iocb, struct socket *sock,
 	lock_sock(sk);
 	if (!buf_len) {
 		if (flags & MSG_PEEK)
-			ret = msm_ipc_router_get_curr_pkt_size(port_ptr);
+			ret = msm_ipc_router_curr_pkt_size(sk);
 		else
 			ret = -EINVAL;
 		release_sock(sk);
 		return ret;
 	}
-	timeout = sock_rcvtimeo(sk, flags & MSG_DONTWAIT);
 
-	ret = msm_ipc_router_rx_data_wait(port_ptr, timeout);
-	if (ret) {
-		release_sock(sk);
-		if (ret == -ENOMSG)
-			m->msg_namelen = 0;
-		return ret;
+	if (list_empty(rx_batch)) {
+		timeout = sock_rcvtimeo(sk, flags & MSG_DONTWAIT);
+
+		ret = msm_ipc_router_rx_data_wait(port_ptr, timeout);
+		if (ret) {
+			release_sock(sk);
+			if (ret == -ENOMSG)
+				m->msg_namelen = 0;
+			return ret;
+		}
+
+		ret = msm_ipc_router_read_batch(port_ptr, rx_batch,
+						IPC_ROUTER_RX_BATCH);
+		if (ret <= 0) {
+			release_sock(sk);
+			return ret;
+		}
 	}
 
-	ret = msm_ipc_router_read(port_ptr, &pkt, buf_len);
-	if (ret <= 0 || !pkt) {
+	pkt = list_first_entry(rx_batch, struct rr_packet, list);
+	if (pkt->hdr.size > buf_len) {
 		release_sock(sk);
-		return ret;
+		return -ETOOSMALL;
 	}
+	list_del(&pkt->list);
+	msm_ipc_router_read_done(pkt);
 
 	ret = msm_ipc_router_extract_msg(m, pkt);
 	release_pkt(pkt);
@@ -453,7 +494,7 @@ static int msm_ipc_router_ioctl(struct socket *sock,
 		break;
 
 	case IPC_ROUTER_IOCTL_GET_CURR_PKT_SIZE:
-		ret = msm_ipc_router_get_curr_pkt_size(port_ptr);
+		ret = msm_ipc_router_curr_pkt_size(sk);
 		break;
 
 	case IPC_ROUTER_IOCTL_LOOKUP_SERVER:
@@ -549,7 +590,8 @@ static unsigned int msm_ipc_router_poll(struct file *file,
 
 	poll_wait(file, &port_ptr->port_rx_wait_q, wait);
 
-	if (!list_empty(&port_ptr->port_rx_q))
+	if (!list_empty(&port_ptr->port_rx_q) ||
+	    !list_empty(&msm_ipc_sk(sk)->rx_batch))
 		mask |= (POLLRDNORM | POLLIN);
 
 	if (port_ptr->conn_status == CONNECTION_RESET)
@@ -562,6 +604,7 @@ static int msm_ipc_router_close(struct socket *sock)
 {
 	struct sock *sk = sock->sk;
 	struct msm_ipc_port *port_ptr;
+	struct rr_packet *pkt, *tmp_pkt;
 	int ret;
 
 	if (!sk)
@@ -573,6 +616,11 @@ static int msm_ipc_router_close(struct socket *sock)
 		release_sock(sk);
 		return -EINVAL;
 	}
+	list_for_each_entry_safe(pkt, tmp_pkt, &msm_ipc_sk(sk)->rx_batch,
+				 list) {
+		list_del(&pkt->list);
+		release_pkt(pkt);
+	}
 	ret = msm_ipc_router_close_port(port_ptr);
 	msm_ipc_unload_default_node(msm_ipc_sk(sk)->default_node_vote_info);
 	release_sock(sk);
@@ -15,11 +15,13 @@
 #define DEBUG
 
 #include <linux/file.h>
+#include <linux/hashtable.h>
 #include <linux/inetdevice.h>
 #include <linux/module.h>
 #include <linux/netfilter/x_tables.h>
 #include <linux/netfilter/xt_qtaguid.h>
 #include <linux/ratelimit.h>
+#include <linux/rculist.h>
 #include <linux/seq_file.h>
 #include <linux/skbuff.h>
 #include <linux/workqueue.h>
@@ -124,10 +126,22 @@ static const char *iface_stat_fmt_procfilename = "iface_stat_fmt";
 static struct proc_dir_entry *iface_stat_fmt_procfile;
 
 
+/*
+ * iface_stat entries are never freed, so the packet path walks the list
+ * under rcu_read_lock() only. Additions need iface_stat_list_lock.
+ */
 static LIST_HEAD(iface_stat_list);
 static DEFINE_SPINLOCK(iface_stat_list_lock);
 
+/*
+ * Every sock_tag in sock_tag_tree is also hashed by sk in sock_tag_hash,
+ * which the packet path searches under rcu_read_lock() instead of taking
+ * sock_tag_list_lock. Both are updated under sock_tag_list_lock, and
+ * sock_tags are freed after a grace period.
+ */
+#define SOCK_TAG_HASH_BITS 8
 static struct rb_root sock_tag_tree = RB_ROOT;
+static DEFINE_HASHTABLE(sock_tag_hash, SOCK_TAG_HASH_BITS);
 static DEFINE_SPINLOCK(sock_tag_list_lock);
 
 static struct rb_root tag_counter_set_tree = RB_ROOT;
@@ -321,10 +335,25 @@ static void sock_tag_tree_erase(struct rb_root *st_to_free_tree)
 			 get_uid_from_tag(st_entry->tag));
 		rb_erase(&st_entry->sock_node, st_to_free_tree);
 		sock_put(st_entry->sk);
-		kfree(st_entry);
+		kfree_rcu(st_entry, rcu);
 	}
 }
 
+/* Caller must hold sock_tag_list_lock */
+static void sock_tag_link(struct sock_tag *st_entry)
+{
+	sock_tag_tree_insert(st_entry, &sock_tag_tree);
+	hash_add_rcu(sock_tag_hash, &st_entry->hash_node,
+		     (unsigned long)st_entry->sk);
+}
+
+/* Caller must hold sock_tag_list_lock */
+static void sock_tag_unlink(struct sock_tag *st_entry)
+{
+	rb_erase(&st_entry->sock_node, &sock_tag_tree);
+	hash_del_rcu(&st_entry->hash_node);
+}
+
 static struct proc_qtu_data *proc_qtu_data_tree_search(struct rb_root *root,
 						       const pid_t pid)
 {
@@ -634,7 +663,7 @@ static int get_active_counter_set(tag_t tag)
 
 /*
  * Find the entry for tracking the specified interface.
- * Caller must hold iface_stat_list_lock
+ * Caller must hold iface_stat_list_lock or rcu_read_lock()
  */
 static struct iface_stat *get_iface_entry(const char *ifname)
 {
@@ -647,7 +676,7 @@ static struct iface_stat *get_iface_entry(const char *ifname)
 	}
 
 	/* Iterate over interfaces */
-	list_for_each_entry(iface_entry, &iface_stat_list, list) {
+	list_for_each_entry_rcu(iface_entry, &iface_stat_list, list) {
 		if (!strcmp(ifname, iface_entry->ifname))
 			goto done;
 	}
@@ -672,12 +701,44 @@ static void pp_iface_stat_header(struct seq_file *m)
 	);
 }
 
+/* Fold the per cpu totals_via_skb of an interface into @sum */
+void iface_stat_sum_skb(struct iface_stat *iface_entry,
+			struct data_counters *sum)
+{
+	struct iface_stat_cpu_counters *pcpu;
+	struct data_counters snap;
+	struct byte_packet_counters *bpc;
+	unsigned int start;
+	int cpu, set, dir, proto;
+
+	memset(sum, 0, sizeof(*sum));
+	for_each_possible_cpu(cpu) {
+		pcpu = per_cpu_ptr(iface_entry->totals_via_skb, cpu);
+		do {
+			start = u64_stats_fetch_begin_irq(&pcpu->syncp);
+			snap = pcpu->counters;
+		} while (u64_stats_fetch_retry_irq(&pcpu->syncp, start));
+
+		for (set = 0; set < IFS_MAX_COUNTER_SETS; set++)
+			for (dir = 0; dir < IFS_MAX_DIRECTIONS; dir++)
+				for (proto = 0; proto < IFS_MAX_PROTOS; proto++) {
+					bpc = &snap.bpc[set][dir][proto];
+					sum->bpc[set][dir][proto].bytes +=
+						bpc->bytes;
+					sum->bpc[set][dir][proto].packets +=
+						bpc->packets;
+				}
+	}
+}
+
 static void pp_iface_stat_line(struct seq_file *m,
 			       struct iface_stat *iface_entry)
 {
-	struct data_counters *cnts;
+	struct data_counters skb_counters;
+	struct data_counters *cnts = &skb_counters;
 	int cnt_set = 0;   /* We only use one set for the device */
-	cnts = &iface_entry->totals_via_skb;
+
+	iface_stat_sum_skb(iface_entry, &skb_counters);
 	seq_printf(m, "%s %llu %llu %llu %llu %llu %llu %llu %llu "
 		   "%llu %llu %llu %llu %llu %llu %llu %llu\n",
 		   iface_entry->ifname,
@@ -851,6 +912,7 @@ static struct iface_stat *iface_alloc(struct net_device *net_dev)
 {
 	struct iface_stat *new_iface;
 	struct iface_stat_work *isw;
+	int cpu;
 
 	new_iface = kzalloc(sizeof(*new_iface), GFP_ATOMIC);
 	if (new_iface == NULL) {
@@ -865,6 +927,18 @@ static struct iface_stat *iface_alloc(struct net_device *net_dev)
 		kfree(new_iface);
 		return NULL;
 	}
+	new_iface->totals_via_skb =
+		alloc_percpu_gfp(struct iface_stat_cpu_counters, GFP_ATOMIC);
+	if (new_iface->totals_via_skb == NULL) {
+		pr_err("qtaguid: iface_stat: create(%s): "
+		       "counters alloc failed\n", net_dev->name);
+		kfree(new_iface->ifname);
+		kfree(new_iface);
+		return NULL;
+	}
+	for_each_possible_cpu(cpu)
+		u64_stats_init(&per_cpu_ptr(new_iface->totals_via_skb,
+					    cpu)->syncp);
 	spin_lock_init(&new_iface->tag_stat_list_lock);
 	new_iface->tag_stat_tree = RB_ROOT;
 	_iface_stat_set_active(new_iface, net_dev, true);
@@ -878,6 +952,7 @@ static struct iface_stat *iface_alloc(struct net_device *net_dev)
 		pr_err("qtaguid: iface_stat: create(%s): "
 		       "work alloc failed\n", new_iface->ifname);
 		_iface_stat_set_active(new_iface, net_dev, false);
+		free_percpu(new_iface->totals_via_skb);
 		kfree(new_iface->ifname);
 		kfree(new_iface);
 		return NULL;
@@ -885,7 +960,7 @@ static struct iface_stat *iface_alloc(struct net_device *net_dev)
 	isw->iface_entry = new_iface;
 	INIT_WORK(&isw->iface_work, iface_create_proc_worker);
 	schedule_work(&isw->iface_work);
-	list_add(&new_iface->list, &iface_stat_list);
+	list_add_rcu(&new_iface->list, &iface_stat_list);
 	return new_iface;
 }
 
@@ -1066,6 +1141,22 @@ static struct sock_tag *get_sock_stat_nl(const struct sock *sk)
 	return sock_tag_tree_search(&sock_tag_tree, sk);
 }
 
+/*
+ * Lockless variant of get_sock_stat_nl() for the packet path.
+ * Caller must hold rcu_read_lock().
+ */
+static struct sock_tag *get_sock_stat_rcu(const struct sock *sk)
+{
+	struct sock_tag *sock_tag_entry;
+
+	hash_for_each_possible_rcu(sock_tag_hash, sock_tag_entry, hash_node,
+				   (unsigned long)sk) {
+		if (sock_tag_entry->sk == sk)
+			return sock_tag_entry;
+	}
+	return NULL;
+}
+
 static int ipx_proto(const struct sk_buff *skb,
 		     struct xt_action_param *par)
 {
@@ -1197,6 +1288,7 @@ static void iface_stat_update_from_skb(const struct sk_buff *skb,
 				       struct xt_action_param *par)
 {
 	struct iface_stat *entry;
+	struct iface_stat_cpu_counters *pcpu;
 	const struct net_device *el_dev;
 	enum ifs_tx_rx direction;
 	int bytes = skb->len;
@@ -1209,21 +1301,25 @@ static void iface_stat_update_from_skb(const struct sk_buff *skb,
 		 par->hooknum, __func__, el_dev->name, el_dev->type,
 		 par->family, proto, direction);
 
-	spin_lock_bh(&iface_stat_list_lock);
+	rcu_read_lock();
 	entry = get_iface_entry(el_dev->name);
 	if (entry == NULL) {
 		IF_DEBUG("qtaguid[%d]: iface_stat: %s(%s): not tracked\n",
 			 par->hooknum, __func__, el_dev->name);
-		spin_unlock_bh(&iface_stat_list_lock);
+		rcu_read_unlock();
 		return;
 	}
 
 	IF_DEBUG("qtaguid[%d]: %s(%s): entry=%p\n", par->hooknum,  __func__,
 		 el_dev->name, entry);
 
-	data_counters_update(&entry->totals_via_skb, 0, direction, proto,
-			     bytes);
-	spin_unlock_bh(&iface_stat_list_lock);
+	local_bh_disable();
+	pcpu = this_cpu_ptr(entry->totals_via_skb);
+	u64_stats_update_begin(&pcpu->syncp);
+	data_counters_update(&pcpu->counters, 0, direction, proto, bytes);
+	u64_stats_update_end(&pcpu->syncp);
+	local_bh_enable();
+	rcu_read_unlock();
 }
 
 static void tag_stat_update(struct tag_stat *tag_entry,
@@ -1280,12 +1376,12 @@ static void if_tag_stat_update(const char *ifname, uid_t uid,
 		"uid=%u sk=%p dir=%d proto=%d bytes=%d)\n",
 		 ifname, uid, sk, direction, proto, bytes);
 
-	spin_lock_bh(&iface_stat_list_lock);
+	rcu_read_lock();
 	iface_entry = get_iface_entry(ifname);
 	if (!iface_entry) {
 		pr_err_ratelimited("qtaguid: tag_stat: stat_update() "
 				   "%s not found\n", ifname);
-		spin_unlock_bh(&iface_stat_list_lock);
+		rcu_read_unlock();
 		return;
 	}
 	/* It is ok to process data when an iface_entry is inactive */
@@ -1297,14 +1393,12 @@ static void if_tag_stat_update(const char *ifname, uid_t uid,
 	 * Look for a tagged sock.
 	 * It will have an acct_uid.
 	 */
-	spin_lock_bh(&sock_tag_list_lock);
-	sock_tag_entry = sk ? get_sock_stat_nl(sk) : NULL;
+	sock_tag_entry = sk ? get_sock_stat_rcu(sk) : NULL;
 	if (sock_tag_entry) {
 		tag = sock_tag_entry->tag;
 		acct_tag = get_atag_from_tag(tag);
 		uid_tag = get_utag_from_tag(tag);
 	}
-	spin_unlock_bh(&sock_tag_list_lock);
 	if (!sock_tag_entry) {
 		acct_tag = make_atag_from_value(0);
 		tag = combine_atag_with_uid(acct_tag, uid);
@@ -1364,7 +1458,7 @@ static void if_tag_stat_update(const char *ifname, uid_t uid,
 	tag_stat_update(new_tag_stat, direction, proto, bytes);
 unlock:
 	spin_unlock_bh(&iface_entry->tag_stat_list_lock);
-	spin_unlock_bh(&iface_stat_list_lock);
+	rcu_read_unlock();
 }
 
 static int iface_netdev_event_handler(struct notifier_block *nb,
@@ -2017,7 +2111,7 @@ static int ctrl_cmd_delete(const char *input)
 			 input, st_entry->tag, entry_uid);
 
 		if (!acct_tag || st_entry->tag == tag) {
-			rb_erase(&st_entry->sock_node, &sock_tag_tree);
+			sock_tag_unlink(st_entry);
 			/* Can't sockfd_put() within spinlock, do it later. */
 			sock_tag_tree_insert(st_entry, &st_to_free_tree);
 			tr_entry = lookup_tag_ref(st_entry->tag, NULL);
@@ -2256,17 +2350,48 @@ static int ctrl_cmd_tag(const char *input)
 	tag_ref_entry->num_sock_tags++;
 	if (sock_tag_entry) {
 		struct tag_ref *prev_tag_ref_entry;
+		struct sock_tag *new_sock_tag_entry;
 
 		CT_DEBUG("qtaguid: ctrl_tag(%s): retag for sk=%p "
 			 "st@%p ...->sk_refcnt=%d\n",
 			 input, el_socket->sk, sock_tag_entry,
 			 atomic_read(&el_socket->sk->sk_refcnt));
+		/*
+		 * The packet path reads the tag without sock_tag_list_lock,
+		 * so swap in a retagged copy instead of rewriting it in place.
+		 */
+		new_sock_tag_entry = kmemdup(sock_tag_entry,
+					     sizeof(*sock_tag_entry),
+					     GFP_ATOMIC);
+		if (!new_sock_tag_entry) {
+			pr_err("qtaguid: ctrl_tag(%s): "
+			       "socket tag alloc failed\n",
+			       input);
+			BUG_ON(tag_ref_entry->num_sock_tags <= 0);
+			tag_ref_entry->num_sock_tags--;
+			free_tag_ref_from_utd_entry(tag_ref_entry,
+						    uid_tag_data_entry);
+			spin_unlock_bh(&uid_tag_data_tree_lock);
+			spin_unlock_bh(&sock_tag_list_lock);
+			res = -ENOMEM;
+			goto err_put;
+		}
 		prev_tag_ref_entry = lookup_tag_ref(sock_tag_entry->tag,
 						    &uid_tag_data_entry);
 		BUG_ON(IS_ERR_OR_NULL(prev_tag_ref_entry));
 		BUG_ON(prev_tag_ref_entry->num_sock_tags <= 0);
 		prev_tag_ref_entry->num_sock_tags--;
-		sock_tag_entry->tag = full_tag;
+		new_sock_tag_entry->tag = full_tag;
+		rb_replace_node(&sock_tag_entry->sock_node,
+				&new_sock_tag_entry->sock_node,
+				&sock_tag_tree);
+		hlist_replace_rcu(&sock_tag_entry->hash_node,
+				  &new_sock_tag_entry->hash_node);
+		if (sock_tag_entry->list.next)
+			list_replace(&sock_tag_entry->list,
+				     &new_sock_tag_entry->list);
+		kfree_rcu(sock_tag_entry, rcu);
+		sock_tag_entry = new_sock_tag_entry;
 	} else {
 		CT_DEBUG("qtaguid: ctrl_tag(%s): newtag for sk=%p\n",
 			 input, el_socket->sk);
@@ -2311,7 +2436,7 @@ static int ctrl_cmd_tag(const char *input)
 			list_add(&sock_tag_entry->list,
 				 &pqd_entry->sock_tag_list);
 
-		sock_tag_tree_insert(sock_tag_entry, &sock_tag_tree);
+		sock_tag_link(sock_tag_entry);
 		atomic64_inc(&qtu_events.sockets_tagged);
 	}
 	spin_unlock_bh(&uid_tag_data_tree_lock);
@@ -2385,7 +2510,7 @@ int qtaguid_untag(struct socket *el_socket, bool kernel)
 	 * The socket already belongs to the current process
 	 * so it can do whatever it wants to it.
 	 */
-	rb_erase(&sock_tag_entry->sock_node, &sock_tag_tree);
+	sock_tag_unlink(sock_tag_entry);
 
 	tag_ref_entry = lookup_tag_ref(sock_tag_entry->tag, &utd_entry);
 	BUG_ON(!tag_ref_entry);
@@ -2431,7 +2556,7 @@ int qtaguid_untag(struct socket *el_socket, bool kernel)
 		 sock_tag_entry,
 		 atomic_read(&el_socket->sk->sk_refcnt));
 
-	kfree(sock_tag_entry);
+	kfree_rcu(sock_tag_entry, rcu);
 	atomic64_inc(&qtu_events.sockets_untagged);
 
 	return 0;
@@ -2838,7 +2963,7 @@ static int qtudev_release(struct inode *inode, struct file *file)
 		tr->num_sock_tags--;
 		free_tag_ref_from_utd_entry(tr, utd_entry);
 
-		rb_erase(&st_entry->sock_node, &sock_tag_tree);
+		sock_tag_unlink(st_entry);
 		list_del(&st_entry->list);
 		/* Can't sockfd_put() within spinlock, do it later. */
 		sock_tag_tree_insert(st_entry, &st_to_free_tree);
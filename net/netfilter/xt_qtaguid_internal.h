@@ -13,6 +13,7 @@
 #include <linux/types.h>
 #include <linux/rbtree.h>
 #include <linux/spinlock_types.h>
+#include <linux/u64_stats_sync.h>
 #include <linux/workqueue.h>
 
 /* Iface handling */
@@ -198,6 +199,12 @@ static inline uint64_t dc_sum_packets(struct data_counters *counters,
 }
 
 
+/* One cpu's share of iface_stat.totals_via_skb */
+struct iface_stat_cpu_counters {
+	struct data_counters counters;
+	struct u64_stats_sync syncp;
+};
+
 /* Generic X based nodes used as a base for rb_tree ops */
 struct tag_node {
 	struct rb_node node;
@@ -222,7 +229,8 @@ struct iface_stat {
 	struct net_device *net_dev;
 
 	struct byte_packet_counters totals_via_dev[IFS_MAX_DIRECTIONS];
-	struct data_counters totals_via_skb;
+	/* Updated per cpu from the packet path, see iface_stat_sum_skb() */
+	struct iface_stat_cpu_counters __percpu *totals_via_skb;
 	/*
 	 * We keep the last_known, because some devices reset their counters
 	 * just before NETDEV_UP, while some will reset just before
@@ -255,6 +263,9 @@ struct iface_stat_work {
  */
 struct sock_tag {
 	struct rb_node sock_node;
+	/* in sock_tag_hash, for lockless lookups from the packet path */
+	struct hlist_node hash_node;
+	struct rcu_head rcu;
 	struct sock *sk;  /* Only used as a number, never dereferenced */
 	/* Used to associate with a given pid */
 	struct list_head list;   /* in proc_qtu_data.sock_tag_list */
@@ -347,4 +358,7 @@ struct proc_qtu_data {
 };
 
 /*----------------------------------------------*/
+void iface_stat_sum_skb(struct iface_stat *iface_entry,
+			struct data_counters *sum);
+
 #endif  /* ifndef __XT_QTAGUID_INTERNAL_H__ */
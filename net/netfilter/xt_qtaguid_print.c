@@ -180,7 +180,10 @@ char *pp_iface_stat(struct iface_stat *is)
 	if (!is) {
 		res = kasprintf(GFP_ATOMIC, "iface_stat@null{}");
 	} else {
-		struct data_counters *cnts = &is->totals_via_skb;
+		struct data_counters skb_counters;
+		struct data_counters *cnts = &skb_counters;
+
+		iface_stat_sum_skb(is, &skb_counters);
 		res = kasprintf(GFP_ATOMIC, "iface_stat@%p{"
 				"list=list_head{...}, "
 				"ifname=%s, "
@@ -711,6 +711,7 @@ int rmnet_unassociate_network_device(struct net_device *dev)
 	if (!config)
 		return RMNET_CONFIG_UNKNOWN_ERROR;
 
+	tasklet_kill(&config->agg_tx_done);
 	kfree(config);
 
 	netdev_rx_handler_unregister(dev);
@@ -838,6 +839,8 @@ int rmnet_associate_network_device(struct net_device *dev)
 	memset(config, 0, sizeof(struct rmnet_phys_ep_conf_s));
 	config->dev = dev;
 	spin_lock_init(&config->agg_lock);
+	tasklet_init(&config->agg_tx_done, rmnet_map_agg_tx_done,
+		     (unsigned long)config);
 
 	rc = netdev_rx_handler_register(dev, rmnet_rx_handler, config);
 
@@ -1246,6 +1249,7 @@ int rmnet_config_notify_cb(struct notifier_block *nb,
 		trace_rmnet_unregister_cb_entry(dev);
 		LOGH("Kernel is trying to unregister %s", dev->name);
 		rmnet_force_unassociate_device(dev);
+		rmnet_steer_flush_dev(dev);
 		trace_rmnet_unregister_cb_exit(dev);
 		break;
 
@@ -17,6 +17,8 @@
 #include <linux/types.h>
 #include <linux/time.h>
 #include <linux/spinlock.h>
+#include <linux/interrupt.h>
+#include <linux/atomic.h>
 
 #ifndef _RMNET_DATA_CONFIG_H_
 #define _RMNET_DATA_CONFIG_H_
@@ -83,6 +85,9 @@ struct rmnet_phys_ep_conf_s {
 	uint8_t agg_count;
 	struct timespec agg_time;
 	struct timespec agg_last;
+	/* Aggregates handed to the transport and not yet freed by it */
+	atomic_t agg_inflight;
+	struct tasklet_struct agg_tx_done;
 };
 
 int rmnet_config_init(void);
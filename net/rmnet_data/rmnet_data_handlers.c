@@ -22,6 +22,8 @@
 #include <linux/netdev_features.h>
 #include <linux/ip.h>
 #include <linux/ipv6.h>
+#include <linux/smp.h>
+#include <linux/topology.h>
 #include "rmnet_data_private.h"
 #include "rmnet_data_config.h"
 #include "rmnet_data_vnd.h"
@@ -50,6 +52,10 @@ long gro_flush_time __read_mostly = 10000L;
 module_param(gro_flush_time, long, S_IRUGO | S_IWUSR);
 MODULE_PARM_DESC(gro_flush_time, "Flush GRO when spaced more than this");
 
+unsigned int rmnet_steer_flows __read_mostly;
+module_param(rmnet_steer_flows, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(rmnet_steer_flows, "Spread ingress flows over the cluster");
+
 #define RMNET_DATA_IP_VERSION_4 0x40
 #define RMNET_DATA_IP_VERSION_6 0x60
 
@@ -123,7 +129,7 @@ void rmnet_print_packet(const struct sk_buff *skb, const char *dev, char dir)
 	       dev, dir, skb_tail_pointer(skb), skb_end_pointer(skb));
 
 	if (skb->len > 0)
-		len = skb->len;
+		len = skb_headlen(skb);
 	else
 		len = ((unsigned int)(uintptr_t)skb->end) -
 		      ((unsigned int)(uintptr_t)skb->data);
@@ -251,6 +257,201 @@ static void rmnet_optional_gro_flush(struct napi_struct *napi,
 	}
 }
 
+/* ***************** Flow Steering ****************************************** */
+
+/**
+ * struct rmnet_steer_queue - per-CPU queue of steered ingress packets
+ * @list:       packets waiting to be delivered on this CPU
+ * @napi:       drains @list, and runs GRO on this CPU
+ * @csd:        IPI used to schedule @napi from the CPU doing deaggregation
+ */
+struct rmnet_steer_queue {
+	struct sk_buff_head list;
+	struct napi_struct napi;
+	struct call_single_data csd;
+};
+
+static DEFINE_PER_CPU(struct rmnet_steer_queue, rmnet_steer_queues);
+static struct net_device rmnet_steer_dev;
+
+#define RMNET_STEER_NAPI_WEIGHT 64
+
+/**
+ * rmnet_steer_cpu() - Pick the CPU a flow is delivered on
+ * @skb:        Packet being delivered
+ *
+ * Flows are hashed over the online CPUs of the cluster doing the
+ * deaggregation, so they spread over the cores sharing its cache without
+ * bouncing to the other cluster.
+ *
+ * Return:
+ *      - CPU to deliver on, which may be the current one
+ */
+static int rmnet_steer_cpu(struct sk_buff *skb)
+{
+	int this_cpu = smp_processor_id();
+	const struct cpumask *cluster = topology_core_cpumask(this_cpu);
+	unsigned int nr = 0, n;
+	u32 hash;
+	int cpu;
+
+	for_each_cpu_and(cpu, cluster, cpu_online_mask)
+		nr++;
+
+	if (nr <= 1)
+		return this_cpu;
+
+	hash = skb_get_hash(skb);
+	if (!hash)
+		return this_cpu;
+
+	n = reciprocal_scale(hash, nr);
+	for_each_cpu_and(cpu, cluster, cpu_online_mask)
+		if (!n--)
+			return cpu;
+
+	return this_cpu;
+}
+
+static void rmnet_steer_kick(void *data)
+{
+	struct rmnet_steer_queue *q = data;
+
+	napi_schedule(&q->napi);
+}
+
+/**
+ * rmnet_steer_skb() - Hand a packet to another CPU of the cluster
+ * @skb:        Packet being delivered
+ *
+ * Return:
+ *      - 1 if the packet was queued on another CPU
+ *      - 0 if the caller should deliver it here
+ */
+static int rmnet_steer_skb(struct sk_buff *skb)
+{
+	struct rmnet_steer_queue *q;
+	unsigned long flags;
+	int cpu, kick;
+
+	if (!rmnet_steer_flows)
+		return 0;
+
+	cpu = rmnet_steer_cpu(skb);
+	if (cpu == smp_processor_id())
+		return 0;
+
+	q = &per_cpu(rmnet_steer_queues, cpu);
+	spin_lock_irqsave(&q->list.lock, flags);
+	kick = skb_queue_empty(&q->list);
+	__skb_queue_tail(&q->list, skb);
+	spin_unlock_irqrestore(&q->list.lock, flags);
+
+	/* An IPI only on the empty to non-empty transition */
+	if (kick && smp_call_function_single_async(cpu, &q->csd))
+		napi_schedule(&q->napi);
+
+	return 1;
+}
+
+static int rmnet_steer_poll(struct napi_struct *napi, int budget)
+{
+	struct rmnet_steer_queue *q;
+	struct sk_buff *skb;
+	int work = 0;
+
+	q = container_of(napi, struct rmnet_steer_queue, napi);
+
+	while (work < budget) {
+		spin_lock_irq(&q->list.lock);
+		skb = __skb_dequeue(&q->list);
+		spin_unlock_irq(&q->list.lock);
+
+		if (!skb) {
+			napi_gro_flush(napi, false);
+
+			/*
+			 * Complete under the queue lock: a producer seeing an
+			 * empty queue after this point sends a fresh kick.
+			 */
+			spin_lock_irq(&q->list.lock);
+			if (skb_queue_empty(&q->list)) {
+				__napi_complete(napi);
+				spin_unlock_irq(&q->list.lock);
+				break;
+			}
+			spin_unlock_irq(&q->list.lock);
+			continue;
+		}
+
+		if (rmnet_check_skb_can_gro(skb) &&
+		    (skb->dev->features & NETIF_F_GRO))
+			napi_gro_receive(napi, skb);
+		else
+			netif_receive_skb(skb);
+		work++;
+	}
+
+	return work;
+}
+
+/**
+ * rmnet_steer_flush_dev() - Drop steered packets of a departing device
+ * @dev:        Device being unregistered
+ */
+void rmnet_steer_flush_dev(struct net_device *dev)
+{
+	struct rmnet_steer_queue *q;
+	struct sk_buff *skb, *tmp;
+	unsigned long flags;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		q = &per_cpu(rmnet_steer_queues, cpu);
+		spin_lock_irqsave(&q->list.lock, flags);
+		skb_queue_walk_safe(&q->list, skb, tmp) {
+			if (skb->dev == dev) {
+				__skb_unlink(skb, &q->list);
+				kfree_skb(skb);
+			}
+		}
+		spin_unlock_irqrestore(&q->list.lock, flags);
+	}
+}
+
+void rmnet_steer_init(void)
+{
+	struct rmnet_steer_queue *q;
+	int cpu;
+
+	init_dummy_netdev(&rmnet_steer_dev);
+
+	for_each_possible_cpu(cpu) {
+		q = &per_cpu(rmnet_steer_queues, cpu);
+		skb_queue_head_init(&q->list);
+		q->csd.func = rmnet_steer_kick;
+		q->csd.info = q;
+		netif_napi_add(&rmnet_steer_dev, &q->napi, rmnet_steer_poll,
+			       RMNET_STEER_NAPI_WEIGHT);
+		napi_enable(&q->napi);
+	}
+}
+
+void rmnet_steer_exit(void)
+{
+	struct rmnet_steer_queue *q;
+	int cpu;
+
+	rmnet_steer_flows = 0;
+
+	for_each_possible_cpu(cpu) {
+		q = &per_cpu(rmnet_steer_queues, cpu);
+		napi_disable(&q->napi);
+		netif_napi_del(&q->napi);
+		skb_queue_purge(&q->list);
+	}
+}
+
 /**
  * __rmnet_deliver_skb() - Deliver skb
  *
@@ -285,6 +486,8 @@ static rx_handler_result_t __rmnet_deliver_skb(struct sk_buff *skb,
 		case RX_HANDLER_PASS:
 			skb->pkt_type = PACKET_HOST;
 			rmnet_reset_mac_header(skb);
+			if (rmnet_steer_skb(skb))
+				return RX_HANDLER_CONSUMED;
 			if (rmnet_check_skb_can_gro(skb) &&
 			    (skb->dev->features & NETIF_F_GRO)) {
 				napi = get_current_napi_context();
@@ -420,7 +623,10 @@ static rx_handler_result_t _rmnet_map_ingress_handler(struct sk_buff *skb,
 
 	/* Subtract MAP header */
 	skb_pull(skb, sizeof(struct rmnet_map_header_s));
-	skb_trim(skb, len);
+	if (pskb_trim(skb, len)) {
+		rmnet_kfree_skb(skb, RMNET_STATS_SKBFREE_DEAGG_MALFORMED);
+		return RX_HANDLER_CONSUMED;
+	}
 	__rmnet_data_set_skb_proto(skb);
 	return __rmnet_deliver_skb(skb, ep);
 }
@@ -545,6 +751,37 @@ static int rmnet_map_egress_handler(struct sk_buff *skb,
 
 	return RMNET_MAP_SUCCESS;
 }
+
+/**
+ * rmnet_egress_gso_segment() - Splits a GSO packet into MAP frames
+ * @skb:        GSO packet from the VND
+ * @ep:         logical endpoint configuration of the packet originator
+ *
+ * The segments go straight through MAP framing and aggregation, instead of
+ * each one going back through the qdisc and the VND transmit path.
+ */
+static void rmnet_egress_gso_segment(struct sk_buff *skb,
+				     struct rmnet_logical_ep_conf_s *ep)
+{
+	struct sk_buff *segs, *next;
+	netdev_features_t features;
+
+	features = skb->dev->features & ~NETIF_F_GSO_MASK;
+	segs = skb_gso_segment(skb, features);
+	if (IS_ERR_OR_NULL(segs)) {
+		rmnet_kfree_skb(skb, RMNET_STATS_SKBFREE_EGR_MAPFAIL);
+		return;
+	}
+	consume_skb(skb);
+
+	while (segs) {
+		next = segs->next;
+		segs->next = NULL;
+		rmnet_egress_handler(segs, ep);
+		segs = next;
+	}
+}
+
 /* ***************** Ingress / Egress Entry Points ************************** */
 
 /**
@@ -672,6 +909,12 @@ void rmnet_egress_handler(struct sk_buff *skb,
 	     skb->dev->name, config->egress_data_format);
 
 	if (config->egress_data_format & RMNET_EGRESS_FORMAT_MAP) {
+		if (skb_is_gso(skb)) {
+			skb->dev = orig_dev;
+			rmnet_egress_gso_segment(skb, ep);
+			return;
+		}
+
 		switch (rmnet_map_egress_handler(skb, config, ep, orig_dev)) {
 		case RMNET_MAP_CONSUMED:
 			LOGD("%s", "MAP process consumed packet");
@@ -50,6 +50,7 @@ enum rmnet_queue_xmit_e {
 	RMNET_STATS_QUEUE_XMIT_AGG_TIMEOUT,
 	RMNET_STATS_QUEUE_XMIT_AGG_CPY_EXP_FAIL,
 	RMNET_STATS_QUEUE_XMIT_AGG_SKIP,
+	RMNET_STATS_QUEUE_XMIT_AGG_TX_DONE,
 	RMNET_STATS_QUEUE_XMIT_MAX
 };
 
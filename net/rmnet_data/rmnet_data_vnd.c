@@ -615,6 +615,8 @@ int rmnet_vnd_create_dev(int id, struct net_device **new_device,
 		dev->hw_features |= NETIF_F_SG;
 		/* Configuring GSO on rmnet_data interfaces */
 		dev->hw_features |= NETIF_F_GSO;
+		/* TSO packets are segmented into MAP frames on egress */
+		dev->hw_features |= NETIF_F_TSO | NETIF_F_TSO6;
 		dev->hw_features |= NETIF_F_GSO_UDP_TUNNEL;
 		dev->hw_features |= NETIF_F_GSO_UDP_TUNNEL_CSUM;
 	}
@@ -57,6 +57,8 @@ struct agg_work {
 
 #define RMNET_MAP_DEAGGR_SPACING  64
 #define RMNET_MAP_DEAGGR_HEADROOM (RMNET_MAP_DEAGGR_SPACING/2)
+/* Bytes of each frame copied out on the page frag path: MAP + IP + L4 headers */
+#define RMNET_MAP_DEAGGR_COPYBREAK 128
 /******************************************************************************/
 
 /**
@@ -121,10 +123,12 @@ done:
  * @skb:        Source socket buffer containing multiple MAP frames
  * @config:     Physical endpoint configuration of the ingress device
  *
- * A whole new buffer is allocated for each portion of an aggregated frame.
- * Caller should keep calling deaggregate() on the source skb until 0 is
- * returned, indicating that there are no more packets to deaggregate. Caller
- * is responsible for freeing the original skb.
+ * When the aggregate lives in a page fragment, only the headers of each data
+ * frame are copied into the new skb and the rest is attached as a reference
+ * to the aggregate's page. Otherwise a whole new buffer is allocated for each
+ * portion of an aggregated frame. Caller should keep calling deaggregate() on
+ * the source skb until 0 is returned, indicating that there are no more
+ * packets to deaggregate. Caller is responsible for freeing the original skb.
  *
  * Return:
  *     - Pointer to new skb
@@ -135,7 +139,8 @@ struct sk_buff *rmnet_map_deaggregate(struct sk_buff *skb,
 {
 	struct sk_buff *skbn;
 	struct rmnet_map_header_s *maph;
-	uint32_t packet_len;
+	struct page *page;
+	uint32_t packet_len, copy_len, offset;
 
 	if (skb->len == 0)
 		return 0;
@@ -152,14 +157,28 @@ struct sk_buff *rmnet_map_deaggregate(struct sk_buff *skb,
 		return 0;
 	}
 
-	skbn = alloc_skb(packet_len + RMNET_MAP_DEAGGR_SPACING, GFP_ATOMIC);
+	if (skb->head_frag && !skb_is_nonlinear(skb) && !maph->cd_bit &&
+	    packet_len > RMNET_MAP_DEAGGR_COPYBREAK)
+		copy_len = RMNET_MAP_DEAGGR_COPYBREAK;
+	else
+		copy_len = packet_len;
+
+	skbn = alloc_skb(copy_len + RMNET_MAP_DEAGGR_SPACING, GFP_ATOMIC);
 	if (!skbn)
 		return 0;
 
 	skbn->dev = skb->dev;
 	skb_reserve(skbn, RMNET_MAP_DEAGGR_HEADROOM);
-	skb_put(skbn, packet_len);
-	memcpy(skbn->data, skb->data, packet_len);
+	skb_put(skbn, copy_len);
+	memcpy(skbn->data, skb->data, copy_len);
+
+	if (copy_len < packet_len) {
+		page = virt_to_head_page(skb->data);
+		offset = skb->data + copy_len - (unsigned char *)page_address(page);
+		get_page(page);
+		skb_add_rx_frag(skbn, 0, page, offset, packet_len - copy_len,
+				packet_len - copy_len);
+	}
 	skb_pull(skb, packet_len);
 
 
@@ -173,6 +192,69 @@ struct sk_buff *rmnet_map_deaggregate(struct sk_buff *skb,
 	return skbn;
 }
 
+/**
+ * rmnet_map_agg_destructor() - Transport is done with an aggregate
+ * @skb:        Aggregated frame being freed by the transport
+ *
+ * Once the last aggregate in flight completes, whatever has been aggregated
+ * meanwhile is sent right away instead of waiting for the flush work. The
+ * send is deferred to a tasklet since the transport may be holding its own
+ * TX lock while freeing the skb.
+ */
+static void rmnet_map_agg_destructor(struct sk_buff *skb)
+{
+	struct rmnet_phys_ep_conf_s *config;
+
+	rcu_read_lock();
+	config = (struct rmnet_phys_ep_conf_s *)
+		rcu_dereference(skb->dev->rx_handler_data);
+	if (config && atomic_add_unless(&config->agg_inflight, -1, 0) &&
+	    !atomic_read(&config->agg_inflight))
+		tasklet_schedule(&config->agg_tx_done);
+	rcu_read_unlock();
+}
+
+static int rmnet_map_send_agg(struct rmnet_phys_ep_conf_s *config,
+			      struct sk_buff *skb)
+{
+	skb->destructor = rmnet_map_agg_destructor;
+	atomic_inc(&config->agg_inflight);
+	return dev_queue_xmit(skb);
+}
+
+/**
+ * rmnet_map_agg_tx_done() - Flushes the aggregation buffer on TX completion
+ * @data:       struct rmnet_phys_ep_conf_s of the egress device
+ *
+ * The flush work stays scheduled; it finds the buffer already shipped out and
+ * just returns the state machine to idle.
+ */
+void rmnet_map_agg_tx_done(unsigned long data)
+{
+	struct rmnet_phys_ep_conf_s *config;
+	unsigned long flags;
+	struct sk_buff *skb = 0;
+	int rc, agg_count = 0;
+
+	config = (struct rmnet_phys_ep_conf_s *)data;
+	spin_lock_irqsave(&config->agg_lock, flags);
+	if (config->agg_skb && !atomic_read(&config->agg_inflight)) {
+		rmnet_stats_agg_pkts(config->agg_count);
+		skb = config->agg_skb;
+		agg_count = config->agg_count;
+		config->agg_skb = 0;
+		config->agg_count = 0;
+		memset(&(config->agg_time), 0, sizeof(struct timespec));
+	}
+	spin_unlock_irqrestore(&config->agg_lock, flags);
+
+	if (skb) {
+		trace_rmnet_map_flush_packet_queue(skb, agg_count);
+		rc = rmnet_map_send_agg(config, skb);
+		rmnet_stats_queue_xmit(rc, RMNET_STATS_QUEUE_XMIT_AGG_TX_DONE);
+	}
+}
+
 /**
  * rmnet_map_flush_packet_queue() - Transmits aggregeted frame on timeout
  * @work:        struct agg_work containing delayed work and skb to flush
@@ -217,7 +299,7 @@ static void rmnet_map_flush_packet_queue(struct work_struct *work)
 	spin_unlock_irqrestore(&config->agg_lock, flags);
 	if (skb) {
 		trace_rmnet_map_flush_packet_queue(skb, agg_count);
-		rc = dev_queue_xmit(skb);
+		rc = rmnet_map_send_agg(config, skb);
 		rmnet_stats_queue_xmit(rc, RMNET_STATS_QUEUE_XMIT_AGG_TIMEOUT);
 	}
 	kfree(work);
@@ -292,6 +374,23 @@ new_packet:
 		getnstimeofday(&(config->agg_time));
 		trace_rmnet_start_aggregation(skb);
 		rmnet_kfree_skb(skb, RMNET_STATS_SKBFREE_AGG_CPY_EXPAND);
+
+		/* Nothing in flight would complete and flush this buffer, so
+		 * send it now and aggregate behind it until it completes.
+		 */
+		if (!atomic_read(&config->agg_inflight)) {
+			rmnet_stats_agg_pkts(1);
+			agg_skb = config->agg_skb;
+			config->agg_skb = 0;
+			config->agg_count = 0;
+			memset(&(config->agg_time), 0, sizeof(struct timespec));
+			spin_unlock_irqrestore(&config->agg_lock, flags);
+			trace_rmnet_map_aggregate(agg_skb, 1);
+			rc = rmnet_map_send_agg(config, agg_skb);
+			rmnet_stats_queue_xmit(rc,
+					RMNET_STATS_QUEUE_XMIT_AGG_TX_DONE);
+			return;
+		}
 		goto schedule;
 	}
 	diff = timespec_sub(config->agg_last, config->agg_time);
@@ -309,14 +408,15 @@ new_packet:
 		LOGL("delta t: %ld.%09lu\tcount: %d", diff.tv_sec,
 		     diff.tv_nsec, agg_count);
 		trace_rmnet_map_aggregate(skb, agg_count);
-		rc = dev_queue_xmit(agg_skb);
+		rc = rmnet_map_send_agg(config, agg_skb);
 		rmnet_stats_queue_xmit(rc,
 					RMNET_STATS_QUEUE_XMIT_AGG_FILL_BUFFER);
 		goto new_packet;
 	}
 
 	dest_buff = skb_put(config->agg_skb, skb->len);
-	memcpy(dest_buff, skb->data, skb->len);
+	if (skb_copy_bits(skb, 0, dest_buff, skb->len))
+		BUG();
 	config->agg_count++;
 	rmnet_kfree_skb(skb, RMNET_STATS_SKBFREE_AGG_INTO_BUFF);
 
@@ -589,7 +689,7 @@ static int rmnet_map_validate_ipv6_packet_checksum(unsigned char *map_payload,
  */
 int rmnet_map_checksum_downlink_packet(struct sk_buff *skb)
 {
-	struct rmnet_map_dl_checksum_trailer_s *cksum_trailer;
+	struct rmnet_map_dl_checksum_trailer_s *cksum_trailer, trailer;
 	unsigned int data_len;
 	unsigned char *map_payload;
 	unsigned char ip_version;
@@ -600,9 +700,12 @@ int rmnet_map_checksum_downlink_packet(struct sk_buff *skb)
 	    sizeof(struct rmnet_map_dl_checksum_trailer_s))))
 		return RMNET_MAP_CHECKSUM_ERR_BAD_BUFFER;
 
-	cksum_trailer = (struct rmnet_map_dl_checksum_trailer_s *)
-			(skb->data + data_len
-			+ sizeof(struct rmnet_map_header_s));
+	/* The trailer may sit in a page frag of a deaggregated frame */
+	cksum_trailer = skb_header_pointer(skb,
+			data_len + sizeof(struct rmnet_map_header_s),
+			sizeof(trailer), &trailer);
+	if (unlikely(!cksum_trailer))
+		return RMNET_MAP_CHECKSUM_ERR_BAD_BUFFER;
 
 	if (unlikely(!ntohs(cksum_trailer->valid)))
 		return RMNET_MAP_CHECKSUM_VALID_FLAG_NOT_SET;
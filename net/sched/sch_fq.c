@@ -240,6 +240,11 @@ static struct fq_flow *fq_classify(struct sk_buff *skb, struct fq_sched_data *q)
 		 * collide with a local flow (socket pointers are word aligned)
 		 */
 		sk = (struct sock *)(skb_get_hash(skb) | 1L);
+	} else if (sk->sk_pacing_status != SK_PACING_FQ) {
+		/* Let TCP know this socket is paced here, so that it does
+		 * not arm its own pacing timer (see tcp_internal_pacing())
+		 */
+		smp_store_release(&sk->sk_pacing_status, SK_PACING_FQ);
 	}
 
 	root = &q->fq_root[hash_32((u32)(long)sk, q->fq_trees_log)];
@@ -66,9 +66,10 @@ enum pfk_kc_entry_state {
 	ACTIVE_ICE_PRELOAD,
 
 	/*
-	 * Entry is actively used by ICE engine and cannot be used by others.
+	 * Entry is actively used by ICE engine and cannot be evicted.
 	 * SCM call to load key to ICE was successfully executed and key is
-	 * now loaded.
+	 * now loaded. Further requests with the same key share the entry,
+	 * which stays in this state until the last of them has ended.
 	 */
 	ACTIVE_ICE_LOADED,
 
@@ -103,6 +104,9 @@ struct kc_entry {
 
 	 struct task_struct *thread_pending;
 
+	 /* number of requests currently using the loaded key */
+	 unsigned int ref_cnt;
+
 	 enum pfk_kc_entry_state state;
 	 int scm_error;
 };
@@ -371,6 +375,7 @@ static void kc_clear_entry(struct kc_entry *entry)
 
 	entry->time_stamp = 0;
 	entry->scm_error = 0;
+	entry->ref_cnt = 0;
 }
 
 /**
@@ -523,6 +528,7 @@ int pfk_kc_load_key_start(const unsigned char *key, size_t key_size,
 		if (entry_exists) {
 			kc_update_timestamp(entry);
 			entry->state = ACTIVE_ICE_LOADED;
+			entry->ref_cnt = 1;
 			break;
 		}
 	case (FREE):
@@ -533,6 +539,7 @@ int pfk_kc_load_key_start(const unsigned char *key, size_t key_size,
 			pr_err("%s: key load error (%d)\n", __func__, ret);
 		} else {
 			entry->state = ACTIVE_ICE_LOADED;
+			entry->ref_cnt = 1;
 			kc_update_timestamp(entry);
 		}
 		break;
@@ -542,6 +549,7 @@ int pfk_kc_load_key_start(const unsigned char *key, size_t key_size,
 		break;
 	case (ACTIVE_ICE_LOADED):
 		kc_update_timestamp(entry);
+		entry->ref_cnt++;
 		break;
 	case(SCM_ERROR):
 		ret = entry->scm_error;
@@ -596,6 +604,12 @@ void pfk_kc_load_key_end(const unsigned char *key, size_t key_size,
 		pr_err("internal error, there should an entry to unlock\n");
 		return;
 	}
+
+	/* the key stays resident while other requests still use it */
+	if (entry->ref_cnt && --entry->ref_cnt) {
+		kc_spin_unlock();
+		return;
+	}
 	entry->state = INACTIVE;
 
 	/* wake-up invalidation if it's waiting for the entry to be released */
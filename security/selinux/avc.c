@@ -34,9 +34,13 @@
 #include "avc_ss.h"
 #include "classmap.h"
 
-#define AVC_CACHE_SLOTS			512
-#define AVC_DEF_CACHE_THRESHOLD		512
+#define AVC_CACHE_SLOTS			(1 << CONFIG_SECURITY_SELINUX_AVC_HASH_BITS)
+#define AVC_DEF_CACHE_THRESHOLD		AVC_CACHE_SLOTS
 #define AVC_CACHE_RECLAIM		16
+#define AVC_CHAIN_HIST_MAX		8
+
+/* Per-CPU direct-mapped cache of recent decisions in front of avc_cache */
+#define AVC_PCPU_SLOTS			64
 
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 #define avc_cache_stats_incr(field)	this_cpu_inc(avc_cache_stats.field)
@@ -76,6 +80,18 @@ struct avc_cache {
 	u32			latest_notif;	/* latest revocation notification */
 };
 
+struct avc_pcpu_entry {
+	u32			ssid;
+	u32			tsid;
+	u16			tclass;
+	u32			gen;	/* avc_pcpu_gen when filled, 0 if empty */
+	struct av_decision	avd;
+};
+
+struct avc_pcpu_cache {
+	struct avc_pcpu_entry	slots[AVC_PCPU_SLOTS];
+};
+
 struct avc_callback_node {
 	int (*callback) (u32 event);
 	u32 events;
@@ -90,6 +106,12 @@ DEFINE_PER_CPU(struct avc_cache_stats, avc_cache_stats) = { 0 };
 #endif
 
 static struct avc_cache avc_cache;
+static DEFINE_PER_CPU(struct avc_pcpu_cache, avc_pcpu_cache);
+/*
+ * Bumped whenever a cached decision is replaced, updated or flushed,
+ * which invalidates every per-CPU entry at once.  Never zero.
+ */
+static atomic_t avc_pcpu_gen = ATOMIC_INIT(1);
 static struct avc_callback_node *avc_callbacks;
 static struct kmem_cache *avc_node_cachep;
 static struct kmem_cache *avc_xperms_data_cachep;
@@ -101,6 +123,73 @@ static inline int avc_hash(u32 ssid, u32 tsid, u16 tclass)
 	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (AVC_CACHE_SLOTS - 1);
 }
 
+static inline u32 avc_pcpu_gen_read(void)
+{
+	u32 gen = atomic_read(&avc_pcpu_gen);
+
+	/* pairs with the barrier implied by avc_pcpu_invalidate() */
+	smp_rmb();
+	return gen;
+}
+
+static inline void avc_pcpu_invalidate(void)
+{
+	if (unlikely(atomic_inc_return(&avc_pcpu_gen) == 0))
+		atomic_inc(&avc_pcpu_gen);
+}
+
+/**
+ * avc_pcpu_lookup - Look up a decision in this CPU's front cache.
+ * @ssid: source security identifier
+ * @tsid: target security identifier
+ * @tclass: target security class
+ * @avd: filled in on a hit
+ *
+ * Returns 1 on a hit, 0 otherwise.  Entries are only touched with
+ * interrupts off since checks may also come from softirq context.
+ */
+static inline int avc_pcpu_lookup(u32 ssid, u32 tsid, u16 tclass,
+				  struct av_decision *avd)
+{
+	struct avc_pcpu_entry *e;
+	unsigned long flags;
+	int hit = 0;
+
+	local_irq_save(flags);
+	e = this_cpu_ptr(&avc_pcpu_cache.slots[avc_hash(ssid, tsid, tclass) &
+					       (AVC_PCPU_SLOTS - 1)]);
+	if (e->gen == atomic_read(&avc_pcpu_gen) && e->ssid == ssid &&
+	    e->tsid == tsid && e->tclass == tclass) {
+		memcpy(avd, &e->avd, sizeof(*avd));
+		hit = 1;
+	}
+	local_irq_restore(flags);
+
+	return hit;
+}
+
+/*
+ * Record a decision taken from avc_cache.  @gen must have been sampled
+ * before the decision was looked up or computed, so that an update in
+ * between leaves the entry stale rather than wrong.
+ */
+static inline void avc_pcpu_fill(u32 ssid, u32 tsid, u16 tclass,
+				 struct av_decision *avd, u32 gen)
+{
+	struct avc_pcpu_entry *e;
+	unsigned long flags;
+
+	local_irq_save(flags);
+	e = this_cpu_ptr(&avc_pcpu_cache.slots[avc_hash(ssid, tsid, tclass) &
+					       (AVC_PCPU_SLOTS - 1)]);
+	e->ssid = ssid;
+	e->tsid = tsid;
+	e->tclass = tclass;
+	memcpy(&e->avd, avd, sizeof(*avd));
+	e->gen = gen;
+	local_irq_restore(flags);
+}
+
 /**
  * avc_dump_av - Display an access vector in human-readable form.
  * @tclass: target security class
@@ -202,7 +291,8 @@ void __init avc_init(void)
 
 int avc_get_hash_stats(char *page)
 {
-	int i, chain_len, max_chain_len, slots_used;
+	int i, chain_len, max_chain_len, slots_used, len;
+	int hist[AVC_CHAIN_HIST_MAX + 1] = { 0 };
 	struct avc_node *node;
 	struct hlist_head *head;
 
@@ -219,15 +309,21 @@ int avc_get_hash_stats(char *page)
 				chain_len++;
 			if (chain_len > max_chain_len)
 				max_chain_len = chain_len;
+			hist[min(chain_len, AVC_CHAIN_HIST_MAX)]++;
 		}
 	}
 
 	rcu_read_unlock();
 
-	return scnprintf(page, PAGE_SIZE, "entries: %d\nbuckets used: %d/%d\n"
-			 "longest chain: %d\n",
-			 atomic_read(&avc_cache.active_nodes),
-			 slots_used, AVC_CACHE_SLOTS, max_chain_len);
+	len = scnprintf(page, PAGE_SIZE, "entries: %d\nbuckets used: %d/%d\n"
+			"longest chain: %d\nchain lengths:",
+			atomic_read(&avc_cache.active_nodes),
+			slots_used, AVC_CACHE_SLOTS, max_chain_len);
+	for (i = 1; i <= AVC_CHAIN_HIST_MAX; i++)
+		len += scnprintf(page + len, PAGE_SIZE - len, " %d%s:%d", i,
+				 i == AVC_CHAIN_HIST_MAX ? "+" : "", hist[i]);
+	len += scnprintf(page + len, PAGE_SIZE - len, "\n");
+	return len;
 }
 
 /*
@@ -688,6 +784,7 @@ static struct avc_node *avc_insert(u32 ssid, u32 tsid, u16 tclass,
 			    pos->ae.tsid == tsid &&
 			    pos->ae.tclass == tclass) {
 				avc_node_replace(node, pos);
+				avc_pcpu_invalidate();
 				goto found;
 			}
 		}
@@ -901,6 +998,7 @@ static int avc_update_node(u32 event, u32 perms, u8 driver, u8 xperm, u32 ssid,
 		break;
 	}
 	avc_node_replace(node, orig);
+	avc_pcpu_invalidate();
 out_unlock:
 	spin_unlock_irqrestore(lock, flag);
 out:
@@ -933,6 +1031,7 @@ static void avc_flush(void)
 		rcu_read_unlock();
 		spin_unlock_irqrestore(lock, flag);
 	}
+	avc_pcpu_invalidate();
 }
 
 /**
@@ -1106,9 +1205,19 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 	struct avc_xperms_node xp_node;
 	int rc = 0;
 	u32 denied;
+	u32 gen;
 
 	BUG_ON(!requested);
 
+	/* denials go the slow way, a permissive grant updates the node */
+	if (likely(avc_pcpu_lookup(ssid, tsid, tclass, avd)) &&
+	    likely(!(requested & ~(avd->allowed)))) {
+		avc_cache_stats_incr(lookups);
+		avc_cache_stats_incr(pcpu_hits);
+		return 0;
+	}
+
+	gen = avc_pcpu_gen_read();
 	rcu_read_lock();
 
 	node = avc_lookup(ssid, tsid, tclass);
@@ -1116,6 +1225,8 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 		node = avc_compute_av(ssid, tsid, tclass, avd, &xp_node);
 	else
 		memcpy(avd, &node->ae.avd, sizeof(*avd));
+	if (node)
+		avc_pcpu_fill(ssid, tsid, tclass, avd, gen);
 
 	denied = requested & ~(avd->allowed);
 	if (unlikely(denied))
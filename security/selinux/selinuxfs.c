@@ -1425,14 +1425,14 @@ static int sel_avc_stats_seq_show(struct seq_file *seq, void *v)
 
 	if (v == SEQ_START_TOKEN)
 		seq_printf(seq, "lookups hits misses allocations reclaims "
-			   "frees\n");
+			   "frees pcpu_hits\n");
 	else {
 		unsigned int lookups = st->lookups;
 		unsigned int misses = st->misses;
 		unsigned int hits = lookups - misses;
-		seq_printf(seq, "%u %u %u %u %u %u\n", lookups,
+		seq_printf(seq, "%u %u %u %u %u %u %u\n", lookups,
 			   hits, misses, st->allocations,
-			   st->reclaims, st->frees);
+			   st->reclaims, st->frees, st->pcpu_hits);
 	}
 	return 0;
 }
@@ -180,6 +180,8 @@ struct msm_compr_audio {
 	uint32_t dsp_fragments;
 	uint32_t dsp_fragment_ratio;
 	uint32_t dsp_fragments_sent;
+	uint32_t wakeup_watermark; /* free bytes before waking the app */
+	bool app_woken; /* app woken, no write since */
 
 	spinlock_t lock;
 };
@@ -427,6 +429,23 @@ static int msm_compr_read_buffer(struct msm_compr_audio *prtd)
 	return 0;
 }
 
+/*
+ * Waking the application on every elapsed fragment keeps the CPU busy during
+ * long offload playback. Only wake it once the ring has drained down to the
+ * watermark, so each wakeup refills many fragments at once, or when the DSP
+ * is about to run out of data. Called with prtd->lock held.
+ */
+static bool msm_compr_playback_wakeup_due(struct msm_compr_audio *prtd)
+{
+	uint64_t queued = prtd->bytes_received - prtd->copied_total;
+
+	if (queued < prtd->dsp_fragment_size)
+		return true;
+	if (prtd->app_woken)
+		return false;
+	return prtd->buffer_size - queued >= prtd->wakeup_watermark;
+}
+
 static void compr_event_handler(uint32_t opcode,
 		uint32_t token, uint32_t *payload, void *priv)
 {
@@ -483,7 +502,10 @@ static void compr_event_handler(uint32_t opcode,
 
 		prtd->dsp_fragments_sent += token / prtd->dsp_fragment_size;
 		if (prtd->dsp_fragments_sent >= prtd->dsp_fragment_ratio) {
-			snd_compr_fragment_elapsed(cstream);
+			if (msm_compr_playback_wakeup_due(prtd)) {
+				snd_compr_fragment_elapsed(cstream);
+				prtd->app_woken = true;
+			}
 			prtd->dsp_fragments_sent = 0;
 		}
 
@@ -1258,6 +1280,9 @@ static int msm_compr_configure_dsp_for_playback
 	prtd->buffer       = ac->port[dir].buf[0].data;
 	prtd->buffer_paddr = ac->port[dir].buf[0].phys;
 	prtd->buffer_size  = runtime->fragments * runtime->fragment_size;
+	prtd->wakeup_watermark = max_t(uint32_t, runtime->fragment_size,
+				       prtd->buffer_size / 2);
+	prtd->app_woken = false;
 
 	ret = msm_compr_send_media_format_block(cstream, ac->stream_id, false);
 	if (ret < 0) {
@@ -2089,6 +2114,7 @@ static int msm_compr_trigger(struct snd_compr_stream *cstream, int cmd)
 		prtd->bytes_sent = 0;
 		prtd->marker_timestamp = 0;
 		prtd->dsp_fragments_sent = 0;
+		prtd->app_woken = false;
 
 		atomic_set(&prtd->xrun, 0);
 		spin_unlock_irqrestore(&prtd->lock, flags);
@@ -2646,6 +2672,7 @@ static int msm_compr_playback_copy(struct snd_compr_stream *cstream,
 	 */
 	spin_lock_irqsave(&prtd->lock, flags);
 	prtd->bytes_received += count;
+	prtd->app_woken = false;
 	if (atomic_read(&prtd->start)) {
 		if (atomic_read(&prtd->xrun)) {
 			pr_debug("%s: in xrun, count = %zd\n", __func__, count);
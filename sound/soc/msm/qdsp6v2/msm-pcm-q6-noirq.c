@@ -19,6 +19,7 @@
 #include <linux/wait.h>
 #include <linux/platform_device.h>
 #include <linux/slab.h>
+#include <linux/uaccess.h>
 #include <linux/of_device.h>
 #include <linux/dma-mapping.h>
 #include <linux/msm_audio_ion.h>
@@ -29,6 +30,8 @@
 #include <sound/pcm.h>
 #include <sound/initval.h>
 #include <sound/control.h>
+#include <sound/hwdep.h>
+#include <sound/devdep_params.h>
 #include <sound/q6audio-v2.h>
 #include <sound/timer.h>
 #include <asm/dma.h>
@@ -47,6 +50,9 @@ struct snd_msm {
 	struct snd_pcm *pcm;
 };
 
+/* hwdep device numbers for FE pcms, clear of the BE range used by routing */
+#define HWDEP_FE_BASE 3000
+
 #define CMD_EOS_MIN_TIMEOUT_LENGTH  50
 #define CMD_EOS_TIMEOUT_MULTIPLIER  (HZ * 50)
 
@@ -766,6 +772,119 @@ static int msm_pcm_add_chmap_control(struct snd_soc_pcm_runtime *rtd)
 	return 0;
 }
 
+#ifdef CONFIG_SND_HWDEP
+static int msm_pcm_mmap_fd(struct snd_pcm_substream *substream,
+			   struct snd_pcm_mmap_fd *mmap_fd, bool pos)
+{
+	struct msm_audio *prtd;
+	struct audio_buffer *ab;
+
+	if (!substream->runtime) {
+		pr_err("%s: substream not opened\n", __func__);
+		return -EINVAL;
+	}
+	prtd = substream->runtime->private_data;
+	if (!prtd || !prtd->audio_client) {
+		pr_err("%s: audio client not allocated\n", __func__);
+		return -EINVAL;
+	}
+
+	if (pos)
+		ab = q6asm_shared_pos_buf(prtd->audio_client);
+	else
+		ab = q6asm_shared_io_buf(prtd->audio_client, mmap_fd->dir);
+	if (!ab || !ab->client || !ab->handle) {
+		pr_err("%s: %s buffer not allocated\n", __func__,
+		       pos ? "position" : "data");
+		return -EINVAL;
+	}
+
+	mmap_fd->fd = ion_share_dma_buf_fd(ab->client, ab->handle);
+	if (mmap_fd->fd < 0)
+		return mmap_fd->fd;
+	mmap_fd->size = ab->size;
+	mmap_fd->actual_size = ab->actual_size;
+	return 0;
+}
+
+static int msm_pcm_hwdep_ioctl(struct snd_hwdep *hw, struct file *file,
+			       unsigned int cmd, unsigned long arg)
+{
+	struct snd_soc_pcm_runtime *rtd = hw->private_data;
+	struct snd_pcm *pcm = rtd->pcm;
+	struct snd_pcm_substream *substream;
+	struct snd_pcm_mmap_fd mmap_fd;
+	int ret;
+
+	switch (cmd) {
+	case SNDRV_PCM_IOCTL_MMAP_DATA_FD:
+	case SNDRV_PCM_IOCTL_MMAP_POS_FD:
+		break;
+	default:
+		pr_err("%s called with invalid control 0x%X\n", __func__, cmd);
+		return -EINVAL;
+	}
+
+	if (copy_from_user(&mmap_fd, (void __user *)arg, sizeof(mmap_fd)))
+		return -EFAULT;
+
+	if (mmap_fd.dir != SNDRV_PCM_STREAM_PLAYBACK &&
+	    mmap_fd.dir != SNDRV_PCM_STREAM_CAPTURE) {
+		pr_err("%s: invalid stream dir %d\n", __func__, mmap_fd.dir);
+		return -EINVAL;
+	}
+
+	/* keep the substream from being closed while its buffers are shared */
+	mutex_lock(&pcm->open_mutex);
+	substream = pcm->streams[mmap_fd.dir].substream;
+	if (!substream) {
+		ret = -ENODEV;
+		goto done;
+	}
+	ret = msm_pcm_mmap_fd(substream, &mmap_fd,
+			      cmd == SNDRV_PCM_IOCTL_MMAP_POS_FD);
+done:
+	mutex_unlock(&pcm->open_mutex);
+	if (ret)
+		return ret;
+
+	if (copy_to_user((void __user *)arg, &mmap_fd, sizeof(mmap_fd)))
+		return -EFAULT;
+	return 0;
+}
+
+static int msm_pcm_add_hwdep_dev(struct snd_soc_pcm_runtime *rtd)
+{
+	struct snd_hwdep *hwdep;
+	char id[] = "NOIRQ_NN";
+	int rc;
+
+	snprintf(id, sizeof(id), "NOIRQ_%d", rtd->pcm->device);
+	pr_debug("%s: pcm dev %d\n", __func__, rtd->pcm->device);
+	rc = snd_hwdep_new(rtd->card->snd_card, id,
+			   HWDEP_FE_BASE + rtd->pcm->device, &hwdep);
+	if (!hwdep || IS_ERR_VALUE(rc)) {
+		pr_err("%s: hwdep intf failed to create %s rc %d\n",
+		       __func__, id, rc);
+		return rc ? : -ENOMEM;
+	}
+
+	hwdep->iface = SNDRV_HWDEP_IFACE_AUDIO_BE;
+	hwdep->private_data = rtd;
+	hwdep->ops.ioctl = msm_pcm_hwdep_ioctl;
+#ifdef CONFIG_COMPAT
+	/* struct snd_pcm_mmap_fd has the same layout for 32 bit callers */
+	hwdep->ops.ioctl_compat = msm_pcm_hwdep_ioctl;
+#endif
+	return 0;
+}
+#else
+static int msm_pcm_add_hwdep_dev(struct snd_soc_pcm_runtime *rtd)
+{
+	return 0;
+}
+#endif
+
 static int msm_asoc_pcm_new(struct snd_soc_pcm_runtime *rtd)
 {
 	struct snd_card *card = rtd->card->snd_card;
@@ -786,6 +905,8 @@ static int msm_asoc_pcm_new(struct snd_soc_pcm_runtime *rtd)
 		pr_err("%s: Could not add pcm Volume Control %d\n",
 			__func__, ret);
 	}
+	if (msm_pcm_add_hwdep_dev(rtd))
+		pr_err("%s: Could not add hw dep node\n", __func__);
 	pcm->nonatomic = true;
 exit:
 	return ret;
@@ -70,6 +70,19 @@ struct source_tracking_data {
 	int apr_cmd_status;
 };
 
+/*
+ * Staging area used to send the audproc and audvol calibration of a COPP
+ * in a single ADM_CMD_SET_PP_PARAMS_V5. Only accessed with both cal type
+ * locks held.
+ */
+#define ADM_CAL_ARENA_SIZE	(64 * 1024)
+
+struct adm_cal_arena {
+	struct ion_client *ion_client;
+	struct ion_handle *ion_handle;
+	struct param_outband memmap;
+};
+
 struct adm_ctl {
 	void *apr;
 
@@ -88,6 +101,7 @@ struct adm_ctl {
 
 	struct param_outband outband_memmap;
 	struct source_tracking_data sourceTrackingData;
+	struct adm_cal_arena cal_arena;
 
 	int set_custom_topology;
 	int ec_ref_rx;
@@ -1301,6 +1315,21 @@ int adm_get_multi_ch_map(char *channel_map, int path)
 	return 0;
 }
 
+static void adm_cal_arena_free(void)
+{
+	if (!this_adm.cal_arena.memmap.paddr)
+		return;
+
+	msm_audio_ion_free(this_adm.cal_arena.ion_client,
+			   this_adm.cal_arena.ion_handle);
+	this_adm.cal_arena.ion_client = NULL;
+	this_adm.cal_arena.ion_handle = NULL;
+	this_adm.cal_arena.memmap.size = 0;
+	this_adm.cal_arena.memmap.kvaddr = NULL;
+	this_adm.cal_arena.memmap.paddr = 0;
+	atomic_set(&this_adm.mem_map_handles[ADM_MEM_MAP_INDEX_CAL_ARENA], 0);
+}
+
 static int32_t adm_callback(struct apr_client_data *data, void *priv)
 {
 	uint32_t *payload;
@@ -1375,6 +1404,7 @@ static int32_t adm_callback(struct apr_client_data *data, void *priv)
 				atomic_set(&this_adm.mem_map_handles[
 					ADM_MEM_MAP_INDEX_SOURCE_TRACKING], 0);
 			}
+			adm_cal_arena_free();
 		}
 		return 0;
 	}
@@ -1923,43 +1953,12 @@ done:
 	return;
 }
 
-static int send_adm_cal_block(int port_id, int copp_idx,
-			      struct cal_block_data *cal_block, int perf_mode,
-			      int app_type, int acdb_id, int sample_rate)
+static int adm_send_cal_payload(int port_id, int port_idx, int copp_idx,
+				phys_addr_t paddr, uint32_t mem_map_handle,
+				uint32_t size)
 {
 	s32				result = 0;
 	struct adm_cmd_set_pp_params_v5	adm_params;
-	int port_idx;
-
-	pr_debug("%s: Port id 0x%x sample_rate %d ,\n", __func__,
-			port_id, sample_rate);
-	port_id = afe_convert_virtual_to_portid(port_id);
-	port_idx = adm_validate_and_get_port_index(port_id);
-	if (port_idx < 0) {
-		pr_err("%s: Invalid port_id 0x%x\n", __func__, port_id);
-		return -EINVAL;
-	}
-	if (!cal_block) {
-		pr_debug("%s: No ADM cal to send for port_id = 0x%x!\n",
-			__func__, port_id);
-		result = -EINVAL;
-		goto done;
-	}
-	if (cal_block->cal_data.size <= 0) {
-		pr_debug("%s: No ADM cal send for port_id = 0x%x!\n",
-			__func__, port_id);
-		result = -EINVAL;
-		goto done;
-	}
-
-	if (perf_mode == LEGACY_PCM_MODE &&
-		((atomic_read(&this_adm.copp.topology[port_idx][copp_idx])) ==
-			DS2_ADM_COPP_TOPOLOGY_ID)) {
-		pr_err("%s: perf_mode %d, topology 0x%x\n", __func__, perf_mode,
-			atomic_read(
-				&this_adm.copp.topology[port_idx][copp_idx]));
-		goto done;
-	}
 
 	adm_params.hdr.hdr_field = APR_HDR_FIELD(APR_MSG_TYPE_SEQ_CMD,
 		APR_HDR_LEN(20), APR_PKT_VER);
@@ -1974,22 +1973,20 @@ static int send_adm_cal_block(int port_id, int copp_idx,
 	adm_params.hdr.dest_port =
 			atomic_read(&this_adm.copp.id[port_idx][copp_idx]);
 	adm_params.hdr.opcode = ADM_CMD_SET_PP_PARAMS_V5;
-	adm_params.payload_addr_lsw = lower_32_bits(cal_block->cal_data.paddr);
-	adm_params.payload_addr_msw = msm_audio_populate_upper_32_bits(
-						cal_block->cal_data.paddr);
-	adm_params.mem_map_handle = cal_block->map_data.q6map_handle;
-	adm_params.payload_size = cal_block->cal_data.size;
+	adm_params.payload_addr_lsw = lower_32_bits(paddr);
+	adm_params.payload_addr_msw = msm_audio_populate_upper_32_bits(paddr);
+	adm_params.mem_map_handle = mem_map_handle;
+	adm_params.payload_size = size;
 
 	atomic_set(&this_adm.copp.stat[port_idx][copp_idx], -1);
 	pr_debug("%s: Sending SET_PARAMS payload = 0x%pK, size = %d\n",
-		__func__, &cal_block->cal_data.paddr,
-		adm_params.payload_size);
+		__func__, &paddr, adm_params.payload_size);
 	result = apr_send_pkt(this_adm.apr, (uint32_t *)&adm_params);
 	if (result < 0) {
 		pr_err("%s: Set params failed port 0x%x result %d\n",
 				__func__, port_id, result);
 		pr_debug("%s: Set params failed port = 0x%x payload = 0x%pK result %d\n",
-			__func__, port_id, &cal_block->cal_data.paddr, result);
+			__func__, port_id, &paddr, result);
 		result = -EINVAL;
 		goto done;
 	}
@@ -2001,7 +1998,7 @@ static int send_adm_cal_block(int port_id, int copp_idx,
 		pr_err("%s: Set params timed out port = 0x%x\n",
 				__func__, port_id);
 		pr_debug("%s: Set params timed out port = 0x%x, payload = 0x%pK\n",
-			__func__, port_id, &cal_block->cal_data.paddr);
+			__func__, port_id, &paddr);
 		result = -EINVAL;
 		goto done;
 	} else if (atomic_read(&this_adm.copp.stat
@@ -2020,6 +2017,52 @@ done:
 	return result;
 }
 
+static int send_adm_cal_block(int port_id, int copp_idx,
+			      struct cal_block_data *cal_block, int perf_mode,
+			      int app_type, int acdb_id, int sample_rate)
+{
+	s32				result = 0;
+	int port_idx;
+
+	pr_debug("%s: Port id 0x%x sample_rate %d ,\n", __func__,
+			port_id, sample_rate);
+	port_id = afe_convert_virtual_to_portid(port_id);
+	port_idx = adm_validate_and_get_port_index(port_id);
+	if (port_idx < 0) {
+		pr_err("%s: Invalid port_id 0x%x\n", __func__, port_id);
+		return -EINVAL;
+	}
+	if (!cal_block) {
+		pr_debug("%s: No ADM cal to send for port_id = 0x%x!\n",
+			__func__, port_id);
+		result = -EINVAL;
+		goto done;
+	}
+	if (cal_block->cal_data.size <= 0) {
+		pr_debug("%s: No ADM cal send for port_id = 0x%x!\n",
+			__func__, port_id);
+		result = -EINVAL;
+		goto done;
+	}
+
+	if (perf_mode == LEGACY_PCM_MODE &&
+		((atomic_read(&this_adm.copp.topology[port_idx][copp_idx])) ==
+			DS2_ADM_COPP_TOPOLOGY_ID)) {
+		pr_err("%s: perf_mode %d, topology 0x%x\n", __func__, perf_mode,
+			atomic_read(
+				&this_adm.copp.topology[port_idx][copp_idx]));
+		goto done;
+	}
+
+	result = adm_send_cal_payload(port_id, port_idx, copp_idx,
+				      cal_block->cal_data.paddr,
+				      cal_block->map_data.q6map_handle,
+				      cal_block->cal_data.size);
+
+done:
+	return result;
+}
+
 static struct cal_block_data *adm_find_cal_by_path(int cal_index, int path)
 {
 	struct list_head		*ptr, *next;
@@ -2175,6 +2218,103 @@ done:
 	return;
 }
 
+static int adm_cal_arena_alloc_map_memory(void)
+{
+	int ret;
+
+	ret = msm_audio_ion_alloc("ADM_CAL_ARENA",
+				  &this_adm.cal_arena.ion_client,
+				  &this_adm.cal_arena.ion_handle,
+				  ADM_CAL_ARENA_SIZE,
+				  &this_adm.cal_arena.memmap.paddr,
+				  &this_adm.cal_arena.memmap.size,
+				  &this_adm.cal_arena.memmap.kvaddr);
+	if (ret) {
+		pr_err("%s: failed to allocate memory\n", __func__);
+		return -ENOMEM;
+	}
+
+	atomic_set(&this_adm.mem_map_index, ADM_MEM_MAP_INDEX_CAL_ARENA);
+	ret = adm_memory_map_regions(&this_adm.cal_arena.memmap.paddr, 0,
+			(uint32_t *)&this_adm.cal_arena.memmap.size, 1);
+	if (ret < 0) {
+		pr_err("%s: failed to map memory, size = %d\n", __func__,
+			(uint32_t)this_adm.cal_arena.memmap.size);
+		adm_cal_arena_free();
+		return -EINVAL;
+	}
+	return 0;
+}
+
+/*
+ * Copy the audproc and audvol cal of a COPP back to back into the mapped
+ * arena and send both with one SET_PP_PARAMS, saving a DSP round trip on
+ * every device switch. Returns false if nothing was sent, in which case
+ * the caller falls back to sending each cal type separately.
+ */
+static bool send_adm_cal_batched(int port_id, int copp_idx, int path,
+				 int perf_mode, int app_type, int acdb_id,
+				 int sample_rate)
+{
+	struct cal_block_data *audproc, *audvol;
+	size_t total;
+	int port_idx, afe_port_id;
+	bool sent = false;
+
+	if (!this_adm.cal_data[ADM_AUDPROC_CAL] ||
+	    !this_adm.cal_data[ADM_AUDVOL_CAL])
+		return false;
+
+	afe_port_id = afe_convert_virtual_to_portid(port_id);
+	port_idx = adm_validate_and_get_port_index(afe_port_id);
+	if (port_idx < 0)
+		return false;
+
+	if (perf_mode == LEGACY_PCM_MODE &&
+	    atomic_read(&this_adm.copp.topology[port_idx][copp_idx]) ==
+	    DS2_ADM_COPP_TOPOLOGY_ID)
+		return false;
+
+	mutex_lock(&this_adm.cal_data[ADM_AUDPROC_CAL]->lock);
+	mutex_lock(&this_adm.cal_data[ADM_AUDVOL_CAL]->lock);
+	audproc = adm_find_cal(ADM_AUDPROC_CAL, path, app_type, acdb_id,
+			       sample_rate);
+	audvol = adm_find_cal(ADM_AUDVOL_CAL, path, app_type, acdb_id,
+			      sample_rate);
+	if (!audproc || !audvol || !audproc->cal_data.kvaddr ||
+	    !audvol->cal_data.kvaddr)
+		goto unlock;
+
+	/* each payload is a list of 4 byte aligned param entries */
+	total = audproc->cal_data.size + audvol->cal_data.size;
+	if (total > ADM_CAL_ARENA_SIZE ||
+	    !IS_ALIGNED(audproc->cal_data.size, 4))
+		goto unlock;
+
+	if (!this_adm.cal_arena.memmap.paddr &&
+	    adm_cal_arena_alloc_map_memory())
+		goto unlock;
+
+	memcpy(this_adm.cal_arena.memmap.kvaddr, audproc->cal_data.kvaddr,
+	       audproc->cal_data.size);
+	memcpy(this_adm.cal_arena.memmap.kvaddr + audproc->cal_data.size,
+	       audvol->cal_data.kvaddr, audvol->cal_data.size);
+
+	pr_debug("%s: port 0x%x copp_idx %d audproc %zd audvol %zd\n",
+		 __func__, port_id, copp_idx, audproc->cal_data.size,
+		 audvol->cal_data.size);
+	adm_send_cal_payload(afe_port_id, port_idx, copp_idx,
+		this_adm.cal_arena.memmap.paddr,
+		atomic_read(&this_adm.mem_map_handles
+			    [ADM_MEM_MAP_INDEX_CAL_ARENA]),
+		total);
+	sent = true;
+unlock:
+	mutex_unlock(&this_adm.cal_data[ADM_AUDVOL_CAL]->lock);
+	mutex_unlock(&this_adm.cal_data[ADM_AUDPROC_CAL]->lock);
+	return sent;
+}
+
 static int get_cal_path(int path)
 {
 	if (path == 0x1)
@@ -2188,6 +2328,10 @@ static void send_adm_cal(int port_id, int copp_idx, int path, int perf_mode,
 {
 	pr_debug("%s: port id 0x%x copp_idx %d\n", __func__, port_id, copp_idx);
 
+	if (send_adm_cal_batched(port_id, copp_idx, path, perf_mode, app_type,
+				 acdb_id, sample_rate))
+		return;
+
 	send_adm_cal_type(ADM_AUDPROC_CAL, path, port_id, copp_idx, perf_mode,
 			  app_type, acdb_id, sample_rate);
 	send_adm_cal_type(ADM_AUDVOL_CAL, path, port_id, copp_idx, perf_mode,
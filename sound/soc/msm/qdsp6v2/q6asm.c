@@ -3544,6 +3544,23 @@ struct audio_buffer *q6asm_shared_io_buf(struct audio_client *ac,
 }
 EXPORT_SYMBOL(q6asm_shared_io_buf);
 
+/*
+ * q6asm_shared_pos_buf: Returns handle to the position buffer the DSP
+ * updates for pull/push mode.
+ * returns buffer handle, NULL if no shared io session is open
+ */
+struct audio_buffer *q6asm_shared_pos_buf(struct audio_client *ac)
+{
+	if (!ac) {
+		pr_err("%s: ac is null\n", __func__);
+		return NULL;
+	}
+	if (!ac->shared_pos_buf.handle)
+		return NULL;
+	return &ac->shared_pos_buf;
+}
+EXPORT_SYMBOL(q6asm_shared_pos_buf);
+
 /*
  * q6asm_shared_io_free: Frees memory allocated for a pull/push session
  * parameters